@@ -146,12 +146,17 @@ def run_algorithm(func, jobid, algorithm, files, arguments):
 #
 class algorithm_runner(object):
   Process = NonDaemonProcess    
+  ## Weight of the latest job when updating the moving average of the job times
+  JOB_TIME_WEIGHT = 0.1
+
   def __init__(self, nrprocesses):
     self.lock = threading.Lock()
     self.queue = queue.PriorityQueue()
     self.pool = RavePool(nrprocesses)
     self.nrprocesses = nrprocesses
     self.running_jobs = 0
+    self.finished_jobs = 0
+    self.mean_job_time = 0.0
     super(algorithm_runner, self).__init__()
   
   ##
@@ -188,16 +193,53 @@ class algorithm_runner(object):
   ##
   # Invoked by the async pool on answer
   #
-  def async_callback(self, arg):
+  def async_callback(self, arg, started=None):
     self.lock.acquire()
     try:
       self.queue.task_done()
       self.running_jobs = self.running_jobs - 1
+      if started != None:
+        self._record_job_time(time.time() - started)
       logger.debug("[algorithm_runner] Finished with job %s"%(str(arg)))
       self._handle_queue()
     finally:
       self.lock.release()
 
+  ##
+  # Updates the exponential moving average of the time spent on each job. Synchronization
+  # must be performed before entering this method.
+  # @param elapsed the wall clock time of the finished job in seconds
+  #
+  def _record_job_time(self, elapsed):
+    if self.finished_jobs == 0:
+      self.mean_job_time = elapsed
+    else:
+      self.mean_job_time = self.mean_job_time + self.JOB_TIME_WEIGHT * (elapsed - self.mean_job_time)
+    self.finished_jobs = self.finished_jobs + 1
+
+  ##
+  # Returns the back-pressure of the runner so that injectors can decide to slow down.
+  # The estimated latency is the time a job added now would have to wait before it
+  # is started, assuming that the queued and running jobs take the mean job time.
+  # @return a dictionary with queued, running, processes, finished, mean_job_time and estimated_latency
+  #
+  def status(self):
+    self.lock.acquire()
+    try:
+      queued = self.queue.qsize()
+      running = self.running_jobs
+      latency = 0.0
+      if queued + running >= self.nrprocesses:
+        latency = self.mean_job_time * float(queued + running - self.nrprocesses + 1) / self.nrprocesses
+      return {"queued":queued,
+              "running":running,
+              "processes":self.nrprocesses,
+              "finished":self.finished_jobs,
+              "mean_job_time":self.mean_job_time,
+              "estimated_latency":latency}
+    finally:
+      self.lock.release()
+
   ##
   # Runs one job from the queue. Synchronization must be performed before entering this
   # method. Will increase running jobs with 1 if job added async to pool
@@ -210,7 +252,9 @@ class algorithm_runner(object):
       except queue.Empty:
         pass
       if job:
-        self.pool.apply_async(run_algorithm, (job.func(), job.jobid(), job.algorithm(), job.files(), job.arguments()), callback=self.async_callback)
+        started = time.time()
+        self.pool.apply_async(run_algorithm, (job.func(), job.jobid(), job.algorithm(), job.files(), job.arguments()),
+                              callback=lambda arg: self.async_callback(arg, started))
         self.running_jobs = self.running_jobs + 1
         logger.info("[algorithm_runner] Applied job %s, currently %d jobs running and %d in queue"%(str(job.jobid()), self.running_jobs, self.queue.qsize()))
       else:
@@ -50,9 +50,11 @@ import rave_area
 import odim_source
 import rave_projection
 import rave_quality_plugin
+import rave_qc_executor
 from rave_quality_plugin import QUALITY_CONTROL_MODE_ANALYZE, QUALITY_CONTROL_MODE_ANALYZE_AND_APPLY   
 
 from rave_defines import CENTER_ID, GAIN, OFFSET
+from rave_defines import ETOP_GAIN, ETOP_OFFSET, VIL_GAIN, VIL_OFFSET
 from rave_defines import DEFAULTA, DEFAULTB, DEFAULTC
 
 logger = rave_pgf_logger.create_logger()
@@ -122,6 +124,8 @@ class compositing(object):
     self.radar_index_mapping = {}
     self.use_lazy_loading=True
     self.use_lazy_loading_preloads=True
+    self.qc_threads = 1
+    self.qc_timings = {}
     
   def generate(self, dd, dt, area=None):
     return self._generate(dd, dt, area)
@@ -192,6 +196,57 @@ class compositing(object):
   def _generate(self, dd, dt, area=None):
     self._debug_generate_info(area)
  
+    prepared = self._prepare_objects(dd, dt, area)
+    if prepared is None:
+      return None
+    objects, nodes, how_tasks, algorithm, qfields = prepared
+
+    pyarea = self._get_area(area, objects)
+    generator = self._create_generator(objects, algorithm, dd, dt)
+
+    if self.verbose:
+      self.logger.info("Generating cartesian composite")
+    
+    result = generator.generate(pyarea, qfields)
+    
+    return self._finalize_result(result, objects, nodes, how_tasks, qfields, dd, dt)
+
+  ## Generates the cartesian image over several areas. The objects are fetched and quality
+  # controlled once and the areas are then generated concurrently from the same polar data.
+  #
+  # @param dd: date in format YYYYmmdd
+  # @param dt: time in format HHMMSS
+  # @param areas: a list of areas (area ids or AreaCore instances)
+  # @param nthreads: the number of threads to use when generating the areas, <= 0 means one per area
+  # @return a list with one cartesian image per area or None if no composite could be generated
+  def generate_many(self, dd, dt, areas, nthreads=0):
+    areastr = ",".join([a.id if _area.isArea(a) else a for a in areas])
+    self._debug_generate_info(areastr)
+
+    prepared = self._prepare_objects(dd, dt, areastr)
+    if prepared is None:
+      return None
+    objects, nodes, how_tasks, algorithm, qfields = prepared
+
+    pyareas = [self._get_area(area, objects) for area in areas]
+    generator = self._create_generator(objects, algorithm, dd, dt)
+
+    if self.verbose:
+      self.logger.info("Generating %d cartesian composites"%len(pyareas))
+
+    if nthreads is None or nthreads <= 0:
+      nthreads = len(pyareas)
+    results = generator.generateMany(pyareas, qfields, nthreads)
+
+    return [self._finalize_result(r, objects, nodes, how_tasks, qfields, dd, dt) for r in results]
+
+  ## Fetches the objects and runs the quality controls on them.
+  #
+  # @param dd: date in format YYYYmmdd
+  # @param dt: time in format HHMMSS
+  # @param area: the area(s) that is generated, only used for logging
+  # @return a tuple ([objects], nodes, how_tasks, algorithm, qfields) or None if no composite should be generated
+  def _prepare_objects(self, dd, dt, area):
     if self.verbose:
       self.logger.info("Fetching objects and applying quality plugins")
     
@@ -216,7 +271,14 @@ class compositing(object):
     if self.dump:
       self._dump_objects(objects)
 
-    generator = _pycomposite.new()
+    return objects, nodes, how_tasks, algorithm, qfields
+
+  ## Returns the area to generate.
+  #
+  # @param area: an area id, an AreaCore or None for best fit
+  # @param objects: the polar objects, used for best fit
+  # @return the AreaCore
+  def _get_area(self, area, objects):
     if area is not None:
       if _area.isArea(area):
         pyarea = area
@@ -246,8 +308,19 @@ class compositing(object):
           pyarea.id = "auto_%s_%s"%(A.pcs, tmpid)
         except:
           pass
-    
-    generator.addParameter(self.quantity, self.gain, self.offset, self.minvalue)
+    return pyarea
+
+  ## Creates the composite generator for the objects.
+  #
+  # @param objects: the polar objects
+  # @param algorithm: the algorithm returned from the quality controls or None
+  # @param dd: date in format YYYYmmdd
+  # @param dt: time in format HHMMSS
+  # @return the generator with the radar index mapping applied
+  def _create_generator(self, objects, algorithm, dd, dt):
+    generator = _pycomposite.new()
+    gain, offset = self._product_gain_offset()
+    generator.addParameter(self.quantity, gain, offset, self.minvalue)
     generator.product = self.product
     if algorithm is not None:
       generator.algorithm = algorithm
@@ -284,13 +357,20 @@ class compositing(object):
     if self.prodpar is not None:
       self._update_generator_with_prodpar(generator)
     
-    if self.verbose:
-      self.logger.info("Generating cartesian composite")
-    
     generator.applyRadarIndexMapping(self.radar_index_mapping)
-    
-    result = generator.generate(pyarea, qfields)
-    
+    return generator
+
+  ## Applies the post processing (ct filter, gra, gap filling) and sets the source and how attributes.
+  #
+  # @param result: the generated cartesian image
+  # @param objects: the polar objects
+  # @param nodes: the nodes as a comma separated string
+  # @param how_tasks: the how/tasks as a comma separated string
+  # @param qfields: the quality fields
+  # @param dd: date in format YYYYmmdd
+  # @param dt: time in format HHMMSS
+  # @return the result
+  def _finalize_result(self, result, objects, nodes, how_tasks, qfields, dd, dt):
     if self.applyctfilter:
       if self.verbose:
         self.logger.debug("Applying ct filter")
@@ -309,7 +389,7 @@ class compositing(object):
           self.logger.warn("Failed to generate gra field....")
     
     # Hack to create a BRDR field if the qfields contains se.smhi.composite.index.radar
-    if "se.smhi.composite.index.radar" in qfields:
+    if "se.smhi.composite.index.radar" in qfields and self.product not in [_rave.Rave_ProductType_ETOP, _rave.Rave_ProductType_VIL]:
       bitmapgen = _bitmapgenerator.new()
       brdr_field = bitmapgen.create_intersect(result.getParameter(self.quantity), "se.smhi.composite.index.radar")
       brdr_param = result.createParameter("BRDR", _rave.RaveDataType_UCHAR)
@@ -320,7 +400,8 @@ class compositing(object):
         self.logger.debug("Applying gap filling")
       t = _transform.new()
       gap_filled = t.fillGap(result)
-      result.getParameter(self.quantity).setData(gap_filled.getParameter(self.quantity).getData())
+      quantity = self._product_quantity()
+      result.getParameter(quantity).setData(gap_filled.getParameter(quantity).getData())
     
     # Fix so that we get a valid place for /what/source and /how/nodes 
     plc = result.source
@@ -358,8 +439,12 @@ class compositing(object):
       self.product = _rave.Rave_ProductType_PMAX
     elif prodstr == "max":
       self.product = _rave.Rave_ProductType_MAX
+    elif prodstr == "etop":
+      self.product = _rave.Rave_ProductType_ETOP
+    elif prodstr == "vil":
+      self.product = _rave.Rave_ProductType_VIL
     else:
-      raise ValueError("Only supported product types are ppi, cappi, pcappi, pmax and max")    
+      raise ValueError("Only supported product types are ppi, cappi, pcappi, pmax, max, etop and vil")    
   
   def set_method_from_string(self, methstr):
     if methstr.upper() == "NEAREST_RADAR":
@@ -394,35 +479,17 @@ class compositing(object):
       raise ValueError("Invalid quality control mode (%s), only supported modes are analyze_and_apply or analyze"%modestr.lower())
     self.quality_control_mode = modestr.lower()
   
+  ##
+  # Runs the detectors on the objects. If qc_threads != 1, the objects are processed concurrently,
+  # see @ref rave_qc_executor.
+  # @param objects: a dictionary with the objects
+  # @return a tuple (dictionary with processed objects, algorithm, list of quality fields)
   def quality_control_objects(self, objects):
-    algorithm = None
-    result = {}
-    qfields = []
-    for k in objects.keys():
-      obj = objects[k]
-      for d in self.detectors:
-        p = rave_pgf_quality_registry.get_plugin(d)
-        if p != None:
-          process_result = p.process(obj, self.reprocess_quality_field, self.quality_control_mode)
-          if isinstance(process_result, tuple):
-            obj = process_result[0]
-            detector_qfields = process_result[1]
-          else:
-            obj = process_result
-            detector_qfields = p.getQualityFields()
-          for qfield in detector_qfields:
-            if qfield not in qfields:
-              qfields.append(qfield)
-          na = None
-          if isinstance(obj, tuple):
-            obj,na = obj[0],obj[1]
-          if na is None:
-            na = p.algorithm()
-          if algorithm == None and na != None: # Try to get the generator algorithm != None 
-            algorithm = na
-
-      result[k] = obj
-
+    executor = rave_qc_executor.qc_executor(self.detectors, self.reprocess_quality_field, self.quality_control_mode, self.qc_threads)
+    result, algorithm, qfields = executor.process(objects)
+    self.qc_timings = executor.timings
+    if len(executor.timings) > 0:
+      self.logger.info("Quality control timings: %s", executor.timings_str())
     return result, algorithm, qfields
   
   ##
@@ -641,9 +708,32 @@ class compositing(object):
       return "pmax"
     elif self.product == _rave.Rave_ProductType_MAX:
       return "max"
+    elif self.product == _rave.Rave_ProductType_ETOP:
+      return "etop"
+    elif self.product == _rave.Rave_ProductType_VIL:
+      return "vil"
     else:
       return "unknown"
       
+  ##
+  # @return the quantity of the generated parameter, ETOP and VIL are generated from reflectivity
+  def _product_quantity(self):
+    if self.product == _rave.Rave_ProductType_ETOP:
+      return "HGHT"
+    elif self.product == _rave.Rave_ProductType_VIL:
+      return "VIL"
+    return self.quantity
+
+  ##
+  # @return the gain and offset of the generated parameter. ETOP and VIL can not be stored with the
+  # reflectivity gain and offset so they get their own.
+  def _product_gain_offset(self):
+    if self.product == _rave.Rave_ProductType_ETOP:
+      return ETOP_GAIN, ETOP_OFFSET
+    elif self.product == _rave.Rave_ProductType_VIL:
+      return VIL_GAIN, VIL_OFFSET
+    return self.gain, self.offset
+
   ##
   # If prodpar has been set, the generator is updated with the apropriate values
   # @param generator: the generator to be updated with the information from the prodpar
@@ -675,6 +765,11 @@ class compositing(object):
           generator.elangle = v * math.pi / 180.0
         except ValueError:
           pass
+      elif generator.product in [_rave.Rave_ProductType_ETOP]:
+        try:
+          generator.etop_threshold = self._strToNumber(self.prodpar)
+        except ValueError:
+          pass
 
   ##
   # Converts a string into a number, either int or float. If value already is an int or float, that value is returned.
@@ -769,7 +864,7 @@ if __name__ == "__main__":
 
   parser.add_option("-p", "--product", dest="product",
                     default="PCAPPI",
-                    help="The type of Cartesian product to generate [PPI, CAPPI, PCAPPI, PMAX]. Default=PCAPPI.")
+                    help="The type of Cartesian product to generate [PPI, CAPPI, PCAPPI, PMAX, MAX, ETOP, VIL]. Default=PCAPPI.")
 
   parser.add_option("-P", "--prodpar", dest="prodpar",
                     type="float", default=1000.0,
@@ -31,6 +31,10 @@ import rave_math
 from gadjust import ttest
 from numpy import *
 from rave_defines import GADJUST_STATFILE
+try:
+  from rave_defines import GRA_QC_MAX_ITERATIONS
+except ImportError:
+  GRA_QC_MAX_ITERATIONS = 1
 
 import rave_pgf_logger
 
@@ -65,16 +69,20 @@ def generate(points, DATE, TIME, LOGFILE=GADJUST_STATFILE):
 # @return tuple containing correlation coefficient, sample size, and boolean
 # string 'T' or 'F' as to whether the correlation is statistically significant.
 def general_correlation(points):
-  xarr, yarr = [], []
-
-  for point in points:
-    xarr.append(log10(point.observation))
-    yarr.append(log10(point.radarvalue))
+  xarr = log10(fromiter((point.observation for point in points), float64, len(points)))
+  yarr = log10(fromiter((point.radarvalue for point in points), float64, len(points)))
+  n = len(xarr) - 1
+  r = correlation(xarr, yarr)
+  return r, n, ttest.ttest(r, n)
 
-  xarr = array(xarr, float64)
-  yarr = array(yarr, float64)
 
+## Correlation coefficient between two arrays
+# @param xarr array of x values
+# @param yarr array of y values
+# @return float correlation coefficient
+def correlation(xarr, yarr):
   n = len(xarr) - 1
+
   mx = sum(xarr) / len(xarr)
   my = sum(yarr) / len(yarr)
 
@@ -83,8 +91,33 @@ def general_correlation(points):
 
   Sxy = sum((xarr-mx) * (yarr-my))
 
-  r = Sxy / (n * Sx * Sy)
-  return r, n, ttest.ttest(r, n)
+  return Sxy / (n * Sx * Sy)
+
+
+## Least-squares fit of a polynomial of the nth order
+# @param order int representing order of fit
+# @param x array of x values
+# @param y array of y values
+# @return array with the order+1 coefficients, lowest order first
+def least_squares(order, x, y):
+  A = vander(x, order + 1, increasing=True)
+  coeffs = linalg.lstsq(A, y, rcond=None)[0]
+  return coeffs
+
+
+## Weights the residuals of a fit. Residuals within 1 standard deviation from the
+# mean get quality 1, between 1 and 2 standard deviations the quality decreases
+# linearly to 0 and residuals more than 2 standard deviations away are rejected.
+# @param Fq array of residuals
+# @return tuple with the quality array and a boolean array that is True for the residuals to keep
+def weight_residuals(Fq):
+  m = sum(Fq) / len(Fq)
+  std = sqrt(sum(power(Fq - m, 2)) / len(Fq))
+  if not isfinite(std) or std == 0.0:
+    return ones(len(Fq), float64), ones(len(Fq), bool)
+  z = abs((Fq - m) / std)
+  quality = where(z <= 1.0, 1.0, 2.0 - z)
+  return quality, z <= 2.0
 
 
 class gra_coefficient(object):
@@ -108,28 +141,41 @@ class gra_coefficient(object):
 class gra:
   ## Initializer
   # @param points list of synop points
-  def __init__(self, points):
+  # @param max_iterations the maximum number of times the quality control is repeated. Each
+  # time points are rejected the coefficients are derived again and the remaining points are checked.
+  def __init__(self, points, max_iterations=GRA_QC_MAX_ITERATIONS):
     self.points = points
     self.corr_coeff=1.0   # What is the correlation between range and F(G)?
     self.significant = "False"
     self.qc = 0.0
+    self.max_iterations = max_iterations
 
+  ## @return tuple with the distance and G-R arrays of the points
+  def _arrays(self):
+    n = len(self.points)
+    dist = fromiter((point.radardistance for point in self.points), float64, n)
+    gr = fromiter((point.gr for point in self.points), float64, n)
+    return dist, gr
 
   ## Derives a second-order statistical relation including quality control
   # @return coefficients a, b, c together with mean and standard deviation
   # of the G-R point pairs (dB)
   def get_2nd_order_adjustment(self):
     n = len(self.points)
-    a, b, c = self.least_square_nth_degree(2)
-    self.corr_coeff = self.get_correlation()
-    m, dev = self.get_std_deviation()
-    self.quality_control_2nd_order(a, b, c)
-
-    # Always regenerate a,b,c,m,dev,corr_coeff if QC has removed some obs
-    if n > len(self.points):
-      a, b, c = self.least_square_nth_degree(2)
-      self.corr_coeff = self.get_correlation()
-      m, dev = self.get_std_deviation()
+    dist, gr = self._arrays()
+    a, b, c = [float(v) for v in least_squares(2, dist, gr)]
+    self.corr_coeff = correlation(dist, gr)
+    m, dev = rave_math.get_std_deviation(gr)
+
+    for i in range(self.max_iterations if self.max_iterations > 1 else 1):
+      keep = self._quality_control_2nd_order(a, b, c, dist, gr)
+      if keep is None:
+        break
+      dist, gr = dist[keep], gr[keep]
+      # Always regenerate a,b,c,m,dev,corr_coeff if QC has removed some obs
+      a, b, c = [float(v) for v in least_squares(2, dist, gr)]
+      self.corr_coeff = correlation(dist, gr)
+      m, dev = rave_math.get_std_deviation(gr)
 
     if ttest.ttest(abs(self.corr_coeff),len(self.points))=="T":
       self.significant = "True"
@@ -142,70 +188,36 @@ class gra:
   ## Utility method for deriving least-squares fit of the nth order
   # @param order int representing order of fit
   def least_square_nth_degree(self, order):
-    xl, yl = [], []
-    for point in self.points:
-      xl.append(point.radardistance)
-      yl.append(point.gr)
-
-    arr=rave_math.least_square_nth_degree(order,xl,yl)
-    
-    alist=arr.tolist()
-    for i in range(len(alist)):
-      alist[i]=alist[i][0]
-
-    return tuple(alist)
+    dist, gr = self._arrays()
+    return tuple([float(v) for v in least_squares(order, dist, gr)])
 
   ## Derives correlation coefficient between G-R (dB) and distance
   # @return float correlation coefficient
   def get_correlation(self):
-    gr, dist = [], []
-    for point in self.points:
-      gr.append(point.gr)
-      dist.append(point.radardistance)
-      
-    xarr = array(dist, 'd')
-    yarr = array(gr, 'd')
-    n = len(xarr) - 1
-
-    mx = sum(xarr) / len(xarr)
-    my = sum(yarr) / len(yarr)
-
-    Sx = sqrt(sum(power(xarr-mx, 2)) / n)
-    Sy = sqrt(sum(power(yarr-my, 2)) / n)
-
-    Sxy = sum((xarr-mx) * (yarr-my))
-
-    r = Sxy / (n * Sx * Sy)
-    return r
+    dist, gr = self._arrays()
+    return correlation(dist, gr)
 
 
   ## Derives mean and standard deviation of the G-R point pairs
   # @return tuple containing mean and standard deviation
   def get_std_deviation(self):
-    vals=[]
-    for point in self.points:
-      vals.append(point.gr)
-    valarray=array(vals, 'd')
-    m, dev = rave_math.get_std_deviation(valarray)
+    dist, gr = self._arrays()
+    m, dev = rave_math.get_std_deviation(gr)
     return m, dev
 
 
   ## Derives mean QUALITY of the point pairs
   # @return float mean quality
   def get_mean_quality(self):
-    S = 0.0
-    for p in self.points:
-      S += p.Fq
-    return S / len(self.points)
+    Fq = fromiter((p.Fq for p in self.points), float64, len(self.points))
+    return sum(Fq) / len(Fq)
 
   ## Derives the standard deviation of G-R point-pair quality
   # @param m float mean
   # @return float standard deviation
   def get_stddev_quality(self, m):
-    std = 0.0
-    for p in self.points:
-      std += (p.Fq - m)**2
-    return sqrt(std / len(self.points))
+    Fq = fromiter((p.Fq for p in self.points), float64, len(self.points))
+    return sqrt(sum(power(Fq - m, 2)) / len(Fq))
 
   ## Conducts quality control of the relation between G-R point pairs and
   # surface distance. Point pairs more than 2 standard deviations in error
@@ -214,27 +226,24 @@ class gra:
   # @param b float coefficient b
   # @param c float coefficient c
   def quality_control_2nd_order(self, a, b, c):
-    for point in self.points:
-      # grapoint.radardistance is in unit km
-      fr = a + point.radardistance*b + c*(point.radardistance**2)
-      point.Fq = point.gr - fr
-
-    m = self.get_mean_quality()
-    std = self.get_stddev_quality(m)
-
-    tokill = []
-    for i in range(len(self.points)):
-      z = (self.points[i].Fq - m) / std
-      if abs(z) <= 1:
-        self.points[i].quality_ok = 1.0
-      elif 1 < abs(z) <= 2:
-        self.points[i].quality_ok = 1.0 - (abs(z) - 1.0)
-      elif abs(z) > 2:
-        tokill.append(i)
-    if len(tokill):
-      tokill.reverse()
-      for i in tokill:
-        del self.points[i]
+    dist, gr = self._arrays()
+    self._quality_control_2nd_order(a, b, c, dist, gr)
+
+  ## Quality control on the distance and G-R arrays that belong to the current points.
+  # Rejected points are removed from self.points, but never so many that there are
+  # fewer points left than needed for the 2nd order fit.
+  # @return the boolean array of points that are kept or None if no point was rejected
+  def _quality_control_2nd_order(self, a, b, c, dist, gr):
+    # grapoint.radardistance is in unit km
+    Fq = gr - (a + dist*b + c*power(dist, 2))
+    quality, keep = weight_residuals(Fq)
+    for point, fq, q in zip(self.points, Fq.tolist(), quality.tolist()):
+      point.Fq = fq
+      point.quality_ok = q
+    if keep.all() or count_nonzero(keep) < 3:
+      return None
+    self.points = [point for point, k in zip(self.points, keep.tolist()) if k]
+    return keep
 
 if __name__ == "__main__":
     """
@@ -24,6 +24,7 @@ along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
 # @author Anders Henja, SMHI
 # @date 2013-12-11
 import datetime, math
+import numpy
 import _rave
 from gadjust import grapoint
 from Proj import dr, rd
@@ -75,17 +76,21 @@ class obsmatcher(object):
     xptsv = 0
 
     result = []
-    for obs in obses:
-      if obs.accumulation_period == acc_period:
-        xpts = xpts + 1
-        time, value = image.getConvertedValueAtLonLat((obs.longitude*dr, obs.latitude*dr))
+    matching = [obs for obs in obses if obs.accumulation_period == acc_period]
+    xpts = len(matching)
+    if xpts > 0:
+      # All positions are sampled in one call so that the lookups are only done once
+      lons = numpy.array([obs.longitude*dr for obs in matching], numpy.float64)
+      lats = numpy.array([obs.latitude*dr for obs in matching], numpy.float64)
+      values, types, distances = image.getConvertedValuesAtLonLats(lons, lats, how_task)
+      for i, obs in enumerate(matching):
+        time, value = int(types[i]), float(values[i])
         if time in [_rave.RaveValueType_DATA, _rave.RaveValueType_UNDETECT]:
           xptst = xptst + 1
-          distance = image.getConvertedQualityValueAtLonLat((obs.longitude*dr, obs.latitude*dr), how_task)
-          # distance is in unit meters in the product, for grapoints it should be stored in unit km. Thus, we convert below
-          distance = distance / 1000.0
-          if distance != None:
+          if not math.isnan(distances[i]):
             xptsq = xptsq + 1
+            # distance is in unit meters in the product, for grapoints it should be stored in unit km. Thus, we convert below
+            distance = float(distances[i]) / 1000.0
             if obs.liquid_precipitation >= grapoint.MIN_GMM and value >= grapoint.MIN_RMM:
               xptsv = xptsv + 1
               result.append(grapoint.grapoint.from_observation(time, value, distance, obs))
@@ -27,16 +27,20 @@ along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
 ## @date 2013-01-14
 
 import sys, os, time, glob, types
+import atexit, socket, threading
 import multiprocessing
 import _raveio, _ravefield
 import _polarvolume, _polarscan
 import _pyhl, _odc_hac
 import rave_defines
+import rave_pgf_logger
 import odim_source
 from Proj import rd
-from numpy import zeros, uint8, uint32
+from numpy import zeros, uint8, uint32, packbits, unpackbits, frombuffer
 import xml.etree.ElementTree as ET
 
+logger = rave_pgf_logger.create_logger()
+
 
 HACDATA = rave_defines.RAVEROOT + '/share/hac/data'
 CONFIG_FILE = rave_defines.RAVECONFIG + '/hac_options.xml'
@@ -44,13 +48,31 @@ CONFIG_FILE = rave_defines.RAVECONFIG + '/hac_options.xml'
 initialized = 0
 ARGS = {}
 
+## Seconds between writes of a modified HAC when the store is used, can be
+#  set with the flush_interval attribute of the hac-options element.
+FLUSH_INTERVAL = 300
+
+## The HAC store, see \ref enableStore
+STORE = None
+
+## The process that owns \ref STORE. A forked process inherits a copy of the store that
+#  it must neither use nor release, since releasing it writes the copied HACs.
+STORE_PID = None
+
+## Last month's HACs cached for filtering in processes that do not own a store, see \ref climatologyStore
+CLIMATOLOGIES = None
+
+_storeLock = threading.Lock()
+
 ## Initializes the ARGS dictionary by reading config from XML file
 def init():
-    global initialized
+    global initialized, FLUSH_INTERVAL
     if initialized: return
     
     C = ET.parse(CONFIG_FILE)
     OPTIONS = C.getroot()
+    if "flush_interval" in OPTIONS.attrib:
+        FLUSH_INTERVAL = int(OPTIONS.attrib["flush_interval"])
     
     for site in list(OPTIONS):
         hac = HAC()
@@ -62,6 +84,64 @@ def init():
     initialized = 1
 
 
+## Keeps the HACs in memory between scans instead of reading and writing the HAC file
+#  for each scan. Modified HACs are written every flush interval and at exit, and last
+#  month's HACs used for filtering are read once. Only one process may own the store for
+#  a set of HAC files. In the PGF this is the main process, the worker processes send
+#  their hits to it with \ref sendIncrement. bin/odc_hac --store owns a store of its own.
+# @param flush_interval seconds between writes of a modified HAC, defaults to \ref FLUSH_INTERVAL
+# @returns the store
+def enableStore(flush_interval=None):
+    global STORE, STORE_PID
+    if flush_interval is None:
+        flush_interval = FLUSH_INTERVAL
+    with _storeLock:
+        if STORE is not None and STORE_PID != os.getpid():
+            raise RuntimeError("The HAC store is owned by process %d" % STORE_PID)
+        if STORE is None:
+            STORE = _odc_hac.store(flush_interval)
+            STORE_PID = os.getpid()
+            atexit.register(flushStore)
+        else:
+            STORE.flush_interval = flush_interval
+        return STORE
+
+
+## Returns the store if it is owned by this process.
+# @returns the store or None
+def ownStore():
+    if STORE is not None and STORE_PID == os.getpid():
+        return STORE
+    return None
+
+
+## Writes the modified HACs in the store, if any.
+def flushStore():
+    store = ownStore()
+    if store is not None:
+        store.flush()
+
+
+## Writes the modified HACs and stops using the store.
+def disableStore():
+    global STORE
+    if ownStore() is not None:
+        flushStore()
+        STORE = None
+
+
+## Returns a store that is only used for reading last month's HACs when filtering in a
+#  process without a store of its own, e.g. a PGF worker. Nothing is ever incremented in it,
+#  so it never writes and may exist in any number of processes.
+# @returns the store
+def climatologyStore():
+    global CLIMATOLOGIES
+    with _storeLock:
+        if CLIMATOLOGIES is None:
+            CLIMATOLOGIES = _odc_hac.store(FLUSH_INTERVAL)
+        return CLIMATOLOGIES
+
+
 class HAC:
     def __init__(self):
         self.hac = None
@@ -135,36 +215,50 @@ class HAC:
     # @param param string of the quantity to filter
     # @param enough int lower threshold of the number of hits to accept in order to process
     def hacFilter(self, scan, quant="DBZH", enough=100):
+        store = ownStore()
+        if store is None:
+            store = climatologyStore()
+
+        # A scan with another geometry than its HAC is left unfiltered, like a scan without HAC.
+        try:
+            self.hacFilterStore(store, scan, quant, enough)
+        except IOError:
+            pass
+
+
+    ## Performs the filtering with the climatology cached in the HAC store.
+    # @param store the HAC store
+    # @param scan input SCAN object
+    # @param param string of the quantity to filter
+    # @param enough int lower threshold of the number of hits to accept in order to process
+    def hacFilterStore(self, store, scan, quant="DBZH", enough=100):
         NOD = odim_source.NODfromSource(scan)
+        hacfile = hacFile(scan, lastmonth=True)
 
         # If HAC files are missing, then this method will passively fail.
-        try:
-            self.readHac(hacFile(scan, lastmonth=True))
+        climatology = store.climatology(hacfile)
+        if climatology is None:
+            return
+        count, nrays, nbins = climatology
 
-            if self.hac.getAttribute("how/count") < enough:
-                raise ValueError("Not enough hits in climatology for %s" % NOD)
+        if count < enough:
+            raise ValueError("Not enough hits in climatology for %s" % NOD)
 
-            hac_data = self.hac.getData()
-            if hac_data.shape != (scan.nrays, scan.nbins):
-                print(hac_data.shape, (scan.nrays, scan.nbins))
-                raise IOError("Scan and HAC have different geometries for %s" % NOD)
+        if (nrays, nbins) != (scan.nrays, scan.nbins):
+            raise IOError("Scan and HAC have different geometries for %s" % NOD)
 
-            ## Get site-specific threshold!
-            try:
-                self.thresh = ARGS[NOD].thresh
-            except KeyError:
-                self.thresh = ARGS["default"].thresh
-            ## Got site-specific threshold?
-
-            qind = _ravefield.new()
-            qind.setData(zeros(hac_data.shape, uint8))
-            qind.addAttribute("how/task", "eu.opera.odc.hac")
-            qind.addAttribute("how/task_args", self.thresh)
-            scan.addQualityField(qind)
-
-            _odc_hac.hacFilter(scan, self.hac, quant)
-        except IOError:
-            pass
+        try:
+            self.thresh = ARGS[NOD].thresh
+        except KeyError:
+            self.thresh = ARGS["default"].thresh
+
+        qind = _ravefield.new()
+        qind.setData(zeros((nrays, nbins), uint8))
+        qind.addAttribute("how/task", "eu.opera.odc.hac")
+        qind.addAttribute("how/task_args", self.thresh)
+        scan.addQualityField(qind)
+
+        store.filter(hacfile, scan, quant)
 
 
     ## Increments the HAC with the hits in the current scan.
@@ -174,6 +268,14 @@ class HAC:
         NOD = odim_source.NODfromSource(scan)
         hacfile = hacFile(scan)
 
+        store = ownStore()
+        if store is not None:
+            path = os.path.split(hacfile)[0]
+            if not os.path.isdir(path):
+                os.makedirs(path)
+            store.increment(hacfile, scan, quant)
+            return
+
         try:
             try:
                 self.readHac(hacfile)
@@ -257,6 +359,77 @@ def incrementPvol(pvol, quant="DBZH"):
         incrementScan(scan, quant)
 
 
+## Extracts the hits in the scans of the object, so that they can be accumulated by the
+#  process that owns the HACs. Scans without the quantity are skipped.
+# @param obj input SCAN or PVOL
+# @param quant string of the quantity to count hits in
+# @returns list of (file string, nrays, nbins, hits) tuples where hits is one bit per bin
+def packHits(obj, quant="DBZH"):
+    if _polarvolume.isPolarVolume(obj):
+        scans = [obj.getScan(i) for i in range(obj.getNumberOfScans())]
+    elif _polarscan.isPolarScan(obj):
+        scans = [obj]
+    else:
+        raise TypeError("HAC incrementor received neither SCAN nor PVOL as input object")
+
+    result = []
+    for scan in scans:
+        if not scan.hasParameter(quant):
+            continue
+        param = scan.getParameter(quant)
+        data = param.getData()
+        hits = (data != param.nodata) & (data != param.undetect)
+        result.append((hacFile(scan), scan.nrays, scan.nbins, packbits(hits).tobytes()))
+    return result
+
+
+## Increments the HACs in the store with hits from \ref packHits. Called in the process
+#  that owns the HACs, i.e. by the hac_increment method of the PGF main process.
+#  A scan with another geometry than its HAC is skipped, like in \ref HAC.hacIncrement.
+# @param hits list of (file string, nrays, nbins, hits) sequences
+# @return list of the HAC file strings that were skipped because of differing geometries
+def incrementHits(hits):
+    store = enableStore()
+    failed = []
+    for fstr, nrays, nbins, packed in hits:
+        packed = getattr(packed, "data", packed)  # XML-RPC binary
+        field = _ravefield.new()
+        field.setData(unpackbits(frombuffer(packed, uint8))[:nrays*nbins].reshape((nrays, nbins)))
+
+        path = os.path.split(fstr)[0]
+        if not os.path.isdir(path):
+            os.makedirs(path)
+        if not store.incrementHits(fstr, field):
+            failed.append(fstr)
+    if failed:
+        logger.warning("Scan and HAC have different geometries for %s" % ", ".join(failed))
+    return failed
+
+
+## Increments the HACs for the given object through the PGF main process, which owns the
+#  HAC store. Used by the PGF plugins since the PGF worker processes must not hold HACs of
+#  their own. If no PGF is running, the HAC files are incremented directly.
+# @param obj input SCAN or PVOL
+# @param quant string of the quantity to count hits in
+# @param host string host of the PGF
+# @param port int port of the PGF
+def sendIncrement(obj, quant="DBZH", host=rave_defines.PGF_HOST, port=rave_defines.PGF_PORT):
+    if sys.version_info < (3,):
+        import xmlrpclib as client
+    else:
+        import xmlrpc.client as client
+
+    hits = [(fstr, nrays, nbins, client.Binary(packed)) for fstr, nrays, nbins, packed in packHits(obj, quant)]
+    if not hits:
+        return
+    try:
+        client.ServerProxy("http://%s:%i/RAVE" % (host, port), verbose=False).hac_increment(hits)
+    except socket.error:
+        hacIncrement(obj, quant)
+    except client.Fault as e:
+        logger.error("Failed to increment HACs through the PGF: %s" % e.faultString)
+
+
 ## Filters the given object
 # @param obj input SCAN or PVOL
 def hacFilter(obj, quant="DBZH"):
@@ -49,7 +49,8 @@ def arglist2dict(arglist):
   return result
 
 
-## Increments HAC file(s) for the given object.
+## Increments HAC file(s) for the given object. The hits are sent to the PGF main
+#  process which owns the HACs, see \ref odc_hac.sendIncrement.
 # @param files the list of files to be used for generating the volume. Should be only one, normally.
 # @param arguments the arguments defining the volume. Should be empty in this first version; the desired quantity can be added later.
 def generate(files, arguments):
@@ -62,6 +63,6 @@ def generate(files, arguments):
     else:
       obj = _raveio.open(fname).object
 
-    odc_hac.hacIncrement(obj)
+    odc_hac.sendIncrement(obj)
   
   return None
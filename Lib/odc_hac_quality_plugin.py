@@ -37,6 +37,11 @@ class odc_hac_increment_plugin(rave_quality_plugin):
   # @return a list containing the corresponding string
   def getQualityFields(self):
     return ["eu.opera.odyssey.hac"]
+
+  ##
+  # @return False since the accumulators are shared between all scans from the same radar
+  def isThreadSafe(self):
+    return False
   
   ##
   # @param obj: A RAVE object that should be processed.
@@ -47,7 +52,7 @@ class odc_hac_increment_plugin(rave_quality_plugin):
   def process(self, obj, reprocess_quality_flag=True, quality_control_mode=QUALITY_CONTROL_MODE_ANALYZE_AND_APPLY, arguments=None):
     try:
       import odc_hac
-      odc_hac.hacIncrement(obj)
+      odc_hac.sendIncrement(obj)
     except:
       pass
     return obj, self.getQualityFields()
@@ -63,6 +68,11 @@ class odc_hac_filter_plugin(rave_quality_plugin):
   # @return a list containing the corresponding string
   def getQualityFields(self):
     return ["eu.opera.odyssey.hac"]
+
+  ##
+  # @return False since the accumulators are shared between all scans from the same radar
+  def isThreadSafe(self):
+    return False
   
   ##
   # @param obj: A RAVE object that should be processed.
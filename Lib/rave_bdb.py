@@ -141,16 +141,10 @@ class rave_bdb(object):
 
     content = self.get_database().get_file_content(fname)
     if content:
-      fpd, tmppath = tempfile.mkstemp(suffix='.h5', prefix='ravetmp')
-      try:
-        with contextlib.closing(content):
-          with os.fdopen(fpd, "wb") as outf:
-            shutil.copyfileobj(content, outf)
-            outf.flush()
-            outf.close()
-        return _raveio.open(tmppath).object # We cant perform lazy loading if we remove the file...
-      finally:
-        os.unlink(tmppath)
+      with contextlib.closing(content):
+        data = content.read()
+      # Opened directly from memory so lazy loading can be used without keeping a temporary file
+      return _raveio.openFromMemory(data, lazy_loading, preloadedQuantities).object
     else:
       raise Exception("No content for file %s"%fname)
 
@@ -49,6 +49,11 @@ class dealias_plugin(rave_quality_plugin):
   def getQualityFields(self):
     return ["se.smhi.detector.dealias"]
   
+  ##
+  # @return True since the dealiasing only works on the provided object
+  def isThreadSafe(self):
+    return True
+
   ##
   # @param obj: A RAVE object that should be processed.
   # @param reprocess_quality_flag: Not used
@@ -73,6 +73,12 @@ ARRAYTYPES = {'b':'char', 'B':'uchar', 'I':'int', 'h':'short',
 GAIN = 0.4
 OFFSET = -30.0
 
+# Default gain and offset for echo top heights (km) and vertically integrated liquid water (kg/m2)
+ETOP_GAIN = 0.1
+ETOP_OFFSET = -0.1
+VIL_GAIN = 0.5
+VIL_OFFSET = -0.5
+
 # Default Z-R coefficients, legacy from BALTEX Working Group on Radar
 ZR_A = 200.0
 ZR_b = 1.5
@@ -83,6 +89,7 @@ DEFAULTA = 0.323868068019
 DEFAULTB = -0.00107776407064
 DEFAULTC = 1.77500903316e-05
 MERGETERMS = 20  # how many 12-hour SYNOP terms to merge: 10 days.
+GRA_QC_MAX_ITERATIONS = 1  # how many times outliers are rejected and the coefficients derived again
 TIMELIMIT_CLIMATOLOGIC_COEFF = 48 # how many hours back in time we can use generated gra coefficients before using the climatologic variant
 
 # SAF-NWC MSG CT filter
@@ -159,6 +166,25 @@ RAVE_TILE_COMPOSITING_PROCESSES=None
 # and number of available cores. 
 RAVE_QUALITY_CONTROL_PROCESSES=4
 
+# Number of threads used by the PGF when running the quality controls on the objects in a
+# composite. 1 runs the objects serially, 0 uses the number of cores. Objects are processed
+# concurrently, the plugins for one object are always run in the configured order.
+RAVE_PGF_QUALITY_CONTROL_THREADS=1
+
+# Number of threads used by the PGF when generating a composite over several areas (argument areas)
+# from the same input. 0 uses one thread per area.
+RAVE_PGF_COMPOSITING_AREA_THREADS=0
+
+# Max number of BUFR files that are decoded at the same time in separate worker processes by each
+# PGF process. The BUFR library can only decode one file at a time within a process, so with 0 the
+# BUFR files read by the threads of a process are decoded one after the other. Every file is decoded
+# by a new worker process which loads the BUFR descriptor tables again, so this only pays off when
+# several BUFR files are read at the same time, e.g. by the quality control threads.
+RAVE_PGF_BUFR_WORKERS=0
+
+# The worker program used for decoding BUFR files when RAVE_PGF_BUFR_WORKERS > 0
+RAVE_PGF_BUFR_WORKER_PROGRAM=os.path.join(RAVEBIN, 'rave_bufr2odim')
+
 # If the quality fields should be reprocessed or not if the input already contains a relevant how/task
 # quality field. 
 RAVE_PGF_QUALITY_FIELD_REPROCESSING=False
@@ -175,6 +201,13 @@ RAVE_PGF_COMPOSITING_USE_LAZY_LOADING=False
 #
 RAVE_PGF_COMPOSITING_USE_LAZY_LOADING_PRELOADS=False
 
+# If the gra coefficient generation should match the observations from an in-process index
+# that is refreshed incrementally instead of querying the full time window from the database.
+# Observations arriving later than the index overlap are missed and each PGF worker process
+# keeps its own index, so this is off by default.
+#
+RAVE_PGF_GRA_USE_OBSERVATION_INDEX=False
+
 # What algorithm that should be used when performing QI-total
 #
 QITOTAL_METHOD = "minimum"
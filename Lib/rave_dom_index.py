@@ -0,0 +1,243 @@
+'''
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute (SMHI)
+
+This file is part of RAVE.
+
+RAVE is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RAVE is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
+
+'''
+## In-process spatial and temporal index of the observations and stations in the
+## DOM database (see @ref rave_dom_db).
+##
+## The gauge matching and the gra adjustment query the same area every hour with a
+## time window that only moves forward. Instead of letting the database scan the full
+## window each time, the observations for an area extent are kept in memory in a
+## lon/lat grid. When the window moves, only the new part of the window (plus an
+## overlap for late reports) is fetched from the database and observations that are
+## older than the window are evicted.
+##
+## The index provides the same get_observations_in_bbox and get_stations_in_bbox as
+## rave_dom_db.rave_db so it can be used wherever the database is used for lookups.
+##
+## @file
+## @date 2026-10-17
+import datetime
+import math
+import threading
+import time
+
+## Default grid cell size in degrees
+DEFAULT_CELLSIZE = 0.5
+
+## Default time before the end of the loaded window that is fetched again on each refresh
+## so that delayed and corrected reports are picked up
+DEFAULT_OVERLAP = datetime.timedelta(hours=3)
+
+## Default number of seconds that stations are cached before they are fetched again
+DEFAULT_STATION_TTL = 24*3600
+
+##
+# Returns the date and time of an observation as a datetime
+# @param obs: the observation
+# @return the datetime
+def observation_datetime(obs):
+  d, t = obs.date, obs.time
+  if isinstance(d, datetime.datetime):
+    return d
+  if not isinstance(d, datetime.date):
+    d = datetime.datetime.strptime(str(d), "%Y%m%d").date()
+  if not isinstance(t, datetime.time):
+    t = datetime.datetime.strptime(str(t), "%H%M%S").time()
+  return datetime.datetime.combine(d, t)
+
+##
+# The key identifying an observation, same as the primary key in the database
+# @param obs: the observation
+# @return the key
+def observation_key(obs):
+  return (obs.station, observation_datetime(obs), obs.accumulation_period)
+
+##
+# A lon/lat grid where each cell contains the keys of the items in it.
+class lonlat_grid(object):
+  def __init__(self, cellsize=DEFAULT_CELLSIZE):
+    self.cellsize = cellsize
+    self.cells = {}
+    self.items = {}
+
+  def _cell(self, lon, lat):
+    return (int(math.floor(lon / self.cellsize)), int(math.floor(lat / self.cellsize)))
+
+  ##
+  # Adds or replaces an item
+  # @param key: the key of the item
+  # @param item: the item, must have longitude and latitude in degrees
+  def add(self, key, item):
+    if key in self.items:
+      self.remove(key)
+    self.items[key] = item
+    self.cells.setdefault(self._cell(item.longitude, item.latitude), set()).add(key)
+
+  ##
+  # Removes an item
+  # @param key: the key of the item
+  def remove(self, key):
+    item = self.items.pop(key, None)
+    if item is not None:
+      c = self._cell(item.longitude, item.latitude)
+      self.cells[c].discard(key)
+      if not self.cells[c]:
+        del self.cells[c]
+
+  ##
+  # Returns the items within the bounding box
+  # @param ullon, ullat, lrlon, lrlat: the bounding box in degrees
+  # @return a list of items
+  def query(self, ullon, ullat, lrlon, lrlat):
+    result = []
+    x0, y0 = self._cell(ullon, lrlat)
+    x1, y1 = self._cell(lrlon, ullat)
+    if (x1 - x0 + 1) * (y1 - y0 + 1) > len(self.cells):
+      cells = [c for c in self.cells.keys() if x0 <= c[0] <= x1 and y0 <= c[1] <= y1]
+    else:
+      cells = [(x, y) for x in range(x0, x1 + 1) for y in range(y0, y1 + 1) if (x, y) in self.cells]
+    for c in cells:
+      for key in self.cells[c]:
+        item = self.items[key]
+        if ullon <= item.longitude <= lrlon and lrlat <= item.latitude <= ullat:
+          result.append(item)
+    return result
+
+  def __len__(self):
+    return len(self.items)
+
+##
+# The observations and stations for one area extent
+class extent_index(object):
+  def __init__(self, extent, cellsize):
+    self.extent = extent
+    self.observations = lonlat_grid(cellsize)
+    self.stations = None
+    self.stations_loaded = 0.0
+    self.loaded_start = None
+    self.loaded_end = None
+    self.lock = threading.Lock()
+
+##
+# Index over the observations and stations in a DOM database
+class dom_index(object):
+  ##
+  # Constructor
+  # @param db: the database, typically a rave_dom_db.rave_db instance. Must provide
+  #            get_observations_in_bbox and get_stations_in_bbox
+  # @param cellsize: the grid cell size in degrees
+  # @param overlap: the timedelta before the end of the loaded window that is fetched again on refresh
+  # @param station_ttl: number of seconds the stations are cached
+  def __init__(self, db, cellsize=DEFAULT_CELLSIZE, overlap=DEFAULT_OVERLAP, station_ttl=DEFAULT_STATION_TTL):
+    self.db = db
+    self.cellsize = cellsize
+    self.overlap = overlap
+    self.station_ttl = station_ttl
+    self._extents = {}
+    self._lock = threading.Lock()
+
+  def _get_extent_index(self, ullon, ullat, lrlon, lrlat):
+    key = (ullon, ullat, lrlon, lrlat)
+    with self._lock:
+      if key not in self._extents:
+        self._extents[key] = extent_index(key, self.cellsize)
+      return self._extents[key]
+
+  ##
+  # Makes sure that the observations between startdt and enddt are loaded. Only the part of the
+  # window that has not been loaded before is fetched and observations older than startdt are evicted.
+  def _refresh(self, idx, startdt, enddt):
+    ullon, ullat, lrlon, lrlat = idx.extent
+    if idx.loaded_start is None or startdt < idx.loaded_start or enddt < idx.loaded_start:
+      idx.observations = lonlat_grid(self.cellsize)
+      fetchstart = startdt
+      idx.loaded_start = startdt
+      idx.loaded_end = None
+    else:
+      fetchstart = max(startdt, idx.loaded_end - self.overlap)
+
+    if idx.loaded_end is None or enddt > idx.loaded_end - self.overlap:
+      for obs in self.db.get_observations_in_bbox(ullon, ullat, lrlon, lrlat, fetchstart, enddt):
+        idx.observations.add(observation_key(obs), obs)
+      idx.loaded_end = enddt if idx.loaded_end is None else max(idx.loaded_end, enddt)
+
+    if startdt > idx.loaded_start:
+      for key in [k for k in idx.observations.items.keys() if k[1] < startdt]:
+        idx.observations.remove(key)
+      idx.loaded_start = startdt
+
+  ##
+  # Returns the observations within the bounding box and time window in the same order as
+  # rave_dom_db.rave_db.get_observations_in_bbox, i.e. by station and newest first.
+  # The index is keyed by the bounding box so the same box should be used for each call.
+  # @param ullon, ullat, lrlon, lrlat: the bounding box in degrees
+  # @param startdt: the start of the time window
+  # @param enddt: the end of the time window, None means now
+  # @return a list of observations
+  def get_observations_in_bbox(self, ullon, ullat, lrlon, lrlat, startdt=None, enddt=None):
+    if startdt is None:
+      # Unbounded windows are not cached
+      return self.db.get_observations_in_bbox(ullon, ullat, lrlon, lrlat, startdt, enddt)
+    if enddt is None:
+      enddt = datetime.datetime.now()
+
+    idx = self._get_extent_index(ullon, ullat, lrlon, lrlat)
+    with idx.lock:
+      self._refresh(idx, startdt, enddt)
+      result = [o for o in idx.observations.query(ullon, ullat, lrlon, lrlat) if startdt <= observation_datetime(o) <= enddt]
+
+    result.sort(key=lambda o: observation_datetime(o), reverse=True)
+    result.sort(key=lambda o: o.station)
+    return result
+
+  ##
+  # Returns the stations within the bounding box. The stations are fetched once per
+  # bounding box and station_ttl.
+  # @param ullon, ullat, lrlon, lrlat: the bounding box in degrees
+  # @return a list of stations
+  def get_stations_in_bbox(self, ullon, ullat, lrlon, lrlat):
+    idx = self._get_extent_index(ullon, ullat, lrlon, lrlat)
+    with idx.lock:
+      if idx.stations is None or time.time() - idx.stations_loaded > self.station_ttl:
+        idx.stations = lonlat_grid(self.cellsize)
+        for s in self.db.get_stations_in_bbox(ullon, ullat, lrlon, lrlat):
+          if s.longitude is not None and s.latitude is not None:
+            idx.stations.add((s.stationnumber, s.stationsubnumber), s)
+        idx.stations_loaded = time.time()
+      return idx.stations.query(ullon, ullat, lrlon, lrlat)
+
+  ##
+  # Forgets everything that has been loaded
+  def clear(self):
+    with self._lock:
+      self._extents = {}
+
+indexpool = {}
+indexpool_lock = threading.Lock()
+
+##
+# Returns the index for the database. The same index is returned for the same database
+# instance so that it is kept between jobs in the same process.
+# @param db: the database
+# @return the dom_index
+def get_index(db):
+  with indexpool_lock:
+    if id(db) not in indexpool or indexpool[id(db)].db is not db:
+      indexpool[id(db)] = dom_index(db)
+    return indexpool[id(db)]
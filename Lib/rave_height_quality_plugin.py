@@ -43,6 +43,11 @@ class rave_height_quality_plugin(rave_quality_plugin):
   def getQualityFields(self):
     return ["se.smhi.composite.height.radar"]
   
+  ##
+  # @return True since the plugin does not modify anything
+  def isThreadSafe(self):
+    return True
+
   ##
   # @param obj: A rave object that should be processed, bogus in this case.
   # @param reprocess_quality_flag: Not used
@@ -51,6 +51,11 @@ class rave_overshooting_quality_plugin(rave_quality_plugin):
   def getQualityFields(self):
     return ["se.smhi.detector.poo"]
   
+  ##
+  # @return True since the detection range only works on the provided object
+  def isThreadSafe(self):
+    return True
+
   ##
   # @param obj: A rave object that should be processed.
   # @param reprocess_quality_flag: Specifies if the quality flag should be reprocessed or not. If False, then if possible the plugin should avoid generating the quality field again.
@@ -23,7 +23,8 @@ along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
 ## @author Daniel Michelson, SMHI
 ## @date 2010-07-09
 
-import sys, os, traceback, string, types
+import sys, os, traceback, string, types, time
+import threading
 from copy import deepcopy as copy
 import logging
 import multiprocessing
@@ -45,7 +46,19 @@ else:
   
 from rave_defines import DEX_SPOE, REGFILE, PGFs, LOGID, LOGLEVEL, PGF_HOST, PGF_PORT
 
+try:
+  import _ravestats
+except ImportError:
+  _ravestats = None
+
+try:
+  import _raveio
+except ImportError:
+  _raveio = None
+
 METHODS = {'generate' :  '("algorithm",[files],[arguments])',
+           'generate_batch' : '([("algorithm",[files],[arguments]), ...])',
+           'queue_status' : '',
            'get_quality_controls' : '',
            'get_areas' : '',
            'get_pcs_definitions' : '',
@@ -54,6 +67,7 @@ METHODS = {'generate' :  '("algorithm",[files],[arguments])',
            'deregister': '("name")',
            'flush':      '("stupid_password")',
            'job_done':   '("jobid")',
+           'hac_increment': '([("hacfile", nrays, nbins, hits), ...])',
            'Help': ''
            }
 
@@ -70,6 +84,8 @@ class RavePGF():
     self._pid = os.getpid()
     self._job_counter = 0
     self._jobid = "%i-0" % self._pid
+    self._lock = threading.Lock()
+    self._registry_lock = threading.RLock()
     self.logger = rave_pgf_logger.create_logger()
     self._algorithm_registry = None
     self.runner = None
@@ -114,10 +130,11 @@ class RavePGF():
   def register(self, name, module, function, Help="",
                strings="", ints="", floats="", seqs=""):
     self.logger.info("%s: Registering algorithm: %s" % (self.name, name))
-    self.deregister(name)
-    self._algorithm_registry.register(name, module, function, Help=Help,
-                                      strings=strings, ints=ints,
-                                      floats=floats, seqs=seqs)
+    with self._registry_lock:
+      self.deregister(name)
+      self._algorithm_registry.register(name, module, function, Help=Help,
+                                        strings=strings, ints=ints,
+                                        floats=floats, seqs=seqs)
     return "Registered %s" % name
 
 
@@ -132,7 +149,8 @@ class RavePGF():
   # @return string
   def deregister(self, name):
     self.logger.info("%s: De-registering algorithm: %s" % (self.name, name))
-    self._algorithm_registry.deregister(name)
+    with self._registry_lock:
+      self._algorithm_registry.deregister(name)
     return "De-registered %s" % name
 
 
@@ -142,6 +160,8 @@ class RavePGF():
   def flush(self, stupid_password):
     if stupid_password == "Killing me softly":
       self._dump_queue()
+      if "odc_hac" in sys.modules:
+        sys.modules["odc_hac"].flushStore()
       if self.pool:
         self.pool.terminate()
       if self.runner:
@@ -164,8 +184,17 @@ class RavePGF():
     self.queue.queue_job(algorithm, files, arguments, jobid)
     mod_name, func_name = algorithm.get('module'), algorithm.get('function')
     self.logger.debug("%s: ID=%s Queued %s.%s" % (self.name, jobid, mod_name, func_name))
-    self._job_counter += 1
-    self._jobid = "%i-%i" % (self._pid, self._job_counter)
+
+
+  ## Reserves a unique job ID. The server handles requests in several threads
+  # so the counter must be protected.
+  # @return string the job ID to use for the next job
+  def _next_jobid(self):
+    with self._lock:
+      jobid = self._jobid
+      self._job_counter += 1
+      self._jobid = "%i-%i" % (self._pid, self._job_counter)
+      return jobid
 
 
   ## Dumps the job queue to XML file. Called automatically when the server
@@ -203,7 +232,7 @@ class RavePGF():
   # @param algorithm Element copied from \ref self._algorithm_registry
   # @param files list of file strings
   # @param arguments list of verified arguments to pass to the generator
-  # @return the result from the algorithm, either filename or None
+  # @return the result from the algorithm, either filename, a list of filenames or None
   def _run(self, algorithm, files, arguments):
     import imp
     mod_name, func_name = algorithm.get('module'), algorithm.get('function')
@@ -221,6 +250,61 @@ class RavePGF():
     return outfile
 
 
+  ## Resets the toolbox timers and counters. The jobs are run one at a time in each
+  # worker process so after the job the values only belong to that job.
+  def _reset_stats(self):
+    if _ravestats is not None and _ravestats.isEnabled():
+      _ravestats.reset()
+
+
+  ## Logs the time spent in the instrumented parts of the toolbox during the job.
+  # Nothing is logged unless rave has been configured with --enable-stats.
+  # @param algorithm the algorithm name
+  # @param elapsed the wall clock time of the job in seconds
+  def _log_stats(self, algorithm, elapsed):
+    if _ravestats is None or not _ravestats.isEnabled():
+      return
+    timers = ["%s=%.3fs/%d" % (k, v[0], v[1]) for k, v in sorted(_ravestats.timers().items()) if v[1] > 0]
+    counters = ["%s=%d" % (k, v) for k, v in sorted(_ravestats.counters().items()) if v > 0]
+    self.logger.info("%s: ID=%s Stats for %s: total=%.3fs %s" % (self.name, self._jobid, algorithm, elapsed, " ".join(timers + counters)))
+
+
+  ## Returns the files produced by an algorithm
+  # @param outfile the result from the algorithm, None, a filename or a list of filenames
+  # @return a list of filenames
+  def _outfiles(self, outfile):
+    if outfile is None:
+      return []
+    if isinstance(outfile, (list, tuple)):
+      return [f for f in outfile if f is not None]
+    return [outfile]
+
+
+  ## Verifies that the algorithm is registered and hands the job over to the
+  # runner. Raises an exception if the job can not be dispatched.
+  # @param algorithm string to the desired product generation call
+  # @param files list of file strings
+  # @param arguments list of argument strings
+  # @param jobid string unique ID of the job
+  def _dispatch(self, algorithm, files, arguments, jobid):
+    # Verify algorithm is registered
+    algorithm = algorithm.lower()
+    with self._registry_lock:
+      algorithm_entry = copy(self._algorithm_registry.find(algorithm))
+    if not algorithm_entry:
+      raise LookupError('Algorithm "%s" not in registry' % algorithm)
+
+    # Format job. This queue will only ever have one entry; it is thus used
+    # for conveniently formatting the job, not for actually queueing.
+    self._queue_job(algorithm_entry, files, arguments, jobid)
+    # Write job to resilient queue on disk.
+    #self._dump_queue()  # Really necessary each time?
+
+    self.logger.info("%s: ID=%s Dispatching request for %s" % (self.name, jobid, algorithm))
+    self.runner.add(generate, jobid, algorithm, files, arguments, self.job_done)
+    #result = self.pool.apply_async(generate, (jobid, algorithm, files, arguments))
+
+
   ## Dispatcher method. Calls the \ref generate function that in turn creates 
   # a provisional instance of a \ref PGF object to invoke the \ref _generate 
   # method that does the job. The algorithm's presence in the registry is checked
@@ -233,23 +317,9 @@ class RavePGF():
   # @return string "OK" always, which is ignored because the real work is deferred.
   def generate(self, algorithm, files, arguments):
     err_msg = None
-    jobid = self._jobid
+    jobid = self._next_jobid()
     try:
-      # Verify algorithm is registered
-      algorithm = algorithm.lower()
-      algorithm_entry = copy(self._algorithm_registry.find(algorithm))
-      if not algorithm_entry:
-        raise LookupError('Algorithm "%s" not in registry' % algorithm)
-          
-      # Format job. This queue will only ever have one entry; it is thus used
-      # for conveniently formatting the job, not for actually queueing.
-      self._queue_job(algorithm_entry, files, arguments, jobid)
-      # Write job to resilient queue on disk.
-      #self._dump_queue()  # Really necessary each time?
-
-      self.logger.info("%s: ID=%s Dispatching request for %s" % (self.name, jobid, algorithm))
-      self.runner.add(generate, jobid, algorithm, files, arguments, self.job_done)
-      #result = self.pool.apply_async(generate, (jobid, algorithm, files, arguments))
+      self._dispatch(algorithm, files, arguments, jobid)
     except Exception:
       #err_msg = traceback.format_exc()
       #self.logger.error("%s: ID=%s failed. Check this out:\n%s" % (self.name, jobid, err_msg))
@@ -258,6 +328,41 @@ class RavePGF():
     if err_msg: return err_msg        
     return "OK"
 
+
+  ## Dispatches several jobs in one call. Injectors delivering many files at the same
+  # time should use this instead of calling \ref generate once per file since each
+  # XML-RPC round trip costs more than the dispatching itself.
+  # @param jobs list of (algorithm, files, arguments) sequences, see \ref generate
+  # @return list with one string per job, either "OK" or the reason why the job was not dispatched
+  def generate_batch(self, jobs):
+    result = []
+    for job in jobs:
+      jobid = self._next_jobid()
+      try:
+        if len(job) != 3:
+          raise ValueError("Job must be (algorithm, files, arguments)")
+        algorithm, files, arguments = job
+        self._dispatch(algorithm, files, arguments, jobid)
+        result.append("OK")
+      except Exception as e:
+        self.logger.exception("%s: ID=%s failed. Check this out:" % (self.name, jobid))
+        result.append("%s: %s" % (e.__class__.__name__, str(e)))
+    self.logger.debug("%s: Dispatched batch of %i jobs" % (self.name, len(result)))
+    return result
+
+
+  ## Returns the back-pressure of the server so that injectors can throttle themselves.
+  # @return dictionary with the number of queued, running and pending jobs, the number
+  # of processes, the mean job time and the estimated latency in seconds for a new job.
+  # Pending jobs are the ones that have been dispatched but not reported as done.
+  def queue_status(self):
+    if self.runner:
+      result = self.runner.status()
+    else:
+      result = {"queued":0, "running":0, "processes":0, "finished":0, "mean_job_time":0.0, "estimated_latency":0.0}
+    result["pending"] = self.queue.qsize() if self.queue is not None else 0
+    return result
+
   ##
   # Returns the registered controls
   #
@@ -320,6 +425,8 @@ class RavePGF():
     self.logger.debug("%s: Request for generate algorithm: %s" % (self.name, algorithm))
 
     outfile = None
+    starttime = time.time()
+    self._reset_stats()
     
     try:
       # Verify that the file list contains at least one file
@@ -345,11 +452,11 @@ class RavePGF():
       else:
         self.logger.debug("%s: ID=%s one job run, no output file" % (self.name, self._jobid))
       
-      # Inject the result if it is a file
-      if outfile != None:
-        BaltradFrame.inject_file(outfile, DEX_SPOE)
+      # Inject the result if it is a file, algorithms generating several products return a list of files
+      for f in self._outfiles(outfile):
+        BaltradFrame.inject_file(f, DEX_SPOE)
         # Log the result
-        self.logger.debug("%s: ID=%s Injected %s" % (self.name, self._jobid, outfile))
+        self.logger.debug("%s: ID=%s Injected %s" % (self.name, self._jobid, f))
         
     except Exception:
       # the 'err' itself is pretty useless
@@ -357,8 +464,10 @@ class RavePGF():
       #self.logger.error("%s: ID=%s failed. Check this out:\n%s" % (self.name, self._jobid, err_msg))
       self.logger.exception("%s: ID=%s failed. Check this out:" % (self.name, self._jobid))
 
-    if outfile != None:
-      if os.path.isfile(outfile): os.remove(outfile)
+    for f in self._outfiles(outfile):
+      if os.path.isfile(f): os.remove(f)
+
+    self._log_stats(algorithm, time.time() - starttime)
     
     if err_msg != None:
       self.logger.debug("%s: ID=%s Returning: %s" % (self.name, self._jobid, err_msg))
@@ -377,6 +486,17 @@ class RavePGF():
       self.logger.debug("%s: ID=%s Dequeued job" % (self.name, jobid))
 
 
+  ## Increments the HACs with hits sent by the HAC plugins running in the worker
+  # processes, see \ref odc_hac.sendIncrement. The main process owns the HAC store
+  # so that each HAC is only held and written by one process.
+  # @param hits list of (file string, nrays, nbins, hits) sequences, see \ref odc_hac.packHits
+  # @return string "OK"
+  def hac_increment(self, hits):
+    import odc_hac
+    odc_hac.incrementHits(hits)
+    return "OK"
+
+
   ##
   # Executes a shell escape command
   # @param command: the shell command without &
@@ -414,6 +534,25 @@ class RavePGF():
     return ret
 
 
+## Lets the BUFR files be decoded in separate worker processes according to
+# RAVE_PGF_BUFR_WORKERS and RAVE_PGF_BUFR_WORKER_PROGRAM in rave_defines. The setting
+# belongs to the process so it is applied when the PGF starts and in each job process.
+# @param logger the logger to report a failed configuration to
+def configure_bufr_workers(logger):
+  import rave_defines
+  nworkers = getattr(rave_defines, "RAVE_PGF_BUFR_WORKERS", 0)
+  if _raveio is None or nworkers <= 0 or _raveio.getBufrWorkers() == nworkers:
+    return
+  program = getattr(rave_defines, "RAVE_PGF_BUFR_WORKER_PROGRAM", None)
+  if program is None or not os.path.isfile(program):
+    logger.warning("BUFR worker program %s does not exist, decoding BUFR files in process" % program)
+    return
+  try:
+    _raveio.setBufrWorkers(program, nworkers)
+  except Exception:
+    logger.exception("Failed to configure BUFR workers")
+
+
 ## Convenience function for running several jobs asynchronously with
 # \multiprocessing.apply_async
 # @param jobid string job ID, used to keep track of jobs
@@ -427,6 +566,7 @@ class RavePGF():
 def generate(jobid, algorithm, files, arguments, host=PGF_HOST, port=PGF_PORT):
     pgf = RavePGF()
     pgf._jobid = jobid
+    configure_bufr_workers(pgf.logger)
     pgf._algorithm_registry = copy(PGF_REGISTRY)  # Less flexible than reading it each time
     try:
       ret = pgf._generate(algorithm, files, arguments)
@@ -158,12 +158,15 @@ def generate(files, arguments):
 
   nodes = None
 
+  # Only the parameter and the distance field are needed, everything else is left for lazy loading
+  preload = "%s,%s"%(quantity, distancefield)
+
   for fname in files:
     obj = None
     if ravebdb != None:
-      obj = ravebdb.get_rave_object(fname)
+      obj = ravebdb.get_rave_object(fname, True, preload)
     else:
-      rio = _raveio.open(fname)
+      rio = _raveio.open(fname, True, preload)
       obj = rio.object
 
     if _cartesianvolume.isCartesianVolume(obj):
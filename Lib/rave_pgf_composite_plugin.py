@@ -21,8 +21,12 @@ along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
 ## framework.
 ## Register in pgf with
 ## --name=eu.baltrad.beast.generatecomposite
-## --strings=area,quantity,method,date,time,selection,anomaly-qc
-## --floats=height -m rave_pgf_composite_plugin -f generate
+## --strings=area,areas,quantity,method,date,time,selection,anomaly-qc
+## --floats=height --ints=qc-threads -m rave_pgf_composite_plugin -f generate
+##
+## Instead of area, a comma separated list of area ids can be given with areas. The
+## input files are then only loaded and quality controlled once and the areas are
+## generated concurrently. One file per area is returned.
 ##
 
 ## @file
@@ -62,6 +66,20 @@ except:
   pass
 
 
+QUALITY_CONTROL_THREADS=1
+try:
+  from rave_defines import RAVE_PGF_QUALITY_CONTROL_THREADS
+  QUALITY_CONTROL_THREADS = RAVE_PGF_QUALITY_CONTROL_THREADS
+except:
+  pass
+
+AREA_THREADS=0
+try:
+  from rave_defines import RAVE_PGF_COMPOSITING_AREA_THREADS
+  AREA_THREADS = RAVE_PGF_COMPOSITING_AREA_THREADS
+except:
+  pass
+
 logger = rave_pgf_logger.create_logger()
 
 ravebdb = None
@@ -109,6 +127,10 @@ def generate(files, arguments):
   if "qc-mode" in args.keys():
     comp.set_quality_control_mode_from_string(args["qc-mode"])
 
+  comp.qc_threads = QUALITY_CONTROL_THREADS
+  if "qc-threads" in args.keys():
+    comp.qc_threads = int(args["qc-threads"])
+
   if "ignore-malfunc" in args.keys():
     try:
       if args["ignore-malfunc"].lower() in ["true", "yes", "y", "1"]:
@@ -185,6 +207,9 @@ def generate(files, arguments):
     comp.zr_b = float(args["zrb"])
   
   
+  if "areas" in args.keys():
+    return generate_areas(comp, args["date"], args["time"], [a.strip() for a in args["areas"].split(",") if a.strip()])
+
   if rave_tile_registry.has_tiled_area(args["area"]):
     comp = tiled_compositing(comp)
   
@@ -194,6 +219,40 @@ def generate(files, arguments):
     logger.info("No composite could be generated.")
     return None
   
+  return save_result(result)
+
+## Generates the composite over several areas from the same input files
+#@param comp the configured compositing instance
+#@param dd the date
+#@param dt the time
+#@param areas the area ids
+#@return a list of temporary h5 files, one for each area that could be generated
+def generate_areas(comp, dd, dt, areas):
+  tiled = [a for a in areas if rave_tile_registry.has_tiled_area(a)]
+  untiled = [a for a in areas if a not in tiled]
+  results = []
+
+  if len(untiled) > 0:
+    generated = comp.generate_many(dd, dt, untiled, AREA_THREADS)
+    if generated is not None:
+      results.extend(generated)
+
+  # Tiled areas are already generated concurrently by tiled_compositing
+  for a in tiled:
+    result = tiled_compositing(comp).generate(dd, dt, a)
+    if result is not None:
+      results.append(result)
+
+  if len(results) == 0:
+    logger.info("No composite could be generated.")
+    return None
+
+  return [save_result(r) for r in results]
+
+## Saves the result in a temporary file
+#@param result the composite
+#@return the name of the temporary h5 file
+def save_result(result):
   _, outfile = rave_tempfile.mktemp(suffix='.h5', close="True")
   
   rio = _raveio.new()
@@ -60,12 +60,20 @@ from gadjust import gra, obsmatcher
 from gadjust.gra import gra_coefficient
 import odim_source
 import rave_dom_db
+import rave_dom_index
 
 from rave_defines import CENTER_ID, GAIN, OFFSET, MERGETERMS
 from rave_defines import DEFAULTA, DEFAULTB, DEFAULTC, TIMELIMIT_CLIMATOLOGIC_COEFF
 from sqlalchemy.exc import OperationalError
 import psycopg2
 
+USE_OBSERVATION_INDEX=False
+try:
+  from rave_defines import RAVE_PGF_GRA_USE_OBSERVATION_INDEX
+  USE_OBSERVATION_INDEX = RAVE_PGF_GRA_USE_OBSERVATION_INDEX
+except:
+  pass
+
 logger = rave_pgf_logger.create_logger()
   
 ravebdb = None
@@ -114,7 +122,10 @@ def get_backup_gra_coefficient(db, maxage):
 #@return a temporary h5 file with the composite
 
 def calculate_gra_coefficient(distancefield, interval, adjustmentfile, etime, edate, acrrproduct, db):
-  matcher = obsmatcher.obsmatcher(db)
+  if USE_OBSERVATION_INDEX:
+    matcher = obsmatcher.obsmatcher(rave_dom_index.get_index(db))
+  else:
+    matcher = obsmatcher.obsmatcher(db)
   logger.info("rave_pgf_gra_plugin: Matching observations")
   points = matcher.match(acrrproduct, acc_period=interval, quantity="ACRR", how_task=distancefield)
   if len(points) == 0:
@@ -212,12 +223,15 @@ def generate(files, arguments):
 
   logger.info("rave_pgf_gra_plugin: Processing files")
 
+  # Only the parameter and the distance field are needed, everything else is left for lazy loading
+  preload = "%s,%s"%(quantity, distancefield)
+
   for fname in files:
     obj = None
     if ravebdb != None:
-      obj = ravebdb.get_rave_object(fname)
+      obj = ravebdb.get_rave_object(fname, True, preload)
     else:
-      rio = _raveio.open(fname)
+      rio = _raveio.open(fname, True, preload)
       obj = rio.object
 
     if _cartesianvolume.isCartesianVolume(obj):
@@ -0,0 +1,208 @@
+'''
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute (SMHI)
+
+This file is part of RAVE.
+
+RAVE is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RAVE is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
+
+'''
+## Executes the quality controls (detectors) for a number of objects.
+##
+## The work is described as a graph with one node per object and plugin. The plugins
+## for one object must be run in the configured order, while different objects are
+## independent of each other and are processed concurrently by a pool of threads.
+## Consecutive plugins for the same object are fused into one stage that is executed
+## by the same thread on the already loaded object. A plugin that returns False from
+## isThreadSafe() becomes a stage of its own that is never run concurrently with itself.
+##
+## Most of the quality controls are implemented in C and release the GIL while
+## processing so the threads run in parallel.
+##
+## @file
+## @date 2026-10-17
+import threading
+import time
+import multiprocessing
+import rave_pgf_logger
+import rave_pgf_quality_registry
+from rave_quality_plugin import QUALITY_CONTROL_MODE_ANALYZE_AND_APPLY
+
+logger = rave_pgf_logger.create_logger()
+
+##
+# Returns if the plugin may be run concurrently on different objects.
+# @param plugin: the quality plugin
+# @return True if the plugin is thread safe
+def is_thread_safe(plugin):
+  try:
+    return bool(plugin.isThreadSafe())
+  except AttributeError:
+    return False
+
+##
+# One stage in the chain of an object, i.e. a number of consecutive plugins
+# that are run by the same thread.
+class qc_stage(object):
+  def __init__(self, threadsafe):
+    self.threadsafe = threadsafe
+    self.plugins = [] # list of (index, name, plugin)
+
+  def __repr__(self):
+    return "qc_stage(%s, %s)"%(self.threadsafe, [x[1] for x in self.plugins])
+
+##
+# Executes the quality plugins over a number of objects.
+class qc_executor(object):
+  ##
+  # Constructor
+  # @param detectors: the names of the quality plugins in the order they should be run
+  # @param reprocess_quality_field: passed on to the plugins
+  # @param quality_control_mode: passed on to the plugins
+  # @param nthreads: number of threads to use, <= 0 means number of cpus and 1 means that the objects are processed serially
+  def __init__(self, detectors, reprocess_quality_field=False, quality_control_mode=QUALITY_CONTROL_MODE_ANALYZE_AND_APPLY, nthreads=1):
+    self.detectors = list(detectors)
+    self.reprocess_quality_field = reprocess_quality_field
+    self.quality_control_mode = quality_control_mode
+    self.nthreads = nthreads
+    self.timings = {}
+    self._timings_lock = threading.Lock()
+    self._plugin_locks = {}
+
+  ##
+  # Creates the stages that each object should be processed with.
+  # @param parallel: if the objects will be processed concurrently. If not, all plugins are fused into one stage.
+  # @return a list of qc_stage
+  def create_stages(self, parallel=True):
+    stages = []
+    for i, d in enumerate(self.detectors):
+      p = rave_pgf_quality_registry.get_plugin(d)
+      if p is None:
+        continue
+      threadsafe = is_thread_safe(p) if parallel else True
+      if not threadsafe:
+        self._plugin_locks.setdefault(d, threading.Lock())
+      if not stages or not threadsafe or not stages[-1].threadsafe:
+        stages.append(qc_stage(threadsafe))
+      stages[-1].plugins.append((i, d, p))
+    return stages
+
+  ##
+  # Runs all stages for one object.
+  # @param obj: the object
+  # @param stages: the stages
+  # @return (obj, [(qfields, algorithm) for each plugin])
+  def _process_object(self, obj, stages):
+    outcome = []
+    for stage in stages:
+      for i, name, p in stage.plugins:
+        lock = None if stage.threadsafe else self._plugin_locks[name]
+        if lock is not None:
+          lock.acquire()
+        try:
+          starttime = time.time()
+          process_result = p.process(obj, self.reprocess_quality_field, self.quality_control_mode)
+          if isinstance(process_result, tuple):
+            obj = process_result[0]
+            detector_qfields = process_result[1]
+          else:
+            obj = process_result
+            detector_qfields = p.getQualityFields()
+          na = None
+          if isinstance(obj, tuple):
+            obj,na = obj[0],obj[1]
+          if na is None:
+            na = p.algorithm()
+          self._add_timing(name, time.time() - starttime)
+        finally:
+          if lock is not None:
+            lock.release()
+        outcome.append((detector_qfields, na))
+    return obj, outcome
+
+  def _add_timing(self, name, elapsed):
+    with self._timings_lock:
+      t = self.timings.setdefault(name, [0, 0.0])
+      t[0] += 1
+      t[1] += elapsed
+
+  def _get_number_of_threads(self, nobjects):
+    nthreads = self.nthreads
+    if nthreads is None or nthreads <= 0:
+      nthreads = multiprocessing.cpu_count()
+    return max(1, min(nthreads, nobjects))
+
+  ##
+  # Runs the quality controls on the objects.
+  # @param objects: a dictionary with objects
+  # @return a tuple (dictionary with processed objects, algorithm, list of quality fields)
+  #         which is the same as is returned from compositing.quality_control_objects
+  def process(self, objects):
+    keys = list(objects.keys())
+    nthreads = self._get_number_of_threads(len(keys))
+    stages = self.create_stages(nthreads > 1)
+    outcomes = {}
+    errors = []
+
+    if nthreads == 1 or not stages:
+      for k in keys:
+        outcomes[k] = self._process_object(objects[k], stages)
+    else:
+      pending = list(keys)
+      pending_lock = threading.Lock()
+
+      def worker():
+        while True:
+          with pending_lock:
+            if not pending or errors:
+              return
+            k = pending.pop(0)
+          try:
+            outcomes[k] = self._process_object(objects[k], stages)
+          except Exception as e:
+            logger.exception("Quality control of %s failed"%k)
+            with pending_lock:
+              errors.append(e)
+
+      threads = [threading.Thread(target=worker) for i in range(nthreads - 1)]
+      for t in threads:
+        t.start()
+      worker()
+      for t in threads:
+        t.join()
+      if errors:
+        raise errors[0]
+
+    result = {}
+    algorithm = None
+    qfields = []
+    for k in keys:
+      obj, outcome = outcomes[k]
+      for detector_qfields, na in outcome:
+        for qfield in detector_qfields:
+          if qfield not in qfields:
+            qfields.append(qfield)
+        if algorithm is None and na is not None:
+          algorithm = na
+      result[k] = obj
+
+    return result, algorithm, qfields
+
+  ##
+  # @return the timings as a string, e.g. "ropo: 12 objects, 3.210 s; beamb: 12 objects, 1.020 s"
+  def timings_str(self):
+    result = []
+    for d in self.detectors:
+      if d in self.timings:
+        result.append("%s: %d objects, %.3f s"%(d, self.timings[d][0], self.timings[d][1]))
+    return "; ".join(result)
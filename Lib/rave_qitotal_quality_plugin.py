@@ -89,6 +89,11 @@ class rave_qitotal_quality_plugin(rave_quality_plugin):
         scan.addOrReplaceQualityField(result)
     
 
+  ##
+  # @return True since the qi-total is calculated from the provided object only
+  def isThreadSafe(self):
+    return True
+
   ##
   # @param obj: A rave object that should be processed, bogus in this case.
   # @param reprocess_quality_flag: Not used, we always want to reprocess qi-total
@@ -60,3 +60,10 @@ class rave_quality_plugin(object):
   #
   def algorithm(self):
     return None
+
+  ##
+  # @return: If process may be called concurrently for different objects. Default is False,
+  # plugins that only work on the provided object should return True.
+  #
+  def isThreadSafe(self):
+    return False
@@ -58,6 +58,11 @@ class radvol_att_plugin(rave_quality_plugin):
   def getQualityFields(self):
     return ["pl.imgw.radvolqc.att"]
   
+  ##
+  # @return True since radvol only works on the provided object
+  def isThreadSafe(self):
+    return True
+
   ##
   # @param obj: A RAVE object that should be processed.
   # @param reprocess_quality_flag: If quality flag should be reprocessed or not
@@ -86,6 +91,11 @@ class radvol_broad_plugin(rave_quality_plugin):
   def getQualityFields(self):
     return ["pl.imgw.radvolqc.broad"]
   
+  ##
+  # @return True since radvol only works on the provided object
+  def isThreadSafe(self):
+    return True
+
   ##
   # @param obj: A RAVE object that should be processed.
   # @param reprocess_quality_flag: If quality flag should be reprocessed or not
@@ -114,6 +124,11 @@ class radvol_nmet_plugin(rave_quality_plugin):
   def getQualityFields(self):
     return ["pl.imgw.radvolqc.nmet"]
   
+  ##
+  # @return True since radvol only works on the provided object
+  def isThreadSafe(self):
+    return True
+
   ##
   # @param obj: A RAVE object that should be processed.
   # @param reprocess_quality_flag: If quality flag should be reprocessed or not
@@ -142,6 +157,11 @@ class radvol_speck_plugin(rave_quality_plugin):
   def getQualityFields(self):
     return ["pl.imgw.radvolqc.speck"]
   
+  ##
+  # @return True since radvol only works on the provided object
+  def isThreadSafe(self):
+    return True
+
   ##
   # @param obj: A RAVE object that should be processed.
   # @param reprocess_quality_flag: If quality flag should be reprocessed or not
@@ -170,6 +190,11 @@ class radvol_spike_plugin(rave_quality_plugin):
   def getQualityFields(self):
     return ["pl.imgw.radvolqc.spike"]
   
+  ##
+  # @return True since radvol only works on the provided object
+  def isThreadSafe(self):
+    return True
+
   ##
   # @param obj: A RAVE object that should be processed.
   # @param reprocess_quality_flag: If quality flag should be reprocessed or not
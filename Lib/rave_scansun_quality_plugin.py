@@ -45,6 +45,11 @@ class scansun_quality_plugin(rave_quality_plugin):
   def getQualityFields(self):
     return ["nl.knmi.scansun"]
   
+  ##
+  # @return False since the hits are appended to one file per radar
+  def isThreadSafe(self):
+    return False
+
   ##
   # @param obj: A RAVE object that should be processed.
   # @param reprocess_quality_flag: If quality flag should be reprocessed or not
@@ -44,6 +44,11 @@ class rave_zdiff_quality_plugin(rave_quality_plugin):
   def getQualityFields(self):
     return ["eu.opera.odc.zdiff"]
   
+  ##
+  # @return True since zdiff only works on the provided object
+  def isThreadSafe(self):
+    return True
+
   ##
   # @param obj: A RAVE object that should be processed.
   # @param reprocess_quality_flag: If quality flag should be reprocessed or not
@@ -418,24 +418,26 @@ error:
 void Radvol_getName(Radvol_t* self, const char* source) {
   char* tmp = NULL;
   char* asource = NULL;
+  char* saveptr = NULL;
+  char* nodptr = NULL;
 
   RAVE_ASSERT((self != NULL), "self == NULL");
   if (source != NULL) {
     asource = RAVE_STRDUP(source);
     if (asource != NULL) {
-      tmp = strtok(asource, ",");
+      tmp = strtok_r(asource, ",", &saveptr);
       while (tmp != NULL) {
         if (strspn(tmp, "NOD") == 3) {
-          tmp = strtok(tmp, ":");
+          tmp = strtok_r(tmp, ":", &nodptr);
           if (tmp != NULL) {
-            tmp = strtok(NULL, "");
+            tmp = strtok_r(NULL, "", &nodptr);
             if (tmp != NULL) {
               RadvolInternal_setName(self, tmp);
             }
           }
           break;
         }
-        tmp = strtok(NULL, ",");
+        tmp = strtok_r(NULL, ",", &saveptr);
       }
     }
     RAVE_FREE(asource);
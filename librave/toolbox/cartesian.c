@@ -32,6 +32,7 @@ along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
 #include "rave_utilities.h"
 #include <string.h>
 #include <stdio.h>
+#include <math.h>
 #include "projection_pipeline.h"
 #include "rave_attribute_table.h"
 
@@ -764,6 +765,61 @@ RaveValueType Cartesian_getConvertedValueAtLonLat(Cartesian_t* cartesian, double
   return RaveValueType_UNDEFINED;
 }
 
+int Cartesian_getConvertedValuesAtLonLats(Cartesian_t* cartesian, long n, const double* lon, const double* lat,
+  double* values, RaveValueType* types, const char* qualityname, double* qualities)
+{
+  RaveField_t* field = NULL;
+  RaveAttribute_t* attr = NULL;
+  double qgain = 1.0, qoffset = 0.0;
+  long i = 0;
+
+  RAVE_ASSERT((cartesian != NULL), "cartesian == NULL");
+  RAVE_ASSERT((lon != NULL && lat != NULL), "lon or lat == NULL");
+  RAVE_ASSERT((values != NULL && types != NULL), "values or types == NULL");
+
+  if (cartesian->currentParameter == NULL || cartesian->pipeline == NULL) {
+    RAVE_ERROR0("Cartesian has no default parameter or projection");
+    return 0;
+  }
+
+  /* The quality field and its gain and offset are looked up once for all positions */
+  if (qualityname != NULL && qualities != NULL) {
+    field = Cartesian_findQualityFieldByHowTask(cartesian, qualityname);
+    if (field != NULL) {
+      attr = RaveField_getAttribute(field, "what/gain");
+      if (attr != NULL) {
+        RaveAttribute_getDouble(attr, &qgain);
+      }
+      RAVE_OBJECT_RELEASE(attr);
+      attr = RaveField_getAttribute(field, "what/offset");
+      if (attr != NULL) {
+        RaveAttribute_getDouble(attr, &qoffset);
+      }
+      RAVE_OBJECT_RELEASE(attr);
+    }
+  }
+
+  for (i = 0; i < n; i++) {
+    int x = 0, y = 0;
+    double qv = 0.0;
+    values[i] = 0.0;
+    types[i] = RaveValueType_UNDEFINED;
+    if (qualities != NULL) {
+      qualities[i] = NAN;
+    }
+    if (!CartesianInternal_getXYFromLonLat(cartesian, lon[i], lat[i], &x, &y)) {
+      continue;
+    }
+    types[i] = CartesianParam_getConvertedValue(cartesian->currentParameter, x, y, &values[i]);
+    if (field != NULL && RaveField_getValue(field, x, y, &qv)) {
+      qualities[i] = qv * qgain + qoffset;
+    }
+  }
+
+  RAVE_OBJECT_RELEASE(field);
+  return 1;
+}
+
 int Cartesian_getQualityValueAtLocation(Cartesian_t* cartesian, double lx, double ly, const char* name, double *v)
 {
   RaveField_t* field = NULL;
@@ -858,30 +914,20 @@ void Cartesian_init(Cartesian_t* self, Area_t* area)
 
 RaveValueType Cartesian_getMean(Cartesian_t* cartesian, long x, long y, int N, double* v)
 {
-  RaveValueType xytype = RaveValueType_NODATA;
   RAVE_ASSERT((cartesian != NULL), "cartesian == NULL");
-
-  xytype = Cartesian_getValue(cartesian, x, y, v);
-  if (xytype == RaveValueType_DATA) {
-    long xk = 0, yk = 0;
-    double sum = 0.0L;
-    int pts = 0;
-    int k = N/2;
-    double value = 0.0L;
-
-    for (yk = -k; yk < k; yk++) {
-      for (xk = -k; xk < k; xk++) {
-        xytype = Cartesian_getValue(cartesian, xk + x, yk + y, &value);
-        if (xytype == RaveValueType_DATA) {
-          sum += value;
-          pts++;
-        }
-      }
-    }
-    *v = sum / (double)pts; // we have at least 1 at pts so division by zero will not occur
+  if (cartesian->currentParameter != NULL) {
+    return CartesianParam_getMean(cartesian->currentParameter, x, y, N, v);
   }
+  return RaveValueType_UNDEFINED;
+}
 
-  return xytype;
+int Cartesian_applyMean(Cartesian_t* cartesian, int N)
+{
+  RAVE_ASSERT((cartesian != NULL), "cartesian == NULL");
+  if (cartesian->currentParameter != NULL) {
+    return CartesianParam_applyMean(cartesian->currentParameter, N);
+  }
+  return 1;
 }
 
 int Cartesian_isTransformable(Cartesian_t* cartesian)
@@ -445,6 +445,23 @@ RaveValueType Cartesian_getConvertedValueAtLocation(Cartesian_t* cartesian, doub
  */
 RaveValueType Cartesian_getConvertedValueAtLonLat(Cartesian_t* cartesian, double lon, double lat, double* v);
 
+/**
+ * Returns the converted values and optionally the converted quality values for a number of lon/lat positions.
+ * Gives the same values as calling \ref Cartesian_getConvertedValueAtLonLat and \ref Cartesian_getConvertedQualityValueAtLonLat
+ * for each position but the projection pipeline, the quality field and its gain and offset are only looked up once.
+ * @param[in] cartesian - self
+ * @param[in] n - the number of positions
+ * @param[in] lon - the longitudes (in radians), n items
+ * @param[in] lat - the latitudes (in radians), n items
+ * @param[out] values - the converted values, n items
+ * @param[out] types - the type of each value, n items
+ * @param[in] qualityname - the how/task of the quality field (MAY BE NULL)
+ * @param[out] qualities - the converted quality values, n items. NaN when there is no quality value (MAY BE NULL)
+ * @return 1 on success, 0 if the cartesian has no default parameter or projection
+ */
+int Cartesian_getConvertedValuesAtLonLats(Cartesian_t* cartesian, long n, const double* lon, const double* lat,
+  double* values, RaveValueType* types, const char* qualityname, double* qualities);
+
 /**
  * Returns the quality value at the specified location from the specified quality field. First the code
  * tests if the quality field exist in the default param. If not, it will check for the quality field
@@ -518,6 +535,15 @@ void Cartesian_init(Cartesian_t* cartesian, Area_t* area);
  */
 RaveValueType Cartesian_getMean(Cartesian_t* cartesian, long x, long y, int N, double* v);
 
+/**
+ * Replaces every value of type DATA in the current parameter with the mean over the NxN square around it,
+ * see \ref #CartesianParam_applyMean. Nothing is done if there is no current parameter.
+ * @param[in] cartesian - the cartesian product
+ * @param[in] N - the N size
+ * @return 1 on success otherwise 0
+ */
+int Cartesian_applyMean(Cartesian_t* cartesian, int N);
+
 /**
  * Verifies that all preconditions are met in order to perform
  * a transformation.
@@ -704,12 +704,12 @@ static int CartesianOdimIOInternal_addParameterToNodeList(CartesianOdimIO_t* sel
     goto done;
   }
 
-  if (!RaveHL_addData(nodelist,
-                      CartesianParam_getData(param),
-                      CartesianParam_getXSize(param),
-                      CartesianParam_getYSize(param),
-                      CartesianParam_getDataType(param),
-                      nodeName)) {
+  if (!RaveHL_addBorrowedData(nodelist,
+                              (void*)CartesianParam_getReadOnlyData(param),
+                              CartesianParam_getXSize(param),
+                              CartesianParam_getYSize(param),
+                              CartesianParam_getDataType(param),
+                              nodeName)) {
     goto done;
   }
 
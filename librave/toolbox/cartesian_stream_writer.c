@@ -0,0 +1,493 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of RAVE.
+
+RAVE is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RAVE is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+/**
+ * Writes a cartesian product as ODIM H5 one block of rows at a time.
+ * @file
+ * @date 2026-10-17
+ */
+#include "cartesian_stream_writer.h"
+#include "cartesian_odim_io.h"
+#include "rave_hlhdf_utilities.h"
+#include "rave_debug.h"
+#include "rave_alloc.h"
+#include "hlhdf.h"
+#include <string.h>
+#include <stdarg.h>
+
+/**
+ * Represents the writer
+ */
+struct _CartesianStreamWriter_t {
+  RAVE_OBJECT_HEAD /** Always on top */
+  RaveIO_ODIM_Version version; /**< the odim version */
+  int compressionLevel;        /**< the zlib compression level */
+  char* filename;              /**< the file to write */
+  Area_t* area;                /**< the area of the full product */
+  hid_t file;                  /**< the file when it has been created */
+  long rowsWritten;            /**< number of written rows */
+  char* signature;             /**< the metadata of the first block that all other blocks must agree with */
+};
+
+/*@{ Private functions */
+static int CartesianStreamWriter_constructor(RaveCoreObject* obj)
+{
+  CartesianStreamWriter_t* this = (CartesianStreamWriter_t*)obj;
+  this->version = RaveIO_ODIM_Version_2_4;
+  this->compressionLevel = 6;
+  this->filename = NULL;
+  this->area = NULL;
+  this->file = -1;
+  this->rowsWritten = 0;
+  this->signature = NULL;
+  return 1;
+}
+
+/**
+ * Closes the file if it is open.
+ * @param[in] self - self
+ * @return 1 on success or if no file was open, otherwise 0
+ */
+static int CartesianStreamWriterInternal_closeFile(CartesianStreamWriter_t* self)
+{
+  int result = 1;
+  if (self->file >= 0) {
+    RaveHL_lock();
+    result = (H5Fclose(self->file) >= 0) ? 1 : 0;
+    RaveHL_unlock();
+    self->file = -1;
+  }
+  return result;
+}
+
+static void CartesianStreamWriter_destructor(RaveCoreObject* obj)
+{
+  CartesianStreamWriter_t* this = (CartesianStreamWriter_t*)obj;
+  CartesianStreamWriterInternal_closeFile(this);
+  RAVE_FREE(this->filename);
+  RAVE_FREE(this->signature);
+  RAVE_OBJECT_RELEASE(this->area);
+}
+
+/**
+ * Appends formatted text to a signature.
+ * @param[in,out] sig - the signature, reallocated as needed
+ * @param[in,out] len - the current length of the signature
+ * @param[in] fmt - the format
+ * @param[in] ... - the varargs
+ * @return 1 on success otherwise 0
+ */
+static int CartesianStreamWriterInternal_appendSignature(char** sig, size_t* len, const char* fmt, ...)
+{
+  char buff[1024];
+  char* tmp = NULL;
+  va_list ap;
+  int n = 0;
+
+  va_start(ap, fmt);
+  n = vsnprintf(buff, 1024, fmt, ap);
+  va_end(ap);
+  if (n < 0 || n >= 1024) {
+    RAVE_ERROR0("Metadata would evaluate to more than 1024 characters.");
+    return 0;
+  }
+  tmp = RAVE_REALLOC(*sig, *len + n + 1);
+  if (tmp == NULL) {
+    RAVE_ERROR0("Failed to allocate memory for block signature");
+    return 0;
+  }
+  memcpy(tmp + *len, buff, n + 1);
+  *sig = tmp;
+  *len += n;
+  return 1;
+}
+
+/**
+ * Appends the data type and how/task of each field to the signature.
+ * @param[in,out] sig - the signature
+ * @param[in,out] len - the current length of the signature
+ * @param[in] fields - the quality fields
+ * @return 1 on success otherwise 0
+ */
+static int CartesianStreamWriterInternal_appendFieldsSignature(char** sig, size_t* len, RaveObjectList_t* fields)
+{
+  int i = 0, nfields = 0, result = 1;
+
+  nfields = RaveObjectList_size(fields);
+  for (i = 0; result && i < nfields; i++) {
+    RaveField_t* field = (RaveField_t*)RaveObjectList_get(fields, i);
+    RaveAttribute_t* attr = RaveField_getAttribute(field, "how/task");
+    char* task = NULL;
+    if (attr != NULL) {
+      RaveAttribute_getString(attr, &task);
+    }
+    result = CartesianStreamWriterInternal_appendSignature(sig, len, "[%s:%d]", task != NULL ? task : "", (int)RaveField_getDataType(field));
+    RAVE_OBJECT_RELEASE(attr);
+    RAVE_OBJECT_RELEASE(field);
+  }
+  return result;
+}
+
+/**
+ * Describes everything in a block that ends up in the metadata written from the first block,
+ * i.e. what must be the same in all blocks for the rows to end up in the right datasets.
+ * @param[in] block - the block
+ * @return the signature or NULL on failure
+ */
+static char* CartesianStreamWriterInternal_createSignature(Cartesian_t* block)
+{
+  RaveList_t* names = NULL;
+  RaveObjectList_t* fields = NULL;
+  char* sig = NULL;
+  size_t len = 0;
+  int i = 0, n = 0, ok = 0;
+
+  if (!CartesianStreamWriterInternal_appendSignature(&sig, &len, "%d|%s|%s|%s|%s|%f|%f|%ld",
+        (int)Cartesian_getProduct(block),
+        Cartesian_getDate(block) != NULL ? Cartesian_getDate(block) : "",
+        Cartesian_getTime(block) != NULL ? Cartesian_getTime(block) : "",
+        Cartesian_getSource(block) != NULL ? Cartesian_getSource(block) : "",
+        Cartesian_getProjectionString(block) != NULL ? Cartesian_getProjectionString(block) : "",
+        Cartesian_getXScale(block), Cartesian_getYScale(block), Cartesian_getXSize(block))) {
+    goto done;
+  }
+
+  if ((names = Cartesian_getParameterNames(block)) == NULL) {
+    goto done;
+  }
+  n = RaveList_size(names);
+  for (i = 0; i < n; i++) {
+    CartesianParam_t* param = Cartesian_getParameter(block, (const char*)RaveList_get(names, i));
+    int pok = 0;
+    if (param != NULL &&
+        CartesianStreamWriterInternal_appendSignature(&sig, &len, "|%s:%d:%f:%f:%f:%f", CartesianParam_getQuantity(param),
+          (int)CartesianParam_getDataType(param), CartesianParam_getGain(param), CartesianParam_getOffset(param),
+          CartesianParam_getNodata(param), CartesianParam_getUndetect(param))) {
+      fields = CartesianParam_getQualityFields(param);
+      pok = (fields != NULL && CartesianStreamWriterInternal_appendFieldsSignature(&sig, &len, fields));
+      RAVE_OBJECT_RELEASE(fields);
+    }
+    RAVE_OBJECT_RELEASE(param);
+    if (!pok) {
+      goto done;
+    }
+  }
+
+  if ((fields = Cartesian_getQualityFields(block)) == NULL ||
+      !CartesianStreamWriterInternal_appendSignature(&sig, &len, "|") ||
+      !CartesianStreamWriterInternal_appendFieldsSignature(&sig, &len, fields)) {
+    goto done;
+  }
+
+  ok = 1;
+done:
+  RaveList_freeAndDestroy(&names);
+  RAVE_OBJECT_RELEASE(fields);
+  if (!ok) {
+    RAVE_FREE(sig);
+  }
+  return sig;
+}
+
+/**
+ * Creates the file with all metadata using the first block. The datasets are made as high
+ * as the full area and the rows of the first block are written.
+ * @param[in] self - self
+ * @param[in] block - the first block
+ * @return 1 on success otherwise 0
+ */
+static int CartesianStreamWriterInternal_createFile(CartesianStreamWriter_t* self, Cartesian_t* block)
+{
+  Cartesian_t* header = NULL;
+  CartesianOdimIO_t* odimio = NULL;
+  HL_NodeList* nodelist = NULL;
+  HL_Compression* compression = NULL;
+  HL_FileCreationProperty* property = NULL;
+  double llX = 0.0, llY = 0.0, urX = 0.0, urY = 0.0;
+  int result = 0;
+
+  header = RAVE_OBJECT_CLONE(block);
+  odimio = RAVE_OBJECT_NEW(&CartesianOdimIO_TYPE);
+  compression = HLCompression_new(self->compressionLevel > 0 ? CT_ZLIB : CT_NONE);
+  property = RaveHL_createFileCreationProperty();
+  if (header == NULL || odimio == NULL || compression == NULL || property == NULL) {
+    RAVE_ERROR0("Failed to allocate memory for writing header");
+    goto done;
+  }
+
+  /* The metadata should describe the full area while the data comes from the block */
+  Area_getExtent(self->area, &llX, &llY, &urX, &urY);
+  Cartesian_setYSize(header, Area_getYSize(self->area));
+  Cartesian_setAreaExtent(header, llX, llY, urX, urY);
+
+  compression->level = self->compressionLevel;
+
+  CartesianOdimIO_setVersion(odimio, self->version);
+
+  RaveHL_lock();
+  nodelist = HLNodeList_new();
+  if (nodelist == NULL) {
+    RAVE_ERROR0("Failed to create nodelist");
+  } else if (!RaveHL_beginBorrowedData(nodelist, compression) ||
+             !RaveHL_setBorrowedDataRows(nodelist, Area_getYSize(self->area))) {
+    RAVE_ERROR0("Failed to prepare nodelist for writing blocks");
+  } else if (!CartesianOdimIO_fillImage(odimio, nodelist, header)) {
+    RAVE_ERROR1("Failed to create metadata: %s", CartesianOdimIO_getErrorMessage(odimio));
+  } else if (!HLNodeList_setFileName(nodelist, self->filename) ||
+             !HLNodeList_write(nodelist, property, compression) ||
+             !RaveHL_writeBorrowedData(nodelist, compression)) {
+    RAVE_ERROR1("Failed to write %s", self->filename);
+  } else {
+    self->file = H5Fopen(self->filename, H5F_ACC_RDWR, H5P_DEFAULT);
+    if (self->file < 0) {
+      RAVE_ERROR1("Failed to reopen %s", self->filename);
+    } else {
+      result = 1;
+    }
+  }
+  if (nodelist != NULL) {
+    RaveHL_endBorrowedData(nodelist);
+    HLNodeList_free(nodelist);
+  }
+  RaveHL_unlock();
+
+done:
+  HLCompression_free(compression);
+  HLFileCreationProperty_free(property);
+  RAVE_OBJECT_RELEASE(odimio);
+  RAVE_OBJECT_RELEASE(header);
+  return result;
+}
+
+/**
+ * Writes the rows of the fields in the list. Fields are named as by the ODIM writer, i.e. <name>/quality<n>/data.
+ * @param[in] self - self
+ * @param[in] fields - the quality fields
+ * @param[in] yoffset - the first row
+ * @param[in] fmt - the name of the group containing the fields
+ * @param[in] ... - the varargs
+ * @return 1 on success otherwise 0
+ */
+static int CartesianStreamWriterInternal_writeFields(CartesianStreamWriter_t* self, RaveObjectList_t* fields, long yoffset, const char* fmt, ...)
+{
+  char name[1024];
+  va_list ap;
+  int n = 0, i = 0, nfields = 0;
+  int result = 1;
+
+  va_start(ap, fmt);
+  n = vsnprintf(name, 1024, fmt, ap);
+  va_end(ap);
+  if (n < 0 || n >= 1000) {
+    RAVE_ERROR0("NodeName would evaluate to more than 1024 characters.");
+    return 0;
+  }
+
+  nfields = RaveObjectList_size(fields);
+  for (i = 0; result == 1 && i < nfields; i++) {
+    RaveField_t* field = (RaveField_t*)RaveObjectList_get(fields, i);
+    char fieldname[1024];
+    snprintf(fieldname, 1024, "%s/quality%d/data", name, i+1);
+    result = RaveHL_writeDataRows(self->file, fieldname, (void*)RaveField_getReadOnlyData(field),
+                                  RaveField_getXsize(field), RaveField_getYsize(field),
+                                  RaveField_getDataType(field), yoffset);
+    RAVE_OBJECT_RELEASE(field);
+  }
+  return result;
+}
+
+/**
+ * Writes the rows of all parameters and quality fields in the block into the open file.
+ * @param[in] self - self
+ * @param[in] block - the block
+ * @param[in] yoffset - the first row
+ * @return 1 on success otherwise 0
+ */
+static int CartesianStreamWriterInternal_writeRows(CartesianStreamWriter_t* self, Cartesian_t* block, long yoffset)
+{
+  RaveList_t* names = NULL;
+  RaveObjectList_t* fields = NULL;
+  int i = 0, n = 0;
+  int result = 0;
+
+  if ((names = Cartesian_getParameterNames(block)) == NULL) {
+    goto done;
+  }
+  n = RaveList_size(names);
+  for (i = 0; i < n; i++) {
+    CartesianParam_t* param = Cartesian_getParameter(block, (const char*)RaveList_get(names, i));
+    char name[1024];
+    int ok = 0;
+    snprintf(name, 1024, "/dataset1/data%d/data", i+1);
+    if (param != NULL &&
+        RaveHL_writeDataRows(self->file, name, (void*)CartesianParam_getReadOnlyData(param),
+                             CartesianParam_getXSize(param), CartesianParam_getYSize(param),
+                             CartesianParam_getDataType(param), yoffset)) {
+      fields = CartesianParam_getQualityFields(param);
+      ok = (fields != NULL && CartesianStreamWriterInternal_writeFields(self, fields, yoffset, "/dataset1/data%d", i+1));
+      RAVE_OBJECT_RELEASE(fields);
+    }
+    RAVE_OBJECT_RELEASE(param);
+    if (!ok) {
+      goto done;
+    }
+  }
+
+  if ((fields = Cartesian_getQualityFields(block)) == NULL ||
+      !CartesianStreamWriterInternal_writeFields(self, fields, yoffset, "/dataset1")) {
+    goto done;
+  }
+
+  result = 1;
+done:
+  RaveList_freeAndDestroy(&names);
+  RAVE_OBJECT_RELEASE(fields);
+  return result;
+}
+
+/*@} End of Private functions */
+
+/*@{ Interface functions */
+void CartesianStreamWriter_setVersion(CartesianStreamWriter_t* self, RaveIO_ODIM_Version version)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  self->version = version;
+}
+
+RaveIO_ODIM_Version CartesianStreamWriter_getVersion(CartesianStreamWriter_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return self->version;
+}
+
+int CartesianStreamWriter_setCompressionLevel(CartesianStreamWriter_t* self, int level)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  if (level < 0 || level > 9) {
+    return 0;
+  }
+  self->compressionLevel = level;
+  return 1;
+}
+
+int CartesianStreamWriter_getCompressionLevel(CartesianStreamWriter_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return self->compressionLevel;
+}
+
+int CartesianStreamWriter_open(CartesianStreamWriter_t* self, const char* filename, Area_t* area)
+{
+  char* tmp = NULL;
+  RAVE_ASSERT((self != NULL), "self == NULL");
+
+  if (filename == NULL || area == NULL) {
+    RAVE_ERROR0("Must specify both filename and area");
+    return 0;
+  }
+  if (!CartesianStreamWriterInternal_closeFile(self)) {
+    RAVE_WARNING1("Failed to close previous file %s", self->filename);
+  }
+  if ((tmp = RAVE_STRDUP(filename)) == NULL) {
+    RAVE_ERROR0("Failed to allocate memory for filename");
+    return 0;
+  }
+  RAVE_FREE(self->filename);
+  self->filename = tmp;
+  RAVE_OBJECT_RELEASE(self->area);
+  self->area = RAVE_OBJECT_COPY(area);
+  self->rowsWritten = 0;
+  RAVE_FREE(self->signature);
+  return 1;
+}
+
+int CartesianStreamWriter_writeBlock(CartesianStreamWriter_t* self, Cartesian_t* block, long yoffset)
+{
+  char* signature = NULL;
+  int result = 0;
+
+  RAVE_ASSERT((self != NULL), "self == NULL");
+
+  if (block == NULL || self->area == NULL) {
+    RAVE_ERROR0("Writer has not been opened or no block provided");
+    return 0;
+  }
+  if (Cartesian_getXSize(block) != Area_getXSize(self->area) ||
+      yoffset < 0 || yoffset + Cartesian_getYSize(block) > Area_getYSize(self->area)) {
+    RAVE_ERROR1("Block at row %ld does not fit into area", yoffset);
+    return 0;
+  }
+
+  signature = CartesianStreamWriterInternal_createSignature(block);
+  if (signature == NULL) {
+    return 0;
+  }
+
+  if (self->file < 0) {
+    if (yoffset != 0) {
+      RAVE_ERROR0("First block must start at row 0");
+      goto done;
+    }
+    if (!CartesianStreamWriterInternal_createFile(self, block)) {
+      goto done;
+    }
+    RAVE_FREE(self->signature);
+    self->signature = signature;
+    signature = NULL;
+  } else {
+    if (self->signature == NULL || strcmp(self->signature, signature) != 0) {
+      RAVE_ERROR1("Block at row %ld does not have the same metadata, parameters and quality fields as the first block", yoffset);
+      goto done;
+    }
+    if (!CartesianStreamWriterInternal_writeRows(self, block, yoffset)) {
+      goto done;
+    }
+  }
+  self->rowsWritten += Cartesian_getYSize(block);
+  result = 1;
+done:
+  RAVE_FREE(signature);
+  return result;
+}
+
+int CartesianStreamWriter_close(CartesianStreamWriter_t* self)
+{
+  int result = 0;
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  result = CartesianStreamWriterInternal_closeFile(self);
+  if (self->area != NULL && self->rowsWritten != Area_getYSize(self->area)) {
+    RAVE_ERROR2("Only %ld of %ld rows written", self->rowsWritten, Area_getYSize(self->area));
+    result = 0;
+  }
+  return result;
+}
+
+int CartesianStreamWriter_blockWriter(void* writer, Cartesian_t* block, long yoffset)
+{
+  return CartesianStreamWriter_writeBlock((CartesianStreamWriter_t*)writer, block, yoffset);
+}
+
+/*@} End of Interface functions */
+
+RaveCoreObjectType CartesianStreamWriter_TYPE = {
+    "CartesianStreamWriter",
+    sizeof(CartesianStreamWriter_t),
+    CartesianStreamWriter_constructor,
+    CartesianStreamWriter_destructor,
+    NULL
+};
@@ -0,0 +1,110 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of RAVE.
+
+RAVE is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RAVE is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+/**
+ * Writes a cartesian product as ODIM H5 one block of rows at a time. Used together
+ * with \ref Composite_generateBlocks so that large composites never have to be kept
+ * in memory as a whole.
+ * @file
+ * @date 2026-10-17
+ */
+#ifndef CARTESIAN_STREAM_WRITER_H
+#define CARTESIAN_STREAM_WRITER_H
+#include "rave_object.h"
+#include "rave_types.h"
+#include "cartesian.h"
+#include "area.h"
+
+/**
+ * Defines the stream writer
+ */
+typedef struct _CartesianStreamWriter_t CartesianStreamWriter_t;
+
+/**
+ * Type definition to use when creating a rave object.
+ */
+extern RaveCoreObjectType CartesianStreamWriter_TYPE;
+
+/**
+ * Sets the ODIM version to write. Default is \ref RaveIO_ODIM_Version_2_4.
+ * @param[in] self - self
+ * @param[in] version - the version
+ */
+void CartesianStreamWriter_setVersion(CartesianStreamWriter_t* self, RaveIO_ODIM_Version version);
+
+/**
+ * Returns the ODIM version to write.
+ * @param[in] self - self
+ * @return the version
+ */
+RaveIO_ODIM_Version CartesianStreamWriter_getVersion(CartesianStreamWriter_t* self);
+
+/**
+ * Sets the zlib compression level, 0 means no compression. Default is 6.
+ * @param[in] self - self
+ * @param[in] level - the level, 0 - 9
+ * @return 1 if level is within 0 - 9, otherwise 0
+ */
+int CartesianStreamWriter_setCompressionLevel(CartesianStreamWriter_t* self, int level);
+
+/**
+ * Returns the zlib compression level.
+ * @param[in] self - self
+ * @return the level
+ */
+int CartesianStreamWriter_getCompressionLevel(CartesianStreamWriter_t* self);
+
+/**
+ * Prepares for writing a product covering the area to filename. The file itself is created
+ * when the first block is written.
+ * @param[in] self - self
+ * @param[in] filename - the file to write
+ * @param[in] area - the area of the full product
+ * @return 1 on success otherwise 0
+ */
+int CartesianStreamWriter_open(CartesianStreamWriter_t* self, const char* filename, Area_t* area);
+
+/**
+ * Writes one block of rows. The first block must start at row 0 and defines the metadata,
+ * parameters and quality fields of the product. All following blocks must contain the same
+ * parameters and quality fields and have the same or fewer number of rows.
+ * @param[in] self - self
+ * @param[in] block - the block
+ * @param[in] yoffset - the row in the full product of the first row in the block
+ * @return 1 on success otherwise 0
+ */
+int CartesianStreamWriter_writeBlock(CartesianStreamWriter_t* self, Cartesian_t* block, long yoffset);
+
+/**
+ * Closes the file.
+ * @param[in] self - self
+ * @return 1 if all rows have been written and the file could be closed, otherwise 0
+ */
+int CartesianStreamWriter_close(CartesianStreamWriter_t* self);
+
+/**
+ * Same as \ref CartesianStreamWriter_writeBlock but with a signature that can be passed
+ * as writer to \ref Composite_generateBlocks.
+ * @param[in] writer - the CartesianStreamWriter_t
+ * @param[in] block - the block
+ * @param[in] yoffset - the row in the full product of the first row in the block
+ * @return 1 on success otherwise 0
+ */
+int CartesianStreamWriter_blockWriter(void* writer, Cartesian_t* block, long yoffset);
+
+#endif /* CARTESIAN_STREAM_WRITER_H */
@@ -32,7 +32,9 @@ along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
 #include "rave_utilities.h"
 #include "rave_types.h"
 #include <string.h>
+#include <math.h>
 #include "rave_attribute_table.h"
+#include "rave_hlhdf_utilities.h"
 
 /**
  * Represents the cartesian field product.
@@ -93,13 +95,18 @@ fail:
 static RaveData2D_t* CartesianParamInternal_ensureData2D(CartesianParam_t* self)
 {
   if (self->lazyDataset != NULL) {
-    RaveData2D_t* loaded = LazyDataset_get(self->lazyDataset);
-    if (loaded != NULL) {
-      RAVE_OBJECT_RELEASE(self->data);
-      self->data = RAVE_OBJECT_COPY(loaded);
-      RAVE_OBJECT_RELEASE(self->lazyDataset);
+    /* Lazy loading is serialized so that threads sharing this parameter will not load it twice */
+    RaveHL_lock();
+    if (self->lazyDataset != NULL) {
+      RaveData2D_t* loaded = LazyDataset_get(self->lazyDataset);
+      if (loaded != NULL) {
+        RAVE_OBJECT_RELEASE(self->data);
+        self->data = RAVE_OBJECT_COPY(loaded);
+        RAVE_OBJECT_RELEASE(self->lazyDataset);
+      }
+      RAVE_OBJECT_RELEASE(loaded);
     }
-    RAVE_OBJECT_RELEASE(loaded);
+    RaveHL_unlock();
   }
   return self->data;
 }
@@ -160,29 +167,44 @@ static void CartesianParam_destructor(RaveCoreObject* obj)
 /*@{ Interface functions */
 long CartesianParam_getXSize(CartesianParam_t* self)
 {
+  long result = 0;
   RAVE_ASSERT((self != NULL), "self == NULL");
+  RaveHL_lock(); /* a concurrent lazy load releases the lazy dataset under this lock */
   if (self->lazyDataset != NULL) {
-    return LazyDataset_getXsize(self->lazyDataset);
+    result = LazyDataset_getXsize(self->lazyDataset);
+  } else {
+    result = RaveData2D_getXsize(self->data);
   }
-  return RaveData2D_getXsize(self->data);
+  RaveHL_unlock();
+  return result;
 }
 
 long CartesianParam_getYSize(CartesianParam_t* self)
 {
+  long result = 0;
   RAVE_ASSERT((self != NULL), "self == NULL");
+  RaveHL_lock(); /* a concurrent lazy load releases the lazy dataset under this lock */
   if (self->lazyDataset != NULL) {
-    return LazyDataset_getYsize(self->lazyDataset);
+    result = LazyDataset_getYsize(self->lazyDataset);
+  } else {
+    result = RaveData2D_getYsize(self->data);
   }
-  return RaveData2D_getYsize(self->data);
+  RaveHL_unlock();
+  return result;
 }
 
 RaveDataType CartesianParam_getDataType(CartesianParam_t* self)
 {
+  RaveDataType result = RaveDataType_UNDEFINED;
   RAVE_ASSERT((self != NULL), "self == NULL");
+  RaveHL_lock(); /* a concurrent lazy load releases the lazy dataset under this lock */
   if (self->lazyDataset != NULL) {
-    return LazyDataset_getDataType(self->lazyDataset);
+    result = LazyDataset_getDataType(self->lazyDataset);
+  } else {
+    result = RaveData2D_getType(self->data);
   }
-  return RaveData2D_getType(self->data);
+  RaveHL_unlock();
+  return result;
 }
 
 int CartesianParam_setQuantity(CartesianParam_t* self, const char* quantity)
@@ -279,7 +301,7 @@ int CartesianParam_setData(CartesianParam_t* self, long xsize, long ysize, void*
 int CartesianParam_setLazyDataset(CartesianParam_t* self, LazyDataset_t* lazyDataset)
 {
   RAVE_ASSERT((self != NULL), "self == NULL");
-  if (RaveData2D_getData(self->data) == NULL) {
+  if (RaveData2D_getReadOnlyData(self->data) == NULL) {
     self->lazyDataset = RAVE_OBJECT_COPY(lazyDataset);
     return 1;
   } else {
@@ -305,13 +327,24 @@ void* CartesianParam_getData(CartesianParam_t* self)
   return RaveData2D_getData(CartesianParamInternal_ensureData2D(self));
 }
 
+const void* CartesianParam_getReadOnlyData(CartesianParam_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return RaveData2D_getReadOnlyData(CartesianParamInternal_ensureData2D(self));
+}
+
 RaveDataType CartesianParam_getType(CartesianParam_t* self)
 {
+  RaveDataType result = RaveDataType_UNDEFINED;
   RAVE_ASSERT((self != NULL), "self == NULL");
+  RaveHL_lock(); /* a concurrent lazy load releases the lazy dataset under this lock */
   if (self->lazyDataset != NULL) {
-    return LazyDataset_getDataType(self->lazyDataset);
+    result = LazyDataset_getDataType(self->lazyDataset);
+  } else {
+    result = RaveData2D_getType(self->data);
   }
-  return RaveData2D_getType(self->data);
+  RaveHL_unlock();
+  return result;
 }
 
 int CartesianParam_setValue(CartesianParam_t* self, long x, long y, double v)
@@ -405,6 +438,64 @@ RaveValueType CartesianParam_getMean(CartesianParam_t* self, long x, long y, int
   return xytype;
 }
 
+int CartesianParam_applyMean(CartesianParam_t* self, int N)
+{
+  RaveData2D_t *data = NULL, *mask = NULL, *mean = NULL;
+  long xsize = 0, ysize = 0, x = 0, y = 0;
+  int k = N/2;
+  int result = 0;
+
+  RAVE_ASSERT((self != NULL), "self == NULL");
+
+  data = CartesianParamInternal_ensureData2D(self);
+  if (data == NULL || !RaveData2D_hasData(data)) {
+    RAVE_ERROR0("Parameter has no data");
+    return 0;
+  }
+  xsize = RaveData2D_getXsize(data);
+  ysize = RaveData2D_getYsize(data);
+
+  mask = RaveData2D_zeros(xsize, ysize, RaveDataType_UCHAR);
+  if (mask == NULL) {
+    goto done;
+  }
+  for (y = 0; y < ysize; y++) {
+    for (x = 0; x < xsize; x++) {
+      double value = 0.0;
+      RaveData2D_getValueUnchecked(data, x, y, &value);
+      if (value != self->nodata && value != self->undetect) {
+        RaveData2D_setValueUnchecked(mask, x, y, 1.0);
+      }
+    }
+  }
+
+  /* Same square as CartesianParam_getMean, i.e. -N/2 .. N/2-1. An empty square gives NaN just like getMean */
+  if (k > 0 && !RaveData2D_boxStatistics(data, mask, -k, k - 1, -k, k - 1, &mean, NULL, NULL)) {
+    goto done;
+  }
+
+  for (y = 0; y < ysize; y++) {
+    for (x = 0; x < xsize; x++) {
+      double m = 0.0, value = NAN;
+      RaveData2D_getValueUnchecked(mask, x, y, &m);
+      if (m != 0.0) {
+        if (mean != NULL) {
+          RaveData2D_getValueUnchecked(mean, x, y, &value);
+        }
+        if (!RaveData2D_setValueUnchecked(data, x, y, value)) {
+          goto done;
+        }
+      }
+    }
+  }
+
+  result = 1;
+done:
+  RAVE_OBJECT_RELEASE(mask);
+  RAVE_OBJECT_RELEASE(mean);
+  return result;
+}
+
 int CartesianParam_addAttribute(CartesianParam_t* self, RaveAttribute_t* attribute)
 {
   RAVE_ASSERT((self != NULL), "self == NULL");
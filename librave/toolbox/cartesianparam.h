@@ -182,12 +182,21 @@ int CartesianParam_setLazyDataset(CartesianParam_t* self, LazyDataset_t* lazyDat
 int CartesianParam_createData(CartesianParam_t* self, long xsize, long ysize, RaveDataType type, double value);
 
 /**
- * Returns a pointer to the internal data storage.
+ * Returns a pointer to the internal data storage. If the data is shared with a clone
+ * it is copied first since the caller may modify it.
  * @param[in] self - self
  * @return the internal data pointer (NOTE! Do not release this pointer)
  */
 void* CartesianParam_getData(CartesianParam_t* self);
 
+/**
+ * Returns a pointer to the internal data storage that must not be modified. A data
+ * array that is shared with a clone is not copied.
+ * @param[in] self - self
+ * @return the internal data pointer (NOTE! Do not release this pointer)
+ */
+const void* CartesianParam_getReadOnlyData(CartesianParam_t* self);
+
 /**
  * Returns the data type
  * @param[in] self - self
@@ -242,6 +251,16 @@ RaveValueType CartesianParam_getConvertedValue(CartesianParam_t* self, long x, l
  */
 RaveValueType CartesianParam_getMean(CartesianParam_t* self, long x, long y, int N, double* v);
 
+/**
+ * Replaces every value of type DATA with the mean over the NxN square around it, the same square and
+ * exclusion of nodata / undetect as in \ref #CartesianParam_getMean. Nodata and undetect are left untouched.
+ * Uses summed area tables so the cost does not depend on N.
+ * @param[in] self - self
+ * @param[in] N - the N size
+ * @return 1 on success otherwise 0
+ */
+int CartesianParam_applyMean(CartesianParam_t* self, int N);
+
 /**
  * Adds a rave attribute to the cartesian product. If attribute maps to the
  * member attributes it will be used to set the specific member
@@ -31,9 +31,17 @@ along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
 #include "projection_pipeline.h"
 #include <string.h>
 #include "rave_field.h"
+#include "lazy_dataset.h"
+#include "raveutil.h"
+#include "rave_stats.h"
+#include "polarcube.h"
+#include "rave_rowpool.h"
 #include <float.h>
 #include <stdio.h>
 #include <math.h>
+#ifdef PTHREAD_SUPPORTED
+#include <pthread.h>
+#endif
 
 
 #define MAX_NO_OF_SURROUNDING_POSITIONS 8 // pow(2, NO_OF_COMPOSITE_INTERPOLATION_DIMENSIONS)
@@ -54,6 +62,9 @@ struct _Composite_t {
   RaveList_t* objectList;
   CompositeAlgorithm_t* algorithm; /**< the specific algorithm */
   char* qiFieldName; /**< the Quality Indicator field name to use when determining the radar usage */
+  int lazyQuality; /**< if quality fields should be derived on demand from a compact store, default 0 */
+  double threshold; /**< the reflectivity threshold when generating etop, default 20 dBZ */
+  int nthreads; /**< number of threads when generating etop and vil, default 1 */
 };
 
 typedef struct CompositeRadarItem {
@@ -134,7 +145,35 @@ typedef int (*FUNC_PREPARE_VALUEPOS)(Composite_t*, RaveCoreObject*, const char*,
 /** The name of the task for indexing the radars used */
 #define RADAR_INDEX_HOW_TASK "se.smhi.composite.index.radar"
 
+#ifdef PTHREAD_SUPPORTED
+/**
+ * Serializes the sorting of the input volumes since the same volume might be used by several composites
+ * that are generated at the same time.
+ */
+static pthread_mutex_t composite_sort_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
 /*@{ Private functions */
+/**
+ * Sorts the scans of a volume in ascending elevation unless they already are. Volumes that are sorted
+ * are left untouched so that they can be read by concurrent generations while another thread checks them.
+ * @param[in] obj - the composite object, anything but a volume is ignored (may be NULL)
+ */
+static void CompositeInternal_ensureAscendingScans(RaveCoreObject* obj)
+{
+  if (obj != NULL && RAVE_OBJECT_CHECK_TYPE(obj, &PolarVolume_TYPE)) {
+#ifdef PTHREAD_SUPPORTED
+    pthread_mutex_lock(&composite_sort_mutex);
+#endif
+    if (!PolarVolume_isAscendingScans((PolarVolume_t*)obj)) {
+      PolarVolume_sortByElevations((PolarVolume_t*)obj, 1);
+    }
+#ifdef PTHREAD_SUPPORTED
+    pthread_mutex_unlock(&composite_sort_mutex);
+#endif
+  }
+}
+
 /**
  * Creates a parameter that should be composited
  * @param[in] name - quantity
@@ -415,9 +454,451 @@ done:
 
 }
 
-static RaveField_t* CompositeInternal_createQualityField(char* howtaskstr, int xsize, int ysize, double gain, double offset) {
+/**
+ * Radar index in a quality record when no radar contributed to the pixel.
+ */
+#define COMPOSITE_QUALITY_NO_RADAR UCHAR_MAX
+
+/**
+ * Max index that fits in the ray and bin indexes of a quality record.
+ */
+#define COMPOSITE_QUALITY_MAX_INDEX USHRT_MAX
+
+/**
+ * Compact record of what the quality information of one pixel is derived from.
+ */
+typedef struct CompositeQualityRecord_t {
+  unsigned short ri;        /**< range index */
+  unsigned short ai;        /**< azimuth index */
+  unsigned char ei;         /**< elevation index */
+  unsigned char radarindex; /**< radar index in list of radars, COMPOSITE_QUALITY_NO_RADAR if no radar contributed */
+  unsigned char distance;   /**< distance to radar, scaled as in the distance quality field */
+  unsigned char height;     /**< height of the bin, scaled as in the height quality field */
+} CompositeQualityRecord_t;
+
+/**
+ * The quality fields with one how/task value of all radars and scans, taken when the composite is generated.
+ */
+typedef struct CompositeQualitySnapshot_t {
+  char* name;           /**< the how/task value */
+  RaveField_t** fields; /**< the quality field of each scan, indexed by scanOffset[radarindex] + ei, may contain NULL */
+} CompositeQualitySnapshot_t;
+
+/**
+ * Keeps the compact quality records for one parameter together with the quality fields they refer to so
+ * that the quality fields of the composite can be derived when they are requested instead of during generation.
+ * The quality fields are clones of the ones in the radars, the data is shared until one of them is changed.
+ */
+typedef struct _CompositeQualityStore_t {
+  RAVE_OBJECT_HEAD /** Always on top */
+  char* quantity;   /**< the quantity the records belong to */
+  long xsize;       /**< xsize */
+  long ysize;       /**< ysize */
+  CompositeQualityRecord_t* records; /**< one record per pixel */
+  int nradars;      /**< number of radars */
+  int* radarIndexValues; /**< the radar index values, indexed by radarindex */
+  int* scanOffset;  /**< index of the first scan of each radar in the snapshots, nradars + 1 values */
+  CompositeQualitySnapshot_t* snapshots; /**< the quality fields that are not derived from the records alone */
+  int nsnapshots;   /**< number of snapshots */
+} CompositeQualityStore_t;
+
+/**
+ * Releases the quality fields of a snapshot.
+ * @param[in] store - the store
+ * @param[in] snapshot - the snapshot
+ */
+static void CompositeQualityStoreInternal_releaseSnapshot(CompositeQualityStore_t* store, CompositeQualitySnapshot_t* snapshot)
+{
+  int i = 0;
+  for (i = 0; snapshot->fields != NULL && i < store->scanOffset[store->nradars]; i++) {
+    RAVE_OBJECT_RELEASE(snapshot->fields[i]);
+  }
+  RAVE_FREE(snapshot->fields);
+}
+
+static int CompositeQualityStore_constructor(RaveCoreObject* obj)
+{
+  CompositeQualityStore_t* this = (CompositeQualityStore_t*)obj;
+  this->quantity = NULL;
+  this->xsize = 0;
+  this->ysize = 0;
+  this->records = NULL;
+  this->nradars = 0;
+  this->radarIndexValues = NULL;
+  this->scanOffset = NULL;
+  this->snapshots = NULL;
+  this->nsnapshots = 0;
+  return 1;
+}
+
+static void CompositeQualityStore_destructor(RaveCoreObject* obj)
+{
+  CompositeQualityStore_t* this = (CompositeQualityStore_t*)obj;
+  int i = 0;
+  for (i = 0; this->snapshots != NULL && i < this->nsnapshots; i++) {
+    RAVE_FREE(this->snapshots[i].name);
+    CompositeQualityStoreInternal_releaseSnapshot(this, &this->snapshots[i]);
+  }
+  RAVE_FREE(this->snapshots);
+  RAVE_FREE(this->quantity);
+  RAVE_FREE(this->records);
+  RAVE_FREE(this->radarIndexValues);
+  RAVE_FREE(this->scanOffset);
+}
+
+static RaveCoreObjectType CompositeQualityStore_TYPE = {
+    "CompositeQualityStore",
+    sizeof(CompositeQualityStore_t),
+    CompositeQualityStore_constructor,
+    CompositeQualityStore_destructor,
+    NULL
+};
+
+/**
+ * Records the winning radar and its navigation information for a pixel. Assumes that
+ * nearest interpolation has been used, i.e. that there is exactly one value position.
+ * @param[in] store - the quality store
+ * @param[in] x - x coordinate
+ * @param[in] y - y coordinate
+ * @param[in] radarindex - the radar index
+ * @param[in] radardist - the distance to the radar
+ * @param[in] navinfo - the navigation information of the value position
+ */
+static void CompositeInternal_recordQuality(CompositeQualityStore_t* store, int x, int y, int radarindex, double radardist, PolarNavigationInfo* navinfo)
+{
+  CompositeQualityRecord_t* record = &store->records[y * store->xsize + x];
+  record->radarindex = (unsigned char)radarindex;
+  record->ei = (unsigned char)navinfo->ei;
+  record->ri = (unsigned short)navinfo->ri;
+  record->ai = (unsigned short)navinfo->ai;
+  record->distance = (unsigned char)myround_int(radardist/DISTANCE_TO_RADAR_RESOLUTION, 0, 255);
+  record->height = (unsigned char)myround_int(navinfo->actual_height/HEIGHT_RESOLUTION, 0, 255);
+}
+
+/**
+ * Returns if the quality flag can be derived from the quality record alone, i.e. without the radar objects.
+ * @param[in] name - the how/task value
+ * @return 1 if the radar objects are not needed otherwise 0
+ */
+static int CompositeInternal_isRecordQualityFlag(const char* name)
+{
+  return (strcmp(DISTANCE_TO_RADAR_HOW_TASK, name) == 0 ||
+          strcmp(HEIGHT_ABOVE_SEA_HOW_TASK, name) == 0 ||
+          strcmp(RADAR_INDEX_HOW_TASK, name) == 0);
+}
+
+/**
+ * Returns if the quality flag is filled by the composite algorithm. Such flags are always filled
+ * during generation since they depend on the state of the algorithm.
+ * @param[in] self - self
+ * @param[in] name - the how/task value
+ * @return 1 if the algorithm fills the quality flag otherwise 0
+ */
+static int CompositeInternal_isAlgorithmQualityFlag(Composite_t* self, const char* name)
+{
+  if (strcmp(DISTANCE_TO_RADAR_HOW_TASK, name) == 0 ||
+      strcmp(HEIGHT_ABOVE_SEA_HOW_TASK, name) == 0 ||
+      strcmp(RADAR_INDEX_HOW_TASK, name) == 0) {
+    return 0;
+  }
+  return (self->algorithm != NULL && CompositeAlgorithm_supportsFillQualityInformation(self->algorithm, name));
+}
+
+/**
+ * Derives the quality field identified by the how/task value from the records in the store.
+ * Gives the same result as filling the field pixel by pixel during generation since the quality
+ * fields of the radars were taken when the composite was generated. The quality fields of a how/task
+ * are released when it has been derived.
+ * @param[in] provider - the quality store
+ * @param[in] name - the how/task value
+ * @return the data on success otherwise NULL
+ */
+static RaveData2D_t* CompositeInternal_deriveQualityField(RaveCoreObject* provider, const char* name)
+{
+  CompositeQualityStore_t* store = (CompositeQualityStore_t*)provider;
+  CompositeQualitySnapshot_t* snapshot = NULL;
+  RaveData2D_t* result = NULL;
+  RaveData2D_t* data = NULL;
+  int i = 0;
+  long x = 0, y = 0;
+
+  data = RAVE_OBJECT_NEW(&RaveData2D_TYPE);
+  if (data == NULL || !RaveData2D_createData(data, store->xsize, store->ysize, RaveDataType_UCHAR, 0)) {
+    RAVE_ERROR1("Failed to create quality field for %s", name);
+    goto done;
+  }
+
+  for (i = 0; !CompositeInternal_isRecordQualityFlag(name) && i < store->nsnapshots; i++) {
+    if (strcmp(store->snapshots[i].name, name) == 0) {
+      snapshot = &store->snapshots[i];
+    }
+  }
+
+  for (y = 0; y < store->ysize; y++) {
+    for (x = 0; x < store->xsize; x++) {
+      CompositeQualityRecord_t* record = &store->records[y * store->xsize + x];
+      double value = 0.0;
+
+      if (record->radarindex == COMPOSITE_QUALITY_NO_RADAR) {
+        continue;
+      }
+
+      if (strcmp(DISTANCE_TO_RADAR_HOW_TASK, name) == 0) {
+        value = (double)record->distance;
+      } else if (strcmp(HEIGHT_ABOVE_SEA_HOW_TASK, name) == 0) {
+        value = (double)record->height;
+      } else if (strcmp(RADAR_INDEX_HOW_TASK, name) == 0) {
+        value = (double)store->radarIndexValues[record->radarindex];
+      } else if (snapshot != NULL && snapshot->fields != NULL && record->radarindex < store->nradars) {
+        RaveField_t* field = NULL;
+        if (store->scanOffset[record->radarindex] + record->ei < store->scanOffset[record->radarindex + 1]) {
+          field = snapshot->fields[store->scanOffset[record->radarindex] + record->ei];
+        }
+        if (field == NULL || !RaveField_getConvertedValue(field, record->ri, record->ai, &value)) {
+          value = 0.0;
+        }
+        value = (value - COMPOSITE_QUALITY_FIELDS_OFFSET) / COMPOSITE_QUALITY_FIELDS_GAIN;
+      }
+      RaveData2D_setValueUnchecked(data, x, y, value);
+    }
+  }
+
+  result = RAVE_OBJECT_COPY(data);
+  if (snapshot != NULL) {
+    CompositeQualityStoreInternal_releaseSnapshot(store, snapshot);
+  }
+done:
+  RAVE_OBJECT_RELEASE(data);
+  return result;
+}
+
+/**
+ * Returns a clone of the quality field that \ref PolarScan_getQualityValueAt would use, i.e. the one in
+ * the parameter or, if the parameter does not have it, the one in the scan.
+ * @param[in] scan - the scan
+ * @param[in] quantity - the quantity
+ * @param[in] name - the how/task value
+ * @param[out] field - the clone or NULL if there is no such quality field
+ * @return 1 on success, 0 if the field could not be cloned
+ */
+static int CompositeInternal_cloneScanQualityField(PolarScan_t* scan, const char* quantity, const char* name, RaveField_t** field)
+{
+  PolarScanParam_t* param = PolarScan_getParameter(scan, quantity);
+  RaveField_t* quality = NULL;
+  int result = 1;
+
+  *field = NULL;
+  if (param != NULL) {
+    quality = PolarScanParam_getQualityFieldByHowTask(param, name);
+    if (quality == NULL) {
+      quality = PolarScan_getQualityFieldByHowTask(scan, name);
+    }
+  }
+  if (quality != NULL) {
+    *field = RAVE_OBJECT_CLONE(quality);
+    result = (*field != NULL);
+  }
+  RAVE_OBJECT_RELEASE(param);
+  RAVE_OBJECT_RELEASE(quality);
+  return result;
+}
+
+/**
+ * Creates a quality store for the specified quantity. The quality fields needed to derive the
+ * quality flags are taken with \ref CompositeInternal_takeQualitySnapshots.
+ * @param[in] self - self
+ * @param[in] quantity - the quantity
+ * @param[in] xsize - xsize
+ * @param[in] ysize - ysize
+ * @return the store on success otherwise NULL
+ */
+static CompositeQualityStore_t* CompositeInternal_createQualityStore(Composite_t* self, const char* quantity, long xsize, long ysize)
+{
+  CompositeQualityStore_t* store = NULL;
+  CompositeQualityStore_t* result = NULL;
+  int nradars = 0, i = 0;
+  long n = 0;
+
+  store = RAVE_OBJECT_NEW(&CompositeQualityStore_TYPE);
+  if (store == NULL) {
+    goto done;
+  }
+  nradars = RaveList_size(self->objectList);
+  store->quantity = RAVE_STRDUP(quantity);
+  store->records = RAVE_MALLOC(sizeof(CompositeQualityRecord_t) * xsize * ysize);
+  store->radarIndexValues = RAVE_MALLOC(sizeof(int) * (nradars > 0 ? nradars : 1));
+  store->scanOffset = RAVE_CALLOC(nradars + 1, sizeof(int));
+  if (store->quantity == NULL || store->records == NULL || store->radarIndexValues == NULL || store->scanOffset == NULL) {
+    RAVE_ERROR0("Failed to allocate quality store");
+    goto done;
+  }
+  store->xsize = xsize;
+  store->ysize = ysize;
+  store->nradars = nradars;
+  for (n = 0; n < xsize * ysize; n++) {
+    store->records[n].radarindex = COMPOSITE_QUALITY_NO_RADAR;
+  }
+  for (i = 0; i < nradars; i++) {
+    store->radarIndexValues[i] = ((CompositeRadarItem_t*)RaveList_get(self->objectList, i))->radarIndexValue;
+  }
+
+  result = RAVE_OBJECT_COPY(store);
+done:
+  RAVE_OBJECT_RELEASE(store);
+  return result;
+}
+
+/**
+ * Clones the quality fields of the radars that are needed to derive the quality flags that are not
+ * given by the records alone. Changing the radars after the generation does therefore not affect the
+ * derived quality fields. Must be called when the scans of the volumes have got the order that the
+ * elevation indexes in the records refer to.
+ * @param[in] self - self
+ * @param[in] store - the quality store
+ * @param[in] qualityflags - the quality flags
+ * @return 1 on success otherwise 0
+ */
+static int CompositeInternal_takeQualitySnapshots(Composite_t* self, CompositeQualityStore_t* store, RaveList_t* qualityflags)
+{
+  int nflags = 0, i = 0, j = 0, k = 0;
+
+  for (i = 0; i < store->nradars; i++) {
+    RaveCoreObject* obj = ((CompositeRadarItem_t*)RaveList_get(self->objectList, i))->object;
+    int nscans = 1;
+    if (RAVE_OBJECT_CHECK_TYPE(obj, &PolarVolume_TYPE)) {
+      nscans = PolarVolume_getNumberOfScans((PolarVolume_t*)obj);
+    }
+    store->scanOffset[i + 1] = store->scanOffset[i] + nscans;
+  }
+
+  nflags = RaveList_size(qualityflags);
+  store->snapshots = RAVE_MALLOC(sizeof(CompositeQualitySnapshot_t) * (nflags > 0 ? nflags : 1));
+  if (store->snapshots == NULL) {
+    RAVE_ERROR0("Failed to allocate quality store");
+    return 0;
+  }
+
+  for (k = 0; k < nflags; k++) {
+    const char* name = (const char*)RaveList_get(qualityflags, k);
+    CompositeQualitySnapshot_t* snapshot = &store->snapshots[store->nsnapshots];
+    if (CompositeInternal_isRecordQualityFlag(name) || CompositeInternal_isAlgorithmQualityFlag(self, name)) {
+      continue;
+    }
+    snapshot->name = RAVE_STRDUP(name);
+    snapshot->fields = RAVE_CALLOC((store->scanOffset[store->nradars] > 0 ? store->scanOffset[store->nradars] : 1), sizeof(RaveField_t*));
+    store->nsnapshots++;
+    if (snapshot->name == NULL || snapshot->fields == NULL) {
+      RAVE_ERROR0("Failed to allocate quality store");
+      return 0;
+    }
+    for (i = 0; i < store->nradars; i++) {
+      RaveCoreObject* obj = ((CompositeRadarItem_t*)RaveList_get(self->objectList, i))->object;
+      for (j = store->scanOffset[i]; j < store->scanOffset[i + 1]; j++) {
+        PolarScan_t* scan = NULL;
+        int ok = 0;
+        if (RAVE_OBJECT_CHECK_TYPE(obj, &PolarVolume_TYPE)) {
+          scan = PolarVolume_getScan((PolarVolume_t*)obj, j - store->scanOffset[i]);
+        } else {
+          scan = (PolarScan_t*)RAVE_OBJECT_COPY(obj);
+        }
+        ok = (scan == NULL || CompositeInternal_cloneScanQualityField(scan, store->quantity, name, &snapshot->fields[j]));
+        RAVE_OBJECT_RELEASE(scan);
+        if (!ok) {
+          RAVE_ERROR1("Failed to copy quality field %s", name);
+          return 0;
+        }
+      }
+    }
+  }
+  return 1;
+}
+
+/**
+ * Returns the quality store for the specified quantity.
+ * @param[in] qstores - the quality stores (may be NULL)
+ * @param[in] nstores - number of stores
+ * @param[in] quantity - the quantity
+ * @return the store (not a copy) or NULL if not found
+ */
+static CompositeQualityStore_t* CompositeInternal_findQualityStore(CompositeQualityStore_t** qstores, int nstores, const char* quantity)
+{
+  int i = 0;
+  for (i = 0; qstores != NULL && quantity != NULL && i < nstores; i++) {
+    if (qstores[i] != NULL && strcmp(qstores[i]->quantity, quantity) == 0) {
+      return qstores[i];
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Returns if the quality stores should be used for the composite, i.e. if there is at least one quality
+ * flag that is not filled by the algorithm and the records are able to represent the radars, scans and
+ * bins of the composite.
+ * @param[in] self - self
+ * @param[in] qualityflags - the quality flags
+ * @return 1 if the quality stores should be used otherwise 0
+ */
+static int CompositeInternal_useQualityStore(Composite_t* self, RaveList_t* qualityflags)
+{
+  int nflags = 0, nderived = 0, nradars = 0, i = 0, j = 0;
+
+  nflags = RaveList_size(qualityflags);
+  for (i = 0; i < nflags; i++) {
+    if (!CompositeInternal_isAlgorithmQualityFlag(self, (const char*)RaveList_get(qualityflags, i))) {
+      nderived++;
+    }
+  }
+  if (nderived == 0) {
+    return 0;
+  }
+
+  nradars = RaveList_size(self->objectList);
+  if (nradars >= COMPOSITE_QUALITY_NO_RADAR) {
+    return 0;
+  }
+  for (i = 0; i < nradars; i++) {
+    RaveCoreObject* obj = ((CompositeRadarItem_t*)RaveList_get(self->objectList, i))->object;
+    if (RAVE_OBJECT_CHECK_TYPE(obj, &PolarScan_TYPE)) {
+      if (PolarScan_getNrays((PolarScan_t*)obj) > COMPOSITE_QUALITY_MAX_INDEX ||
+          PolarScan_getNbins((PolarScan_t*)obj) > COMPOSITE_QUALITY_MAX_INDEX) {
+        return 0;
+      }
+    } else if (RAVE_OBJECT_CHECK_TYPE(obj, &PolarVolume_TYPE)) {
+      int nscans = PolarVolume_getNumberOfScans((PolarVolume_t*)obj);
+      if (nscans > UCHAR_MAX) {
+        return 0;
+      }
+      for (j = 0; j < nscans; j++) {
+        PolarScan_t* scan = PolarVolume_getScan((PolarVolume_t*)obj, j);
+        int fits = (scan != NULL &&
+                    PolarScan_getNrays(scan) <= COMPOSITE_QUALITY_MAX_INDEX &&
+                    PolarScan_getNbins(scan) <= COMPOSITE_QUALITY_MAX_INDEX);
+        RAVE_OBJECT_RELEASE(scan);
+        if (!fits) {
+          return 0;
+        }
+      }
+    }
+  }
+  return 1;
+}
+
+/**
+ * Creates a quality field. If a quality store is given, the data will not be allocated. Instead it
+ * will be derived from the store when the field is first accessed.
+ * @param[in] howtaskstr - the how/task value
+ * @param[in] xsize - xsize
+ * @param[in] ysize - ysize
+ * @param[in] gain - gain
+ * @param[in] offset - offset
+ * @param[in] store - the quality store (may be NULL)
+ * @return the field on success otherwise NULL
+ */
+static RaveField_t* CompositeInternal_createQualityField(char* howtaskstr, int xsize, int ysize, double gain, double offset, CompositeQualityStore_t* store) {
   RaveField_t* qfield = RAVE_OBJECT_NEW(&RaveField_TYPE);
   RaveAttribute_t* howtaskattribute = NULL;
+  LazyDataset_t* lazy = NULL;
 
   if (qfield == NULL) {
     RAVE_ERROR0("Failed to create quality field");
@@ -441,7 +922,16 @@ static RaveField_t* CompositeInternal_createQualityField(char* howtaskstr, int x
     goto error;
   }
 
-  if(!RaveField_createData(qfield, xsize, ysize, RaveDataType_UCHAR)) {
+  if (store != NULL) {
+    lazy = RAVE_OBJECT_NEW(&LazyDataset_TYPE);
+    if (lazy == NULL ||
+        !LazyDataset_initWithProvider(lazy, (RaveCoreObject*)store, CompositeInternal_deriveQualityField, howtaskstr, xsize, ysize, RaveDataType_UCHAR) ||
+        !RaveField_setLazyDataset(qfield, lazy)) {
+      RAVE_ERROR0("Failed to create quality field");
+      goto error;
+    }
+    RAVE_OBJECT_RELEASE(lazy);
+  } else if(!RaveField_createData(qfield, xsize, ysize, RaveDataType_UCHAR)) {
     RAVE_ERROR0("Failed to create quality field");
     goto error;
   }
@@ -450,6 +940,7 @@ static RaveField_t* CompositeInternal_createQualityField(char* howtaskstr, int x
 error:
   RAVE_OBJECT_RELEASE(qfield);
   RAVE_OBJECT_RELEASE(howtaskattribute);
+  RAVE_OBJECT_RELEASE(lazy);
   return NULL;
 
 }
@@ -473,6 +964,9 @@ static int Composite_constructor(RaveCoreObject* obj)
   this->datetime = RAVE_OBJECT_NEW(&RaveDateTime_TYPE);
   this->parameters = RAVE_OBJECT_NEW(&RaveList_TYPE);
   this->qiFieldName = NULL;
+  this->lazyQuality = 0;
+  this->threshold = 20.0;
+  this->nthreads = 1;
 
   if (this->objectList == NULL || this->parameters == NULL || this->datetime == NULL) {
     goto error;
@@ -504,6 +998,9 @@ static int Composite_copyconstructor(RaveCoreObject* obj, RaveCoreObject* srcobj
   this->objectList = CompositeInternal_cloneRadarItemList(src->objectList);
   this->datetime = RAVE_OBJECT_CLONE(src->datetime);
   this->qiFieldName = NULL;
+  this->lazyQuality = src->lazyQuality;
+  this->threshold = src->threshold;
+  this->nthreads = src->nthreads;
 
   if (this->objectList == NULL || this->datetime == NULL || this->parameters == NULL) {
     goto error;
@@ -660,22 +1157,25 @@ static int CompositeInternal_isQuadraticInterpolation(Composite_t* composite) {
   return isQuadratic;
 }
 
+/**
+ * Compares two ints, used when sorting and searching radar indexes.
+ */
+static int CompositeInternal_compareRadarIndex(const void* a, const void* b)
+{
+  int ia = *(const int*)a, ib = *(const int*)b;
+  return (ia > ib) - (ia < ib);
+}
+
 /**
  * Tries to find the next available integer that is not filtered by indexes.
- * @param[in] indexes - filter of already used integers
+ * @param[in] indexes - filter of already used integers, sorted in ascending order
  * @param[in] n_objs - number of indexes
  * @param[in] available - the integer that should be tested for availability
  * @return 1 if already exists, otherwise 0
  */
 static int CompositeInternal_containsRadarIndex(int* indexes, int n_objs, int available)
 {
-  int i = 0;
-  for (i = 0; i < n_objs; i++) {
-    if (indexes[i] == available) {
-      return 1;
-    }
-  }
-  return 0;
+  return bsearch(&available, indexes, n_objs, sizeof(int), CompositeInternal_compareRadarIndex) != NULL;
 }
 
 static char* CompositeInternal_getTypeAndIdFromSource(const char* source, const char* id)
@@ -744,38 +1244,6 @@ static char* CompositeInternal_getAnyIdFromSource(const char* source)
   return result;
 }
 
-static int CompositeInternal_concateStr(char** ids, int* len, const char* str)
-{
-  int result = 0;
-  char* p = *ids;
-  int n = *len;
-  int currStrLen = strlen(p);
-  if (currStrLen + strlen(str) + 1 > n) {
-    int newsize = n + strlen(str) + 1;
-    char* newp = RAVE_REALLOC(p, newsize * sizeof(char));
-    if (newp != NULL) {
-      p = newp;
-      n = newsize;
-    } else {
-      goto done;
-    }
-  }
-  strcat(p, str);
-
-  *ids = p;
-  *len = n;
-  result = 1;
-done:
-  return result;
-}
-
-static int CompositeInternal_concateInt(char** ids, int* len, int value)
-{
-  char buff[16];
-  memset(buff, 0, sizeof(char)*16);
-  sprintf(buff, "%d", value);
-  return CompositeInternal_concateStr(ids, len, buff);
-}
 /**
  * Returns the next available integer with a filter of already aquired indexes.
  * We assume that we always want to index radars from 1-gt;N. Which means that the first time
@@ -866,6 +1334,7 @@ static int CompositeInternal_updateRadarIndexes(Composite_t* composite, RaveObje
   }
 
   /* Any radarIndexValue = 0, needs to get a suitable value, take first available one */
+  qsort(indexes, n_objs, sizeof(int), CompositeInternal_compareRadarIndex);
   for (i = 0; i < n_objs; i++) {
     CompositeRadarItem_t* ri = (CompositeRadarItem_t*)RaveList_get(composite->objectList, i);
     if (ri->radarIndexValue == 0) {
@@ -1152,6 +1621,8 @@ static int CompositeInternal_getValuePositions(
 
   int noOfValuePositions = -1;
 
+  RAVE_STATS_COUNT(RaveStats_Counter_COMPOSITE_LOOKUPS, 1);
+
   if (composite->interpolationMethod == CompositeInterpolationMethod_NEAREST) {
     noOfValuePositions = CompositeInternal_getValuePositions_nearest(composite, object, plon, plat, valuePositions);
   } else {
@@ -1889,92 +2360,88 @@ done:
 }
 
 
-static int CompositeInternal_addNodeIdsToFieldHowTaskArgs(Composite_t* self, RaveField_t* field)
+/**
+ * Creates the table mapping the radar ids to the values in the radar index quality field.
+ * @param[in] self - self
+ * @return the table or NULL on failure
+ */
+static RadarIndexTable_t* CompositeInternal_createRadarIndexTable(Composite_t* self)
 {
   int i = 0, n = 0;
-  char* ids = NULL;
-  int idsLength = 0;
-  int result = 0;
-  RaveAttribute_t* howTaskArgs = NULL;
-  char* srcid = NULL;
+  RadarIndexTable_t* result = NULL;
+  RadarIndexTable_t* table = NULL;
   RaveCoreObject* obj = NULL;
-  n = Composite_getNumberOfObjects(self);
-  /* We assume that length of ids is <nr radars> * 10 (WMO-number and a ':', followed by a 3-digit number and finally a ',') */
-  idsLength = n * 10 + 1;
-  ids = RAVE_MALLOC(sizeof(char) * idsLength);
-  if (ids == NULL) {
-    return 0;
+  char* srcid = NULL;
+
+  table = RAVE_OBJECT_NEW(&RadarIndexTable_TYPE);
+  if (table == NULL) {
+    goto done;
   }
-  memset(ids, 0, sizeof(char)*idsLength);
 
+  n = Composite_getNumberOfObjects(self);
   for (i = 0; i < n; i++) {
     obj = Composite_get(self, i);
-    srcid = NULL;
     if (obj != NULL) {
       if (RAVE_OBJECT_CHECK_TYPE(obj, &PolarScan_TYPE)) {
-        const char* source = PolarScan_getSource((PolarScan_t*)obj);
-        srcid = CompositeInternal_getAnyIdFromSource(source);
+        srcid = CompositeInternal_getAnyIdFromSource(PolarScan_getSource((PolarScan_t*)obj));
       } else if (RAVE_OBJECT_CHECK_TYPE(obj, &PolarVolume_TYPE)) {
-        const char* source = PolarVolume_getSource((PolarVolume_t*)obj);
-        srcid = CompositeInternal_getAnyIdFromSource(source);
-      }
-
-      if (srcid != NULL) {
-        if (!CompositeInternal_concateStr(&ids, &idsLength, srcid)) {
-          goto done;
-        }
-      } else {
-        if (!CompositeInternal_concateStr(&ids, &idsLength, "Unknown")) {
-          goto done;
-        }
-      }
-      if (!CompositeInternal_concateStr(&ids, &idsLength, ":")) {
-        goto done;
+        srcid = CompositeInternal_getAnyIdFromSource(PolarVolume_getSource((PolarVolume_t*)obj));
       }
-      if (!CompositeInternal_concateInt(&ids, &idsLength, Composite_getRadarIndexValue(self, i))) {
+      if (!RadarIndexTable_add(table, (srcid != NULL) ? srcid : "Unknown", Composite_getRadarIndexValue(self, i))) {
         goto done;
       }
-      if (i < n-1) {
-        if (!CompositeInternal_concateStr(&ids, &idsLength,",")) {
-          goto done;
-        }
-      }
+      RAVE_FREE(srcid);
     }
-    RAVE_FREE(srcid);
     RAVE_OBJECT_RELEASE(obj);
   }
 
-  howTaskArgs = RaveAttributeHelp_createString("how/task_args", ids);
-  if (howTaskArgs == NULL) {
-    goto done;
-  }
-  if (!RaveField_addAttribute(field, howTaskArgs)) {
-    goto done;
-  }
-
-  result = 1;
+  result = RAVE_OBJECT_COPY(table);
 done:
   RAVE_FREE(srcid);
   RAVE_OBJECT_RELEASE(obj);
-  RAVE_FREE(ids);
-  RAVE_OBJECT_RELEASE(howTaskArgs);
+  RAVE_OBJECT_RELEASE(table);
   return result;
 }
 
+/**
+ * Sets a copy of the radar index table on the field. The how/task_args attribute is
+ * generated from the table when the field is written.
+ * @param[in] field - the radar index quality field
+ * @param[in] table - the radar index table
+ * @return 1 on success otherwise 0
+ */
+static int CompositeInternal_setRadarIndexTable(RaveField_t* field, RadarIndexTable_t* table)
+{
+  RadarIndexTable_t* ctable = NULL;
+  if (table == NULL) {
+    return 0;
+  }
+  ctable = RAVE_OBJECT_CLONE(table);
+  if (ctable == NULL) {
+    return 0;
+  }
+  RaveField_setRadarIndexTable(field, ctable);
+  RAVE_OBJECT_RELEASE(ctable);
+  return 1;
+}
+
 /**
  * Adds quality flags to the composite.
  * @apram[in] self - self
  * @param[in] image - the image to add quality flags to
  * @param[in] qualityflags - a list of strings identifying the how/task value in the quality fields
+ * @param[in] qstores - the quality stores for the parameters if the quality fields should be derived on demand (may be NULL)
+ * @param[in] nstores - the number of quality stores
  * @return 1 on success otherwise 0
  */
-static int CompositeInternal_addQualityFlags(Composite_t* self, Cartesian_t* image, RaveList_t* qualityflags)
+static int CompositeInternal_addQualityFlags(Composite_t* self, Cartesian_t* image, RaveList_t* qualityflags, CompositeQualityStore_t** qstores, int nstores)
 {
   int result = 0;
   int nqualityflags = 0;
   RaveField_t* field = NULL;
   CartesianParam_t* param = NULL;
   RaveList_t* paramNames = NULL;
+  RadarIndexTable_t* indexTable = NULL;
 
   int xsize = 0, ysize = 0;
   int i = 0, j = 0;
@@ -2010,17 +2477,42 @@ static int CompositeInternal_addQualityFlags(Composite_t* self, Cartesian_t* ima
     } else if (strcmp(RADAR_INDEX_HOW_TASK, howtaskvaluestr) == 0) {
       gain = 1.0;
       offset = 0.0;
+      if (indexTable == NULL) {
+        indexTable = CompositeInternal_createRadarIndexTable(self);
+      }
     } else {
       // set the same, fixed gain and offset that is used for all quality fields (except distance) in the composite
       gain = COMPOSITE_QUALITY_FIELDS_GAIN;
       offset = COMPOSITE_QUALITY_FIELDS_OFFSET;
     }
 
-    field = CompositeInternal_createQualityField(howtaskvaluestr, xsize, ysize, gain, offset);
-
-    if (strcmp(RADAR_INDEX_HOW_TASK, howtaskvaluestr)==0) {
-      CompositeInternal_addNodeIdsToFieldHowTaskArgs(self, field);
-    }
+    if (qstores != NULL && !CompositeInternal_isAlgorithmQualityFlag(self, howtaskvaluestr)) {
+      /* Each parameter gets its own field deriving its data from the parameters quality store */
+      for (j = 0; j < nparam; j++) {
+        const char* pname = (const char*)RaveList_get(paramNames, j);
+        CompositeQualityStore_t* store = CompositeInternal_findQualityStore(qstores, nstores, pname);
+        param = Cartesian_getParameter(image, pname);
+        if (param != NULL && store != NULL) {
+          field = CompositeInternal_createQualityField(howtaskvaluestr, xsize, ysize, gain, offset, store);
+          if (field != NULL && strcmp(RADAR_INDEX_HOW_TASK, howtaskvaluestr) == 0) {
+            CompositeInternal_setRadarIndexTable(field, indexTable);
+          }
+          if (field == NULL || !CartesianParam_addQualityField(param, field)) {
+            RAVE_ERROR0("Failed to add quality field");
+            goto done;
+          }
+          RAVE_OBJECT_RELEASE(field);
+        }
+        RAVE_OBJECT_RELEASE(param);
+      }
+      continue;
+    }
+
+    field = CompositeInternal_createQualityField(howtaskvaluestr, xsize, ysize, gain, offset, NULL);
+
+    if (strcmp(RADAR_INDEX_HOW_TASK, howtaskvaluestr)==0) {
+      CompositeInternal_setRadarIndexTable(field, indexTable);
+    }
 
     if (field != NULL) {
       for (j = 0; j < nparam; j++) {
@@ -2048,6 +2540,7 @@ static int CompositeInternal_addQualityFlags(Composite_t* self, Cartesian_t* ima
 done:
   RAVE_OBJECT_RELEASE(field);
   RAVE_OBJECT_RELEASE(param);
+  RAVE_OBJECT_RELEASE(indexTable);
   RaveList_freeAndDestroy(&paramNames);
   return result;
 }
@@ -2064,13 +2557,19 @@ done:
  * @param[in] y - y coordinate
  * @param[in] cvalues - the composite values
  * @param[in] interpolationDimensions - dimensions to perform interpolation in                      
+ * @param[in] store - if the quality fields are derived on demand from a quality store, only
+ *                    the fields filled by the algorithm are filled (may be NULL)
+ * @param[in] skipAlgorithmFlags - if the fields filled by the algorithm should be skipped since they
+ *                    are filled one row at a time by \ref CompositeInternal_fillQualityRow
  */
 static void CompositeInternal_fillQualityInformation(
   Composite_t* composite,
   int x,
   int y,
   CompositeValues_t* cvalues,
-  int interpolationDimensions[])
+  int interpolationDimensions[],
+  CompositeQualityStore_t* store,
+  int skipAlgorithmFlags)
 {
   int nfields = 0, i = 0;
   const char* quantity;
@@ -2107,6 +2606,13 @@ static void CompositeInternal_fillQualityInformation(
       RaveAttribute_getString(attribute, &name);
     }
 
+    if (name != NULL && store != NULL && !CompositeInternal_isAlgorithmQualityFlag(composite, name)) {
+      name = NULL; /* Derived from the quality store when requested */
+    }
+    if (name != NULL && skipAlgorithmFlags && CompositeInternal_isAlgorithmQualityFlag(composite, name)) {
+      name = NULL; /* Filled for the whole row by the algorithm */
+    }
+
     if (name != NULL) {
       RaveCoreObject* obj = Composite_get(composite, radarindex);
       if (obj != NULL) {
@@ -2167,6 +2673,23 @@ static void CompositeInternal_fillQualityInformation(
   }
 }
 
+/**
+ * Returns the quantity that a composite parameter has in the product. ETOP and VIL are calculated from
+ * reflectivity but the result is a height (HGHT) or a water content (VIL).
+ * @param[in] self - self
+ * @param[in] quantity - the composite parameter
+ * @returns the quantity in the product
+ */
+static const char* CompositeInternal_getProductQuantity(Composite_t* self, const char* quantity)
+{
+  if (self->ptype == Rave_ProductType_ETOP) {
+    return "HGHT";
+  } else if (self->ptype == Rave_ProductType_VIL) {
+    return "VIL";
+  }
+  return quantity;
+}
+
 /**
  * Creates the resulting composite image.
  * @param[in] self - self
@@ -2200,6 +2723,8 @@ static Cartesian_t* CompositeInternal_createCompositeImage(Composite_t* self, Ar
     char s[256];
     sprintf(s, "%f,%f",self->height,self->range);
     prodpar = RaveAttributeHelp_createString("what/prodpar", s);
+  } else if (self->ptype == Rave_ProductType_ETOP) {
+    prodpar = RaveAttributeHelp_createDouble("what/prodpar", self->threshold);
   } else {
     prodpar = RaveAttributeHelp_createDouble("what/prodpar", self->elangle * 180.0/M_PI);
   }
@@ -2228,7 +2753,7 @@ static Cartesian_t* CompositeInternal_createCompositeImage(Composite_t* self, Ar
 
   for (i = 0; i < nparam; i++) {
     double gain = 0.0, offset = 0.0;
-    const char* name = Composite_getParameter(self, i, &gain, &offset);
+    const char* name = CompositeInternal_getProductQuantity(self, Composite_getParameter(self, i, &gain, &offset));
     CartesianParam_t* cp = Cartesian_createParameter(cartesian, name, RaveDataType_UCHAR, 0);
     if (cp == NULL) {
       goto done;
@@ -2247,6 +2772,21 @@ done:
   return result;
 }
 
+/**
+ * Transforms a composite surface coordinate into the projection of a radar.
+ * @param[in] pipeline - the projection pipeline
+ * @param[in] x - the surface x coordinate
+ * @param[in] y - the surface y coordinate
+ * @param[out] lon - the longitude (radians)
+ * @param[out] lat - the latitude (radians)
+ * @return 1 on success otherwise 0
+ */
+static int CompositeInternal_projectionFwd(ProjectionPipeline_t* pipeline, double x, double y, double* lon, double* lat)
+{
+  RAVE_STATS_COUNT(RaveStats_Counter_COMPOSITE_PROJECTIONS, 1);
+  return ProjectionPipeline_fwd(pipeline, x, y, lon, lat);
+}
+
 /**
  * Returns the projection object that belongs to this obj.
  * @param[in] obj - the rave core object instance
@@ -2284,6 +2824,170 @@ static int CompositeInternal_getDistances(RaveCoreObject* obj, double lon, doubl
   return result;
 }
 
+/**
+ * Selects the value for one pixel from one radar when the value positions of the pixel in the radar
+ * already have been calculated with \ref CompositeInternal_getValuePositions. Allows several products
+ * with the same navigation to share the value positions.
+ * @param[in] composite - self
+ * @param[in] obj - the radar object
+ * @param[in] radarindex - the index of obj in the composite
+ * @param[in] olon - the longitude of the pixel (radians)
+ * @param[in] olat - the latitude of the pixel (radians)
+ * @param[in] dist - the distance from the radar to the pixel
+ * @param[in] interpolationDimensions - dimensions to perform interpolation in
+ * @param[in] valuePositions - the value positions (MAX_NO_OF_SURROUNDING_POSITIONS)
+ * @param[in] noOfValuePositions - the number of valid value positions
+ * @param[in,out] cvalues - the composite values for the pixel (nparam)
+ * @param[in] nparam - the number of parameters
+ * @return 1 on success, 0 if the interpolation failed
+ */
+static int CompositeInternal_selectValueAtPositions(Composite_t* composite, RaveCoreObject* obj, int radarindex, double olon, double olat,
+  double dist, int interpolationDimensions[], CompositeValuePosition_t valuePositions[], int noOfValuePositions,
+  CompositeValues_t* cvalues, int nparam)
+{
+  double rdist = 0.0;
+  int cindex = 0;
+
+  if (noOfValuePositions > 0) {
+    rdist = dist; /* Remember distance to radar */
+
+    if (composite->method == CompositeSelectionMethod_HEIGHT) {
+      dist = CompositeInternal_getValuePositionsLowestHeight(valuePositions, noOfValuePositions);
+    }
+
+    for (cindex = 0; cindex < nparam; cindex++) {
+      RaveValueType otype = RaveValueType_NODATA;
+      double ovalue = 0.0, qivalue = 0.0;
+
+      if (!CompositeInternal_getInterpolatedValue(composite, obj, interpolationDimensions,
+                                                  cvalues[cindex].name, NULL, valuePositions,
+                                                  noOfValuePositions,
+                                                  CompositeInternal_setValuesInValuePos,
+                                                  &otype, &ovalue, &qivalue)) {
+        RAVE_ERROR0("Interpolation failed.\n");
+        return 0;
+      }
+
+      if (composite->algorithm != NULL && CompositeAlgorithm_supportsProcess(composite->algorithm)) {
+        // NOTE: The CompositeAlgorithm_process interface expects only one single navigation info. In the below call, we always provide
+        // the navigation info for the first position. This will at least work for the 'nearest' interpolation method. For other interpolation methods,
+        // where multiple positions have been collected, it depends on the composite algorithm how it handles the navigation info.
+        if (CompositeAlgorithm_process(composite->algorithm, obj, cvalues[cindex].name, olon, olat, rdist, &otype, &ovalue, &valuePositions[0].navinfo)) {
+          cvalues[cindex].vtype = otype;
+          cvalues[cindex].value = ovalue;
+          cvalues[cindex].mindist = dist;
+          cvalues[cindex].radardist = rdist;
+          cvalues[cindex].radarindex = radarindex;
+          cvalues[cindex].qivalue = qivalue;
+          cvalues[cindex].noOfValuePositions = noOfValuePositions;
+          memcpy(cvalues[cindex].valuePositions, valuePositions, sizeof(CompositeValuePosition_t)*MAX_NO_OF_SURROUNDING_POSITIONS);
+        }
+      } else {
+        if (otype == RaveValueType_DATA || otype == RaveValueType_UNDETECT) {
+          if (cvalues[cindex].vtype != RaveValueType_DATA && cvalues[cindex].vtype != RaveValueType_UNDETECT) {
+            /* First time */
+            cvalues[cindex].vtype = otype;
+            cvalues[cindex].value = ovalue;
+            cvalues[cindex].mindist = dist;
+            cvalues[cindex].radardist = rdist;
+            cvalues[cindex].radarindex = radarindex;
+            cvalues[cindex].qivalue = qivalue;
+            cvalues[cindex].noOfValuePositions = noOfValuePositions;
+            memcpy(cvalues[cindex].valuePositions, valuePositions, sizeof(CompositeValuePosition_t)*MAX_NO_OF_SURROUNDING_POSITIONS);
+          } else if (
+              composite->qiFieldName != NULL &&
+              ((qivalue > cvalues[cindex].qivalue) ||
+               (qivalue == cvalues[cindex].qivalue && dist < cvalues[cindex].mindist))) {
+            cvalues[cindex].vtype = otype;
+            cvalues[cindex].value = ovalue;
+            cvalues[cindex].mindist = dist;
+            cvalues[cindex].radardist = rdist;
+            cvalues[cindex].radarindex = radarindex;
+            cvalues[cindex].qivalue = qivalue;
+            cvalues[cindex].noOfValuePositions = noOfValuePositions;
+            memcpy(cvalues[cindex].valuePositions, valuePositions, sizeof(CompositeValuePosition_t)*MAX_NO_OF_SURROUNDING_POSITIONS);
+          } else if (composite->qiFieldName == NULL && dist < cvalues[cindex].mindist) {
+            cvalues[cindex].vtype = otype;
+            cvalues[cindex].value = ovalue;
+            cvalues[cindex].mindist = dist;
+            cvalues[cindex].radardist = rdist;
+            cvalues[cindex].radarindex = radarindex;
+            cvalues[cindex].qivalue = qivalue;
+            cvalues[cindex].noOfValuePositions = noOfValuePositions;
+            memcpy(cvalues[cindex].valuePositions, valuePositions, sizeof(CompositeValuePosition_t)*MAX_NO_OF_SURROUNDING_POSITIONS);
+          }
+        }
+      }
+    }
+  }
+  return 1;
+}
+
+/**
+ * Selects the value for one pixel from one radar when the position of the pixel in the radar already
+ * has been calculated and the pixel is within the radars range. Used when generating composites with
+ * product types other than MAX.
+ * @param[in] composite - self
+ * @param[in] obj - the radar object
+ * @param[in] radarindex - the index of obj in the composite
+ * @param[in] olon - the longitude of the pixel (radians)
+ * @param[in] olat - the latitude of the pixel (radians)
+ * @param[in] dist - the distance from the radar to the pixel
+ * @param[in] interpolationDimensions - dimensions to perform interpolation in
+ * @param[in,out] cvalues - the composite values for the pixel (nparam)
+ * @param[in] nparam - the number of parameters
+ * @return 1 on success, 0 if the interpolation failed
+ */
+static int CompositeInternal_selectValue(Composite_t* composite, RaveCoreObject* obj, int radarindex, double olon, double olat,
+  double dist, int interpolationDimensions[], CompositeValues_t* cvalues, int nparam)
+{
+  CompositeValuePosition_t valuePositions[MAX_NO_OF_SURROUNDING_POSITIONS];
+  int noOfValuePositions = CompositeInternal_getValuePositions(composite, obj, olon, olat,
+                                                               interpolationDimensions,
+                                                               valuePositions);
+  return CompositeInternal_selectValueAtPositions(composite, obj, radarindex, olon, olat, dist, interpolationDimensions,
+                                                  valuePositions, noOfValuePositions, cvalues, nparam);
+}
+
+/**
+ * Selects the vertical max value for one pixel from one radar in the same way as the MAX product does.
+ * @param[in] composite - self
+ * @param[in] radarindex - the index of the radar in the composite
+ * @param[in] olon - the longitude of the pixel (radians)
+ * @param[in] olat - the latitude of the pixel (radians)
+ * @param[in] dist - the distance from the radar to the pixel
+ * @param[in,out] cvalues - the composite values for the pixel (nparam)
+ * @param[in] nparam - the number of parameters
+ */
+static void CompositeInternal_selectVerticalMaxValue(Composite_t* composite, int radarindex, double olon, double olat,
+  double dist, CompositeValues_t* cvalues, int nparam)
+{
+  PolarNavigationInfo navinfo;
+  int cindex = 0;
+
+  for (cindex = 0; cindex < nparam; cindex++) {
+    RaveValueType otype = RaveValueType_NODATA;
+    double ovalue = 0.0, qivalue = 0.0;
+    CompositeInternal_getVerticalMaxValue(composite, radarindex, cvalues[cindex].name, olon, olat, &otype, &ovalue, &navinfo, &qivalue);
+    if (otype == RaveValueType_DATA || otype == RaveValueType_UNDETECT) {
+      if ((cvalues[cindex].vtype != RaveValueType_DATA && cvalues[cindex].vtype != RaveValueType_UNDETECT) ||
+          (cvalues[cindex].vtype == RaveValueType_UNDETECT && otype == RaveValueType_DATA) ||
+          (cvalues[cindex].vtype == RaveValueType_DATA && otype == RaveValueType_DATA && composite->qiFieldName == NULL && ovalue > cvalues[cindex].value) ||
+          (composite->qiFieldName != NULL && (qivalue > cvalues[cindex].qivalue))) {
+        cvalues[cindex].vtype = otype;
+        cvalues[cindex].value = ovalue;
+        cvalues[cindex].mindist = dist;
+        cvalues[cindex].radardist = dist;
+        cvalues[cindex].radarindex = radarindex;
+        cvalues[cindex].qivalue = qivalue;
+        cvalues[cindex].noOfValuePositions = 1;
+        cvalues[cindex].valuePositions[0].navinfo = navinfo;
+        cvalues[cindex].valuePositions[0].valid = 1;
+      }
+    }
+  }
+}
+
 /**
  * Pure max is a quite difference composite generator that does not care about proximity to ground
  * or radar or anything else. It only cares about maximum value at the specific position so we handle
@@ -2301,7 +3005,6 @@ static Cartesian_t* Composite_nearest_max(Composite_t* composite, Area_t* area,
   Cartesian_t* result = NULL;
   Projection_t* projection = NULL;
   RaveObjectList_t* pipelines = NULL;
-  PolarNavigationInfo navinfo;
   CompositeValues_t* cvalues = NULL;
   int x = 0, y = 0, i = 0, xsize = 0, ysize = 0, nradars = 0;
   int nqualityflags = 0;
@@ -2347,7 +3050,7 @@ static Cartesian_t* Composite_nearest_max(Composite_t* composite, Area_t* area,
 
   if (qualityflags != NULL) {
     nqualityflags = RaveList_size(qualityflags);
-    if (!CompositeInternal_addQualityFlags(composite, result, qualityflags)) {
+    if (!CompositeInternal_addQualityFlags(composite, result, qualityflags, NULL, 0)) {
       goto fail;
     }
   }
@@ -2406,7 +3109,7 @@ static Cartesian_t* Composite_nearest_max(Composite_t* composite, Area_t* area,
 
         if (pipeline != NULL) {
           /* We will go from surface coords into the lonlat projection assuming that a polar volume uses a lonlat projection*/
-          if (!ProjectionPipeline_fwd(pipeline, herex, herey, &olon, &olat)) {
+          if (!CompositeInternal_projectionFwd(pipeline, herex, herey, &olon, &olat)) {
             RAVE_WARNING0("Failed to transform from composite into polar coordinates");
           } else {
             double dist = 0.0;
@@ -2415,27 +3118,7 @@ static Cartesian_t* Composite_nearest_max(Composite_t* composite, Area_t* area,
             // We only use distance & max distance to speed up processing but it isn't used for anything else
             // in the pure vertical max implementation.
             if (CompositeInternal_getDistances(obj, olon, olat, &dist, &maxdist) && dist <= maxdist) {
-              for (cindex = 0; cindex < nparam; cindex++) {
-                RaveValueType otype = RaveValueType_NODATA;
-                double ovalue = 0.0, qivalue = 0.0;
-                CompositeInternal_getVerticalMaxValue(composite, i, cvalues[cindex].name, olon, olat, &otype, &ovalue, &navinfo, &qivalue);
-                if (otype == RaveValueType_DATA || otype == RaveValueType_UNDETECT) {
-                  if ((cvalues[cindex].vtype != RaveValueType_DATA && cvalues[cindex].vtype != RaveValueType_UNDETECT) ||
-                      (cvalues[cindex].vtype == RaveValueType_UNDETECT && otype == RaveValueType_DATA) ||
-                      (cvalues[cindex].vtype == RaveValueType_DATA && otype == RaveValueType_DATA && composite->qiFieldName == NULL && ovalue > cvalues[cindex].value) ||
-                      (composite->qiFieldName != NULL && (qivalue > cvalues[cindex].qivalue))) {
-                    cvalues[cindex].vtype = otype;
-                    cvalues[cindex].value = ovalue;
-                    cvalues[cindex].mindist = dist;
-                    cvalues[cindex].radardist = dist;
-                    cvalues[cindex].radarindex = i;
-                    cvalues[cindex].qivalue = qivalue;
-                    cvalues[cindex].noOfValuePositions = 1;
-                    cvalues[cindex].valuePositions[0].navinfo = navinfo;
-                    cvalues[cindex].valuePositions[0].valid = 1;
-                  }
-                }
-              }
+              CompositeInternal_selectVerticalMaxValue(composite, i, olon, olat, dist, cvalues, nparam);
             }
           }
         }
@@ -2450,7 +3133,7 @@ static Cartesian_t* Composite_nearest_max(Composite_t* composite, Area_t* area,
 
         if ((vtype == RaveValueType_DATA || vtype == RaveValueType_UNDETECT) &&
             cvalues[cindex].radarindex >= 0 && nqualityflags > 0) {
-          CompositeInternal_fillQualityInformation(composite, x, y, &cvalues[cindex], interpolationDimensions);
+          CompositeInternal_fillQualityInformation(composite, x, y, &cvalues[cindex], interpolationDimensions, NULL, 0);
         }
       }
     }
@@ -2476,134 +3159,994 @@ fail:
 }
 
 
-/*@} End of Private functions */
+/**
+ * Value in the per radar product fields for columns without any data
+ */
+#define COMPOSITE_VERTICAL_NODATA (-DBL_MAX)
 
-/*@{ Interface functions */
-int Composite_add(Composite_t* composite, RaveCoreObject* object)
+/**
+ * Value in the per radar product fields for columns with only undetect
+ */
+#define COMPOSITE_VERTICAL_UNDETECT (-FLT_MAX)
+
+/**
+ * One radar prepared for the ETOP and VIL products.
+ */
+typedef struct CompositeVerticalRadar_t {
+  PolarNavigator_t* navigator; /**< the navigator of the cube, used for locating the columns */
+  double dscale;               /**< surface distance between two bins in the cube */
+  RaveData2D_t* field;         /**< the product for each column, xsize = nbins and ysize = nrays */
+  const double* data;          /**< the data of the field */
+  long nrays;                  /**< number of rays in the field */
+  long nbins;                  /**< number of bins in the field */
+  Projection_t* projection;    /**< the projection of the radar */
+} CompositeVerticalRadar_t;
+
+/**
+ * The work shared by the threads when generating the ETOP and VIL products.
+ */
+typedef struct CompositeVerticalJob_t {
+  Cartesian_t* image;                /**< the composite */
+  CartesianParam_t* parameter;       /**< the parameter to fill */
+  Projection_t* projection;          /**< the projection of the composite */
+  CompositeVerticalRadar_t* radars;  /**< the radars */
+  int nradars;                       /**< number of radars */
+  double scale;                      /**< factor applied to the values before they are stored */
+} CompositeVerticalJob_t;
+
+/**
+ * Releases the prepared radars.
+ * @param[in] radars - the radars
+ * @param[in] nradars - number of radars
+ */
+static void CompositeInternal_freeVerticalRadars(CompositeVerticalRadar_t* radars, int nradars)
 {
-  CompositeRadarItem_t* item = NULL;
-  int result = 0;
-  RAVE_ASSERT((composite != NULL), "composite == NULL");
-  RAVE_ASSERT((object != NULL), "object == NULL");
+  int i = 0;
+  for (i = 0; radars != NULL && i < nradars; i++) {
+    RAVE_OBJECT_RELEASE(radars[i].navigator);
+    RAVE_OBJECT_RELEASE(radars[i].field);
+    RAVE_OBJECT_RELEASE(radars[i].projection);
+  }
+  RAVE_FREE(radars);
+}
 
-  if (!RAVE_OBJECT_CHECK_TYPE(object, &PolarVolume_TYPE) &&
-      !RAVE_OBJECT_CHECK_TYPE(object, &PolarScan_TYPE)) {
-    RAVE_ERROR0("Providing an object that not is a PolarVolume nor a PolarScan during composite generation");
+/**
+ * Prepares one radar by calculating the product for every column of its cube. Only the product and what is
+ * needed for locating the columns is kept, the cube is released when the product has been calculated.
+ * @param[in] composite - self
+ * @param[in] obj - the radar, only polar volumes are used
+ * @param[in] quantity - the reflectivity quantity
+ * @param[out] radar - the prepared radar
+ * @return 1 if the radar should be used, 0 if the radar can not contribute
+ */
+static int CompositeInternal_prepareVerticalRadar(Composite_t* composite, RaveCoreObject* obj, const char* quantity, CompositeVerticalRadar_t* radar)
+{
+  PolarVolume_t* pvol = NULL;
+  PolarCube_t* cube = NULL;
+
+  if (obj == NULL || !RAVE_OBJECT_CHECK_TYPE(obj, &PolarVolume_TYPE)) {
+    RAVE_WARNING0("ETOP and VIL can only be generated from polar volumes, ignoring object");
     return 0;
   }
-  item = RAVE_MALLOC(sizeof(CompositeRadarItem_t));
-  if (item != NULL) {
-    item->object = RAVE_OBJECT_COPY(object);
-    result = RaveList_add(composite->objectList, item);
-    if (result == 0) {
-      RAVE_OBJECT_RELEASE(item->object);
-      RAVE_FREE(item);
-    }
-    item->radarIndexValue = RaveList_size(composite->objectList);
+  pvol = (PolarVolume_t*)obj;
+  if (!PolarVolume_isTransformable(pvol)) {
+    return 0;
   }
-
-  return result;
+  cube = PolarVolume_getCube(pvol, quantity, 0, 0);
+  if (cube == NULL) {
+    return 0;
+  }
+  if (composite->ptype == Rave_ProductType_ETOP) {
+    radar->field = PolarCube_echoTop(cube, composite->threshold, COMPOSITE_VERTICAL_NODATA, COMPOSITE_VERTICAL_UNDETECT);
+  } else {
+    radar->field = PolarCube_vil(cube, COMPOSITE_VERTICAL_NODATA, COMPOSITE_VERTICAL_UNDETECT);
+  }
+  radar->navigator = PolarCube_getNavigator(cube);
+  radar->dscale = PolarCube_getDscale(cube);
+  radar->nrays = PolarCube_getNrays(cube);
+  radar->nbins = PolarCube_getNbins(cube);
+  radar->projection = PolarVolume_getProjection(pvol);
+  RAVE_OBJECT_RELEASE(cube);
+  if (radar->field == NULL || radar->navigator == NULL || radar->projection == NULL ||
+      radar->dscale <= 0.0 || radar->nrays <= 0 || radar->nbins <= 0) {
+    RAVE_OBJECT_RELEASE(radar->navigator);
+    RAVE_OBJECT_RELEASE(radar->field);
+    RAVE_OBJECT_RELEASE(radar->projection);
+    return 0;
+  }
+  radar->data = (const double*)RaveData2D_getReadOnlyData(radar->field);
+  return 1;
 }
 
-int Composite_getNumberOfObjects(Composite_t* composite)
+/**
+ * Locates the column in a prepared radar in the same way as \ref PolarCube_getColumn.
+ * @param[in] radar - the prepared radar
+ * @param[in] lon - the longitude (radians)
+ * @param[in] lat - the latitude (radians)
+ * @param[out] ri - the ray index
+ * @param[out] bi - the bin index
+ * @return 1 if the location is covered by the radar, otherwise 0
+ */
+static int CompositeInternal_getVerticalColumn(CompositeVerticalRadar_t* radar, double lon, double lat, long* ri, long* bi)
 {
-  RAVE_ASSERT((composite != NULL), "composite == NULL");
-  return RaveList_size(composite->objectList);
+  double d = 0.0, a = 0.0;
+  long r = 0, b = 0;
+  PolarNavigator_llToDa(radar->navigator, lat, lon, &d, &a);
+  b = (long)floor(d / radar->dscale);
+  if (b < 0 || b >= radar->nbins) {
+    return 0;
+  }
+  r = (long)floor(a * (double)radar->nrays / (2.0 * M_PI) + 0.5) % radar->nrays;
+  if (r < 0) {
+    r += radar->nrays;
+  }
+  *ri = r;
+  *bi = b;
+  return 1;
 }
 
-RaveCoreObject* Composite_get(Composite_t* composite, int index)
+/**
+ * Creates the projection pipelines of one worker since the pipelines can not be shared between threads.
+ */
+static int CompositeInternal_initVerticalWorker(void* arg, void** worker)
 {
-  CompositeRadarItem_t* item = NULL;
-  RAVE_ASSERT((composite != NULL), "composite == NULL");
-  item = (CompositeRadarItem_t*)RaveList_get(composite->objectList, index);
-  if (item != NULL) {
-    return RAVE_OBJECT_COPY(item->object);
+  CompositeVerticalJob_t* job = (CompositeVerticalJob_t*)arg;
+  ProjectionPipeline_t** pipelines = NULL;
+  int i = 0;
+
+  pipelines = RAVE_CALLOC((job->nradars > 0 ? job->nradars : 1), sizeof(ProjectionPipeline_t*));
+  *worker = pipelines;
+  if (pipelines == NULL) {
+    RAVE_ERROR0("Failed to allocate memory for pipelines");
+    return 0;
   }
-  return NULL;
+  for (i = 0; i < job->nradars; i++) {
+    pipelines[i] = ProjectionPipeline_createPipeline(job->projection, job->radars[i].projection);
+    if (pipelines[i] == NULL) {
+      RAVE_ERROR0("Failed to create pipeline");
+      return 0;
+    }
+  }
+  return 1;
 }
 
-int Composite_getRadarIndexValue(Composite_t* composite, int index)
+/**
+ * Releases the projection pipelines of one worker.
+ */
+static void CompositeInternal_releaseVerticalWorker(void* arg, void* worker)
 {
-  CompositeRadarItem_t* item = NULL;
-  RAVE_ASSERT((composite != NULL), "composite == NULL");
-  item = (CompositeRadarItem_t*)RaveList_get(composite->objectList, index);
-  if (item != NULL) {
-    return item->radarIndexValue;
+  CompositeVerticalJob_t* job = (CompositeVerticalJob_t*)arg;
+  ProjectionPipeline_t** pipelines = (ProjectionPipeline_t**)worker;
+  int i = 0;
+  for (i = 0; pipelines != NULL && i < job->nradars; i++) {
+    RAVE_OBJECT_RELEASE(pipelines[i]);
   }
-  return 0;
-
+  RAVE_FREE(pipelines);
 }
 
-void Composite_setProduct(Composite_t* composite, Rave_ProductType type)
+/**
+ * Generates one row of the ETOP or VIL product.
+ */
+static int CompositeInternal_generateVerticalRow(void* arg, void* worker, long y)
 {
-  RAVE_ASSERT((composite != NULL), "composite == NULL");
-  if (type == Rave_ProductType_PCAPPI ||
-      type == Rave_ProductType_CAPPI ||
-      type == Rave_ProductType_PPI ||
-      type == Rave_ProductType_PMAX ||
-      type == Rave_ProductType_MAX) {
-    composite->ptype = type;
-  } else {
-    RAVE_ERROR0("Only supported algorithms are PPI, CAPPI, PCAPPI, PMAX and MAX");
+  CompositeVerticalJob_t* job = (CompositeVerticalJob_t*)arg;
+  ProjectionPipeline_t** pipelines = (ProjectionPipeline_t**)worker;
+  long xsize = Cartesian_getXSize(job->image);
+  double herey = Cartesian_getLocationY(job->image, y);
+  long x = 0;
+  int i = 0;
+  RAVE_STATS_TIMER_START(selectStart);
+
+  RAVE_STATS_COUNT(RaveStats_Counter_COMPOSITE_PIXELS, xsize);
+  for (x = 0; x < xsize; x++) {
+    double herex = Cartesian_getLocationX(job->image, x);
+    double value = COMPOSITE_VERTICAL_NODATA;
+    RaveValueType vtype = RaveValueType_NODATA;
+
+    for (i = 0; i < job->nradars; i++) {
+      double olon = 0.0, olat = 0.0;
+      long ri = 0, bi = 0;
+      if (CompositeInternal_projectionFwd(pipelines[i], herex, herey, &olon, &olat) &&
+          CompositeInternal_getVerticalColumn(&job->radars[i], olon, olat, &ri, &bi)) {
+        double v = job->radars[i].data[ri * job->radars[i].nbins + bi];
+        value = (v > value) ? v : value;
+      }
+    }
+    if (value == COMPOSITE_VERTICAL_UNDETECT) {
+      vtype = RaveValueType_UNDETECT;
+    } else if (value != COMPOSITE_VERTICAL_NODATA) {
+      vtype = RaveValueType_DATA;
+      value *= job->scale;
+    }
+    CartesianParam_setConvertedValue(job->parameter, x, y, value, vtype);
   }
+  RAVE_STATS_TIMER_STOP(selectStart, RaveStats_Timer_COMPOSITE_SELECT);
+  return 1;
 }
 
-Rave_ProductType Composite_getProduct(Composite_t* composite)
+/**
+ * Generates the echo top (ETOP) or vertically integrated liquid water (VIL). The product is calculated for
+ * every column of each radar with the vertical kernels of \ref PolarCube_t and the composite rows are then
+ * shared by the threads. Where several radars cover a pixel the highest value is used.
+ *
+ * @param[in] composite - self
+ * @param[in] area - the area we are working with
+ * @param[in] qualityflags - not used for these products
+ * @return the cartesian product
+ */
+static Cartesian_t* Composite_vertical(Composite_t* composite, Area_t* area, RaveList_t* qualityflags)
 {
+  Cartesian_t* result = NULL;
+  CompositeVerticalJob_t job;
+  const char* quantity = NULL;
+  int i = 0, nobjects = 0;
+
   RAVE_ASSERT((composite != NULL), "composite == NULL");
-  return composite->ptype;
-}
+  memset(&job, 0, sizeof(CompositeVerticalJob_t));
 
-int Composite_setSelectionMethod(Composite_t* self, CompositeSelectionMethod_t method)
-{
-  int result = 0;
-  RAVE_ASSERT((self != NULL), "self == NULL");
-  if (method >= CompositeSelectionMethod_NEAREST && method <= CompositeSelectionMethod_HEIGHT) {
-    self->method = method;
-    result = 1;
+  if (area == NULL) {
+    RAVE_ERROR0("Trying to generate composite with NULL area");
+    goto fail;
   }
-  return result;
-}
+  if (Composite_getParameterCount(composite) != 1) {
+    RAVE_ERROR0("ETOP and VIL must be generated from exactly one reflectivity parameter");
+    goto fail;
+  }
+  if (qualityflags != NULL && RaveList_size(qualityflags) > 0) {
+    RAVE_INFO0("Quality flags are not generated for ETOP and VIL");
+  }
+  quantity = Composite_getParameter(composite, 0, NULL, NULL);
 
-CompositeSelectionMethod_t Composite_getSelectionMethod(Composite_t* self)
-{
-  RAVE_ASSERT((self != NULL), "self == NULL");
-  return self->method;
-}
+  result = CompositeInternal_createCompositeImage(composite, area);
+  if (result == NULL) {
+    goto fail;
+  }
+  job.image = result;
+  job.parameter = Cartesian_getParameter(result, CompositeInternal_getProductQuantity(composite, quantity));
+  job.projection = Cartesian_getProjection(result);
+  job.scale = (composite->ptype == Rave_ProductType_ETOP) ? 0.001 : 1.0; /* ETOP in km */
+  /* Make sure the data is not shared before the workers start to write to it */
+  if (job.parameter == NULL || job.projection == NULL || CartesianParam_getData(job.parameter) == NULL) {
+    RAVE_ERROR0("Failure in parameter handling");
+    goto fail;
+  }
 
-int Composite_setInterpolationMethod(Composite_t* self, CompositeInterpolationMethod_t interpolationMethod)
-{
-  int result = 0;
-  RAVE_ASSERT((self != NULL), "self == NULL");
-  if (interpolationMethod >= CompositeInterpolationMethod_NEAREST && interpolationMethod <= CompositeInterpolationMethod_QUADRATIC_3D) {
-    self->interpolationMethod = interpolationMethod;
-    result = 1;
+  nobjects = Composite_getNumberOfObjects(composite);
+  job.radars = RAVE_CALLOC((nobjects > 0 ? nobjects : 1), sizeof(CompositeVerticalRadar_t));
+  if (job.radars == NULL) {
+    RAVE_ERROR0("Failed to allocate memory for radars");
+    goto fail;
+  }
+  for (i = 0; i < nobjects; i++) {
+    RaveCoreObject* obj = Composite_get(composite, i);
+    if (CompositeInternal_prepareVerticalRadar(composite, obj, quantity, &job.radars[job.nradars])) {
+      job.nradars++;
+    }
+    RAVE_OBJECT_RELEASE(obj);
+  }
+
+  if (!RaveRowPool_run(Cartesian_getYSize(result), composite->nthreads, CompositeInternal_generateVerticalRow,
+                       CompositeInternal_initVerticalWorker, CompositeInternal_releaseVerticalWorker, &job)) {
+    goto fail;
   }
+
+  CompositeInternal_freeVerticalRadars(job.radars, job.nradars);
+  RAVE_OBJECT_RELEASE(job.parameter);
+  RAVE_OBJECT_RELEASE(job.projection);
   return result;
+fail:
+  CompositeInternal_freeVerticalRadars(job.radars, job.nradars);
+  RAVE_OBJECT_RELEASE(job.parameter);
+  RAVE_OBJECT_RELEASE(job.projection);
+  RAVE_OBJECT_RELEASE(result);
+  return NULL;
 }
 
-CompositeInterpolationMethod_t Composite_getInterpolationMethod(Composite_t* self)
-{
-  RAVE_ASSERT((self != NULL), "self == NULL");
-  return self->interpolationMethod;
-}
+/**
+ * Work buffers used when the composite algorithm fills its quality fields one row at a time.
+ */
+typedef struct CompositeRowBuffers_t {
+  int xsize;                          /**< number of pixels in a row */
+  int nparam;                         /**< number of parameters */
+  int nradars;                        /**< number of objects in the composite */
+  RaveCoreObject** objects;           /**< the composite objects indexed by radar index (nradars) */
+  RaveCoreObject** qobjs;             /**< the selected object for each parameter and pixel (nparam * xsize) */
+  int* qindex;                        /**< the selected radar index for each parameter and pixel (nparam * xsize) */
+  PolarNavigationInfo* qnavinfo;      /**< the selected navigation info for each parameter and pixel (nparam * xsize) */
+} CompositeRowBuffers_t;
 
-void Composite_setHeight(Composite_t* composite, double height)
+/**
+ * Releases the row buffers.
+ * @param[in] rb - the row buffers
+ */
+static void CompositeInternal_freeRowBuffers(CompositeRowBuffers_t* rb)
 {
-  RAVE_ASSERT((composite != NULL), "composite == NULL");
-  composite->height = height;
+  int i = 0;
+  if (rb != NULL) {
+    for (i = 0; rb->objects != NULL && i < rb->nradars; i++) {
+      RAVE_OBJECT_RELEASE(rb->objects[i]);
+    }
+    RAVE_FREE(rb->objects);
+    RAVE_FREE(rb->qobjs);
+    RAVE_FREE(rb->qindex);
+    RAVE_FREE(rb->qnavinfo);
+    RAVE_FREE(rb);
+  }
 }
 
-double Composite_getHeight(Composite_t* composite)
+/**
+ * Creates the row buffers for \ref CompositeAlgorithm_fillQualityRow.
+ * @param[in] composite - self
+ * @param[in] xsize - the number of pixels in a row
+ * @param[in] nparam - the number of parameters
+ * @return the row buffers or NULL on failure
+ */
+static CompositeRowBuffers_t* CompositeInternal_createRowBuffers(Composite_t* composite, int xsize, int nparam)
 {
-  RAVE_ASSERT((composite != NULL), "composite == NULL");
-  return composite->height;
-}
+  CompositeRowBuffers_t* rb = NULL;
+  int i = 0, ok = 1;
 
-void Composite_setElevationAngle(Composite_t* composite, double angle)
-{
-  RAVE_ASSERT((composite != NULL), "composite == NULL");
-  composite->elangle = angle;
+  rb = RAVE_MALLOC(sizeof(CompositeRowBuffers_t));
+  if (rb == NULL) {
+    RAVE_ERROR0("Failed to allocate memory for row buffers");
+    return NULL;
+  }
+  memset(rb, 0, sizeof(CompositeRowBuffers_t));
+  rb->xsize = xsize;
+  rb->nparam = nparam;
+  rb->nradars = Composite_getNumberOfObjects(composite);
+
+  if (rb->nradars > 0) {
+    rb->objects = RAVE_MALLOC(sizeof(RaveCoreObject*) * rb->nradars);
+    ok = (rb->objects != NULL);
+    for (i = 0; ok && i < rb->nradars; i++) {
+      rb->objects[i] = Composite_get(composite, i);
+    }
+  }
+
+  if (ok) {
+    rb->qobjs = RAVE_MALLOC(sizeof(RaveCoreObject*) * xsize * nparam);
+    rb->qindex = RAVE_MALLOC(sizeof(int) * xsize * nparam);
+    rb->qnavinfo = RAVE_MALLOC(sizeof(PolarNavigationInfo) * xsize * nparam);
+    ok = (rb->qobjs != NULL && rb->qindex != NULL && rb->qnavinfo != NULL);
+    if (ok) {
+      memset(rb->qobjs, 0, sizeof(RaveCoreObject*) * xsize * nparam);
+    }
+  }
+
+  if (!ok) {
+    RAVE_ERROR0("Failed to allocate memory for row buffers");
+    CompositeInternal_freeRowBuffers(rb);
+    rb = NULL;
+  }
+  return rb;
+}
+
+/**
+ * Sets the value and the quality information for one pixel when all radars have been processed.
+ * @param[in] composite - self
+ * @param[in] x - x coordinate
+ * @param[in] y - y coordinate
+ * @param[in] olon - the last longitude (radians) that was calculated for the pixel, used by PMAX
+ * @param[in] olat - the last latitude (radians) that was calculated for the pixel, used by PMAX
+ * @param[in] cvalues - the composite values for the pixel (nparam)
+ * @param[in] nparam - the number of parameters
+ * @param[in] interpolationDimensions - dimensions to perform interpolation in
+ * @param[in] qstores - the quality stores or NULL
+ * @param[in] nqualityflags - the number of quality flags
+ * @param[in] nalgorithmflags - the number of quality flags filled by the algorithm when using quality stores
+ * @param[in] rb - if the quality information filled by the algorithm is filled one row at a time, the row
+ *                 buffers where the selected objects are recorded, otherwise NULL
+ */
+static void CompositeInternal_setCompositePixel(Composite_t* composite, int x, int y, double olon, double olat,
+  CompositeValues_t* cvalues, int nparam, int interpolationDimensions[], CompositeQualityStore_t** qstores,
+  int nqualityflags, int nalgorithmflags, CompositeRowBuffers_t* rb)
+{
+  int cindex = 0;
+  int qualityRow = (rb != NULL && rb->qobjs != NULL);
+
+  for (cindex = 0; cindex < nparam; cindex++) {
+    double vvalue = cvalues[cindex].value;
+    double vtype = cvalues[cindex].vtype;
+
+    if (vtype != RaveValueType_NODATA && composite->ptype == Rave_ProductType_PMAX && cvalues[cindex].radardist < composite->range) {
+      // only support for nearest value interpolation with PMAX, meaning that we only have one value position
+      PolarNavigationInfo info = cvalues[cindex].valuePositions[0].navinfo;
+
+      RaveValueType ntype = RaveValueType_NODATA;
+      double nvalue = 0.0;
+      if (vtype == RaveValueType_UNDETECT) {
+        /* Undetect should not affect navigation information */
+        CompositeInternal_getVerticalMaxValue(composite, cvalues[cindex].radarindex, cvalues[cindex].name, olon, olat, &ntype, &nvalue, NULL, NULL);
+      } else {
+        CompositeInternal_getVerticalMaxValue(composite, cvalues[cindex].radarindex, cvalues[cindex].name, olon, olat, &ntype, &nvalue, &info, NULL);
+      }
+      if (ntype != RaveValueType_NODATA) {
+        vtype = ntype;
+        vvalue = nvalue;
+        cvalues[cindex].valuePositions[0].navinfo = info;
+      }
+    }
+
+    CartesianParam_setConvertedValue(cvalues[cindex].parameter, x, y, vvalue, vtype);
+
+    if (qualityRow) {
+      rb->qobjs[cindex * rb->xsize + x] = NULL;
+    }
+
+    if ((vtype == RaveValueType_DATA || vtype == RaveValueType_UNDETECT) &&
+        cvalues[cindex].radarindex >= 0 && nqualityflags > 0) {
+      if (qualityRow && cvalues[cindex].radarindex < rb->nradars) {
+        rb->qobjs[cindex * rb->xsize + x] = rb->objects[cvalues[cindex].radarindex];
+        rb->qindex[cindex * rb->xsize + x] = cvalues[cindex].radarindex;
+        rb->qnavinfo[cindex * rb->xsize + x] = cvalues[cindex].valuePositions[0].navinfo;
+      }
+      if (qstores != NULL) {
+        CompositeInternal_recordQuality(qstores[cindex], x, y, cvalues[cindex].radarindex, cvalues[cindex].radardist, &cvalues[cindex].valuePositions[0].navinfo);
+        if (nalgorithmflags > 0 && !qualityRow) {
+          CompositeInternal_fillQualityInformation(composite, x, y, &cvalues[cindex], interpolationDimensions, qstores[cindex], 0);
+        }
+      } else {
+        CompositeInternal_fillQualityInformation(composite, x, y, &cvalues[cindex], interpolationDimensions, NULL, qualityRow);
+      }
+    }
+  }
+}
+
+/**
+ * Lets the algorithm fill the quality fields it supports for one row.
+ * @param[in] composite - self
+ * @param[in] cvalues - the composite values, used for the parameters (nparam)
+ * @param[in] y - the row
+ * @param[in] rb - the row buffers with the selected objects
+ */
+static void CompositeInternal_fillQualityRow(Composite_t* composite, CompositeValues_t* cvalues, int y, CompositeRowBuffers_t* rb)
+{
+  int cindex = 0, i = 0;
+  RAVE_STATS_SCOPE(RaveStats_Timer_COMPOSITE_QUALITY);
+
+  for (cindex = 0; cindex < rb->nparam; cindex++) {
+    CartesianParam_t* param = cvalues[cindex].parameter;
+    const char* quantity = CartesianParam_getQuantity(param);
+    int nfields = CartesianParam_getNumberOfQualityFields(param);
+    for (i = 0; i < nfields; i++) {
+      RaveField_t* field = CartesianParam_getQualityField(param, i);
+      RaveAttribute_t* attribute = NULL;
+      char* name = NULL;
+      if (field != NULL) {
+        attribute = RaveField_getAttribute(field, "how/task");
+      }
+      if (attribute != NULL) {
+        RaveAttribute_getString(attribute, &name);
+      }
+      if (name != NULL && CompositeInternal_isAlgorithmQualityFlag(composite, name)) {
+        CompositeAlgorithm_fillQualityRow(composite->algorithm, name, quantity, field, y, rb->xsize,
+                                          &rb->qobjs[cindex * rb->xsize], &rb->qindex[cindex * rb->xsize], &rb->qnavinfo[cindex * rb->xsize],
+                                          COMPOSITE_QUALITY_FIELDS_GAIN, COMPOSITE_QUALITY_FIELDS_OFFSET);
+      }
+      RAVE_OBJECT_RELEASE(field);
+      RAVE_OBJECT_RELEASE(attribute);
+    }
+  }
+}
+
+/**
+ * Replaces the product settings in the composite.
+ * @param[in] composite - self
+ * @param[in] product - the product settings to use
+ */
+static void CompositeInternal_applyProduct(Composite_t* composite, const CompositeProduct_t* product)
+{
+  composite->ptype = product->ptype;
+  composite->height = product->height;
+  composite->elangle = product->elangle;
+  composite->method = product->method;
+}
+
+/**
+ * Returns the index of the first product that is navigated in the same way as the product at index p,
+ * i.e. that has the same product type, height and elevation angle. Such products only differ in
+ * selection method and can share the value positions.
+ * @param[in] products - the product definitions
+ * @param[in] p - the index of the product
+ * @return the index of the first product with the same navigation, p if there is none before p
+ */
+static int CompositeInternal_getNavigationGroup(const CompositeProduct_t* products, int p)
+{
+  int q = 0;
+  for (q = 0; q < p; q++) {
+    if (products[q].ptype == products[p].ptype &&
+        products[q].height == products[p].height &&
+        products[q].elangle == products[p].elangle) {
+      return q;
+    }
+  }
+  return p;
+}
+
+/**
+ * Creates a composite that shares the radar objects with the source composite but has its own
+ * settings, parameters and algorithm. Used when several areas are generated concurrently from
+ * the same polar data.
+ * @param[in] src - the composite to share objects with
+ * @return the composite or NULL on failure
+ */
+static Composite_t* CompositeInternal_createSharedComposite(Composite_t* src)
+{
+  Composite_t* result = NULL;
+  int i = 0, nobjects = 0;
+
+  result = RAVE_OBJECT_NEW(&Composite_TYPE);
+  if (result == NULL) {
+    return NULL;
+  }
+  result->ptype = src->ptype;
+  result->method = src->method;
+  result->interpolationMethod = src->interpolationMethod;
+  result->height = src->height;
+  result->elangle = src->elangle;
+  result->range = src->range;
+  result->lazyQuality = src->lazyQuality;
+  result->threshold = src->threshold;
+  result->nthreads = 1; /* The areas are already generated concurrently */
+
+  CompositeInternal_freeParameterList(&result->parameters);
+  RAVE_OBJECT_RELEASE(result->datetime);
+  result->parameters = CompositeInternal_cloneParameterList(src->parameters);
+  result->datetime = RAVE_OBJECT_CLONE(src->datetime);
+  if (result->parameters == NULL || result->datetime == NULL ||
+      !Composite_setQualityIndicatorFieldName(result, src->qiFieldName)) {
+    goto fail;
+  }
+
+  nobjects = RaveList_size(src->objectList);
+  for (i = 0; i < nobjects; i++) {
+    CompositeRadarItem_t* item = (CompositeRadarItem_t*)RaveList_get(src->objectList, i);
+    if (!Composite_add(result, item->object)) {
+      goto fail;
+    }
+    ((CompositeRadarItem_t*)RaveList_get(result->objectList, i))->radarIndexValue = item->radarIndexValue;
+  }
+
+  if (src->algorithm != NULL) {
+    result->algorithm = RAVE_OBJECT_CLONE(src->algorithm);
+    if (result->algorithm == NULL) {
+      goto fail;
+    }
+  }
+  return result;
+fail:
+  RAVE_OBJECT_RELEASE(result);
+  return NULL;
+}
+
+/**
+ * The work shared by the threads in \ref Composite_generateMany.
+ */
+typedef struct CompositeManyJob_t {
+  Composite_t* composite;       /**< the prepared composite */
+  RaveObjectList_t* areas;      /**< the areas */
+  RaveList_t* qualityflags;     /**< the quality flags */
+  Cartesian_t** results;        /**< one result per area */
+} CompositeManyJob_t;
+
+/**
+ * Creates the composite of one worker. Each worker uses its own composite sharing the polar objects
+ * since the algorithm keeps state during the generation.
+ */
+static int CompositeInternal_initManyWorker(void* arg, void** worker)
+{
+  CompositeManyJob_t* job = (CompositeManyJob_t*)arg;
+  *worker = CompositeInternal_createSharedComposite(job->composite);
+  return (*worker != NULL);
+}
+
+/**
+ * Releases the composite of one worker.
+ */
+static void CompositeInternal_releaseManyWorker(void* arg, void* worker)
+{
+  Composite_t* composite = (Composite_t*)worker;
+  RAVE_OBJECT_RELEASE(composite);
+}
+
+/**
+ * Generates the composite for one area.
+ */
+static int CompositeInternal_generateManyArea(void* arg, void* worker, long a)
+{
+  CompositeManyJob_t* job = (CompositeManyJob_t*)arg;
+  Area_t* area = (Area_t*)RaveObjectList_get(job->areas, (int)a);
+  job->results[a] = Composite_generate((Composite_t*)worker, area, job->qualityflags);
+  RAVE_OBJECT_RELEASE(area);
+  if (job->results[a] == NULL) {
+    RAVE_ERROR1("Failed to generate composite for area %ld", a);
+    return 0;
+  }
+  return 1;
+}
+
+/**
+ * What is prepared once before one or more composite images are generated over the same projection,
+ * e.g. the blocks in \ref Composite_generateBlocks.
+ */
+typedef struct CompositeGenerator_t {
+  Projection_t* projection;     /**< the projection of the composite */
+  RaveObjectList_t* pipelines;  /**< one projection pipeline per radar */
+  int interpolationDimensions[NO_OF_COMPOSITE_INTERPOLATION_DIMENSIONS]; /**< dimensions to perform interpolation in */
+  int nparam;                   /**< number of parameters */
+  int nradars;                  /**< number of radars */
+  int nqualityflags;            /**< number of quality flags */
+  int nalgorithmflags;          /**< number of quality flags filled by the algorithm when using quality stores */
+  int useQualityStore;          /**< if the quality fields should be derived from quality stores */
+  CompositeRowBuffers_t* rb;    /**< the row buffers if the algorithm fills the quality one row at a time, otherwise NULL */
+} CompositeGenerator_t;
+
+/**
+ * Releases what has been prepared by \ref CompositeInternal_prepareGenerator.
+ * @param[in] gen - the generator
+ */
+static void CompositeInternal_releaseGenerator(CompositeGenerator_t* gen)
+{
+  CompositeInternal_freeRowBuffers(gen->rb);
+  gen->rb = NULL;
+  RAVE_OBJECT_RELEASE(gen->projection);
+  RAVE_OBJECT_RELEASE(gen->pipelines);
+}
+
+/**
+ * Prepares the generation of composite images over the projection of the area, i.e. decides how the
+ * quality should be handled, initializes the algorithm and prepares the radars and the projection pipelines.
+ * @param[in] composite - self
+ * @param[in] area - the area, only the projection and xsize are used
+ * @param[in] qualityflags - the quality flags (may be NULL)
+ * @param[in] allowQualityStore - if the quality fields may be derived from quality stores when they are requested
+ * @param[out] gen - the generator, must be released with \ref CompositeInternal_releaseGenerator also on failure
+ * @return 1 on success otherwise 0
+ */
+static int CompositeInternal_prepareGenerator(Composite_t* composite, Area_t* area, RaveList_t* qualityflags, int allowQualityStore, CompositeGenerator_t* gen)
+{
+  int i = 0;
+
+  memset(gen, 0, sizeof(CompositeGenerator_t));
+  CompositeInternal_setInterpolationDimensionsArray(composite, gen->interpolationDimensions);
+
+  gen->nparam = Composite_getParameterCount(composite);
+  if (gen->nparam <= 0) {
+    RAVE_ERROR0("You can not generate a composite without specifying at least one parameter");
+    return 0;
+  }
+  gen->nradars = Composite_getNumberOfObjects(composite);
+
+  gen->projection = Area_getProjection(area);
+  if (gen->projection == NULL) {
+    RAVE_ERROR0("Area does not have a projection");
+    return 0;
+  }
+
+  if (qualityflags != NULL) {
+    gen->nqualityflags = RaveList_size(qualityflags);
+    /* With nearest interpolation the quality information for a pixel is given by the winning radar and
+     * one bin, so only that is recorded and the quality fields are derived when they are requested. */
+    if (allowQualityStore && composite->lazyQuality && gen->nqualityflags > 0 &&
+        composite->interpolationMethod == CompositeInterpolationMethod_NEAREST &&
+        CompositeInternal_useQualityStore(composite, qualityflags)) {
+      gen->useQualityStore = 1;
+      for (i = 0; i < gen->nqualityflags; i++) {
+        if (CompositeInternal_isAlgorithmQualityFlag(composite, (const char*)RaveList_get(qualityflags, i))) {
+          gen->nalgorithmflags++;
+        }
+      }
+    }
+  }
+
+  if (composite->algorithm != NULL) {
+    if (!CompositeAlgorithm_initialize(composite->algorithm, composite)) {
+      return 0;
+    }
+    if (CompositeAlgorithm_supportsFillQualityRow(composite->algorithm) && gen->nqualityflags > 0 &&
+        composite->interpolationMethod == CompositeInterpolationMethod_NEAREST) {
+      gen->rb = CompositeInternal_createRowBuffers(composite, Area_getXSize(area), gen->nparam);
+      if (gen->rb == NULL) {
+        return 0;
+      }
+    }
+  }
+
+  gen->pipelines = RAVE_OBJECT_NEW(&RaveObjectList_TYPE);
+  if (gen->pipelines == NULL) {
+    return 0;
+  }
+  for (i = 0; i < gen->nradars; i++) {
+    RaveCoreObject* obj = Composite_get(composite, i);
+    if (obj != NULL) {
+      Projection_t* objproj = CompositeInternal_getProjection(obj);
+      ProjectionPipeline_t* pipeline = NULL;
+      if (objproj == NULL) {
+        RAVE_OBJECT_RELEASE(obj);
+        RAVE_ERROR0("No projection for object");
+        return 0;
+      }
+      /* Sort once up front instead of for every pixel */
+      CompositeInternal_ensureAscendingScans(obj);
+      pipeline = ProjectionPipeline_createPipeline(gen->projection, objproj);
+      RAVE_OBJECT_RELEASE(objproj);
+      RAVE_OBJECT_RELEASE(obj);
+      if (pipeline == NULL || !RaveObjectList_add(gen->pipelines, (RaveCoreObject*)pipeline)) {
+        RAVE_ERROR0("Failed to create pipeline");
+        RAVE_OBJECT_RELEASE(pipeline);
+        return 0;
+      }
+      RAVE_OBJECT_RELEASE(pipeline);
+    }
+  }
+  return 1;
+}
+
+/**
+ * Generates one composite image with what has been prepared by \ref CompositeInternal_prepareGenerator.
+ * @param[in] composite - self
+ * @param[in] gen - the prepared generator
+ * @param[in] area - the area of the image, must have the same projection and xsize as the prepared area
+ * @param[in] qualityflags - the quality flags (may be NULL)
+ * @return the composite image on success otherwise NULL
+ */
+static Cartesian_t* CompositeInternal_generateImage(Composite_t* composite, CompositeGenerator_t* gen, Area_t* area, RaveList_t* qualityflags)
+{
+  Cartesian_t* result = NULL;
+  CompositeValues_t* cvalues = NULL;
+  CompositeQualityStore_t** qstores = NULL;
+  int x = 0, y = 0, i = 0, xsize = 0, ysize = 0;
+  int nparam = gen->nparam;
+
+  result = CompositeInternal_createCompositeImage(composite, area);
+  if (result == NULL) {
+    goto fail;
+  }
+
+  if ((cvalues = CompositeInternal_createCompositeValues(nparam)) == NULL) {
+    goto fail;
+  }
+
+  for (i = 0; i < nparam; i++) {
+    const char* name = Composite_getParameter(composite, i, NULL, NULL);
+    cvalues[i].parameter = Cartesian_getParameter(result, name); // Keep track on parameters
+    if (cvalues[i].parameter == NULL) {
+      RAVE_ERROR0("Failure in parameter handling\n");
+      goto fail;
+    }
+  }
+
+  xsize = Cartesian_getXSize(result);
+  ysize = Cartesian_getYSize(result);
+
+  if (gen->useQualityStore) {
+    qstores = RAVE_MALLOC(sizeof(CompositeQualityStore_t*) * nparam);
+    if (qstores == NULL) {
+      goto fail;
+    }
+    memset(qstores, 0, sizeof(CompositeQualityStore_t*) * nparam);
+    for (i = 0; i < nparam; i++) {
+      qstores[i] = CompositeInternal_createQualityStore(composite, Composite_getParameter(composite, i, NULL, NULL), xsize, ysize);
+      if (qstores[i] == NULL) {
+        goto fail;
+      }
+    }
+  }
+  if (qualityflags != NULL) {
+    if (!CompositeInternal_addQualityFlags(composite, result, qualityflags, qstores, qstores != NULL ? nparam : 0)) {
+      goto fail;
+    }
+  }
+
+  for (i = 0; qstores != NULL && i < nparam; i++) {
+    if (!CompositeInternal_takeQualitySnapshots(composite, qstores[i], qualityflags)) {
+      goto fail;
+    }
+  }
+
+  for (y = 0; y < ysize; y++) {
+    double herey = Cartesian_getLocationY(result, y);
+    RAVE_STATS_TIMER_START(selectStart);
+    RAVE_STATS_COUNT(RaveStats_Counter_COMPOSITE_PIXELS, xsize);
+    for (x = 0; x < xsize; x++) {
+      double herex = Cartesian_getLocationX(result, x);
+      double olon = 0.0, olat = 0.0;
+
+      CompositeInternal_resetCompositeValues(composite, nparam, cvalues);
+      if (composite->algorithm != NULL) {
+        CompositeAlgorithm_reset(composite->algorithm, x, y);
+      }
+
+      for (i = 0; i < gen->nradars; i++) {
+        RaveCoreObject* obj = NULL;
+        ProjectionPipeline_t* pipeline = NULL;
+        obj = Composite_get(composite, i);
+        if (obj != NULL) {
+          pipeline = (ProjectionPipeline_t*)RaveObjectList_get(gen->pipelines, i);
+        }
+
+        if (pipeline != NULL) {
+          /* We will go from surface coords into the lonlat projection assuming that a polar volume uses a lonlat projection*/
+          if (!CompositeInternal_projectionFwd(pipeline, herex, herey, &olon, &olat)) {
+            RAVE_WARNING0("Failed to transform from composite into polar coordinates");
+          } else {
+            double dist = 0.0;
+            double maxdist = 0.0;
+            if (RAVE_OBJECT_CHECK_TYPE(obj, &PolarVolume_TYPE)) {
+              dist = PolarVolume_getDistance((PolarVolume_t*)obj, olon, olat);
+              maxdist = PolarVolume_getMaxDistance((PolarVolume_t*)obj);
+            } else if (RAVE_OBJECT_CHECK_TYPE(obj, &PolarScan_TYPE)) {
+              dist = PolarScan_getDistance((PolarScan_t*)obj, olon, olat);
+              maxdist = PolarScan_getMaxDistance((PolarScan_t*)obj);
+            }
+            if (dist <= maxdist) {
+              if (!CompositeInternal_selectValue(composite, obj, i, olon, olat, dist, gen->interpolationDimensions, cvalues, nparam)) {
+                RAVE_OBJECT_RELEASE(obj);
+                RAVE_OBJECT_RELEASE(pipeline);
+                goto fail;
+              }
+            }
+          }
+        }
+        RAVE_OBJECT_RELEASE(obj);
+        RAVE_OBJECT_RELEASE(pipeline);
+      }
+
+      CompositeInternal_setCompositePixel(composite, x, y, olon, olat, cvalues, nparam, gen->interpolationDimensions,
+                                          qstores, gen->nqualityflags, gen->nalgorithmflags, gen->rb);
+    }
+    RAVE_STATS_TIMER_STOP(selectStart, RaveStats_Timer_COMPOSITE_SELECT);
+    if (gen->rb != NULL) {
+      CompositeInternal_fillQualityRow(composite, cvalues, y, gen->rb);
+    }
+  }
+
+  goto done;
+fail:
+  RAVE_OBJECT_RELEASE(result);
+done:
+  for (i = 0; cvalues != NULL && i < nparam; i++) {
+    RAVE_OBJECT_RELEASE(cvalues[i].parameter);
+  }
+  RAVE_FREE(cvalues);
+  for (i = 0; qstores != NULL && i < nparam; i++) {
+    RAVE_OBJECT_RELEASE(qstores[i]);
+  }
+  RAVE_FREE(qstores);
+  return result;
+}
+
+/*@} End of Private functions */
+
+/*@{ Interface functions */
+int Composite_add(Composite_t* composite, RaveCoreObject* object)
+{
+  CompositeRadarItem_t* item = NULL;
+  int result = 0;
+  RAVE_ASSERT((composite != NULL), "composite == NULL");
+  RAVE_ASSERT((object != NULL), "object == NULL");
+
+  if (!RAVE_OBJECT_CHECK_TYPE(object, &PolarVolume_TYPE) &&
+      !RAVE_OBJECT_CHECK_TYPE(object, &PolarScan_TYPE)) {
+    RAVE_ERROR0("Providing an object that not is a PolarVolume nor a PolarScan during composite generation");
+    return 0;
+  }
+  item = RAVE_MALLOC(sizeof(CompositeRadarItem_t));
+  if (item != NULL) {
+    item->object = RAVE_OBJECT_COPY(object);
+    result = RaveList_add(composite->objectList, item);
+    if (result == 0) {
+      RAVE_OBJECT_RELEASE(item->object);
+      RAVE_FREE(item);
+    }
+    item->radarIndexValue = RaveList_size(composite->objectList);
+  }
+
+  return result;
+}
+
+int Composite_getNumberOfObjects(Composite_t* composite)
+{
+  RAVE_ASSERT((composite != NULL), "composite == NULL");
+  return RaveList_size(composite->objectList);
+}
+
+RaveCoreObject* Composite_get(Composite_t* composite, int index)
+{
+  CompositeRadarItem_t* item = NULL;
+  RAVE_ASSERT((composite != NULL), "composite == NULL");
+  item = (CompositeRadarItem_t*)RaveList_get(composite->objectList, index);
+  if (item != NULL) {
+    return RAVE_OBJECT_COPY(item->object);
+  }
+  return NULL;
+}
+
+int Composite_getRadarIndexValue(Composite_t* composite, int index)
+{
+  CompositeRadarItem_t* item = NULL;
+  RAVE_ASSERT((composite != NULL), "composite == NULL");
+  item = (CompositeRadarItem_t*)RaveList_get(composite->objectList, index);
+  if (item != NULL) {
+    return item->radarIndexValue;
+  }
+  return 0;
+
+}
+
+void Composite_setProduct(Composite_t* composite, Rave_ProductType type)
+{
+  RAVE_ASSERT((composite != NULL), "composite == NULL");
+  if (type == Rave_ProductType_PCAPPI ||
+      type == Rave_ProductType_CAPPI ||
+      type == Rave_ProductType_PPI ||
+      type == Rave_ProductType_PMAX ||
+      type == Rave_ProductType_MAX ||
+      type == Rave_ProductType_ETOP ||
+      type == Rave_ProductType_VIL) {
+    composite->ptype = type;
+  } else {
+    RAVE_ERROR0("Only supported algorithms are PPI, CAPPI, PCAPPI, PMAX, MAX, ETOP and VIL");
+  }
+}
+
+Rave_ProductType Composite_getProduct(Composite_t* composite)
+{
+  RAVE_ASSERT((composite != NULL), "composite == NULL");
+  return composite->ptype;
+}
+
+int Composite_setSelectionMethod(Composite_t* self, CompositeSelectionMethod_t method)
+{
+  int result = 0;
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  if (method >= CompositeSelectionMethod_NEAREST && method <= CompositeSelectionMethod_HEIGHT) {
+    self->method = method;
+    result = 1;
+  }
+  return result;
+}
+
+CompositeSelectionMethod_t Composite_getSelectionMethod(Composite_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return self->method;
+}
+
+int Composite_setInterpolationMethod(Composite_t* self, CompositeInterpolationMethod_t interpolationMethod)
+{
+  int result = 0;
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  if (interpolationMethod >= CompositeInterpolationMethod_NEAREST && interpolationMethod <= CompositeInterpolationMethod_QUADRATIC_3D) {
+    self->interpolationMethod = interpolationMethod;
+    result = 1;
+  }
+  return result;
+}
+
+CompositeInterpolationMethod_t Composite_getInterpolationMethod(Composite_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return self->interpolationMethod;
+}
+
+void Composite_setHeight(Composite_t* composite, double height)
+{
+  RAVE_ASSERT((composite != NULL), "composite == NULL");
+  composite->height = height;
+}
+
+double Composite_getHeight(Composite_t* composite)
+{
+  RAVE_ASSERT((composite != NULL), "composite == NULL");
+  return composite->height;
+}
+
+void Composite_setElevationAngle(Composite_t* composite, double angle)
+{
+  RAVE_ASSERT((composite != NULL), "composite == NULL");
+  composite->elangle = angle;
 }
 
 double Composite_getElevationAngle(Composite_t* composite)
@@ -2624,6 +4167,35 @@ double Composite_getRange(Composite_t* self)
   return self->range;
 }
 
+void Composite_setEchoTopThreshold(Composite_t* self, double threshold)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  self->threshold = threshold;
+}
+
+double Composite_getEchoTopThreshold(Composite_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return self->threshold;
+}
+
+int Composite_setNumberOfThreads(Composite_t* self, int nthreads)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  if (nthreads < 1) {
+    RAVE_ERROR0("Number of threads must be >= 1");
+    return 0;
+  }
+  self->nthreads = nthreads;
+  return 1;
+}
+
+int Composite_getNumberOfThreads(Composite_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return self->nthreads;
+}
+
 int Composite_setQualityIndicatorFieldName(Composite_t* self, const char* qiFieldName)
 {
   char* tmp = NULL;
@@ -2652,6 +4224,18 @@ const char* Composite_getQualityIndicatorFieldName(Composite_t* self)
   return (const char*)self->qiFieldName;
 }
 
+void Composite_setLazyQuality(Composite_t* self, int lazy)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  self->lazyQuality = lazy ? 1 : 0;
+}
+
+int Composite_getLazyQuality(Composite_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return self->lazyQuality;
+}
+
 int Composite_addParameter(Composite_t* composite, const char* quantity, double gain, double offset, double minvalue)
 {
   int result = 0;
@@ -2751,18 +4335,11 @@ int Composite_applyRadarIndexMapping(Composite_t* composite, RaveObjectHashTable
 Cartesian_t* Composite_generate(Composite_t* composite, Area_t* area, RaveList_t* qualityflags)
 {
   Cartesian_t* result = NULL;
-  Projection_t* projection = NULL;
-  CompositeValuePosition_t valuePositions[MAX_NO_OF_SURROUNDING_POSITIONS];
-  CompositeValues_t* cvalues = NULL;
-  RaveObjectList_t* pipelines = NULL;
-  int interpolationDimensions[NO_OF_COMPOSITE_INTERPOLATION_DIMENSIONS] = {0};
-  int x = 0, y = 0, i = 0, xsize = 0, ysize = 0, nradars = 0;
-  int nqualityflags = 0;
-  int nparam = 0;
+  CompositeGenerator_t gen;
+  RAVE_STATS_SCOPE(RaveStats_Timer_COMPOSITE_GENERATE);
 
   RAVE_ASSERT((composite != NULL), "composite == NULL");
-  
-  CompositeInternal_setInterpolationDimensionsArray(composite, interpolationDimensions);
+  memset(&gen, 0, sizeof(CompositeGenerator_t));
 
   if (composite->ptype == Rave_ProductType_MAX && composite->interpolationMethod != CompositeInterpolationMethod_NEAREST) {
     RAVE_ERROR0("Product type MAX can currently only be used with interpolation method 'nearest value'.");
@@ -2774,47 +4351,119 @@ Cartesian_t* Composite_generate(Composite_t* composite, Area_t* area, RaveList_t
     return Composite_nearest_max(composite, area, qualityflags);
   }
 
+  if (composite->ptype == Rave_ProductType_ETOP || composite->ptype == Rave_ProductType_VIL) {
+    return Composite_vertical(composite, area, qualityflags);
+  }
+
   if (area == NULL) {
     RAVE_ERROR0("Trying to generate composite with NULL area");
-    goto fail;
+    return NULL;
   }
 
-  nparam = Composite_getParameterCount(composite);
-  if (nparam <= 0) {
-    RAVE_ERROR0("You can not generate a composite without specifying at least one parameter");
+  if (CompositeInternal_prepareGenerator(composite, area, qualityflags, 1, &gen)) {
+    result = CompositeInternal_generateImage(composite, &gen, area, qualityflags);
+  }
+  CompositeInternal_releaseGenerator(&gen);
+  return result;
+}
+
+RaveObjectList_t* Composite_generateProducts(Composite_t* self, Area_t* area, RaveList_t* qualityflags, const CompositeProduct_t* products, int nproducts)
+{
+  RaveObjectList_t* result = NULL;
+  RaveObjectList_t* pipelines = NULL;
+  Composite_t* composite = NULL;
+  Cartesian_t* image = NULL;
+  Projection_t* projection = NULL;
+  CompositeValues_t** cvalues = NULL;
+  RaveCoreObject** objects = NULL;
+  double *lon = NULL, *lat = NULL, *dist = NULL, *lastlon = NULL, *lastlat = NULL;
+  unsigned char* valid = NULL;
+  CompositeValuePosition_t* valuePositions = NULL;
+  int* noOfValuePositions = NULL;
+  int* navgroups = NULL;
+  int interpolationDimensions[NO_OF_COMPOSITE_INTERPOLATION_DIMENSIONS] = {0};
+  int x = 0, y = 0, i = 0, p = 0, xsize = 0, ysize = 0, nradars = 0, nparam = 0, nqualityflags = 0;
+
+  RAVE_ASSERT((self != NULL), "self == NULL");
+
+  if (area == NULL || products == NULL || nproducts <= 0) {
+    RAVE_ERROR0("Trying to generate products without area or product definitions");
     goto fail;
   }
 
-  result = CompositeInternal_createCompositeImage(composite, area);
-  if (result == NULL) {
+  /* The product settings are applied to a composite of our own so that self is never modified */
+  composite = CompositeInternal_createSharedComposite(self);
+  if (composite == NULL) {
+    RAVE_ERROR0("Failed to create composite for products");
     goto fail;
   }
 
-  if ((cvalues = CompositeInternal_createCompositeValues(nparam)) == NULL) {
+  nparam = Composite_getParameterCount(composite);
+  if (nparam <= 0) {
+    RAVE_ERROR0("You can not generate a composite without specifying at least one parameter");
     goto fail;
   }
 
-  for (i = 0; i < nparam; i++) {
-    const char* name = Composite_getParameter(composite, i, NULL, NULL);
-    cvalues[i].parameter = Cartesian_getParameter(result, name); // Keep track on parameters
-    if (cvalues[i].parameter == NULL) {
-      RAVE_ERROR0("Failure in parameter handling\n");
+  for (p = 0; p < nproducts; p++) {
+    if (products[p].ptype == Rave_ProductType_ETOP || products[p].ptype == Rave_ProductType_VIL) {
+      RAVE_ERROR0("Product type ETOP and VIL can only be generated with Composite_generate.");
+      goto fail;
+    }
+    if ((products[p].ptype == Rave_ProductType_MAX || products[p].ptype == Rave_ProductType_PMAX) &&
+        composite->interpolationMethod != CompositeInterpolationMethod_NEAREST) {
+      RAVE_ERROR0("Product type MAX and PMAX can currently only be used with interpolation method 'nearest value'.");
       goto fail;
     }
   }
 
-  xsize = Cartesian_getXSize(result);
-  ysize = Cartesian_getYSize(result);
-  projection = Cartesian_getProjection(result);
-  nradars = Composite_getNumberOfObjects(composite);
+  CompositeInternal_setInterpolationDimensionsArray(composite, interpolationDimensions);
 
   if (qualityflags != NULL) {
     nqualityflags = RaveList_size(qualityflags);
-    if (!CompositeInternal_addQualityFlags(composite, result, qualityflags)) {
+  }
+
+  result = RAVE_OBJECT_NEW(&RaveObjectList_TYPE);
+  cvalues = RAVE_MALLOC(sizeof(CompositeValues_t*) * nproducts);
+  valuePositions = RAVE_MALLOC(sizeof(CompositeValuePosition_t) * MAX_NO_OF_SURROUNDING_POSITIONS * nproducts);
+  noOfValuePositions = RAVE_MALLOC(sizeof(int) * nproducts);
+  navgroups = RAVE_MALLOC(sizeof(int) * nproducts);
+  if (result == NULL || cvalues == NULL || valuePositions == NULL || noOfValuePositions == NULL || navgroups == NULL) {
+    RAVE_ERROR0("Failed to allocate memory for products");
+    goto fail;
+  }
+  memset(cvalues, 0, sizeof(CompositeValues_t*) * nproducts);
+  for (p = 0; p < nproducts; p++) {
+    navgroups[p] = CompositeInternal_getNavigationGroup(products, p);
+  }
+
+  for (p = 0; p < nproducts; p++) {
+    CompositeInternal_applyProduct(composite, &products[p]);
+    image = CompositeInternal_createCompositeImage(composite, area);
+    if (image == NULL || (cvalues[p] = CompositeInternal_createCompositeValues(nparam)) == NULL) {
       goto fail;
     }
+    for (i = 0; i < nparam; i++) {
+      cvalues[p][i].parameter = Cartesian_getParameter(image, Composite_getParameter(composite, i, NULL, NULL));
+      if (cvalues[p][i].parameter == NULL) {
+        RAVE_ERROR0("Failure in parameter handling\n");
+        goto fail;
+      }
+    }
+    if (nqualityflags > 0 && !CompositeInternal_addQualityFlags(composite, image, qualityflags, NULL, 0)) {
+      goto fail;
+    }
+    if (!RaveObjectList_add(result, (RaveCoreObject*)image)) {
+      goto fail;
+    }
+    RAVE_OBJECT_RELEASE(image);
   }
 
+  image = (Cartesian_t*)RaveObjectList_get(result, 0);
+  xsize = Cartesian_getXSize(image);
+  ysize = Cartesian_getYSize(image);
+  projection = Cartesian_getProjection(image);
+  nradars = Composite_getNumberOfObjects(composite);
+
   if (composite->algorithm != NULL) {
     if (!CompositeAlgorithm_initialize(composite->algorithm, composite)) {
       goto fail;
@@ -2825,19 +4474,37 @@ Cartesian_t* Composite_generate(Composite_t* composite, Area_t* area, RaveList_t
   if (pipelines == NULL) {
     goto fail;
   }
+  if (nradars > 0) {
+    objects = RAVE_MALLOC(sizeof(RaveCoreObject*) * nradars);
+    lon = RAVE_MALLOC(sizeof(double) * nradars * xsize);
+    lat = RAVE_MALLOC(sizeof(double) * nradars * xsize);
+    dist = RAVE_MALLOC(sizeof(double) * nradars * xsize);
+    valid = RAVE_MALLOC(sizeof(unsigned char) * nradars * xsize);
+    if (objects == NULL || lon == NULL || lat == NULL || dist == NULL || valid == NULL) {
+      RAVE_ERROR0("Failed to allocate memory for navigation");
+      goto fail;
+    }
+    memset(objects, 0, sizeof(RaveCoreObject*) * nradars);
+  }
+  lastlon = RAVE_MALLOC(sizeof(double) * xsize);
+  lastlat = RAVE_MALLOC(sizeof(double) * xsize);
+  if (lastlon == NULL || lastlat == NULL) {
+    RAVE_ERROR0("Failed to allocate memory for navigation");
+    goto fail;
+  }
+
   for (i = 0; i < nradars; i++) {
-    RaveCoreObject* obj = Composite_get(composite, i);
-    if (obj != NULL) {
-      Projection_t* objproj = CompositeInternal_getProjection(obj);
+    objects[i] = Composite_get(composite, i);
+    if (objects[i] != NULL) {
+      Projection_t* objproj = CompositeInternal_getProjection(objects[i]);
       ProjectionPipeline_t* pipeline = NULL;
       if (objproj == NULL) {
-        RAVE_OBJECT_RELEASE(obj);
         RAVE_ERROR0("No projection for object");
         goto fail;
       }
+      CompositeInternal_ensureAscendingScans(objects[i]);
       pipeline = ProjectionPipeline_createPipeline(projection, objproj);
       RAVE_OBJECT_RELEASE(objproj);
-      RAVE_OBJECT_RELEASE(obj);
       if (pipeline == NULL || !RaveObjectList_add(pipelines, (RaveCoreObject*)pipeline)) {
         RAVE_ERROR0("Failed to create pipeline");
         RAVE_OBJECT_RELEASE(pipeline);
@@ -2848,172 +4515,316 @@ Cartesian_t* Composite_generate(Composite_t* composite, Area_t* area, RaveList_t
   }
 
   for (y = 0; y < ysize; y++) {
-    double herey = Cartesian_getLocationY(result, y);
+    double herey = Cartesian_getLocationY(image, y);
+    RAVE_STATS_TIMER_START(rowStart);
+    RAVE_STATS_COUNT(RaveStats_Counter_COMPOSITE_PIXELS, xsize * nproducts);
+
+    /* The navigation is calculated once for each radar and pixel and shared by all products */
     for (x = 0; x < xsize; x++) {
-      int cindex = 0;
-      double herex = Cartesian_getLocationX(result, x);
-      double olon = 0.0, olat = 0.0;
+      lastlon[x] = 0.0;
+      lastlat[x] = 0.0;
+    }
+    for (i = 0; i < nradars; i++) {
+      ProjectionPipeline_t* pipeline = NULL;
+      if (objects[i] != NULL) {
+        pipeline = (ProjectionPipeline_t*)RaveObjectList_get(pipelines, i);
+      }
+      for (x = 0; x < xsize; x++) {
+        int idx = i * xsize + x;
+        double maxdist = 0.0;
+        valid[idx] = 0;
+        if (pipeline == NULL) {
+          continue;
+        }
+        if (!CompositeInternal_projectionFwd(pipeline, Cartesian_getLocationX(image, x), herey, &lon[idx], &lat[idx])) {
+          RAVE_WARNING0("Failed to transform from composite into polar coordinates");
+          continue;
+        }
+        lastlon[x] = lon[idx];
+        lastlat[x] = lat[idx];
+        if (CompositeInternal_getDistances(objects[i], lon[idx], lat[idx], &dist[idx], &maxdist) && dist[idx] <= maxdist) {
+          valid[idx] = 1;
+        }
+      }
+      RAVE_OBJECT_RELEASE(pipeline);
+    }
+    RAVE_STATS_TIMER_STOP(rowStart, RaveStats_Timer_COMPOSITE_PROJECTION);
 
-      CompositeInternal_resetCompositeValues(composite, nparam, cvalues);
+    RAVE_STATS_TIMER_RESTART(rowStart);
+    for (x = 0; x < xsize; x++) {
+      for (p = 0; p < nproducts; p++) {
+        CompositeInternal_applyProduct(composite, &products[p]);
+        CompositeInternal_resetCompositeValues(composite, nparam, cvalues[p]);
+      }
       if (composite->algorithm != NULL) {
         CompositeAlgorithm_reset(composite->algorithm, x, y);
       }
-
       for (i = 0; i < nradars; i++) {
-        RaveCoreObject* obj = NULL;
-        ProjectionPipeline_t* pipeline = NULL;
-        obj = Composite_get(composite, i);
-        if (obj != NULL) {
-          pipeline = (ProjectionPipeline_t*)RaveObjectList_get(pipelines, i);
+        int idx = i * xsize + x;
+        if (!valid[idx]) {
+          continue;
         }
-
-        if (pipeline != NULL) {
-          /* We will go from surface coords into the lonlat projection assuming that a polar volume uses a lonlat projection*/
-          if (!ProjectionPipeline_fwd(pipeline, herex, herey, &olon, &olat)) {
-            RAVE_WARNING0("Failed to transform from composite into polar coordinates");
-          } else {
-            double dist = 0.0;
-            double maxdist = 0.0;
-            double rdist = 0.0;
-            if (RAVE_OBJECT_CHECK_TYPE(obj, &PolarVolume_TYPE)) {
-              dist = PolarVolume_getDistance((PolarVolume_t*)obj, olon, olat);
-              maxdist = PolarVolume_getMaxDistance((PolarVolume_t*)obj);
-              PolarVolume_sortByElevations((PolarVolume_t*)obj, 1);
-            } else if (RAVE_OBJECT_CHECK_TYPE(obj, &PolarScan_TYPE)) {
-              dist = PolarScan_getDistance((PolarScan_t*)obj, olon, olat);
-              maxdist = PolarScan_getMaxDistance((PolarScan_t*)obj);
-            }
-            if (dist <= maxdist) {
-              int noOfValuePositions = CompositeInternal_getValuePositions(composite, obj, olon, olat,
-                                                                           interpolationDimensions,
-                                                                           valuePositions);
-              if (noOfValuePositions > 0) {
-                rdist = dist; /* Remember distance to radar */
-
-                if (composite->method == CompositeSelectionMethod_HEIGHT) {
-                  dist = CompositeInternal_getValuePositionsLowestHeight(valuePositions, noOfValuePositions);
-                }
-
-                for (cindex = 0; cindex < nparam; cindex++) {
-                  RaveValueType otype = RaveValueType_NODATA;
-                  double ovalue = 0.0, qivalue = 0.0;
-
-                  if (!CompositeInternal_getInterpolatedValue(composite, obj, interpolationDimensions,
-                                                              cvalues[cindex].name, NULL, valuePositions,
-                                                              noOfValuePositions,
-                                                              CompositeInternal_setValuesInValuePos,
-                                                              &otype, &ovalue, &qivalue)) {
-                    RAVE_ERROR0("Interpolation failed.\n");
-                    goto fail;
-                  }
-
-                  if (composite->algorithm != NULL && CompositeAlgorithm_supportsProcess(composite->algorithm)) {
-                    // NOTE: The CompositeAlgorithm_process interface expects only one single navigation info. In the below call, we always provide
-                    // the navigation info for the first position. This will at least work for the 'nearest' interpolation method. For other interpolation methods,
-                    // where multiple positions have been collected, it depends on the composite algorithm how it handles the navigation info.
-                    if (CompositeAlgorithm_process(composite->algorithm, obj, cvalues[cindex].name, olon, olat, rdist, &otype, &ovalue, &valuePositions[0].navinfo)) {
-                      cvalues[cindex].vtype = otype;
-                      cvalues[cindex].value = ovalue;
-                      cvalues[cindex].mindist = dist;
-                      cvalues[cindex].radardist = rdist;
-                      cvalues[cindex].radarindex = i;
-                      cvalues[cindex].qivalue = qivalue;
-                      cvalues[cindex].noOfValuePositions = noOfValuePositions;
-                      memcpy(cvalues[cindex].valuePositions, valuePositions, sizeof(CompositeValuePosition_t)*MAX_NO_OF_SURROUNDING_POSITIONS);
-                    }
-                  } else {
-                    if (otype == RaveValueType_DATA || otype == RaveValueType_UNDETECT) {
-                      if (cvalues[cindex].vtype != RaveValueType_DATA && cvalues[cindex].vtype != RaveValueType_UNDETECT) {
-                        /* First time */
-                        cvalues[cindex].vtype = otype;
-                        cvalues[cindex].value = ovalue;
-                        cvalues[cindex].mindist = dist;
-                        cvalues[cindex].radardist = rdist;
-                        cvalues[cindex].radarindex = i;
-                        cvalues[cindex].qivalue = qivalue;
-                        cvalues[cindex].noOfValuePositions = noOfValuePositions;
-                        memcpy(cvalues[cindex].valuePositions, valuePositions, sizeof(CompositeValuePosition_t)*MAX_NO_OF_SURROUNDING_POSITIONS);
-                      } else if (
-                          composite->qiFieldName != NULL &&
-                          ((qivalue > cvalues[cindex].qivalue) ||
-                           (qivalue == cvalues[cindex].qivalue && dist < cvalues[cindex].mindist))) {
-                        cvalues[cindex].vtype = otype;
-                        cvalues[cindex].value = ovalue;
-                        cvalues[cindex].mindist = dist;
-                        cvalues[cindex].radardist = rdist;
-                        cvalues[cindex].radarindex = i;
-                        cvalues[cindex].qivalue = qivalue;
-                        cvalues[cindex].noOfValuePositions = noOfValuePositions;
-                        memcpy(cvalues[cindex].valuePositions, valuePositions, sizeof(CompositeValuePosition_t)*MAX_NO_OF_SURROUNDING_POSITIONS);
-                      } else if (composite->qiFieldName == NULL && dist < cvalues[cindex].mindist) {
-                        cvalues[cindex].vtype = otype;
-                        cvalues[cindex].value = ovalue;
-                        cvalues[cindex].mindist = dist;
-                        cvalues[cindex].radardist = rdist;
-                        cvalues[cindex].radarindex = i;
-                        cvalues[cindex].qivalue = qivalue;
-                        cvalues[cindex].noOfValuePositions = noOfValuePositions;
-                        memcpy(cvalues[cindex].valuePositions, valuePositions, sizeof(CompositeValuePosition_t)*MAX_NO_OF_SURROUNDING_POSITIONS);
-                      }
-                    }
-                  }
-                }
-              }
-            }
+        /* The value positions are calculated once for each group of products with the same navigation */
+        for (p = 0; p < nproducts; p++) {
+          CompositeValuePosition_t* positions = &valuePositions[navgroups[p] * MAX_NO_OF_SURROUNDING_POSITIONS];
+          CompositeInternal_applyProduct(composite, &products[p]);
+          if (products[p].ptype == Rave_ProductType_MAX) {
+            CompositeInternal_selectVerticalMaxValue(composite, i, lon[idx], lat[idx], dist[idx], cvalues[p], nparam);
+            continue;
           }
-        }
-        RAVE_OBJECT_RELEASE(obj);
-        RAVE_OBJECT_RELEASE(pipeline);
-      }
-
-      for (cindex = 0; cindex < nparam; cindex++) {
-        double vvalue = cvalues[cindex].value;
-        double vtype = cvalues[cindex].vtype;
-
-        if (vtype != RaveValueType_NODATA && composite->ptype == Rave_ProductType_PMAX && cvalues[cindex].radardist < composite->range) {
-          // only support for nearest value interpolation with PMAX, meaning that we only have one value position
-          PolarNavigationInfo info = cvalues[cindex].valuePositions[0].navinfo;
-
-          RaveValueType ntype = RaveValueType_NODATA;
-          double nvalue = 0.0;
-          if (vtype == RaveValueType_UNDETECT) {
-            /* Undetect should not affect navigation information */
-            CompositeInternal_getVerticalMaxValue(composite, cvalues[cindex].radarindex, cvalues[cindex].name, olon, olat, &ntype, &nvalue, NULL, NULL);
-          } else {
-            CompositeInternal_getVerticalMaxValue(composite, cvalues[cindex].radarindex, cvalues[cindex].name, olon, olat, &ntype, &nvalue, &info, NULL);
+          if (navgroups[p] == p) {
+            noOfValuePositions[p] = CompositeInternal_getValuePositions(composite, objects[i], lon[idx], lat[idx],
+                                                                        interpolationDimensions, positions);
+          }
+          if (!CompositeInternal_selectValueAtPositions(composite, objects[i], i, lon[idx], lat[idx], dist[idx], interpolationDimensions,
+                                                        positions, noOfValuePositions[navgroups[p]], cvalues[p], nparam)) {
+            goto fail;
           }
-          if (ntype != RaveValueType_NODATA) {
-            vtype = ntype;
-            vvalue = nvalue;
-            cvalues[cindex].valuePositions[0].navinfo = info;
-          }          
-        }
-
-        CartesianParam_setConvertedValue(cvalues[cindex].parameter, x, y, vvalue, vtype);
-
-        if ((vtype == RaveValueType_DATA || vtype == RaveValueType_UNDETECT) &&
-            cvalues[cindex].radarindex >= 0 && nqualityflags > 0) {
-          CompositeInternal_fillQualityInformation(composite, x, y, &cvalues[cindex], interpolationDimensions);
         }
       }
+      for (p = 0; p < nproducts; p++) {
+        CompositeInternal_applyProduct(composite, &products[p]);
+        CompositeInternal_setCompositePixel(composite, x, y, lastlon[x], lastlat[x], cvalues[p], nparam, interpolationDimensions,
+                                            NULL, nqualityflags, 0, NULL);
+      }
     }
+    RAVE_STATS_TIMER_STOP(rowStart, RaveStats_Timer_COMPOSITE_SELECT);
   }
 
-  for (i = 0; cvalues != NULL && i < nparam; i++) {
-    RAVE_OBJECT_RELEASE(cvalues[i].parameter);
+  goto done;
+fail:
+  RAVE_OBJECT_RELEASE(result);
+done:
+  for (p = 0; cvalues != NULL && p < nproducts; p++) {
+    for (i = 0; cvalues[p] != NULL && i < nparam; i++) {
+      RAVE_OBJECT_RELEASE(cvalues[p][i].parameter);
+    }
+    RAVE_FREE(cvalues[p]);
   }
   RAVE_FREE(cvalues);
+  for (i = 0; objects != NULL && i < nradars; i++) {
+    RAVE_OBJECT_RELEASE(objects[i]);
+  }
+  RAVE_FREE(objects);
+  RAVE_FREE(lon);
+  RAVE_FREE(lat);
+  RAVE_FREE(dist);
+  RAVE_FREE(valid);
+  RAVE_FREE(lastlon);
+  RAVE_FREE(lastlat);
+  RAVE_FREE(valuePositions);
+  RAVE_FREE(noOfValuePositions);
+  RAVE_FREE(navgroups);
+  RAVE_OBJECT_RELEASE(image);
   RAVE_OBJECT_RELEASE(projection);
   RAVE_OBJECT_RELEASE(pipelines);
+  RAVE_OBJECT_RELEASE(composite);
   return result;
-fail:
-  for (i = 0; cvalues != NULL && i < nparam; i++) {
-    RAVE_OBJECT_RELEASE(cvalues[i].parameter);
+}
+
+CartesianVolume_t* Composite_generateCappiVolume(Composite_t* composite, Area_t* area, RaveList_t* qualityflags,
+  Rave_ProductType ptype, const double* heights, int nheights)
+{
+  CartesianVolume_t* result = NULL;
+  RaveObjectList_t* images = NULL;
+  CompositeProduct_t* products = NULL;
+  Cartesian_t* image = NULL;
+  Projection_t* projection = NULL;
+  double llX = 0.0, llY = 0.0, urX = 0.0, urY = 0.0;
+  int i = 0;
+
+  RAVE_ASSERT((composite != NULL), "composite == NULL");
+
+  if (ptype != Rave_ProductType_CAPPI && ptype != Rave_ProductType_PCAPPI) {
+    RAVE_ERROR0("A cappi volume can only be generated with product type CAPPI or PCAPPI");
+    goto done;
   }
-  RAVE_FREE(cvalues);
-  RAVE_OBJECT_RELEASE(projection);
-  RAVE_OBJECT_RELEASE(pipelines);
+  if (heights == NULL || nheights <= 0) {
+    RAVE_ERROR0("Trying to generate a cappi volume without heights");
+    goto done;
+  }
+
+  products = RAVE_MALLOC(sizeof(CompositeProduct_t) * nheights);
+  if (products == NULL) {
+    RAVE_ERROR0("Failed to allocate memory for products");
+    goto done;
+  }
+  for (i = 0; i < nheights; i++) {
+    products[i].ptype = ptype;
+    products[i].height = heights[i];
+    products[i].elangle = composite->elangle;
+    products[i].method = composite->method;
+  }
+
+  images = Composite_generateProducts(composite, area, qualityflags, products, nheights);
+  if (images == NULL) {
+    goto done;
+  }
+
+  result = RAVE_OBJECT_NEW(&CartesianVolume_TYPE);
+  if (result == NULL) {
+    RAVE_ERROR0("Failed to create cartesian volume");
+    goto done;
+  }
+
+  image = (Cartesian_t*)RaveObjectList_get(images, 0);
+  projection = Cartesian_getProjection(image);
+  Cartesian_getAreaExtent(image, &llX, &llY, &urX, &urY);
+  CartesianVolume_setProjection(result, projection);
+  CartesianVolume_setAreaExtent(result, llX, llY, urX, urY);
+  CartesianVolume_setXScale(result, Cartesian_getXScale(image));
+  CartesianVolume_setYScale(result, Cartesian_getYScale(image));
+  CartesianVolume_setZStart(result, heights[0]);
+  CartesianVolume_setZScale(result, (nheights > 1) ? (heights[1] - heights[0]) : 0.0);
+  if (!CartesianVolume_setObjectType(result, Rave_ObjectType_CVOL) ||
+      !CartesianVolume_setDate(result, Cartesian_getDate(image)) ||
+      !CartesianVolume_setTime(result, Cartesian_getTime(image)) ||
+      !CartesianVolume_setSource(result, Cartesian_getSource(image))) {
+    RAVE_ERROR0("Failed to set cartesian volume attributes");
+    goto fail;
+  }
+  RAVE_OBJECT_RELEASE(image);
+
+  for (i = 0; i < nheights; i++) {
+    image = (Cartesian_t*)RaveObjectList_get(images, i);
+    if (image == NULL || !CartesianVolume_addImage(result, image)) {
+      RAVE_ERROR0("Failed to add image to cartesian volume");
+      goto fail;
+    }
+    RAVE_OBJECT_RELEASE(image);
+  }
+
+  goto done;
+fail:
   RAVE_OBJECT_RELEASE(result);
+done:
+  RAVE_FREE(products);
+  RAVE_OBJECT_RELEASE(image);
+  RAVE_OBJECT_RELEASE(projection);
+  RAVE_OBJECT_RELEASE(images);
+  return result;
+}
+
+RaveObjectList_t* Composite_generateMany(Composite_t* composite, RaveObjectList_t* areas, RaveList_t* qualityflags, int nthreads)
+{
+  RaveObjectList_t* result = NULL;
+  CompositeManyJob_t job;
+  int i = 0, nareas = 0;
+
+  RAVE_ASSERT((composite != NULL), "composite == NULL");
+  memset(&job, 0, sizeof(CompositeManyJob_t));
+
+  if (areas == NULL) {
+    RAVE_ERROR0("Trying to generate composites without areas");
+    return NULL;
+  }
+  nareas = RaveObjectList_size(areas);
+  for (i = 0; i < nareas; i++) {
+    RaveCoreObject* area = RaveObjectList_get(areas, i);
+    int isarea = RAVE_OBJECT_CHECK_TYPE(area, &Area_TYPE);
+    RAVE_OBJECT_RELEASE(area);
+    if (!isarea) {
+      RAVE_ERROR0("Composite_generateMany only accepts areas");
+      return NULL;
+    }
+  }
+
+  /* Prepare the shared polar data once so that the generations only read from it */
+  for (i = 0; i < Composite_getNumberOfObjects(composite); i++) {
+    RaveCoreObject* obj = Composite_get(composite, i);
+    CompositeInternal_ensureAscendingScans(obj);
+    RAVE_OBJECT_RELEASE(obj);
+  }
+
+  job.composite = composite;
+  job.areas = areas;
+  job.qualityflags = qualityflags;
+  job.results = RAVE_MALLOC(sizeof(Cartesian_t*) * (nareas > 0 ? nareas : 1));
+  if (job.results == NULL) {
+    RAVE_ERROR0("Failed to allocate memory for results");
+    return NULL;
+  }
+  memset(job.results, 0, sizeof(Cartesian_t*) * (nareas > 0 ? nareas : 1));
+
+  if (RaveRowPool_run(nareas, nthreads, CompositeInternal_generateManyArea,
+                      CompositeInternal_initManyWorker, CompositeInternal_releaseManyWorker, &job)) {
+    result = RAVE_OBJECT_NEW(&RaveObjectList_TYPE);
+    for (i = 0; result != NULL && i < nareas; i++) {
+      if (!RaveObjectList_add(result, (RaveCoreObject*)job.results[i])) {
+        RAVE_ERROR0("Failed to add composite to result");
+        RAVE_OBJECT_RELEASE(result);
+      }
+    }
+  }
+  for (i = 0; i < nareas; i++) {
+    RAVE_OBJECT_RELEASE(job.results[i]);
+  }
+  RAVE_FREE(job.results);
+  return result;
+}
+
+int Composite_generateBlocks(Composite_t* composite, Area_t* area, RaveList_t* qualityflags, long blockrows, Composite_blockWriter_f writerf, void* writer)
+{
+  Area_t* blockarea = NULL;
+  Cartesian_t* block = NULL;
+  CompositeGenerator_t gen;
+  double llX = 0.0, llY = 0.0, urX = 0.0, urY = 0.0, yscale = 0.0;
+  long y = 0, ysize = 0, nrows = 0;
+  int prepared = 0;
+  int result = 0;
+
+  RAVE_ASSERT((composite != NULL), "composite == NULL");
+  memset(&gen, 0, sizeof(CompositeGenerator_t));
+
+  if (area == NULL || writerf == NULL || blockrows <= 0) {
+    RAVE_ERROR0("Must provide area, writer and a positive number of rows per block");
+    goto done;
+  }
+
+  /* MAX, ETOP and VIL have generators of their own so they are generated block by block as they are */
+  if (composite->ptype != Rave_ProductType_MAX && composite->ptype != Rave_ProductType_ETOP && composite->ptype != Rave_ProductType_VIL) {
+    /* The blocks are written, and their quality fields thereby derived, at once so quality stores would only add work */
+    if (!CompositeInternal_prepareGenerator(composite, area, qualityflags, 0, &gen)) {
+      goto done;
+    }
+    prepared = 1;
+  }
+
+  blockarea = RAVE_OBJECT_CLONE(area);
+  if (blockarea == NULL) {
+    RAVE_ERROR0("Failed to clone area");
+    goto done;
+  }
+  Area_getExtent(area, &llX, &llY, &urX, &urY);
+  yscale = Area_getYScale(area);
+  ysize = Area_getYSize(area);
+
+  for (y = 0; y < ysize; y += nrows) {
+    nrows = (ysize - y) < blockrows ? (ysize - y) : blockrows;
+    Area_setYSize(blockarea, nrows);
+    Area_setExtent(blockarea, llX, urY - (double)(y + nrows) * yscale, urX, urY - (double)y * yscale);
+
+    if (prepared) {
+      block = CompositeInternal_generateImage(composite, &gen, blockarea, qualityflags);
+    } else {
+      block = Composite_generate(composite, blockarea, qualityflags);
+    }
+    if (block == NULL) {
+      RAVE_ERROR1("Failed to generate composite block at row %ld", y);
+      goto done;
+    }
+    if (!writerf(writer, block, y)) {
+      RAVE_ERROR1("Failed to write composite block at row %ld", y);
+      goto done;
+    }
+    RAVE_OBJECT_RELEASE(block);
+  }
+
+  result = 1;
+done:
+  CompositeInternal_releaseGenerator(&gen);
+  RAVE_OBJECT_RELEASE(block);
+  RAVE_OBJECT_RELEASE(blockarea);
   return result;
 }
 
@@ -28,9 +28,11 @@ along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
 #include "rave_object.h"
 #include "rave_types.h"
 #include "cartesian.h"
+#include "cartesianvolume.h"
 #include "area.h"
 #include "composite_algorithm.h"
 #include "raveobject_hashtable.h"
+#include "raveobject_list.h"
 #include "limits.h"
 
 #define COMPOSITE_QUALITY_FIELDS_GAIN   (1.0/UCHAR_MAX)
@@ -76,6 +78,16 @@ typedef enum CompositeInterpolationMethod_t {
   CompositeInterpolationMethod_QUADRATIC_3D
 } CompositeInterpolationMethod_t;
 
+/**
+ * Defines one product when generating several products in one pass with \ref Composite_generateProducts.
+ */
+typedef struct CompositeProduct_t {
+  Rave_ProductType ptype;            /**< the product type, PCAPPI, CAPPI, PPI, PMAX or MAX */
+  double height;                     /**< the height in meters for PCAPPI, CAPPI and PMAX */
+  double elangle;                    /**< the elevation angle in radians for PPI */
+  CompositeSelectionMethod_t method; /**< the selection method */
+} CompositeProduct_t;
+
 /**
  * Defines a Composite generator
  */
@@ -126,9 +138,11 @@ int Composite_getRadarIndexValue(Composite_t* composite, int index);
  * PPI requires elevation angle
  * CAPPI, PCAPPI and PMAX requires height above sea level
  * PMAX also requires range in meters
+ * ETOP uses the echo top threshold. ETOP and VIL are generated from polar volumes with one
+ * reflectivity parameter and the result is stored as HGHT (km) or VIL (kg/m2).
  *
  * @param[in] composite - self
- * @param[in] type - the product type, PPI, CAPPI, PCAPPI and PMAX are currently supported.
+ * @param[in] type - the product type, PPI, CAPPI, PCAPPI, PMAX, MAX, ETOP and VIL are currently supported.
  */
 void Composite_setProduct(Composite_t* composite, Rave_ProductType type);
 
@@ -215,6 +229,34 @@ void Composite_setRange(Composite_t* composite, double range);
  */
 double Composite_getRange(Composite_t* composite);
 
+/**
+ * Sets the reflectivity threshold used when generating the echo top (ETOP). The echo top is the
+ * height of the highest bin with a reflectivity >= the threshold.
+ * @param[in] self - self
+ * @param[in] threshold - the threshold in dBZ, default 20.0
+ */
+void Composite_setEchoTopThreshold(Composite_t* self, double threshold);
+
+/**
+ * @param[in] self - self
+ * @returns the echo top threshold in dBZ
+ */
+double Composite_getEchoTopThreshold(Composite_t* self);
+
+/**
+ * Sets the number of threads that share the rows when generating ETOP and VIL.
+ * @param[in] self - self
+ * @param[in] nthreads - number of threads, must be >= 1. Default is 1.
+ * @returns 1 on success or 0 if nthreads < 1
+ */
+int Composite_setNumberOfThreads(Composite_t* self, int nthreads);
+
+/**
+ * @param[in] self - self
+ * @returns the number of threads used when generating ETOP and VIL
+ */
+int Composite_getNumberOfThreads(Composite_t* self);
+
 /**
  * If this field name is set, then the composite will be generated by first using the
  * quality indicator field for determining radar usage. If the field name is NULL, then
@@ -231,6 +273,26 @@ int Composite_setQualityIndicatorFieldName(Composite_t* self, const char* qiFiel
  */
 const char* Composite_getQualityIndicatorFieldName(Composite_t* self);
 
+/**
+ * If lazy quality is enabled, the composite will only keep the winning radar and bin for each pixel
+ * when generating and the quality fields will be derived from that when they are first accessed
+ * (e.g. when reading values or when writing the product). This only applies when using the nearest
+ * interpolation method and to the quality flags that are not filled by the composite algorithm.
+ * The per pixel record takes 8 bytes. The quality fields of the radars that are needed are cloned
+ * when generating, sharing the data with the radars until either of them is changed, so the result
+ * is the same as when the quality fields are filled during generation even if the radars are
+ * changed afterwards.
+ * @param[in] self - self
+ * @param[in] lazy - 1 if quality fields should be derived on demand, otherwise 0 (default 0)
+ */
+void Composite_setLazyQuality(Composite_t* self, int lazy);
+
+/**
+ * @param[in] self - self
+ * @return if quality fields are derived on demand
+ */
+int Composite_getLazyQuality(Composite_t* self);
+
 /**
  * Adds a parameter to be processed.
  * @param[in] composite - self
@@ -321,10 +383,90 @@ int Composite_applyRadarIndexMapping(Composite_t* composite, RaveObjectHashTable
  * @param[in] qualityflags - A list of char pointers identifying how/task values in the quality fields of the polar data.
  *            Each entry in this list will result in the atempt to generate a corresponding quality field
  *            in the resulting cartesian product. (MAY BE NULL)
+ * ETOP and VIL are calculated per radar on a \ref PolarCube_t with the vertical kernels and the rows of the
+ * composite are then shared by the number of threads, see \ref Composite_setNumberOfThreads. Where radars overlap
+ * the highest echo top or VIL is used. The quality flags and the algorithm are not used for these products.
  * @returns the generated composite.
  */
 Cartesian_t* Composite_generate(Composite_t* composite, Area_t* area, RaveList_t* qualityflags);
 
+/**
+ * Generates several products over the same area in one pass. The position of each pixel in each radar is
+ * only calculated once and shared by all products, which saves the projection and distance calculations
+ * compared to calling \ref Composite_generate once per product. Products with the same product type, height
+ * and elevation angle also share the value positions in the radars so that only the selection differs. The product type, height, elevation angle
+ * and selection method of each product definition are used instead of the ones in the composite, all other
+ * settings are shared. The products are generated with a copy of the composite that shares the radar objects,
+ * so the settings of the composite are never modified. The quality flags are generated for all products.
+ * The lazy quality setting and the batched algorithm functions are not used by this function.
+ * ETOP and VIL can not be generated with this function.
+ * @param[in] composite - self
+ * @param[in] area - the area that should be used for defining the composite.
+ * @param[in] qualityflags - see \ref Composite_generate (MAY BE NULL)
+ * @param[in] products - the product definitions
+ * @param[in] nproducts - the number of product definitions
+ * @returns a list with one cartesian product for each product definition in the same order or NULL on failure
+ */
+RaveObjectList_t* Composite_generateProducts(Composite_t* composite, Area_t* area, RaveList_t* qualityflags, const CompositeProduct_t* products, int nproducts);
+
+/**
+ * Generates a stack of CAPPI or PCAPPI products at several heights in one pass with
+ * \ref Composite_generateProducts and returns them as a cartesian volume. The selection method and
+ * elevation angle of the composite are used for all heights. The volume gets the projection, extent,
+ * scales, date, time and source of the images, zstart is the first height and zscale is the
+ * distance between the first two heights so the heights should be given in ascending order with
+ * equal spacing.
+ * @param[in] composite - self
+ * @param[in] area - the area that should be used for defining the composite.
+ * @param[in] qualityflags - see \ref Composite_generate (MAY BE NULL)
+ * @param[in] ptype - the product type, Rave_ProductType_CAPPI or Rave_ProductType_PCAPPI
+ * @param[in] heights - the heights above sea level in meters
+ * @param[in] nheights - the number of heights
+ * @returns a cartesian volume with one image for each height in the same order or NULL on failure
+ */
+CartesianVolume_t* Composite_generateCappiVolume(Composite_t* composite, Area_t* area, RaveList_t* qualityflags,
+  Rave_ProductType ptype, const double* heights, int nheights);
+
+/**
+ * Generates the composite over several areas from the same set of radar objects. The objects
+ * are prepared once (volumes are sorted by elevation) and are then shared read-only while the
+ * areas are generated concurrently by up to nthreads threads. Each thread uses its own copy of
+ * the settings, parameters and algorithm so the result is the same as calling \ref Composite_generate
+ * once per area. The radar index mapping should be applied before calling this function.
+ * @param[in] composite - self
+ * @param[in] areas - the areas (list of Area_t)
+ * @param[in] qualityflags - see \ref Composite_generate (MAY BE NULL)
+ * @param[in] nthreads - the maximum number of threads to use, <= 1 generates the areas one after the other
+ * @returns a list with one cartesian product per area in the same order or NULL on failure
+ */
+RaveObjectList_t* Composite_generateMany(Composite_t* composite, RaveObjectList_t* areas, RaveList_t* qualityflags, int nthreads);
+
+/**
+ * Receives the blocks generated by \ref Composite_generateBlocks.
+ * @param[in] writer - the writer argument passed to \ref Composite_generateBlocks
+ * @param[in] block - the generated block of rows
+ * @param[in] yoffset - the row in the full area that corresponds to the first row in the block
+ * @return 1 on success, 0 will abort the generation
+ */
+typedef int(*Composite_blockWriter_f)(void* writer, Cartesian_t* block, long yoffset);
+
+/**
+ * Generates the composite in blocks of rows instead of as one product. Each block is a cartesian
+ * product covering blockrows rows (the last block might be smaller) of the area. The block is handed
+ * over to the writer function as soon as it has been generated and released afterwards so that the
+ * memory needed is bounded by the block size instead of the full area. The projection pipelines, the
+ * radars and the algorithm are prepared once and shared by all blocks. The quality fields of the blocks
+ * are always filled during generation since the writer will need them at once.
+ * @param[in] composite - self
+ * @param[in] area - the area that should be used for defining the composite.
+ * @param[in] qualityflags - see \ref Composite_generate (MAY BE NULL)
+ * @param[in] blockrows - number of rows in each block
+ * @param[in] writerf - the function receiving the blocks
+ * @param[in] writer - the argument passed to writerf
+ * @return 1 on success otherwise 0
+ */
+int Composite_generateBlocks(Composite_t* composite, Area_t* area, RaveList_t* qualityflags, long blockrows, Composite_blockWriter_f writerf, void* writer);
+
 /**
  * Sets the algorithm to use when generating the composite.
  * @param[in] composite - self
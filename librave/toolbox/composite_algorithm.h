@@ -25,6 +25,14 @@ along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
  * \ref CompositeAlgorithm_initialize will be called. Then, for each value calculated
  * \ref CompositeAlgorithm_process will be called.
  *
+ * An algorithm can also implement the batched function fillQualityRow that is called
+ * once per composite row with arrays for all pixels in the row. When it is implemented
+ * (not NULL), \ref Composite_generate uses it instead of fillQualityInformation.
+ * Algorithms that do not support the batched interface should set it to NULL.
+ * The processor function has no batched version, it is always called once per pixel. The POO
+ * algorithm in RAVE only fills quality information and does not support process, so there is no
+ * per pixel selection in the tree that a batched processor would replace.
+ *
  * @file
  * @author Anders Henja (Swedish Meteorological and Hydrological Institute, SMHI)
  * @date 2011-10-28
@@ -108,6 +116,25 @@ typedef int(*composite_algorithm_supportsFillQualityInformation_fun)(struct _Com
  */
 typedef int(*composite_algorithm_fillQualityInformation_fun)(struct _CompositeAlgorithm_t* self, RaveCoreObject* obj, const char* howtask, const char* quantity, RaveField_t* field, long x, long y, PolarNavigationInfo* navinfo, double gain, double offset);
 
+/**
+ * Batched version of the fill quality information function. Fills one row of the quality field. Is only used
+ * for nearest interpolation where each pixel has got one navigation info.
+ * @param[in] self - self
+ * @param[in] howtask - the how/task value  defining what quality attribute we are processing
+ * @param[in] quantity - the quantity we are working with
+ * @param[in] field - the quality field to be set
+ * @param[in] y - the row
+ * @param[in] n - the number of pixels in the row
+ * @param[in] objs - the object that was selected for each pixel or NULL if the pixel should be left untouched (n values)
+ * @param[in] radarindex - the index in the composite of the selected object or -1 (n values)
+ * @param[in] navinfo - the navigation information that was used within the selected object (n values)
+ * @param[in] gain - the gain of the quality field
+ * @param[in] offset - the offset of the quality field
+ * @return 1 on success otherwise 0
+ */
+typedef int(*composite_algorithm_fillQualityRow_fun)(struct _CompositeAlgorithm_t* self, const char* howtask, const char* quantity, RaveField_t* field, \
+    int y, int n, RaveCoreObject** objs, const int* radarindex, PolarNavigationInfo* navinfo, double gain, double offset);
+
 /**
  * The head part for a CompositeAlgorithm subclass. Should be placed directly under
  * RAVE_OBJECT_HEAD like in CompositeAlgorithm_t.
@@ -119,7 +146,8 @@ typedef int(*composite_algorithm_fillQualityInformation_fun)(struct _CompositeAl
   composite_algorithm_initialize_fun initialize; \
   composite_algorithm_reset_fun reset; \
   composite_algorithm_supportsFillQualityInformation_fun supportsFillQualityInformation; \
-  composite_algorithm_fillQualityInformation_fun fillQualityInformation;
+  composite_algorithm_fillQualityInformation_fun fillQualityInformation; \
+  composite_algorithm_fillQualityRow_fun fillQualityRow;
 
 /**
  * The basic composite algorithm that can be cast into a subclassed processor.
@@ -188,4 +216,16 @@ typedef struct _CompositeAlgorithm_t {
 #define CompositeAlgorithm_fillQualityInformation(self,obj,howtask,quantity,field,x,y,navinfo,gain,offset) \
     ((CompositeAlgorithm_t*)self)->fillQualityInformation((CompositeAlgorithm_t*)self,obj,howtask,quantity,field,x,y,navinfo,gain,offset)
 
+/**
+ * Macro expansion if this algorithm supports the batched fill quality function or not
+ */
+#define CompositeAlgorithm_supportsFillQualityRow(self) \
+    (((CompositeAlgorithm_t*)self)->fillQualityRow != NULL)
+
+/**
+ * Macro expansion for calling the batched fill quality function
+ */
+#define CompositeAlgorithm_fillQualityRow(self,howtask,quantity,field,y,n,objs,radarindex,navinfo,gain,offset) \
+    ((CompositeAlgorithm_t*)self)->fillQualityRow((CompositeAlgorithm_t*)self,howtask,quantity,field,y,n,objs,radarindex,navinfo,gain,offset)
+
 #endif /* COMPOSITE_ALGORITHM_H */
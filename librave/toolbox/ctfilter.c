@@ -24,6 +24,7 @@ along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
  */
 
 #include "ctfilter.h"
+#include "rave_stats.h"
 
 
 int ctFilter(Cartesian_t* product, Cartesian_t* ct) {
@@ -40,6 +41,7 @@ int ctFilter(Cartesian_t* product, Cartesian_t* ct) {
    int xp, yp, xc, yc;
    double xsurfp, ysurfp, xsurfc, ysurfc;
    long xsizep, ysizep, xsizec, ysizec;
+   RAVE_STATS_SCOPE(RaveStats_Timer_QC_CTFILTER);
 
    xsizep = Cartesian_getXSize(product);
    ysizep = Cartesian_getYSize(product);
@@ -25,6 +25,7 @@ along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
  */
 
 #include "dealias.h"
+#include "rave_stats.h"
 
 double max_vector (double *a, int n) {
   int i;
@@ -316,6 +317,7 @@ int dealias_scan_by_quantity(PolarScan_t* scan, const char* quantity, double ema
   int nbins, nrays, i, j, n, m, ib, ir, eind, vo_valid;
   int retval = 0;
   double elangle, gain, offset, nodata, undetect, NI, val, vm, min1, esum, u1, v1, min2, dmy, vmin_vo, vmax_vo, vmin_vd, vmax_vd;
+  RAVE_STATS_SCOPE(RaveStats_Timer_QC_DEALIAS);
 
   nbins = PolarScan_getNbins(scan);
   nrays = PolarScan_getNrays(scan);
@@ -28,6 +28,7 @@ along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
 #include "raveobject_list.h"
 #include "rave_debug.h"
 #include "rave_alloc.h"
+#include "rave_stats.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -646,6 +647,7 @@ PolarScan_t* DetectionRange_top(DetectionRange_t* self, PolarVolume_t* pvol, dou
   double scaleFactor = 0.0;
   long nbins = 0, nrays = 0;
   int rayi = 0, bini = 0, elevi = 0;
+  RAVE_STATS_SCOPE(RaveStats_Timer_QC_DETECTION_RANGE);
 
   RAVE_ASSERT((self != NULL), "self == NULL");
 
@@ -794,6 +796,7 @@ PolarScan_t* DetectionRange_filter(DetectionRange_t* self, PolarScan_t* scan)
 
   int bi = 0, ri = 0;
   int nbins = 0, nrays = 0;
+  RAVE_STATS_SCOPE(RaveStats_Timer_QC_DETECTION_RANGE);
 
   RAVE_ASSERT((self != NULL), "self == NULL");
 
@@ -889,6 +892,7 @@ RaveField_t* DetectionRange_analyze(DetectionRange_t* self,
   PolarScanParam_t* param = NULL;
   RaveField_t* result = NULL;   /* The resulting field, will only be set on success */
   PolarScan_t* outscan = NULL;  /* The working scan where data will be set and on success copied to result */
+  RAVE_STATS_SCOPE(RaveStats_Timer_QC_DETECTION_RANGE);
 
   RAVE_ASSERT((self != NULL), "self == NULL");
   if (scan == NULL) {
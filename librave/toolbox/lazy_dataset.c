@@ -17,7 +17,8 @@ You should have received a copy of the GNU Lesser General Public License
 along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
 ------------------------------------------------------------------------*/
 /**
- * This is a wrapper around a lazy nodelist reader used for fetching data from a HL_NodeList.
+ * This is a wrapper around a lazy nodelist reader used for fetching data from a HL_NodeList
+ * or around a provider that derives the data when it is first requested.
  * This does not support \ref #RAVE_OBJECT_CLONE.
  * @file
  * @author Anders Henja (Swedish Meteorological and Hydrological Institute, SMHI)
@@ -38,6 +39,11 @@ struct _LazyDataset_t {
   RAVE_OBJECT_HEAD /** Always on top */
   LazyNodeListReader_t* reader; /**< reader */
   char* nodename; /**< name of the node to fetch from reader */
+  RaveCoreObject* provider; /**< provider when data is derived instead of read */
+  LazyDataset_provider_f providerf; /**< the function deriving the data */
+  long xsize; /**< xsize when using a provider */
+  long ysize; /**< ysize when using a provider */
+  RaveDataType type; /**< data type when using a provider */
 };
 
 /*@{ Private functions */
@@ -49,6 +55,11 @@ static int LazyDataset_constructor(RaveCoreObject* obj)
   LazyDataset_t* dataset = (LazyDataset_t*)obj;
   dataset->reader = NULL;
   dataset->nodename = NULL;
+  dataset->provider = NULL;
+  dataset->providerf = NULL;
+  dataset->xsize = 0;
+  dataset->ysize = 0;
+  dataset->type = RaveDataType_UNDEFINED;
   return 1;
 }
 
@@ -59,6 +70,7 @@ static void LazyDataset_destructor(RaveCoreObject* obj)
 {
   LazyDataset_t* dataset = (LazyDataset_t*)obj;
   RAVE_OBJECT_RELEASE(dataset->reader);
+  RAVE_OBJECT_RELEASE(dataset->provider);
   RAVE_FREE(dataset->nodename);
 }
 
@@ -100,9 +112,36 @@ int LazyDataset_init(LazyDataset_t* self, LazyNodeListReader_t* reader, const ch
   return 1;
 }
 
+int LazyDataset_initWithProvider(LazyDataset_t* self, RaveCoreObject* provider, LazyDataset_provider_f providerf,
+  const char* name, long xsize, long ysize, RaveDataType type)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  if (provider == NULL || providerf == NULL) {
+    RAVE_ERROR0("Can not initialize LazyDataset without provider");
+    return 0;
+  }
+  if (name == NULL) {
+    RAVE_ERROR0("Can not initialize LazyDataset with NULL name");
+    return 0;
+  }
+  self->nodename = RAVE_STRDUP(name);
+  if (self->nodename == NULL) {
+    return 0;
+  }
+  self->provider = RAVE_OBJECT_COPY(provider);
+  self->providerf = providerf;
+  self->xsize = xsize;
+  self->ysize = ysize;
+  self->type = type;
+  return 1;
+}
+
 RaveData2D_t* LazyDataset_get(LazyDataset_t* self)
 {
   RAVE_ASSERT((self != NULL), "self == NULL");
+  if (self->provider != NULL) {
+    return self->providerf(self->provider, self->nodename);
+  }
   return LazyNodeListReader_getDataset(self->reader, self->nodename);
 
 }
@@ -110,18 +149,27 @@ RaveData2D_t* LazyDataset_get(LazyDataset_t* self)
 long LazyDataset_getXsize(LazyDataset_t* self)
 {
   RAVE_ASSERT((self != NULL), "self == NULL");
+  if (self->provider != NULL) {
+    return self->xsize;
+  }
   return HLNode_getDimension(LazyDatasetInternal_getNode(self->reader, self->nodename), 1);
 }
 
 long LazyDataset_getYsize(LazyDataset_t* self)
 {
   RAVE_ASSERT((self != NULL), "self == NULL");
+  if (self->provider != NULL) {
+    return self->ysize;
+  }
   return HLNode_getDimension(LazyDatasetInternal_getNode(self->reader, self->nodename), 0);
 }
 
 RaveDataType LazyDataset_getDataType(LazyDataset_t* self)
 {
   RAVE_ASSERT((self != NULL), "self == NULL");
+  if (self->provider != NULL) {
+    return self->type;
+  }
   return RaveHL_hlhdfToRaveType(HLNode_getFormat(LazyDatasetInternal_getNode(self->reader, self->nodename)));
 }
 
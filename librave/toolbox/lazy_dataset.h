@@ -43,6 +43,14 @@ typedef struct _LazyDataset_t LazyDataset_t;
  */
 extern RaveCoreObjectType LazyDataset_TYPE;
 
+/**
+ * Function used for deriving the data of a lazy dataset that is not read from file.
+ * @param[in] provider - the provider object given at initialization
+ * @param[in] name - the name given at initialization
+ * @return the data on success otherwise NULL
+ */
+typedef RaveData2D_t*(*LazyDataset_provider_f)(RaveCoreObject* provider, const char* name);
+
 /**
  * Initializes this object with the reader and the name of the node to fetch.
  * The nodename must exist within the available names in the reader otherwise initialization will fail.
@@ -53,6 +61,22 @@ extern RaveCoreObjectType LazyDataset_TYPE;
  */
 int LazyDataset_init(LazyDataset_t* self, LazyNodeListReader_t* reader, const char* nodename);
 
+/**
+ * Initializes this object with a provider that will derive the data when it is requested instead
+ * of reading it from a node list. Since the data does not exist yet, the dimensions and data type
+ * has to be specified.
+ * @param[in] self - self
+ * @param[in] provider - the object that is passed on to the provider function
+ * @param[in] providerf - the function that derives the data
+ * @param[in] name - the name identifying the data for the provider
+ * @param[in] xsize - the xsize of the data
+ * @param[in] ysize - the ysize of the data
+ * @param[in] type - the data type
+ * @return 1 on success otherwise 0
+ */
+int LazyDataset_initWithProvider(LazyDataset_t* self, RaveCoreObject* provider, LazyDataset_provider_f providerf,
+  const char* name, long xsize, long ysize, RaveDataType type);
+
 /**
  * Load the data upon request
  */
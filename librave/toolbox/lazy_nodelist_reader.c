@@ -11,6 +11,7 @@
 #include "hlhdf_node.h"
 #include "hlhdf_alloc.h"
 #include <string.h>
+#include <unistd.h>
 #include "rave_debug.h"
 #include "rave_hlhdf_utilities.h"
 
@@ -21,6 +22,7 @@ struct _LazyNodeListReader_t {
   RAVE_OBJECT_HEAD /** Always on top */
   HL_NodeList* nodelist;
   char* filename;
+  int fd; /**< descriptor owned by the reader or -1 */
 };
 
 /*@{ Private functions */
@@ -32,6 +34,7 @@ static int LazyNodeListReader_constructor(RaveCoreObject* obj)
   LazyNodeListReader_t* self = (LazyNodeListReader_t*)obj;
   self->nodelist = NULL;
   self->filename = NULL;
+  self->fd = -1;
   return 1;
 }
 
@@ -48,6 +51,9 @@ static void LazyNodeListReader_destructor(RaveCoreObject* obj)
   if (self->filename != NULL) {
     HLHDF_FREE(self->filename);
   }
+  if (self->fd >= 0) {
+    close(self->fd);
+  }
 }
 
 /*@} End of Private functions */
@@ -79,6 +85,77 @@ static int LazyNodeListReaderInternal_liststrcmp(void* a, void* b)
   return 0;
 }
 
+/**
+ * Returns the string value of the node with the name <group>/<attr> if it exists.
+ * @param[in] nodelist - the node list
+ * @param[in] group - the group name, only the first grouplen characters are used
+ * @param[in] grouplen - the length of the group name
+ * @param[in] attr - the attribute name relative to group
+ * @returns the string or NULL if not found
+ */
+static const char* LazyNodeListReaderInternal_getGroupString(HL_NodeList* nodelist, const char* group, size_t grouplen, const char* attr)
+{
+  char name[1024];
+  if (grouplen + strlen(attr) + 2 > sizeof(name)) {
+    return NULL;
+  }
+  strncpy(name, group, grouplen);
+  name[grouplen] = '/';
+  strcpy(name + grouplen + 1, attr);
+  if (HLNodeList_hasNodeByName(nodelist, name)) {
+    HL_Node* node = HLNodeList_getNodeByName(nodelist, name);
+    if (HLNode_getType(node) == ATTRIBUTE_ID && HLNode_getFormat(node) == HLHDF_STRING) {
+      return (const char*)HLNode_getData(node);
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Determines if a dataset should be preloaded.
+ * @param[in] nodelist - the node list
+ * @param[in] nodeName - the name of the dataset node
+ * @param[in] names - the quantities and how/tasks to match against, if NULL or empty everything is selected
+ * @returns 1 if the dataset should be preloaded otherwise 0
+ */
+static int LazyNodeListReaderInternal_shouldPreload(HL_NodeList* nodelist, const char* nodeName, RaveList_t* names)
+{
+  const char* slash = strrchr(nodeName, '/');
+  const char* group = NULL;
+  const char* value = NULL;
+  size_t grouplen = 0;
+  int kind = 0; /* 1 = parameter, 2 = quality field */
+  int idx = 0, n = 0;
+
+  if (names == NULL || RaveList_size(names) == 0 || slash == NULL || strcmp(slash, "/data") != 0) {
+    return 1;
+  }
+  grouplen = slash - nodeName;
+  for (group = slash - 1; group > nodeName && *group != '/'; group--);
+  if (sscanf(group, "/data%d%n", &idx, &n) == 1 && group + n == slash) {
+    kind = 1;
+  } else if (sscanf(group, "/quality%d%n", &idx, &n) == 1 && group + n == slash) {
+    kind = 2;
+  }
+
+  if (kind == 1) {
+    value = LazyNodeListReaderInternal_getGroupString(nodelist, nodeName, grouplen, "what/quantity");
+    if (value == NULL) {
+      value = LazyNodeListReaderInternal_getGroupString(nodelist, nodeName, group - nodeName, "what/quantity");
+    }
+  } else if (kind == 2) {
+    value = LazyNodeListReaderInternal_getGroupString(nodelist, nodeName, grouplen, "how/task");
+  } else {
+    return 1; /* Not a parameter or quality field, keep it */
+  }
+
+  if (value == NULL) {
+    /* Parameters without a quantity are kept, quality fields without a task are left for lazy loading */
+    return (kind == 1) ? 1 : 0;
+  }
+  return (RaveList_find(names, (void*)value, LazyNodeListReaderInternal_liststrcmp) != NULL) ? 1 : 0;
+}
+
 int LazyNodeListReader_preloadQuantities(LazyNodeListReader_t* self, const char* quantities)
 {
   RaveList_t* quantitiesToPreload = NULL;
@@ -93,31 +170,18 @@ int LazyNodeListReader_preloadQuantities(LazyNodeListReader_t* self, const char*
         return 0;
       }
     }
+    RaveHL_lock();
     n = HLNodeList_getNumberOfNodes(self->nodelist);
     for (i = 0; i < n; i++) {
       HL_Node* node = HLNodeList_getNodeByIndex(self->nodelist, i);
-      const char* nodeName = HLNode_getName(node);
       if (HLNode_getType(node) == DATASET_ID && !HLNode_fetched(node)) {
-        int dsetid=0, did=0;
-        if (sscanf(nodeName, "/dataset%d/data%d/data", &dsetid, &did) == 2) { /* This is a parameter and probably has a quantity */
-          char qname[1024];
-          sprintf(qname, "/dataset%d/data%d/what/quantity", dsetid, did);
-          if (quantitiesToPreload != NULL && RaveList_size(quantitiesToPreload) > 0 && HLNodeList_hasNodeByName(self->nodelist, qname)) {
-            const char* quantity = (const char *)HLNode_getData(HLNodeList_getNodeByName(self->nodelist, qname));
-            if (RaveList_find(quantitiesToPreload, (void*)quantity, LazyNodeListReaderInternal_liststrcmp) != NULL) {
-              HLNode_setMark(node, NMARK_SELECT);
-            }
-          } else {
-            HLNode_setMark(node, NMARK_SELECT);
-          }
-        } else {
-          if (!HLNode_fetched(node)) {
-            HLNode_setMark(node, NMARK_SELECT);
-          }
+        if (LazyNodeListReaderInternal_shouldPreload(self->nodelist, HLNode_getName(node), quantitiesToPreload)) {
+          HLNode_setMark(node, NMARK_SELECT);
         }
       }
     }
     result = HLNodeList_fetchMarkedNodes(self->nodelist);
+    RaveHL_unlock();
   }
   if (quantitiesToPreload != NULL) {
     RaveList_freeAndDestroy(&quantitiesToPreload);
@@ -129,6 +193,7 @@ RaveData2D_t* LazyNodeListReader_getDataset(LazyNodeListReader_t* self, const ch
 {
   RaveData2D_t* result = NULL;
   RAVE_ASSERT((self != NULL), "self == NULL");
+  RaveHL_lock();
   if (self->nodelist != NULL) {
     HL_Node* node = HLNodeList_getNodeByName(self->nodelist, datasetname);
     if (node != NULL && HLNode_getType(node) == DATASET_ID) {
@@ -151,6 +216,7 @@ RaveData2D_t* LazyNodeListReader_getDataset(LazyNodeListReader_t* self, const ch
     }
   }
 done:
+  RaveHL_unlock();
   return result;
 }
 
@@ -160,6 +226,7 @@ RaveAttribute_t* LazyNodeListReader_getAttribute(LazyNodeListReader_t* self, con
   RaveAttribute_t* result = NULL;
 
   RAVE_ASSERT((self != NULL), "self == NULL");
+  RaveHL_lock();
   if (self->nodelist != NULL) {
     HL_Node* node = HLNodeList_getNodeByName(self->nodelist, attributename);
     if (node != NULL && HLNode_getType(node) == ATTRIBUTE_ID) {
@@ -180,6 +247,7 @@ RaveAttribute_t* LazyNodeListReader_getAttribute(LazyNodeListReader_t* self, con
   }
   result = RAVE_OBJECT_COPY(attr);
 done:
+  RaveHL_unlock();
   return result;
 }
 
@@ -228,6 +296,16 @@ RaveList_t* LazyNodeListReader_getNodeNames(LazyNodeListReader_t* self)
   return result;
 }
 
+int LazyNodeListReader_setFileDescriptor(LazyNodeListReader_t* self, int fd)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  if (self->fd >= 0) {
+    return 0;
+  }
+  self->fd = fd;
+  return 1;
+}
+
 HL_NodeList* LazyNodeListReader_getHLNodeList(LazyNodeListReader_t* self)
 {
   RAVE_ASSERT((self != NULL), "self == NULL");
@@ -250,9 +328,12 @@ LazyNodeListReader_t* LazyNodeListReader_create(HL_NodeList* nodelist)
 
 LazyNodeListReader_t* LazyNodeListReader_read(const char* filename)
 {
-  HL_NodeList* nodelist = HLNodeList_read(filename);
+  HL_NodeList* nodelist = NULL;
 
+  RaveHL_lock();
+  nodelist = HLNodeList_read(filename);
   if (nodelist == NULL) {
+    RaveHL_unlock();
     RAVE_ERROR1("Failed to read %s", nodelist);
     return NULL;
   }
@@ -260,29 +341,36 @@ LazyNodeListReader_t* LazyNodeListReader_read(const char* filename)
   HLNodeList_selectAllMetadataNodes(nodelist);
   //HLNodeList_selectAllNodes(nodelist); 0.5 LDR
   if (!HLNodeList_fetchMarkedNodes(nodelist)) {
+    RaveHL_unlock();
     RAVE_ERROR1("Failed to load hdf5 file '%s'", filename);
     HLNodeList_free(nodelist);
     return NULL;
   }
+  RaveHL_unlock();
 
   return LazyNodeListReader_create(nodelist);
 }
 
 LazyNodeListReader_t* LazyNodeListReader_readPreloaded(const char* filename)
 {
-  HL_NodeList* nodelist = HLNodeList_read(filename);
+  HL_NodeList* nodelist = NULL;
 
+  RaveHL_lock();
+  nodelist = HLNodeList_read(filename);
   if (nodelist == NULL) {
+    RaveHL_unlock();
     RAVE_ERROR1("Failed to read %s", nodelist);
     return NULL;
   }
 
   HLNodeList_selectAllNodes(nodelist);
   if (!HLNodeList_fetchMarkedNodes(nodelist)) {
+    RaveHL_unlock();
     RAVE_ERROR1("Failed to load hdf5 file '%s'", filename);
     HLNodeList_free(nodelist);
     return NULL;
   }
+  RaveHL_unlock();
 
   return LazyNodeListReader_create(nodelist);
 }
@@ -45,10 +45,13 @@ int LazyNodeListReader_preload(LazyNodeListReader_t* self);
 
 /**
  * Preloads datasets according to:
- * + /datasetX/dataY/data that are paired with /datasetX/dataY/what/quantity that are in the list of quantities
+ * + .../dataY/data that are paired with .../dataY/what/quantity (or the quantity of the dataset above) that are in the list.
+ * + .../qualityY/data at any level that are paired with .../qualityY/how/task that are in the list.
  * + all datasets that doesn't have the above pairing.
+ * Datasets that are not preloaded will be read when they are first accessed.
  * @param[in] self - self
- * @param[in] quantities - a comma separated list of quantities that should be matched against. If quantities = NULL everything is read..
+ * @param[in] quantities - a comma separated list of quantities and quality field how/tasks that should be matched
+ * against, e.g. "ACRR,se.smhi.composite.distance.radar". If quantities = NULL everything is read.
  * @returns 1 on success otherwise 0
  */
 int LazyNodeListReader_preloadQuantities(LazyNodeListReader_t* self, const char* quantities);
@@ -92,6 +95,15 @@ int LazyNodeListReader_exists(LazyNodeListReader_t* self, const char* name);
  */
 HL_NodeList* LazyNodeListReader_getHLNodeList(LazyNodeListReader_t* self);
 
+/**
+ * Lets the reader take over the file descriptor that keeps the underlying file alive, e.g. an anonymous
+ * memory file opened through /proc/self/fd. The descriptor is closed when the reader is destroyed.
+ * @param[in] self - self
+ * @param[in] fd - the file descriptor
+ * @returns 1 on success, 0 if the reader already owns a descriptor
+ */
+int LazyNodeListReader_setFileDescriptor(LazyNodeListReader_t* self, int fd);
+
 /**
  * Returns all node names within the nodelist.
  * @param[in] self - self
@@ -23,6 +23,7 @@ along with HLHDF.  If not, see <http://www.gnu.org/licenses/>.
  */
 
 #include "odc_hac.h"
+#include "rave_stats.h"
 
 
 int hacFilter(PolarScan_t* scan, RaveField_t* hac, char* quant) {
@@ -34,6 +35,7 @@ int hacFilter(PolarScan_t* scan, RaveField_t* hac, char* quant) {
   int ir, ib;
   long nrays, nbins, N;
   double nodata, ni, Pi, val, thresh;
+  RAVE_STATS_SCOPE(RaveStats_Timer_QC_HAC);
   
   nbins = PolarScan_getNbins(scan);
   nrays = PolarScan_getNrays(scan);
@@ -82,6 +84,7 @@ int hacIncrement(PolarScan_t* scan, RaveField_t* hac, char* quant) {
   int ir, ib;
   long nrays, nbins, N;
   double val, ni;
+  RAVE_STATS_SCOPE(RaveStats_Timer_QC_HAC);
   
   nbins = PolarScan_getNbins(scan);
   nrays = PolarScan_getNrays(scan);
@@ -114,6 +117,91 @@ int hacIncrement(PolarScan_t* scan, RaveField_t* hac, char* quant) {
 }
 
 
+int hacFilterHits(PolarScan_t* scan, const unsigned int* hits, long count, const char* quant) {
+  PolarScanParam_t* param = NULL;
+  RaveField_t* qind = NULL;
+  RaveAttribute_t* attr = NULL;
+  RaveValueType rvt;
+  int retval = 0;
+  int ir, ib;
+  long nrays, nbins;
+  double nodata, Pi, val, thresh = 0.0;
+  RAVE_STATS_SCOPE(RaveStats_Timer_QC_HAC);
+
+  nbins = PolarScan_getNbins(scan);
+  nrays = PolarScan_getNrays(scan);
+
+  if (PolarScan_hasParameter(scan, quant) && count > 0) {
+     param = PolarScan_getParameter(scan, quant);
+     qind = PolarScan_getQualityFieldByHowTask(scan, "eu.opera.odc.hac");
+     if (qind == NULL) {
+       goto done;
+     }
+     nodata = PolarScanParam_getNodata(param);
+
+     attr = RaveField_getAttribute(qind, "how/task_args");
+     if (attr == NULL || !RaveAttribute_getDouble(attr, &thresh)) {
+       goto done;
+     }
+
+     for (ir=0; ir<nrays; ir++) {
+       for (ib=0; ib<nbins; ib++) {
+         rvt = PolarScanParam_getValue(param, ib, ir, &val);
+
+         if (rvt==RaveValueType_DATA) {
+           Pi = 100 * ((double)hits[ir*nbins+ib]/(double)count);
+
+           if (Pi > thresh) {
+             PolarScanParam_setValue(param, ib, ir, nodata);
+             RaveField_setValue(qind, ib, ir, val);
+           }
+         }
+       }
+     }
+
+     retval = 1;
+  }
+done:
+  RAVE_OBJECT_RELEASE(param);
+  RAVE_OBJECT_RELEASE(qind);
+  RAVE_OBJECT_RELEASE(attr);
+  return retval;
+}
+
+
+int hacIncrementHits(PolarScan_t* scan, unsigned int* hits, long* count, const char* quant) {
+  PolarScanParam_t* param = NULL;
+  RaveValueType rvt;
+  int retval = 0;
+  int ir, ib;
+  long nrays, nbins;
+  double val;
+  RAVE_STATS_SCOPE(RaveStats_Timer_QC_HAC);
+
+  nbins = PolarScan_getNbins(scan);
+  nrays = PolarScan_getNrays(scan);
+
+  if (PolarScan_hasParameter(scan, quant)) {
+     param = PolarScan_getParameter(scan, quant);
+     *count += 1;
+
+     for (ir=0; ir<nrays; ir++) {
+       for (ib=0; ib<nbins; ib++) {
+         rvt = PolarScanParam_getValue(param, ib, ir, &val);
+
+         if (rvt==RaveValueType_DATA) {
+           hits[ir*nbins+ib] += 1;
+         }
+       }
+     }
+
+     retval = 1;
+  }
+  RAVE_OBJECT_RELEASE(param);
+  return retval;
+}
+
+
 int zdiff(PolarScan_t* scan, double thresh) {
   PolarScanParam_t* dbzu = NULL;
   PolarScanParam_t* dbzc = NULL;
@@ -124,6 +212,7 @@ int zdiff(PolarScan_t* scan, double thresh) {
   long nrays, nbins;
   double uval, cval, diff, quality;
   double gain = 1/255.0;
+  RAVE_STATS_SCOPE(RaveStats_Timer_QC_HAC);
 
   nbins = PolarScan_getNbins(scan);
   nrays = PolarScan_getNrays(scan);
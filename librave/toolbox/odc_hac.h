@@ -51,6 +51,27 @@ int hacFilter(PolarScan_t* scan, RaveField_t* hac, char* quant);
  */
 int hacIncrement(PolarScan_t* scan, RaveField_t* hac, char* quant);
 
+/**
+ * Performs HAC filtering using hit counts kept in memory instead of in a field.
+ * The quality field with how/task eu.opera.odc.hac must have been added to the scan.
+ * @param[in] scan - input scan
+ * @param[in] hits - the hits, nrays * nbins values
+ * @param[in] count - the number of accumulated scans
+ * @param[in] quant - string containing quantity, e.g. "DBZH"
+ * @returns int 1 if successful, otherwise 0
+ */
+int hacFilterHits(PolarScan_t* scan, const unsigned int* hits, long count, const char* quant);
+
+/**
+ * Increments hit counts kept in memory instead of in a field.
+ * @param[in] scan - input scan
+ * @param[in,out] hits - the hits, nrays * nbins values
+ * @param[in,out] count - the number of accumulated scans, incremented by one
+ * @param[in] quant - string containing quantity, e.g. "DBZH"
+ * @returns int 1 if successful, otherwise 0
+ */
+int hacIncrementHits(PolarScan_t* scan, unsigned int* hits, long* count, const char* quant);
+
 /**
  * Derives Z-diff quality indicator.
  * @param[in] scan - input scan
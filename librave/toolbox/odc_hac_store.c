@@ -0,0 +1,662 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of RAVE.
+
+RAVE is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RAVE is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+/**
+ * Long-lived store of hit-accumulation clutter (HAC) counters.
+ * @file
+ * @date 2026-10-17
+ */
+#include "odc_hac_store.h"
+#include "odc_hac.h"
+#include "rave_list.h"
+#include "rave_data2d.h"
+#include "rave_hlhdf_utilities.h"
+#include "rave_debug.h"
+#include "rave_alloc.h"
+#include "hlhdf.h"
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/stat.h>
+
+#ifdef PTHREAD_SUPPORTED
+#include <pthread.h>
+#endif
+
+/**
+ * Entries that have not been used for this many seconds (or twice the flush interval if that is longer)
+ * are written and released from the store.
+ */
+#define HAC_STORE_MIN_IDLE_TIME 3600
+
+/**
+ * One HAC accumulator or climatology
+ */
+typedef struct HacStoreEntry_t {
+  char* filename;      /**< the file */
+  long nrays;          /**< number of rays */
+  long nbins;          /**< number of bins */
+  unsigned int* hits;  /**< the hits, nrays * nbins */
+  long count;          /**< the number of accumulated scans */
+  int dirty;           /**< if the entry has been modified since it was written */
+  time_t lastflush;    /**< when the entry was last written */
+  time_t lastused;     /**< when the entry was last used */
+} HacStoreEntry_t;
+
+/**
+ * Represents the store
+ */
+struct _HacStore_t {
+  RAVE_OBJECT_HEAD /** Always on top */
+  int flushInterval;          /**< seconds between writes of a modified accumulator */
+  RaveList_t* accumulators;   /**< the accumulators */
+  RaveList_t* climatologies;  /**< the cached climatologies */
+#ifdef PTHREAD_SUPPORTED
+  pthread_mutex_t mutex;      /**< serializes access to the entries */
+#endif
+};
+
+/*@{ Private functions */
+/**
+ * Frees an entry
+ * @param[in] entry - the entry
+ */
+static void HacStoreInternal_freeEntry(HacStoreEntry_t* entry)
+{
+  if (entry != NULL) {
+    RAVE_FREE(entry->filename);
+    RAVE_FREE(entry->hits);
+    RAVE_FREE(entry);
+  }
+}
+
+/**
+ * Creates an entry with all hits set to 0.
+ * @param[in] filename - the file
+ * @param[in] nrays - number of rays
+ * @param[in] nbins - number of bins
+ * @return the entry or NULL on failure
+ */
+static HacStoreEntry_t* HacStoreInternal_createEntry(const char* filename, long nrays, long nbins)
+{
+  HacStoreEntry_t* entry = RAVE_MALLOC(sizeof(HacStoreEntry_t));
+  if (entry == NULL) {
+    RAVE_ERROR0("Failed to allocate HAC entry");
+    return NULL;
+  }
+  entry->filename = RAVE_STRDUP(filename);
+  entry->hits = RAVE_MALLOC(sizeof(unsigned int) * (nrays * nbins > 0 ? nrays * nbins : 1));
+  if (entry->filename == NULL || entry->hits == NULL) {
+    RAVE_ERROR0("Failed to allocate HAC entry");
+    HacStoreInternal_freeEntry(entry);
+    return NULL;
+  }
+  memset(entry->hits, 0, sizeof(unsigned int) * nrays * nbins);
+  entry->nrays = nrays;
+  entry->nbins = nbins;
+  entry->count = 0;
+  entry->dirty = 0;
+  entry->lastflush = time(NULL);
+  entry->lastused = entry->lastflush;
+  return entry;
+}
+
+/**
+ * Reads a HAC file.
+ * @param[in] filename - the file
+ * @param[out] missing - set to 1 if the file does not exist, 0 if it exists or could not be checked (may be NULL)
+ * @return the entry or NULL if the file does not exist or could not be read
+ */
+static HacStoreEntry_t* HacStoreInternal_readEntry(const char* filename, int* missing)
+{
+  HacStoreEntry_t* result = NULL;
+  HacStoreEntry_t* entry = NULL;
+  HL_NodeList* nodelist = NULL;
+  HL_Node* node = NULL;
+  RaveAttribute_t* attr = NULL;
+  RaveData2D_t* data = NULL;
+  struct stat st;
+  long nrays = 0, nbins = 0, count = 0, x = 0, y = 0;
+
+  if (missing != NULL) {
+    *missing = 0;
+  }
+  if (stat(filename, &st) != 0) {
+    if (errno == ENOENT) {
+      if (missing != NULL) {
+        *missing = 1;
+      }
+    } else {
+      RAVE_ERROR2("Failed to check HAC file %s: %s", filename, strerror(errno));
+    }
+    return NULL;
+  }
+
+  RaveHL_lock();
+  nodelist = HLNodeList_read(filename);
+  if (nodelist == NULL ||
+      !HLNodeList_selectNode(nodelist, "/accumulation_count") ||
+      !HLNodeList_selectNode(nodelist, "/hit_accum") ||
+      !HLNodeList_fetchMarkedNodes(nodelist)) {
+    RAVE_ERROR1("Failed to read HAC file %s", filename);
+    goto done;
+  }
+
+  attr = RaveHL_getAttribute(nodelist, "/accumulation_count");
+  node = HLNodeList_getNodeByName(nodelist, "/hit_accum");
+  if (attr == NULL || !RaveAttribute_getLong(attr, &count) || node == NULL || HLNode_getRank(node) != 2) {
+    RAVE_ERROR1("HAC file %s does not contain accumulation_count and hit_accum", filename);
+    goto done;
+  }
+  nrays = (long)HLNode_getDimension(node, 0);
+  nbins = (long)HLNode_getDimension(node, 1);
+
+  entry = HacStoreInternal_createEntry(filename, nrays, nbins);
+  if (entry == NULL) {
+    goto done;
+  }
+  entry->count = count;
+
+  if (RaveHL_hlhdfToRaveType(HLNode_getFormat(node)) == RaveDataType_UINT) {
+    memcpy(entry->hits, HLNode_getData(node), sizeof(unsigned int) * nrays * nbins);
+  } else {
+    /* Older files might have been written with another integer type */
+    data = RAVE_OBJECT_NEW(&RaveData2D_TYPE);
+    if (data == NULL ||
+        !RaveData2D_setData(data, nbins, nrays, HLNode_getData(node), RaveHL_hlhdfToRaveType(HLNode_getFormat(node)))) {
+      RAVE_ERROR1("Unsupported hit_accum data type in %s", filename);
+      goto done;
+    }
+    for (y = 0; y < nrays; y++) {
+      for (x = 0; x < nbins; x++) {
+        double v = 0.0;
+        RaveData2D_getValue(data, x, y, &v);
+        entry->hits[y * nbins + x] = (unsigned int)v;
+      }
+    }
+  }
+
+  result = entry;
+  entry = NULL;
+done:
+  HLNodeList_free(nodelist);
+  RaveHL_unlock();
+  RAVE_OBJECT_RELEASE(attr);
+  RAVE_OBJECT_RELEASE(data);
+  HacStoreInternal_freeEntry(entry);
+  return result;
+}
+
+/**
+ * Adds a scalar long attribute to the nodelist.
+ * @param[in] nodelist - the nodelist
+ * @param[in] name - the attribute name
+ * @param[in] value - the value
+ * @return 1 on success otherwise 0
+ */
+static int HacStoreInternal_addLongAttribute(HL_NodeList* nodelist, const char* name, long value)
+{
+  HL_Node* node = HLNode_newAttribute(name);
+  if (node == NULL ||
+      !HLNode_setScalarValue(node, sizeof(long), (unsigned char*)&value, "long", -1) ||
+      !HLNodeList_addNode(nodelist, node)) {
+    HLNode_free(node);
+    return 0;
+  }
+  return 1;
+}
+
+/**
+ * Writes the entry to its file. The file is first written under a temporary name and then
+ * renamed so that readers never see a partially written file.
+ * @param[in] entry - the entry
+ * @return 1 on success otherwise 0
+ */
+static int HacStoreInternal_writeEntry(HacStoreEntry_t* entry)
+{
+  int result = 0;
+  HL_NodeList* nodelist = NULL;
+  HL_Node* node = NULL;
+  HL_FileCreationProperty* property = NULL;
+  HL_Compression* compression = NULL;
+  hsize_t dims[2];
+  char tmpname[1024];
+
+  if (snprintf(tmpname, sizeof(tmpname), "%s.tmp", entry->filename) >= (int)sizeof(tmpname)) {
+    RAVE_ERROR1("Too long HAC file name %s", entry->filename);
+    return 0;
+  }
+
+  RaveHL_lock();
+  nodelist = HLNodeList_new();
+  property = RaveHL_createFileCreationProperty();
+  compression = HLCompression_new(CT_NONE);
+  if (nodelist == NULL || property == NULL || compression == NULL) {
+    RAVE_ERROR0("Failed to create nodelist");
+    goto done;
+  }
+
+  if (!HacStoreInternal_addLongAttribute(nodelist, "/accumulation_count", entry->count) ||
+      !HacStoreInternal_addLongAttribute(nodelist, "/validity_time_of_last_update", (long)time(NULL))) {
+    RAVE_ERROR0("Failed to add HAC attributes");
+    goto done;
+  }
+
+  dims[0] = (hsize_t)entry->nrays;
+  dims[1] = (hsize_t)entry->nbins;
+  node = HLNode_newDataset("/hit_accum");
+  if (node == NULL ||
+      !HLNode_setArrayValue(node, sizeof(unsigned int), 2, dims, (unsigned char*)entry->hits, "uint", -1) ||
+      !HLNodeList_addNode(nodelist, node)) {
+    HLNode_free(node);
+    RAVE_ERROR0("Failed to add hit_accum dataset");
+    goto done;
+  }
+
+  if (!HLNodeList_setFileName(nodelist, tmpname) ||
+      !HLNodeList_write(nodelist, property, compression)) {
+    RAVE_ERROR1("Failed to write HAC file %s", tmpname);
+    goto done;
+  }
+  if (rename(tmpname, entry->filename) != 0) {
+    RAVE_ERROR1("Failed to rename HAC file to %s", entry->filename);
+    remove(tmpname);
+    goto done;
+  }
+
+  entry->dirty = 0;
+  entry->lastflush = time(NULL);
+  result = 1;
+done:
+  HLNodeList_free(nodelist);
+  HLFileCreationProperty_free(property);
+  HLCompression_free(compression);
+  RaveHL_unlock();
+  return result;
+}
+
+/**
+ * Locates the entry with the specified filename.
+ * @param[in] entries - the list to search
+ * @param[in] filename - the file
+ * @param[out] index - the index of the entry (may be NULL)
+ * @return the entry or NULL if not found
+ */
+static HacStoreEntry_t* HacStoreInternal_findEntry(RaveList_t* entries, const char* filename, int* index)
+{
+  int i = 0, n = RaveList_size(entries);
+  for (i = 0; i < n; i++) {
+    HacStoreEntry_t* entry = (HacStoreEntry_t*)RaveList_get(entries, i);
+    if (strcmp(entry->filename, filename) == 0) {
+      if (index != NULL) {
+        *index = i;
+      }
+      return entry;
+    }
+  }
+  return NULL;
+}
+
+/**
+ * Writes and releases entries that have not been used for a while, e.g. the
+ * accumulators of last month or the climatologies of the month before.
+ * @param[in] self - self
+ * @param[in] now - the current time
+ */
+static void HacStoreInternal_releaseIdleEntries(HacStore_t* self, time_t now)
+{
+  int i = 0;
+  time_t idle = 2 * (time_t)self->flushInterval;
+  if (idle < HAC_STORE_MIN_IDLE_TIME) {
+    idle = HAC_STORE_MIN_IDLE_TIME;
+  }
+
+  for (i = RaveList_size(self->accumulators) - 1; i >= 0; i--) {
+    HacStoreEntry_t* entry = (HacStoreEntry_t*)RaveList_get(self->accumulators, i);
+    if (now - entry->lastused > idle && (!entry->dirty || HacStoreInternal_writeEntry(entry))) {
+      HacStoreInternal_freeEntry((HacStoreEntry_t*)RaveList_remove(self->accumulators, i));
+    }
+  }
+  for (i = RaveList_size(self->climatologies) - 1; i >= 0; i--) {
+    HacStoreEntry_t* entry = (HacStoreEntry_t*)RaveList_get(self->climatologies, i);
+    if (now - entry->lastused > idle) {
+      HacStoreInternal_freeEntry((HacStoreEntry_t*)RaveList_remove(self->climatologies, i));
+    }
+  }
+}
+
+/**
+ * Returns the climatology with the specified filename. An accumulator with the same filename takes
+ * precedence since it is more recent than the file. Otherwise the file is read and cached.
+ * @param[in] self - self
+ * @param[in] filename - the file
+ * @return the entry or NULL if there is no such climatology
+ */
+static HacStoreEntry_t* HacStoreInternal_getClimatology(HacStore_t* self, const char* filename)
+{
+  HacStoreEntry_t* entry = HacStoreInternal_findEntry(self->accumulators, filename, NULL);
+  if (entry == NULL) {
+    entry = HacStoreInternal_findEntry(self->climatologies, filename, NULL);
+  }
+  if (entry == NULL) {
+    /* A store only used for filtering is never flushed, so idle climatologies are released here */
+    HacStoreInternal_releaseIdleEntries(self, time(NULL));
+    entry = HacStoreInternal_readEntry(filename, NULL);
+    if (entry != NULL && !RaveList_add(self->climatologies, entry)) {
+      HacStoreInternal_freeEntry(entry);
+      entry = NULL;
+    }
+  }
+  if (entry != NULL) {
+    entry->lastused = time(NULL);
+  }
+  return entry;
+}
+
+/**
+ * Writes all modified accumulators. Must be called with the store locked.
+ * @param[in] self - self
+ * @return 1 if all files could be written otherwise 0
+ */
+static int HacStoreInternal_flush(HacStore_t* self)
+{
+  int result = 1, i = 0, n = RaveList_size(self->accumulators);
+  for (i = 0; i < n; i++) {
+    HacStoreEntry_t* entry = (HacStoreEntry_t*)RaveList_get(self->accumulators, i);
+    if (entry->dirty && !HacStoreInternal_writeEntry(entry)) {
+      result = 0;
+    }
+  }
+  return result;
+}
+
+/**
+ * Returns the accumulator with the specified filename. If it is not in the store, it is
+ * read from the file or created with the specified geometry if there is no such file. A file that
+ * exists but can not be read is left untouched and NULL is returned.
+ * Must be called with the store locked.
+ * @param[in] self - self
+ * @param[in] filename - the file
+ * @param[in] nrays - number of rays of the data to accumulate
+ * @param[in] nbins - number of bins of the data to accumulate
+ * @return the entry or NULL on failure or if the geometries differ
+ */
+static HacStoreEntry_t* HacStoreInternal_getAccumulator(HacStore_t* self, const char* filename, long nrays, long nbins)
+{
+  HacStoreEntry_t* entry = HacStoreInternal_findEntry(self->accumulators, filename, NULL);
+  if (entry == NULL) {
+    int cindex = 0, missing = 0;
+    /* A cached climatology is the same file so it can continue as accumulator */
+    entry = HacStoreInternal_findEntry(self->climatologies, filename, &cindex);
+    if (entry != NULL) {
+      RaveList_remove(self->climatologies, cindex);
+    } else {
+      entry = HacStoreInternal_readEntry(filename, &missing);
+      /* Only start from zero when there is no file, otherwise the next flush would overwrite an
+       * existing accumulation that just could not be read this time */
+      if (entry == NULL && missing) {
+        entry = HacStoreInternal_createEntry(filename, nrays, nbins);
+      }
+    }
+    if (entry == NULL) {
+      return NULL;
+    }
+    if (!RaveList_add(self->accumulators, entry)) {
+      HacStoreInternal_freeEntry(entry);
+      return NULL;
+    }
+  }
+
+  if (entry->nrays != nrays || entry->nbins != nbins) {
+    RAVE_ERROR1("Scan and HAC have different geometries for %s", filename);
+    return NULL;
+  }
+  return entry;
+}
+
+/**
+ * Marks the accumulator as modified and writes it if the flush interval has passed.
+ * Must be called with the store locked.
+ * @param[in] self - self
+ * @param[in] entry - the modified accumulator
+ * @param[in] now - the current time
+ */
+static void HacStoreInternal_modified(HacStore_t* self, HacStoreEntry_t* entry, time_t now)
+{
+  entry->dirty = 1;
+  entry->lastused = now;
+  if (now - entry->lastflush >= self->flushInterval) {
+    /* A failed write is retried at the next interval, the counts are kept in memory */
+    HacStoreInternal_writeEntry(entry);
+    HacStoreInternal_releaseIdleEntries(self, now);
+  }
+}
+
+static void HacStoreInternal_lock(HacStore_t* self)
+{
+#ifdef PTHREAD_SUPPORTED
+  pthread_mutex_lock(&self->mutex);
+#endif
+}
+
+static void HacStoreInternal_unlock(HacStore_t* self)
+{
+#ifdef PTHREAD_SUPPORTED
+  pthread_mutex_unlock(&self->mutex);
+#endif
+}
+
+static int HacStore_constructor(RaveCoreObject* obj)
+{
+  HacStore_t* this = (HacStore_t*)obj;
+  this->flushInterval = 300;
+  this->accumulators = RAVE_OBJECT_NEW(&RaveList_TYPE);
+  this->climatologies = RAVE_OBJECT_NEW(&RaveList_TYPE);
+  if (this->accumulators == NULL || this->climatologies == NULL) {
+    RAVE_OBJECT_RELEASE(this->accumulators);
+    RAVE_OBJECT_RELEASE(this->climatologies);
+    return 0;
+  }
+#ifdef PTHREAD_SUPPORTED
+  pthread_mutex_init(&this->mutex, NULL);
+#endif
+  return 1;
+}
+
+/**
+ * Destructor. Modified accumulators are written before they are released.
+ */
+static void HacStore_destructor(RaveCoreObject* obj)
+{
+  HacStore_t* this = (HacStore_t*)obj;
+  HacStoreInternal_flush(this);
+  while (RaveList_size(this->accumulators) > 0) {
+    HacStoreInternal_freeEntry((HacStoreEntry_t*)RaveList_removeLast(this->accumulators));
+  }
+  while (RaveList_size(this->climatologies) > 0) {
+    HacStoreInternal_freeEntry((HacStoreEntry_t*)RaveList_removeLast(this->climatologies));
+  }
+  RAVE_OBJECT_RELEASE(this->accumulators);
+  RAVE_OBJECT_RELEASE(this->climatologies);
+#ifdef PTHREAD_SUPPORTED
+  pthread_mutex_destroy(&this->mutex);
+#endif
+}
+/*@} End of Private functions */
+
+/*@{ Interface functions */
+void HacStore_setFlushInterval(HacStore_t* self, int interval)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  self->flushInterval = interval < 0 ? 0 : interval;
+}
+
+int HacStore_getFlushInterval(HacStore_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return self->flushInterval;
+}
+
+int HacStore_increment(HacStore_t* self, const char* filename, PolarScan_t* scan, const char* quant)
+{
+  int result = 0;
+  HacStoreEntry_t* entry = NULL;
+  time_t now = time(NULL);
+
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  if (filename == NULL || scan == NULL || quant == NULL) {
+    RAVE_ERROR0("HacStore_increment requires filename, scan and quantity");
+    return 0;
+  }
+
+  HacStoreInternal_lock(self);
+  entry = HacStoreInternal_getAccumulator(self, filename, PolarScan_getNrays(scan), PolarScan_getNbins(scan));
+  if (entry != NULL) {
+    result = hacIncrementHits(scan, entry->hits, &entry->count, quant);
+    if (result) {
+      HacStoreInternal_modified(self, entry, now);
+    }
+  }
+  HacStoreInternal_unlock(self);
+  return result;
+}
+
+int HacStore_incrementHits(HacStore_t* self, const char* filename, RaveField_t* hits)
+{
+  HacStoreEntry_t* entry = NULL;
+  long nrays = 0, nbins = 0, ir = 0, ib = 0;
+  double val = 0.0;
+  time_t now = time(NULL);
+
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  if (filename == NULL || hits == NULL) {
+    RAVE_ERROR0("HacStore_incrementHits requires filename and hits");
+    return 0;
+  }
+  nrays = RaveField_getYsize(hits);
+  nbins = RaveField_getXsize(hits);
+
+  HacStoreInternal_lock(self);
+  entry = HacStoreInternal_getAccumulator(self, filename, nrays, nbins);
+  if (entry != NULL) {
+    for (ir = 0; ir < nrays; ir++) {
+      for (ib = 0; ib < nbins; ib++) {
+        if (RaveField_getValue(hits, ib, ir, &val) && val != 0.0) {
+          entry->hits[ir*nbins+ib] += 1;
+        }
+      }
+    }
+    entry->count += 1;
+    HacStoreInternal_modified(self, entry, now);
+  }
+  HacStoreInternal_unlock(self);
+  return (entry != NULL) ? 1 : 0;
+}
+
+int HacStore_getClimatology(HacStore_t* self, const char* filename, long* count, long* nrays, long* nbins)
+{
+  int result = 0;
+  HacStoreEntry_t* entry = NULL;
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  if (filename == NULL) {
+    return 0;
+  }
+  HacStoreInternal_lock(self);
+  entry = HacStoreInternal_getClimatology(self, filename);
+  if (entry != NULL) {
+    if (count != NULL) {
+      *count = entry->count;
+    }
+    if (nrays != NULL) {
+      *nrays = entry->nrays;
+    }
+    if (nbins != NULL) {
+      *nbins = entry->nbins;
+    }
+    result = 1;
+  }
+  HacStoreInternal_unlock(self);
+  return result;
+}
+
+int HacStore_filter(HacStore_t* self, const char* filename, PolarScan_t* scan, const char* quant)
+{
+  int result = 0;
+  HacStoreEntry_t* entry = NULL;
+
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  if (filename == NULL || scan == NULL || quant == NULL) {
+    RAVE_ERROR0("HacStore_filter requires filename, scan and quantity");
+    return 0;
+  }
+
+  HacStoreInternal_lock(self);
+  entry = HacStoreInternal_getClimatology(self, filename);
+  if (entry == NULL) {
+    goto done;
+  }
+  if (entry->nrays != PolarScan_getNrays(scan) || entry->nbins != PolarScan_getNbins(scan)) {
+    RAVE_ERROR1("Scan and HAC have different geometries for %s", filename);
+    goto done;
+  }
+  result = hacFilterHits(scan, entry->hits, entry->count, quant);
+done:
+  HacStoreInternal_unlock(self);
+  return result;
+}
+
+int HacStore_flush(HacStore_t* self)
+{
+  int result = 0;
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  HacStoreInternal_lock(self);
+  result = HacStoreInternal_flush(self);
+  HacStoreInternal_releaseIdleEntries(self, time(NULL));
+  HacStoreInternal_unlock(self);
+  return result;
+}
+
+int HacStore_getNumberOfAccumulators(HacStore_t* self)
+{
+  int result = 0;
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  HacStoreInternal_lock(self);
+  result = RaveList_size(self->accumulators);
+  HacStoreInternal_unlock(self);
+  return result;
+}
+
+int HacStore_getNumberOfClimatologies(HacStore_t* self)
+{
+  int result = 0;
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  HacStoreInternal_lock(self);
+  result = RaveList_size(self->climatologies);
+  HacStoreInternal_unlock(self);
+  return result;
+}
+/*@} End of Interface functions */
+
+RaveCoreObjectType HacStore_TYPE = {
+    "HacStore",
+    sizeof(HacStore_t),
+    HacStore_constructor,
+    HacStore_destructor,
+    NULL
+};
@@ -0,0 +1,125 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of RAVE.
+
+RAVE is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RAVE is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+/**
+ * Long-lived store of hit-accumulation clutter (HAC) counters. Instead of reading and
+ * writing the HAC file for every scan, the accumulators are kept in memory and written
+ * back to their files at a configurable interval. Previous months files that are used
+ * for filtering are read once and cached read-only.
+ * The files are identified by their file names and have the same layout as the ones
+ * written by odc_hac.py, i.e. /accumulation_count, /validity_time_of_last_update and /hit_accum.
+ * @file
+ * @date 2026-10-17
+ */
+#ifndef ODC_HAC_STORE_H
+#define ODC_HAC_STORE_H
+#include "rave_object.h"
+#include "polarscan.h"
+#include "rave_field.h"
+
+/**
+ * Defines the HAC store
+ */
+typedef struct _HacStore_t HacStore_t;
+
+/**
+ * Type definition to use when creating a rave object.
+ */
+extern RaveCoreObjectType HacStore_TYPE;
+
+/**
+ * Sets the number of seconds an accumulator may be modified in memory before it is written
+ * back to its file. If interval is 0, the file is written after each increment.
+ * @param[in] self - self
+ * @param[in] interval - the interval in seconds (default 300)
+ */
+void HacStore_setFlushInterval(HacStore_t* self, int interval);
+
+/**
+ * @param[in] self - self
+ * @return the flush interval in seconds
+ */
+int HacStore_getFlushInterval(HacStore_t* self);
+
+/**
+ * Increments the accumulator identified by filename with the hits in the scan. If the accumulator
+ * is not in the store, it is read from the file or created with the geometry of the scan if there
+ * is no such file.
+ * @param[in] self - self
+ * @param[in] filename - the HAC file
+ * @param[in] scan - the scan
+ * @param[in] quant - the quantity, e.g. "DBZH"
+ * @return 1 on success, 0 if the scan does not contain the quantity or if the geometries differ
+ */
+int HacStore_increment(HacStore_t* self, const char* filename, PolarScan_t* scan, const char* quant);
+
+/**
+ * Increments the accumulator identified by filename with hits that already have been extracted
+ * from a scan, e.g. in another process. Each non-zero bin in the field is one hit and the number
+ * of accumulated scans is incremented by one. The accumulator is located or created as in
+ * \ref HacStore_increment.
+ * @param[in] self - self
+ * @param[in] filename - the HAC file
+ * @param[in] hits - a field with xsize = nbins and ysize = nrays
+ * @return 1 on success, 0 if the geometries differ
+ */
+int HacStore_incrementHits(HacStore_t* self, const char* filename, RaveField_t* hits);
+
+/**
+ * Returns information about the climatology identified by filename. If the file is accumulated by this
+ * store the in-memory accumulator is used, otherwise the file is read once and cached read-only.
+ * @param[in] self - self
+ * @param[in] filename - the HAC file
+ * @param[out] count - the number of accumulated scans (may be NULL)
+ * @param[out] nrays - the number of rays (may be NULL)
+ * @param[out] nbins - the number of bins (may be NULL)
+ * @return 1 if the climatology exists, otherwise 0
+ */
+int HacStore_getClimatology(HacStore_t* self, const char* filename, long* count, long* nrays, long* nbins);
+
+/**
+ * Filters the scan with the climatology identified by filename, see \ref hacFilterHits.
+ * The quality field with how/task eu.opera.odc.hac must have been added to the scan.
+ * @param[in] self - self
+ * @param[in] filename - the HAC file
+ * @param[in] scan - the scan
+ * @param[in] quant - the quantity, e.g. "DBZH"
+ * @return 1 on success, 0 if there is no climatology, if the geometries differ or if the filter failed
+ */
+int HacStore_filter(HacStore_t* self, const char* filename, PolarScan_t* scan, const char* quant);
+
+/**
+ * Writes all modified accumulators to their files.
+ * @param[in] self - self
+ * @return 1 if all files could be written, otherwise 0
+ */
+int HacStore_flush(HacStore_t* self);
+
+/**
+ * @param[in] self - self
+ * @return the number of accumulators that are kept in memory
+ */
+int HacStore_getNumberOfAccumulators(HacStore_t* self);
+
+/**
+ * @param[in] self - self
+ * @return the number of cached climatologies
+ */
+int HacStore_getNumberOfClimatologies(HacStore_t* self);
+
+#endif /* ODC_HAC_STORE_H */
@@ -167,12 +167,12 @@ int OdimIoUtilities_addRaveField(RaveField_t* field, HL_NodeList* nodelist, Rave
     goto done;
   }
 
-  if (!RaveHL_addData(nodelist,
-                      RaveField_getData(field),
-                      RaveField_getXsize(field),
-                      RaveField_getYsize(field),
-                      RaveField_getDataType(field),
-                      name)) {
+  if (!RaveHL_addBorrowedData(nodelist,
+                              (void*)RaveField_getReadOnlyData(field),
+                              RaveField_getXsize(field),
+                              RaveField_getYsize(field),
+                              RaveField_getDataType(field),
+                              name)) {
     goto done;
   }
 
@@ -29,6 +29,7 @@ along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
 #include <string.h>
 #include "odim_io_utilities.h"
 #include "lazy_dataset.h"
+#include "rave_stats.h"
 #include <math.h>
 
 /**
@@ -676,12 +677,12 @@ static int PolarOdimIOInternal_addParameter(PolarOdimIO_t* self, PolarScanParam_
     goto done;
   }
 
-  if (!RaveHL_addData(nodelist,
-                      PolarScanParam_getData(param),
-                      PolarScanParam_getNbins(param),
-                      PolarScanParam_getNrays(param),
-                      PolarScanParam_getDataType(param),
-                      name)) {
+  if (!RaveHL_addBorrowedData(nodelist,
+                              (void*)PolarScanParam_getReadOnlyData(param),
+                              PolarScanParam_getNbins(param),
+                              PolarScanParam_getNrays(param),
+                              PolarScanParam_getDataType(param),
+                              name)) {
     goto done;
   }
 
@@ -1032,6 +1033,7 @@ int PolarOdimIO_readScan(PolarOdimIO_t* self, LazyNodeListReader_t* lazyReader,
 {
   int result = 0;
   OdimIoUtilityArg arg;
+  RAVE_STATS_SCOPE(RaveStats_Timer_POLAR_ODIM_READ);
 
   RAVE_ASSERT((self != NULL), "self == NULL");
   RAVE_ASSERT((lazyReader != NULL), "lazyReader == NULL");
@@ -1071,6 +1073,7 @@ int PolarOdimIO_readVolume(PolarOdimIO_t* self, LazyNodeListReader_t* lazyReader
   int result = 0;
   int pindex = 1;
   OdimIoUtilityArg arg;
+  RAVE_STATS_SCOPE(RaveStats_Timer_POLAR_ODIM_READ);
 
   RAVE_ASSERT((self != NULL), "self == NULL");
   RAVE_ASSERT((lazyReader != NULL), "lazyReader == NULL");
@@ -1116,6 +1119,7 @@ int PolarOdimIO_fillScan(PolarOdimIO_t* self, PolarScan_t* scan, HL_NodeList* no
   RaveObjectList_t* qualityfields = NULL;
   char* source = NULL;
   double rstartFactor = 1.0;
+  RAVE_STATS_SCOPE(RaveStats_Timer_POLAR_ODIM_WRITE);
 
   RAVE_ASSERT((self != NULL), "self == NULL");
   RAVE_ASSERT((scan != NULL), "scan == NULL");
@@ -1232,6 +1236,7 @@ int PolarOdimIO_fillVolume(PolarOdimIO_t* self, PolarVolume_t* volume, HL_NodeLi
 
   int nrscans = 0;
   int index = 0;
+  RAVE_STATS_SCOPE(RaveStats_Timer_POLAR_ODIM_WRITE);
 
   RAVE_ASSERT((self != NULL), "self == NULL");
   RAVE_ASSERT((volume != NULL), "volume == NULL");
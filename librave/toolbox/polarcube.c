@@ -0,0 +1,678 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of RAVE.
+
+RAVE is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RAVE is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+/**
+ * A contiguous elevation x ray x bin cube with the decoded values of one quantity in a polar volume.
+ * @file
+ * @date 2026-10-17
+ */
+#include "polarcube.h"
+#include "rave_debug.h"
+#include "rave_alloc.h"
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+/**
+ * Represents the cube
+ */
+struct _PolarCube_t {
+  RAVE_OBJECT_HEAD /** Always on top */
+  char* quantity;         /**< the quantity */
+  long nelevs;            /**< number of elevations */
+  long nrays;             /**< number of rays */
+  long nbins;             /**< number of bins */
+  double dscale;          /**< surface distance between two bins in meters */
+  double* elangles;       /**< elevation angles, nelevs */
+  double* ranges;         /**< slant ranges, nelevs * nbins */
+  double* heights;        /**< heights above sea level, nelevs * nbins */
+  double* values;         /**< decoded values, nelevs * nrays * nbins */
+  unsigned char* types;   /**< value types, nelevs * nrays * nbins */
+  PolarNavigator_t* navigator; /**< the navigator */
+};
+
+/**
+ * Flags used by the kernels to keep track of what a column contains
+ */
+#define POLARCUBE_SEEN_UNDETECT 1 /**< column has undetect */
+#define POLARCUBE_SEEN_DATA     2 /**< column has data */
+#define POLARCUBE_SEEN_FOUND    4 /**< kernel has found what it looks for */
+
+/**
+ * Reflectivity above this (dBZ) is assumed to be hail and is capped when calculating VIL
+ */
+#define POLARCUBE_VIL_MAX_DBZ 56.0
+
+/**
+ * Number of bits in the index of the conversion caches used when calculating VIL
+ */
+#define POLARCUBE_CACHE_BITS 10
+
+/**
+ * Number of entries in the conversion caches used when calculating VIL
+ */
+#define POLARCUBE_CACHE_SIZE (1 << POLARCUBE_CACHE_BITS)
+
+/**
+ * Remembers the results of a conversion. The decoded values are quantized by the gain of the scans
+ * so there are only a few hundred distinct values in a plane and the conversions are mostly looked up.
+ */
+typedef struct PolarCubeCache {
+  double keys[POLARCUBE_CACHE_SIZE];   /**< the converted values, NaN if the entry is unused */
+  double values[POLARCUBE_CACHE_SIZE]; /**< the result of the conversion */
+} PolarCubeCache;
+
+/*@{ Private functions */
+/**
+ * Releases all arrays.
+ * @param[in] self - self
+ */
+static void PolarCubeInternal_freeArrays(PolarCube_t* self)
+{
+  RAVE_FREE(self->elangles);
+  RAVE_FREE(self->ranges);
+  RAVE_FREE(self->heights);
+  RAVE_FREE(self->values);
+  RAVE_FREE(self->types);
+  self->nelevs = self->nrays = self->nbins = 0;
+}
+
+/**
+ * Constructor.
+ */
+static int PolarCube_constructor(RaveCoreObject* obj)
+{
+  PolarCube_t* self = (PolarCube_t*)obj;
+  self->quantity = NULL;
+  self->nelevs = self->nrays = self->nbins = 0;
+  self->dscale = 0.0;
+  self->elangles = NULL;
+  self->ranges = NULL;
+  self->heights = NULL;
+  self->values = NULL;
+  self->types = NULL;
+  self->navigator = RAVE_OBJECT_NEW(&PolarNavigator_TYPE);
+  if (self->navigator == NULL) {
+    return 0;
+  }
+  return 1;
+}
+
+/**
+ * Copy constructor.
+ */
+static int PolarCube_copyconstructor(RaveCoreObject* obj, RaveCoreObject* srcobj)
+{
+  PolarCube_t* self = (PolarCube_t*)obj;
+  PolarCube_t* src = (PolarCube_t*)srcobj;
+  long ncells = src->nelevs * src->nrays * src->nbins;
+
+  PolarCube_constructor(obj);
+  RAVE_OBJECT_RELEASE(self->navigator);
+  self->navigator = RAVE_OBJECT_CLONE(src->navigator);
+  if (self->navigator == NULL || !PolarCube_setQuantity(self, src->quantity)) {
+    goto fail;
+  }
+  if (src->nelevs > 0) {
+    if (!PolarCube_init(self, src->nelevs, src->nrays, src->nbins, src->dscale)) {
+      goto fail;
+    }
+    memcpy(self->elangles, src->elangles, sizeof(double) * src->nelevs);
+    memcpy(self->ranges, src->ranges, sizeof(double) * src->nelevs * src->nbins);
+    memcpy(self->heights, src->heights, sizeof(double) * src->nelevs * src->nbins);
+    memcpy(self->values, src->values, sizeof(double) * ncells);
+    memcpy(self->types, src->types, sizeof(unsigned char) * ncells);
+  }
+  return 1;
+fail:
+  RAVE_FREE(self->quantity);
+  RAVE_OBJECT_RELEASE(self->navigator);
+  PolarCubeInternal_freeArrays(self);
+  return 0;
+}
+
+/**
+ * Destructor.
+ */
+static void PolarCube_destructor(RaveCoreObject* obj)
+{
+  PolarCube_t* self = (PolarCube_t*)obj;
+  RAVE_FREE(self->quantity);
+  RAVE_OBJECT_RELEASE(self->navigator);
+  PolarCubeInternal_freeArrays(self);
+}
+
+/**
+ * Creates the result field for a kernel.
+ * @param[in] self - self
+ * @param[in] nodata - the nodata value
+ * @param[out] data - the data array of the field
+ * @return the field or NULL on failure
+ */
+static RaveData2D_t* PolarCubeInternal_createResult(PolarCube_t* self, double nodata, double** data)
+{
+  RaveData2D_t* result = NULL;
+  if (self->nelevs <= 0) {
+    RAVE_ERROR0("Cube has not been initialized");
+    return NULL;
+  }
+  result = RaveData2D_zeros(self->nbins, self->nrays, RaveDataType_DOUBLE);
+  if (result != NULL) {
+    RaveData2D_setNodata(result, nodata);
+    RaveData2D_useNodata(result, 1);
+    *data = (double*)RaveData2D_getData(result);
+  }
+  return result;
+}
+
+/**
+ * Sets nodata or undetect in all columns that the kernel has not found anything in.
+ * @param[in] out - the result
+ * @param[in] seen - the column flags
+ * @param[in] n - number of columns
+ * @param[in] nodata - the nodata value
+ * @param[in] undetect - the undetect value
+ */
+static void PolarCubeInternal_finish(double* out, unsigned char* seen, long n, double nodata, double undetect)
+{
+  long i = 0;
+  for (i = 0; i < n; i++) {
+    if (!(seen[i] & POLARCUBE_SEEN_FOUND)) {
+      out[i] = (seen[i] & (POLARCUBE_SEEN_DATA | POLARCUBE_SEEN_UNDETECT)) ? undetect : nodata;
+    }
+  }
+}
+
+/**
+ * Clears the cache.
+ * @param[in] cache - the cache
+ */
+static void PolarCubeInternal_clearCache(PolarCubeCache* cache)
+{
+  int i = 0;
+  for (i = 0; i < POLARCUBE_CACHE_SIZE; i++) {
+    cache->keys[i] = NAN;
+  }
+}
+
+/**
+ * Returns the cache entry for the value.
+ * @param[in] x - the value
+ * @return the index in the cache
+ */
+static unsigned int PolarCubeInternal_cacheIndex(double x)
+{
+  unsigned long long bits = 0;
+  memcpy(&bits, &x, sizeof(double));
+  bits ^= bits >> 32;
+  bits *= 0x9E3779B97F4A7C15ULL;
+  return (unsigned int)(bits >> (64 - POLARCUBE_CACHE_BITS));
+}
+
+/**
+ * Converts a reflectivity in dBZ into the reflectivity factor Z.
+ * @param[in] cache - the cache with previous conversions
+ * @param[in] dbz - the reflectivity
+ * @return Z
+ */
+static double PolarCubeInternal_dbzToZ(PolarCubeCache* cache, double dbz)
+{
+  unsigned int i = PolarCubeInternal_cacheIndex(dbz);
+  if (cache->keys[i] != dbz) {
+    cache->keys[i] = dbz;
+    cache->values[i] = pow(10.0, dbz / 10.0);
+  }
+  return cache->values[i];
+}
+
+/**
+ * Converts a reflectivity factor Z into liquid water content per meter of the column (kg/m3).
+ * @param[in] cache - the cache with previous conversions
+ * @param[in] z - the reflectivity factor
+ * @return the liquid water content
+ */
+static double PolarCubeInternal_zToM(PolarCubeCache* cache, double z)
+{
+  unsigned int i = PolarCubeInternal_cacheIndex(z);
+  if (cache->keys[i] != z) {
+    cache->keys[i] = z;
+    cache->values[i] = 3.44e-6 * pow(z, 4.0 / 7.0);
+  }
+  return cache->values[i];
+}
+/*@} End of Private functions */
+
+/*@{ Interface functions */
+int PolarCube_init(PolarCube_t* self, long nelevs, long nrays, long nbins, double dscale)
+{
+  long ncells = 0, i = 0;
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  if (nelevs <= 0 || nrays <= 0 || nbins <= 0) {
+    RAVE_ERROR0("Cube dimensions must be > 0");
+    return 0;
+  }
+  PolarCubeInternal_freeArrays(self);
+
+  ncells = nelevs * nrays * nbins;
+  self->elangles = RAVE_CALLOC(nelevs, sizeof(double));
+  self->ranges = RAVE_CALLOC(nelevs * nbins, sizeof(double));
+  self->heights = RAVE_CALLOC(nelevs * nbins, sizeof(double));
+  self->values = RAVE_CALLOC(ncells, sizeof(double));
+  self->types = RAVE_MALLOC(ncells * sizeof(unsigned char));
+  if (self->elangles == NULL || self->ranges == NULL || self->heights == NULL || self->values == NULL || self->types == NULL) {
+    RAVE_ERROR0("Failed to allocate memory for cube");
+    PolarCubeInternal_freeArrays(self);
+    return 0;
+  }
+  for (i = 0; i < ncells; i++) {
+    self->types[i] = (unsigned char)RaveValueType_NODATA;
+  }
+  self->nelevs = nelevs;
+  self->nrays = nrays;
+  self->nbins = nbins;
+  self->dscale = dscale;
+  return 1;
+}
+
+int PolarCube_setQuantity(PolarCube_t* self, const char* quantity)
+{
+  char* tmp = NULL;
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  if (quantity != NULL) {
+    tmp = RAVE_STRDUP(quantity);
+    if (tmp == NULL) {
+      return 0;
+    }
+  }
+  RAVE_FREE(self->quantity);
+  self->quantity = tmp;
+  return 1;
+}
+
+const char* PolarCube_getQuantity(PolarCube_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return (const char*)self->quantity;
+}
+
+long PolarCube_getNumberOfElevations(PolarCube_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return self->nelevs;
+}
+
+long PolarCube_getNrays(PolarCube_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return self->nrays;
+}
+
+long PolarCube_getNbins(PolarCube_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return self->nbins;
+}
+
+double PolarCube_getDscale(PolarCube_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return self->dscale;
+}
+
+void PolarCube_setNavigator(PolarCube_t* self, PolarNavigator_t* navigator)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  RAVE_ASSERT((navigator != NULL), "navigator == NULL");
+  RAVE_OBJECT_RELEASE(self->navigator);
+  self->navigator = RAVE_OBJECT_COPY(navigator);
+}
+
+PolarNavigator_t* PolarCube_getNavigator(PolarCube_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return RAVE_OBJECT_COPY(self->navigator);
+}
+
+int PolarCube_getColumn(PolarCube_t* self, double lon, double lat, long* ri, long* bi)
+{
+  double d = 0.0, a = 0.0;
+  long r = 0, b = 0;
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  RAVE_ASSERT((ri != NULL), "ri == NULL");
+  RAVE_ASSERT((bi != NULL), "bi == NULL");
+  if (self->nelevs <= 0 || self->dscale <= 0.0) {
+    return 0;
+  }
+  PolarNavigator_llToDa(self->navigator, lat, lon, &d, &a);
+  b = (long)floor(d / self->dscale);
+  if (b < 0 || b >= self->nbins) {
+    return 0;
+  }
+  r = (long)floor(a * (double)self->nrays / (2.0 * M_PI) + 0.5) % self->nrays;
+  if (r < 0) {
+    r += self->nrays;
+  }
+  *ri = r;
+  *bi = b;
+  return 1;
+}
+
+int PolarCube_setElangle(PolarCube_t* self, long ei, double elangle)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  if (ei < 0 || ei >= self->nelevs) {
+    return 0;
+  }
+  self->elangles[ei] = elangle;
+  return 1;
+}
+
+double PolarCube_getElangle(PolarCube_t* self, long ei)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  if (ei < 0 || ei >= self->nelevs) {
+    return 0.0;
+  }
+  return self->elangles[ei];
+}
+
+double* PolarCube_getRanges(PolarCube_t* self, long ei)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  if (ei < 0 || ei >= self->nelevs) {
+    return NULL;
+  }
+  return self->ranges + ei * self->nbins;
+}
+
+double* PolarCube_getHeights(PolarCube_t* self, long ei)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  if (ei < 0 || ei >= self->nelevs) {
+    return NULL;
+  }
+  return self->heights + ei * self->nbins;
+}
+
+double* PolarCube_getValues(PolarCube_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return self->values;
+}
+
+unsigned char* PolarCube_getTypes(PolarCube_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return self->types;
+}
+
+RaveValueType PolarCube_getValue(PolarCube_t* self, long ei, long ri, long bi, double* v)
+{
+  long idx = 0;
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  if (ei < 0 || ei >= self->nelevs || ri < 0 || ri >= self->nrays || bi < 0 || bi >= self->nbins) {
+    return RaveValueType_UNDEFINED;
+  }
+  idx = (ei * self->nrays + ri) * self->nbins + bi;
+  if (v != NULL) {
+    *v = self->values[idx];
+  }
+  return (RaveValueType)self->types[idx];
+}
+
+int PolarCube_setValue(PolarCube_t* self, long ei, long ri, long bi, RaveValueType type, double v)
+{
+  long idx = 0;
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  if (ei < 0 || ei >= self->nelevs || ri < 0 || ri >= self->nrays || bi < 0 || bi >= self->nbins) {
+    return 0;
+  }
+  idx = (ei * self->nrays + ri) * self->nbins + bi;
+  self->values[idx] = v;
+  self->types[idx] = (unsigned char)type;
+  return 1;
+}
+
+/*
+ * The kernels walk one elevation plane at a time with the innermost loop over contiguous bins and
+ * without function calls or early exits, so that the compiler can vectorize them.
+ */
+RaveData2D_t* PolarCube_max(PolarCube_t* self, double nodata, double undetect)
+{
+  RaveData2D_t *field = NULL, *result = NULL;
+  unsigned char* seen = NULL;
+  double* out = NULL;
+  long n = 0, e = 0, i = 0;
+
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  field = PolarCubeInternal_createResult(self, nodata, &out);
+  if (field == NULL || out == NULL) {
+    goto done;
+  }
+  n = self->nrays * self->nbins;
+  seen = RAVE_CALLOC(n, sizeof(unsigned char));
+  if (seen == NULL) {
+    goto done;
+  }
+  for (i = 0; i < n; i++) {
+    out[i] = -DBL_MAX;
+  }
+  for (e = 0; e < self->nelevs; e++) {
+    const double* v = self->values + e * n;
+    const unsigned char* t = self->types + e * n;
+    for (i = 0; i < n; i++) {
+      int isdata = (t[i] == RaveValueType_DATA);
+      out[i] = (isdata && v[i] > out[i]) ? v[i] : out[i];
+      seen[i] |= (unsigned char)((isdata ? (POLARCUBE_SEEN_DATA | POLARCUBE_SEEN_FOUND) : 0) |
+                                 ((t[i] == RaveValueType_UNDETECT) ? POLARCUBE_SEEN_UNDETECT : 0));
+    }
+  }
+  PolarCubeInternal_finish(out, seen, n, nodata, undetect);
+  result = RAVE_OBJECT_COPY(field);
+done:
+  RAVE_FREE(seen);
+  RAVE_OBJECT_RELEASE(field);
+  return result;
+}
+
+RaveData2D_t* PolarCube_echoTop(PolarCube_t* self, double threshold, double nodata, double undetect)
+{
+  RaveData2D_t *field = NULL, *result = NULL;
+  unsigned char* seen = NULL;
+  double* out = NULL;
+  long n = 0, e = 0, i = 0, r = 0, b = 0;
+
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  field = PolarCubeInternal_createResult(self, nodata, &out);
+  if (field == NULL || out == NULL) {
+    goto done;
+  }
+  n = self->nrays * self->nbins;
+  seen = RAVE_CALLOC(n, sizeof(unsigned char));
+  if (seen == NULL) {
+    goto done;
+  }
+  for (i = 0; i < n; i++) {
+    out[i] = -DBL_MAX;
+  }
+  for (e = 0; e < self->nelevs; e++) {
+    const double* h = self->heights + e * self->nbins;
+    for (r = 0; r < self->nrays; r++) {
+      const double* v = self->values + (e * self->nrays + r) * self->nbins;
+      const unsigned char* t = self->types + (e * self->nrays + r) * self->nbins;
+      double* o = out + r * self->nbins;
+      unsigned char* s = seen + r * self->nbins;
+      for (b = 0; b < self->nbins; b++) {
+        int isdata = (t[b] == RaveValueType_DATA);
+        int found = (isdata && v[b] >= threshold);
+        o[b] = (found && h[b] > o[b]) ? h[b] : o[b];
+        s[b] |= (unsigned char)((isdata ? POLARCUBE_SEEN_DATA : 0) | (found ? POLARCUBE_SEEN_FOUND : 0) |
+                                ((t[b] == RaveValueType_UNDETECT) ? POLARCUBE_SEEN_UNDETECT : 0));
+      }
+    }
+  }
+  PolarCubeInternal_finish(out, seen, n, nodata, undetect);
+  result = RAVE_OBJECT_COPY(field);
+done:
+  RAVE_FREE(seen);
+  RAVE_OBJECT_RELEASE(field);
+  return result;
+}
+
+RaveData2D_t* PolarCube_vil(PolarCube_t* self, double nodata, double undetect)
+{
+  RaveData2D_t *field = NULL, *result = NULL;
+  unsigned char* seen = NULL;
+  double *out = NULL, *zprev = NULL, *zcur = NULL;
+  PolarCubeCache *zcache = NULL, *mcache = NULL;
+  long n = 0, e = 0, i = 0, r = 0, b = 0;
+
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  field = PolarCubeInternal_createResult(self, nodata, &out);
+  if (field == NULL || out == NULL) {
+    goto done;
+  }
+  n = self->nrays * self->nbins;
+  seen = RAVE_CALLOC(n, sizeof(unsigned char));
+  zprev = RAVE_MALLOC(n * sizeof(double));
+  zcur = RAVE_MALLOC(n * sizeof(double));
+  zcache = RAVE_MALLOC(sizeof(PolarCubeCache));
+  mcache = RAVE_MALLOC(sizeof(PolarCubeCache));
+  if (seen == NULL || zprev == NULL || zcur == NULL || zcache == NULL || mcache == NULL) {
+    goto done;
+  }
+  PolarCubeInternal_clearCache(zcache);
+  PolarCubeInternal_clearCache(mcache);
+
+  /* Reflectivity factor per plane, undetect gives 0 and nodata is marked with a negative value. Hail is capped. */
+  for (e = 0; e < self->nelevs; e++) {
+    const double* v = self->values + e * n;
+    const unsigned char* t = self->types + e * n;
+    double* tmp = NULL;
+    for (i = 0; i < n; i++) {
+      double dbz = (v[i] > POLARCUBE_VIL_MAX_DBZ) ? POLARCUBE_VIL_MAX_DBZ : v[i];
+      zcur[i] = (t[i] == RaveValueType_DATA) ? PolarCubeInternal_dbzToZ(zcache, dbz) : ((t[i] == RaveValueType_UNDETECT) ? 0.0 : -1.0);
+      seen[i] |= (unsigned char)(((t[i] == RaveValueType_DATA) ? (POLARCUBE_SEEN_DATA | POLARCUBE_SEEN_FOUND) : 0) |
+                                 ((t[i] == RaveValueType_UNDETECT) ? POLARCUBE_SEEN_UNDETECT : 0));
+    }
+    if (e == 0) {
+      for (i = 0; i < n; i++) {
+        out[i] = 0.0;
+      }
+    } else {
+      const double* h0 = self->heights + (e - 1) * self->nbins;
+      const double* h1 = self->heights + e * self->nbins;
+      for (r = 0; r < self->nrays; r++) {
+        const double* z0 = zprev + r * self->nbins;
+        const double* z1 = zcur + r * self->nbins;
+        double* o = out + r * self->nbins;
+        for (b = 0; b < self->nbins; b++) {
+          double zm = (z0[b] + z1[b]) / 2.0;
+          if (z0[b] >= 0.0 && z1[b] >= 0.0 && zm > 0.0) {
+            o[b] += PolarCubeInternal_zToM(mcache, zm) * fabs(h1[b] - h0[b]);
+          }
+        }
+      }
+    }
+    tmp = zprev;
+    zprev = zcur;
+    zcur = tmp;
+  }
+  PolarCubeInternal_finish(out, seen, n, nodata, undetect);
+  result = RAVE_OBJECT_COPY(field);
+done:
+  RAVE_FREE(seen);
+  RAVE_FREE(zprev);
+  RAVE_FREE(zcur);
+  RAVE_FREE(zcache);
+  RAVE_FREE(mcache);
+  RAVE_OBJECT_RELEASE(field);
+  return result;
+}
+
+RaveData2D_t* PolarCube_lowest(PolarCube_t* self, double nodata, double undetect, RaveData2D_t** heights)
+{
+  RaveData2D_t *field = NULL, *hfield = NULL, *result = NULL;
+  unsigned char* seen = NULL;
+  double *out = NULL, *hout = NULL;
+  long n = 0, e = 0, i = 0, r = 0, b = 0;
+
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  field = PolarCubeInternal_createResult(self, nodata, &out);
+  if (field == NULL || out == NULL) {
+    goto done;
+  }
+  if (heights != NULL) {
+    hfield = PolarCubeInternal_createResult(self, nodata, &hout);
+    if (hfield == NULL || hout == NULL) {
+      goto done;
+    }
+  }
+  n = self->nrays * self->nbins;
+  seen = RAVE_CALLOC(n, sizeof(unsigned char));
+  if (seen == NULL) {
+    goto done;
+  }
+
+  /* From the top and down so that the lowest valid value is the one that remains */
+  for (e = self->nelevs - 1; e >= 0; e--) {
+    const double* h = self->heights + e * self->nbins;
+    for (r = 0; r < self->nrays; r++) {
+      const double* v = self->values + (e * self->nrays + r) * self->nbins;
+      const unsigned char* t = self->types + (e * self->nrays + r) * self->nbins;
+      double* o = out + r * self->nbins;
+      unsigned char* s = seen + r * self->nbins;
+      for (b = 0; b < self->nbins; b++) {
+        int isdata = (t[b] == RaveValueType_DATA);
+        int isundetect = (t[b] == RaveValueType_UNDETECT);
+        o[b] = isdata ? v[b] : (isundetect ? undetect : o[b]);
+        s[b] = (isdata || isundetect) ? (unsigned char)(POLARCUBE_SEEN_FOUND | (isdata ? POLARCUBE_SEEN_DATA : POLARCUBE_SEEN_UNDETECT)) : s[b];
+      }
+      if (hout != NULL) {
+        double* ho = hout + r * self->nbins;
+        for (b = 0; b < self->nbins; b++) {
+          ho[b] = (t[b] == RaveValueType_DATA || t[b] == RaveValueType_UNDETECT) ? h[b] : ho[b];
+        }
+      }
+    }
+  }
+  PolarCubeInternal_finish(out, seen, n, nodata, undetect);
+  if (hout != NULL) {
+    for (i = 0; i < n; i++) {
+      if (!(seen[i] & POLARCUBE_SEEN_FOUND)) {
+        hout[i] = nodata;
+      }
+    }
+    *heights = RAVE_OBJECT_COPY(hfield);
+  }
+  result = RAVE_OBJECT_COPY(field);
+done:
+  RAVE_FREE(seen);
+  RAVE_OBJECT_RELEASE(field);
+  RAVE_OBJECT_RELEASE(hfield);
+  return result;
+}
+/*@} End of Interface functions */
+
+RaveCoreObjectType PolarCube_TYPE = {
+    "PolarCube",
+    sizeof(PolarCube_t),
+    PolarCube_constructor,
+    PolarCube_destructor,
+    PolarCube_copyconstructor
+};
@@ -0,0 +1,239 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of RAVE.
+
+RAVE is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RAVE is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+/**
+ * A contiguous elevation x ray x bin cube with the decoded values of one quantity in a polar volume.
+ *
+ * All scans are resampled onto the same rays and onto bins at the same surface distance from the radar so
+ * that index (ray, bin) is the same vertical column in every elevation. The elevations are in ascending
+ * order and for each elevation the slant range and the height above sea level of every bin is kept.
+ * The vertical kernels (max, echo top, VIL and lowest valid value) then only walk flat arrays instead of
+ * going through scans, parameters and value accessors.
+ *
+ * Created with \ref PolarVolume_getCube.
+ * @file
+ * @date 2026-10-17
+ */
+#ifndef POLARCUBE_H
+#define POLARCUBE_H
+#include "rave_object.h"
+#include "rave_types.h"
+#include "rave_data2d.h"
+#include "polarnav.h"
+
+/**
+ * Defines a polar cube
+ */
+typedef struct _PolarCube_t PolarCube_t;
+
+/**
+ * Type definition to use when creating a rave object.
+ */
+extern RaveCoreObjectType PolarCube_TYPE;
+
+/**
+ * Allocates the cube. Any previous content is removed and all values are set to nodata.
+ * @param[in] self - self
+ * @param[in] nelevs - number of elevations
+ * @param[in] nrays - number of rays
+ * @param[in] nbins - number of bins
+ * @param[in] dscale - the surface distance between two bins in meters
+ * @return 1 on success otherwise 0
+ */
+int PolarCube_init(PolarCube_t* self, long nelevs, long nrays, long nbins, double dscale);
+
+/**
+ * Sets the quantity.
+ * @param[in] self - self
+ * @param[in] quantity - the quantity
+ * @return 1 on success otherwise 0
+ */
+int PolarCube_setQuantity(PolarCube_t* self, const char* quantity);
+
+/**
+ * @param[in] self - self
+ * @return the quantity (may be NULL)
+ */
+const char* PolarCube_getQuantity(PolarCube_t* self);
+
+/**
+ * @param[in] self - self
+ * @return the number of elevations
+ */
+long PolarCube_getNumberOfElevations(PolarCube_t* self);
+
+/**
+ * @param[in] self - self
+ * @return the number of rays
+ */
+long PolarCube_getNrays(PolarCube_t* self);
+
+/**
+ * @param[in] self - self
+ * @return the number of bins
+ */
+long PolarCube_getNbins(PolarCube_t* self);
+
+/**
+ * @param[in] self - self
+ * @return the surface distance between two bins in meters. Bin b is centered at (b + 0.5) * dscale.
+ */
+double PolarCube_getDscale(PolarCube_t* self);
+
+/**
+ * Sets the navigator that describes the location of the radar. The cube keeps a reference to the navigator.
+ * @param[in] self - self
+ * @param[in] navigator - the navigator (MAY NOT BE NULL)
+ */
+void PolarCube_setNavigator(PolarCube_t* self, PolarNavigator_t* navigator);
+
+/**
+ * @param[in] self - self
+ * @return the navigator
+ */
+PolarNavigator_t* PolarCube_getNavigator(PolarCube_t* self);
+
+/**
+ * Locates the column that a surface position falls in. Ray i is centered at azimuth i * 2PI / nrays and
+ * bin b covers surface distances [b * dscale, (b + 1) * dscale).
+ * @param[in] self - self
+ * @param[in] lon - the longitude in radians
+ * @param[in] lat - the latitude in radians
+ * @param[out] ri - the ray index
+ * @param[out] bi - the bin index
+ * @return 1 if the position is covered by the cube, otherwise 0
+ */
+int PolarCube_getColumn(PolarCube_t* self, double lon, double lat, long* ri, long* bi);
+
+/**
+ * Sets the elevation angle of an elevation.
+ * @param[in] self - self
+ * @param[in] ei - the elevation index
+ * @param[in] elangle - the elevation angle in radians
+ * @return 1 on success otherwise 0
+ */
+int PolarCube_setElangle(PolarCube_t* self, long ei, double elangle);
+
+/**
+ * @param[in] self - self
+ * @param[in] ei - the elevation index
+ * @return the elevation angle in radians
+ */
+double PolarCube_getElangle(PolarCube_t* self, long ei);
+
+/**
+ * Returns the slant range for each bin in an elevation. The array is owned by the cube.
+ * @param[in] self - self
+ * @param[in] ei - the elevation index
+ * @return an array of nbins ranges in meters or NULL if ei is out of bounds
+ */
+double* PolarCube_getRanges(PolarCube_t* self, long ei);
+
+/**
+ * Returns the height above sea level for each bin in an elevation. The array is owned by the cube.
+ * @param[in] self - self
+ * @param[in] ei - the elevation index
+ * @return an array of nbins heights in meters or NULL if ei is out of bounds
+ */
+double* PolarCube_getHeights(PolarCube_t* self, long ei);
+
+/**
+ * Returns the decoded values, nrays * nbins per elevation with the bins varying fastest. The array is owned by the cube.
+ * @param[in] self - self
+ * @return the values
+ */
+double* PolarCube_getValues(PolarCube_t* self);
+
+/**
+ * Returns the value types (\ref RaveValueType) for the values. The array is owned by the cube.
+ * @param[in] self - self
+ * @return the types
+ */
+unsigned char* PolarCube_getTypes(PolarCube_t* self);
+
+/**
+ * Returns the decoded value at the specified position.
+ * @param[in] self - self
+ * @param[in] ei - the elevation index
+ * @param[in] ri - the ray index
+ * @param[in] bi - the bin index
+ * @param[out] v - the value (may be NULL)
+ * @return the value type, RaveValueType_UNDEFINED if out of bounds
+ */
+RaveValueType PolarCube_getValue(PolarCube_t* self, long ei, long ri, long bi, double* v);
+
+/**
+ * Sets the value at the specified position.
+ * @param[in] self - self
+ * @param[in] ei - the elevation index
+ * @param[in] ri - the ray index
+ * @param[in] bi - the bin index
+ * @param[in] type - the value type
+ * @param[in] v - the decoded value
+ * @return 1 on success or 0 if out of bounds
+ */
+int PolarCube_setValue(PolarCube_t* self, long ei, long ri, long bi, RaveValueType type, double v);
+
+/**
+ * The maximum value in each column. Columns without data but with undetect get undetect and columns
+ * with neither get nodata.
+ * @param[in] self - self
+ * @param[in] nodata - the nodata value in the result
+ * @param[in] undetect - the undetect value in the result
+ * @return a double field with xsize = nbins and ysize = nrays or NULL on failure
+ */
+RaveData2D_t* PolarCube_max(PolarCube_t* self, double nodata, double undetect);
+
+/**
+ * The echo top, i.e. the height above sea level of the highest bin in each column with a value >= threshold.
+ * Columns where no value reaches the threshold get undetect if there is any data or undetect in the column,
+ * otherwise nodata.
+ * @param[in] self - self
+ * @param[in] threshold - the threshold, e.g. 20 dBZ
+ * @param[in] nodata - the nodata value in the result
+ * @param[in] undetect - the undetect value in the result
+ * @return a double field with xsize = nbins and ysize = nrays or NULL on failure
+ */
+RaveData2D_t* PolarCube_echoTop(PolarCube_t* self, double threshold, double nodata, double undetect);
+
+/**
+ * The vertically integrated liquid water content (kg/m2) of each column, assuming that the cube contains
+ * reflectivity in dBZ. Each pair of consecutive elevations contributes 3.44e-6 * ((Z1 + Z2) / 2)^(4/7) * dh
+ * where Z is the reflectivity factor in mm6/m3 and dh the height difference in meters. Reflectivity above 56 dBZ
+ * is assumed to be hail and is capped at 56 dBZ. Undetect counts as no
+ * reflectivity and a pair with nodata does not contribute. Columns without any data get undetect if there is
+ * undetect in the column, otherwise nodata.
+ * @param[in] self - self
+ * @param[in] nodata - the nodata value in the result
+ * @param[in] undetect - the undetect value in the result
+ * @return a double field with xsize = nbins and ysize = nrays or NULL on failure
+ */
+RaveData2D_t* PolarCube_vil(PolarCube_t* self, double nodata, double undetect);
+
+/**
+ * The value from the lowest elevation in each column that is not nodata. If that is undetect the result is undetect
+ * and if all elevations are nodata the result is nodata.
+ * @param[in] self - self
+ * @param[in] nodata - the nodata value in the result
+ * @param[in] undetect - the undetect value in the result
+ * @param[out] heights - if not NULL, a double field with the height above sea level of the selected bins (nodata if none)
+ * @return a double field with xsize = nbins and ysize = nrays or NULL on failure
+ */
+RaveData2D_t* PolarCube_lowest(PolarCube_t* self, double nodata, double undetect, RaveData2D_t** heights);
+
+#endif /* POLARCUBE_H */
@@ -33,6 +33,7 @@ along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
 #include "raveobject_hashtable.h"
 #include "rave_utilities.h"
 #include "rave_attribute_table.h"
+#include "rave_hlhdf_utilities.h"
 #include <float.h>
 
 /**
@@ -86,16 +87,21 @@ error:
 static RaveData2D_t* PolarScanParamInternal_ensureData2D(PolarScanParam_t* scanparam)
 {
   if (scanparam->lazyDataset != NULL) {
-    RaveData2D_t* loaded = LazyDataset_get(scanparam->lazyDataset);
-    if (loaded != NULL) {
-      RAVE_DEBUG0("PolarScanParamInternal_ensureData2D: LazyDataset fetched");
-      RAVE_OBJECT_RELEASE(scanparam->data);
-      scanparam->data = RAVE_OBJECT_COPY(loaded);
-      RAVE_OBJECT_RELEASE(scanparam->lazyDataset);
-    } else {
-      RAVE_ERROR0("Failed to load dataset");
+    /* Lazy loading is serialized so that threads sharing this parameter will not load it twice */
+    RaveHL_lock();
+    if (scanparam->lazyDataset != NULL) {
+      RaveData2D_t* loaded = LazyDataset_get(scanparam->lazyDataset);
+      if (loaded != NULL) {
+        RAVE_DEBUG0("PolarScanParamInternal_ensureData2D: LazyDataset fetched");
+        RAVE_OBJECT_RELEASE(scanparam->data);
+        scanparam->data = RAVE_OBJECT_COPY(loaded);
+        RAVE_OBJECT_RELEASE(scanparam->lazyDataset);
+      } else {
+        RAVE_ERROR0("Failed to load dataset");
+      }
+      RAVE_OBJECT_RELEASE(loaded);
     }
-    RAVE_OBJECT_RELEASE(loaded);
+    RaveHL_unlock();
   }
   return scanparam->data;
 }
@@ -234,7 +240,7 @@ int PolarScanParam_setData(PolarScanParam_t* scanparam, long nbins, long nrays,
 int PolarScanParam_setLazyDataset(PolarScanParam_t* scanparam, LazyDataset_t* lazyDataset)
 {
   RAVE_ASSERT((scanparam != NULL), "scanparam == NULL");
-  if (RaveData2D_getData(scanparam->data) == NULL) {
+  if (RaveData2D_getReadOnlyData(scanparam->data) == NULL) {
     scanparam->lazyDataset = RAVE_OBJECT_COPY(lazyDataset);
     return 1;
   } else {
@@ -278,6 +284,12 @@ void* PolarScanParam_getData(PolarScanParam_t* scanparam)
   return RaveData2D_getData(PolarScanParamInternal_ensureData2D(scanparam));
 }
 
+const void* PolarScanParam_getReadOnlyData(PolarScanParam_t* scanparam)
+{
+  RAVE_ASSERT((scanparam != NULL), "scanparam == NULL");
+  return RaveData2D_getReadOnlyData(PolarScanParamInternal_ensureData2D(scanparam));
+}
+
 RaveData2D_t* PolarScanParam_getData2D(PolarScanParam_t* scanparam)
 {
   RaveData2D_t* result = NULL;
@@ -292,29 +304,44 @@ RaveData2D_t* PolarScanParam_getData2D(PolarScanParam_t* scanparam)
 
 long PolarScanParam_getNbins(PolarScanParam_t* scanparam)
 {
+  long result = 0;
   RAVE_ASSERT((scanparam != NULL), "scanparam == NULL");
+  RaveHL_lock(); /* a concurrent lazy load releases the lazy dataset under this lock */
   if (scanparam->lazyDataset != NULL) {
-    return LazyDataset_getXsize(scanparam->lazyDataset);
+    result = LazyDataset_getXsize(scanparam->lazyDataset);
+  } else {
+    result = RaveData2D_getXsize(scanparam->data);
   }
-  return RaveData2D_getXsize(scanparam->data);
+  RaveHL_unlock();
+  return result;
 }
 
 long PolarScanParam_getNrays(PolarScanParam_t* scanparam)
 {
+  long result = 0;
   RAVE_ASSERT((scanparam != NULL), "scanparam == NULL");
+  RaveHL_lock(); /* a concurrent lazy load releases the lazy dataset under this lock */
   if (scanparam->lazyDataset != NULL) {
-    return LazyDataset_getYsize(scanparam->lazyDataset);
+    result = LazyDataset_getYsize(scanparam->lazyDataset);
+  } else {
+    result = RaveData2D_getYsize(scanparam->data);
   }
-  return RaveData2D_getYsize(scanparam->data);
+  RaveHL_unlock();
+  return result;
 }
 
 RaveDataType PolarScanParam_getDataType(PolarScanParam_t* scanparam)
 {
+  RaveDataType result = RaveDataType_UNDEFINED;
   RAVE_ASSERT((scanparam != NULL), "scanparam == NULL");
+  RaveHL_lock(); /* a concurrent lazy load releases the lazy dataset under this lock */
   if (scanparam->lazyDataset != NULL) {
-    return LazyDataset_getDataType(scanparam->lazyDataset);
+    result = LazyDataset_getDataType(scanparam->lazyDataset);
+  } else {
+    result = RaveData2D_getType(scanparam->data);
   }
-  return RaveData2D_getType(scanparam->data);
+  RaveHL_unlock();
+  return result;
 }
 
 RaveValueType PolarScanParam_getValue(PolarScanParam_t* scanparam, int bin, int ray, double* v)
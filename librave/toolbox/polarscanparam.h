@@ -153,12 +153,21 @@ int PolarScanParam_setData2D(PolarScanParam_t* scanparam, RaveData2D_t* data2d);
 int PolarScanParam_createData(PolarScanParam_t* scanparam, long nbins, long nrays, RaveDataType type);
 
 /**
- * Returns a pointer to the internal data storage.
+ * Returns a pointer to the internal data storage. If the data is shared with a clone
+ * it is copied first since the caller may modify it.
  * @param[in] scanparam - self
  * @return the internal data pointer (NOTE! Do not release this pointer)
  */
 void* PolarScanParam_getData(PolarScanParam_t* scanparam);
 
+/**
+ * Returns a pointer to the internal data storage that must not be modified. A data
+ * array that is shared with a clone is not copied.
+ * @param[in] scanparam - self
+ * @return the internal data pointer (NOTE! Do not release this pointer)
+ */
+const void* PolarScanParam_getReadOnlyData(PolarScanParam_t* scanparam);
+
 /**
  * Returns a copy of the internal 2d data field.
  * @param[in] scanparam - self
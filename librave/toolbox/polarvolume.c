@@ -901,6 +901,110 @@ RaveValueType PolarVolume_getNearestConvertedParameterValue(PolarVolume_t* pvol,
   return result;
 }
 
+/**
+ * The parameter and quality field of one scan used by \ref PolarVolume_getNearestValuesAtLonLats.
+ */
+typedef struct PolarVolumeScanLookup_t {
+  int initialized;           /**< if the lookup has been done */
+  PolarScanParam_t* param;   /**< the parameter */
+  RaveField_t* quality;      /**< the quality field */
+  double qgain;              /**< quality gain */
+  double qoffset;            /**< quality offset */
+} PolarVolumeScanLookup_t;
+
+/**
+ * Looks up the parameter and quality field for the scan at index ei.
+ */
+static void PolarVolumeInternal_initScanLookup(PolarVolume_t* pvol, int ei, const char* quantity, const char* qualityname, PolarVolumeScanLookup_t* lookup)
+{
+  PolarScan_t* scan = PolarVolume_getScan(pvol, ei);
+  lookup->initialized = 1;
+  lookup->qgain = 1.0;
+  lookup->qoffset = 0.0;
+  if (scan != NULL) {
+    lookup->param = PolarScan_getParameter(scan, quantity);
+    if (qualityname != NULL) {
+      if (lookup->param != NULL) {
+        lookup->quality = PolarScanParam_getQualityFieldByHowTask(lookup->param, qualityname);
+      }
+      if (lookup->quality == NULL) {
+        lookup->quality = PolarScan_getQualityFieldByHowTask(scan, qualityname);
+      }
+      if (lookup->quality != NULL) {
+        RaveAttribute_t* attr = RaveField_getAttribute(lookup->quality, "what/gain");
+        if (attr != NULL) {
+          RaveAttribute_getDouble(attr, &lookup->qgain);
+        }
+        RAVE_OBJECT_RELEASE(attr);
+        attr = RaveField_getAttribute(lookup->quality, "what/offset");
+        if (attr != NULL) {
+          RaveAttribute_getDouble(attr, &lookup->qoffset);
+        }
+        RAVE_OBJECT_RELEASE(attr);
+      }
+    }
+  }
+  RAVE_OBJECT_RELEASE(scan);
+}
+
+int PolarVolume_getNearestValuesAtLonLats(PolarVolume_t* pvol, const char* quantity, long n, const double* lon, const double* lat,
+  double height, int insidee, double* values, RaveValueType* types, const char* qualityname, double* qualities)
+{
+  PolarVolumeScanLookup_t* lookups = NULL;
+  int nscans = 0, ei = 0;
+  long i = 0;
+
+  RAVE_ASSERT((pvol != NULL), "pvol == NULL");
+  RAVE_ASSERT((quantity != NULL), "quantity == NULL");
+  RAVE_ASSERT((lon != NULL && lat != NULL), "lon or lat == NULL");
+  RAVE_ASSERT((values != NULL && types != NULL), "values or types == NULL");
+
+  nscans = RaveObjectList_size(pvol->scans);
+  lookups = RAVE_MALLOC(sizeof(PolarVolumeScanLookup_t) * (nscans > 0 ? nscans : 1));
+  if (lookups == NULL) {
+    RAVE_ERROR0("Failed to allocate memory for scan lookups");
+    return 0;
+  }
+  memset(lookups, 0, sizeof(PolarVolumeScanLookup_t) * (nscans > 0 ? nscans : 1));
+
+  for (i = 0; i < n; i++) {
+    PolarNavigationInfo info;
+    PolarVolumeScanLookup_t* lookup = NULL;
+    double qv = 0.0;
+
+    values[i] = 0.0;
+    types[i] = RaveValueType_NODATA;
+    if (qualities != NULL) {
+      qualities[i] = NAN;
+    }
+    info.ei = -1;
+    info.ri = -1;
+    info.ai = -1;
+    if (!PolarVolume_getNearestNavigationInfo(pvol, lon[i], lat[i], height, insidee, &info) || info.ei >= nscans) {
+      continue;
+    }
+    lookup = &lookups[info.ei];
+    if (!lookup->initialized) {
+      PolarVolumeInternal_initScanLookup(pvol, info.ei, quantity, qualities != NULL ? qualityname : NULL, lookup);
+    }
+    if (lookup->param == NULL) {
+      types[i] = RaveValueType_UNDEFINED;
+      continue;
+    }
+    types[i] = PolarScanParam_getConvertedValue(lookup->param, info.ri, info.ai, &values[i]);
+    if (lookup->quality != NULL && RaveField_getValue(lookup->quality, info.ri, info.ai, &qv)) {
+      qualities[i] = qv * lookup->qgain + lookup->qoffset;
+    }
+  }
+
+  for (ei = 0; ei < nscans; ei++) {
+    RAVE_OBJECT_RELEASE(lookups[ei].param);
+    RAVE_OBJECT_RELEASE(lookups[ei].quality);
+  }
+  RAVE_FREE(lookups);
+  return 1;
+}
+
 int PolarVolume_getQualityValueAt(PolarVolume_t* pvol, const char* quantity, int ei, int ri, int ai, const char* name, int convert, double* v)
 {
   int result = 0;
@@ -1358,6 +1462,148 @@ int PolarVolume_removeParametersExcept(PolarVolume_t* self, RaveList_t* paramete
 }
 
 
+PolarCube_t* PolarVolume_getCube(PolarVolume_t* self, const char* quantity, long nrays, long nbins)
+{
+  PolarCube_t *cube = NULL, *result = NULL;
+  PolarNavigator_t* navigator = NULL;
+  PolarScan_t** scans = NULL;
+  int* rayindex = NULL;
+  int* binindex = NULL;
+  int nscans = 0, nelevs = 0, i = 0, j = 0;
+  double dmax = 0.0, dscale = 0.0;
+  long ei = 0, a = 0, b = 0;
+
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  RAVE_ASSERT((quantity != NULL), "quantity == NULL");
+
+  nscans = RaveObjectList_size(self->scans);
+  scans = RAVE_CALLOC((nscans > 0 ? nscans : 1), sizeof(PolarScan_t*));
+  if (scans == NULL) {
+    RAVE_ERROR0("Failed to allocate memory for scans");
+    goto done;
+  }
+
+  /* The scans with the quantity in ascending elevation order */
+  for (i = 0; i < nscans; i++) {
+    PolarScan_t* scan = (PolarScan_t*)RaveObjectList_get(self->scans, i);
+    if (scan != NULL && PolarScan_hasParameter(scan, quantity) && PolarScan_getNrays(scan) > 0 && PolarScan_getNbins(scan) > 0) {
+      for (j = nelevs; j > 0 && PolarScan_getElangle(scans[j - 1]) > PolarScan_getElangle(scan); j--) {
+        scans[j] = scans[j - 1];
+      }
+      scans[j] = RAVE_OBJECT_COPY(scan);
+      nelevs++;
+    }
+    RAVE_OBJECT_RELEASE(scan);
+  }
+  if (nelevs == 0) {
+    RAVE_ERROR1("No scans with quantity %s", quantity);
+    goto done;
+  }
+
+  for (i = 0; i < nelevs; i++) {
+    double d = 0.0, h = 0.0;
+    double r = PolarScan_getRstart(scans[i]) * 1000.0 + PolarScan_getNbins(scans[i]) * PolarScan_getRscale(scans[i]);
+    PolarNavigator_reToDh(self->navigator, r, PolarScan_getElangle(scans[i]), &d, &h);
+    dmax = (d > dmax) ? d : dmax;
+  }
+
+  /* Use the largest number of rays / bins in the volume if not specified */
+  if (nrays <= 0) {
+    for (i = 0; i < nelevs; i++) {
+      nrays = (PolarScan_getNrays(scans[i]) > nrays) ? PolarScan_getNrays(scans[i]) : nrays;
+    }
+  }
+  if (nbins <= 0) {
+    for (i = 0; i < nelevs; i++) {
+      nbins = (PolarScan_getNbins(scans[i]) > nbins) ? PolarScan_getNbins(scans[i]) : nbins;
+    }
+  }
+  dscale = dmax / (double)nbins;
+
+  rayindex = RAVE_MALLOC(sizeof(int) * nrays);
+  binindex = RAVE_MALLOC(sizeof(int) * nbins);
+  cube = RAVE_OBJECT_NEW(&PolarCube_TYPE);
+  navigator = RAVE_OBJECT_CLONE(self->navigator);
+  if (rayindex == NULL || binindex == NULL || cube == NULL || navigator == NULL ||
+      !PolarCube_init(cube, nelevs, nrays, nbins, dscale) || !PolarCube_setQuantity(cube, quantity)) {
+    RAVE_ERROR0("Failed to create cube");
+    goto done;
+  }
+  PolarCube_setNavigator(cube, navigator);
+
+  for (ei = 0; ei < nelevs; ei++) {
+    PolarScan_t* scan = scans[ei];
+    PolarScanParam_t* param = PolarScan_getParameter(scan, quantity);
+    RaveData2D_t* data = (param != NULL) ? PolarScanParam_getData2D(param) : NULL;
+    double elangle = PolarScan_getElangle(scan);
+    double* ranges = PolarCube_getRanges(cube, ei);
+    double* heights = PolarCube_getHeights(cube, ei);
+    double* values = PolarCube_getValues(cube) + ei * nrays * nbins;
+    unsigned char* types = PolarCube_getTypes(cube) + ei * nrays * nbins;
+    double gain = 0.0, offset = 0.0, nodata = 0.0, undetect = 0.0;
+
+    if (data == NULL) {
+      RAVE_ERROR1("Failed to get data for %s", quantity);
+      RAVE_OBJECT_RELEASE(param);
+      goto done;
+    }
+    gain = PolarScanParam_getGain(param);
+    offset = PolarScanParam_getOffset(param);
+    nodata = PolarScanParam_getNodata(param);
+    undetect = PolarScanParam_getUndetect(param);
+
+    PolarCube_setElangle(cube, ei, elangle);
+    for (b = 0; b < nbins; b++) {
+      PolarNavigator_deToRh(self->navigator, ((double)b + 0.5) * dscale, elangle, &ranges[b], &heights[b]);
+      binindex[b] = PolarScan_getRangeIndex(scan, ranges[b], PolarScanSelectionMethod_FLOOR, 0);
+    }
+    for (a = 0; a < nrays; a++) {
+      rayindex[a] = PolarScan_getAzimuthIndex(scan, (double)a * 2.0 * M_PI / (double)nrays, PolarScanSelectionMethod_ROUND);
+    }
+
+    for (a = 0; a < nrays; a++) {
+      double* v = values + a * nbins;
+      unsigned char* t = types + a * nbins;
+      if (rayindex[a] < 0) {
+        continue; /* Already nodata */
+      }
+      for (b = 0; b < nbins; b++) {
+        double value = 0.0;
+        if (binindex[b] < 0) {
+          continue;
+        }
+        RaveData2D_getValueUnchecked(data, binindex[b], rayindex[a], &value);
+        if (value == nodata) {
+          t[b] = (unsigned char)RaveValueType_NODATA;
+          v[b] = 0.0;
+        } else if (value == undetect) {
+          t[b] = (unsigned char)RaveValueType_UNDETECT;
+          v[b] = 0.0;
+        } else {
+          t[b] = (unsigned char)RaveValueType_DATA;
+          v[b] = offset + value * gain;
+        }
+      }
+    }
+    RAVE_OBJECT_RELEASE(data);
+    RAVE_OBJECT_RELEASE(param);
+  }
+
+  result = RAVE_OBJECT_COPY(cube);
+done:
+  if (scans != NULL) {
+    for (i = 0; i < nelevs; i++) {
+      RAVE_OBJECT_RELEASE(scans[i]);
+    }
+    RAVE_FREE(scans);
+  }
+  RAVE_FREE(rayindex);
+  RAVE_FREE(binindex);
+  RAVE_OBJECT_RELEASE(navigator);
+  RAVE_OBJECT_RELEASE(cube);
+  return result;
+}
+
 /*@} End of Interface functions */
 RaveCoreObjectType PolarVolume_TYPE = {
     "PolarVolume",
@@ -30,6 +30,7 @@ along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
 #include "projection.h"
 #include "rave_object.h"
 #include "raveobject_list.h"
+#include "polarcube.h"
 
 /**
  * Defines a Polar Volume
@@ -397,6 +398,42 @@ void PolarVolume_addEiForNavInfos(
  */
 RaveValueType PolarVolume_getNearestConvertedParameterValue(PolarVolume_t* pvol, const char* quantity, double lon, double lat, double height, int insidee, double* v, PolarNavigationInfo* navinfo);
 
+/**
+ * Fetches the nearest converted parameter values and optionally the converted quality values for a number of
+ * lon/lat positions at the same height. Gives the same values as \ref PolarVolume_getNearestConvertedParameterValue
+ * for each position, but the parameter and quality field of each scan and the gain and offset of the quality field
+ * are only looked up once.
+ * @param[in] pvol - self (MAY NOT BE NULL)
+ * @param[in] quantity - the parameter (MAY NOT BE NULL)
+ * @param[in] n - the number of positions
+ * @param[in] lon - the longitudes (in radians), n items
+ * @param[in] lat - the latitudes (in radians), n items
+ * @param[in] height - the height
+ * @param[in] insidee - if the estimated elevation must be within the min-max elevation or not to be valid
+ * @param[out] values - the converted values, n items
+ * @param[out] types - the type of each value, n items
+ * @param[in] qualityname - the how/task of the quality field (MAY BE NULL)
+ * @param[out] qualities - the converted quality values, n items. NaN when there is no quality value (MAY BE NULL)
+ * @return 1 on success otherwise 0
+ */
+int PolarVolume_getNearestValuesAtLonLats(PolarVolume_t* pvol, const char* quantity, long n, const double* lon, const double* lat,
+  double height, int insidee, double* values, RaveValueType* types, const char* qualityname, double* qualities);
+
+/**
+ * Materializes the decoded values of a quantity as a contiguous elevation x ray x bin cube, see \ref polarcube.h.
+ * The scans that have the quantity are used in ascending elevation order. Every scan is resampled with nearest
+ * neighbour onto nrays rays, ray i at azimuth i * 360 / nrays, and onto nbins bins at the same surface distance
+ * in all elevations. The bins are spaced so that the cube reaches the largest surface distance covered by any scan.
+ * Bins outside a scan are nodata.
+ * The cube gets a copy of the navigator of the volume so that it can locate the column of a surface position.
+ * @param[in] self - self
+ * @param[in] quantity - the quantity
+ * @param[in] nrays - number of rays in the cube, if <= 0 the largest number of rays in the used scans
+ * @param[in] nbins - number of bins in the cube, if <= 0 the largest number of bins in the used scans
+ * @return the cube or NULL if no scan has the quantity or on failure
+ */
+PolarCube_t* PolarVolume_getCube(PolarVolume_t* self, const char* quantity, long nrays, long nbins);
+
 /**
  * Returns the quality value for the quality field that has a name matching the how/task attribute
  * for the specified scan.
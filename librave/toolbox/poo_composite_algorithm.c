@@ -46,6 +46,8 @@ struct _PooCompositeAlgorithm_t {
   COMPOSITE_ALGORITHM_HEAD /**< composite specifics */
 
   RaveObjectHashTable_t* sources; /**< the composite objects */
+  PolarScan_t** pooscans; /**< the poo scans indexed by the radar index in the composite, used by fillQualityRow */
+  int npooscans; /**< number of entries in pooscans */
   RaveValueType type; /**< the currents positions type */
   double pooheight; /**< the value to be used */
   double mindist; /**< the minimium distance used when going for NEAREST/HEIGHT*/
@@ -67,7 +69,10 @@ static int PooCompositeAlgorithm_constructor(RaveCoreObject* obj)
   this->reset = PooCompositeAlgorithm_reset;
   this->supportsFillQualityInformation = PooCompositeAlgorithm_supportsFillQualityInformation;
   this->fillQualityInformation = PooCompositeAlgorithm_fillQualityInformation;
+  this->fillQualityRow = PooCompositeAlgorithm_fillQualityRow;
   this->sources = NULL;
+  this->pooscans = NULL;
+  this->npooscans = 0;
   return 1;
 }
 
@@ -87,6 +92,9 @@ static int PooCompositeAlgorithm_copyconstructor(RaveCoreObject* obj, RaveCoreOb
   this->reset = src->reset;
   this->supportsFillQualityInformation = src->supportsFillQualityInformation;
   this->fillQualityInformation = src->fillQualityInformation;
+  this->fillQualityRow = src->fillQualityRow;
+  this->pooscans = NULL; /* Created when initialized */
+  this->npooscans = 0;
   this->sources = RAVE_OBJECT_CLONE(src->sources);
   if (this->sources == NULL) {
     goto error;
@@ -97,6 +105,20 @@ error:
   return 0;
 }
 
+/**
+ * Releases the poo scans indexed by radar index.
+ * @param[in] self - self
+ */
+static void PooCompositeAlgorithmInternal_releasePooScans(PooCompositeAlgorithm_t* self)
+{
+  int i = 0;
+  for (i = 0; self->pooscans != NULL && i < self->npooscans; i++) {
+    RAVE_OBJECT_RELEASE(self->pooscans[i]);
+  }
+  RAVE_FREE(self->pooscans);
+  self->npooscans = 0;
+}
+
 /**
  * Destructor
  * @param[in] obj - the object to destroy
@@ -111,6 +133,8 @@ static void PooCompositeAlgorithm_destructor(RaveCoreObject* obj)
   this->reset = NULL;
   this->supportsFillQualityInformation = NULL;
   this->fillQualityInformation = NULL;
+  this->fillQualityRow = NULL;
+  PooCompositeAlgorithmInternal_releasePooScans(this);
   RAVE_OBJECT_RELEASE(this->sources);
 }
 
@@ -172,6 +196,45 @@ done:
   RAVE_OBJECT_RELEASE(scans);
   return result;
 }
+
+/**
+ * Creates the array of poo scans indexed by the radar index in the composite.
+ * @param[in] self - self
+ * @param[in] composite - the composite
+ * @return 1 on success otherwise 0
+ */
+static int PooCompositeAlgorithmInternal_indexPooScans(PooCompositeAlgorithm_t* self, Composite_t* composite)
+{
+  int nrobjs = 0, i = 0;
+
+  PooCompositeAlgorithmInternal_releasePooScans(self);
+  nrobjs = Composite_getNumberOfObjects(composite);
+  if (nrobjs <= 0) {
+    return 1;
+  }
+  self->pooscans = RAVE_MALLOC(sizeof(PolarScan_t*) * nrobjs);
+  if (self->pooscans == NULL) {
+    RAVE_ERROR0("Failed to allocate memory for poo scans");
+    return 0;
+  }
+  memset(self->pooscans, 0, sizeof(PolarScan_t*) * nrobjs);
+  self->npooscans = nrobjs;
+
+  for (i = 0; i < nrobjs; i++) {
+    RaveCoreObject* obj = Composite_get(composite, i);
+    const char* source = NULL;
+    if (RAVE_OBJECT_CHECK_TYPE(obj, &PolarVolume_TYPE)) {
+      source = PolarVolume_getSource((PolarVolume_t*)obj);
+    } else if (RAVE_OBJECT_CHECK_TYPE(obj, &PolarScan_TYPE)) {
+      source = PolarScan_getSource((PolarScan_t*)obj);
+    }
+    if (source != NULL) {
+      self->pooscans[i] = (PolarScan_t*)RaveObjectHashTable_get(self->sources, source);
+    }
+    RAVE_OBJECT_RELEASE(obj);
+  }
+  return 1;
+}
 /*@} End of Private functions */
 
 /*@{ Interface functions */
@@ -213,6 +276,9 @@ int PooCompositeAlgorithm_initialize(CompositeAlgorithm_t* self, struct _Composi
     RAVE_ERROR0("Failed to prepare poo fields");
     goto done;
   }
+  if (!PooCompositeAlgorithmInternal_indexPooScans(this, composite)) {
+    goto done;
+  }
   this->method = Composite_getSelectionMethod(composite);
 
   result = 1;
@@ -281,6 +347,44 @@ int PooCompositeAlgorithm_fillQualityInformation(CompositeAlgorithm_t* self,
   return result;
 }
 
+int PooCompositeAlgorithm_fillQualityRow(CompositeAlgorithm_t* self, const char* howtask, const char* quantity, RaveField_t* field,
+  int y, int n, RaveCoreObject** objs, const int* radarindex, PolarNavigationInfo* navinfo, double gain, double offset)
+{
+  PooCompositeAlgorithm_t* this = (PooCompositeAlgorithm_t*)self;
+  int x = 0;
+
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  RAVE_ASSERT((field != NULL), "field == NULL");
+  RAVE_ASSERT((gain != 0.0), "gain == 0.0");
+
+  if (strcmp("se.smhi.detector.poo", howtask) != 0) {
+    return 0;
+  }
+
+  for (x = 0; x < n; x++) {
+    PolarScan_t* pooscan = NULL;
+    int ri = radarindex[x];
+    if (objs[x] == NULL) {
+      continue;
+    }
+    if (ri >= 0 && ri < this->npooscans && navinfo[x].ri >= 0 && navinfo[x].ai >= 0 &&
+        (navinfo[x].ei >= 0 || !RAVE_OBJECT_CHECK_TYPE(objs[x], &PolarVolume_TYPE))) {
+      pooscan = this->pooscans[ri];
+    }
+    if (pooscan != NULL) {
+      double v = 0.0;
+      if (PolarScan_getNearest(pooscan, navinfo[x].lon, navinfo[x].lat, 1, &v) != RaveValueType_DATA) {
+        v = 0.0;
+      }
+      RaveField_setValue(field, x, y, (v - offset) / gain);
+    } else {
+      RaveField_setValue(field, x, y, 0.0); /* Same as when the quality information can not be filled for a pixel */
+    }
+  }
+
+  return 1;
+}
+
 
 /*@} End of Interface functions */
 
@@ -105,4 +105,23 @@ int PooCompositeAlgorithm_supportsFillQualityInformation(CompositeAlgorithm_t* s
  */
 int PooCompositeAlgorithm_fillQualityInformation(CompositeAlgorithm_t* self, RaveCoreObject* obj,const char* howtask,const char* quantity,RaveField_t* field,long x, long y, PolarNavigationInfo* navinfo, double gain, double offset);
 
+/**
+ * Fills one row of the quality field for howtask values = se.smhi.detector.poo. The poo scans are
+ * looked up by the composite index of the radars so no hash lookup is performed per pixel.
+ * @param[in] self - self
+ * @param[in] howtask - the how/task value
+ * @param[in] quantity - the quantity
+ * @param[in] field - the rave quality field that should get it's values set
+ * @param[in] y - the row
+ * @param[in] n - the number of pixels in the row
+ * @param[in] objs - the selected object for each pixel or NULL
+ * @param[in] radarindex - the composite index of the selected object for each pixel or -1
+ * @param[in] navinfo - the navigation information that was used for each pixel
+ * @param[in] gain - the gain of the quality field
+ * @param[in] offset - the offset of the quality field
+ * @return 1 on success, 0 if howtask is not supported
+ */
+int PooCompositeAlgorithm_fillQualityRow(CompositeAlgorithm_t* self, const char* howtask, const char* quantity, RaveField_t* field,
+  int y, int n, RaveCoreObject** objs, const int* radarindex, PolarNavigationInfo* navinfo, double gain, double offset);
+
 #endif /* POO_COMPOSITE_ALGORITHM_H */
@@ -0,0 +1,359 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of RAVE.
+
+RAVE is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RAVE is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+/**
+ * Mapping between radar ids and the values used in the radar index quality field.
+ * @file
+ * @date 2026-10-17
+ */
+#include "radar_index_table.h"
+#include "rave_debug.h"
+#include "rave_alloc.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+
+/**
+ * An entry in the table
+ */
+typedef struct RadarIndexEntry {
+  char* id;  /**< the radar id */
+  int index; /**< the index */
+} RadarIndexEntry;
+
+/**
+ * Represents the radar index table
+ */
+struct _RadarIndexTable_t {
+  RAVE_OBJECT_HEAD /** Always on top */
+  RadarIndexEntry* entries; /**< the entries in insertion order */
+  int nentries;             /**< number of entries */
+  int capacity;             /**< allocated number of entries */
+  int* buckets;             /**< open addressed hash, position in entries or -1 */
+  int nbuckets;             /**< number of buckets, always a power of 2 */
+  long modifications;       /**< incremented whenever entries are added or removed */
+};
+
+/*@{ Private functions */
+/**
+ * FNV-1a hash of the id.
+ */
+static unsigned int RadarIndexTableInternal_hash(const char* id)
+{
+  unsigned int h = 2166136261u;
+  while (*id != '\0') {
+    h ^= (unsigned char)*id++;
+    h *= 16777619u;
+  }
+  return h;
+}
+
+/**
+ * Returns the bucket where id is or should be placed.
+ */
+static int RadarIndexTableInternal_findBucket(RadarIndexTable_t* self, const char* id)
+{
+  unsigned int mask = (unsigned int)self->nbuckets - 1;
+  unsigned int b = RadarIndexTableInternal_hash(id) & mask;
+  while (self->buckets[b] >= 0 && strcmp(self->entries[self->buckets[b]].id, id) != 0) {
+    b = (b + 1) & mask;
+  }
+  return (int)b;
+}
+
+/**
+ * Reallocates the buckets so that they are at least twice the number of entries.
+ */
+static int RadarIndexTableInternal_rehash(RadarIndexTable_t* self, int minentries)
+{
+  int nbuckets = 16, i = 0;
+  int* buckets = NULL;
+  while (nbuckets < minentries * 2) {
+    nbuckets *= 2;
+  }
+  if (nbuckets <= self->nbuckets) {
+    return 1;
+  }
+  buckets = RAVE_MALLOC(sizeof(int) * nbuckets);
+  if (buckets == NULL) {
+    RAVE_ERROR0("Failed to allocate memory for radar index buckets");
+    return 0;
+  }
+  for (i = 0; i < nbuckets; i++) {
+    buckets[i] = -1;
+  }
+  RAVE_FREE(self->buckets);
+  self->buckets = buckets;
+  self->nbuckets = nbuckets;
+  for (i = 0; i < self->nentries; i++) {
+    self->buckets[RadarIndexTableInternal_findBucket(self, self->entries[i].id)] = i;
+  }
+  return 1;
+}
+
+/**
+ * Makes sure that there is room for at least n entries.
+ */
+static int RadarIndexTableInternal_reserve(RadarIndexTable_t* self, int n)
+{
+  if (n > self->capacity) {
+    int capacity = self->capacity > 0 ? self->capacity : 16;
+    RadarIndexEntry* entries = NULL;
+    while (capacity < n) {
+      capacity *= 2;
+    }
+    entries = RAVE_REALLOC(self->entries, sizeof(RadarIndexEntry) * capacity);
+    if (entries == NULL) {
+      RAVE_ERROR0("Failed to allocate memory for radar index entries");
+      return 0;
+    }
+    self->entries = entries;
+    self->capacity = capacity;
+  }
+  return RadarIndexTableInternal_rehash(self, n);
+}
+
+static int RadarIndexTable_constructor(RaveCoreObject* obj)
+{
+  RadarIndexTable_t* this = (RadarIndexTable_t*)obj;
+  this->entries = NULL;
+  this->nentries = 0;
+  this->capacity = 0;
+  this->buckets = NULL;
+  this->nbuckets = 0;
+  this->modifications = 0;
+  return RadarIndexTableInternal_reserve(this, 1);
+}
+
+static void RadarIndexTable_destructor(RaveCoreObject* obj)
+{
+  RadarIndexTable_t* this = (RadarIndexTable_t*)obj;
+  RadarIndexTable_clear(this);
+  RAVE_FREE(this->entries);
+  RAVE_FREE(this->buckets);
+}
+
+static int RadarIndexTable_copyconstructor(RaveCoreObject* obj, RaveCoreObject* srcobj)
+{
+  RadarIndexTable_t* this = (RadarIndexTable_t*)obj;
+  RadarIndexTable_t* src = (RadarIndexTable_t*)srcobj;
+  this->entries = NULL;
+  this->nentries = 0;
+  this->capacity = 0;
+  this->buckets = NULL;
+  this->nbuckets = 0;
+  this->modifications = 0;
+  if (!RadarIndexTableInternal_reserve(this, src->nentries > 0 ? src->nentries : 1) ||
+      !RadarIndexTable_merge(this, src)) {
+    RadarIndexTable_destructor(obj);
+    return 0;
+  }
+  return 1;
+}
+/*@} End of Private functions */
+
+/*@{ Interface functions */
+int RadarIndexTable_add(RadarIndexTable_t* self, const char* id, int index)
+{
+  int b = 0;
+  char* cid = NULL;
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  if (id == NULL) {
+    RAVE_ERROR0("Can not add radar index without id");
+    return 0;
+  }
+  b = RadarIndexTableInternal_findBucket(self, id);
+  if (self->buckets[b] >= 0) {
+    return 1;
+  }
+  cid = RAVE_STRDUP(id);
+  if (cid == NULL || !RadarIndexTableInternal_reserve(self, self->nentries + 1)) {
+    RAVE_FREE(cid);
+    return 0;
+  }
+  self->entries[self->nentries].id = cid;
+  self->entries[self->nentries].index = index;
+  self->buckets[RadarIndexTableInternal_findBucket(self, cid)] = self->nentries;
+  self->nentries++;
+  self->modifications++;
+  return 1;
+}
+
+int RadarIndexTable_getIndex(RadarIndexTable_t* self, const char* id, int* index)
+{
+  int b = 0;
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  if (id == NULL) {
+    return 0;
+  }
+  b = RadarIndexTableInternal_findBucket(self, id);
+  if (self->buckets[b] < 0) {
+    return 0;
+  }
+  if (index != NULL) {
+    *index = self->entries[self->buckets[b]].index;
+  }
+  return 1;
+}
+
+int RadarIndexTable_exists(RadarIndexTable_t* self, const char* id)
+{
+  return RadarIndexTable_getIndex(self, id, NULL);
+}
+
+int RadarIndexTable_size(RadarIndexTable_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return self->nentries;
+}
+
+long RadarIndexTable_getModifications(RadarIndexTable_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return self->modifications;
+}
+
+int RadarIndexTable_getEntry(RadarIndexTable_t* self, int i, const char** id, int* index)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  if (i < 0 || i >= self->nentries) {
+    return 0;
+  }
+  if (id != NULL) {
+    *id = self->entries[i].id;
+  }
+  if (index != NULL) {
+    *index = self->entries[i].index;
+  }
+  return 1;
+}
+
+int RadarIndexTable_merge(RadarIndexTable_t* self, RadarIndexTable_t* other)
+{
+  int i = 0;
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  if (other == NULL || other == self) {
+    return 1;
+  }
+  if (!RadarIndexTableInternal_reserve(self, self->nentries + other->nentries)) {
+    return 0;
+  }
+  for (i = 0; i < other->nentries; i++) {
+    if (!RadarIndexTable_add(self, other->entries[i].id, other->entries[i].index)) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+void RadarIndexTable_clear(RadarIndexTable_t* self)
+{
+  int i = 0;
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  for (i = 0; i < self->nentries; i++) {
+    RAVE_FREE(self->entries[i].id);
+  }
+  self->nentries = 0;
+  for (i = 0; i < self->nbuckets; i++) {
+    self->buckets[i] = -1;
+  }
+  self->modifications++;
+}
+
+char* RadarIndexTable_toString(RadarIndexTable_t* self)
+{
+  size_t len = 1, pos = 0;
+  int i = 0;
+  char* result = NULL;
+  RAVE_ASSERT((self != NULL), "self == NULL");
+
+  for (i = 0; i < self->nentries; i++) {
+    len += strlen(self->entries[i].id) + 13; /* ':', at most 11 characters for an int and ',' */
+  }
+  result = RAVE_MALLOC(sizeof(char) * len);
+  if (result == NULL) {
+    RAVE_ERROR0("Failed to allocate memory for radar index string");
+    return NULL;
+  }
+  result[0] = '\0';
+  for (i = 0; i < self->nentries; i++) {
+    pos += snprintf(result + pos, len - pos, "%s%s:%d", (i > 0) ? "," : "", self->entries[i].id, self->entries[i].index);
+  }
+  return result;
+}
+
+RadarIndexTable_t* RadarIndexTable_fromString(const char* str)
+{
+  RadarIndexTable_t* result = NULL;
+  const char* p = str;
+
+  if (str == NULL) {
+    return NULL;
+  }
+  result = RAVE_OBJECT_NEW(&RadarIndexTable_TYPE);
+  if (result == NULL) {
+    return NULL;
+  }
+
+  while (*p != '\0') {
+    const char *tokend = strchr(p, ',');
+    const char *b = p, *e = NULL, *sep = NULL;
+    char* endptr = NULL;
+    char id[256];
+    long v = 0;
+    if (tokend == NULL) {
+      tokend = p + strlen(p);
+    }
+    e = tokend;
+    while (b < e && isspace((unsigned char)*b)) b++;
+    while (e > b && isspace((unsigned char)*(e-1))) e--;
+
+    if (e > b) {
+      for (sep = e - 1; sep > b && *sep != ':'; sep--);
+      if (*sep != ':' || sep == b || sep - b >= (long)sizeof(id)) {
+        RAVE_ERROR0("Could not parse radar index string");
+        goto fail;
+      }
+      memcpy(id, b, sep - b);
+      id[sep - b] = '\0';
+      v = strtol(sep + 1, &endptr, 10);
+      if (endptr != e) {
+        RAVE_ERROR0("Could not parse radar index string");
+        goto fail;
+      }
+      if (!RadarIndexTable_add(result, id, (int)v)) {
+        goto fail;
+      }
+    }
+    p = (*tokend == ',') ? tokend + 1 : tokend;
+  }
+  return result;
+fail:
+  RAVE_OBJECT_RELEASE(result);
+  return NULL;
+}
+/*@} End of Interface functions */
+
+RaveCoreObjectType RadarIndexTable_TYPE = {
+    "RadarIndexTable",
+    sizeof(RadarIndexTable_t),
+    RadarIndexTable_constructor,
+    RadarIndexTable_destructor,
+    RadarIndexTable_copyconstructor
+};
@@ -0,0 +1,122 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of RAVE.
+
+RAVE is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RAVE is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+/**
+ * Mapping between radar ids and the values used in the radar index quality field
+ * (se.smhi.composite.index.radar). The table keeps the entries in insertion order and
+ * uses a hash on the id so that tables from several tiles can be merged without
+ * parsing and concatenating the how/task_args strings. The ODIM representation,
+ * id:index separated by ',', is only created when requested.
+ * This object supports \ref #RAVE_OBJECT_CLONE.
+ * @file
+ * @date 2026-10-17
+ */
+#ifndef RADAR_INDEX_TABLE_H
+#define RADAR_INDEX_TABLE_H
+#include "rave_object.h"
+
+/**
+ * Defines a radar index table
+ */
+typedef struct _RadarIndexTable_t RadarIndexTable_t;
+
+/**
+ * Type definition to use when creating a rave object.
+ */
+extern RaveCoreObjectType RadarIndexTable_TYPE;
+
+/**
+ * Adds a radar id with its index. If the id already exists in the table the
+ * previous index is kept.
+ * @param[in] self - self
+ * @param[in] id - the radar id
+ * @param[in] index - the index
+ * @return 1 if the id was added or already existed, 0 on failure
+ */
+int RadarIndexTable_add(RadarIndexTable_t* self, const char* id, int index);
+
+/**
+ * Returns the index for the specified id.
+ * @param[in] self - self
+ * @param[in] id - the radar id
+ * @param[out] index - the index
+ * @return 1 if the id exists, otherwise 0
+ */
+int RadarIndexTable_getIndex(RadarIndexTable_t* self, const char* id, int* index);
+
+/**
+ * @param[in] self - self
+ * @param[in] id - the radar id
+ * @return 1 if the id exists, otherwise 0
+ */
+int RadarIndexTable_exists(RadarIndexTable_t* self, const char* id);
+
+/**
+ * @param[in] self - self
+ * @return the number of entries
+ */
+int RadarIndexTable_size(RadarIndexTable_t* self);
+
+/**
+ * Returns a counter that changes whenever entries are added or removed, so that users
+ * can tell if the table has changed since they last looked at it.
+ * @param[in] self - self
+ * @return the number of modifications
+ */
+long RadarIndexTable_getModifications(RadarIndexTable_t* self);
+
+/**
+ * Returns the entry at the specified position.
+ * @param[in] self - self
+ * @param[in] i - the position
+ * @param[out] id - the radar id (internal memory, may be NULL)
+ * @param[out] index - the index (may be NULL)
+ * @return 1 on success, 0 if i is out of bounds
+ */
+int RadarIndexTable_getEntry(RadarIndexTable_t* self, int i, const char** id, int* index);
+
+/**
+ * Adds all entries in other that does not already exist in self.
+ * @param[in] self - self
+ * @param[in] other - the table to merge into self
+ * @return 1 on success otherwise 0
+ */
+int RadarIndexTable_merge(RadarIndexTable_t* self, RadarIndexTable_t* other);
+
+/**
+ * Removes all entries.
+ * @param[in] self - self
+ */
+void RadarIndexTable_clear(RadarIndexTable_t* self);
+
+/**
+ * Creates the how/task_args representation, e.g. "sekkr:1,sevar:2".
+ * @param[in] self - self
+ * @return the string (caller frees) or NULL on failure
+ */
+char* RadarIndexTable_toString(RadarIndexTable_t* self);
+
+/**
+ * Creates a table from the how/task_args representation. Each token is split on the
+ * last ':' so ids containing ':' are preserved.
+ * @param[in] str - the string
+ * @return the table or NULL if the string could not be parsed
+ */
+RadarIndexTable_t* RadarIndexTable_fromString(const char* str);
+
+#endif /* RADAR_INDEX_TABLE_H */
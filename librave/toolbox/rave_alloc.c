@@ -11,6 +11,19 @@
 #include <string.h>
 #include <stdio.h>
 
+#ifdef PTHREAD_SUPPORTED
+#include <pthread.h>
+/**
+ * Protects the heap bookkeeping since the toolbox might be called from several threads at once.
+ */
+static pthread_mutex_t rave_heap_mutex = PTHREAD_MUTEX_INITIALIZER;
+#define RAVE_HEAP_LOCK pthread_mutex_lock(&rave_heap_mutex)
+#define RAVE_HEAP_UNLOCK pthread_mutex_unlock(&rave_heap_mutex)
+#else
+#define RAVE_HEAP_LOCK
+#define RAVE_HEAP_UNLOCK
+#endif
+
 /**
  * Keeps track on one allocation.
  */
@@ -199,7 +212,7 @@ static void rave_alloc_releaseMemory(const char* filename, int lineno, RaveHeap_
   }
 }
 
-void* rave_alloc_malloc(const char* filename, int lineno, size_t sz)
+static void* rave_alloc_mallocInternal(const char* filename, int lineno, size_t sz)
 {
   RaveHeapEntry_t* entry = rave_alloc_addHeapEntry(filename, lineno, sz);
   if (entry != NULL) {
@@ -213,7 +226,7 @@ void* rave_alloc_malloc(const char* filename, int lineno, size_t sz)
   }
 }
 
-void* rave_alloc_calloc(const char* filename, int lineno, size_t npts, size_t sz)
+static void* rave_alloc_callocInternal(const char* filename, int lineno, size_t npts, size_t sz)
 {
   RaveHeapEntry_t* entry = rave_alloc_addHeapEntry(filename, lineno, npts*sz);
   if (entry != NULL) {
@@ -233,12 +246,12 @@ void* rave_alloc_calloc(const char* filename, int lineno, size_t npts, size_t sz
   }
 }
 
-void* rave_alloc_realloc(const char* filename, int lineno, void* ptr, size_t sz)
+static void* rave_alloc_reallocInternal(const char* filename, int lineno, void* ptr, size_t sz)
 {
   RaveHeapEntry_t* entry = NULL;
   size_t oldsz = 0;
   if (ptr == NULL) {
-    return rave_alloc_malloc(filename, lineno, sz);
+    return rave_alloc_mallocInternal(filename, lineno, sz);
   }
   entry = rave_alloc_findPointer(ptr);
   if (entry == NULL) {
@@ -261,7 +274,7 @@ void* rave_alloc_realloc(const char* filename, int lineno, void* ptr, size_t sz)
   return entry->b;
 }
 
-char* rave_alloc_strdup(const char* filename, int lineno, const char* str)
+static char* rave_alloc_strdupInternal(const char* filename, int lineno, const char* str)
 {
   size_t len = 0;
   RaveHeapEntry_t* entry = NULL;
@@ -288,7 +301,7 @@ char* rave_alloc_strdup(const char* filename, int lineno, const char* str)
   }
 }
 
-void rave_alloc_free(const char* filename, int lineno, void* ptr)
+static void rave_alloc_freeInternal(const char* filename, int lineno, void* ptr)
 {
   RaveHeap_t* heapptr = rave_heap;
   if (heapptr == NULL) {
@@ -314,6 +327,49 @@ void rave_alloc_free(const char* filename, int lineno, void* ptr)
   Rave_printf("RAVE_MEMORY_CHECK: Atempting to free something that not has been allocated: %s:%d\n", filename, lineno);
 }
 
+void* rave_alloc_malloc(const char* filename, int lineno, size_t sz)
+{
+  void* result = NULL;
+  RAVE_HEAP_LOCK;
+  result = rave_alloc_mallocInternal(filename, lineno, sz);
+  RAVE_HEAP_UNLOCK;
+  return result;
+}
+
+void* rave_alloc_calloc(const char* filename, int lineno, size_t npts, size_t sz)
+{
+  void* result = NULL;
+  RAVE_HEAP_LOCK;
+  result = rave_alloc_callocInternal(filename, lineno, npts, sz);
+  RAVE_HEAP_UNLOCK;
+  return result;
+}
+
+void* rave_alloc_realloc(const char* filename, int lineno, void* ptr, size_t sz)
+{
+  void* result = NULL;
+  RAVE_HEAP_LOCK;
+  result = rave_alloc_reallocInternal(filename, lineno, ptr, sz);
+  RAVE_HEAP_UNLOCK;
+  return result;
+}
+
+char* rave_alloc_strdup(const char* filename, int lineno, const char* str)
+{
+  char* result = NULL;
+  RAVE_HEAP_LOCK;
+  result = rave_alloc_strdupInternal(filename, lineno, str);
+  RAVE_HEAP_UNLOCK;
+  return result;
+}
+
+void rave_alloc_free(const char* filename, int lineno, void* ptr)
+{
+  RAVE_HEAP_LOCK;
+  rave_alloc_freeInternal(filename, lineno, ptr);
+  RAVE_HEAP_UNLOCK;
+}
+
 void rave_alloc_dump_heap(void)
 {
   RaveHeap_t* heapptr = rave_heap;
@@ -0,0 +1,89 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of RAVE.
+
+RAVE is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RAVE is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+/**
+ * Converts a BUFR file into an ODIM HDF5 file. Used as worker process when
+ * decoding BUFR files in parallel, see \ref RaveBufrIO_setWorkers.
+ * @file
+ * @date 2026-10-17
+ */
+#include "rave_bufr_io.h"
+#include "rave_io.h"
+#include "rave_debug.h"
+#include "hlhdf.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Main function for the rave_bufr2odim binary.
+ * Usage: rave_bufr2odim [-t tabledir] <bufrfile> <odimfile>
+ * @return 0 on success, otherwise 1
+ */
+int main(int argc, char* argv[]) {
+  RaveBufrIO_t* bufrio = NULL;
+  RaveIO_t* raveio = NULL;
+  RaveCoreObject* object = NULL;
+  const char* tabledir = NULL;
+  int argi = 1;
+  int result = 1;
+
+  HL_init();
+  Rave_initializeDebugger();
+  Rave_setDebugLevel(RAVE_WARNING);
+
+  if (argc > 2 && strcmp(argv[1], "-t") == 0) {
+    tabledir = argv[2];
+    argi = 3;
+  }
+  if (argc - argi != 2) {
+    printf("Usage: %s [-t tabledir] <bufrfile> <odimfile>\n", argv[0]);
+    exit(1);
+  }
+
+  bufrio = RAVE_OBJECT_NEW(&RaveBufrIO_TYPE);
+  raveio = RAVE_OBJECT_NEW(&RaveIO_TYPE);
+  if (bufrio == NULL || raveio == NULL) {
+    fprintf(stderr, "Failed to allocate memory\n");
+    goto done;
+  }
+
+  if (tabledir != NULL && !RaveBufrIO_setTableDir(bufrio, tabledir)) {
+    fprintf(stderr, "Failed to set table dir %s\n", tabledir);
+    goto done;
+  }
+
+  object = RaveBufrIO_read(bufrio, argv[argi]);
+  if (object == NULL) {
+    fprintf(stderr, "Could not read %s\n", argv[argi]);
+    goto done;
+  }
+
+  RaveIO_setObject(raveio, object);
+  if (!RaveIO_save(raveio, argv[argi + 1])) {
+    fprintf(stderr, "Could not write %s\n", argv[argi + 1]);
+    goto done;
+  }
+
+  result = 0;
+done:
+  RAVE_OBJECT_RELEASE(object);
+  RAVE_OBJECT_RELEASE(raveio);
+  RAVE_OBJECT_RELEASE(bufrio);
+  exit(result);
+}
@@ -45,6 +45,10 @@ along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
 #include <zlib.h>
 #include <float.h>
 #include <ctype.h>
+#include <errno.h>
+#include <spawn.h>
+#include <sys/types.h>
+#include <sys/wait.h>
 #include "rave_config.h"
 
 /* In order to allow concurrent use we can use pthread if we are able to.
@@ -62,8 +66,31 @@ along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
 static RaveCoreObject* raveObject = NULL;
 
 #ifdef  PTHREAD_SUPPORTED
-static int bufrio_mutex_initialized = 0;
-static pthread_mutex_t bufrio_mutex;
+static pthread_mutex_t bufrio_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/**
+ * Environment passed on to the worker processes
+ */
+extern char** environ;
+
+/**
+ * The worker program used when decoding in separate processes.
+ */
+static char* bufrio_worker_program = NULL;
+
+/**
+ * Max number of concurrently running worker processes. 0 means that no workers are used.
+ */
+static int bufrio_max_workers = 0;
+
+/**
+ * Number of currently running worker processes.
+ */
+static int bufrio_active_workers = 0;
+
+#ifdef  PTHREAD_SUPPORTED
+static pthread_mutex_t bufrio_worker_mutex = PTHREAD_MUTEX_INITIALIZER;
 #endif
 
 
@@ -763,6 +790,44 @@ done:
   return result;
 }
 
+/**
+ * Reserves a worker slot if worker processes are enabled and not all of them are occupied. The check
+ * and the reservation are done under the same lock so that a concurrent \ref RaveBufrIO_setWorkers
+ * or another loader can not take the slot in between.
+ * @return a copy of the worker program that should be released by the caller or NULL if no worker is available
+ */
+static char* RaveBufrIOInternal_acquireWorker(void)
+{
+  char* result = NULL;
+#ifdef  PTHREAD_SUPPORTED
+  pthread_mutex_lock(&bufrio_worker_mutex);
+#endif
+  if (bufrio_max_workers > 0 && bufrio_active_workers < bufrio_max_workers && bufrio_worker_program != NULL) {
+    result = RAVE_STRDUP(bufrio_worker_program);
+    if (result != NULL) {
+      bufrio_active_workers++;
+    }
+  }
+#ifdef  PTHREAD_SUPPORTED
+  pthread_mutex_unlock(&bufrio_worker_mutex);
+#endif
+  return result;
+}
+
+/**
+ * Returns a worker slot that has been reserved with \ref RaveBufrIOInternal_acquireWorker.
+ */
+static void RaveBufrIOInternal_releaseWorker(void)
+{
+#ifdef  PTHREAD_SUPPORTED
+  pthread_mutex_lock(&bufrio_worker_mutex);
+#endif
+  bufrio_active_workers--;
+#ifdef  PTHREAD_SUPPORTED
+  pthread_mutex_unlock(&bufrio_worker_mutex);
+#endif
+}
+
 /*@} End of Private functions */
 
 /*@{ Interface functions */
@@ -803,10 +868,6 @@ RaveCoreObject* RaveBufrIO_read(RaveBufrIO_t* self, const char* filename)
   memset (&msg, 0, sizeof(bufr_t));
 
 #ifdef  PTHREAD_SUPPORTED
-  if (bufrio_mutex_initialized == 0) {
-    pthread_mutex_init(&bufrio_mutex, NULL);
-    bufrio_mutex_initialized = 1;
-  }
   pthread_mutex_lock(&bufrio_mutex);
 #endif
 
@@ -847,6 +908,100 @@ int RaveBufrIO_isBufr(const char* filename)
   return result;
 }
 
+int RaveBufrIO_setWorkers(const char* program, int maxworkers)
+{
+  char* tmp = NULL;
+  if (program != NULL && maxworkers > 0) {
+    tmp = RAVE_STRDUP(program);
+    if (tmp == NULL) {
+      RAVE_ERROR0("Failed to allocate memory for worker program");
+      return 0;
+    }
+  } else {
+    maxworkers = 0;
+  }
+#ifdef  PTHREAD_SUPPORTED
+  pthread_mutex_lock(&bufrio_worker_mutex);
+#endif
+  RAVE_FREE(bufrio_worker_program);
+  bufrio_worker_program = tmp;
+  bufrio_max_workers = maxworkers;
+#ifdef  PTHREAD_SUPPORTED
+  pthread_mutex_unlock(&bufrio_worker_mutex);
+#endif
+  return 1;
+}
+
+int RaveBufrIO_getMaxWorkers(void)
+{
+  int result = 0;
+#ifdef  PTHREAD_SUPPORTED
+  pthread_mutex_lock(&bufrio_worker_mutex);
+#endif
+  result = bufrio_max_workers;
+#ifdef  PTHREAD_SUPPORTED
+  pthread_mutex_unlock(&bufrio_worker_mutex);
+#endif
+  return result;
+}
+
+int RaveBufrIO_convert(RaveBufrIO_t* self, const char* filename, const char* outfile)
+{
+  char* program = NULL;
+  char* argv[6];
+  int argc = 0;
+  pid_t pid;
+  int status = 0;
+  int err = 0;
+  int result = 0;
+
+  RAVE_ASSERT((self != NULL), "self == NULL");
+
+  if (filename == NULL || outfile == NULL) {
+    RAVE_ERROR0("Must specify both input and output file");
+    return 0;
+  }
+
+  program = RaveBufrIOInternal_acquireWorker();
+  if (program == NULL) {
+    return -1;
+  }
+
+  argv[argc++] = program;
+  if (self->tabledir != NULL) {
+    argv[argc++] = "-t";
+    argv[argc++] = self->tabledir;
+  }
+  argv[argc++] = (char*)filename;
+  argv[argc++] = (char*)outfile;
+  argv[argc] = NULL;
+
+  /* posix_spawn instead of fork since we most likely are running in a threaded process */
+  err = posix_spawn(&pid, program, NULL, NULL, argv, environ);
+  if (err != 0) {
+    RAVE_ERROR2("Failed to start BUFR worker %s: %s", program, strerror(err));
+    goto done;
+  }
+
+  while (waitpid(pid, &status, 0) < 0) {
+    if (errno != EINTR) {
+      RAVE_ERROR1("Failed to wait for BUFR worker decoding %s", filename);
+      goto done;
+    }
+  }
+
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    RAVE_ERROR1("BUFR worker failed to decode %s", filename);
+    goto done;
+  }
+
+  result = 1;
+done:
+  RaveBufrIOInternal_releaseWorker();
+  RAVE_FREE(program);
+  return result;
+}
+
 /*@} End of Interface functions */
 RaveCoreObjectType RaveBufrIO_TYPE = {
     "RaveBufrIO",
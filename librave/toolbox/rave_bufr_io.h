@@ -69,4 +69,39 @@ RaveCoreObject* RaveBufrIO_read(RaveBufrIO_t* self, const char* filename);
  */
 int RaveBufrIO_isBufr(const char* filename);
 
+/**
+ * Configures decoding of BUFR files in separate worker processes. The OPERA BUFR
+ * library keeps its descriptor tables in global state so within one process only
+ * one file can be decoded at a time. By letting \ref RaveIO_open hand BUFR files
+ * over to up to maxworkers concurrently running worker processes, several files
+ * can be decoded in parallel.
+ * The worker program is invoked as: program [-t tabledir] <bufrfile> <odimfile> and
+ * should exit with 0 when the file has been written, e.g. the rave_bufr2odim binary.
+ * A new worker process is started for each file, so the descriptor tables are loaded
+ * again for every file. This costs more than decoding in process but lets the files be
+ * decoded in parallel, which is what matters when several threads read BUFR files.
+ * The PGF enables the workers with RAVE_PGF_BUFR_WORKERS in rave_defines.
+ * @param[in] program - the worker program, NULL disables the worker processes
+ * @param[in] maxworkers - the max number of concurrently running workers, <= 0 disables the worker processes
+ * @return 1 on success otherwise 0
+ */
+int RaveBufrIO_setWorkers(const char* program, int maxworkers);
+
+/**
+ * Returns the max number of concurrently running worker processes.
+ * @return the max number of workers, 0 if worker processes are not used
+ */
+int RaveBufrIO_getMaxWorkers(void);
+
+/**
+ * Converts a BUFR file into an ODIM HDF5 file by using a worker process. Will not
+ * wait for a worker if all workers are occupied or if worker processes are disabled,
+ * the caller should decode the file in process with \ref RaveBufrIO_read instead.
+ * @param[in] self - self
+ * @param[in] filename - the BUFR file
+ * @param[in] outfile - the HDF5 file that should be written
+ * @return 1 on success, 0 on failure and -1 if no worker was available
+ */
+int RaveBufrIO_convert(RaveBufrIO_t* self, const char* filename, const char* outfile);
+
 #endif /* RAVE_BUFR_IO_H */
@@ -32,6 +32,27 @@ along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
 #include <stdio.h>
 #include <math.h>
 
+/* Clones share the data buffer so the buffer reference count must be thread safe
+ * in the same way as the object reference count.
+ */
+#ifdef PTHREAD_SUPPORTED
+#define RAVE_DATA2D_ATOMIC_ADD(ptr, v) __sync_add_and_fetch((ptr), (v))
+#define RAVE_DATA2D_ATOMIC_SUB(ptr, v) __sync_sub_and_fetch((ptr), (v))
+#else
+#define RAVE_DATA2D_ATOMIC_ADD(ptr, v) ((*(ptr)) += (v))
+#define RAVE_DATA2D_ATOMIC_SUB(ptr, v) ((*(ptr)) -= (v))
+#endif
+
+/**
+ * Reference counted data buffer. A clone shares the buffer with the original until
+ * one of them is modified at which point the modified instance gets its own copy.
+ */
+typedef struct RaveData2DBuffer_t {
+  long refcount;     /**< number of instances sharing the buffer */
+  long nbytes;       /**< number of bytes in data */
+  void* data;        /**< the data */
+} RaveData2DBuffer_t;
+
 /**
  * Represents a date time instance
  */
@@ -42,9 +63,20 @@ struct _RaveData2D_t {
   int useNodata;     /**< using nodata */
   double nodata;     /**< the nodata value */
   RaveDataType type; /**< data type */
-  void* data;        /**< data ptr */
+  RaveData2DBuffer_t* buffer; /**< the possibly shared buffer */
+  void* data;        /**< data ptr, same as buffer->data */
 };
 
+/**
+ * Number of bytes that have been allocated for data buffers
+ */
+static long materializedBytes = 0;
+
+/**
+ * Number of bytes that have been shared by clones instead of being copied
+ */
+static long sharedBytes = 0;
+
 /**
  * Function pointer used by the element wise operations
  * @param[in] v1 - the first value
@@ -53,6 +85,67 @@ struct _RaveData2D_t {
 typedef double (*rave_eoperation)(double v1,double v2);
 
 /*@{ Private functions */
+/**
+ * Allocates a buffer that is referenced by one instance.
+ * @param[in] nbytes - the size of the data
+ * @return the buffer or NULL on failure
+ */
+static RaveData2DBuffer_t* RaveData2DInternal_createBuffer(long nbytes)
+{
+  RaveData2DBuffer_t* buffer = RAVE_MALLOC(sizeof(RaveData2DBuffer_t));
+  if (buffer == NULL) {
+    return NULL;
+  }
+  buffer->data = RAVE_MALLOC(nbytes > 0 ? nbytes : 1);
+  if (buffer->data == NULL) {
+    RAVE_FREE(buffer);
+    return NULL;
+  }
+  buffer->refcount = 1;
+  buffer->nbytes = nbytes;
+  RAVE_DATA2D_ATOMIC_ADD(&materializedBytes, nbytes);
+  return buffer;
+}
+
+/**
+ * Releases the instance's reference to the buffer. The buffer is freed when
+ * the last reference is released.
+ * @param[in] self - self
+ */
+static void RaveData2DInternal_releaseBuffer(RaveData2D_t* self)
+{
+  if (self->buffer != NULL) {
+    if (RAVE_DATA2D_ATOMIC_SUB(&self->buffer->refcount, 1) == 0) {
+      RAVE_FREE(self->buffer->data);
+      RAVE_FREE(self->buffer);
+    }
+  }
+  self->buffer = NULL;
+  self->data = NULL;
+}
+
+/**
+ * Makes sure that self is the only user of the buffer before it is modified. If
+ * the buffer is shared with a clone, the data is copied.
+ * @param[in] self - self
+ * @return 1 on success or 0 if the copy could not be allocated
+ */
+static int RaveData2DInternal_makeWritable(RaveData2D_t* self)
+{
+  if (self->buffer != NULL && self->buffer->refcount > 1) {
+    RaveData2DBuffer_t* buffer = RaveData2DInternal_createBuffer(self->buffer->nbytes);
+    if (buffer == NULL) {
+      RAVE_CRITICAL1("Failed to allocate memory (%ld bytes)", self->buffer->nbytes);
+      return 0;
+    }
+    memcpy(buffer->data, self->buffer->data, self->buffer->nbytes);
+    RaveData2DInternal_releaseBuffer(self);
+    self->buffer = buffer;
+    self->data = buffer->data;
+  }
+  return 1;
+}
+
 /**
  * Constructor.
  */
@@ -64,6 +157,7 @@ static int RaveData2D_constructor(RaveCoreObject* obj)
   data->useNodata = 0;
   data->nodata = 255;
   data->type = RaveDataType_UNDEFINED;
+  data->buffer = NULL;
   data->data = NULL;
   return 1;
 }
@@ -75,17 +169,20 @@ static int RaveData2D_copyconstructor(RaveCoreObject* obj, RaveCoreObject* srcob
 {
   RaveData2D_t* data = (RaveData2D_t*)obj;
   RaveData2D_t* srcdata = (RaveData2D_t*)srcobj;
-  int result = 1;
   data->xsize = srcdata->xsize;
   data->ysize = srcdata->ysize;
   data->useNodata = srcdata->useNodata;
   data->nodata = srcdata->nodata;
   data->type = srcdata->type;
+  data->buffer = NULL;
   data->data = NULL;
-  if (srcdata->data != NULL && srcdata->type > RaveDataType_UNDEFINED && srcdata->type < RaveDataType_LAST) {
-    result = RaveData2D_setData(data, srcdata->xsize, srcdata->ysize, srcdata->data, srcdata->type);
+  if (srcdata->buffer != NULL && srcdata->type > RaveDataType_UNDEFINED && srcdata->type < RaveDataType_LAST) {
+    RAVE_DATA2D_ATOMIC_ADD(&srcdata->buffer->refcount, 1);
+    RAVE_DATA2D_ATOMIC_ADD(&sharedBytes, srcdata->buffer->nbytes);
+    data->buffer = srcdata->buffer;
+    data->data = srcdata->buffer->data;
   }
-  return result;
+  return 1;
 }
 
 /**
@@ -95,7 +192,7 @@ static void RaveData2D_destructor(RaveCoreObject* obj)
 {
   RaveData2D_t* data = (RaveData2D_t*)obj;
   if (data != NULL) {
-    RAVE_FREE(data->data);
+    RaveData2DInternal_releaseBuffer(data);
   }
 }
 
@@ -252,11 +349,26 @@ RaveDataType RaveData2D_getType(RaveData2D_t* self)
 }
 
 void* RaveData2D_getData(RaveData2D_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  if (!RaveData2DInternal_makeWritable(self)) {
+    return NULL;
+  }
+  return self->data;
+}
+
+const void* RaveData2D_getReadOnlyData(RaveData2D_t* self)
 {
   RAVE_ASSERT((self != NULL), "self == NULL");
   return self->data;
 }
 
+int RaveData2D_isShared(RaveData2D_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return (self->buffer != NULL && self->buffer->refcount > 1) ? 1 : 0;
+}
+
 int RaveData2D_setData(RaveData2D_t* self, long xsize, long ysize, void* data, RaveDataType type)
 {
   int result = 0;
@@ -279,7 +391,7 @@ int RaveData2D_createData(RaveData2D_t* self, long xsize, long ysize, RaveDataTy
 {
   long sz = 0;
   long nbytes = 0;
-  void* ptr = NULL;
+  RaveData2DBuffer_t* buffer = NULL;
   int result = 0;
 
   RAVE_ASSERT((self != NULL), "self == NULL");
@@ -291,15 +403,16 @@ int RaveData2D_createData(RaveData2D_t* self, long xsize, long ysize, RaveDataTy
 
   sz = get_ravetype_size(type);
   nbytes = xsize*ysize*sz;
-  ptr = RAVE_MALLOC(nbytes);
+  buffer = RaveData2DInternal_createBuffer(nbytes);
 
-  if (ptr == NULL) {
+  if (buffer == NULL) {
     RAVE_CRITICAL1("Failed to allocate memory (%d bytes)", (int)nbytes);
     goto fail;
   }
-  memset(ptr, value, nbytes);
-  RAVE_FREE(self->data);
-  self->data = ptr;
+  memset(buffer->data, value, nbytes);
+  RaveData2DInternal_releaseBuffer(self);
+  self->buffer = buffer;
+  self->data = buffer->data;
   self->xsize = xsize;
   self->ysize = ysize;
   self->type = type;
@@ -347,6 +460,9 @@ int RaveData2D_setValueUnchecked(RaveData2D_t* self, long x, long y, double v)
     RAVE_ERROR0("Atempting to set value when there is no data array");
     return 0;
   }
+  if (self->buffer->refcount > 1 && !RaveData2DInternal_makeWritable(self)) {
+    return 0;
+  }
 
   switch (self->type) {
   case RaveDataType_CHAR: {
@@ -676,10 +792,60 @@ done:
   return result;
 }
 
+/**
+ * Swaps two non-overlapping blocks of memory without allocating.
+ * @param[in] a - first block
+ * @param[in] b - second block
+ * @param[in] nbytes - size of the blocks
+ */
+static void RaveData2DInternal_swapBlock(unsigned char* a, unsigned char* b, long nbytes)
+{
+  unsigned char tmp[256];
+  while (nbytes > 0) {
+    long n = (nbytes > (long)sizeof(tmp)) ? (long)sizeof(tmp) : nbytes;
+    memcpy(tmp, a, n);
+    memcpy(a, b, n);
+    memcpy(b, tmp, n);
+    a += n;
+    b += n;
+    nbytes -= n;
+  }
+}
+
+/**
+ * Reverses the order of nblocks consecutive blocks of blocksize bytes each.
+ * @param[in] data - the data
+ * @param[in] nblocks - number of blocks
+ * @param[in] blocksize - the size of each block in bytes
+ */
+static void RaveData2DInternal_reverseBlocks(unsigned char* data, long nblocks, long blocksize)
+{
+  long i = 0, j = nblocks - 1;
+  for (; i < j; i++, j--) {
+    RaveData2DInternal_swapBlock(data + i * blocksize, data + j * blocksize, blocksize);
+  }
+}
+
+/**
+ * Rotates nblocks consecutive blocks k steps towards higher indexes in place, i.e. block i ends up at (i + k) % nblocks.
+ * Uses three reversals so no extra memory is needed.
+ * @param[in] data - the data
+ * @param[in] nblocks - number of blocks
+ * @param[in] blocksize - the size of each block in bytes
+ * @param[in] k - the number of steps, 0 <= k < nblocks
+ */
+static void RaveData2DInternal_rotateBlocks(unsigned char* data, long nblocks, long blocksize, long k)
+{
+  if (k > 0) {
+    RaveData2DInternal_reverseBlocks(data, nblocks, blocksize);
+    RaveData2DInternal_reverseBlocks(data, k, blocksize);
+    RaveData2DInternal_reverseBlocks(data + k * blocksize, nblocks - k, blocksize);
+  }
+}
+
 RaveData2D_t* RaveData2D_circshift(RaveData2D_t* field, int nx, int ny)
 {
   RaveData2D_t *result = NULL, *newfield = NULL;
-  long x = 0, y = 0;
 
   RAVE_ASSERT((field != NULL), "field == NULL");
   if (!RaveData2D_hasData(field)) {
@@ -687,37 +853,10 @@ RaveData2D_t* RaveData2D_circshift(RaveData2D_t* field, int nx, int ny)
     return NULL;
   }
 
+  /* The clone shares the buffer so the shift below copies the data directly into the shifted positions */
   newfield = RAVE_OBJECT_CLONE(field);
-  if (newfield == NULL) {
-    return NULL;
-  }
-  RaveData2D_fill(newfield, 0.0);
-  for (x = 0; x < field->xsize; x++) {
-    int shiftedx = x + nx;
-    if (shiftedx >= field->xsize) {
-      shiftedx = shiftedx % field->xsize;
-    } else if (shiftedx < 0) {
-      while (shiftedx < 0) {
-        shiftedx = shiftedx + field->xsize;
-      }
-    }
-    for (y = 0; y < field->ysize; y++) {
-      double v = 0.0;
-      int shiftedy = y + ny;
-      if (shiftedy >= field->ysize) {
-        shiftedy = shiftedy % field->ysize;
-      } else if (shiftedy < 0) {
-        while (shiftedy < 0) {
-          shiftedy = shiftedy + field->ysize;
-        }
-      }
-      RaveData2D_getValueUnchecked(field, x, y, &v);
-
-      if (!RaveData2D_setValue(newfield, shiftedx, shiftedy, v)) {
-        RAVE_CRITICAL0("Coding error. Bad indexing in circshift!!!!");
-        goto done;
-      }
-    }
+  if (newfield == NULL || !RaveData2D_circshiftData(newfield, nx, ny)) {
+    goto done;
   }
   result = RAVE_OBJECT_COPY(newfield);
 done:
@@ -727,26 +866,60 @@ done:
 
 int RaveData2D_circshiftData(RaveData2D_t* field, int nx, int ny)
 {
-  RaveData2D_t *newfield = NULL;
-  int result = 1;
+  long sx = 0, sy = 0, typesize = 0, rowsize = 0, y = 0;
+  unsigned char* data = NULL;
 
   RAVE_ASSERT((field != NULL), "field == NULL");
   if (!RaveData2D_hasData(field)) {
     RAVE_ERROR0("No data in field");
-    goto fail;
+    return 0;
   }
 
-  newfield = RaveData2D_circshift(field, nx, ny);
-  if (newfield != NULL) {
-    long sz = get_ravetype_size(field->type);
-    long nbytes = field->xsize*field->ysize*sz;
-    memcpy(field->data, newfield->data, nbytes);
+  sx = nx % field->xsize;
+  if (sx < 0) {
+    sx += field->xsize;
+  }
+  sy = ny % field->ysize;
+  if (sy < 0) {
+    sy += field->ysize;
+  }
+  if (sx == 0 && sy == 0) {
+    return 1;
   }
 
-  result = 1;
-fail:
-  RAVE_OBJECT_RELEASE(newfield);
-  return result;
+  typesize = get_ravetype_size(field->type);
+  rowsize = typesize * field->xsize;
+
+  if (field->buffer->refcount > 1) {
+    /* Shared with a clone, copy straight into the shifted positions of a buffer of our own instead of copying first */
+    RaveData2DBuffer_t* buffer = RaveData2DInternal_createBuffer(field->buffer->nbytes);
+    unsigned char* src = field->data;
+    if (buffer == NULL) {
+      RAVE_CRITICAL1("Failed to allocate memory (%ld bytes)", field->buffer->nbytes);
+      return 0;
+    }
+    data = buffer->data;
+    for (y = 0; y < field->ysize; y++) {
+      unsigned char* srow = src + y * rowsize;
+      unsigned char* drow = data + ((y + sy) % field->ysize) * rowsize;
+      memcpy(drow + sx * typesize, srow, (field->xsize - sx) * typesize);
+      memcpy(drow, srow + (field->xsize - sx) * typesize, sx * typesize);
+    }
+    RaveData2DInternal_releaseBuffer(field);
+    field->buffer = buffer;
+    field->data = buffer->data;
+    return 1;
+  }
+
+  /* Rows (rays for polar data) are moved as whole blocks, then each row is rotated */
+  data = field->data;
+  RaveData2DInternal_rotateBlocks(data, field->ysize, rowsize, sy);
+  if (sx > 0) {
+    for (y = 0; y < field->ysize; y++) {
+      RaveData2DInternal_rotateBlocks(data + y * rowsize, field->xsize, typesize, sx);
+    }
+  }
+  return 1;
 }
 
 static double eoperation_add(double v1, double v2)
@@ -958,77 +1131,333 @@ RaveData2D_t* RaveData2D_cumsum(RaveData2D_t* field, int dir)
 	return result;
 }
 
-RaveData2D_t* RaveData2D_movingstd(RaveData2D_t* field, long nx, long ny)
+/**
+ * Builds summed area tables (integral images) over field. The tables have the size (xsize + 1) * (ysize + 1) and
+ * the element at (x + 1, y + 1) is the sum over all positions [0..x] x [0..y]. A position is counted if useNodata
+ * is 0 or the value differs from nodata and if mask is NULL or the mask is != 0 at that position. The values are
+ * accumulated relative to offset to keep the precision of the squared sums.
+ * @param[in] field - the field
+ * @param[in] mask - the mask, may be NULL
+ * @param[in] useNodata - if values equal to nodata should be excluded
+ * @param[in] offset - subtracted from each value before summing
+ * @param[out] sum - the sum of the values (release with RAVE_FREE)
+ * @param[out] sum2 - the sum of the squared values, may be NULL if not wanted
+ * @param[out] count - the number of values, may be NULL if not wanted
+ * @returns 1 on success otherwise 0
+ */
+static int RaveData2DInternal_createIntegralImages(RaveData2D_t* field, RaveData2D_t* mask, int useNodata, double offset,
+  double** sum, double** sum2, double** count)
 {
   long x = 0, y = 0;
-  long i = 0, j = 0;
-  RaveData2D_t *mstd = NULL, *result = NULL;
-  RaveData2D_t *weight = NULL;
-  RAVE_ASSERT((field != NULL), "field == NULL");
-  if (!field->useNodata) {
-    RAVE_ERROR0("When creating movingstd nodata usage should be activated");
-    return NULL;
+  long stride = field->xsize + 1;
+  size_t nbytes = (size_t)stride * (size_t)(field->ysize + 1) * sizeof(double);
+  double *s = NULL, *s2 = NULL, *c = NULL;
+  int result = 0;
+
+  s = RAVE_MALLOC(nbytes);
+  if (sum2 != NULL) {
+    s2 = RAVE_MALLOC(nbytes);
   }
-  mstd = RaveData2D_zeros(field->xsize, field->ysize, RaveDataType_DOUBLE);
-  weight = RaveData2D_zeros(field->xsize, field->ysize, RaveDataType_DOUBLE);
-  if (weight == NULL || mstd == NULL) {
+  if (count != NULL) {
+    c = RAVE_MALLOC(nbytes);
+  }
+  if (s == NULL || (sum2 != NULL && s2 == NULL) || (count != NULL && c == NULL)) {
+    RAVE_ERROR0("Failed to allocate memory for integral images");
     goto done;
   }
-  field->useNodata = 0; /* Think it should be 1 but matlab, criteria says Weight(X>-900. | isnan(X)==0)=1.0 which basically says anything that is != nan is weight 1*/
-  mstd->useNodata = 1; /* Should be active */
-  mstd->nodata = field->nodata;
-  for (x = 0; x < field->xsize; x++) {
-    for (y = 0; y < field->ysize; y++) {
-      double v = 0.0;
+
+  memset(s, 0, sizeof(double) * stride);
+  if (s2 != NULL) {
+    memset(s2, 0, sizeof(double) * stride);
+  }
+  if (c != NULL) {
+    memset(c, 0, sizeof(double) * stride);
+  }
+
+  for (y = 0; y < field->ysize; y++) {
+    double rs = 0.0, rs2 = 0.0, rc = 0.0;
+    long row = (y + 1) * stride, prev = y * stride;
+    s[row] = 0.0;
+    if (s2 != NULL) {
+      s2[row] = 0.0;
+    }
+    if (c != NULL) {
+      c[row] = 0.0;
+    }
+    for (x = 0; x < field->xsize; x++) {
+      double v = 0.0, m = 1.0;
       RaveData2D_getValueUnchecked(field, x, y, &v);
-      if (!field->useNodata || v != field->nodata) {
-        RaveData2D_setValueUnchecked(weight, x, y, 1.0);
+      if (mask != NULL) {
+        RaveData2D_getValueUnchecked(mask, x, y, &m);
+      }
+      if (m != 0.0 && (!useNodata || v != field->nodata)) {
+        v -= offset;
+        rs += v;
+        rs2 += v * v;
+        rc += 1.0;
+      }
+      s[row + x + 1] = s[prev + x + 1] + rs;
+      if (s2 != NULL) {
+        s2[row + x + 1] = s2[prev + x + 1] + rs2;
+      }
+      if (c != NULL) {
+        c[row + x + 1] = c[prev + x + 1] + rc;
       }
     }
   }
 
-  for (x = 0; x < field->xsize; x++) {
-    for (y = 0; y < field->ysize; y++) {
-      double valueMstd = 0.0;
-      double valueSumWeight = 0.0;
-      double valueWeight = 0.0;
-      double valueX = 0.0;
+  *sum = s;
+  s = NULL;
+  if (sum2 != NULL) {
+    *sum2 = s2;
+    s2 = NULL;
+  }
+  if (count != NULL) {
+    *count = c;
+    c = NULL;
+  }
+  result = 1;
+done:
+  RAVE_FREE(s);
+  RAVE_FREE(s2);
+  RAVE_FREE(c);
+  return result;
+}
 
-      RaveData2D_getValueUnchecked(weight, x, y, &valueWeight);
-      RaveData2D_getValueUnchecked(field, x, y, &valueX);
+/**
+ * Returns the sum over the box [x0..x1] x [y0..y1] (inclusive) from an integral image. The box must be within the field.
+ * @param[in] table - the integral image
+ * @param[in] stride - xsize + 1
+ * @returns the sum
+ */
+static double RaveData2DInternal_boxSum(double* table, long stride, long x0, long x1, long y0, long y1)
+{
+  return table[(y1 + 1) * stride + x1 + 1] - table[y0 * stride + x1 + 1] - table[(y1 + 1) * stride + x0] + table[y0 * stride + x0];
+}
 
-      for (j = ny; j >= -ny; j--) {
-        for (i = nx; i >= -nx; i--) {
-          long xi = (x + i)%field->xsize;
-          long yj = (y + j)%field->ysize;
-          double valueCircshiftWeight = 0.0;
-          double valueCircshiftX = 0.0;
+/**
+ * Returns the sum over [0..tx) x [0..ty) of the field repeated periodically in both directions, tx and ty may be
+ * negative or larger than the field. Used for the circularly shifted windows in \ref RaveData2D_movingstd.
+ * @param[in] table - the integral image
+ * @param[in] xsize - xsize of the field
+ * @param[in] ysize - ysize of the field
+ * @returns the sum
+ */
+static double RaveData2DInternal_periodicSum(double* table, long xsize, long ysize, long tx, long ty)
+{
+  long stride = xsize + 1;
+  long qx = tx / xsize, qy = ty / ysize;
+  long rx = 0, ry = 0;
+  if (tx % xsize < 0) {
+    qx--;
+  }
+  if (ty % ysize < 0) {
+    qy--;
+  }
+  rx = tx - qx * xsize;
+  ry = ty - qy * ysize;
+  return (double)qx * (double)qy * table[ysize * stride + xsize] + (double)qx * table[ry * stride + xsize] +
+         (double)qy * table[ysize * stride + rx] + table[ry * stride + rx];
+}
 
-          if (i==0 && j==0) continue;
+int RaveData2D_boxStatistics(RaveData2D_t* field, RaveData2D_t* mask, long x0, long x1, long y0, long y1,
+  RaveData2D_t** mean, RaveData2D_t** std, RaveData2D_t** count)
+{
+  RaveData2D_t *meanfield = NULL, *stdfield = NULL, *countfield = NULL;
+  double *sum = NULL, *sum2 = NULL, *cnt = NULL;
+  double offset = 0.0;
+  long x = 0, y = 0, stride = 0;
+  int result = 0;
 
-          while (xi < 0) {
-            xi += field->xsize;
-          }
-          while (yj < 0) {
-            yj += field->ysize;
-          }
+  RAVE_ASSERT((field != NULL), "field == NULL");
+  if (!RaveData2D_hasData(field)) {
+    RAVE_ERROR0("No data in field");
+    return 0;
+  }
+  if (mask != NULL && (mask->xsize != field->xsize || mask->ysize != field->ysize || !RaveData2D_hasData(mask))) {
+    RAVE_ERROR0("Mask must have same dimensions as field");
+    return 0;
+  }
+  if (x0 > x1 || y0 > y1) {
+    RAVE_ERROR0("Box must not be empty");
+    return 0;
+  }
+
+  /* First value used as offset so that the squared sums does not lose precision for large values */
+  if (std != NULL) {
+    RaveData2D_getValueUnchecked(field, 0, 0, &offset);
+    if (field->useNodata && offset == field->nodata) {
+      offset = 0.0;
+    }
+  }
 
-          RAVE_ASSERT((xi >= 0 && xi <field->xsize && yj >= 0 && yj < field->ysize), "BAD PROGRAMMING");
+  if (!RaveData2DInternal_createIntegralImages(field, mask, field->useNodata, offset, &sum, (std != NULL) ? &sum2 : NULL, &cnt)) {
+    goto done;
+  }
 
-          RaveData2D_getValueUnchecked(weight, xi, yj, &valueCircshiftWeight);
-          RaveData2D_getValueUnchecked(field, xi, yj, &valueCircshiftX);
+  if (mean != NULL) {
+    meanfield = RaveData2D_zeros(field->xsize, field->ysize, RaveDataType_DOUBLE);
+  }
+  if (std != NULL) {
+    stdfield = RaveData2D_zeros(field->xsize, field->ysize, RaveDataType_DOUBLE);
+  }
+  if (count != NULL) {
+    countfield = RaveData2D_zeros(field->xsize, field->ysize, RaveDataType_LONG);
+  }
+  if ((mean != NULL && meanfield == NULL) || (std != NULL && stdfield == NULL) || (count != NULL && countfield == NULL)) {
+    goto done;
+  }
+  if (meanfield != NULL) {
+    meanfield->useNodata = 1;
+    meanfield->nodata = field->nodata;
+  }
+  if (stdfield != NULL) {
+    stdfield->useNodata = 1;
+    stdfield->nodata = field->nodata;
+  }
 
-          valueMstd = valueMstd + valueWeight * valueCircshiftWeight * (valueCircshiftX - valueX)*(valueCircshiftX - valueX);
-          valueSumWeight = valueSumWeight + valueWeight * valueCircshiftWeight;
+  stride = field->xsize + 1;
+  for (y = 0; y < field->ysize; y++) {
+    long by0 = (y + y0 < 0) ? 0 : y + y0;
+    long by1 = (y + y1 >= field->ysize) ? field->ysize - 1 : y + y1;
+    for (x = 0; x < field->xsize; x++) {
+      long bx0 = (x + x0 < 0) ? 0 : x + x0;
+      long bx1 = (x + x1 >= field->xsize) ? field->xsize - 1 : x + x1;
+      double n = 0.0, s = 0.0;
+      if (bx0 <= bx1 && by0 <= by1) {
+        n = RaveData2DInternal_boxSum(cnt, stride, bx0, bx1, by0, by1);
+      }
+      if (countfield != NULL) {
+        RaveData2D_setValueUnchecked(countfield, x, y, n);
+      }
+      if (n < 0.5) {
+        if (meanfield != NULL) {
+          RaveData2D_setValueUnchecked(meanfield, x, y, field->nodata);
+        }
+        if (stdfield != NULL) {
+          RaveData2D_setValueUnchecked(stdfield, x, y, field->nodata);
         }
+        continue;
+      }
+      s = RaveData2DInternal_boxSum(sum, stride, bx0, bx1, by0, by1) / n;
+      if (meanfield != NULL) {
+        RaveData2D_setValueUnchecked(meanfield, x, y, s + offset);
       }
+      if (stdfield != NULL) {
+        double var = RaveData2DInternal_boxSum(sum2, stride, bx0, bx1, by0, by1) / n - s * s;
+        RaveData2D_setValueUnchecked(stdfield, x, y, (var > 0.0) ? sqrt(var) : 0.0);
+      }
+    }
+  }
+
+  if (mean != NULL) {
+    *mean = RAVE_OBJECT_COPY(meanfield);
+  }
+  if (std != NULL) {
+    *std = RAVE_OBJECT_COPY(stdfield);
+  }
+  if (count != NULL) {
+    *count = RAVE_OBJECT_COPY(countfield);
+  }
+  result = 1;
+done:
+  RAVE_FREE(sum);
+  RAVE_FREE(sum2);
+  RAVE_FREE(cnt);
+  RAVE_OBJECT_RELEASE(meanfield);
+  RAVE_OBJECT_RELEASE(stdfield);
+  RAVE_OBJECT_RELEASE(countfield);
+  return result;
+}
+
+RaveData2D_t* RaveData2D_boxmean(RaveData2D_t* field, long nx, long ny)
+{
+  RaveData2D_t* result = NULL;
+  RAVE_ASSERT((field != NULL), "field == NULL");
+  if (nx < 0 || ny < 0) {
+    RAVE_ERROR0("nx and ny must be >= 0");
+    return NULL;
+  }
+  if (!RaveData2D_boxStatistics(field, NULL, -nx, nx, -ny, ny, &result, NULL, NULL)) {
+    return NULL;
+  }
+  return result;
+}
+
+RaveData2D_t* RaveData2D_boxstd(RaveData2D_t* field, long nx, long ny)
+{
+  RaveData2D_t* result = NULL;
+  RAVE_ASSERT((field != NULL), "field == NULL");
+  if (nx < 0 || ny < 0) {
+    RAVE_ERROR0("nx and ny must be >= 0");
+    return NULL;
+  }
+  if (!RaveData2D_boxStatistics(field, NULL, -nx, nx, -ny, ny, NULL, &result, NULL)) {
+    return NULL;
+  }
+  return result;
+}
+
+RaveData2D_t* RaveData2D_movingstd(RaveData2D_t* field, long nx, long ny)
+{
+  long x = 0, y = 0;
+  RaveData2D_t *mstd = NULL, *result = NULL;
+  double *sum = NULL, *sum2 = NULL;
+  double offset = 0.0, n = 0.0;
+  RAVE_ASSERT((field != NULL), "field == NULL");
+  if (!field->useNodata) {
+    RAVE_ERROR0("When creating movingstd nodata usage should be activated");
+    return NULL;
+  }
+  if (!RaveData2D_hasData(field)) {
+    RAVE_ERROR0("No data in field");
+    return NULL;
+  }
+  if (nx < 0) {
+    nx = -nx;
+  }
+  if (ny < 0) {
+    ny = -ny;
+  }
+  mstd = RaveData2D_zeros(field->xsize, field->ysize, RaveDataType_DOUBLE);
+  if (mstd == NULL) {
+    goto done;
+  }
+  mstd->useNodata = 1; /* Should be active */
+  mstd->nodata = field->nodata;
+
+  /* Think nodata should be excluded but matlab, criteria says Weight(X>-900. | isnan(X)==0)=1.0 which basically says
+   * anything that is != nan is weight 1. So all values are used and the weight sum is the window size minus the center.
+   * The sum of (Xn - Xc)^2 over the circularly shifted window is then S2 - 2*Xc*S1 + n*Xc^2 which is fetched from
+   * periodic summed area tables instead of visiting every neighbour.
+   */
+  RaveData2D_getValueUnchecked(field, 0, 0, &offset);
+  if (!RaveData2DInternal_createIntegralImages(field, NULL, 0, offset, &sum, &sum2, NULL)) {
+    goto done;
+  }
+  n = (double)(2 * nx + 1) * (double)(2 * ny + 1);
+
+  for (y = 0; y < field->ysize; y++) {
+    for (x = 0; x < field->xsize; x++) {
+      double valueX = 0.0, s1 = 0.0, s2 = 0.0, valueMstd = 0.0;
+      double valueSumWeight = n - 1.0;
+
+      RaveData2D_getValueUnchecked(field, x, y, &valueX);
+      valueX -= offset;
+
+      s1 = RaveData2DInternal_periodicSum(sum, field->xsize, field->ysize, x + nx + 1, y + ny + 1) -
+           RaveData2DInternal_periodicSum(sum, field->xsize, field->ysize, x - nx, y + ny + 1) -
+           RaveData2DInternal_periodicSum(sum, field->xsize, field->ysize, x + nx + 1, y - ny) +
+           RaveData2DInternal_periodicSum(sum, field->xsize, field->ysize, x - nx, y - ny);
+      s2 = RaveData2DInternal_periodicSum(sum2, field->xsize, field->ysize, x + nx + 1, y + ny + 1) -
+           RaveData2DInternal_periodicSum(sum2, field->xsize, field->ysize, x - nx, y + ny + 1) -
+           RaveData2DInternal_periodicSum(sum2, field->xsize, field->ysize, x + nx + 1, y - ny) +
+           RaveData2DInternal_periodicSum(sum2, field->xsize, field->ysize, x - nx, y - ny);
+      valueMstd = s2 - 2.0 * valueX * s1 + n * valueX * valueX;
 
       if (valueSumWeight >= 3.0) {
-        if (valueMstd >= 0) {
-          RaveData2D_setValueUnchecked(mstd, x, y, sqrt(valueMstd) / valueSumWeight);
-        } else {
-          RaveData2D_setValueUnchecked(mstd, x, y, mstd->nodata);
-        }
+        /* Rounding can give a tiny negative sum when all values are equal */
+        RaveData2D_setValueUnchecked(mstd, x, y, (valueMstd > 0.0) ? sqrt(valueMstd) / valueSumWeight : 0.0);
       } else {
         RaveData2D_setValueUnchecked(mstd, x, y, mstd->nodata);
       }
@@ -1038,9 +1467,9 @@ RaveData2D_t* RaveData2D_movingstd(RaveData2D_t* field, long nx, long ny)
   result = RAVE_OBJECT_COPY(mstd);
 
 done:
+  RAVE_FREE(sum);
+  RAVE_FREE(sum2);
   RAVE_OBJECT_RELEASE(mstd);
-  RAVE_OBJECT_RELEASE(weight);
-  field->useNodata = 1;
   return result;
 }
 
@@ -1289,6 +1718,22 @@ RaveData2D_t* RaveData2D_createObject(long xsize, long ysize, RaveDataType type)
   return result;
 }
 
+long RaveData2D_getMaterializedBytes(void)
+{
+  return RAVE_DATA2D_ATOMIC_ADD(&materializedBytes, 0);
+}
+
+long RaveData2D_getSharedBytes(void)
+{
+  return RAVE_DATA2D_ATOMIC_ADD(&sharedBytes, 0);
+}
+
+void RaveData2D_resetStatistics(void)
+{
+  RAVE_DATA2D_ATOMIC_SUB(&materializedBytes, RaveData2D_getMaterializedBytes());
+  RAVE_DATA2D_ATOMIC_SUB(&sharedBytes, RaveData2D_getSharedBytes());
+}
+
 /*@} End of Interface functions */
 RaveCoreObjectType RaveData2D_TYPE = {
     "RaveData2D",
@@ -18,7 +18,8 @@ along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
 ------------------------------------------------------------------------*/
 /**
  * Represents a 2-dimensional data array.
- * This object supports \ref #RAVE_OBJECT_CLONE.
+ * This object supports \ref #RAVE_OBJECT_CLONE. A clone shares the data array with the
+ * original until one of them is modified (copy-on-write).
  * @file
  * @author Anders Henja (Swedish Meteorological and Hydrological Institute, SMHI)
  * @date 2009-12-17
@@ -87,12 +88,29 @@ long RaveData2D_getYsize(RaveData2D_t* self);
 RaveDataType RaveData2D_getType(RaveData2D_t* self);
 
 /**
- * Returns a pointer to the internal data storage.
+ * Returns a pointer to the internal data storage. Since the caller may modify the data
+ * through the pointer, a data array that is shared with a clone is copied first.
+ * Use \ref #RaveData2D_getReadOnlyData when the data only is read.
  * @param[in] self - self
  * @return the internal data pointer (NOTE! Do not release this pointer)
  */
 void* RaveData2D_getData(RaveData2D_t* self);
 
+/**
+ * Returns a pointer to the internal data storage without copying a shared data array.
+ * The data must not be modified through this pointer.
+ * @param[in] self - self
+ * @return the internal data pointer (NOTE! Do not release this pointer)
+ */
+const void* RaveData2D_getReadOnlyData(RaveData2D_t* self);
+
+/**
+ * Returns if the data array currently is shared with a clone.
+ * @param[in] self - self
+ * @return 1 if shared, otherwise 0
+ */
+int RaveData2D_isShared(RaveData2D_t* self);
+
 /**
  * Sets the data.
  * @param[in] self  - self
@@ -315,6 +333,44 @@ RaveData2D_t* RaveData2D_cumsum(RaveData2D_t* field, int dir);
  */
 RaveData2D_t* RaveData2D_movingstd(RaveData2D_t* field, long nx, long ny);
 
+/**
+ * Calculates the mean, standard deviation and number of values in a box around every position. Summed area
+ * tables (integral images) are used so the cost per position is independent of the box size.
+ * The box around (x,y) covers x+x0 .. x+x1 and y+y0 .. y+y1 (inclusive) and is clipped at the borders.
+ * A value is excluded if nodata is used and the value is nodata, or if a mask is given and the mask is 0.
+ * Positions without any values get nodata in mean and std.
+ * @param[in] field - self
+ * @param[in] mask - a mask with the same dimensions as field, may be NULL
+ * @param[in] x0 - start offset of the box in x-dim
+ * @param[in] x1 - end offset of the box in x-dim (>= x0)
+ * @param[in] y0 - start offset of the box in y-dim
+ * @param[in] y1 - end offset of the box in y-dim (>= y0)
+ * @param[out] mean - the mean as a double field, may be NULL if not wanted
+ * @param[out] std - the population standard deviation as a double field, may be NULL if not wanted
+ * @param[out] count - the number of values as a long field, may be NULL if not wanted
+ * @returns 1 on success otherwise 0
+ */
+int RaveData2D_boxStatistics(RaveData2D_t* field, RaveData2D_t* mask, long x0, long x1, long y0, long y1,
+  RaveData2D_t** mean, RaveData2D_t** std, RaveData2D_t** count);
+
+/**
+ * Computes the mean in the box x +/- nx, y +/- ny around every position, see \ref RaveData2D_boxStatistics.
+ * @param[in] field - self
+ * @param[in] nx - number of pixels on each side in x-dim
+ * @param[in] ny - number of pixels on each side in y-dim
+ * @returns the mean field or NULL on failure
+ */
+RaveData2D_t* RaveData2D_boxmean(RaveData2D_t* field, long nx, long ny);
+
+/**
+ * Computes the standard deviation in the box x +/- nx, y +/- ny around every position, see \ref RaveData2D_boxStatistics.
+ * @param[in] field - self
+ * @param[in] nx - number of pixels on each side in x-dim
+ * @param[in] ny - number of pixels on each side in y-dim
+ * @returns the standard deviation field or NULL on failure
+ */
+RaveData2D_t* RaveData2D_boxstd(RaveData2D_t* field, long nx, long ny);
+
 /**
  * Creates a histogram of field with bins number of bins. The histogram will be determined as
  * Calculate bin ranges as scale = (max - min) / nbins
@@ -397,4 +453,22 @@ RaveData2D_t* RaveData2D_ones(long xsize, long ysize, RaveDataType type);
  */
 RaveData2D_t* RaveData2D_createObject(long xsize, long ysize, RaveDataType type);
 
+/**
+ * Returns the number of bytes that have been allocated for data arrays, either when
+ * creating data or when a shared data array has been copied before being modified.
+ * @return number of bytes since start or since the last \ref #RaveData2D_resetStatistics
+ */
+long RaveData2D_getMaterializedBytes(void);
+
+/**
+ * Returns the number of bytes that clones have shared instead of copying.
+ * @return number of bytes since start or since the last \ref #RaveData2D_resetStatistics
+ */
+long RaveData2D_getSharedBytes(void);
+
+/**
+ * Resets the materialized and shared byte counters.
+ */
+void RaveData2D_resetStatistics(void);
+
 #endif /* RAVE_DATA2D_H */
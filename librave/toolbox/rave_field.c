@@ -29,6 +29,7 @@ along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
 #include "raveobject_hashtable.h"
 #include "rave_utilities.h"
 #include "rave_attribute_table.h"
+#include "rave_hlhdf_utilities.h"
 #include <string.h>
 /**
  * Represents the cartesian volume
@@ -38,6 +39,8 @@ struct _RaveField_t {
   RaveData2D_t* data; /**< the data */
   LazyDataset_t* lazyDataset; /**< the lazy dataset */
   RaveAttributeTable_t* attrs; /**< attributes */
+  RadarIndexTable_t* radarIndexTable; /**< radar indexes, serialized to how/task_args when attributes are read */
+  long radarIndexTableSynced; /**< modifications of the table when it was last serialized, -1 if it has not been */
 };
 
 /*@{ Private functions */
@@ -50,6 +53,8 @@ static int RaveField_constructor(RaveCoreObject* obj)
   this->attrs = RAVE_OBJECT_NEW(&RaveAttributeTable_TYPE);
   this->data = RAVE_OBJECT_NEW(&RaveData2D_TYPE);
   this->lazyDataset = NULL;
+  this->radarIndexTable = NULL;
+  this->radarIndexTableSynced = -1;
   if (this->attrs == NULL || this->data == NULL) {
     goto error;
   }
@@ -69,17 +74,51 @@ error:
 static RaveData2D_t* RaveFieldInternal_ensureData2D(RaveField_t* field)
 {
   if (field->lazyDataset != NULL) {
-    RaveData2D_t* loaded = LazyDataset_get(field->lazyDataset);
-    if (loaded != NULL) {
-      RAVE_OBJECT_RELEASE(field->data);
-      field->data = RAVE_OBJECT_COPY(loaded);
-      RAVE_OBJECT_RELEASE(field->lazyDataset);
+    /* Lazy loading is serialized so that threads sharing this field will not load it twice */
+    RaveHL_lock();
+    if (field->lazyDataset != NULL) {
+      RaveData2D_t* loaded = LazyDataset_get(field->lazyDataset);
+      if (loaded != NULL) {
+        RAVE_OBJECT_RELEASE(field->data);
+        field->data = RAVE_OBJECT_COPY(loaded);
+        RAVE_OBJECT_RELEASE(field->lazyDataset);
+      }
+      RAVE_OBJECT_RELEASE(loaded);
     }
-    RAVE_OBJECT_RELEASE(loaded);
+    RaveHL_unlock();
   }
   return field->data;
 }
 
+/**
+ * Writes the radar index table, if any, to the how/task_args attribute. The table is only
+ * serialized when it has been set or modified since it was last written.
+ * @param[in] field - the rave field
+ * @returns 1 on success otherwise 0
+ */
+static int RaveFieldInternal_syncRadarIndexTable(RaveField_t* field)
+{
+  int result = 1;
+  if (field->radarIndexTable != NULL &&
+      field->radarIndexTableSynced != RadarIndexTable_getModifications(field->radarIndexTable)) {
+    char* str = RadarIndexTable_toString(field->radarIndexTable);
+    RaveAttribute_t* attr = NULL;
+    result = 0;
+    if (str != NULL) {
+      attr = RaveAttributeHelp_createString("how/task_args", str);
+      if (attr != NULL) {
+        result = RaveAttributeTable_addAttributeVersion(field->attrs, attr, RAVEIO_API_ODIM_VERSION, NULL);
+      }
+    }
+    if (result) {
+      field->radarIndexTableSynced = RadarIndexTable_getModifications(field->radarIndexTable);
+    }
+    RAVE_OBJECT_RELEASE(attr);
+    RAVE_FREE(str);
+  }
+  return result;
+}
+
 /**
  * Copy constructor.
  */
@@ -90,6 +129,14 @@ static int RaveField_copyconstructor(RaveCoreObject* obj, RaveCoreObject* srcobj
   this->attrs = RAVE_OBJECT_CLONE(src->attrs);
   this->data = RAVE_OBJECT_CLONE(RaveFieldInternal_ensureData2D(src));
   this->lazyDataset = NULL;
+  this->radarIndexTable = NULL;
+  this->radarIndexTableSynced = -1;
+  if (src->radarIndexTable != NULL) {
+    this->radarIndexTable = RAVE_OBJECT_CLONE(src->radarIndexTable);
+    if (this->radarIndexTable == NULL) {
+      goto error;
+    }
+  }
   if (this->data == NULL || this->attrs == NULL) {
     RAVE_ERROR0("Failed to duplicate data or attributes");
     goto error;
@@ -98,6 +145,7 @@ static int RaveField_copyconstructor(RaveCoreObject* obj, RaveCoreObject* srcobj
 error:
   RAVE_OBJECT_RELEASE(this->attrs);
   RAVE_OBJECT_RELEASE(this->data);
+  RAVE_OBJECT_RELEASE(this->radarIndexTable);
   return 0;
 }
 
@@ -111,6 +159,7 @@ static void RaveField_destructor(RaveCoreObject* obj)
   RAVE_OBJECT_RELEASE(this->attrs);
   RAVE_OBJECT_RELEASE(this->data);
   RAVE_OBJECT_RELEASE(this->lazyDataset);
+  RAVE_OBJECT_RELEASE(this->radarIndexTable);
 }
 
 
@@ -131,7 +180,7 @@ int RaveField_setData(RaveField_t* field, long xsize, long ysize, void* data, Ra
 int RaveField_setLazyDataset(RaveField_t* field, LazyDataset_t* lazyDataset)
 {
   RAVE_ASSERT((field != NULL), "field == NULL");
-  if (RaveData2D_getData(field->data) == NULL) {
+  if (RaveData2D_getReadOnlyData(field->data) == NULL) {
     field->lazyDataset = RAVE_OBJECT_COPY(lazyDataset);
     return 1;
   } else {
@@ -175,6 +224,12 @@ void* RaveField_getData(RaveField_t* field)
   return RaveData2D_getData(RaveFieldInternal_ensureData2D(field));
 }
 
+const void* RaveField_getReadOnlyData(RaveField_t* field)
+{
+  RAVE_ASSERT((field != NULL), "field == NULL");
+  return RaveData2D_getReadOnlyData(RaveFieldInternal_ensureData2D(field));
+}
+
 RaveData2D_t* RaveField_getDatafield(RaveField_t* field)
 {
   RaveData2D_t* result = NULL;
@@ -229,29 +284,44 @@ int RaveField_getConvertedValue(RaveField_t* field, long x, long y, double* v)
 
 long RaveField_getXsize(RaveField_t* field)
 {
+  long result = 0;
   RAVE_ASSERT((field != NULL), "field == NULL");
+  RaveHL_lock(); /* a concurrent lazy load releases the lazy dataset under this lock */
   if (field->lazyDataset != NULL) {
-    return LazyDataset_getXsize(field->lazyDataset);
+    result = LazyDataset_getXsize(field->lazyDataset);
+  } else {
+    result = RaveData2D_getXsize(field->data);
   }
-  return RaveData2D_getXsize(field->data);
+  RaveHL_unlock();
+  return result;
 }
 
 long RaveField_getYsize(RaveField_t* field)
 {
+  long result = 0;
   RAVE_ASSERT((field != NULL), "field == NULL");
+  RaveHL_lock(); /* a concurrent lazy load releases the lazy dataset under this lock */
   if (field->lazyDataset != NULL) {
-    return LazyDataset_getYsize(field->lazyDataset);
+    result = LazyDataset_getYsize(field->lazyDataset);
+  } else {
+    result = RaveData2D_getYsize(field->data);
   }
-  return RaveData2D_getYsize(field->data);
+  RaveHL_unlock();
+  return result;
 }
 
 RaveDataType RaveField_getDataType(RaveField_t* field)
 {
+  RaveDataType result = RaveDataType_UNDEFINED;
   RAVE_ASSERT((field != NULL), "field == NULL");
+  RaveHL_lock(); /* a concurrent lazy load releases the lazy dataset under this lock */
   if (field->lazyDataset != NULL) {
-    return LazyDataset_getDataType(field->lazyDataset);
+    result = LazyDataset_getDataType(field->lazyDataset);
+  } else {
+    result = RaveData2D_getType(field->data);
   }
-  return RaveData2D_getType(field->data);
+  RaveHL_unlock();
+  return result;
 }
 
 int RaveField_addAttribute(RaveField_t* field,  RaveAttribute_t* attribute)
@@ -278,6 +348,9 @@ int RaveField_addAttributeVersion(RaveField_t* field,  RaveAttribute_t* attribut
   if ((strcasecmp("how", gname)==0 && RaveAttributeHelp_validateHowGroupAttributeName(gname, aname)) ||
       ((strcasecmp("what", gname)==0 || strcasecmp("where", gname)==0) && strchr(aname, '/') == NULL)) {
     result = RaveAttributeTable_addAttributeVersion(field->attrs, attribute, version, NULL);
+    if (result && strcasecmp("how", gname) == 0 && strcmp("task_args", aname) == 0) {
+      RAVE_OBJECT_RELEASE(field->radarIndexTable);
+    }
   }
 
 done:
@@ -293,12 +366,18 @@ RaveAttribute_t* RaveField_getAttribute(RaveField_t* field, const char* name)
     RAVE_ERROR0("Trying to get an attribute with NULL name");
     return NULL;
   }
+  if (field->radarIndexTable != NULL && strcmp("how/task_args", name) == 0) {
+    RaveFieldInternal_syncRadarIndexTable(field);
+  }
   return RaveAttributeTable_getAttribute(field->attrs, name);
 }
 
 int RaveField_hasAttribute(RaveField_t* field, const char* name)
 {
   RAVE_ASSERT((field != NULL), "field == NULL");
+  if (field->radarIndexTable != NULL && name != NULL && strcmp("how/task_args", name) == 0) {
+    return 1;
+  }
   return RaveAttributeTable_hasAttribute(field->attrs, name);
 }
 
@@ -311,6 +390,7 @@ RaveList_t* RaveField_getAttributeNames(RaveField_t* field)
 RaveList_t* RaveField_getAttributeNamesVersion(RaveField_t* field, RaveIO_ODIM_Version version)
 {
   RAVE_ASSERT((field != NULL), "field == NULL");
+  RaveFieldInternal_syncRadarIndexTable(field);
   return RaveAttributeTable_getAttributeNamesVersion(field->attrs, version);
 }
 
@@ -323,12 +403,14 @@ RaveObjectList_t* RaveField_getAttributeValues(RaveField_t* field)
 RaveObjectList_t* RaveField_getAttributeValuesVersion(RaveField_t* field, RaveIO_ODIM_Version version)
 {
   RAVE_ASSERT((field != NULL), "field == NULL");
+  RaveFieldInternal_syncRadarIndexTable(field);
   return RaveAttributeTable_getValuesVersion(field->attrs, version);
 }
 
 RaveObjectList_t* RaveField_getInternalAttributeValues(RaveField_t* field)
 {
   RAVE_ASSERT((field != NULL), "field == NULL");
+  RaveFieldInternal_syncRadarIndexTable(field);
   return RaveAttributeTable_getInternalValues(field->attrs);
 }
 
@@ -336,6 +418,7 @@ void RaveField_removeAttributes(RaveField_t* field)
 {
   RAVE_ASSERT((field != NULL), "field == NULL");
   RaveAttributeTable_clear(field->attrs);
+  RAVE_OBJECT_RELEASE(field->radarIndexTable);
 }
 
 int RaveField_hasAttributeStringValue(RaveField_t* field, const char* name, const char* value)
@@ -345,7 +428,7 @@ int RaveField_hasAttributeStringValue(RaveField_t* field, const char* name, cons
 
   RAVE_ASSERT((field != NULL), "field == NULL");
   if (name != NULL && value != NULL) {
-    attr = RaveAttributeTable_getAttribute(field->attrs, name);
+    attr = RaveField_getAttribute(field, name);
     if (attr != NULL && RaveAttribute_getFormat(attr) == RaveAttribute_Format_String) {
       char* aval = NULL;
       RaveAttribute_getString(attr, &aval);
@@ -396,6 +479,32 @@ int RaveField_circshiftData(RaveField_t* field, int nx, int ny)
   return RaveData2D_circshiftData(RaveFieldInternal_ensureData2D(field), nx, ny);
 }
 
+void RaveField_setRadarIndexTable(RaveField_t* field, RadarIndexTable_t* table)
+{
+  RAVE_ASSERT((field != NULL), "field == NULL");
+  RAVE_OBJECT_RELEASE(field->radarIndexTable);
+  field->radarIndexTable = RAVE_OBJECT_COPY(table);
+  field->radarIndexTableSynced = -1;
+}
+
+RadarIndexTable_t* RaveField_getRadarIndexTable(RaveField_t* field)
+{
+  RAVE_ASSERT((field != NULL), "field == NULL");
+  if (field->radarIndexTable == NULL) {
+    RaveAttribute_t* attr = RaveAttributeTable_getAttribute(field->attrs, "how/task_args");
+    char* value = NULL;
+    if (attr != NULL && RaveAttribute_getString(attr, &value) && value != NULL) {
+      field->radarIndexTable = RadarIndexTable_fromString(value);
+      if (field->radarIndexTable != NULL) {
+        /* how/task_args already holds the table as parsed */
+        field->radarIndexTableSynced = RadarIndexTable_getModifications(field->radarIndexTable);
+      }
+    }
+    RAVE_OBJECT_RELEASE(attr);
+  }
+  return RAVE_OBJECT_COPY(field->radarIndexTable);
+}
+
 /*@} End of Interface functions */
 
 
@@ -32,6 +32,7 @@ along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
 #include "raveobject_list.h"
 #include "rave_data2d.h"
 #include "lazy_dataset.h"
+#include "radar_index_table.h"
 /**
  * Defines a Rave field
  */
@@ -79,12 +80,21 @@ int RaveField_createData(RaveField_t* field, long xsize, long ysize, RaveDataTyp
 int RaveField_setDatafield(RaveField_t* field, RaveData2D_t* datafield);
 
 /**
- * Returns a pointer to the internal data storage.
+ * Returns a pointer to the internal data storage. If the data is shared with a clone
+ * it is copied first since the caller may modify it.
  * @param[in] field - self
  * @return the internal data pointer (NOTE! Do not release this pointer)
  */
 void* RaveField_getData(RaveField_t* field);
 
+/**
+ * Returns a pointer to the internal data storage that must not be modified. A data
+ * array that is shared with a clone is not copied.
+ * @param[in] field - self
+ * @return the internal data pointer (NOTE! Do not release this pointer)
+ */
+const void* RaveField_getReadOnlyData(RaveField_t* field);
+
 /**
  * Returns the 2d field associated with this rave field. Note, it is a
  * clone so don't expect that any modifications will modify the rave fields
@@ -252,4 +262,22 @@ RaveField_t* RaveField_concatX(RaveField_t* field, RaveField_t* other);
  */
 int RaveField_circshiftData(RaveField_t* field, int nx, int ny);
 
+/**
+ * Sets the radar index table of the field. While a table is set, the attribute how/task_args
+ * is generated from the table when the attributes are read after the table has been set or
+ * modified. Adding a how/task_args attribute or removing all attributes releases the table.
+ * @param[in] field - self
+ * @param[in] table - the table (NULL to remove)
+ */
+void RaveField_setRadarIndexTable(RaveField_t* field, RadarIndexTable_t* table);
+
+/**
+ * Returns the radar index table of the field. If no table has been set but the field
+ * has a how/task_args attribute, the attribute is parsed once and kept as the table of
+ * the field so that subsequent merges operate on the table.
+ * @param[in] field - self
+ * @returns a reference to the table or NULL if there is no table and how/task_args could not be parsed
+ */
+RadarIndexTable_t* RaveField_getRadarIndexTable(RaveField_t* field);
+
 #endif /* RAVE_FIELD_H */
@@ -43,6 +43,7 @@ along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
 #include "rave_debug.h"
 #include "rave_alloc.h"
 #include "raveutil.h"
+#include "rave_rowpool.h"
 #include <string.h>
 #include <math.h>
 #include <stdio.h>
@@ -59,10 +60,10 @@ struct _RaveGra_t {
   double lowerThreshold; /**< in 10ths of dBR, default -0.25 (-2.5 dBR) */
   double zrA; /**< the ZR A coefficient when converting from reflectivity to MM/H */
   double zrb; /**< the ZR b coefficient when converting from reflectivity to MM/H */
+  int nthreads; /**< number of threads when applying */
 };
 
 /*@{ Private functions */
-
 /**
  * Constructor
  */
@@ -76,6 +77,7 @@ static int RaveGra_constructor(RaveCoreObject* obj)
   self->lowerThreshold = -0.25;
   self->zrA = 200.0;
   self->zrb = 1.6;
+  self->nthreads = 1;
   return 1;
 }
 
@@ -85,7 +87,7 @@ static int RaveGra_constructor(RaveCoreObject* obj)
 static int RaveGra_copyconstructor(RaveCoreObject* obj, RaveCoreObject* srcobj)
 {
   RaveGra_t* self = (RaveGra_t*)obj;
-  RaveGra_t* src = (RaveGra_t*)obj;
+  RaveGra_t* src = (RaveGra_t*)srcobj;
   self->A = src->A;
   self->B = src->B;
   self->C = src->C;
@@ -93,6 +95,7 @@ static int RaveGra_copyconstructor(RaveCoreObject* obj, RaveCoreObject* srcobj)
   self->lowerThreshold = src->lowerThreshold;
   self->zrA = src->zrA;
   self->zrb = src->zrb;
+  self->nthreads = src->nthreads;
   return 1;
 }
 
@@ -202,53 +205,178 @@ double RaveGra_getZRB(RaveGra_t* self)
   return self->zrb;
 }
 
+int RaveGra_setNumberOfThreads(RaveGra_t* self, int nthreads)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  if (nthreads < 1) {
+    return 0;
+  }
+  self->nthreads = nthreads;
+  return 1;
+}
+
+int RaveGra_getNumberOfThreads(RaveGra_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return self->nthreads;
+}
+
 /**
- * Applies the gra coefficient on MM/H.
+ * Returns the adjustment factor 10^F for the distance.
  * @param[in] self - self
- * @param[in] distance - the distance to the radar for this value. in unit km.
- * @param[in] value - the MM/H
- * @param[in] dtype - the data type
- * @returns the corrected value
+ * @param[in] distance - the distance to the radar. in unit km.
+ * @returns the factor the MM/H should be multiplied with
  */
-static double applyAcrr(RaveGra_t* self, double distance, double value, RaveValueType dtype)
+static double RaveGraInternal_getFactor(RaveGra_t* self, double distance)
 {
-  double result = value;
-
-  if (dtype == RaveValueType_DATA) {
-    double F = (self->A + self->B * distance + self->C * distance * distance) / 10.0;
-    F = RAVEMIN(F, self->upperThreshold);
-    F = RAVEMAX(F, self->lowerThreshold);
-    result = value * pow(10.0, F);
-    if (result < self->lowerThreshold) {
-      result = 0.0;
-    }
+  double F = (self->A + self->B * distance + self->C * distance * distance) / 10.0;
+  F = RAVEMIN(F, self->upperThreshold);
+  F = RAVEMAX(F, self->lowerThreshold);
+  return pow(10.0, F);
+}
+
+/**
+ * Returns the raw value at the index in a data array.
+ * @param[in] data - the data array
+ * @param[in] type - the data type
+ * @param[in] index - the index (y * xsize + x)
+ * @returns the value
+ */
+static double RaveGraInternal_getRawValue(const void* data, RaveDataType type, long index)
+{
+  switch (type) {
+  case RaveDataType_CHAR:
+    return ((const char*)data)[index];
+  case RaveDataType_UCHAR:
+    return ((const unsigned char*)data)[index];
+  case RaveDataType_SHORT:
+    return ((const short*)data)[index];
+  case RaveDataType_USHORT:
+    return ((const unsigned short*)data)[index];
+  case RaveDataType_INT:
+    return ((const int*)data)[index];
+  case RaveDataType_UINT:
+    return ((const unsigned int*)data)[index];
+  case RaveDataType_LONG:
+    return ((const long*)data)[index];
+  case RaveDataType_ULONG:
+    return ((const unsigned long*)data)[index];
+  case RaveDataType_FLOAT:
+    return ((const float*)data)[index];
+  case RaveDataType_DOUBLE:
+    return ((const double*)data)[index];
+  default:
+    return 0.0;
   }
-  return result;
 }
 
 /**
- * Applies the gra coefficient on reflectivity by converting the dbz to mm/h using zrA and zrb.
- * @param[in] self - self
- * @param[in] distance - the distance to the radar for this value. in unit km.
- * @param[in] value - the MM/H
- * @param[in] dtype - the data type
- * @returns the corrected value
+ * Arguments when applying the coefficients to a set of rows
+ */
+typedef struct RaveGraJob_t {
+  RaveGra_t* self;              /**< the gra */
+  CartesianParam_t* param;      /**< the parameter that is adjusted in place */
+  const void* distance;         /**< the raw distance data */
+  RaveDataType distanceType;    /**< the distance data type */
+  double dgain;                 /**< distance gain */
+  double doffset;               /**< distance offset */
+  double* factors;              /**< factor per raw distance value for integer distance fields, otherwise NULL */
+  long factorsOffset;           /**< the raw distance value of factors[0] */
+  double gain;                  /**< parameter gain */
+  double offset;                /**< parameter offset */
+  int acrr;                     /**< if parameter is ACRR, otherwise reflectivity */
+  long xsize;                   /**< xsize */
+  long ysize;                   /**< ysize */
+} RaveGraJob_t;
+
+/**
+ * Creates the table with one factor per distinct raw distance value when the distance
+ * field is of an integer type with at most 16 bits. Other distance fields are computed
+ * pixel by pixel.
+ * @param[in] job - the job
+ * @return 1 on success or if no table is needed, 0 on memory failure
+ */
+static int RaveGraInternal_createFactors(RaveGraJob_t* job)
+{
+  long i = 0, n = job->xsize * job->ysize;
+  long minv = 0, maxv = 0;
+
+  if (job->distanceType != RaveDataType_CHAR && job->distanceType != RaveDataType_UCHAR &&
+      job->distanceType != RaveDataType_SHORT && job->distanceType != RaveDataType_USHORT) {
+    return 1;
+  }
+  if (n <= 0) {
+    return 1;
+  }
+  minv = maxv = (long)RaveGraInternal_getRawValue(job->distance, job->distanceType, 0);
+  for (i = 1; i < n; i++) {
+    long v = (long)RaveGraInternal_getRawValue(job->distance, job->distanceType, i);
+    minv = RAVEMIN(minv, v);
+    maxv = RAVEMAX(maxv, v);
+  }
+  job->factors = RAVE_MALLOC(sizeof(double) * (maxv - minv + 1));
+  if (job->factors == NULL) {
+    RAVE_ERROR0("Failed to allocate memory for distance factors");
+    return 0;
+  }
+  job->factorsOffset = minv;
+  for (i = minv; i <= maxv; i++) {
+    job->factors[i - minv] = RaveGraInternal_getFactor(job->self, (job->doffset + job->dgain * (double)i) / 1000.0);
+  }
+  return 1;
+}
+
+/**
+ * Applies the coefficients to one row. In the case of ACRR the factor is applied directly on
+ * the MM/H. For reflectivity the dbz is converted to mm/h using zrA and zrb, adjusted and converted back.
  */
-static double applyReflectivity(RaveGra_t* self, double distance, double value, RaveValueType dtype)
+static void RaveGraInternal_applyRow(RaveGraJob_t* job, long y)
 {
-  double result = value;
-
-  if (dtype == RaveValueType_DATA) {
-    double F = (self->A + self->B * distance + self->C * distance * distance) / 10.0;
-    F = RAVEMIN(F, self->upperThreshold);
-    F = RAVEMAX(F, self->lowerThreshold);
-    result = dBZ2R(value, self->zrA, self->zrb) * pow(10.0, F);
-    if (result < self->lowerThreshold) {
-      result = 0.0;
+  RaveGra_t* self = job->self;
+  long x = 0;
+  double lastdist = 0.0, lastfactor = 0.0;
+  int haslast = 0;
+
+  for (x = 0; x < job->xsize; x++) {
+    double v = 0.0, factor = 0.0, result = 0.0;
+    double dist = RaveGraInternal_getRawValue(job->distance, job->distanceType, y * job->xsize + x);
+    if (CartesianParam_getValue(job->param, x, y, &v) != RaveValueType_DATA) {
+      continue;
+    }
+    if (job->factors != NULL) {
+      factor = job->factors[(long)dist - job->factorsOffset];
+    } else if (haslast && dist == lastdist) {
+      factor = lastfactor;
+    } else {
+      factor = RaveGraInternal_getFactor(self, (job->doffset + job->dgain * dist) / 1000.0);
+      lastdist = dist;
+      lastfactor = factor;
+      haslast = 1;
     }
-    result = R2dBZ(result, self->zrA, self->zrb);
+    v = v * job->gain + job->offset;
+    if (job->acrr) {
+      result = v * factor;
+      if (result < self->lowerThreshold) {
+        result = 0.0;
+      }
+    } else {
+      result = dBZ2R(v, self->zrA, self->zrb) * factor;
+      if (result < self->lowerThreshold) {
+        result = 0.0;
+      }
+      result = R2dBZ(result, self->zrA, self->zrb);
+    }
+    CartesianParam_setValue(job->param, x, y, (result - job->offset) / job->gain);
   }
-  return result;
+}
+
+/**
+ * Row function for \ref RaveRowPool_run.
+ */
+static int RaveGraInternal_processRow(void* arg, void* worker, long y)
+{
+  RaveGraInternal_applyRow((RaveGraJob_t*)arg, y);
+  return 1;
 }
 
 CartesianParam_t* RaveGra_apply(RaveGra_t* self, RaveField_t* distance, CartesianParam_t* parameter)
@@ -256,15 +384,14 @@ CartesianParam_t* RaveGra_apply(RaveGra_t* self, RaveField_t* distance, Cartesia
   CartesianParam_t* result = NULL;
   CartesianParam_t* grafield = NULL;
   RaveAttribute_t* howTaskArgs = NULL;
-
-  long x = 0, y = 0, xsize = 0, ysize = 0;
+  RaveGraJob_t job;
   const char* quantity;
-  double dgain = 0.0, doffset = 0.0;
-  double (*applyGra)(RaveGra_t*, double, double, RaveValueType) = applyReflectivity; /* FP using applyAcrr or applyReflectivity */
   char coeffs[256];
 
   RAVE_ASSERT((self != NULL), "self == NULL");
 
+  memset(&job, 0, sizeof(RaveGraJob_t));
+
   if (distance == NULL || parameter == NULL) {
     RAVE_ERROR0("Neither distance field or cartesian parameter may be NULL");
     goto fail;
@@ -277,25 +404,39 @@ CartesianParam_t* RaveGra_apply(RaveGra_t* self, RaveField_t* distance, Cartesia
   }
 
   grafield = RAVE_OBJECT_CLONE(parameter);
-  xsize = CartesianParam_getXSize(grafield);
-  ysize = CartesianParam_getYSize(grafield);
+  if (grafield == NULL) {
+    RAVE_ERROR0("Failed to clone parameter");
+    goto fail;
+  }
+
+  job.self = self;
+  job.param = grafield;
+  job.xsize = CartesianParam_getXSize(grafield);
+  job.ysize = CartesianParam_getYSize(grafield);
+  job.gain = CartesianParam_getGain(grafield);
+  job.offset = CartesianParam_getOffset(grafield);
+  job.distance = RaveField_getReadOnlyData(distance);
+  job.distanceType = RaveField_getDataType(distance);
+  job.doffset = RaveGraInternal_getAttributeDoubleValueFromField(distance, "what/offset", 0.0);
+  job.dgain = RaveGraInternal_getAttributeDoubleValueFromField(distance, "what/gain", 1.0);
   quantity = CartesianParam_getQuantity(grafield);
-  if (quantity != NULL && strcmp("ACRR", quantity) == 0) {
-    applyGra = applyAcrr;
+  job.acrr = (quantity != NULL && strcmp("ACRR", quantity) == 0) ? 1 : 0;
+
+  if (job.gain == 0.0) {
+    RAVE_ERROR0("gain is 0.0 => division by zero error");
+    goto fail;
   }
-  doffset = RaveGraInternal_getAttributeDoubleValueFromField(distance, "what/offset", 0.0);
-  dgain = RaveGraInternal_getAttributeDoubleValueFromField(distance, "what/gain", 1.0);
-
-  for (y = 0; y < ysize; y++) {
-    for (x = 0; x < xsize; x++) {
-      RaveValueType dt = RaveValueType_UNDEFINED;
-      double v = 0.0, dist = 0.0;
-      dt = CartesianParam_getConvertedValue(grafield, x, y, &v);
-      RaveField_getValue(distance, x, y, &dist);
-      double distanceInMeters = doffset + dgain*dist;
-      CartesianParam_setConvertedValue(grafield, x, y, applyGra(self, distanceInMeters/1000.0, v, dt), dt);
-    }
+  /* The distance field is only read, the clone gets its own data before the workers start to write to it */
+  if (job.distance == NULL || CartesianParam_getData(grafield) == NULL) {
+    RAVE_ERROR0("Distance field and cartesian parameter must contain data");
+    goto fail;
   }
+  if (!RaveGraInternal_createFactors(&job)) {
+    goto fail;
+  }
+
+  RaveRowPool_run(job.ysize, self->nthreads, RaveGraInternal_processRow, NULL, NULL, &job);
+
   sprintf(coeffs, "GRA: A=%f, B=%f, C=%f, low_db=%f, high_db=%f",self->A, self->B, self->C, self->lowerThreshold, self->upperThreshold);
   howTaskArgs = RaveAttributeHelp_createString("how/task_args", coeffs);
   if (howTaskArgs == NULL || !CartesianParam_addAttribute(grafield, howTaskArgs)) {
@@ -304,6 +445,7 @@ CartesianParam_t* RaveGra_apply(RaveGra_t* self, RaveField_t* distance, Cartesia
 
   result = RAVE_OBJECT_COPY(grafield);
 fail:
+  RAVE_FREE(job.factors);
   RAVE_OBJECT_RELEASE(grafield);
   RAVE_OBJECT_RELEASE(howTaskArgs);
   return result;
@@ -153,10 +153,26 @@ void RaveGra_setZRB(RaveGra_t* self, double zrb);
  */
 double RaveGra_getZRB(RaveGra_t* self);
 
+/**
+ * Sets the number of threads used when applying the coefficients. Default is 1.
+ * @param[in] self - self
+ * @param[in] nthreads - number of threads (>= 1)
+ * @return 1 on success, 0 if nthreads < 1
+ */
+int RaveGra_setNumberOfThreads(RaveGra_t* self, int nthreads);
+
+/**
+ * @param[in] self - self
+ * @return the number of threads used when applying the coefficients
+ */
+int RaveGra_getNumberOfThreads(RaveGra_t* self);
+
 /**
  * Applies the coefficients on the parameter field. The distance field dimensions must match the parameter dimensions.
  * If the quantity is ACRR, then no conversion of the value is required. If the quantity is any of DBZH, DBZV, TH or TV, then
  * the values are converted to MM/H and then back again to reflectivity.
+ * The adjustment factor is computed once per distinct distance value and the rows are processed
+ * by \ref #RaveGra_getNumberOfThreads threads.
  * @param[in] self - self
  * @param[in] distance - the distance field
  * @param[in] parameter - the parameter to convert
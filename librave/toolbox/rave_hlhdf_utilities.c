@@ -28,9 +28,26 @@ along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
 #include "rave_utilities.h"
 #include "string.h"
 #include "stdarg.h"
+#include <stdio.h>
+
+#ifdef PTHREAD_SUPPORTED
+#include <pthread.h>
+#endif
 
 /*@{ Constants */
 
+#ifdef PTHREAD_SUPPORTED
+/**
+ * Serializes all access to the HDF5 library.
+ */
+static pthread_mutex_t hlhdf_mutex;
+
+/**
+ * Ensures that the hlhdf mutex only is initialized once.
+ */
+static pthread_once_t hlhdf_mutex_once = PTHREAD_ONCE_INIT;
+#endif
+
 /**
  * Mapping between hlhdf format and rave data type
  */
@@ -129,6 +146,35 @@ const char* QUANTITIES_20_to_22[][2] = {
     {NULL, NULL}
 };
 
+/**
+ * A dataset that references data owned by someone else and that will be written
+ * by \ref #RaveHL_writeBorrowedData.
+ */
+typedef struct RaveHLInternal_BorrowedData {
+  char* name;                                /**< name of the dataset */
+  void* data;                                /**< the borrowed data */
+  long xsize;                                /**< xsize */
+  long ysize;                                /**< ysize */
+  RaveDataType dataType;                     /**< the data type */
+  struct RaveHLInternal_BorrowedData* next;  /**< next dataset */
+} RaveHLInternal_BorrowedData;
+
+/**
+ * A nodelist that has borrowed datasets.
+ */
+typedef struct RaveHLInternal_BorrowingNodeList {
+  HL_NodeList* nodelist;                          /**< the nodelist */
+  long ysize;                                     /**< number of rows in the written datasets, 0 means same as the data */
+  RaveHLInternal_BorrowedData* first;             /**< first borrowed dataset */
+  RaveHLInternal_BorrowedData* last;              /**< last borrowed dataset */
+  struct RaveHLInternal_BorrowingNodeList* next;  /**< next nodelist */
+} RaveHLInternal_BorrowingNodeList;
+
+/**
+ * The nodelists that currently borrows data, protected by \ref #RaveHL_lock.
+ */
+static RaveHLInternal_BorrowingNodeList* borrowingNodeLists = NULL;
+
 /*@} End of Constants */
 
 /*@{ Defines */
@@ -995,4 +1041,465 @@ int RaveHL_loadAttributesAndData(HL_NodeList* nodelist, void* object, RaveHL_att
   return result;
 }
 
+/**
+ * Returns the borrowing entry for the nodelist. Caller must hold \ref #RaveHL_lock.
+ * @param[in] nodelist - the nodelist
+ * @return the entry or NULL if nodelist isn't borrowing data
+ */
+static RaveHLInternal_BorrowingNodeList* RaveHLInternal_getBorrowingNodeList(HL_NodeList* nodelist)
+{
+  RaveHLInternal_BorrowingNodeList* entry = borrowingNodeLists;
+  while (entry != NULL && entry->nodelist != nodelist) {
+    entry = entry->next;
+  }
+  return entry;
+}
+
+/**
+ * Returns the native HDF5 type for the rave data type.
+ * @param[in] dataType - the rave data type
+ * @return the hdf5 type or -1 if not supported
+ */
+static hid_t RaveHLInternal_getNativeType(RaveDataType dataType)
+{
+  switch (dataType) {
+  case RaveDataType_CHAR: return H5T_NATIVE_SCHAR;
+  case RaveDataType_UCHAR: return H5T_NATIVE_UCHAR;
+  case RaveDataType_SHORT: return H5T_NATIVE_SHORT;
+  case RaveDataType_USHORT: return H5T_NATIVE_USHORT;
+  case RaveDataType_INT: return H5T_NATIVE_INT;
+  case RaveDataType_UINT: return H5T_NATIVE_UINT;
+  case RaveDataType_LONG: return H5T_NATIVE_LONG;
+  case RaveDataType_ULONG: return H5T_NATIVE_ULONG;
+  case RaveDataType_FLOAT: return H5T_NATIVE_FLOAT;
+  case RaveDataType_DOUBLE: return H5T_NATIVE_DOUBLE;
+  default: return -1;
+  }
+}
+
+/**
+ * Picks the innermost description from the HDF5 error stack.
+ */
+static herr_t RaveHLInternal_walkH5Error(unsigned n, const H5E_error2_t* err, void* data)
+{
+  char* desc = (char*)data;
+  if (n == 0 && err != NULL && err->desc != NULL) {
+    strncpy(desc, err->desc, 255);
+    desc[255] = '\0';
+  }
+  return 0;
+}
+
+/**
+ * Reports a failed HDF5 call together with the reason from the HDF5 error stack. The raw HDF5
+ * calls are made within H5E_BEGIN_TRY so that the error is reported once through the rave
+ * debugger instead of HDF5 printing its stack, which is the same way the HLHDF calls behave.
+ * Must be called before the error stack is cleared, i.e. before any other HDF5 call.
+ * @param[in] what - what failed
+ * @param[in] name - the file or dataset name
+ */
+static void RaveHLInternal_reportH5Error(const char* what, const char* name)
+{
+  char desc[256];
+  strcpy(desc, "unknown reason");
+  H5Ewalk2(H5E_DEFAULT, H5E_WALK_DOWNWARD, RaveHLInternal_walkH5Error, desc);
+  RAVE_ERROR3("%s %s: %s", what, name, desc);
+}
+
+/**
+ * Writes a fixed length string attribute on a hdf5 object.
+ * @param[in] loc - the object
+ * @param[in] name - the attribute name
+ * @param[in] value - the value
+ * @return 1 on success otherwise 0
+ */
+static int RaveHLInternal_writeStringAttribute(hid_t loc, const char* name, const char* value)
+{
+  hid_t type = -1, space = -1, attr = -1;
+  int result = 0;
+
+  if ((type = H5Tcopy(H5T_C_S1)) < 0 ||
+      H5Tset_size(type, strlen(value) + 1) < 0 ||
+      H5Tset_strpad(type, H5T_STR_NULLTERM) < 0 ||
+      (space = H5Screate(H5S_SCALAR)) < 0 ||
+      (attr = H5Acreate2(loc, name, type, space, H5P_DEFAULT, H5P_DEFAULT)) < 0 ||
+      H5Awrite(attr, type, value) < 0) {
+    goto done;
+  }
+  result = 1;
+done:
+  if (attr >= 0) H5Aclose(attr);
+  if (space >= 0) H5Sclose(space);
+  if (type >= 0) H5Tclose(type);
+  return result;
+}
+
+/**
+ * Writes one borrowed dataset into the file.
+ * @param[in] file - the open file
+ * @param[in] bd - the borrowed dataset
+ * @param[in] compression - the compression to use
+ * @return 1 on success otherwise 0
+ */
+static int RaveHLInternal_writeBorrowedDataset(hid_t file, RaveHLInternal_BorrowedData* bd, long ysize, HL_Compression* compression)
+{
+  hid_t space = -1, memspace = -1, plist = -1, dataset = -1;
+  hid_t type = RaveHLInternal_getNativeType(bd->dataType);
+  hsize_t dims[2], chunk[2], start[2] = {0, 0};
+  int result = 0;
+
+  chunk[0] = (hsize_t)bd->ysize;
+  chunk[1] = (hsize_t)bd->xsize;
+  dims[0] = (hsize_t)(ysize > bd->ysize ? ysize : bd->ysize);
+  dims[1] = (hsize_t)bd->xsize;
+
+  if (type < 0) {
+    RAVE_ERROR1("Unsupported data type for %s", bd->name);
+    goto done;
+  }
+
+  if ((space = H5Screate_simple(2, dims, NULL)) < 0 ||
+      (memspace = H5Screate_simple(2, chunk, NULL)) < 0 ||
+      (plist = H5Pcreate(H5P_DATASET_CREATE)) < 0) {
+    RaveHLInternal_reportH5Error("Failed to create dataspace for", bd->name);
+    goto done;
+  }
+
+  /* Same layout as HLHDF uses, one chunk per dataset or per block of rows */
+  if (compression != NULL && compression->type == CT_ZLIB && compression->level > 0) {
+    if (H5Pset_chunk(plist, 2, chunk) < 0 || H5Pset_deflate(plist, compression->level) < 0) {
+      RaveHLInternal_reportH5Error("Failed to set compression for", bd->name);
+      goto done;
+    }
+  }
+
+  if ((dataset = H5Dcreate2(file, bd->name, type, space, H5P_DEFAULT, plist, H5P_DEFAULT)) < 0) {
+    RaveHLInternal_reportH5Error("Failed to create dataset", bd->name);
+    goto done;
+  }
+
+  if (H5Sselect_hyperslab(space, H5S_SELECT_SET, start, NULL, chunk, NULL) < 0 ||
+      H5Dwrite(dataset, type, memspace, space, H5P_DEFAULT, bd->data) < 0) {
+    RaveHLInternal_reportH5Error("Failed to write dataset", bd->name);
+    goto done;
+  }
+
+  if (bd->dataType == RaveDataType_UCHAR) {
+    if (!RaveHLInternal_writeStringAttribute(dataset, "CLASS", "IMAGE") ||
+        !RaveHLInternal_writeStringAttribute(dataset, "IMAGE_VERSION", "1.2")) {
+      RaveHLInternal_reportH5Error("Failed to write image attributes for", bd->name);
+      goto done;
+    }
+  }
+
+  result = 1;
+done:
+  if (dataset >= 0) H5Dclose(dataset);
+  if (plist >= 0) H5Pclose(plist);
+  if (memspace >= 0) H5Sclose(memspace);
+  if (space >= 0) H5Sclose(space);
+  return result;
+}
+
+HL_FileCreationProperty* RaveHL_createFileCreationProperty(void)
+{
+  HL_FileCreationProperty* property = HLFileCreationProperty_new();
+  if (property == NULL) {
+    RAVE_ERROR0("Failed to create file creation properties");
+    return NULL;
+  }
+  property->userblock = (hsize_t)0;
+  property->sizes.sizeof_size = (size_t)4;
+  property->sizes.sizeof_addr = (size_t)4;
+  property->sym_k.ik = (int)1;
+  property->sym_k.lk = (int)1;
+  property->istore_k = (long)1;
+  property->meta_block_size = (long)0;
+  return property;
+}
+
+int RaveHL_beginBorrowedData(HL_NodeList* nodelist, HL_Compression* compression)
+{
+  RaveHLInternal_BorrowingNodeList* entry = NULL;
+  int result = 0;
+
+  RAVE_ASSERT((nodelist != NULL), "nodelist == NULL");
+
+  if (compression != NULL && compression->type != CT_NONE && compression->type != CT_ZLIB) {
+    return 0; /* Let HLHDF handle other compressions */
+  }
+
+  RaveHL_lock();
+  if (RaveHLInternal_getBorrowingNodeList(nodelist) == NULL) {
+    entry = RAVE_MALLOC(sizeof(RaveHLInternal_BorrowingNodeList));
+    if (entry == NULL) {
+      RAVE_ERROR0("Failed to allocate memory for borrowing nodelist");
+      goto done;
+    }
+    entry->nodelist = nodelist;
+    entry->ysize = 0;
+    entry->first = entry->last = NULL;
+    entry->next = borrowingNodeLists;
+    borrowingNodeLists = entry;
+  }
+  result = 1;
+done:
+  RaveHL_unlock();
+  return result;
+}
+
+int RaveHL_setBorrowedDataRows(HL_NodeList* nodelist, long ysize)
+{
+  RaveHLInternal_BorrowingNodeList* entry = NULL;
+  int result = 0;
+
+  RAVE_ASSERT((nodelist != NULL), "nodelist == NULL");
+
+  RaveHL_lock();
+  entry = RaveHLInternal_getBorrowingNodeList(nodelist);
+  if (entry != NULL) {
+    entry->ysize = ysize;
+    result = 1;
+  }
+  RaveHL_unlock();
+  return result;
+}
+
+int RaveHL_addBorrowedData(HL_NodeList* nodelist, void* data, long xsize, long ysize, RaveDataType dataType, const char* fmt, ...)
+{
+  RaveHLInternal_BorrowingNodeList* entry = NULL;
+  RaveHLInternal_BorrowedData* bd = NULL;
+  char nodeName[1024];
+  va_list ap;
+  int n = 0;
+  int result = 0;
+
+  RAVE_ASSERT((nodelist != NULL), "nodelist == NULL");
+
+  va_start(ap, fmt);
+  n = vsnprintf(nodeName, 1024, fmt, ap);
+  va_end(ap);
+  if (n < 0 || n >= 1024) {
+    RAVE_ERROR0("Failed to generate name for data entry");
+    return 0;
+  }
+
+  if (data == NULL) {
+    return 0;
+  }
+
+  RaveHL_lock();
+  entry = RaveHLInternal_getBorrowingNodeList(nodelist);
+  if (entry == NULL || RaveHLInternal_getNativeType(dataType) < 0) {
+    RaveHL_unlock();
+    return RaveHL_addData(nodelist, data, xsize, ysize, dataType, "%s", nodeName);
+  }
+
+  bd = RAVE_MALLOC(sizeof(RaveHLInternal_BorrowedData));
+  if (bd == NULL) {
+    RAVE_ERROR0("Failed to allocate memory for borrowed data");
+    goto done;
+  }
+  bd->name = RAVE_MALLOC(strlen(nodeName) + 6);
+  if (bd->name == NULL) {
+    RAVE_ERROR0("Failed to allocate memory for borrowed data");
+    RAVE_FREE(bd);
+    goto done;
+  }
+  sprintf(bd->name, "%s/data", nodeName);
+  bd->data = data;
+  bd->xsize = xsize;
+  bd->ysize = ysize;
+  bd->dataType = dataType;
+  bd->next = NULL;
+  if (entry->last == NULL) {
+    entry->first = bd;
+  } else {
+    entry->last->next = bd;
+  }
+  entry->last = bd;
+
+  result = 1;
+done:
+  RaveHL_unlock();
+  return result;
+}
+
+/**
+ * Writes all borrowed datasets of the entry into the file. Should be called within
+ * H5E_BEGIN_TRY since errors are reported by \ref #RaveHLInternal_reportH5Error.
+ * @param[in] filename - the file written by HLNodeList_write
+ * @param[in] entry - the borrowing nodelist
+ * @param[in] compression - the compression to use
+ * @return 1 on success otherwise 0
+ */
+static int RaveHLInternal_writeBorrowedDatasets(const char* filename, RaveHLInternal_BorrowingNodeList* entry, HL_Compression* compression)
+{
+  RaveHLInternal_BorrowedData* bd = NULL;
+  hid_t file = -1;
+  int result = 0;
+
+  file = H5Fopen(filename, H5F_ACC_RDWR, H5P_DEFAULT);
+  if (file < 0) {
+    RaveHLInternal_reportH5Error("Failed to open for writing datasets", filename);
+    goto done;
+  }
+
+  for (bd = entry->first; bd != NULL; bd = bd->next) {
+    if (!RaveHLInternal_writeBorrowedDataset(file, bd, entry->ysize, compression)) {
+      goto done;
+    }
+  }
+
+  result = 1;
+done:
+  if (file >= 0) {
+    if (H5Fclose(file) < 0) {
+      RaveHLInternal_reportH5Error("Failed to close", filename);
+      result = 0;
+    }
+  }
+  return result;
+}
+
+int RaveHL_writeBorrowedData(HL_NodeList* nodelist, HL_Compression* compression)
+{
+  RaveHLInternal_BorrowingNodeList* entry = NULL;
+  const char* filename = NULL;
+  int result = 0;
+
+  RAVE_ASSERT((nodelist != NULL), "nodelist == NULL");
+
+  RaveHL_lock();
+  entry = RaveHLInternal_getBorrowingNodeList(nodelist);
+  if (entry == NULL || entry->first == NULL) {
+    result = 1;
+  } else {
+    filename = HLNodeList_getFileName(nodelist);
+    H5E_BEGIN_TRY {
+      result = RaveHLInternal_writeBorrowedDatasets(filename, entry, compression);
+    } H5E_END_TRY;
+    if (!result) {
+      /* Never leave a file behind that looks like a product but lacks some of its data */
+      remove(filename);
+    }
+  }
+  RaveHL_unlock();
+  return result;
+}
+
+/**
+ * Writes rows into a dataset, see \ref #RaveHL_writeDataRows. Should be called within
+ * H5E_BEGIN_TRY since errors are reported by \ref #RaveHLInternal_reportH5Error.
+ */
+static int RaveHLInternal_writeDataRows(hid_t file, const char* name, void* data, long xsize, long ysize, hid_t type, long yoffset)
+{
+  hid_t dataset = -1, space = -1, memspace = -1;
+  hsize_t dims[2], start[2], count[2];
+  int result = 0;
+
+  if ((dataset = H5Dopen2(file, name, H5P_DEFAULT)) < 0) {
+    RaveHLInternal_reportH5Error("No dataset called", name);
+    goto done;
+  }
+  if ((space = H5Dget_space(dataset)) < 0 ||
+      H5Sget_simple_extent_ndims(space) != 2 ||
+      H5Sget_simple_extent_dims(space, dims, NULL) < 0) {
+    RaveHLInternal_reportH5Error("Failed to get 2-dimensional dataspace for", name);
+    goto done;
+  }
+  if (dims[1] != (hsize_t)xsize || yoffset < 0 || (hsize_t)(yoffset + ysize) > dims[0]) {
+    RAVE_ERROR1("Rows does not fit into dataset %s", name);
+    goto done;
+  }
+  start[0] = (hsize_t)yoffset;
+  start[1] = 0;
+  count[0] = (hsize_t)ysize;
+  count[1] = (hsize_t)xsize;
+  if ((memspace = H5Screate_simple(2, count, NULL)) < 0 ||
+      H5Sselect_hyperslab(space, H5S_SELECT_SET, start, NULL, count, NULL) < 0 ||
+      H5Dwrite(dataset, type, memspace, space, H5P_DEFAULT, data) < 0) {
+    RaveHLInternal_reportH5Error("Failed to write rows to", name);
+    goto done;
+  }
+  result = 1;
+done:
+  if (memspace >= 0) H5Sclose(memspace);
+  if (space >= 0) H5Sclose(space);
+  if (dataset >= 0) H5Dclose(dataset);
+  return result;
+}
+
+int RaveHL_writeDataRows(hid_t file, const char* name, void* data, long xsize, long ysize, RaveDataType dataType, long yoffset)
+{
+  hid_t type = RaveHLInternal_getNativeType(dataType);
+  int result = 0;
+
+  RAVE_ASSERT((name != NULL), "name == NULL");
+
+  if (data == NULL || type < 0) {
+    RAVE_ERROR1("No data or unsupported data type for %s", name);
+    return 0;
+  }
+
+  RaveHL_lock();
+  H5E_BEGIN_TRY {
+    result = RaveHLInternal_writeDataRows(file, name, data, xsize, ysize, type, yoffset);
+  } H5E_END_TRY;
+  RaveHL_unlock();
+  return result;
+}
+
+void RaveHL_endBorrowedData(HL_NodeList* nodelist)
+{
+  RaveHLInternal_BorrowingNodeList** pentry = NULL;
+
+  RaveHL_lock();
+  for (pentry = &borrowingNodeLists; *pentry != NULL; pentry = &(*pentry)->next) {
+    if ((*pentry)->nodelist == nodelist) {
+      RaveHLInternal_BorrowingNodeList* entry = *pentry;
+      RaveHLInternal_BorrowedData* bd = entry->first;
+      while (bd != NULL) {
+        RaveHLInternal_BorrowedData* next = bd->next;
+        RAVE_FREE(bd->name);
+        RAVE_FREE(bd);
+        bd = next;
+      }
+      *pentry = entry->next;
+      RAVE_FREE(entry);
+      break;
+    }
+  }
+  RaveHL_unlock();
+}
+
 /*@} End of Interface functions */
+
+#ifdef PTHREAD_SUPPORTED
+/**
+ * Initializes the recursive hlhdf mutex.
+ */
+static void RaveHLInternal_initializeMutex(void)
+{
+  pthread_mutexattr_t attr;
+  pthread_mutexattr_init(&attr);
+  pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&hlhdf_mutex, &attr);
+  pthread_mutexattr_destroy(&attr);
+}
+#endif
+
+void RaveHL_lock(void)
+{
+#ifdef PTHREAD_SUPPORTED
+  pthread_once(&hlhdf_mutex_once, RaveHLInternal_initializeMutex);
+  pthread_mutex_lock(&hlhdf_mutex);
+#endif
+}
+
+void RaveHL_unlock(void)
+{
+#ifdef PTHREAD_SUPPORTED
+  pthread_mutex_unlock(&hlhdf_mutex);
+#endif
+}
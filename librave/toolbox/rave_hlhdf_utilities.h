@@ -296,4 +296,92 @@ RaveDataType RaveHL_hlhdfToRaveType(HL_FormatSpecifier format);
  */
 int RaveHL_loadAttributesAndData(HL_NodeList* nodelist, void* object, RaveHL_attr_f attrf, RaveHL_data_f dataf, const char* fmt, ...);
 
+/**
+ * Creates the file creation properties that rave uses when writing ODIM H5 files.
+ * @return the properties, should be released with HLFileCreationProperty_free, or NULL on failure
+ */
+HL_FileCreationProperty* RaveHL_createFileCreationProperty(void);
+
+/**
+ * Lets datasets that are added to the nodelist with \ref #RaveHL_addBorrowedData reference the
+ * callers data instead of copying it into HLHDF nodes. The datasets are written directly into the
+ * file by \ref #RaveHL_writeBorrowedData after HLNodeList_write has created the file. This avoids
+ * a full copy of every dataset when writing large products.
+ * Must be followed by \ref #RaveHL_endBorrowedData when the nodelist has been written.
+ * @param[in] nodelist - the nodelist
+ * @param[in] compression - the compression that will be used when writing (only zlib and no compression can be handled)
+ * @return 1 if the nodelist borrows data, 0 if datasets will be copied as usual
+ */
+int RaveHL_beginBorrowedData(HL_NodeList* nodelist, HL_Compression* compression);
+
+/**
+ * Makes the borrowed datasets of the nodelist ysize rows high in the file while only the rows of the
+ * borrowed data are written, starting at row 0. When compressing, each dataset is chunked by the number
+ * of rows in the borrowed data so that the remaining rows can be written block by block afterwards.
+ * Used when writing products in blocks of rows.
+ * @param[in] nodelist - a nodelist that borrows data, see \ref #RaveHL_beginBorrowedData
+ * @param[in] ysize - the number of rows in the written datasets
+ * @return 1 on success, 0 if the nodelist doesn't borrow data
+ */
+int RaveHL_setBorrowedDataRows(HL_NodeList* nodelist, long ysize);
+
+/**
+ * Same as \ref #RaveHL_addData but if \ref #RaveHL_beginBorrowedData has been called for the nodelist,
+ * the data is only referenced and must be kept alive and unmodified until \ref #RaveHL_writeBorrowedData
+ * has been called. Otherwise the data is copied.
+ * @param[in] nodelist - the node list that should get nodes added
+ * @param[in] data - the array data
+ * @param[in] xsize - the xsize
+ * @param[in] ysize - the ysize
+ * @param[in] dataType - type of data
+ * @param[in] fmt - the varargs format
+ * @param[in] ... - the vararg list
+ * @returns 1 on success otherwise 0
+ */
+int RaveHL_addBorrowedData(HL_NodeList* nodelist, void* data, long xsize, long ysize, RaveDataType dataType, const char* fmt, ...);
+
+/**
+ * Writes the borrowed datasets into the file that has been written with HLNodeList_write. The
+ * datasets are written with the HDF5 API under \ref #RaveHL_lock and any HDF5 error is reported
+ * through the rave debugger. If writing fails, the incomplete file is removed.
+ * @param[in] nodelist - the nodelist that has been written
+ * @param[in] compression - the compression to use
+ * @return 1 on success otherwise 0
+ */
+int RaveHL_writeBorrowedData(HL_NodeList* nodelist, HL_Compression* compression);
+
+/**
+ * Writes rows into an existing 2-dimensional dataset. The rows are written under \ref #RaveHL_lock
+ * and any HDF5 error is reported through the rave debugger.
+ * @param[in] file - an open hdf5 file
+ * @param[in] name - the dataset name
+ * @param[in] data - the rows
+ * @param[in] xsize - the xsize, must be same as in the dataset
+ * @param[in] ysize - number of rows
+ * @param[in] dataType - the data type of the rows
+ * @param[in] yoffset - the first row in the dataset to write
+ * @return 1 on success otherwise 0
+ */
+int RaveHL_writeDataRows(hid_t file, const char* name, void* data, long xsize, long ysize, RaveDataType dataType, long yoffset);
+
+/**
+ * Releases the references to the borrowed datasets for the nodelist.
+ * @param[in] nodelist - the nodelist
+ */
+void RaveHL_endBorrowedData(HL_NodeList* nodelist);
+
+/**
+ * Acquires the process wide lock that serializes all calls into the HDF5 library. HDF5 is normally
+ * not built thread safe so any code that reads or writes files through HLHDF while other threads
+ * might do the same (e.g. when the python bindings have released the GIL) must hold this lock.
+ * The lock is recursive so it is safe to acquire it more than once from the same thread.
+ * If the toolbox has been built without pthread support, this function does nothing.
+ */
+void RaveHL_lock(void);
+
+/**
+ * Releases the lock acquired with \ref #RaveHL_lock.
+ */
+void RaveHL_unlock(void);
+
 #endif /* RAVE_HLHDF_UTILITIES_H */
@@ -27,6 +27,7 @@ along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
 #include "rave_debug.h"
 #include "rave_alloc.h"
 #include "rave_utilities.h"
+#include "rave_stats.h"
 #include "rave_data2d.h"
 #include "hlhdf.h"
 #include "hlhdf_alloc.h"
@@ -51,6 +52,16 @@ along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
 #include "rave_bufr_io.h"
 #endif
 
+#include <stdlib.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U /**< from linux/memfd.h, not exported by older C libraries */
+#endif
+
 
 /**
  * Defines the structure for the RaveIO in a volume.
@@ -68,8 +79,19 @@ struct _RaveIO_t {
   HL_FileCreationProperty* property;       /**< the file creation properties */
   char* bufrTableDir;                      /**< the bufr table dir */
   char error_message[1024];                /**< if an error occurs during writing an error message might give you the reason */
+  int memoryfd;                            /**< descriptor of the memory file being loaded, handed over to the lazy reader */
 };
 
+/**
+ * A file that only exists in memory, used when reading from or writing to memory buffers since
+ * HDF5 files are opened by name through HLHDF.
+ */
+typedef struct RaveIOMemoryFile {
+  int fd;           /**< the file descriptor, -1 if not open */
+  int anonymous;    /**< 1 if an anonymous memory file, 0 if a temporary file that is removed when closed */
+  char path[1024];  /**< the name to open the file with */
+} RaveIOMemoryFile;
+
 /*@{ Constants */
 static const char RaveIO_ODIM_Version_2_0_STR[] = "ODIM_H5/V2_0";
 static const char RaveIO_ODIM_Version_2_1_STR[] = "ODIM_H5/V2_1";
@@ -99,21 +121,15 @@ static int RaveIO_constructor(RaveCoreObject* obj)
   raveio->fileFormat = RaveIO_ODIM_FileFormat_UNDEFINED;
   raveio->filename = NULL;
   raveio->compression = HLCompression_new(CT_ZLIB);
-  raveio->property = HLFileCreationProperty_new();
+  raveio->property = RaveHL_createFileCreationProperty();
   raveio->bufrTableDir = NULL;
+  raveio->memoryfd = -1;
   strcpy(raveio->error_message, "");
   if (raveio->compression == NULL || raveio->property == NULL) {
     RAVE_ERROR0("Failed to create compression or file creation properties");
     goto done;
   }
   raveio->compression->level = (int)6;
-  raveio->property->userblock = (hsize_t)0;
-  raveio->property->sizes.sizeof_size = (size_t)4;
-  raveio->property->sizes.sizeof_addr = (size_t)4;
-  raveio->property->sym_k.ik = (int)1;
-  raveio->property->sym_k.lk = (int)1;
-  raveio->property->istore_k = (long)1;
-  raveio->property->meta_block_size = (long)0;
 
   result = 1;
 done:
@@ -475,6 +491,13 @@ static int RaveIOInternal_loadHDF5(RaveIO_t* raveio, int lazyLoading, const char
     goto done;
   }
 
+  if (lazyLoading && raveio->memoryfd >= 0) {
+    /* The data will be read from the memory file later on so the reader must keep it open */
+    if (LazyNodeListReader_setFileDescriptor(lazyReader, raveio->memoryfd)) {
+      raveio->memoryfd = -1;
+    }
+  }
+
   if (lazyLoading) {
     if (preloadQuantities != NULL) {
       if (!LazyNodeListReader_preloadQuantities(lazyReader, preloadQuantities)) {
@@ -528,36 +551,223 @@ done:
 }
 
 #ifdef RAVE_BUFR_SUPPORTED
+/**
+ * Lets a BUFR worker process convert the file to ODIM HDF5 in a temporary file
+ * which is then loaded.
+ * @param[in] raveio - self
+ * @param[in] bufrio - the bufr io instance defining the table dir
+ * @param[out] noworker - set to 1 if no worker was available, 0 otherwise
+ * @return the read object or NULL on failure or if no worker was available
+ */
+static RaveCoreObject* RaveIOInternal_loadBUFRInWorker(RaveIO_t* raveio, RaveBufrIO_t* bufrio, int* noworker)
+{
+  RaveCoreObject* result = NULL;
+  RaveIO_t* tmpio = NULL;
+  const char* tmpdir = getenv("TMPDIR");
+  char tmpfile[1024];
+  int fd = -1;
+  int status = 0;
+
+  *noworker = 0;
+
+  if (tmpdir == NULL || strcmp(tmpdir, "") == 0) {
+    tmpdir = "/tmp";
+  }
+  if (snprintf(tmpfile, 1024, "%s/ravebufrXXXXXX", tmpdir) >= 1024) {
+    RAVE_ERROR0("Temporary directory name too long");
+    return NULL;
+  }
+  fd = mkstemp(tmpfile);
+  if (fd < 0) {
+    RAVE_ERROR1("Failed to create temporary file in %s", tmpdir);
+    return NULL;
+  }
+  close(fd);
+
+  status = RaveBufrIO_convert(bufrio, raveio->filename, tmpfile);
+  if (status > 0) {
+    tmpio = RaveIO_open(tmpfile, 0, NULL);
+    if (tmpio != NULL) {
+      result = RaveIO_getObject(tmpio);
+    }
+  } else if (status < 0) {
+    *noworker = 1;
+  }
+
+  unlink(tmpfile);
+  RAVE_OBJECT_RELEASE(tmpio);
+  return result;
+}
+
 static int RaveIOInternal_loadBUFR(RaveIO_t* raveio)
 {
   RaveBufrIO_t* bufrio = NULL;
+  RaveCoreObject* obj = NULL;
+  int noworker = 0;
   int result = 0;
 
   RAVE_ASSERT((raveio != NULL), "raveio == NULL");
   RAVE_ASSERT((raveio->filename != NULL), "filename == NULL");
 
   bufrio = RAVE_OBJECT_NEW(&RaveBufrIO_TYPE);
-  if (bufrio != NULL) {
-    RaveCoreObject* obj = RaveBufrIO_read(bufrio, raveio->filename);
-    if (obj != NULL) {
-      RAVE_OBJECT_RELEASE(raveio->object);
-      raveio->object = RAVE_OBJECT_COPY(obj);
-      raveio->h5radversion = RaveIO_ODIM_H5rad_Version_UNDEFINED;
-      raveio->version = RaveIO_ODIM_Version_UNDEFINED;
-      raveio->fileFormat = RaveIO_ODIM_FileFormat_BUFR;
-      RAVE_OBJECT_RELEASE(obj);
-    } else {
-      goto done;
-    }
-    result = 1;
+  if (bufrio == NULL) {
+    goto done;
+  }
+  if (raveio->bufrTableDir != NULL && !RaveBufrIO_setTableDir(bufrio, raveio->bufrTableDir)) {
+    goto done;
+  }
+
+  /* Only a hint to avoid the temporary file, the worker slot itself is reserved by RaveBufrIO_convert */
+  if (RaveBufrIO_getMaxWorkers() > 0) {
+    obj = RaveIOInternal_loadBUFRInWorker(raveio, bufrio, &noworker);
+  } else {
+    noworker = 1;
+  }
+  if (noworker) {
+    /* Workers disabled or all of them occupied, decode in this process instead */
+    obj = RaveBufrIO_read(bufrio, raveio->filename);
+  }
+
+  if (obj != NULL) {
+    RAVE_OBJECT_RELEASE(raveio->object);
+    raveio->object = RAVE_OBJECT_COPY(obj);
+    raveio->h5radversion = RaveIO_ODIM_H5rad_Version_UNDEFINED;
+    raveio->version = RaveIO_ODIM_Version_UNDEFINED;
+    raveio->fileFormat = RaveIO_ODIM_FileFormat_BUFR;
+  } else {
+    goto done;
   }
+  result = 1;
 
 done:
+  RAVE_OBJECT_RELEASE(obj);
   RAVE_OBJECT_RELEASE(bufrio);
   return result;
 }
 #endif
 
+/**
+ * Creates a file that only lives in memory. On Linux an anonymous memory file is used which is opened
+ * through /proc/self/fd. Otherwise a temporary file is created in TMPDIR (or /tmp). The descriptor is
+ * closed on exec so that it is not inherited by child processes such as the BUFR workers.
+ * @param[in] mf - the memory file to initialize
+ * @return 1 on success otherwise 0
+ */
+static int RaveIOInternal_createMemoryFile(RaveIOMemoryFile* mf)
+{
+  const char* tmpdir = getenv("TMPDIR");
+  mf->fd = -1;
+  mf->anonymous = 0;
+  strcpy(mf->path, "");
+
+#ifdef SYS_memfd_create
+  mf->fd = (int)syscall(SYS_memfd_create, "raveio", MFD_CLOEXEC);
+  if (mf->fd >= 0) {
+    mf->anonymous = 1;
+    snprintf(mf->path, sizeof(mf->path), "/proc/self/fd/%d", mf->fd);
+    return 1;
+  }
+#endif
+
+  if (tmpdir == NULL || strcmp(tmpdir, "") == 0) {
+    tmpdir = "/tmp";
+  }
+  if (snprintf(mf->path, sizeof(mf->path), "%s/raveioXXXXXX", tmpdir) >= (int)sizeof(mf->path)) {
+    RAVE_ERROR0("Temporary directory name too long");
+    strcpy(mf->path, "");
+    return 0;
+  }
+  mf->fd = mkstemp(mf->path);
+  if (mf->fd < 0) {
+    RAVE_ERROR1("Failed to create temporary file in %s", tmpdir);
+    strcpy(mf->path, "");
+    return 0;
+  }
+  if (fcntl(mf->fd, F_SETFD, FD_CLOEXEC) < 0) {
+    RAVE_ERROR1("Failed to set close on exec for %s", mf->path);
+    close(mf->fd);
+    unlink(mf->path);
+    mf->fd = -1;
+    strcpy(mf->path, "");
+    return 0;
+  }
+  return 1;
+}
+
+/**
+ * Closes the memory file and removes it if it is a temporary file.
+ * @param[in] mf - the memory file
+ */
+static void RaveIOInternal_closeMemoryFile(RaveIOMemoryFile* mf)
+{
+  if (mf->fd >= 0) {
+    close(mf->fd);
+  }
+  if (!mf->anonymous && strcmp(mf->path, "") != 0) {
+    unlink(mf->path);
+  }
+  mf->fd = -1;
+  strcpy(mf->path, "");
+}
+
+/**
+ * Writes the buffer to the memory file.
+ * @param[in] mf - the memory file
+ * @param[in] buffer - the buffer
+ * @param[in] size - the number of bytes
+ * @return 1 on success otherwise 0
+ */
+static int RaveIOInternal_writeMemoryFile(RaveIOMemoryFile* mf, const void* buffer, size_t size)
+{
+  const char* p = (const char*)buffer;
+  while (size > 0) {
+    ssize_t n = write(mf->fd, p, size);
+    if (n <= 0) {
+      RAVE_ERROR0("Failed to write memory file");
+      return 0;
+    }
+    p += n;
+    size -= (size_t)n;
+  }
+  return 1;
+}
+
+/**
+ * Reads the content of the memory file.
+ * @param[in] mf - the memory file
+ * @param[out] buffer - the content, released with RAVE_FREE
+ * @param[out] size - the number of bytes
+ * @return 1 on success otherwise 0
+ */
+static int RaveIOInternal_readMemoryFile(RaveIOMemoryFile* mf, void** buffer, size_t* size)
+{
+  struct stat st;
+  char* data = NULL;
+  size_t pos = 0;
+
+  if (fstat(mf->fd, &st) != 0 || st.st_size <= 0) {
+    RAVE_ERROR0("Failed to determine size of memory file");
+    return 0;
+  }
+  data = RAVE_MALLOC((size_t)st.st_size);
+  if (data == NULL) {
+    RAVE_ERROR0("Failed to allocate memory for file content");
+    return 0;
+  }
+  while (pos < (size_t)st.st_size) {
+    ssize_t n = pread(mf->fd, data + pos, (size_t)st.st_size - pos, (off_t)pos);
+    if (n <= 0) {
+      RAVE_ERROR0("Failed to read memory file");
+      RAVE_FREE(data);
+      return 0;
+    }
+    pos += (size_t)n;
+  }
+  *buffer = data;
+  *size = pos;
+  return 1;
+}
+
 static int RaveIOInternal_writeCF(RaveIO_t* rio)
 {
   int result = 0;
@@ -613,9 +823,67 @@ done:
   return result;
 }
 
+RaveIO_t* RaveIO_openFromMemory(const void* buffer, size_t size, int lazyLoading, const char* preloadQuantities)
+{
+  RaveIO_t* result = NULL;
+  RaveIOMemoryFile mf;
+
+  mf.fd = -1;
+  mf.anonymous = 0;
+  strcpy(mf.path, "");
+
+  if (buffer == NULL || size == 0) {
+    RAVE_ERROR0("Trying to open an empty buffer");
+    goto done;
+  }
+
+  if (!RaveIOInternal_createMemoryFile(&mf) || !RaveIOInternal_writeMemoryFile(&mf, buffer, size)) {
+    goto done;
+  }
+
+  result = RAVE_OBJECT_NEW(&RaveIO_TYPE);
+  if (result == NULL) {
+    RAVE_CRITICAL0("Failed to create raveio instance");
+    goto done;
+  }
+
+  if (!RaveIO_setFilename(result, mf.path)) {
+    RAVE_CRITICAL0("Failed to set filename");
+    RAVE_OBJECT_RELEASE(result);
+    goto done;
+  }
+
+  if (mf.anonymous) {
+    result->memoryfd = mf.fd;
+  } else {
+    lazyLoading = 0; /* The temporary file is removed when we are done */
+  }
+
+  if (!RaveIO_load(result, lazyLoading, preloadQuantities)) {
+    RAVE_WARNING0("Failed to load file from memory");
+    if (mf.anonymous && result->memoryfd < 0) {
+      mf.fd = -1; /* Owned by the lazy reader */
+    }
+    RAVE_OBJECT_RELEASE(result);
+    goto done;
+  }
+
+  if (mf.anonymous && result->memoryfd < 0) {
+    mf.fd = -1; /* Owned by the lazy reader */
+  }
+  result->memoryfd = -1;
+  RAVE_FREE(result->filename); /* The name is only valid as long as the memory file is open */
+
+done:
+  RaveIOInternal_closeMemoryFile(&mf);
+  return result;
+}
+
 int RaveIO_load(RaveIO_t* raveio, int lazyLoading, const char* preloadQuantities)
 {
   int result = 0;
+  int isHdf5 = 0;
+  RAVE_STATS_SCOPE(RaveStats_Timer_IO_READ);
 
   RAVE_ASSERT((raveio != NULL), "raveio == NULL");
 
@@ -624,7 +892,11 @@ int RaveIO_load(RaveIO_t* raveio, int lazyLoading, const char* preloadQuantities
     goto done;
   }
 
-  if(HL_isHDF5File(raveio->filename)) {
+  RaveHL_lock();
+  isHdf5 = HL_isHDF5File(raveio->filename);
+  RaveHL_unlock();
+
+  if(isHdf5) {
     result = RaveIOInternal_loadHDF5(raveio, lazyLoading, preloadQuantities);
 #ifdef RAVE_BUFR_SUPPORTED
   } else if (RaveBufrIO_isBufr(raveio->filename)) {
@@ -634,6 +906,9 @@ int RaveIO_load(RaveIO_t* raveio, int lazyLoading, const char* preloadQuantities
     RAVE_ERROR1("Atempting to load '%s', but file format does not seem to be supported by rave", raveio->filename);
     goto done;
   }
+  if (result) {
+    RAVE_STATS_COUNT(RaveStats_Counter_IO_FILES_READ, 1);
+  }
 
 done:
   return result;
@@ -642,6 +917,7 @@ done:
 int RaveIO_save(RaveIO_t* raveio, const char* filename)
 {
   int result = 0;
+  RAVE_STATS_SCOPE(RaveStats_Timer_IO_WRITE);
   RAVE_ASSERT((raveio != NULL), "raveio == NULL");
 
   strcpy(raveio->error_message, "");
@@ -670,9 +946,13 @@ int RaveIO_save(RaveIO_t* raveio, const char* filename)
         RAVE_OBJECT_CHECK_TYPE(raveio->object, &CartesianVolume_TYPE) ||
         RAVE_OBJECT_CHECK_TYPE(raveio->object, &PolarScan_TYPE) ||
         RAVE_OBJECT_CHECK_TYPE(raveio->object, &VerticalProfile_TYPE)) {
-      HL_NodeList* nodelist = HLNodeList_new();
+      HL_NodeList* nodelist = NULL;
 
+      RaveHL_lock();
+      nodelist = HLNodeList_new();
       if (nodelist != NULL) {
+        /* Datasets are written directly from the objects instead of being copied into the nodelist */
+        RaveHL_beginBorrowedData(nodelist, raveio->compression);
         if (raveio->version == RaveIO_ODIM_Version_2_2) {
           result = RaveHL_createStringValue(nodelist, RaveIO_ODIM_Version_2_2_STR, "/Conventions");
         } else if (raveio->version == RaveIO_ODIM_Version_2_3) {
@@ -708,13 +988,58 @@ int RaveIO_save(RaveIO_t* raveio, const char* filename)
         if (result == 1) {
           result = HLNodeList_write(nodelist, raveio->property, raveio->compression);
         }
+        if (result == 1) {
+          result = RaveHL_writeBorrowedData(nodelist, raveio->compression);
+        }
+        RaveHL_endBorrowedData(nodelist);
       }
       HLNodeList_free(nodelist);
+      RaveHL_unlock();
     }
   } else if (raveio->object != NULL && raveio->fileFormat == RaveIO_FileFormat_CF) {
+    RaveHL_lock(); /* NetCDF-4 is built on top of HDF5 */
     result = RaveIOInternal_writeCF(raveio);
+    RaveHL_unlock();
+  }
+  if (result) {
+    RAVE_STATS_COUNT(RaveStats_Counter_IO_FILES_WRITTEN, 1);
+  }
+
+  return result;
+}
+
+int RaveIO_saveToMemory(RaveIO_t* raveio, void** buffer, size_t* size)
+{
+  int result = 0;
+  char* filename = NULL;
+  RaveIOMemoryFile mf;
+
+  RAVE_ASSERT((raveio != NULL), "raveio == NULL");
+  RAVE_ASSERT((buffer != NULL), "buffer == NULL");
+  RAVE_ASSERT((size != NULL), "size == NULL");
+
+  *buffer = NULL;
+  *size = 0;
+  mf.fd = -1;
+  mf.anonymous = 0;
+  strcpy(mf.path, "");
+
+  if (!RaveIOInternal_createMemoryFile(&mf)) {
+    strcpy(raveio->error_message, "Failed to create memory file");
+    return 0;
+  }
+
+  filename = raveio->filename; /* Restored when done */
+  raveio->filename = NULL;
+  result = RaveIO_save(raveio, mf.path);
+  RAVE_FREE(raveio->filename);
+  raveio->filename = filename;
+
+  if (result) {
+    result = RaveIOInternal_readMemoryFile(&mf, buffer, size);
   }
 
+  RaveIOInternal_closeMemoryFile(&mf);
   return result;
 }
 
@@ -68,16 +68,31 @@ void RaveIO_close(RaveIO_t* raveio);
  *
  * @param[in] filename - the HDF5 file to open
  * @param[in] lazyLoading - if file should be loaded in lazy mode or not
- * @param[in] preloadQuantities - if lazy loading, then these quantities will be loaded immediately.
+ * @param[in] preloadQuantities - if lazy loading, then these quantities will be loaded immediately. Quality fields are matched on how/task.
  * @returns The raveio instance on success, otherwise NULL.
  */
 RaveIO_t* RaveIO_open(const char* filename, int lazyLoading, const char* preloadQuantities);
 
+/**
+ * Opens a supported file from a memory buffer, e.g. a file image fetched from a database or
+ * received over the network, and loads it into the RaveIO instance. The buffer is placed in an
+ * anonymous memory file that HDF5 opens so that the file system is not touched. If lazy loading
+ * is used, the memory file is kept until the loaded object has been released.
+ * Since the content is not associated with a file, the filename of the returned instance is NULL.
+ *
+ * @param[in] buffer - the file content
+ * @param[in] size - the size of the buffer in bytes
+ * @param[in] lazyLoading - if file should be loaded in lazy mode or not
+ * @param[in] preloadQuantities - if lazy loading, then these quantities will be loaded immediately. Quality fields are matched on how/task.
+ * @returns The raveio instance on success, otherwise NULL.
+ */
+RaveIO_t* RaveIO_openFromMemory(const void* buffer, size_t size, int lazyLoading, const char* preloadQuantities);
+
 /**
  * Loads the HDF5 file into the raveio instance.
  * @param[in] raveio - self
  * @param[in] lazyLoading - if file should be loaded in lazy mode or not
- * @param[in] preloadQuantities - if lazy loading, then these quantities will be loaded immediately.*
+ * @param[in] preloadQuantities - if lazy loading, then these quantities will be loaded immediately. Quality fields are matched on how/task.
  * @returns the opened object
  */
 int RaveIO_load(RaveIO_t* raveio, int lazyLoading, const char* preloadQuantities);
@@ -90,6 +105,16 @@ int RaveIO_load(RaveIO_t* raveio, int lazyLoading, const char* preloadQuantities
  */
 int RaveIO_save(RaveIO_t* raveio, const char* filename);
 
+/**
+ * Saves the rave object in the same way as \ref RaveIO_save but returns the file content
+ * instead of writing it to a file. The filename of the instance is not affected.
+ * @param[in] raveio - self
+ * @param[out] buffer - the file content, should be released with RAVE_FREE
+ * @param[out] size - the size of the buffer in bytes
+ * @returns 1 on success, otherwise 0
+ */
+int RaveIO_saveToMemory(RaveIO_t* raveio, void** buffer, size_t* size);
+
 /**
  * Sets the object to be saved.
  * @param[in] raveio - self
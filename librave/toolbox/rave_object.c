@@ -29,6 +29,23 @@ along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
 #include <string.h>
 #include <stdio.h>
 
+/* The Python bindings releases the GIL while running long toolbox operations
+ * so reference counting and the object heap must be thread safe.
+ */
+#ifdef PTHREAD_SUPPORTED
+#include <pthread.h>
+static pthread_mutex_t object_heap_mutex = PTHREAD_MUTEX_INITIALIZER;
+#define RAVE_OBJECT_HEAP_LOCK pthread_mutex_lock(&object_heap_mutex)
+#define RAVE_OBJECT_HEAP_UNLOCK pthread_mutex_unlock(&object_heap_mutex)
+#define RAVE_OBJECT_INCREF(obj) __sync_add_and_fetch(&(obj)->roh_refCnt, 1)
+#define RAVE_OBJECT_DECREF(obj) __sync_sub_and_fetch(&(obj)->roh_refCnt, 1)
+#else
+#define RAVE_OBJECT_HEAP_LOCK
+#define RAVE_OBJECT_HEAP_UNLOCK
+#define RAVE_OBJECT_INCREF(obj) (++(obj)->roh_refCnt)
+#define RAVE_OBJECT_DECREF(obj) (--(obj)->roh_refCnt)
+#endif
+
 static long objectsCreated = 0;
 static long objectsDestroyed = 0;
 
@@ -70,6 +87,8 @@ static void RaveCoreObjectInternal_objCreated(RaveCoreObject* obj, const char* f
     return;
   }
 
+  RAVE_OBJECT_HEAP_LOCK;
+  objectsCreated++;
   if (OBJECT_HEAP == NULL) {
     OBJECT_HEAP = entry;
     LAST_OBJECT_HEAP = entry;
@@ -78,11 +97,15 @@ static void RaveCoreObjectInternal_objCreated(RaveCoreObject* obj, const char* f
     entry->prev = LAST_OBJECT_HEAP;
     LAST_OBJECT_HEAP = entry;
   }
+  RAVE_OBJECT_HEAP_UNLOCK;
 }
 
 static void RaveCoreObjectInternal_objDestroyed(RaveCoreObject* obj)
 {
-  heapobject* ho = OBJECT_HEAP;
+  heapobject* ho = NULL;
+  RAVE_OBJECT_HEAP_LOCK;
+  objectsDestroyed++;
+  ho = OBJECT_HEAP;
   while (ho != NULL && ho->obj != obj) {
     ho = ho->next;
   }
@@ -112,6 +135,7 @@ static void RaveCoreObjectInternal_objDestroyed(RaveCoreObject* obj)
       RAVE_FREE(ho)
     }
   }
+  RAVE_OBJECT_HEAP_UNLOCK;
 }
 
 RaveCoreObject* RaveCoreObject_new(RaveCoreObjectType* type, const char* filename, int lineno)
@@ -120,6 +144,7 @@ RaveCoreObject* RaveCoreObject_new(RaveCoreObjectType* type, const char* filenam
   RAVE_ASSERT((type != NULL), "type == NULL");
   result = RAVE_MALLOC(type->type_size);
   if (result != NULL) {
+    memset(result, 0, type->type_size); /* Members not set by the constructor, e.g. optional function pointers, are NULL */
     result->roh_refCnt = 1;
     result->roh_type = type;
     result->roh_bindingData = NULL;
@@ -131,7 +156,6 @@ RaveCoreObject* RaveCoreObject_new(RaveCoreObjectType* type, const char* filenam
   }
   if (result != NULL) {
     RaveCoreObjectInternal_objCreated(result, filename, lineno);
-    objectsCreated++;
   }
   return result;
 }
@@ -139,16 +163,15 @@ RaveCoreObject* RaveCoreObject_new(RaveCoreObjectType* type, const char* filenam
 void RaveCoreObject_release(RaveCoreObject* obj, const char* filename, int lineno)
 {
   if (obj != NULL) {
-    obj->roh_refCnt--;
-    if (obj->roh_refCnt == 0) {
+    int refCnt = RAVE_OBJECT_DECREF(obj);
+    if (refCnt == 0) {
       if (obj->roh_type->destructor != NULL) {
         obj->roh_type->destructor(obj);
       }
       obj->roh_bindingData = NULL;
       RaveCoreObjectInternal_objDestroyed(obj);
       RAVE_FREE(obj);
-      objectsDestroyed++;
-    } else if (obj->roh_refCnt < 0) {
+    } else if (refCnt < 0) {
       Rave_printf("Got negative reference count, aborting");
       RAVE_ABORT();
     }
@@ -158,7 +181,7 @@ void RaveCoreObject_release(RaveCoreObject* obj, const char* filename, int linen
 RaveCoreObject* RaveCoreObject_copy(RaveCoreObject* src, const char* filename, int lineno)
 {
   if (src != NULL) {
-    src->roh_refCnt++;
+    RAVE_OBJECT_INCREF(src);
   }
   return src;
 }
@@ -169,6 +192,7 @@ RaveCoreObject* RaveCoreObject_clone(RaveCoreObject* src, const char* filename,
   if (src != NULL) {
     result = RAVE_MALLOC(src->roh_type->type_size);
     if (result != NULL) {
+      memset(result, 0, src->roh_type->type_size);
       result->roh_refCnt = 1;
       result->roh_type = src->roh_type;
       result->roh_bindingData = NULL;
@@ -181,7 +205,6 @@ RaveCoreObject* RaveCoreObject_clone(RaveCoreObject* src, const char* filename,
   }
   if (result != NULL) {
     RaveCoreObjectInternal_objCreated(result, filename, lineno);
-    objectsCreated++;
   }
   return result;
 }
@@ -241,6 +264,7 @@ void RaveCoreObject_printStatistics(void)
   Rave_printf("Objects deleted: %ld\n", objectsDestroyed);
   Rave_printf("Objects pending: %ld\n", objectsCreated - objectsDestroyed);
 
+  RAVE_OBJECT_HEAP_LOCK;
   if (OBJECT_HEAP != NULL) {
     heapobject* ho = OBJECT_HEAP;
     while (ho != NULL) {
@@ -249,4 +273,5 @@ void RaveCoreObject_printStatistics(void)
       ho = ho->next;
     }
   }
+  RAVE_OBJECT_HEAP_UNLOCK;
 }
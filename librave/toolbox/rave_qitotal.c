@@ -26,6 +26,7 @@ along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
 #include "rave_debug.h"
 #include "rave_alloc.h"
 #include "raveutil.h"
+#include "rave_stats.h"
 #include "raveobject_hashtable.h"
 #include <string.h>
 #include <stdio.h>
@@ -357,6 +358,7 @@ RaveField_t* RaveQITotal_multiplicative(RaveQITotal_t* self, RaveObjectList_t* f
   RaveField_t* qifield = NULL;
   RaveField_t* qifield_conv = NULL;
   RaveField_t* field = NULL;
+  RAVE_STATS_SCOPE(RaveStats_Timer_QC_QITOTAL);
 
   RAVE_ASSERT((self != NULL), "self == NULL");
 
@@ -442,6 +444,7 @@ RaveField_t* RaveQITotal_additive(RaveQITotal_t* self, RaveObjectList_t* fields)
   RaveField_t* qifield = NULL;
   RaveField_t* qifield_conv = NULL;
   RaveField_t* field = NULL;
+  RAVE_STATS_SCOPE(RaveStats_Timer_QC_QITOTAL);
 
   RAVE_ASSERT((self != NULL), "self == NULL");
 
@@ -537,6 +540,7 @@ RaveField_t* RaveQITotal_minimum(RaveQITotal_t* self, RaveObjectList_t* fields)
   RaveField_t* qifield_conv = NULL;
   RaveField_t* field = NULL;
   RaveField_t* wfield = NULL; /* We need to keep track on the weights for each field so that we can get the original values back */
+  RAVE_STATS_SCOPE(RaveStats_Timer_QC_QITOTAL);
 
   RAVE_ASSERT((self != NULL), "self == NULL");
 
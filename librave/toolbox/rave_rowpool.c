@@ -0,0 +1,126 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of RAVE.
+
+RAVE is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RAVE is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+
+/**
+ * Shares the rows of a product between a number of threads.
+ * @file
+ * @date 2026-10-17
+ */
+#include "rave_rowpool.h"
+#include "rave_alloc.h"
+#include <string.h>
+
+#ifdef PTHREAD_SUPPORTED
+#include <pthread.h>
+#endif
+
+/**
+ * The work shared by the threads.
+ */
+typedef struct RaveRowPoolJob_t {
+  long nrows;                       /**< number of rows */
+  long nextRow;                     /**< next row to process */
+  int failed;                       /**< set if any row or init has failed */
+  RaveRowPool_processRow process;   /**< processes one row */
+  RaveRowPool_initWorker init;      /**< creates the state of a thread, may be NULL */
+  RaveRowPool_releaseWorker release;/**< releases the state of a thread, may be NULL */
+  void* arg;                        /**< the argument to the functions */
+#ifdef PTHREAD_SUPPORTED
+  pthread_mutex_t mutex;            /**< protects nextRow and failed */
+#endif
+} RaveRowPoolJob_t;
+
+/*@{ Private functions */
+/**
+ * Worker that processes rows until there are no more rows or a row has failed.
+ */
+static void* RaveRowPoolInternal_worker(void* arg)
+{
+  RaveRowPoolJob_t* job = (RaveRowPoolJob_t*)arg;
+  void* worker = NULL;
+  int failed = 0;
+
+  if (job->init != NULL && !job->init(job->arg, &worker)) {
+    failed = 1;
+  }
+
+  for (;;) {
+    long y = 0;
+#ifdef PTHREAD_SUPPORTED
+    pthread_mutex_lock(&job->mutex);
+#endif
+    if (failed) {
+      job->failed = 1;
+    }
+    y = job->failed ? job->nrows : job->nextRow++;
+#ifdef PTHREAD_SUPPORTED
+    pthread_mutex_unlock(&job->mutex);
+#endif
+    if (y >= job->nrows) {
+      break;
+    }
+    if (!job->process(job->arg, worker, y)) {
+      failed = 1;
+    }
+  }
+
+  if (job->release != NULL) {
+    job->release(job->arg, worker);
+  }
+  return NULL;
+}
+/*@} End of Private functions */
+
+/*@{ Interface functions */
+int RaveRowPool_run(long nrows, int nthreads, RaveRowPool_processRow process,
+                    RaveRowPool_initWorker init, RaveRowPool_releaseWorker release, void* arg)
+{
+  RaveRowPoolJob_t job;
+
+  memset(&job, 0, sizeof(RaveRowPoolJob_t));
+  job.nrows = nrows;
+  job.process = process;
+  job.init = init;
+  job.release = release;
+  job.arg = arg;
+
+#ifdef PTHREAD_SUPPORTED
+  if (nthreads > 1 && nrows > 1) {
+    int nt = (nthreads > nrows) ? (int)nrows : nthreads;
+    pthread_t* threads = RAVE_MALLOC(sizeof(pthread_t) * nt);
+    int i = 0, started = 0;
+    pthread_mutex_init(&job.mutex, NULL);
+    for (i = 0; threads != NULL && i < nt - 1; i++) {
+      if (pthread_create(&threads[started], NULL, RaveRowPoolInternal_worker, &job) == 0) {
+        started++;
+      }
+    }
+    RaveRowPoolInternal_worker(&job); /* The calling thread takes part as well */
+    for (i = 0; i < started; i++) {
+      pthread_join(threads[i], NULL);
+    }
+    RAVE_FREE(threads);
+    pthread_mutex_destroy(&job.mutex);
+    return !job.failed;
+  }
+#endif
+  RaveRowPoolInternal_worker(&job);
+  return !job.failed;
+}
+/*@} End of Interface functions */
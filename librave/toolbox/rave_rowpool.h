@@ -0,0 +1,71 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of RAVE.
+
+RAVE is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RAVE is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+
+/**
+ * Shares the rows of a product between a number of threads. The rows are handed out one at a time
+ * so that the threads stay busy even when some rows are more expensive than others. The calling thread
+ * takes part as well, so nthreads = 1 processes all rows in the calling thread without starting any threads.
+ *
+ * When pthreads are not supported all rows are processed by the calling thread.
+ *
+ * @file
+ * @date 2026-10-17
+ */
+#ifndef RAVE_ROWPOOL_H
+#define RAVE_ROWPOOL_H
+
+/**
+ * Processes one row.
+ * @param[in] arg - the argument passed to \ref RaveRowPool_run
+ * @param[in] worker - the state created by the init function for this thread, NULL if there is no init function
+ * @param[in] row - the row to process
+ * @return 1 on success, 0 on failure which stops all threads from taking more rows
+ */
+typedef int (*RaveRowPool_processRow)(void* arg, void* worker, long row);
+
+/**
+ * Creates the state of one thread before it starts to take rows, for example projection pipelines that
+ * can not be shared between threads.
+ * @param[in] arg - the argument passed to \ref RaveRowPool_run
+ * @param[out] worker - the state of the thread
+ * @return 1 on success, 0 on failure which stops all threads from taking more rows
+ */
+typedef int (*RaveRowPool_initWorker)(void* arg, void** worker);
+
+/**
+ * Releases the state of one thread when it has finished. Called even if the init function failed.
+ * @param[in] arg - the argument passed to \ref RaveRowPool_run
+ * @param[in] worker - the state created by the init function, may be NULL
+ */
+typedef void (*RaveRowPool_releaseWorker)(void* arg, void* worker);
+
+/**
+ * Processes the rows 0 .. nrows-1 with up to nthreads threads, including the calling thread.
+ * @param[in] nrows - number of rows
+ * @param[in] nthreads - maximum number of threads, values < 1 are treated as 1
+ * @param[in] process - the function called for every row
+ * @param[in] init - creates the state of each thread, may be NULL
+ * @param[in] release - releases the state of each thread, may be NULL
+ * @param[in] arg - passed on to the functions
+ * @return 1 if all rows were processed successfully, otherwise 0
+ */
+int RaveRowPool_run(long nrows, int nthreads, RaveRowPool_processRow process,
+                    RaveRowPool_initWorker init, RaveRowPool_releaseWorker release, void* arg);
+
+#endif /* RAVE_ROWPOOL_H */
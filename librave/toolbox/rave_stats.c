@@ -0,0 +1,294 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of RAVE.
+
+RAVE is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RAVE is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+
+/**
+ * Timers and counters for the hot paths in the toolbox.
+ * @file
+ * @date 2026-10-17
+ */
+#include "rave_stats.h"
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/time.h>
+
+#ifdef PTHREAD_SUPPORTED
+#include <pthread.h>
+#endif
+
+/**
+ * Names of the timers, in the same order as \ref RaveStats_Timer.
+ */
+static const char* RAVE_STATS_TIMER_NAMES[RaveStats_Timer_NTIMERS] = {
+  "composite.generate",
+  "composite.projection",
+  "composite.select",
+  "composite.quality",
+  "transform",
+  "io.read",
+  "io.write",
+  "polar_odim_io.read",
+  "polar_odim_io.write",
+  "qc.hac",
+  "qc.detection_range",
+  "qc.dealias",
+  "qc.ctfilter",
+  "qc.qitotal"
+};
+
+/**
+ * Names of the counters, in the same order as \ref RaveStats_Counter.
+ */
+static const char* RAVE_STATS_COUNTER_NAMES[RaveStats_Counter_NCOUNTERS] = {
+  "composite.pixels",
+  "composite.lookups",
+  "composite.projections",
+  "transform.pixels",
+  "io.files_read",
+  "io.files_written"
+};
+
+#ifdef RAVE_STATS_ENABLED
+
+/**
+ * The statistics for one thread.
+ */
+typedef struct RaveStatsBlock_t {
+  RaveStats_t stats; /**< the statistics */
+  struct RaveStatsBlock_t* next; /**< next block */
+  struct RaveStatsBlock_t* prev; /**< previous block */
+} RaveStatsBlock_t;
+
+/**
+ * The totals from threads that have terminated.
+ */
+static RaveStats_t raveStatsRetired;
+
+/**
+ * The blocks of the running threads.
+ */
+static RaveStatsBlock_t* raveStatsBlocks = NULL;
+
+#ifdef PTHREAD_SUPPORTED
+static pthread_mutex_t raveStatsMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t raveStatsKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t raveStatsKey;
+static __thread RaveStatsBlock_t* raveStatsLocal = NULL;
+#else
+static RaveStatsBlock_t* raveStatsLocal = NULL;
+#endif
+
+/*@{ Private functions */
+static void RaveStatsInternal_add(RaveStats_t* dst, const RaveStats_t* src)
+{
+  int i = 0;
+  for (i = 0; i < RaveStats_Timer_NTIMERS; i++) {
+    dst->seconds[i] += src->seconds[i];
+    dst->calls[i] += src->calls[i];
+  }
+  for (i = 0; i < RaveStats_Counter_NCOUNTERS; i++) {
+    dst->counters[i] += src->counters[i];
+  }
+}
+
+static void RaveStatsInternal_lock(void)
+{
+#ifdef PTHREAD_SUPPORTED
+  pthread_mutex_lock(&raveStatsMutex);
+#endif
+}
+
+static void RaveStatsInternal_unlock(void)
+{
+#ifdef PTHREAD_SUPPORTED
+  pthread_mutex_unlock(&raveStatsMutex);
+#endif
+}
+
+#ifdef PTHREAD_SUPPORTED
+/**
+ * Called when a thread terminates. Merges the block into the retired totals.
+ * @param[in] arg - the block
+ */
+static void RaveStatsInternal_releaseBlock(void* arg)
+{
+  RaveStatsBlock_t* block = (RaveStatsBlock_t*)arg;
+  RaveStatsInternal_lock();
+  RaveStatsInternal_add(&raveStatsRetired, &block->stats);
+  if (block->prev != NULL) {
+    block->prev->next = block->next;
+  } else {
+    raveStatsBlocks = block->next;
+  }
+  if (block->next != NULL) {
+    block->next->prev = block->prev;
+  }
+  RaveStatsInternal_unlock();
+  free(block);
+}
+
+static void RaveStatsInternal_createKey(void)
+{
+  pthread_key_create(&raveStatsKey, RaveStatsInternal_releaseBlock);
+}
+#endif
+
+/**
+ * Returns the block for the calling thread, creating it on first use.
+ * @returns the block or NULL if it could not be allocated
+ */
+static RaveStatsBlock_t* RaveStatsInternal_getBlock(void)
+{
+  if (raveStatsLocal == NULL) {
+    /* Plain malloc since the rave memory debugging would report these as leaks */
+    RaveStatsBlock_t* block = calloc(1, sizeof(RaveStatsBlock_t));
+    if (block == NULL) {
+      return NULL;
+    }
+#ifdef PTHREAD_SUPPORTED
+    pthread_once(&raveStatsKeyOnce, RaveStatsInternal_createKey);
+    pthread_setspecific(raveStatsKey, block);
+#endif
+    RaveStatsInternal_lock();
+    block->next = raveStatsBlocks;
+    if (raveStatsBlocks != NULL) {
+      raveStatsBlocks->prev = block;
+    }
+    raveStatsBlocks = block;
+    RaveStatsInternal_unlock();
+    raveStatsLocal = block;
+  }
+  return raveStatsLocal;
+}
+/*@} End of Private functions */
+
+/*@{ Interface functions */
+int RaveStats_isEnabled(void)
+{
+  return 1;
+}
+
+void RaveStats_addTime(RaveStats_Timer timer, double seconds)
+{
+  RaveStatsBlock_t* block = RaveStatsInternal_getBlock();
+  if (block != NULL && timer >= 0 && timer < RaveStats_Timer_NTIMERS) {
+    block->stats.seconds[timer] += seconds;
+    block->stats.calls[timer]++;
+  }
+}
+
+void RaveStats_increment(RaveStats_Counter counter, long n)
+{
+  RaveStatsBlock_t* block = RaveStatsInternal_getBlock();
+  if (block != NULL && counter >= 0 && counter < RaveStats_Counter_NCOUNTERS) {
+    block->stats.counters[counter] += n;
+  }
+}
+
+void RaveStats_get(RaveStats_t* stats)
+{
+  RaveStatsBlock_t* block = NULL;
+  if (stats == NULL) {
+    return;
+  }
+  RaveStatsInternal_lock();
+  *stats = raveStatsRetired;
+  for (block = raveStatsBlocks; block != NULL; block = block->next) {
+    RaveStatsInternal_add(stats, &block->stats);
+  }
+  RaveStatsInternal_unlock();
+}
+
+void RaveStats_reset(void)
+{
+  RaveStatsBlock_t* block = NULL;
+  RaveStatsInternal_lock();
+  memset(&raveStatsRetired, 0, sizeof(RaveStats_t));
+  for (block = raveStatsBlocks; block != NULL; block = block->next) {
+    memset(&block->stats, 0, sizeof(RaveStats_t));
+  }
+  RaveStatsInternal_unlock();
+}
+
+#else
+
+int RaveStats_isEnabled(void)
+{
+  return 0;
+}
+
+void RaveStats_addTime(RaveStats_Timer timer, double seconds)
+{
+}
+
+void RaveStats_increment(RaveStats_Counter counter, long n)
+{
+}
+
+void RaveStats_get(RaveStats_t* stats)
+{
+  if (stats != NULL) {
+    memset(stats, 0, sizeof(RaveStats_t));
+  }
+}
+
+void RaveStats_reset(void)
+{
+}
+
+#endif
+
+double RaveStats_now(void)
+{
+#if defined(CLOCK_MONOTONIC)
+  struct timespec ts;
+  if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0) {
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+  }
+#endif
+  {
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec + (double)tv.tv_usec * 1e-6;
+  }
+}
+
+void RaveStats_endScope(RaveStatsScope_t* scope)
+{
+  if (scope != NULL) {
+    RaveStats_addTime(scope->timer, RaveStats_now() - scope->start);
+  }
+}
+
+const char* RaveStats_getTimerName(RaveStats_Timer timer)
+{
+  if (timer >= 0 && timer < RaveStats_Timer_NTIMERS) {
+    return RAVE_STATS_TIMER_NAMES[timer];
+  }
+  return NULL;
+}
+
+const char* RaveStats_getCounterName(RaveStats_Counter counter)
+{
+  if (counter >= 0 && counter < RaveStats_Counter_NCOUNTERS) {
+    return RAVE_STATS_COUNTER_NAMES[counter];
+  }
+  return NULL;
+}
+/*@} End of Interface functions */
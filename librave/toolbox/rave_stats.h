@@ -0,0 +1,192 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of RAVE.
+
+RAVE is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RAVE is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+
+/**
+ * Timers and counters for the hot paths in the toolbox (compositing, transforms, I/O and quality controls).
+ *
+ * The instrumentation is only compiled in when RAVE_STATS_ENABLED is defined (configure --enable-stats).
+ * Otherwise all the macros expand to nothing and the functions only return zeros so that there is no
+ * cost at all when disabled.
+ *
+ * The timers are used at row or call granularity and per pixel events are only counted, so that
+ * the measurements do not dominate the work they measure.
+ *
+ * Each thread accumulates into its own block so no locking is needed when measuring. The blocks are
+ * summed when the statistics are read and the block of a thread that terminates is merged into the totals.
+ *
+ * @file
+ * @date 2026-10-17
+ */
+#ifndef RAVE_STATS_H
+#define RAVE_STATS_H
+
+/**
+ * The timers.
+ */
+typedef enum RaveStats_Timer {
+  RaveStats_Timer_COMPOSITE_GENERATE = 0, /**< Total time in Composite_generate */
+  RaveStats_Timer_COMPOSITE_PROJECTION,   /**< Transforming composite rows into the radar projections when done as a separate pass */
+  RaveStats_Timer_COMPOSITE_SELECT,       /**< Navigating and selecting the values of the composite rows */
+  RaveStats_Timer_COMPOSITE_QUALITY,      /**< Filling the quality fields of the composite rows */
+  RaveStats_Timer_TRANSFORM,              /**< Polar to cartesian transforms (ppi, cappi, pcappi, ctoscan ...) */
+  RaveStats_Timer_IO_READ,                /**< RaveIO load */
+  RaveStats_Timer_IO_WRITE,               /**< RaveIO save */
+  RaveStats_Timer_POLAR_ODIM_READ,        /**< Reading polar scans and volumes from the ODIM structure */
+  RaveStats_Timer_POLAR_ODIM_WRITE,       /**< Writing polar scans and volumes into the ODIM structure */
+  RaveStats_Timer_QC_HAC,                 /**< Hit accumulation clutter filter */
+  RaveStats_Timer_QC_DETECTION_RANGE,     /**< Detection range */
+  RaveStats_Timer_QC_DEALIAS,             /**< Dealiasing */
+  RaveStats_Timer_QC_CTFILTER,            /**< Cloud type filter */
+  RaveStats_Timer_QC_QITOTAL,             /**< Total quality index */
+  RaveStats_Timer_NTIMERS                 /**< Number of timers, must be last */
+} RaveStats_Timer;
+
+/**
+ * The counters.
+ */
+typedef enum RaveStats_Counter {
+  RaveStats_Counter_COMPOSITE_PIXELS = 0, /**< Number of composite pixels generated */
+  RaveStats_Counter_COMPOSITE_LOOKUPS,    /**< Number of pixel lookups in radar data */
+  RaveStats_Counter_COMPOSITE_PROJECTIONS, /**< Number of pixels transformed into radar projections */
+  RaveStats_Counter_TRANSFORM_PIXELS,     /**< Number of pixels generated by transforms */
+  RaveStats_Counter_IO_FILES_READ,        /**< Number of files loaded */
+  RaveStats_Counter_IO_FILES_WRITTEN,     /**< Number of files saved */
+  RaveStats_Counter_NCOUNTERS             /**< Number of counters, must be last */
+} RaveStats_Counter;
+
+/**
+ * The aggregated statistics.
+ */
+typedef struct RaveStats_t {
+  double seconds[RaveStats_Timer_NTIMERS]; /**< accumulated time for each timer */
+  long calls[RaveStats_Timer_NTIMERS];     /**< number of measurements for each timer */
+  long counters[RaveStats_Counter_NCOUNTERS]; /**< value of each counter */
+} RaveStats_t;
+
+/**
+ * Returns if the statistics has been compiled in.
+ * @returns 1 if enabled otherwise 0
+ */
+int RaveStats_isEnabled(void);
+
+/**
+ * Returns a monotonic time stamp in seconds.
+ * @returns the time
+ */
+double RaveStats_now(void);
+
+/**
+ * Adds time to a timer for the calling thread.
+ * @param[in] timer - the timer
+ * @param[in] seconds - the time to add
+ */
+void RaveStats_addTime(RaveStats_Timer timer, double seconds);
+
+/**
+ * Increments a counter for the calling thread.
+ * @param[in] counter - the counter
+ * @param[in] n - the value to add
+ */
+void RaveStats_increment(RaveStats_Counter counter, long n);
+
+/**
+ * Sums up the statistics from all threads. Values from threads that are running
+ * while this is called are the values at the time they were read.
+ * @param[out] stats - the statistics
+ */
+void RaveStats_get(RaveStats_t* stats);
+
+/**
+ * Resets all timers and counters.
+ */
+void RaveStats_reset(void);
+
+/**
+ * Returns the name of a timer, e.g. "composite.projection".
+ * @param[in] timer - the timer
+ * @returns the name or NULL if not a valid timer
+ */
+const char* RaveStats_getTimerName(RaveStats_Timer timer);
+
+/**
+ * Returns the name of a counter, e.g. "composite.pixels".
+ * @param[in] counter - the counter
+ * @returns the name or NULL if not a valid counter
+ */
+const char* RaveStats_getCounterName(RaveStats_Counter counter);
+
+/**
+ * Used by \ref #RAVE_STATS_SCOPE.
+ */
+typedef struct RaveStatsScope_t {
+  RaveStats_Timer timer; /**< the timer */
+  double start;          /**< start time */
+} RaveStatsScope_t;
+
+/**
+ * Stops a scoped timer, used by \ref #RAVE_STATS_SCOPE.
+ * @param[in] scope - the scope
+ */
+void RaveStats_endScope(RaveStatsScope_t* scope);
+
+#ifdef RAVE_STATS_ENABLED
+
+/**
+ * Measures the time from this statement until the enclosing block is left, regardless of how it is left.
+ * Should be placed directly after the declarations at the start of the block so that no jump passes it
+ * and so that the empty statement it expands to when disabled does not come before any declaration. Requires gcc or clang, otherwise nothing is measured.
+ */
+#if defined(__GNUC__)
+#define RAVE_STATS_SCOPE(timer) \
+  RaveStatsScope_t __attribute__((cleanup(RaveStats_endScope))) raveStatsScope = {timer, RaveStats_now()}
+#else
+#define RAVE_STATS_SCOPE(timer)
+#endif
+
+/**
+ * Starts a timer by storing the current time in the variable var.
+ */
+#define RAVE_STATS_TIMER_START(var) double var = RaveStats_now()
+
+/**
+ * Adds the time since \ref #RAVE_STATS_TIMER_START with the same variable to the timer.
+ */
+#define RAVE_STATS_TIMER_STOP(var, timer) RaveStats_addTime(timer, RaveStats_now() - (var))
+
+/**
+ * Starts a timer again in a variable declared with \ref #RAVE_STATS_TIMER_START, e.g. to time the next part of a loop.
+ */
+#define RAVE_STATS_TIMER_RESTART(var) (var) = RaveStats_now()
+
+/**
+ * Adds n to the counter.
+ */
+#define RAVE_STATS_COUNT(counter, n) RaveStats_increment(counter, n)
+
+#else
+
+#define RAVE_STATS_SCOPE(timer)
+#define RAVE_STATS_TIMER_START(var)
+#define RAVE_STATS_TIMER_STOP(var, timer) do {} while (0)
+#define RAVE_STATS_TIMER_RESTART(var) do {} while (0)
+#define RAVE_STATS_COUNT(counter, n) do {} while (0)
+
+#endif
+
+#endif /* RAVE_STATS_H */
@@ -29,9 +29,11 @@ along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
 #include "rave_debug.h"
 #include "rave_alloc.h"
 #include "rave_utilities.h"
+#include "rave_stats.h"
 #include <string.h>
 #include <math.h>
 #include <stdio.h>
+#include <float.h>
 
 /**
  * Represents one transformator
@@ -76,6 +78,7 @@ static int Transform_cappis_internal(Transform_t* transform, PolarVolume_t* pvol
   Projection_t* sourcepj = NULL;
   Projection_t* targetpj = NULL;
   ProjectionPipeline_t* pipeline = NULL;
+  RAVE_STATS_SCOPE(RaveStats_Timer_TRANSFORM);
 
   RAVE_ASSERT((transform != NULL), "transform was NULL");
   RAVE_ASSERT((pvol != NULL), "pvol was NULL");
@@ -125,6 +128,7 @@ static int Transform_cappis_internal(Transform_t* transform, PolarVolume_t* pvol
       Cartesian_setValue(cartesian, x, y, v);
     }
   }
+  RAVE_STATS_COUNT(RaveStats_Counter_TRANSFORM_PIXELS, xsize * ysize);
 
   result = 1;
 done:
@@ -134,6 +138,111 @@ done:
   return result;
 }
 
+/**
+ * Internal routine for the products that are calculated from the columns of a \ref PolarCube_t.
+ * @param[in] transform - the transformer instance
+ * @param[in] pvol - the polar volume
+ * @param[in] cartesian - the cartesian (resulting) product
+ * @param[in] product - Rave_ProductType_MAX, Rave_ProductType_ETOP or Rave_ProductType_VIL
+ * @param[in] threshold - the echo top threshold
+ * @returns 1 on success otherwise 0
+ */
+static int Transform_vertical_internal(Transform_t* transform, PolarVolume_t* pvol, Cartesian_t* cartesian, Rave_ProductType product, double threshold)
+{
+  int result = 0;
+  long xsize = 0, ysize = 0, x = 0, y = 0, nbins = 0;
+  double cnodata = 0.0L, cundetect = 0.0L, scale = 1.0;
+  const char* quantity = NULL;
+  const double* data = NULL;
+  Projection_t* sourcepj = NULL;
+  Projection_t* targetpj = NULL;
+  ProjectionPipeline_t* pipeline = NULL;
+  PolarCube_t* cube = NULL;
+  RaveData2D_t* field = NULL;
+  RAVE_STATS_SCOPE(RaveStats_Timer_TRANSFORM);
+
+  RAVE_ASSERT((transform != NULL), "transform was NULL");
+  RAVE_ASSERT((pvol != NULL), "pvol was NULL");
+  RAVE_ASSERT((cartesian != NULL), "cartesian was NULL");
+
+  if (!Cartesian_isTransformable(cartesian)) {
+    RAVE_ERROR0("Cartesian product is not possible to transform");
+    goto done;
+  }
+  if (!PolarVolume_isTransformable(pvol)) {
+    RAVE_ERROR0("Polar volume is not possible to transform");
+    goto done;
+  }
+  quantity = PolarVolume_getDefaultParameter(pvol);
+  cube = PolarVolume_getCube(pvol, quantity, 0, 0);
+  if (cube == NULL) {
+    RAVE_ERROR1("Failed to create cube for %s", quantity);
+    goto done;
+  }
+  cnodata = Cartesian_getNodata(cartesian);
+  cundetect = Cartesian_getUndetect(cartesian);
+  /* Kernel results use values that can not be mixed up with data for nodata and undetect */
+  if (product == Rave_ProductType_ETOP) {
+    field = PolarCube_echoTop(cube, threshold, -DBL_MAX, -FLT_MAX);
+    scale = 0.001; /* km */
+  } else if (product == Rave_ProductType_VIL) {
+    field = PolarCube_vil(cube, -DBL_MAX, -FLT_MAX);
+  } else {
+    field = PolarCube_max(cube, -DBL_MAX, -FLT_MAX);
+  }
+  if (field == NULL) {
+    goto done;
+  }
+  data = (const double*)RaveData2D_getReadOnlyData(field);
+  nbins = RaveData2D_getXsize(field);
+
+  sourcepj = Cartesian_getProjection(cartesian);
+  targetpj = PolarVolume_getProjection(pvol);
+  pipeline = ProjectionPipeline_createPipeline(sourcepj, targetpj);
+  xsize = Cartesian_getXSize(cartesian);
+  ysize = Cartesian_getYSize(cartesian);
+
+  if (pipeline == NULL) {
+    RAVE_ERROR0("Failed to create pipeline");
+    goto done;
+  }
+
+  for (y = 0; y < ysize; y++) {
+    double herey = Cartesian_getLocationY(cartesian, y);
+    for (x = 0; x < xsize; x++) {
+      double herex = Cartesian_getLocationX(cartesian, x);
+      double lon = 0.0, lat = 0.0;
+      long ri = 0, bi = 0;
+      if (!ProjectionPipeline_fwd(pipeline, herex, herey, &lon, &lat)) {
+        RAVE_ERROR0("Transform failed");
+        goto done;
+      }
+      if (!PolarCube_getColumn(cube, lon, lat, &ri, &bi)) {
+        Cartesian_setValue(cartesian, x, y, cnodata);
+      } else {
+        double v = data[ri * nbins + bi];
+        if (v == -DBL_MAX) {
+          Cartesian_setValue(cartesian, x, y, cnodata);
+        } else if (v == -FLT_MAX) {
+          Cartesian_setValue(cartesian, x, y, cundetect);
+        } else {
+          Cartesian_setConvertedValue(cartesian, x, y, v * scale);
+        }
+      }
+    }
+  }
+  RAVE_STATS_COUNT(RaveStats_Counter_TRANSFORM_PIXELS, xsize * ysize);
+
+  result = 1;
+done:
+  RAVE_OBJECT_RELEASE(sourcepj);
+  RAVE_OBJECT_RELEASE(targetpj);
+  RAVE_OBJECT_RELEASE(pipeline);
+  RAVE_OBJECT_RELEASE(field);
+  RAVE_OBJECT_RELEASE(cube);
+  return result;
+}
+
 int TransformInternal_verifySameParameterNames(RaveList_t* expected, RaveList_t* actual)
 {
   int nexpected = 0, nactual = 0, ie = 0, ia = 0;
@@ -221,6 +330,7 @@ int Transform_ppi(Transform_t* transform, PolarScan_t* scan, Cartesian_t* cartes
   Projection_t* sourcepj = NULL;
   Projection_t* targetpj = NULL;
   ProjectionPipeline_t* pipeline = NULL;
+  RAVE_STATS_SCOPE(RaveStats_Timer_TRANSFORM);
 
   RAVE_ASSERT((transform != NULL), "transform was NULL");
   RAVE_ASSERT((scan != NULL), "scan was NULL");
@@ -267,6 +377,7 @@ int Transform_ppi(Transform_t* transform, PolarScan_t* scan, Cartesian_t* cartes
       Cartesian_setValue(cartesian, x, y, v);
     }
   }
+  RAVE_STATS_COUNT(RaveStats_Counter_TRANSFORM_PIXELS, xsize * ysize);
 
   result = 1;
 done:
@@ -286,6 +397,21 @@ int Transform_pcappi(Transform_t* transform, PolarVolume_t* pvol, Cartesian_t* c
   return Transform_cappis_internal(transform, pvol, cartesian, height, 0);
 }
 
+int Transform_max(Transform_t* transform, PolarVolume_t* pvol, Cartesian_t* cartesian)
+{
+  return Transform_vertical_internal(transform, pvol, cartesian, Rave_ProductType_MAX, 0.0);
+}
+
+int Transform_etop(Transform_t* transform, PolarVolume_t* pvol, Cartesian_t* cartesian, double threshold)
+{
+  return Transform_vertical_internal(transform, pvol, cartesian, Rave_ProductType_ETOP, threshold);
+}
+
+int Transform_vil(Transform_t* transform, PolarVolume_t* pvol, Cartesian_t* cartesian)
+{
+  return Transform_vertical_internal(transform, pvol, cartesian, Rave_ProductType_VIL, 0.0);
+}
+
 PolarScan_t* Transform_ctoscan(Transform_t* transform, Cartesian_t* cartesian, RadarDefinition_t* def, double angle, const char* quantity)
 {
   Projection_t* sourcepj = NULL;
@@ -301,6 +427,7 @@ PolarScan_t* Transform_ctoscan(Transform_t* transform, Cartesian_t* cartesian, R
   double undetect = 0.0;
   long ray = 0, bin = 0;
   long nrays = 0, nbins = 0;
+  RAVE_STATS_SCOPE(RaveStats_Timer_TRANSFORM);
 
   RAVE_ASSERT((transform != NULL), "transform == NULL");
   RAVE_ASSERT((cartesian != NULL), "cartesian == NULL");
@@ -591,47 +718,40 @@ done:
   return result;
 }
 
-static RaveAttribute_t* TransformInternal_mergeRadarIndexTaskArgs(const char* tgtHowTaskArgValue, const char* srcHowTaskArgValue)
+/**
+ * Merges the radar index table of the source field into the target field. The tables are
+ * parsed from how/task_args at most once per field and the merged table is only serialized
+ * when the attributes of the target field are read.
+ * @param[in] targetField - the target radar index field
+ * @param[in] sourceField - the tile radar index field
+ * @return 1 on success otherwise 0
+ */
+static int TransformInternal_mergeRadarIndexTable(RaveField_t* targetField, RaveField_t* sourceField)
 {
-  RaveAttribute_t* result = NULL;
-  RaveList_t* srcTokens = NULL;
-  int buffLength = 0;
-  char* buff = NULL;
+  RadarIndexTable_t *tgtTable = NULL, *srcTable = NULL, *ctable = NULL;
+  int result = 0;
 
-  if (tgtHowTaskArgValue == NULL && srcHowTaskArgValue == NULL) {
-    return NULL;
+  srcTable = RaveField_getRadarIndexTable(sourceField);
+  if (srcTable == NULL) {
+    result = 1;
+    goto done;
   }
-  if (tgtHowTaskArgValue == NULL && srcHowTaskArgValue != NULL) {
-    return RaveAttributeHelp_createString("how/task_args", srcHowTaskArgValue);
-  }
-  if (tgtHowTaskArgValue != NULL && srcHowTaskArgValue == NULL) {
-    return RaveAttributeHelp_createString("how/task_args", tgtHowTaskArgValue);
-  }
-  buffLength = strlen(tgtHowTaskArgValue) + strlen(srcHowTaskArgValue) + 2; /* One for ending new line and one for ',' between. */
-  buff = RAVE_MALLOC(sizeof(char)*buffLength);
-  if (buff != NULL) {
-    strcpy(buff, tgtHowTaskArgValue);
-
-    srcTokens = RaveUtilities_getTrimmedTokens(srcHowTaskArgValue, (int)',');
-    if (srcTokens != NULL) {
-      int i = 0;
-      int nTokens = RaveList_size(srcTokens);
-      for (i = 0; i < nTokens; i++) {
-        char* tok = RaveList_get(srcTokens, i);
-        if (tok != NULL && !strstr(buff, tok)) {
-          strcat(buff, ",");
-          strcat(buff, tok);
-        }
-      }
+  tgtTable = RaveField_getRadarIndexTable(targetField);
+  if (tgtTable == NULL) {
+    ctable = RAVE_OBJECT_CLONE(srcTable);
+    if (ctable == NULL) {
+      goto done;
     }
-
-    result = RaveAttributeHelp_createString("how/task_args", buff);
+    RaveField_setRadarIndexTable(targetField, ctable);
+  } else if (!RadarIndexTable_merge(tgtTable, srcTable)) {
+    goto done;
   }
 
-  RAVE_FREE(buff);
-  if (srcTokens != NULL) {
-    RaveList_freeAndDestroy(&srcTokens);
-  }
+  result = 1;
+done:
+  RAVE_OBJECT_RELEASE(tgtTable);
+  RAVE_OBJECT_RELEASE(srcTable);
+  RAVE_OBJECT_RELEASE(ctable);
   return result;
 }
 
@@ -701,24 +821,10 @@ static int TransformInternal_addTileToParameter(Transform_t* self, Cartesian_t*
           }
         }
 
-        if (strcmp("se.smhi.composite.index.radar", howTaskValue) == 0) { /* We want to concatenate all parts into one long string and ensure that there only is one / each */
-          RaveAttribute_t* tgtHowTaskArgAttr = RaveField_getAttribute(targetField, "how/task_args");
-          RaveAttribute_t* srcHowTaskArgAttr = RaveField_getAttribute(sourceField, "how/task_args");
-          RaveAttribute_t* mergedHowTaskArgAttr = NULL;
-          char *tgtHowTaskArgValue = NULL, *srcHowTaskArgValue = NULL;
-          if (tgtHowTaskArgAttr != NULL) {
-            RaveAttribute_getString(tgtHowTaskArgAttr, &tgtHowTaskArgValue);
-          }
-          if (srcHowTaskArgAttr != NULL) {
-            RaveAttribute_getString(srcHowTaskArgAttr, &srcHowTaskArgValue);
-          }
-          mergedHowTaskArgAttr = TransformInternal_mergeRadarIndexTaskArgs(tgtHowTaskArgValue, srcHowTaskArgValue);
-          if (mergedHowTaskArgAttr) {
-            RaveField_addAttribute(targetField, mergedHowTaskArgAttr);
+        if (strcmp("se.smhi.composite.index.radar", howTaskValue) == 0) { /* Merge the radar indexes so that there only is one entry / radar */
+          if (!TransformInternal_mergeRadarIndexTable(targetField, sourceField)) {
+            RAVE_WARNING0("Failed to merge radar index tables");
           }
-          RAVE_OBJECT_RELEASE(tgtHowTaskArgAttr);
-          RAVE_OBJECT_RELEASE(srcHowTaskArgAttr);
-          RAVE_OBJECT_RELEASE(mergedHowTaskArgAttr);
         }
       }
       RAVE_OBJECT_RELEASE(sourceField);
@@ -970,6 +1076,29 @@ done:
   return result;
 }
 
+TransformOperator_t* Transform_compile(Transform_t* self, Area_t* area, RadarDefinition_t* def, Rave_ProductType product, double value, double radius)
+{
+  TransformOperator_t* op = NULL;
+  TransformOperator_t* result = NULL;
+
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  RAVE_ASSERT((area != NULL), "area == NULL");
+  RAVE_ASSERT((def != NULL), "def == NULL");
+
+  op = RAVE_OBJECT_NEW(&TransformOperator_TYPE);
+  if (op == NULL) {
+    RAVE_ERROR0("Failed to create transform operator");
+    goto done;
+  }
+  if (!TransformOperator_compile(op, area, def, self->method, product, value, radius)) {
+    goto done;
+  }
+  result = RAVE_OBJECT_COPY(op);
+done:
+  RAVE_OBJECT_RELEASE(op);
+  return result;
+}
+
 /*@} End of Interface functions */
 
 RaveCoreObjectType Transform_TYPE = {
@@ -31,6 +31,7 @@ along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
 #include "cartesian.h"
 #include "radardefinition.h"
 #include "area.h"
+#include "transform_operator.h"
 
 /**
  * Defines a transformer
@@ -86,6 +87,38 @@ int Transform_cappi(Transform_t* transform, PolarVolume_t* pvol, Cartesian_t* ca
  */
 int Transform_pcappi(Transform_t* transform, PolarVolume_t* pvol, Cartesian_t* cartesian, double height);
 
+/**
+ * Creates a vertical maximum from the default parameter of a polar volume. The volume is resampled onto a
+ * \ref PolarCube_t with \ref PolarVolume_getCube and each pixel gets the maximum of the column it falls in.
+ * The value is stored with the gain and offset of the cartesian product.
+ * @param[in] transform - the transformer
+ * @param[in] pvol - the polar volume
+ * @param[in] cartesian - the cartesian product
+ * @returns 0 on failure, otherwise success
+ */
+int Transform_max(Transform_t* transform, PolarVolume_t* pvol, Cartesian_t* cartesian);
+
+/**
+ * Creates an echo top from the default parameter of a polar volume, see \ref Transform_max. The value is
+ * the height in km above sea level of the highest bin with a reflectivity >= threshold.
+ * @param[in] transform - the transformer
+ * @param[in] pvol - the polar volume
+ * @param[in] cartesian - the cartesian product
+ * @param[in] threshold - the reflectivity threshold in dBZ
+ * @returns 0 on failure, otherwise success
+ */
+int Transform_etop(Transform_t* transform, PolarVolume_t* pvol, Cartesian_t* cartesian, double threshold);
+
+/**
+ * Creates the vertically integrated liquid water content in kg/m2 from the default parameter of a polar volume,
+ * see \ref Transform_max. The default parameter must be reflectivity in dBZ.
+ * @param[in] transform - the transformer
+ * @param[in] pvol - the polar volume
+ * @param[in] cartesian - the cartesian product
+ * @returns 0 on failure, otherwise success
+ */
+int Transform_vil(Transform_t* transform, PolarVolume_t* pvol, Cartesian_t* cartesian);
+
 /**
  * Mirrors a cartesian product into a polar scan.
  * @param[in] transform - self
@@ -142,4 +175,17 @@ CartesianParam_t* Transform_accumulate(Transform_t* self, CartesianParam_t* para
  */
 Cartesian_t* Transform_combine_tiles(Transform_t* self, Area_t* area, RaveObjectList_t* tiles);
 
+/**
+ * Compiles a transform operator with the method of this transformer. The operator can be applied
+ * to any scan or volume with the geometry of the radar definition, see \ref TransformOperator_compile.
+ * @param[in] self - self
+ * @param[in] area - the area
+ * @param[in] def - the radar definition
+ * @param[in] product - Rave_ProductType_PPI, Rave_ProductType_CAPPI or Rave_ProductType_PCAPPI
+ * @param[in] value - the elevation angle in radians (PPI) or the height in meters (CAPPI, PCAPPI)
+ * @param[in] radius - the radius of influence for CRESSMAN, UNIFORM and INVERSE. If <= 0, the largest area scale is used.
+ * @return the operator or NULL on failure
+ */
+TransformOperator_t* Transform_compile(Transform_t* self, Area_t* area, RadarDefinition_t* def, Rave_ProductType product, double value, double radius);
+
 #endif
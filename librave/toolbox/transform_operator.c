@@ -0,0 +1,1120 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of RAVE.
+
+RAVE is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RAVE is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+/**
+ * A compiled polar to cartesian transformation.
+ * @file
+ * @date 2026-10-17
+ */
+#include "transform_operator.h"
+#include "polarnav.h"
+#include "projection.h"
+#include "projection_pipeline.h"
+#include "rave_debug.h"
+#include "rave_alloc.h"
+#include "rave_rowpool.h"
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+/**
+ * Identifies a saved operator
+ */
+#define TRANSFORM_OPERATOR_MAGIC "RAVETOP"
+
+/**
+ * Version of the saved format
+ */
+#define TRANSFORM_OPERATOR_VERSION 2
+
+/**
+ * Tolerance when comparing geometries
+ */
+#define TRANSFORM_OPERATOR_EPSILON 1e-9
+
+/**
+ * One weight in the operator
+ */
+typedef struct TransformOperatorEntry_t {
+  int ei;         /**< elevation index in the radar definition */
+  int ray;        /**< ray index */
+  int bin;        /**< bin index */
+  double weight;  /**< the weight */
+} TransformOperatorEntry_t;
+
+/**
+ * Represents the operator
+ */
+struct _TransformOperator_t {
+  RAVE_OBJECT_HEAD /** Always on top */
+  RaveTransformationMethod method; /**< the method */
+  Rave_ProductType product; /**< the product, UNDEFINED if not compiled */
+  double value;        /**< elevation angle or height */
+  double radius;       /**< radius of influence */
+  int nthreads;        /**< number of threads when applying */
+
+  long xsize;          /**< xsize of the area */
+  long ysize;          /**< ysize of the area */
+  double xscale;       /**< xscale of the area */
+  double yscale;       /**< yscale of the area */
+  double llX;          /**< lower left x of the area */
+  double llY;          /**< lower left y of the area */
+  double urX;          /**< upper right x of the area */
+  double urY;          /**< upper right y of the area */
+  char* pcsdef;        /**< the projection definition of the area */
+
+  double lon;          /**< radar longitude in radians */
+  double lat;          /**< radar latitude in radians */
+  double height;       /**< radar height */
+  long nrays;          /**< number of rays */
+  long nbins;          /**< number of bins */
+  double scale;        /**< bin length */
+  double rstart;       /**< range to the start of the first bin in km */
+  double astart;       /**< azimuth where the first ray starts in radians, only used if hasAstart */
+  int hasAstart;       /**< if the rays start at astart like in a scan with how/astart */
+  unsigned int nelangles; /**< number of elevation angles */
+  double* elangles;    /**< the elevation angles in radians */
+
+  long* rowptr;        /**< offset of the first entry of each pixel, xsize * ysize + 1 values */
+  TransformOperatorEntry_t* entries; /**< the weights */
+  long nentries;       /**< number of entries */
+};
+
+/*@{ Private functions */
+/**
+ * Releases the compiled data
+ */
+static void TransformOperatorInternal_clear(TransformOperator_t* self)
+{
+  RAVE_FREE(self->pcsdef);
+  RAVE_FREE(self->elangles);
+  RAVE_FREE(self->rowptr);
+  RAVE_FREE(self->entries);
+  self->nelangles = 0;
+  self->nentries = 0;
+  self->product = Rave_ProductType_UNDEFINED;
+}
+
+/**
+ * Constructor
+ */
+static int TransformOperator_constructor(RaveCoreObject* obj)
+{
+  TransformOperator_t* self = (TransformOperator_t*)obj;
+  self->method = NEAREST;
+  self->product = Rave_ProductType_UNDEFINED;
+  self->value = 0.0;
+  self->radius = 0.0;
+  self->nthreads = 1;
+  self->xsize = self->ysize = 0;
+  self->xscale = self->yscale = 0.0;
+  self->llX = self->llY = self->urX = self->urY = 0.0;
+  self->pcsdef = NULL;
+  self->lon = self->lat = self->height = 0.0;
+  self->nrays = self->nbins = 0;
+  self->scale = 0.0;
+  self->rstart = 0.0;
+  self->astart = 0.0;
+  self->hasAstart = 0;
+  self->nelangles = 0;
+  self->elangles = NULL;
+  self->rowptr = NULL;
+  self->entries = NULL;
+  self->nentries = 0;
+  return 1;
+}
+
+/**
+ * Copy constructor
+ */
+static int TransformOperator_copyconstructor(RaveCoreObject* obj, RaveCoreObject* srcobj)
+{
+  TransformOperator_t* self = (TransformOperator_t*)obj;
+  TransformOperator_t* src = (TransformOperator_t*)srcobj;
+  long npix = src->xsize * src->ysize;
+
+  self->method = src->method;
+  self->product = src->product;
+  self->value = src->value;
+  self->radius = src->radius;
+  self->nthreads = src->nthreads;
+  self->xsize = src->xsize;
+  self->ysize = src->ysize;
+  self->xscale = src->xscale;
+  self->yscale = src->yscale;
+  self->llX = src->llX;
+  self->llY = src->llY;
+  self->urX = src->urX;
+  self->urY = src->urY;
+  self->pcsdef = NULL;
+  self->lon = src->lon;
+  self->lat = src->lat;
+  self->height = src->height;
+  self->nrays = src->nrays;
+  self->nbins = src->nbins;
+  self->scale = src->scale;
+  self->rstart = src->rstart;
+  self->astart = src->astart;
+  self->hasAstart = src->hasAstart;
+  self->nelangles = src->nelangles;
+  self->elangles = NULL;
+  self->rowptr = NULL;
+  self->entries = NULL;
+  self->nentries = src->nentries;
+
+  if (src->pcsdef != NULL && (self->pcsdef = RAVE_STRDUP(src->pcsdef)) == NULL) {
+    goto error;
+  }
+  if (src->elangles != NULL) {
+    if ((self->elangles = RAVE_MALLOC(sizeof(double) * src->nelangles)) == NULL) {
+      goto error;
+    }
+    memcpy(self->elangles, src->elangles, sizeof(double) * src->nelangles);
+  }
+  if (src->rowptr != NULL) {
+    if ((self->rowptr = RAVE_MALLOC(sizeof(long) * (npix + 1))) == NULL) {
+      goto error;
+    }
+    memcpy(self->rowptr, src->rowptr, sizeof(long) * (npix + 1));
+  }
+  if (src->entries != NULL) {
+    if ((self->entries = RAVE_MALLOC(sizeof(TransformOperatorEntry_t) * (src->nentries > 0 ? src->nentries : 1))) == NULL) {
+      goto error;
+    }
+    memcpy(self->entries, src->entries, sizeof(TransformOperatorEntry_t) * src->nentries);
+  }
+  return 1;
+error:
+  TransformOperatorInternal_clear(self);
+  return 0;
+}
+
+/**
+ * Destructor
+ */
+static void TransformOperator_destructor(RaveCoreObject* obj)
+{
+  TransformOperatorInternal_clear((TransformOperator_t*)obj);
+}
+
+/**
+ * Adds an entry, growing the entry array when needed.
+ * @param[in] self - self
+ * @param[in,out] capacity - the allocated number of entries
+ * @param[in] ei - elevation index
+ * @param[in] ray - ray index
+ * @param[in] bin - bin index
+ * @param[in] weight - the weight
+ * @return 1 on success otherwise 0
+ */
+static int TransformOperatorInternal_addEntry(TransformOperator_t* self, long* capacity, int ei, int ray, int bin, double weight)
+{
+  if (self->nentries >= *capacity) {
+    long ncapacity = (*capacity > 0) ? *capacity * 2 : 1024;
+    TransformOperatorEntry_t* nentries = RAVE_REALLOC(self->entries, sizeof(TransformOperatorEntry_t) * ncapacity);
+    if (nentries == NULL) {
+      RAVE_ERROR0("Failed to allocate memory for operator entries");
+      return 0;
+    }
+    self->entries = nentries;
+    *capacity = ncapacity;
+  }
+  self->entries[self->nentries].ei = ei;
+  self->entries[self->nentries].ray = ray;
+  self->entries[self->nentries].bin = bin;
+  self->entries[self->nentries].weight = weight;
+  self->nentries++;
+  return 1;
+}
+
+/**
+ * Sort function used by qsort to get the elevation angles in ascending order.
+ */
+static int TransformOperatorInternal_sortDoubleAsc(const void* a, const void* b)
+{
+  double da = *((const double*)a);
+  double db = *((const double*)b);
+  if (da < db) {
+    return -1;
+  } else if (da > db) {
+    return 1;
+  }
+  return 0;
+}
+
+/**
+ * Returns the index of the elevation angle closest to e. The elevation angles are sorted in ascending
+ * order when the operator is compiled.
+ * @param[in] self - self
+ * @param[in] e - the elevation angle
+ * @param[in] insidee - if e must be within the lowest and highest elevation angle
+ * @return the index or -1 if insidee and e is outside
+ */
+static int TransformOperatorInternal_getElevationIndex(TransformOperator_t* self, double e, int insidee)
+{
+  unsigned int i = 0;
+  int result = 0;
+  if (self->nelangles == 0) {
+    return -1;
+  }
+  if (insidee && (e < self->elangles[0] || e > self->elangles[self->nelangles - 1])) {
+    return -1;
+  }
+  for (i = 1; i < self->nelangles; i++) {
+    if (fabs(e - self->elangles[i]) < fabs(e - self->elangles[result])) {
+      result = i;
+    }
+  }
+  return result;
+}
+
+/**
+ * Adds the weights for one pixel located at azimuth a and range r in the scan with elevation index ei.
+ * The bins start at rstart and, if hasAstart, the rays start at astart so that the same bins are
+ * used as when navigating in a \ref PolarScan_t.
+ * @param[in] self - self
+ * @param[in,out] capacity - the allocated number of entries
+ * @param[in] ei - the elevation index
+ * @param[in] a - the azimuth in radians
+ * @param[in] r - the range in meters
+ * @return 1 on success otherwise 0
+ */
+static int TransformOperatorInternal_addPixelWeights(TransformOperator_t* self, long* capacity, int ei, double a, double r)
+{
+  double azOffset = 2.0 * M_PI / self->nrays;
+  double r0 = self->rstart * 1000.0;
+  double a0 = self->hasAstart ? self->astart + azOffset / 2.0 : 0.0; /* Center of the first ray */
+  int ai = 0, ri = 0;
+
+  if (r < r0 || (long)floor((r - r0) / self->scale) >= self->nbins) {
+    return 1; /* Outside the scan, no weights */
+  }
+  ri = (int)floor((r - r0) / self->scale);
+  ai = ((int)rint((a - a0) / azOffset)) % self->nrays;
+  if (ai < 0) {
+    ai += self->nrays;
+  }
+
+  if (self->method == NEAREST) {
+    return TransformOperatorInternal_addEntry(self, capacity, ei, ai, ri, 1.0);
+  } else if (self->method == BILINEAR) {
+    double fa = (a - a0) / azOffset, fb = (r - r0) / self->scale - 0.5;
+    int ray0 = (int)floor(fa), bin0 = (int)floor(fb);
+    double ta = fa - ray0, tb = fb - bin0;
+    int i = 0, j = 0;
+    for (i = 0; i < 2; i++) {
+      int ray = (ray0 + i) % self->nrays;
+      double wa = (i == 0) ? (1.0 - ta) : ta;
+      if (ray < 0) {
+        ray += self->nrays;
+      }
+      for (j = 0; j < 2; j++) {
+        int bin = bin0 + j;
+        double w = wa * ((j == 0) ? (1.0 - tb) : tb);
+        if (bin >= 0 && bin < self->nbins && w > 0.0) {
+          if (!TransformOperatorInternal_addEntry(self, capacity, ei, ray, bin, w)) {
+            return 0;
+          }
+        }
+      }
+    }
+    return 1;
+  } else {
+    /* CRESSMAN, UNIFORM and INVERSE use all bins within the radius of influence */
+    double R = self->radius;
+    long start = self->nentries;
+    int bmin = (int)floor((r - r0 - R) / self->scale), bmax = (int)floor((r - r0 + R) / self->scale);
+    int nwin = self->nrays / 2, b = 0, i = 0;
+    if (r > R) {
+      nwin = (int)ceil(asin(R / r) / azOffset);
+    }
+    if (2 * nwin + 1 > self->nrays) {
+      nwin = (self->nrays - 1) / 2;
+    }
+    bmin = (bmin < 0) ? 0 : bmin;
+    bmax = (bmax >= self->nbins) ? self->nbins - 1 : bmax;
+    for (i = -nwin; i <= nwin; i++) {
+      int ray = (ai + i) % self->nrays;
+      double da = 0.0;
+      if (ray < 0) {
+        ray += self->nrays;
+      }
+      da = a - (a0 + ray * azOffset);
+      for (b = bmin; b <= bmax; b++) {
+        double rb = r0 + (b + 0.5) * self->scale;
+        double d2 = r * r + rb * rb - 2.0 * r * rb * cos(da);
+        if (d2 < R * R) {
+          double w = 1.0;
+          if (self->method == CRESSMAN) {
+            w = (R * R - d2) / (R * R + d2);
+          } else if (self->method == INVERSE) {
+            w = 1.0 - sqrt(d2 > 0.0 ? d2 : 0.0) / R;
+          }
+          if (!TransformOperatorInternal_addEntry(self, capacity, ei, ray, b, w)) {
+            return 0;
+          }
+        }
+      }
+    }
+    if (self->nentries == start) {
+      /* No bin center within the radius, fall back on the nearest bin */
+      return TransformOperatorInternal_addEntry(self, capacity, ei, ai, ri, 1.0);
+    }
+    return 1;
+  }
+}
+
+/**
+ * Returns the parameter of the scan that should be used and verifies that the geometry matches.
+ * @param[in] self - self
+ * @param[in] scan - the scan
+ * @return the parameter or NULL if geometry does not match or there is no default parameter
+ */
+static PolarScanParam_t* TransformOperatorInternal_getScanParameter(TransformOperator_t* self, PolarScan_t* scan)
+{
+  PolarScanParam_t* param = NULL;
+  double astart = 0.0;
+  int hasAstart = 0;
+  if (PolarScan_useAzimuthalNavInformation(scan) && PolarScan_hasAttribute(scan, "how/astart")) {
+    RaveAttribute_t* attr = PolarScan_getAttribute(scan, "how/astart");
+    hasAstart = (attr != NULL && RaveAttribute_getDouble(attr, &astart));
+    astart = astart * M_PI / 180.0;
+    RAVE_OBJECT_RELEASE(attr);
+  }
+  if (PolarScan_getNrays(scan) != self->nrays ||
+      PolarScan_getNbins(scan) != self->nbins ||
+      fabs(PolarScan_getRscale(scan) - self->scale) > TRANSFORM_OPERATOR_EPSILON ||
+      fabs(PolarScan_getRstart(scan) - self->rstart) > TRANSFORM_OPERATOR_EPSILON ||
+      hasAstart != self->hasAstart || (hasAstart && fabs(astart - self->astart) > TRANSFORM_OPERATOR_EPSILON)) {
+    RAVE_ERROR0("Scan geometry does not match the geometry of the operator");
+    return NULL;
+  }
+  param = PolarScan_getParameter(scan, PolarScan_getDefaultParameter(scan));
+  if (param == NULL) {
+    RAVE_ERROR0("Scan does not have a default parameter");
+    return NULL;
+  }
+  /* Make sure that the data is available before the threads start using it */
+  if (PolarScanParam_getReadOnlyData(param) == NULL) {
+    RAVE_OBJECT_RELEASE(param);
+  }
+  return param;
+}
+
+/**
+ * Arguments when applying the operator to a set of rows
+ */
+typedef struct TransformOperatorJob_t {
+  TransformOperator_t* self;    /**< the operator */
+  PolarScanParam_t** params;    /**< one parameter per elevation index, may contain NULL */
+  CartesianParam_t* target;     /**< the target */
+  double nodata;                /**< cartesian nodata */
+  double undetect;              /**< cartesian undetect */
+} TransformOperatorJob_t;
+
+/**
+ * Applies the operator to one row.
+ */
+static void TransformOperatorInternal_applyRow(TransformOperatorJob_t* job, long y)
+{
+  TransformOperator_t* self = job->self;
+  long x = 0, i = 0;
+  for (x = 0; x < self->xsize; x++) {
+    long pix = y * self->xsize + x;
+    double vsum = 0.0, wsum = 0.0, v = job->nodata;
+    int undetect = 0;
+    for (i = self->rowptr[pix]; i < self->rowptr[pix + 1]; i++) {
+      TransformOperatorEntry_t* e = &self->entries[i];
+      PolarScanParam_t* param = job->params[e->ei];
+      double pv = 0.0;
+      RaveValueType t = RaveValueType_NODATA;
+      if (param != NULL) {
+        t = PolarScanParam_getValue(param, e->bin, e->ray, &pv);
+      }
+      if (t == RaveValueType_DATA) {
+        vsum += pv * e->weight;
+        wsum += e->weight;
+      } else if (t == RaveValueType_UNDETECT) {
+        undetect = 1;
+      }
+    }
+    if (wsum > 0.0) {
+      v = vsum / wsum;
+    } else if (undetect) {
+      v = job->undetect;
+    }
+    CartesianParam_setValue(job->target, x, y, v);
+  }
+}
+
+/**
+ * Row function for \ref RaveRowPool_run.
+ */
+static int TransformOperatorInternal_processRow(void* arg, void* worker, long y)
+{
+  TransformOperatorInternal_applyRow((TransformOperatorJob_t*)arg, y);
+  return 1;
+}
+
+/**
+ * Applies the operator with one parameter per elevation index.
+ * @param[in] self - self
+ * @param[in] params - the parameters, nelangles items that may be NULL
+ * @param[in] cartesian - the target
+ * @return 1 on success otherwise 0
+ */
+static int TransformOperatorInternal_apply(TransformOperator_t* self, PolarScanParam_t** params, Cartesian_t* cartesian)
+{
+  TransformOperatorJob_t job;
+  int result = 0;
+
+  if (self->product == Rave_ProductType_UNDEFINED) {
+    RAVE_ERROR0("Operator has not been compiled");
+    return 0;
+  }
+  if (!Cartesian_isTransformable(cartesian) ||
+      Cartesian_getXSize(cartesian) != self->xsize ||
+      Cartesian_getYSize(cartesian) != self->ysize) {
+    RAVE_ERROR0("Cartesian product is not possible to transform with this operator");
+    return 0;
+  }
+
+  job.self = self;
+  job.params = params;
+  job.target = Cartesian_getParameter(cartesian, Cartesian_getDefaultParameter(cartesian));
+  job.nodata = Cartesian_getNodata(cartesian);
+  job.undetect = Cartesian_getUndetect(cartesian);
+  if (job.target == NULL || CartesianParam_getData(job.target) == NULL) {
+    RAVE_ERROR0("Cartesian product does not have a default parameter");
+    goto done;
+  }
+
+  RaveRowPool_run(self->ysize, self->nthreads, TransformOperatorInternal_processRow, NULL, NULL, &job);
+  result = 1;
+done:
+  RAVE_OBJECT_RELEASE(job.target);
+  return result;
+}
+
+/**
+ * Writes a string as length followed by the characters.
+ */
+static int TransformOperatorInternal_writeString(FILE* fp, const char* str)
+{
+  int len = (str != NULL) ? (int)strlen(str) : -1;
+  if (fwrite(&len, sizeof(int), 1, fp) != 1) {
+    return 0;
+  }
+  return (len <= 0 || fwrite(str, 1, len, fp) == (size_t)len);
+}
+
+/**
+ * Reads a string written with \ref TransformOperatorInternal_writeString.
+ */
+static int TransformOperatorInternal_readString(FILE* fp, char** str)
+{
+  int len = 0;
+  *str = NULL;
+  if (fread(&len, sizeof(int), 1, fp) != 1 || len > 65536) {
+    return 0;
+  }
+  if (len < 0) {
+    return 1;
+  }
+  if ((*str = RAVE_MALLOC(len + 1)) == NULL) {
+    return 0;
+  }
+  if (len > 0 && fread(*str, 1, len, fp) != (size_t)len) {
+    RAVE_FREE(*str);
+    return 0;
+  }
+  (*str)[len] = '\0';
+  return 1;
+}
+
+/**
+ * Compares two possibly NULL strings
+ */
+static int TransformOperatorInternal_equalStrings(const char* a, const char* b)
+{
+  if (a == NULL || b == NULL) {
+    return (a == b);
+  }
+  return (strcmp(a, b) == 0);
+}
+/*@} End of Private functions */
+
+/*@{ Interface functions */
+int TransformOperator_compile(TransformOperator_t* self, Area_t* area, RadarDefinition_t* def,
+  RaveTransformationMethod method, Rave_ProductType product, double value, double radius)
+{
+  int result = 0;
+  Projection_t* areapj = NULL;
+  Projection_t* radarpj = NULL;
+  ProjectionPipeline_t* pipeline = NULL;
+  PolarNavigator_t* navigator = NULL;
+  double* angles = NULL;
+  unsigned int nangles = 0;
+  long capacity = 0, x = 0, y = 0;
+  int ppiIndex = -1;
+
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  RAVE_ASSERT((area != NULL), "area == NULL");
+  RAVE_ASSERT((def != NULL), "def == NULL");
+
+  TransformOperatorInternal_clear(self);
+
+  if (method != NEAREST && method != BILINEAR && method != CRESSMAN && method != UNIFORM && method != INVERSE) {
+    RAVE_ERROR0("Unsupported transformation method");
+    goto done;
+  }
+  if (product != Rave_ProductType_PPI && product != Rave_ProductType_CAPPI && product != Rave_ProductType_PCAPPI) {
+    RAVE_ERROR0("Only PPI, CAPPI and PCAPPI operators can be compiled");
+    goto done;
+  }
+  if (Area_getXSize(area) <= 0 || Area_getYSize(area) <= 0 ||
+      RadarDefinition_getNrays(def) <= 0 || RadarDefinition_getNbins(def) <= 0 || RadarDefinition_getScale(def) <= 0.0) {
+    RAVE_ERROR0("Area and radar definition must have a size");
+    goto done;
+  }
+  if (!RadarDefinition_getElangles(def, &nangles, &angles) || nangles == 0) {
+    RAVE_ERROR0("Radar definition does not have any elevation angles");
+    goto done;
+  }
+  /* The scans are looked up by elevation angle when applied, so the order of the definition does not matter */
+  qsort(angles, nangles, sizeof(double), TransformOperatorInternal_sortDoubleAsc);
+
+  areapj = Area_getProjection(area);
+  radarpj = RadarDefinition_getProjection(def);
+  if (radarpj == NULL) {
+    radarpj = Projection_createDefaultLonLatProjection();
+  }
+  if (areapj == NULL || radarpj == NULL) {
+    RAVE_ERROR0("Area does not have a projection");
+    goto done;
+  }
+  pipeline = ProjectionPipeline_createPipeline(areapj, radarpj);
+  navigator = RAVE_OBJECT_NEW(&PolarNavigator_TYPE);
+  if (pipeline == NULL || navigator == NULL) {
+    RAVE_ERROR0("Failed to create pipeline or navigator");
+    goto done;
+  }
+
+  self->method = method;
+  self->value = value;
+  self->xsize = Area_getXSize(area);
+  self->ysize = Area_getYSize(area);
+  self->xscale = Area_getXScale(area);
+  self->yscale = Area_getYScale(area);
+  Area_getExtent(area, &self->llX, &self->llY, &self->urX, &self->urY);
+  self->pcsdef = RAVE_STRDUP(Projection_getDefinition(areapj));
+  self->lon = RadarDefinition_getLongitude(def);
+  self->lat = RadarDefinition_getLatitude(def);
+  self->height = RadarDefinition_getHeight(def);
+  self->nrays = RadarDefinition_getNrays(def);
+  self->nbins = RadarDefinition_getNbins(def);
+  self->scale = RadarDefinition_getScale(def);
+  self->nelangles = nangles;
+  self->elangles = angles;
+  angles = NULL;
+  self->radius = radius;
+  if (self->radius <= 0.0) {
+    self->radius = (self->xscale > self->yscale) ? self->xscale : self->yscale;
+  }
+  self->rowptr = RAVE_MALLOC(sizeof(long) * (self->xsize * self->ysize + 1));
+  if (self->pcsdef == NULL || self->rowptr == NULL) {
+    RAVE_ERROR0("Failed to allocate memory for operator");
+    goto done;
+  }
+  self->rowptr[0] = 0;
+
+  PolarNavigator_setLon0(navigator, self->lon);
+  PolarNavigator_setLat0(navigator, self->lat);
+  PolarNavigator_setAlt0(navigator, self->height);
+
+  if (product == Rave_ProductType_PPI) {
+    ppiIndex = TransformOperatorInternal_getElevationIndex(self, value, 0);
+  }
+
+  for (y = 0; y < self->ysize; y++) {
+    for (x = 0; x < self->xsize; x++) {
+      double herex = self->llX + self->xscale * (double)x;
+      double herey = self->urY - self->yscale * (double)y;
+      double d = 0.0, a = 0.0, r = 0.0, e = 0.0, h = 0.0;
+      int ei = ppiIndex;
+      if (!ProjectionPipeline_fwd(pipeline, herex, herey, &herex, &herey)) {
+        RAVE_ERROR0("Transform failed");
+        goto done;
+      }
+      PolarNavigator_llToDa(navigator, herey, herex, &d, &a);
+      if (product == Rave_ProductType_PPI) {
+        PolarNavigator_deToRh(navigator, d, self->elangles[ei], &r, &h);
+      } else {
+        PolarNavigator_dhToRe(navigator, d, value, &r, &e);
+        ei = TransformOperatorInternal_getElevationIndex(self, e, product == Rave_ProductType_CAPPI);
+      }
+      if (ei >= 0 && !TransformOperatorInternal_addPixelWeights(self, &capacity, ei, a, r)) {
+        goto done;
+      }
+      self->rowptr[y * self->xsize + x + 1] = self->nentries;
+    }
+  }
+
+  self->product = product;
+  result = 1;
+done:
+  if (!result) {
+    TransformOperatorInternal_clear(self);
+  }
+  RAVE_FREE(angles);
+  RAVE_OBJECT_RELEASE(areapj);
+  RAVE_OBJECT_RELEASE(radarpj);
+  RAVE_OBJECT_RELEASE(pipeline);
+  RAVE_OBJECT_RELEASE(navigator);
+  return result;
+}
+
+int TransformOperator_isCompiledFor(TransformOperator_t* self, Area_t* area, RadarDefinition_t* def,
+  RaveTransformationMethod method, Rave_ProductType product, double value)
+{
+  int result = 0;
+  Projection_t* areapj = NULL;
+  double llX = 0.0, llY = 0.0, urX = 0.0, urY = 0.0;
+  double* angles = NULL;
+  unsigned int nangles = 0, i = 0;
+
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  RAVE_ASSERT((area != NULL), "area == NULL");
+  RAVE_ASSERT((def != NULL), "def == NULL");
+
+  if (self->product == Rave_ProductType_UNDEFINED || self->product != product || self->method != method ||
+      fabs(self->value - value) > TRANSFORM_OPERATOR_EPSILON) {
+    goto done;
+  }
+  areapj = Area_getProjection(area);
+  Area_getExtent(area, &llX, &llY, &urX, &urY);
+  if (areapj == NULL || !TransformOperatorInternal_equalStrings(self->pcsdef, Projection_getDefinition(areapj)) ||
+      Area_getXSize(area) != self->xsize || Area_getYSize(area) != self->ysize ||
+      fabs(Area_getXScale(area) - self->xscale) > TRANSFORM_OPERATOR_EPSILON ||
+      fabs(Area_getYScale(area) - self->yscale) > TRANSFORM_OPERATOR_EPSILON ||
+      fabs(llX - self->llX) > TRANSFORM_OPERATOR_EPSILON || fabs(urY - self->urY) > TRANSFORM_OPERATOR_EPSILON) {
+    goto done;
+  }
+  if (fabs(RadarDefinition_getLongitude(def) - self->lon) > TRANSFORM_OPERATOR_EPSILON ||
+      fabs(RadarDefinition_getLatitude(def) - self->lat) > TRANSFORM_OPERATOR_EPSILON ||
+      fabs(RadarDefinition_getHeight(def) - self->height) > TRANSFORM_OPERATOR_EPSILON ||
+      RadarDefinition_getNrays(def) != self->nrays || RadarDefinition_getNbins(def) != self->nbins ||
+      fabs(RadarDefinition_getScale(def) - self->scale) > TRANSFORM_OPERATOR_EPSILON) {
+    goto done;
+  }
+  if (!RadarDefinition_getElangles(def, &nangles, &angles) || nangles != self->nelangles) {
+    goto done;
+  }
+  qsort(angles, nangles, sizeof(double), TransformOperatorInternal_sortDoubleAsc);
+  for (i = 0; i < nangles; i++) {
+    if (fabs(angles[i] - self->elangles[i]) > TRANSFORM_OPERATOR_EPSILON) {
+      goto done;
+    }
+  }
+  result = 1;
+done:
+  RAVE_FREE(angles);
+  RAVE_OBJECT_RELEASE(areapj);
+  return result;
+}
+
+RaveTransformationMethod TransformOperator_getMethod(TransformOperator_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return self->method;
+}
+
+Rave_ProductType TransformOperator_getProduct(TransformOperator_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return self->product;
+}
+
+double TransformOperator_getValue(TransformOperator_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return self->value;
+}
+
+double TransformOperator_getRadius(TransformOperator_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return self->radius;
+}
+
+long TransformOperator_getXSize(TransformOperator_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return self->xsize;
+}
+
+long TransformOperator_getYSize(TransformOperator_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return self->ysize;
+}
+
+long TransformOperator_getNumberOfEntries(TransformOperator_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return self->nentries;
+}
+
+void TransformOperator_setRstart(TransformOperator_t* self, double rstart)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  self->rstart = rstart;
+}
+
+double TransformOperator_getRstart(TransformOperator_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return self->rstart;
+}
+
+void TransformOperator_setAstart(TransformOperator_t* self, double astart)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  self->astart = astart;
+  self->hasAstart = 1;
+}
+
+double TransformOperator_getAstart(TransformOperator_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return self->astart;
+}
+
+int TransformOperator_hasAstart(TransformOperator_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return self->hasAstart;
+}
+
+int TransformOperator_setNumberOfThreads(TransformOperator_t* self, int nthreads)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  if (nthreads < 1) {
+    return 0;
+  }
+  self->nthreads = nthreads;
+  return 1;
+}
+
+int TransformOperator_getNumberOfThreads(TransformOperator_t* self)
+{
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  return self->nthreads;
+}
+
+int TransformOperator_applyScan(TransformOperator_t* self, PolarScan_t* scan, Cartesian_t* cartesian)
+{
+  int result = 0;
+  unsigned int i = 0;
+  PolarScanParam_t** params = NULL;
+
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  RAVE_ASSERT((scan != NULL), "scan == NULL");
+  RAVE_ASSERT((cartesian != NULL), "cartesian == NULL");
+
+  if (self->product == Rave_ProductType_UNDEFINED) {
+    RAVE_ERROR0("Operator has not been compiled");
+    return 0;
+  }
+  params = RAVE_MALLOC(sizeof(PolarScanParam_t*) * self->nelangles);
+  if (params == NULL) {
+    goto done;
+  }
+  memset(params, 0, sizeof(PolarScanParam_t*) * self->nelangles);
+
+  /* A PPI operator only refers to one elevation, let the scan provide that one */
+  if (self->product == Rave_ProductType_PPI) {
+    int ei = TransformOperatorInternal_getElevationIndex(self, self->value, 0);
+    if ((params[ei] = TransformOperatorInternal_getScanParameter(self, scan)) == NULL) {
+      goto done;
+    }
+  } else {
+    int ei = TransformOperatorInternal_getElevationIndex(self, PolarScan_getElangle(scan), 0);
+    if ((params[ei] = TransformOperatorInternal_getScanParameter(self, scan)) == NULL) {
+      goto done;
+    }
+  }
+
+  result = TransformOperatorInternal_apply(self, params, cartesian);
+done:
+  if (params != NULL) {
+    for (i = 0; i < self->nelangles; i++) {
+      RAVE_OBJECT_RELEASE(params[i]);
+    }
+    RAVE_FREE(params);
+  }
+  return result;
+}
+
+int TransformOperator_applyVolume(TransformOperator_t* self, PolarVolume_t* pvol, Cartesian_t* cartesian)
+{
+  int result = 0;
+  unsigned int i = 0;
+  PolarScanParam_t** params = NULL;
+
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  RAVE_ASSERT((pvol != NULL), "pvol == NULL");
+  RAVE_ASSERT((cartesian != NULL), "cartesian == NULL");
+
+  if (self->product == Rave_ProductType_UNDEFINED) {
+    RAVE_ERROR0("Operator has not been compiled");
+    return 0;
+  }
+  if (PolarVolume_getNumberOfScans(pvol) <= 0) {
+    RAVE_ERROR0("Volume does not contain any scans");
+    return 0;
+  }
+  params = RAVE_MALLOC(sizeof(PolarScanParam_t*) * self->nelangles);
+  if (params == NULL) {
+    goto done;
+  }
+  memset(params, 0, sizeof(PolarScanParam_t*) * self->nelangles);
+
+  for (i = 0; i < self->nelangles; i++) {
+    PolarScan_t* scan = PolarVolume_getScanClosestToElevation(pvol, self->elangles[i], 0);
+    if (scan != NULL) {
+      params[i] = TransformOperatorInternal_getScanParameter(self, scan);
+      RAVE_OBJECT_RELEASE(scan);
+      if (params[i] == NULL) {
+        goto done;
+      }
+    }
+  }
+
+  result = TransformOperatorInternal_apply(self, params, cartesian);
+done:
+  if (params != NULL) {
+    for (i = 0; i < self->nelangles; i++) {
+      RAVE_OBJECT_RELEASE(params[i]);
+    }
+    RAVE_FREE(params);
+  }
+  return result;
+}
+
+int TransformOperator_save(TransformOperator_t* self, const char* filename)
+{
+  FILE* fp = NULL;
+  int result = 0, fd = -1;
+  int version = TRANSFORM_OPERATOR_VERSION;
+  int method = 0, product = 0;
+  long npix = 0;
+  char magic[8];
+  char* tmpname = NULL;
+
+  RAVE_ASSERT((self != NULL), "self == NULL");
+  RAVE_ASSERT((filename != NULL), "filename == NULL");
+
+  if (self->product == Rave_ProductType_UNDEFINED) {
+    RAVE_ERROR0("Operator has not been compiled");
+    return 0;
+  }
+  /* Write to a temporary file that is renamed when complete so that a concurrent load never sees a partial operator */
+  tmpname = RAVE_MALLOC(strlen(filename) + 8);
+  if (tmpname == NULL) {
+    RAVE_ERROR0("Failed to allocate memory for file name");
+    return 0;
+  }
+  sprintf(tmpname, "%s.XXXXXX", filename);
+  if ((fd = mkstemp(tmpname)) < 0 || fchmod(fd, 0644) != 0 || (fp = fdopen(fd, "wb")) == NULL) {
+    RAVE_ERROR1("Failed to open %s for writing", filename);
+    if (fd >= 0) {
+      close(fd);
+      remove(tmpname);
+    }
+    RAVE_FREE(tmpname);
+    return 0;
+  }
+  memset(magic, 0, sizeof(magic));
+  strcpy(magic, TRANSFORM_OPERATOR_MAGIC);
+  method = (int)self->method;
+  product = (int)self->product;
+  npix = self->xsize * self->ysize;
+
+  if (fwrite(magic, sizeof(magic), 1, fp) != 1 ||
+      fwrite(&version, sizeof(int), 1, fp) != 1 ||
+      fwrite(&method, sizeof(int), 1, fp) != 1 ||
+      fwrite(&product, sizeof(int), 1, fp) != 1 ||
+      fwrite(&self->value, sizeof(double), 1, fp) != 1 ||
+      fwrite(&self->radius, sizeof(double), 1, fp) != 1 ||
+      fwrite(&self->xsize, sizeof(long), 1, fp) != 1 ||
+      fwrite(&self->ysize, sizeof(long), 1, fp) != 1 ||
+      fwrite(&self->xscale, sizeof(double), 1, fp) != 1 ||
+      fwrite(&self->yscale, sizeof(double), 1, fp) != 1 ||
+      fwrite(&self->llX, sizeof(double), 1, fp) != 1 ||
+      fwrite(&self->llY, sizeof(double), 1, fp) != 1 ||
+      fwrite(&self->urX, sizeof(double), 1, fp) != 1 ||
+      fwrite(&self->urY, sizeof(double), 1, fp) != 1 ||
+      !TransformOperatorInternal_writeString(fp, self->pcsdef) ||
+      fwrite(&self->lon, sizeof(double), 1, fp) != 1 ||
+      fwrite(&self->lat, sizeof(double), 1, fp) != 1 ||
+      fwrite(&self->height, sizeof(double), 1, fp) != 1 ||
+      fwrite(&self->nrays, sizeof(long), 1, fp) != 1 ||
+      fwrite(&self->nbins, sizeof(long), 1, fp) != 1 ||
+      fwrite(&self->scale, sizeof(double), 1, fp) != 1 ||
+      fwrite(&self->rstart, sizeof(double), 1, fp) != 1 ||
+      fwrite(&self->astart, sizeof(double), 1, fp) != 1 ||
+      fwrite(&self->hasAstart, sizeof(int), 1, fp) != 1 ||
+      fwrite(&self->nelangles, sizeof(unsigned int), 1, fp) != 1 ||
+      fwrite(self->elangles, sizeof(double), self->nelangles, fp) != self->nelangles ||
+      fwrite(&self->nentries, sizeof(long), 1, fp) != 1 ||
+      fwrite(self->rowptr, sizeof(long), npix + 1, fp) != (size_t)(npix + 1) ||
+      fwrite(self->entries, sizeof(TransformOperatorEntry_t), self->nentries, fp) != (size_t)self->nentries) {
+    RAVE_ERROR1("Failed to write operator to %s", filename);
+    goto done;
+  }
+  result = 1;
+done:
+  if (fclose(fp) != 0) {
+    result = 0;
+  }
+  if (result && rename(tmpname, filename) != 0) {
+    RAVE_ERROR1("Failed to rename operator to %s", filename);
+    result = 0;
+  }
+  if (!result) {
+    remove(tmpname);
+  }
+  RAVE_FREE(tmpname);
+  return result;
+}
+
+TransformOperator_t* TransformOperator_load(const char* filename)
+{
+  TransformOperator_t* self = NULL;
+  TransformOperator_t* result = NULL;
+  FILE* fp = NULL;
+  char magic[8];
+  int version = 0, method = 0, product = 0;
+  long npix = 0, i = 0;
+
+  RAVE_ASSERT((filename != NULL), "filename == NULL");
+
+  if ((fp = fopen(filename, "rb")) == NULL) {
+    RAVE_ERROR1("Failed to open %s", filename);
+    return NULL;
+  }
+  self = RAVE_OBJECT_NEW(&TransformOperator_TYPE);
+  if (self == NULL) {
+    goto done;
+  }
+
+  if (fread(magic, sizeof(magic), 1, fp) != 1 || strncmp(magic, TRANSFORM_OPERATOR_MAGIC, sizeof(magic)) != 0 ||
+      fread(&version, sizeof(int), 1, fp) != 1 || version != TRANSFORM_OPERATOR_VERSION) {
+    RAVE_ERROR1("%s is not a transform operator of a supported version", filename);
+    goto done;
+  }
+  if (fread(&method, sizeof(int), 1, fp) != 1 ||
+      fread(&product, sizeof(int), 1, fp) != 1 ||
+      fread(&self->value, sizeof(double), 1, fp) != 1 ||
+      fread(&self->radius, sizeof(double), 1, fp) != 1 ||
+      fread(&self->xsize, sizeof(long), 1, fp) != 1 ||
+      fread(&self->ysize, sizeof(long), 1, fp) != 1 ||
+      fread(&self->xscale, sizeof(double), 1, fp) != 1 ||
+      fread(&self->yscale, sizeof(double), 1, fp) != 1 ||
+      fread(&self->llX, sizeof(double), 1, fp) != 1 ||
+      fread(&self->llY, sizeof(double), 1, fp) != 1 ||
+      fread(&self->urX, sizeof(double), 1, fp) != 1 ||
+      fread(&self->urY, sizeof(double), 1, fp) != 1 ||
+      !TransformOperatorInternal_readString(fp, &self->pcsdef) ||
+      fread(&self->lon, sizeof(double), 1, fp) != 1 ||
+      fread(&self->lat, sizeof(double), 1, fp) != 1 ||
+      fread(&self->height, sizeof(double), 1, fp) != 1 ||
+      fread(&self->nrays, sizeof(long), 1, fp) != 1 ||
+      fread(&self->nbins, sizeof(long), 1, fp) != 1 ||
+      fread(&self->scale, sizeof(double), 1, fp) != 1 ||
+      fread(&self->rstart, sizeof(double), 1, fp) != 1 ||
+      fread(&self->astart, sizeof(double), 1, fp) != 1 ||
+      fread(&self->hasAstart, sizeof(int), 1, fp) != 1 ||
+      fread(&self->nelangles, sizeof(unsigned int), 1, fp) != 1) {
+    RAVE_ERROR1("Failed to read operator header from %s", filename);
+    goto done;
+  }
+  if ((product != Rave_ProductType_PPI && product != Rave_ProductType_CAPPI && product != Rave_ProductType_PCAPPI) ||
+      self->xsize <= 0 || self->ysize <= 0 || self->nrays <= 0 || self->nbins <= 0 ||
+      self->nelangles == 0 || self->nelangles > 1024) {
+    RAVE_ERROR1("Corrupt operator header in %s", filename);
+    goto done;
+  }
+  npix = self->xsize * self->ysize;
+  self->elangles = RAVE_MALLOC(sizeof(double) * self->nelangles);
+  self->rowptr = RAVE_MALLOC(sizeof(long) * (npix + 1));
+  if (self->elangles == NULL || self->rowptr == NULL ||
+      fread(self->elangles, sizeof(double), self->nelangles, fp) != self->nelangles ||
+      fread(&self->nentries, sizeof(long), 1, fp) != 1 || self->nentries < 0 ||
+      fread(self->rowptr, sizeof(long), npix + 1, fp) != (size_t)(npix + 1)) {
+    RAVE_ERROR1("Failed to read operator from %s", filename);
+    goto done;
+  }
+  self->entries = RAVE_MALLOC(sizeof(TransformOperatorEntry_t) * (self->nentries > 0 ? self->nentries : 1));
+  if (self->entries == NULL ||
+      fread(self->entries, sizeof(TransformOperatorEntry_t), self->nentries, fp) != (size_t)self->nentries) {
+    RAVE_ERROR1("Failed to read operator entries from %s", filename);
+    goto done;
+  }
+
+  /* Verify the matrix so that a corrupt file can not make apply read outside the arrays */
+  if (self->rowptr[0] != 0 || self->rowptr[npix] != self->nentries) {
+    RAVE_ERROR1("Corrupt operator in %s", filename);
+    goto done;
+  }
+  for (i = 0; i < npix; i++) {
+    if (self->rowptr[i + 1] < self->rowptr[i]) {
+      RAVE_ERROR1("Corrupt operator in %s", filename);
+      goto done;
+    }
+  }
+  for (i = 0; i < self->nentries; i++) {
+    TransformOperatorEntry_t* e = &self->entries[i];
+    if (e->ei < 0 || e->ei >= (int)self->nelangles || e->ray < 0 || e->ray >= self->nrays ||
+        e->bin < 0 || e->bin >= self->nbins) {
+      RAVE_ERROR1("Corrupt operator in %s", filename);
+      goto done;
+    }
+  }
+
+  self->method = (RaveTransformationMethod)method;
+  self->product = (Rave_ProductType)product;
+  result = RAVE_OBJECT_COPY(self);
+done:
+  fclose(fp);
+  RAVE_OBJECT_RELEASE(self);
+  return result;
+}
+/*@} End of Interface functions */
+
+RaveCoreObjectType TransformOperator_TYPE = {
+    "TransformOperator",
+    sizeof(TransformOperator_t),
+    TransformOperator_constructor,
+    TransformOperator_destructor,
+    TransformOperator_copyconstructor
+};
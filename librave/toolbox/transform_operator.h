@@ -0,0 +1,205 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of RAVE.
+
+RAVE is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RAVE is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+/**
+ * A compiled polar to cartesian transformation. For a given area, radar definition, method and
+ * product the mapping from every cartesian pixel to the polar bins it is derived from is calculated
+ * once and stored as a sparse matrix (compressed rows of bin indices and weights). The operator can
+ * then be applied to any scan or volume with the same geometry, saved to disk and loaded again.
+ * @file
+ * @date 2026-10-17
+ */
+#ifndef TRANSFORM_OPERATOR_H
+#define TRANSFORM_OPERATOR_H
+#include "rave_object.h"
+#include "rave_types.h"
+#include "area.h"
+#include "radardefinition.h"
+#include "polarscan.h"
+#include "polarvolume.h"
+#include "cartesian.h"
+
+/**
+ * Defines a transform operator
+ */
+typedef struct _TransformOperator_t TransformOperator_t;
+
+/**
+ * Type definition to use when creating a rave object.
+ */
+extern RaveCoreObjectType TransformOperator_TYPE;
+
+/**
+ * Compiles the operator.
+ * Supported methods are NEAREST, BILINEAR, CRESSMAN, UNIFORM and INVERSE. Supported products are
+ * Rave_ProductType_PPI (value is the elevation angle in radians and the closest elevation angle in the
+ * radar definition is used), Rave_ProductType_CAPPI and Rave_ProductType_PCAPPI (value is the height in meters).
+ * The elevation angles of the radar definition may be given in any order.
+ * @param[in] self - self
+ * @param[in] area - the area
+ * @param[in] def - the radar definition
+ * @param[in] method - the transformation method
+ * @param[in] product - the product
+ * @param[in] value - the elevation angle (PPI) or height (CAPPI, PCAPPI)
+ * @param[in] radius - the radius of influence in meters for CRESSMAN, UNIFORM and INVERSE. If <= 0, the largest of the area scales is used.
+ * @return 1 on success otherwise 0
+ */
+int TransformOperator_compile(TransformOperator_t* self, Area_t* area, RadarDefinition_t* def,
+  RaveTransformationMethod method, Rave_ProductType product, double value, double radius);
+
+/**
+ * Returns if the operator has been compiled for the specified setup.
+ * @param[in] self - self
+ * @param[in] area - the area
+ * @param[in] def - the radar definition
+ * @param[in] method - the transformation method
+ * @param[in] product - the product
+ * @param[in] value - the elevation angle (PPI) or height (CAPPI, PCAPPI)
+ * @return 1 if the operator can be used for the setup, otherwise 0
+ */
+int TransformOperator_isCompiledFor(TransformOperator_t* self, Area_t* area, RadarDefinition_t* def,
+  RaveTransformationMethod method, Rave_ProductType product, double value);
+
+/**
+ * @param[in] self - self
+ * @return the method the operator was compiled with
+ */
+RaveTransformationMethod TransformOperator_getMethod(TransformOperator_t* self);
+
+/**
+ * @param[in] self - self
+ * @return the product the operator was compiled for (Rave_ProductType_UNDEFINED if not compiled)
+ */
+Rave_ProductType TransformOperator_getProduct(TransformOperator_t* self);
+
+/**
+ * @param[in] self - self
+ * @return the elevation angle or height the operator was compiled for
+ */
+double TransformOperator_getValue(TransformOperator_t* self);
+
+/**
+ * @param[in] self - self
+ * @return the radius of influence that was used
+ */
+double TransformOperator_getRadius(TransformOperator_t* self);
+
+/**
+ * @param[in] self - self
+ * @return the xsize of the area
+ */
+long TransformOperator_getXSize(TransformOperator_t* self);
+
+/**
+ * @param[in] self - self
+ * @return the ysize of the area
+ */
+long TransformOperator_getYSize(TransformOperator_t* self);
+
+/**
+ * @param[in] self - self
+ * @return the number of weights in the operator
+ */
+long TransformOperator_getNumberOfEntries(TransformOperator_t* self);
+
+/**
+ * Sets the range to the start of the first bin in km, see \ref PolarScan_setRstart. Must be set before the
+ * operator is compiled and the scans it is applied to must have the same rstart. Default is 0.
+ * @param[in] self - self
+ * @param[in] rstart - the range start in km
+ */
+void TransformOperator_setRstart(TransformOperator_t* self, double rstart);
+
+/**
+ * @param[in] self - self
+ * @return the range to the start of the first bin in km
+ */
+double TransformOperator_getRstart(TransformOperator_t* self);
+
+/**
+ * Sets the azimuth where the first ray starts, i.e. how/astart of the scans. Must be set before the operator
+ * is compiled and the scans it is applied to must use the same how/astart. When not set, the scans must not
+ * use how/astart and the first ray is centered on north.
+ * @param[in] self - self
+ * @param[in] astart - the azimuth start in radians
+ */
+void TransformOperator_setAstart(TransformOperator_t* self, double astart);
+
+/**
+ * @param[in] self - self
+ * @return the azimuth where the first ray starts in radians
+ */
+double TransformOperator_getAstart(TransformOperator_t* self);
+
+/**
+ * @param[in] self - self
+ * @return 1 if the azimuth start has been set, otherwise 0
+ */
+int TransformOperator_hasAstart(TransformOperator_t* self);
+
+/**
+ * Sets the number of threads used when applying the operator. Default is 1.
+ * @param[in] self - self
+ * @param[in] nthreads - number of threads (>= 1)
+ * @return 1 on success, 0 if nthreads < 1
+ */
+int TransformOperator_setNumberOfThreads(TransformOperator_t* self, int nthreads);
+
+/**
+ * @param[in] self - self
+ * @return the number of threads used when applying the operator
+ */
+int TransformOperator_getNumberOfThreads(TransformOperator_t* self);
+
+/**
+ * Applies the operator to the default parameter of a scan and writes the result to the default parameter
+ * of the cartesian product. The scan must have the number of rays, bins and scale of the radar definition and
+ * the rstart and astart of the operator.
+ * @param[in] self - self
+ * @param[in] scan - the scan
+ * @param[in] cartesian - the cartesian product, must have the size of the area
+ * @return 1 on success otherwise 0
+ */
+int TransformOperator_applyScan(TransformOperator_t* self, PolarScan_t* scan, Cartesian_t* cartesian);
+
+/**
+ * Applies the operator to the default parameter of a volume and writes the result to the default parameter
+ * of the cartesian product. The scan closest to each elevation angle of the radar definition is used.
+ * @param[in] self - self
+ * @param[in] pvol - the volume
+ * @param[in] cartesian - the cartesian product, must have the size of the area
+ * @return 1 on success otherwise 0
+ */
+int TransformOperator_applyVolume(TransformOperator_t* self, PolarVolume_t* pvol, Cartesian_t* cartesian);
+
+/**
+ * Saves the operator in a native binary format.
+ * @param[in] self - self
+ * @param[in] filename - the file
+ * @return 1 on success otherwise 0
+ */
+int TransformOperator_save(TransformOperator_t* self, const char* filename);
+
+/**
+ * Loads an operator that has been saved with \ref TransformOperator_save.
+ * @param[in] filename - the file
+ * @return the operator or NULL on failure
+ */
+TransformOperator_t* TransformOperator_load(const char* filename);
+
+#endif /* TRANSFORM_OPERATOR_H */
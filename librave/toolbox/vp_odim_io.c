@@ -455,12 +455,12 @@ static int VpOdimIOInternal_addParameter(VpOdimIO_t* self, RaveField_t* field, H
     goto done;
   }
 
-  result = RaveHL_addData(nodelist,
-                          RaveField_getData(field),
-                          RaveField_getXsize(field),
-                          RaveField_getYsize(field),
-                          RaveField_getDataType(field),
-                          name);
+  result = RaveHL_addBorrowedData(nodelist,
+                                  (void*)RaveField_getReadOnlyData(field),
+                                  RaveField_getXsize(field),
+                                  RaveField_getYsize(field),
+                                  RaveField_getDataType(field),
+                                  name);
 done:
   RAVE_OBJECT_RELEASE(attributes);
   return result;
@@ -51,7 +51,6 @@ static PyObject* _average_func(PyObject* self, PyObject* args)
   Cartesian_t* target = NULL;
 
   int N = 0;
-  long xsize = 0, ysize = 0, x = 0, y = 0;
 
   if (!PyArg_ParseTuple(args, "Oi", &pyobject, &N)) {
     return NULL;
@@ -67,15 +66,10 @@ static PyObject* _average_func(PyObject* self, PyObject* args)
   if (target == NULL) {
     goto done;
   }
-  xsize = Cartesian_getXSize(cartesian);
-  ysize = Cartesian_getYSize(cartesian);
-
-  for (x = 0; x < xsize; x++) {
-    for (y = 0; y < ysize; y++) {
-      double value = 0.0L;
-      (void)Cartesian_getMean(cartesian, x, y, N, &value);
-      Cartesian_setValue(target, x, y, value);
-    }
+
+  if (!Cartesian_applyMean(target, N)) {
+    Raise(PyExc_RuntimeError, "Failed to calculate average");
+    goto done;
   }
 
   result = (PyObject*)PyCartesian_New(target);
@@ -4,6 +4,14 @@
 #include <math.h>
 #include <stdio.h>
 #include <string.h>
+#include <stddef.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef PTHREAD_SUPPORTED
+#include <pthread.h>
+#endif
 #include "raveutil.h"
 #include "rave.h"
 #include "values.h"
@@ -24,7 +32,15 @@ static PyObject *PyTransform_Error;
 /* -------------------------------------------------------------------- */
 /* Constructors                                                         */
 
-static FILE* staticFD;
+/*
+ * The weight buffers are per thread when the rows of a transform are
+ * processed in parallel.
+ */
+#ifdef PTHREAD_SUPPORTED
+#define PTOC_THREAD_LOCAL __thread
+#else
+#define PTOC_THREAD_LOCAL
+#endif
 
 static void
 _ptoc_error(void)
@@ -76,6 +92,7 @@ typedef struct {
   double R;
   double beamBroad;
   char* cashfile;
+  int nthreads; /* number of threads used for processing the rows */
 
   double cressmanR_xy;
   double cressmanR_z;
@@ -936,8 +953,8 @@ static int getCubic(Position* src, CoordWeight* weight, TrafoWrapper3D* wrap)
 
 static CoordWeight* getAllocatedCW(int maxNoOfItems)
 {
-  static CoordWeight* staticWeight = NULL;
-  static int noOfWeights = 0;
+  static PTOC_THREAD_LOCAL CoordWeight* staticWeight = NULL;
+  static PTOC_THREAD_LOCAL int noOfWeights = 0;
 
   if(maxNoOfItems==-99) {
      if(staticWeight) {
@@ -2009,7 +2026,9 @@ static CoordWeight* getCressmanCW(UV coord, int* noOfItems, TrafoWrapper3D* wrap
   source.alt = wrap->height;
   source.dndh = wrap->dndh;
 
-  wrap->R = wrap->cressmanR_xy*wrap->inscale;
+  /* Preset before the rows are processed in parallel, avoid writing it again */
+  if(wrap->R != wrap->cressmanR_xy*wrap->inscale)
+    wrap->R = wrap->cressmanR_xy*wrap->inscale;
 
   llToDa(&source,&source);
 
@@ -2078,14 +2097,6 @@ static int getCoordWeights(UV coord, CoordWeight* weight, TrafoWrapper3D* wrap)
   }
 }
 
-static void storeCash(CoordWeight* cw, int x, int y, int noi)
-{
-  fwrite(&x,sizeof(x),1,staticFD);
-  fwrite(&y,sizeof(y),1,staticFD);
-  fwrite(&noi,sizeof(noi),1,staticFD);
-  fwrite(cw,sizeof(cw[0]),noi,staticFD);
-}
-
 /*Method for comparing doubles, used by qsort.*/
 static int compareDoubles(const void* a,const void* b)
 {
@@ -2346,183 +2357,562 @@ static int checkCompactness(int r,int a,int e,TrafoWrapper3D* tw,int debug)
 }
 
 
-static void useCash(TrafoWrapper3D* tw)
-{
-  FILE* f;
-  int x,y,n,i,noe;
-  double tmpelist[MAXELEV];
+/* ----------------------------------------------------------------
+   Weight cache: the weights of every output pixel are stored as a
+   sparse matrix in compressed row form. The file starts with a header
+   identifying the area, the radar, the scan strategy and the method,
+   followed by npixels+1 offsets into the packed weights and the
+   weights themselves. The file is mapped read-only so that several
+   processes transforming to the same area share the same pages.
+*/
+#define PTOC_CACHE_MAGIC "PTOCWC"
+#define PTOC_CACHE_VERSION 2
+#define PTOC_CACHE_PCSLEN 512
+#define PTOC_CACHE_BAND 64 /* rows kept in memory while writing the cache */
+
+typedef struct {
+  char magic[8];
+  int version;
+  int headersize;
+  int method, slice, elevUsage, nelev;
+  int inxmax, inymax;
+  int xdim, ydim;
+  double elev[MAXELEV];
+  double inscale, height, dndh, beamBroad;
+  double cressmanR_xy, cressmanR_z;
+  double alt0, lon0, lat0;
+  double outULu, outULv, outxscale, outyscale;
+  char pcs[PTOC_CACHE_PCSLEN];
+  long long nentries; /* must be last, everything before is the key */
+} PtocCacheHeader;
+
+typedef struct {
+  void* map;
+  size_t mapsize;
+  const PtocCacheHeader* header;
+  const long long* rowptr;
+  CoordWeight* entries;
+} PtocWeightCache;
+
+typedef struct {
   CoordWeight* cw;
+  long long n, size;
+  int* counts;
+  int error;
+} PtocCacheRow;
 
-  int acta,actr,acte;
+typedef struct PtocRowJob PtocRowJob;
 
-  if(!(f=fopen(tw->cashfile,"r"))) {
-    return;
+typedef void (*ptoc_row_f)(int y, PtocRowJob* job, TrafoWrapper3D* tw);
+
+/*
+ * The rows [0, nrows) of a transform. Each thread takes one row at a
+ * time and processes it with its own copy of the wrapper, see
+ * ptocForEachRow.
+ */
+struct PtocRowJob {
+  ptoc_row_f rowf;
+  TrafoWrapper3D* tw;
+  void (*methfun)(int, int, UV, TrafoWrapper3D *);
+  PtocWeightCache* cache;
+  PtocCacheRow* rows;
+  const char* pcsdef;
+  int xdim, y0;
+  int nrows;
+  int next;
+#ifdef PTHREAD_SUPPORTED
+  pthread_mutex_t mutex;
+#endif
+};
+
+/*
+ * Joins the projection arguments into a single definition used as
+ * part of the cache key.
+ */
+static void ptocJoinPcs(char* buf, size_t len, char** argv, int n)
+{
+  int i;
+  buf[0] = '\0';
+  for(i=0;i<n;i++) {
+    if(i>0)
+      strncat(buf, " ", len-strlen(buf)-1);
+    strncat(buf, argv[i], len-strlen(buf)-1);
   }
+}
 
-  if(!feof(f)) {
-    int tempint;
-    double tempdouble;
+static void ptocCache_initKey(PtocCacheHeader* key, TrafoWrapper3D* tw,
+			      int xdim, int ydim, const char* pcsdef)
+{
+  int i;
+  memset(key, 0, sizeof(PtocCacheHeader)); /* padding is part of the key */
+  strcpy(key->magic, PTOC_CACHE_MAGIC);
+  key->version = PTOC_CACHE_VERSION;
+  key->headersize = sizeof(PtocCacheHeader);
+  key->method = tw->method;
+  key->slice = tw->slice;
+  key->elevUsage = tw->elevUsage;
+  key->nelev = tw->nelev;
+  for(i=0;i<tw->nelev;i++)
+    key->elev[i] = tw->elev[i];
+  key->inxmax = tw->inxmax;
+  key->inymax = tw->inymax;
+  key->xdim = xdim;
+  key->ydim = ydim;
+  key->inscale = tw->inscale;
+  key->height = tw->height;
+  key->dndh = tw->dndh;
+  key->beamBroad = tw->beamBroad;
+  key->cressmanR_xy = tw->cressmanR_xy;
+  key->cressmanR_z = tw->cressmanR_z;
+  key->alt0 = tw->alt0;
+  key->lon0 = tw->lon0;
+  key->lat0 = tw->lat0;
+  key->outULu = tw->outUL.u;
+  key->outULv = tw->outUL.v;
+  key->outxscale = tw->outxscale;
+  key->outyscale = tw->outyscale;
+  strncpy(key->pcs, pcsdef, PTOC_CACHE_PCSLEN-1);
+}
 
-    /*Remove header from cash file*/
+static void ptocCache_unmap(PtocWeightCache* cache)
+{
+  if(cache->map)
+    munmap(cache->map, cache->mapsize);
+  memset(cache, 0, sizeof(PtocWeightCache));
+}
 
-    fread(&noe,sizeof(noe),1,f); /*No of elevations*/
-    fread(tmpelist,sizeof(tmpelist[0]),noe,f); /*Elevation list*/
-    fread(&tempint,sizeof(tempint),1,f); /*Range uppb*/
-    fread(&tempint,sizeof(tempint),1,f); /*Azimuth uppb*/
-    fread(&tempdouble,sizeof(tempdouble),1,f); /*Range size*/
-    fread(&tempdouble,sizeof(tempdouble),1,f); /*cressmanR_xy*/
-    fread(&tempdouble,sizeof(tempdouble),1,f); /*cressmanR_z*/
+/*
+ * Maps the cache file if it exists and has been created with the
+ * same key, returns 1 on success, otherwise 0.
+ */
+static int ptocCache_map(const char* filename, const PtocCacheHeader* key, PtocWeightCache* cache)
+{
+  int fd;
+  struct stat st;
+  void* map;
+  const PtocCacheHeader* header;
+  const long long* rowptr;
+  long long npix = (long long)key->xdim*key->ydim;
+
+  memset(cache, 0, sizeof(PtocWeightCache));
+
+  if((fd=open(filename, O_RDONLY)) < 0)
+    return 0;
+
+  if(fstat(fd, &st)!=0 || st.st_size < (off_t)sizeof(PtocCacheHeader)) {
+    close(fd);
+    return 0;
   }
 
-  while(!feof(f)) {
-    fread(&x, sizeof(x), 1,f);
-    fread(&y, sizeof(y), 1,f);
-    fread(&n, sizeof(n), 1,f);
-    cw = getAllocatedCW(n);
-    fread(cw, sizeof(cw[0]), n, f);
-    if (n) {
-      double v=0;
-      double sum=0, item;
-      double refr;
+  map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if(map == MAP_FAILED)
+    return 0;
 
-#ifdef OLD_CHECK_NEAREST
-      if(tw->check_nearest) {
-	 Position source;
-	 UV here_s,here;
-	 /* printf("Working with x=%d,y=%d\n",x,y); */
-	 here_s.v = (tw->outUL.v-tw->outyscale*y);
-	 here_s.u = (tw->outUL.u+tw->outxscale*x);
-	 here = pj_inv(here_s, tw->outpj);
-	 /* printf("Got pjinv\n"); */
-
-	 source.lon0 = tw->lon0;
-	 source.lat0 = tw->lat0;
-	 source.alt0 = tw->alt0;
-	 /* printf("Got lon/lat/alt\n"); */
-
-	 source.lon = here.u;
-	 source.lat = here.v;
-	 source.alt = tw->height;
-	 source.dndh = tw->dndh;
-	 llToDa(&source,&source);
-	 /* printf("Got lltoda\n"); */
-	 acta=getAzindex(source.azimuth, tw, ROUND_AZIMUTH);
-	 if(tw->slice==PPI) {
-	    source.elevation=tw->elev[mytrunc(tw->height)];
-	    deToRh(&source,&source);
-	 } else {
-	    dhToRe(&source,&source);
-	 }
-	 actr=mytrunc(source.range/tw->inscale)-1;
-	 actr=(actr<0)?0:actr;
-	 acte=getElevIndex(source.elevation, tw);
-	 /* printf("a=%d,e=%d,r=%d\n",acta,acte,actr); */
-      }
+  header = (const PtocCacheHeader*)map;
+  rowptr = (const long long*)((char*)map + sizeof(PtocCacheHeader));
+
+  if(memcmp(header, key, offsetof(PtocCacheHeader, nentries))!=0 ||
+     header->nentries < 0 ||
+     (off_t)(sizeof(PtocCacheHeader) + (npix+1)*sizeof(long long) +
+	     header->nentries*sizeof(CoordWeight)) != st.st_size ||
+     rowptr[npix] != header->nentries) {
+    munmap(map, st.st_size);
+    return 0;
+  }
+
+  cache->map = map;
+  cache->mapsize = st.st_size;
+  cache->header = header;
+  cache->rowptr = rowptr;
+  cache->entries = (CoordWeight*)(rowptr + npix + 1);
+  return 1;
+}
+
+/*
+ * Creates a projection with its own context from the joined definition,
+ * since a projection can only be used by one thread at a time.
+ */
+static PJ* ptocInitProjection(projCtx ctx, const char* pcsdef)
+{
+  char buf[PTOC_CACHE_PCSLEN];
+  char* argv[PTOC_CACHE_PCSLEN/2];
+  char *tok, *save = NULL;
+  int n = 0;
+
+  strcpy(buf, pcsdef);
+  for(tok=strtok_r(buf, " ", &save); tok!=NULL; tok=strtok_r(NULL, " ", &save))
+    argv[n++] = tok;
+  return pj_init_ctx(ctx, n, argv);
+}
+
+static void ptocRowWorker(PtocRowJob* job, TrafoWrapper3D* tw)
+{
+  int y;
+
+  for(;;) {
+#ifdef PTHREAD_SUPPORTED
+    pthread_mutex_lock(&job->mutex);
+#endif
+    y = job->next++;
+#ifdef PTHREAD_SUPPORTED
+    pthread_mutex_unlock(&job->mutex);
 #endif
+    if(y >= job->nrows)
+      break;
+    job->rowf(y, job, tw);
+  }
+}
 
-      for (i=0; i<n; i++) {
-	 if ( (cw[i].weight != 0.0) &&
-	      (refr=getarritem3d(cw[i].elev,cw[i].range, \
-				 cw[i].azimuth,tw)) != tw->nodata) {
+#ifdef PTHREAD_SUPPORTED
+/*
+ * Processes rows with a copy of the wrapper that has its own projection.
+ * A thread that can not create its projection leaves its rows to the
+ * other threads.
+ */
+static void* ptocRowThread(void* ptr)
+{
+  PtocRowJob* job = (PtocRowJob*)ptr;
+  TrafoWrapper3D tw = *job->tw;
+  projCtx ctx = pj_ctx_alloc();
+
+  tw.outpj = (ctx!=NULL) ? ptocInitProjection(ctx, job->pcsdef) : NULL;
+  if(tw.outpj!=NULL) {
+    ptocRowWorker(job, &tw);
+    pj_free(tw.outpj);
+  }
+  if(ctx!=NULL)
+    pj_ctx_free(ctx);
+  getAllocatedCW(-99); /* release the weight buffer of this thread */
+  return NULL;
+}
+#endif
 
-	    if( (tw->useWeights == NO_ZERO_WEIGHTS && refr != 0.0) ||
-		tw->useWeights == ALL_WEIGHTS)
-	       sum +=cw[i].weight;
-	 }
-      }
+/*
+ * Calls job->rowf for every row in [0, nrows). The rows are shared
+ * between nthreads threads, the calling thread included, which uses
+ * job->tw itself.
+ */
+static void ptocForEachRow(PtocRowJob* job, int nrows, int nthreads)
+{
+  job->nrows = nrows;
+  job->next = 0;
+
+#ifdef PTHREAD_SUPPORTED
+  /* A truncated definition can not be used to recreate the projection */
+  if(strlen(job->pcsdef) >= PTOC_CACHE_PCSLEN-1)
+    nthreads = 1;
+  if(nthreads > nrows)
+    nthreads = nrows;
+  if(nthreads > 1) {
+    pthread_t* threads = malloc(sizeof(pthread_t)*(nthreads-1));
+    int i, started = 0;
+    pthread_mutex_init(&job->mutex, NULL);
+    for(i=0; threads && i<nthreads-1; i++) {
+      if(pthread_create(&threads[started], NULL, ptocRowThread, job)==0)
+	started++;
+    }
+    ptocRowWorker(job, job->tw);
+    for(i=0;i<started;i++)
+      pthread_join(threads[i], NULL);
+    free(threads);
+    pthread_mutex_destroy(&job->mutex);
+    return;
+  }
+#endif
+  ptocRowWorker(job, job->tw);
+}
 
-      if(tw->useWeights == NO_ZERO_WEIGHTS && sum == 0.0) {
-	 /*
-	  *Ouch, all possible points has got zero refraction, set
-	  *v to refraction 0
-	  */
-	 v=0.0;
-      }
-      else {
-	 if(tw->iqc==STD_DEVIATION_MEANVALUE ||
-	    tw->iqc==STD_DEVIATION_MEDIAN) {
-	    v=calculateStdDeviation(cw,n,tw);
-	 } else {
-	    for(i=0;i<n;i++) {
-	       if(cw[i].weight!=0.0)
-		  item=getarritem3d(cw[i].elev,cw[i].range,cw[i].azimuth,tw);
-	       else
-		  item=tw->nodata;
-	       if(item!=tw->nodata)
-		  v+=item*cw[i].weight/sum;
-	    }
-	 }
+static void ptocCache_buildRow(int i, PtocRowJob* job, TrafoWrapper3D* tw)
+{
+  PtocCacheRow* row = &job->rows[i];
+  int x, n;
+  UV here_s, here;
+  CoordWeight* cw;
+
+  row->n = 0;
+  row->error = 0;
+  here_s.v = (tw->outUL.v-tw->outyscale*(job->y0+i));
+
+  for(x=0;x<job->xdim;x++) {
+    here_s.u = (tw->outUL.u+tw->outxscale*x);
+    here = pj_inv(here_s, tw->outpj);
+    cw = getCressmanCW(here, &n, tw);
+    row->counts[x] = n;
+    if(n <= 0) {
+      row->counts[x] = 0;
+      continue;
+    }
+    if(row->n + n > row->size) {
+      long long nsize = (row->n + n)*2;
+      CoordWeight* ncw = realloc(row->cw, sizeof(CoordWeight)*nsize);
+      if(!ncw) {
+	row->error = 1;
+	return;
       }
+      row->cw = ncw;
+      row->size = nsize;
+    }
+    memcpy(row->cw + row->n, cw, sizeof(CoordWeight)*n);
+    row->n += n;
+  }
+}
+
+/*
+ * Calculates the weights for all pixels and writes them to the cache
+ * file. The file is written to a temporary name and renamed when
+ * complete so that readers never see a partial cache.
+ */
+static int ptocCache_write(const char* filename, const PtocCacheHeader* key, TrafoWrapper3D* tw,
+			   const char* pcsdef)
+{
+  PtocCacheHeader header;
+  PtocCacheRow rows[PTOC_CACHE_BAND];
+  PtocRowJob job;
+  long long* rowptr = NULL;
+  long long npix = (long long)key->xdim*key->ydim;
+  char* tmpname = NULL;
+  FILE* fp = NULL;
+  int fd = -1, i, x, y0, nb;
+  int result = 0;
+
+  memset(rows, 0, sizeof(rows));
+  memset(&job, 0, sizeof(job));
+  job.rowf = ptocCache_buildRow;
+  job.tw = tw;
+  job.rows = rows;
+  job.pcsdef = pcsdef;
+  job.xdim = key->xdim;
+  memcpy(&header, key, sizeof(PtocCacheHeader));
+  header.nentries = 0;
+
+  tmpname = malloc(strlen(filename)+8);
+  rowptr = calloc(npix+1, sizeof(long long));
+  if(!tmpname || !rowptr)
+    goto done;
+  sprintf(tmpname, "%s.XXXXXX", filename);
+  if((fd = mkstemp(tmpname)) < 0) {
+    free(tmpname);
+    tmpname = NULL;
+    goto done;
+  }
+  fchmod(fd, 0644);
+  if(!(fp = fdopen(fd, "wb"))) {
+    close(fd);
+    goto done;
+  }
+
+  for(i=0;i<PTOC_CACHE_BAND;i++) {
+    if(!(rows[i].counts = malloc(sizeof(int)*key->xdim)))
+      goto done;
+  }
+
+  /* Header and offsets are rewritten when all weights are known */
+  if(fwrite(&header, sizeof(header), 1, fp)!=1 ||
+     fwrite(rowptr, sizeof(long long), npix+1, fp)!=(size_t)(npix+1))
+    goto done;
+
+  for(y0=0;y0<key->ydim;y0+=PTOC_CACHE_BAND) {
+    nb = (key->ydim-y0 < PTOC_CACHE_BAND) ? key->ydim-y0 : PTOC_CACHE_BAND;
+    job.y0 = y0;
+    ptocForEachRow(&job, nb, tw->nthreads);
+    for(i=0;i<nb;i++) {
+      long long idx = (long long)(y0+i)*key->xdim;
+      if(rows[i].error)
+	goto done;
+      for(x=0;x<key->xdim;x++,idx++)
+	rowptr[idx+1] = rowptr[idx] + rows[i].counts[x];
+      if(rows[i].n > 0 &&
+	 fwrite(rows[i].cw, sizeof(CoordWeight), rows[i].n, fp)!=(size_t)rows[i].n)
+	goto done;
+    }
+  }
 
-      if(tw->set_compactness==1) {
-	 double cval,cval2;
-	 int noofv=0;
-	 int ee,aa,rr;
-	 int noofzeros=0;
+  header.nentries = rowptr[npix];
+  if(fseek(fp, 0, SEEK_SET)!=0 ||
+     fwrite(&header, sizeof(header), 1, fp)!=1 ||
+     fwrite(rowptr, sizeof(long long), npix+1, fp)!=(size_t)(npix+1))
+    goto done;
 
-	 for(i=0;i<n;i++) {
-	    cval=getarritem3d(cw[i].elev,cw[i].range,cw[i].azimuth,tw);
-	    if(cval!=0.0 && cval!=tw->nodata && cw[i].range>0) {
-	       if(cw[i].elev==0 || cw[i].elev==tw->nelev-1) {
-		  noofv+=5;
-	       }
-	       else {
-		  noofv+=6;
-	       }
-
-	       noofzeros+=checkCompactness(cw[i].range,
-					   cw[i].azimuth,cw[i].elev,tw,0);
-	    }
-	 }
+  result = 1;
+done:
+  if(fp) {
+    if(fclose(fp)!=0)
+      result = 0;
+  }
+  if(tmpname) {
+    if(result && rename(tmpname, filename)!=0)
+      result = 0;
+    if(!result)
+      remove(tmpname);
+  }
+  for(i=0;i<PTOC_CACHE_BAND;i++) {
+    free(rows[i].cw);
+    free(rows[i].counts);
+  }
+  free(rowptr);
+  free(tmpname);
+  return result;
+}
 
-	 if(noofv==0) {
-	    v=0.0;
-	 } else {
-	    cval2=(double)noofzeros/(double)noofv;
-	    v=cval2;
-	 }
+/*
+ * Assigns the value of pixel x,y from its cached weights.
+ */
+static void ptocCache_applyPixel(int x, int y, CoordWeight* cw, int n, TrafoWrapper3D* tw)
+{
+  double v=0;
+  double sum=0, item;
+  double refr;
+  int i;
+
+  for (i=0; i<n; i++) {
+    if ( (cw[i].weight != 0.0) &&
+	 (refr=getarritem3d(cw[i].elev,cw[i].range, \
+			    cw[i].azimuth,tw)) != tw->nodata) {
+
+      if( (tw->useWeights == NO_ZERO_WEIGHTS && refr != 0.0) ||
+	  tw->useWeights == ALL_WEIGHTS)
+	sum +=cw[i].weight;
+    }
+  }
+
+  if(tw->useWeights == NO_ZERO_WEIGHTS && sum == 0.0) {
+    /*
+     *Ouch, all possible points has got zero refraction, set
+     *v to refraction 0
+     */
+    v=0.0;
+  }
+  else {
+    if(tw->iqc==STD_DEVIATION_MEANVALUE ||
+       tw->iqc==STD_DEVIATION_MEDIAN) {
+      v=calculateStdDeviation(cw,n,tw);
+    } else {
+      for(i=0;i<n;i++) {
+	if(cw[i].weight!=0.0)
+	  item=getarritem3d(cw[i].elev,cw[i].range,cw[i].azimuth,tw);
+	else
+	  item=tw->nodata;
+	if(item!=tw->nodata)
+	  v+=item*cw[i].weight/sum;
       }
+    }
+  }
 
-      if(tw->check_nearest) {
-	 int nidx=0;
-	 double highw=0.0;
-	 double aval;
-	 for(i=0;i<n;i++) {
-	    if(highw<cw[i].weight) {
-	       nidx=i;
-	       highw=cw[i].weight;
-	    }
-	 }
-	 aval=getarritem3d(cw[nidx].elev,cw[nidx].range,cw[nidx].azimuth,tw);
-	 if(aval==0 || aval==tw->nodata)
-	    setarritem3d(x,y,aval,tw);
-	 else
-	    setarritem3d(x,y,v,tw);
-      } else {
-	 setarritem3d(x,y,v,tw);
+  if(tw->set_compactness==1) {
+    double cval,cval2;
+    int noofv=0;
+    int noofzeros=0;
+
+    for(i=0;i<n;i++) {
+      cval=getarritem3d(cw[i].elev,cw[i].range,cw[i].azimuth,tw);
+      if(cval!=0.0 && cval!=tw->nodata && cw[i].range>0) {
+	if(cw[i].elev==0 || cw[i].elev==tw->nelev-1) {
+	  noofv+=5;
+	}
+	else {
+	  noofv+=6;
+	}
+
+	noofzeros+=checkCompactness(cw[i].range,
+				    cw[i].azimuth,cw[i].elev,tw,0);
       }
-#ifdef OLD_CHECK_NEAREST
-      if(tw->check_nearest) {
-	 for(i=0;i<n;i++) {
-	    if(cw[i].range==actr && cw[i].azimuth==acta) {
-	       if(cw[i].elev<tw->nelev-1 && acte+1==cw[i].elev) {
-		  double aval=getarritem3d(cw[i].elev,cw[i].range,cw[i].azimuth,tw);
-		  if(aval==tw->nodata || aval==0)
-		     setarritem3d(x,y,aval,tw);
-		  else
-		     setarritem3d(x,y,v,tw);
-	       }
-	    }
-	 }
-      } else {
-	 setarritem3d(x,y,v,tw);
+    }
+
+    if(noofv==0) {
+      v=0.0;
+    } else {
+      cval2=(double)noofzeros/(double)noofv;
+      v=cval2;
+    }
+  }
+
+  if(tw->check_nearest) {
+    int nidx=0;
+    double highw=0.0;
+    double aval;
+    for(i=0;i<n;i++) {
+      if(highw<cw[i].weight) {
+	nidx=i;
+	highw=cw[i].weight;
       }
-#endif
-    /*  setarritem3d(x,y,v,tw);*/
     }
+    aval=getarritem3d(cw[nidx].elev,cw[nidx].range,cw[nidx].azimuth,tw);
+    if(aval==0 || aval==tw->nodata)
+      setarritem3d(x,y,aval,tw);
+    else
+      setarritem3d(x,y,v,tw);
+  } else {
+    setarritem3d(x,y,v,tw);
+  }
+}
+
+static void ptocCache_applyRow(int y, PtocRowJob* job, TrafoWrapper3D* tw)
+{
+  const long long* rowptr = job->cache->rowptr;
+  long long nentries = job->cache->header->nentries;
+  long long idx = (long long)y*job->xdim;
+  int x;
+
+  for(x=0;x<job->xdim;x++,idx++) {
+    long long start = rowptr[idx], end = rowptr[idx+1];
+    if(end > start && start >= 0 && end <= nentries)
+      ptocCache_applyPixel(x, y, job->cache->entries + start, (int)(end-start), tw);
+  }
+}
+
+static void ptocMethodRow(int y, PtocRowJob* job, TrafoWrapper3D* tw)
+{
+  UV here_s;
+  int x;
+
+  here_s.v = (tw->outUL.v-tw->outyscale*y);
+  for(x=0;x<job->xdim;x++) {
+    here_s.u = (tw->outUL.u+tw->outxscale*x);
+    job->methfun(x,y,here_s,tw); /* Call appropriate function to do the job*/
+  }
+}
+
+/*
+ * Runs the transformation over all rows of the destination. Cressman,
+ * inverse and uniform weights are taken from the cache file when one
+ * is given and recalculated when the key no longer matches.
+ */
+static void ptocRun(TrafoWrapper3D* tw, void (*methfun)(int, int, UV, TrafoWrapper3D *),
+		    int xdim, int ydim, const char* pcsdef)
+{
+  PtocRowJob job;
+
+  memset(&job, 0, sizeof(job));
+  job.tw = tw;
+  job.methfun = methfun;
+  job.pcsdef = pcsdef;
+  job.xdim = xdim;
+
+  /* Copied to the wrapper of every thread, see getCressmanCW */
+  tw->R = tw->cressmanR_xy*tw->inscale;
+
+  if(tw->cashfile!=NULL &&
+     (tw->method==CRESSMAN || tw->method==INVERSE || tw->method==UNIFORM)) {
+    PtocCacheHeader key;
+    PtocWeightCache cache;
+
+    ptocCache_initKey(&key, tw, xdim, ydim, pcsdef);
+    if(ptocCache_map(tw->cashfile, &key, &cache) ||
+       (ptocCache_write(tw->cashfile, &key, tw, pcsdef) &&
+	ptocCache_map(tw->cashfile, &key, &cache))) {
+      job.rowf = ptocCache_applyRow;
+      job.cache = &cache;
+      ptocForEachRow(&job, ydim, tw->nthreads);
+      ptocCache_unmap(&cache);
+      return;
+    }
+    printf("Error occured while writing cashfile, removing it\n");
+    remove(tw->cashfile);
   }
 
-  fclose(f);
+  job.rowf = ptocMethodRow;
+  ptocForEachRow(&job, ydim, tw->nthreads);
 }
 
 /* ----------------------------------------------------------------
@@ -2649,11 +3039,6 @@ static void cressman3d(int x, int y, UV here_s, TrafoWrapper3D *tw)
   }
 #endif
 
-  if(tw->cashfile && n>0) {
-     if(!ferror(staticFD))
-	storeCash(cw,x,y,n);
-  }
-
   /* Assign result if there was data - keep NO_DATA otherwise */
   if (n) {
     double v=0;
@@ -3264,7 +3649,7 @@ static PyObject*  _ptoc_transform(PyObject* self, PyObject* args)
   TrafoWrapper3D tw;
   void (*methfun)(int, int, UV, TrafoWrapper3D *);
   int no_of_src=0;
-  int cashfile_error=0;
+  char pcsdef[PTOC_CACHE_PCSLEN];
 
   PJ *pj;
   PyObject* in;          /* rave_image.image_2d */
@@ -3312,6 +3697,7 @@ static PyObject*  _ptoc_transform(PyObject* self, PyObject* args)
       Py_DECREF(op);
     }
 
+    ptocJoinPcs(pcsdef, sizeof(pcsdef), argv, n);
     pj = pj_init(n, argv);
 
     free(argv);
@@ -3493,6 +3879,11 @@ static PyObject*  _ptoc_transform(PyObject* self, PyObject* args)
      tw.check_nearest=0;
   }
 
+  /* Rows are only processed in parallel when the caller asks for it */
+  if(!getIntFromDictionary("threads",&tw.nthreads,out_info) || tw.nthreads<1) {
+     tw.nthreads=1;
+  }
+
   if(!getDoubleFromDictionary("i_qcvalue",&tw.iqcvalue,out_info)) {
     tw.iqcvalue=-1.0;
   }
@@ -3618,115 +4009,9 @@ static PyObject*  _ptoc_transform(PyObject* self, PyObject* args)
   tw.inxmax = tw.src[0]->dimensions[1];
   tw.inymax = tw.src[0]->dimensions[0];
 
-  if(tw.cashfile!=NULL &&
-     (tw.method==CRESSMAN || tw.method==INVERSE || tw.method==UNIFORM)) {
-    FILE* tmpf;
-    int recash=0;
-    double checkelev[MAXELEV];
-    int noofelev;
-    int range_uppb,azim_uppb;
-    double range_size;
-
-    double cressmanRxy,cressmanRz;
-
-    recash=(tmpf=fopen(tw.cashfile,"r"))?0:1;
-
-    if(recash==0) {
-      fread(&noofelev,sizeof(noofelev),1,tmpf);
-      fread(checkelev,sizeof(checkelev[0]),noofelev,tmpf);
-
-      if(noofelev==tw.nelev) {
-	 for(i=0;i<noofelev;i++) {
-	    if(checkelev[i]!=tw.elev[i]) {
-	       recash = 1;
-	    }
-	 }
-      }
-      else {
-	 recash = 1;
-      }
-      if(recash==0) {
-	 fread(&range_uppb,sizeof(range_uppb),1,tmpf);
-	 fread(&azim_uppb,sizeof(azim_uppb),1,tmpf);
-	 fread(&range_size,sizeof(range_size),1,tmpf);
-	 fread(&cressmanRxy,sizeof(cressmanRxy),1,tmpf);
-	 fread(&cressmanRz,sizeof(cressmanRz),1,tmpf);
-
-	 if(range_uppb!=tw.inymax ||
-	    azim_uppb!=tw.inxmax ||
-	    range_size!=tw.inscale ||
-	    cressmanRxy!=tw.cressmanR_xy ||
-	    cressmanRz!=tw.cressmanR_z) {
-	    recash=1;
-	 }
-      }
-    }
-
-    if(!tmpf || recash==1) {
-      if(tmpf) {
-	 fclose(tmpf);
-	 remove(tw.cashfile);
-      }
-
-      if(!(staticFD=fopen(tw.cashfile,"a"))) {
-	 printf("Could not create cashfile for writing\n");
-	 /*perror("Could not create cashfile for writing\n");*/
-	 cashfile_error=1;
-	 free(tw.cashfile);
-	 tw.cashfile=NULL;
-      }
-
-      if(!cashfile_error) {
-	 fwrite(&tw.nelev,sizeof(tw.nelev),1,staticFD);
-	 fwrite(tw.elev,sizeof(tw.elev[0]),tw.nelev,staticFD);
-
-	 fwrite(&tw.inymax,sizeof(tw.inymax),1,staticFD);
-	 fwrite(&tw.inxmax,sizeof(tw.inxmax),1,staticFD);
-	 fwrite(&tw.inscale,sizeof(tw.inscale),1,staticFD);
-
-	 fwrite(&tw.cressmanR_xy,sizeof(tw.cressmanR_xy),1,staticFD);
-	 fwrite(&tw.cressmanR_z,sizeof(tw.cressmanR_z),1,staticFD);
-      }
-
-      for(y=0;y<dest->dimensions[0]; y++) {
-	 UV here_s;
-	 here_s.v = (outUL.v-outyscale*y);
-	 for(x=0;x<dest->dimensions[1]; x++) {
-	    here_s.u = (outUL.u+outxscale*x);
-	    methfun(x,y,here_s, &tw);
-	 }
-      }
-
-      if(ferror(staticFD)) {
-	 cashfile_error=1;
-      }
-
-      if(staticFD)
-	 fclose(staticFD);
-    }
-    else {
-      fclose(tmpf);
-    }
-
-    if(!cashfile_error)
-       useCash(&tw);
-    else {
-       if(tw.cashfile) {
-	  printf("Error occured while writing cashfile, removing it\n");
-	  remove(tw.cashfile);
-       }
-    }
-  }
-  else {
-    for(y=0;y<dest->dimensions[0]; y++) {/* do it! */
-      UV here_s;
-      here_s.v = (outUL.v-outyscale*y);
-      for(x=0;x<dest->dimensions[1]; x++) {
-	 here_s.u = (outUL.u+outxscale*x);
-	 methfun(x,y,here_s, &tw); /* Call appropriate function to do the job*/
-      }
-    }
-  }
+  Py_BEGIN_ALLOW_THREADS
+  ptocRun(&tw, methfun, dest->dimensions[1], dest->dimensions[0], pcsdef);
+  Py_END_ALLOW_THREADS
 
   getAllocatedCW(-99);
 
@@ -3940,6 +4225,10 @@ static int shouldRecashEcho(FILE* fp, TrafoWrapper3D* wrap)
   return 0;
 }
 
+/*
+ * DEPRECATED. Echo top is generated natively with Rave_ProductType_ETOP in
+ * _pycomposite (Composite_generate) or with _transform.etop (Transform_etop).
+ */
 static PyObject* _ptoc_echotop(PyObject* self, PyObject* args)
 {
   PyObject *in,*out,*outpcs;
@@ -4196,6 +4485,10 @@ static int getMaxechoVars(PyObject* info, TrafoWrapper3D* wrap)
   return 1;
 }
 
+/*
+ * DEPRECATED. Vertical max is generated natively with Rave_ProductType_MAX in
+ * _pycomposite (Composite_generate) or with _transform.max (Transform_max).
+ */
 static PyObject* _ptoc_max(PyObject* self, PyObject* args)
 {
   PyObject *in,*out,*outpcs;
@@ -4362,7 +4655,7 @@ static PyObject*  _ptoc_compactness(PyObject* self, PyObject* args)
    TrafoWrapper3D tw;
    void (*methfun)(int, int, UV, TrafoWrapper3D *);
    int no_of_src=0;
-   int cashfile_error=0;
+   char pcsdef[PTOC_CACHE_PCSLEN];
 
    PJ *pj;
    PyObject* in;          /* rave_image.image_2d */
@@ -4410,6 +4703,7 @@ static PyObject*  _ptoc_compactness(PyObject* self, PyObject* args)
 	 Py_DECREF(op);
       }
 
+      ptocJoinPcs(pcsdef, sizeof(pcsdef), argv, n);
       pj = pj_init(n, argv);
 
       free(argv);
@@ -4576,6 +4870,11 @@ static PyObject*  _ptoc_compactness(PyObject* self, PyObject* args)
     tw.iqc=NO_QC;
   }
 
+  /* Rows are only processed in parallel when the caller asks for it */
+  if(!getIntFromDictionary("threads",&tw.nthreads,out_info) || tw.nthreads<1) {
+     tw.nthreads=1;
+  }
+
   if(!getDoubleFromDictionary("i_qcvalue",&tw.iqcvalue,out_info)) {
     tw.iqcvalue=-1.0;
   }
@@ -4701,115 +5000,11 @@ static PyObject*  _ptoc_compactness(PyObject* self, PyObject* args)
   tw.inxmax = tw.src[0]->dimensions[1];
   tw.inymax = tw.src[0]->dimensions[0];
 
-  if(tw.cashfile!=NULL &&
-     (tw.method==CRESSMAN || tw.method==INVERSE || tw.method==UNIFORM)) {
-    FILE* tmpf;
-    int recash=0;
-    double checkelev[MAXELEV];
-    int noofelev;
-    int range_uppb,azim_uppb;
-    double range_size;
-
-    double cressmanRxy,cressmanRz;
-
-    recash=(tmpf=fopen(tw.cashfile,"r"))?0:1;
-
-    if(recash==0) {
-      fread(&noofelev,sizeof(noofelev),1,tmpf);
-      fread(checkelev,sizeof(checkelev[0]),noofelev,tmpf);
-
-      if(noofelev==tw.nelev) {
-		for(i=0;i<noofelev;i++) {
-		  if(checkelev[i]!=tw.elev[i]) {
-			recash = 1;
-		  }
-		}
-      }
-      else {
-		recash = 1;
-      }
-      if(recash==0) {
-	 fread(&range_uppb,sizeof(range_uppb),1,tmpf);
-	 fread(&azim_uppb,sizeof(azim_uppb),1,tmpf);
-	 fread(&range_size,sizeof(range_size),1,tmpf);
-	 fread(&cressmanRxy,sizeof(cressmanRxy),1,tmpf);
-	 fread(&cressmanRz,sizeof(cressmanRz),1,tmpf);
-
-	 if(range_uppb!=tw.inymax ||
-	    azim_uppb!=tw.inxmax ||
-	    range_size!=tw.inscale ||
-	    cressmanRxy!=tw.cressmanR_xy ||
-	    cressmanRz!=tw.cressmanR_z) {
-	    recash=1;
-	 }
-      }
-    }
-
-    if(!tmpf || recash==1) {
-      if(tmpf) {
-	 fclose(tmpf);
-	 remove(tw.cashfile);
-      }
-
-      if(!(staticFD=fopen(tw.cashfile,"a"))) {
-	 printf("Could not create cashfile for writing\n");
-	 /*perror("Could not create cashfile for writing\n");*/
-	 cashfile_error=1;
-	 free(tw.cashfile);
-	 tw.cashfile=NULL;
-      }
-
-      if(!cashfile_error) {
-	 fwrite(&tw.nelev,sizeof(tw.nelev),1,staticFD);
-	 fwrite(tw.elev,sizeof(tw.elev[0]),tw.nelev,staticFD);
-
-	 fwrite(&tw.inymax,sizeof(tw.inymax),1,staticFD);
-	 fwrite(&tw.inxmax,sizeof(tw.inxmax),1,staticFD);
-	 fwrite(&tw.inscale,sizeof(tw.inscale),1,staticFD);
+  Py_BEGIN_ALLOW_THREADS
+  ptocRun(&tw, methfun, dest->dimensions[1], dest->dimensions[0], pcsdef);
+  Py_END_ALLOW_THREADS
 
-	 fwrite(&tw.cressmanR_xy,sizeof(tw.cressmanR_xy),1,staticFD);
-	 fwrite(&tw.cressmanR_z,sizeof(tw.cressmanR_z),1,staticFD);
-      }
-
-      for(y=0;y<dest->dimensions[0]; y++) {
-	 UV here_s;
-	 here_s.v = (outUL.v-outyscale*y);
-	 for(x=0;x<dest->dimensions[1]; x++) {
-	    here_s.u = (outUL.u+outxscale*x);
-	    methfun(x,y,here_s, &tw);
-	 }
-      }
-
-      if(ferror(staticFD)) {
-	 cashfile_error=1;
-      }
-
-      if(staticFD)
-	 fclose(staticFD);
-    }
-    else {
-      fclose(tmpf);
-    }
-
-    if(!cashfile_error)
-       useCash(&tw);
-    else {
-       if(tw.cashfile) {
-	  printf("Error occured while writing cashfile, removing it\n");
-	  remove(tw.cashfile);
-       }
-    }
-  }
-  else {
-    for(y=0;y<dest->dimensions[0]; y++) {/* do it! */
-      UV here_s;
-      here_s.v = (outUL.v-outyscale*y);
-      for(x=0;x<dest->dimensions[1]; x++) {
-	 here_s.u = (outUL.u+outxscale*x);
-	 methfun(x,y,here_s, &tw); /* Call appropriate function to do the job*/
-      }
-    }
-  }
+  getAllocatedCW(-99);
 
   /* Also: DECREF all temporary items!! */
   pj_free(tw.outpj);
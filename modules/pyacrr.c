@@ -177,6 +177,9 @@ static PyObject* _pyacrr_sum(PyAcrr* self, PyObject* args)
 {
   PyObject* pyo = NULL;
   double zr_a = 0.0, zr_b = 0.0;
+  RaveAcrr_t* acrr = NULL;
+  CartesianParam_t* param = NULL;
+  int result = 0;
   if (!PyArg_ParseTuple(args, "Odd", &pyo, &zr_a, &zr_b)) {
     return NULL;
   }
@@ -185,7 +188,15 @@ static PyObject* _pyacrr_sum(PyAcrr* self, PyObject* args)
     raiseException_returnNULL(PyExc_ValueError, "First parameter must be a cartesian parameter");
   }
 
-  if (!RaveAcrr_sum(self->acrr, ((PyCartesianParam*)pyo)->param, zr_a, zr_b)) {
+  acrr = RAVE_OBJECT_COPY(self->acrr);
+  param = RAVE_OBJECT_COPY(((PyCartesianParam*)pyo)->param);
+  Py_BEGIN_ALLOW_THREADS
+  result = RaveAcrr_sum(acrr, param, zr_a, zr_b);
+  Py_END_ALLOW_THREADS
+  RAVE_OBJECT_RELEASE(acrr);
+  RAVE_OBJECT_RELEASE(param);
+
+  if (!result) {
     raiseException_returnNULL(PyExc_IOError, "Failed to process parameter");
   }
 
@@ -203,13 +214,18 @@ static PyObject* _pyacrr_accumulate(PyAcrr* self, PyObject* args)
   long N = 0;
   double hours = 0.0;
   CartesianParam_t* param = NULL;
+  RaveAcrr_t* acrr = NULL;
   PyObject* result = NULL;
 
   if (!PyArg_ParseTuple(args, "dld", &accept, &N, &hours)) {
     return NULL;
   }
 
-  param = RaveAcrr_accumulate(self->acrr, accept, N, hours);
+  acrr = RAVE_OBJECT_COPY(self->acrr);
+  Py_BEGIN_ALLOW_THREADS
+  param = RaveAcrr_accumulate(acrr, accept, N, hours);
+  Py_END_ALLOW_THREADS
+  RAVE_OBJECT_RELEASE(acrr);
   if (param != NULL) {
     result = (PyObject*)PyCartesianParam_New(param);
   } else {
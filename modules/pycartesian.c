@@ -400,6 +400,65 @@ static PyObject* _pycartesian_getConvertedValueAtLonLat(PyCartesian* self, PyObj
   return Py_BuildValue("(id)", result, v);
 }
 
+/**
+ * Returns the converted values and quality values for a number of lon/lat positions
+ * @param[in] self this instance.
+ * @param[in] args - longitudes, latitudes (in radians) and optionally the quality field name
+ * @return a tuple (values, types, qualities) of numpy arrays
+ */
+static PyObject* _pycartesian_getConvertedValuesAtLonLats(PyCartesian* self, PyObject* args)
+{
+  PyObject *pylon = NULL, *pylat = NULL;
+  PyArrayObject *lonarr = NULL, *latarr = NULL;
+  PyObject *values = NULL, *types = NULL, *qualities = NULL, *result = NULL;
+  RaveValueType* vtypes = NULL;
+  char* qualityname = NULL;
+  npy_intp dims[1] = {0};
+  npy_intp i = 0;
+  int ok = 0;
+
+  if (!PyArg_ParseTuple(args, "OO|z", &pylon, &pylat, &qualityname)) {
+    return NULL;
+  }
+  lonarr = (PyArrayObject*)PyArray_ContiguousFromObject(pylon, PyArray_DOUBLE, 1, 1);
+  latarr = (PyArrayObject*)PyArray_ContiguousFromObject(pylat, PyArray_DOUBLE, 1, 1);
+  if (lonarr == NULL || latarr == NULL) {
+    raiseException_gotoTag(done, PyExc_TypeError, "longitudes and latitudes must be 1-dimensional sequences of numbers");
+  }
+  if (PyArray_DIM(lonarr, 0) != PyArray_DIM(latarr, 0)) {
+    raiseException_gotoTag(done, PyExc_ValueError, "longitudes and latitudes must have the same length");
+  }
+  dims[0] = PyArray_DIM(lonarr, 0);
+  values = PyArray_SimpleNew(1, dims, PyArray_DOUBLE);
+  types = PyArray_SimpleNew(1, dims, PyArray_INT);
+  qualities = PyArray_SimpleNew(1, dims, PyArray_DOUBLE);
+  vtypes = RAVE_MALLOC(sizeof(RaveValueType) * (dims[0] > 0 ? dims[0] : 1));
+  if (values == NULL || types == NULL || qualities == NULL || vtypes == NULL) {
+    raiseException_gotoTag(done, PyExc_MemoryError, "Failed to allocate memory for result");
+  }
+
+  Py_BEGIN_ALLOW_THREADS
+  ok = Cartesian_getConvertedValuesAtLonLats(self->cartesian, (long)dims[0], (double*)PyArray_DATA(lonarr), (double*)PyArray_DATA(latarr),
+                                             (double*)PyArray_DATA((PyArrayObject*)values), vtypes, qualityname,
+                                             (double*)PyArray_DATA((PyArrayObject*)qualities));
+  Py_END_ALLOW_THREADS
+  if (!ok) {
+    raiseException_gotoTag(done, PyExc_AttributeError, "Failed to get values, cartesian must have a default parameter and a projection");
+  }
+  for (i = 0; i < dims[0]; i++) {
+    *((int*) PyArray_GETPTR1((PyArrayObject*)types, i)) = (int)vtypes[i];
+  }
+  result = Py_BuildValue("(OOO)", values, types, qualities);
+done:
+  Py_XDECREF(lonarr);
+  Py_XDECREF(latarr);
+  Py_XDECREF(values);
+  Py_XDECREF(types);
+  Py_XDECREF(qualities);
+  RAVE_FREE(vtypes);
+  return result;
+}
+
 /**
  * returns the quality value at the specified location as defined by the area definition
  * @param[in] self this instance.
@@ -1136,6 +1195,15 @@ static struct PyMethodDef _pycartesian_methods[] =
     "Returns the value from the lon/lat coordinate. \n\n"
     "(lon,lat) - tuple with lon/lat coordinate in radians\n"
   },
+  {"getConvertedValuesAtLonLats", (PyCFunction) _pycartesian_getConvertedValuesAtLonLats, 1,
+    "getConvertedValuesAtLonLats(lons, lats[, qualityfield]) -> (values, types, qualities)\n\n"
+    "Returns the converted values for a number of lon/lat positions as numpy arrays. Same as calling getConvertedValueAtLonLat and\n"
+    "getConvertedQualityValueAtLonLat for each position but the lookups are only done once.\n\n"
+    "lons         - sequence of longitudes in radians\n"
+    "lats         - sequence of latitudes in radians\n"
+    "qualityfield - how/task of the quality field. If not given or not found, all qualities are NaN.\n"
+    "Returns a tuple with the values (float64), value types (int32) and quality values (float64, NaN when missing)."
+  },
   {"getQualityValueAtLocation", (PyCFunction) _pycartesian_getQualityValueAtLocation, 1,
     "getQualityValueAtLocation((x,y), fieldname) -> the quality value at the specified x/y coordinate.\n\n"
     "Returns the quality value from the specified quality field and location \n\n"
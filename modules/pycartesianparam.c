@@ -200,12 +200,12 @@ static PyObject* _pycartesianparam_getData(PyCartesianParam* self, PyObject* arg
   PyObject* result = NULL;
   npy_intp dims[2] = {0,0};
   int arrtype = 0;
-  void* data = NULL;
+  const void* data = NULL;
 
   xsize = CartesianParam_getXSize(self->param);
   ysize = CartesianParam_getYSize(self->param);
   type = CartesianParam_getDataType(self->param);
-  data = CartesianParam_getData(self->param);
+  data = CartesianParam_getReadOnlyData(self->param);
 
   dims[1] = (npy_intp)xsize;
   dims[0] = (npy_intp)ysize;
@@ -224,7 +224,7 @@ static PyObject* _pycartesianparam_getData(PyCartesianParam* self, PyObject* arg
   }
   if (result != NULL) {
     int nbytes = xsize*ysize*PyArray_ITEMSIZE(result);
-    memcpy(((PyArrayObject*)result)->data, (unsigned char*)CartesianParam_getData(self->param), nbytes);
+    memcpy(((PyArrayObject*)result)->data, data, nbytes);
   }
   return result;
 }
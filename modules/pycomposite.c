@@ -36,11 +36,13 @@ along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
 #include "pypolarvolume.h"
 #include "pypolarscan.h"
 #include "pycartesian.h"
+#include "pycartesianvolume.h"
 #include "pyarea.h"
 #include "rave_alloc.h"
 #include "raveutil.h"
 #include "rave.h"
 #include "pycompositealgorithm.h"
+#include "cartesian_stream_writer.h"
 
 /**
  * Debug this module
@@ -311,6 +313,45 @@ done:
   return NULL;
 }
 
+/**
+ * Creates a list of quality names from a python list of strings.
+ * @param[in] pyqualitynames - the python list (MAY BE NULL)
+ * @param[out] qualitynames - the created list, NULL if pyqualitynames is NULL or empty
+ * @return 1 on success otherwise 0 with a python exception set
+ */
+static int _pycomposite_createQualityNames(PyObject* pyqualitynames, RaveList_t** qualitynames)
+{
+  *qualitynames = NULL;
+  if (pyqualitynames != NULL && pyqualitynames != Py_None && !PyList_Check(pyqualitynames)) {
+    raiseException_gotoTag(fail, PyExc_AttributeError, "second argument should be a list of quality (how/task) names");
+  }
+  if (pyqualitynames != NULL && pyqualitynames != Py_None && PyObject_Length(pyqualitynames) > 0) {
+    Py_ssize_t nnames = PyObject_Length(pyqualitynames);
+    Py_ssize_t i = 0;
+    *qualitynames = RAVE_OBJECT_NEW(&RaveList_TYPE);
+    if (*qualitynames == NULL) {
+      raiseException_gotoTag(fail, PyExc_MemoryError, "Could not allocate memory");
+    }
+    for (i = 0; i < nnames; i++) {
+      PyObject* pystr = PyList_GetItem(pyqualitynames, i);
+      char* dupstr = NULL;
+      if (pystr == NULL || !PyString_Check(pystr)) {
+        raiseException_gotoTag(fail, PyExc_AttributeError, "second argument should be a list of quality (how/task) names (strings)");
+      }
+      dupstr = RAVE_STRDUP(PyString_AsString(pystr));
+      if (dupstr == NULL || !RaveList_add(*qualitynames, dupstr)) {
+        RAVE_FREE(dupstr);
+        raiseException_gotoTag(fail, PyExc_MemoryError, "Could not allocate memory");
+      }
+      dupstr = NULL; // We have handed it over to the rave list.
+    }
+  }
+  return 1;
+fail:
+  RaveList_freeAndDestroy(qualitynames);
+  return 0;
+}
+
 /**
  * Generates a composite according to the principles defined in the PyComposite object.
  * @param[in] self - self
@@ -324,6 +365,8 @@ static PyObject* _pycomposite_generate(PyComposite* self, PyObject* args)
   PyObject* pyresult = NULL;
   PyObject* pyqualitynames = NULL;
   RaveList_t* qualitynames = NULL;
+  Composite_t* composite = NULL;
+  Area_t* area = NULL;
 
   if (!PyArg_ParseTuple(args, "O|O", &obj, &pyqualitynames)) {
     return NULL;
@@ -331,47 +374,312 @@ static PyObject* _pycomposite_generate(PyComposite* self, PyObject* args)
   if (!PyArea_Check(obj)) {
     raiseException_returnNULL(PyExc_AttributeError, "argument should be an area");
   }
-  if (pyqualitynames != NULL && !PyList_Check(pyqualitynames)) {
-    raiseException_returnNULL(PyExc_AttributeError, "second argument should be a list of quality (how/task) names");
+  if (!_pycomposite_createQualityNames(pyqualitynames, &qualitynames)) {
+    return NULL;
   }
-  if (pyqualitynames != NULL && PyObject_Length(pyqualitynames) > 0) {
-    Py_ssize_t nnames = PyObject_Length(pyqualitynames);
-    Py_ssize_t i = 0;
-    qualitynames = RAVE_OBJECT_NEW(&RaveList_TYPE);
-    if (qualitynames == NULL) {
-      raiseException_gotoTag(done, PyExc_MemoryError, "Could not allocate memory");
+
+  composite = RAVE_OBJECT_COPY(self->composite);
+  area = RAVE_OBJECT_COPY(((PyArea*)obj)->area);
+  Py_BEGIN_ALLOW_THREADS
+  result = Composite_generate(composite, area, qualitynames);
+  Py_END_ALLOW_THREADS
+  if (result == NULL) {
+    raiseException_gotoTag(done, PyExc_AttributeError, "failed to generate composite");
+  }
+
+  pyresult = (PyObject*)PyCartesian_New(result);
+done:
+  RAVE_OBJECT_RELEASE(composite);
+  RAVE_OBJECT_RELEASE(area);
+  RAVE_OBJECT_RELEASE(result);
+  RaveList_freeAndDestroy(&qualitynames);
+  return pyresult;
+}
+
+/**
+ * Generates several products in one pass
+ * @param[in] self - self
+ * @param[in] args - the area, a list of product definitions and optionally the quality flags
+ * @return a list of cartesian products on success otherwise NULL
+ */
+static PyObject* _pycomposite_generateProducts(PyComposite* self, PyObject* args)
+{
+  PyObject* obj = NULL;
+  PyObject* pyproducts = NULL;
+  PyObject* pyqualitynames = NULL;
+  PyObject* pyresult = NULL;
+  RaveList_t* qualitynames = NULL;
+  RaveObjectList_t* result = NULL;
+  CompositeProduct_t* products = NULL;
+  Composite_t* composite = NULL;
+  Area_t* area = NULL;
+  Py_ssize_t nproducts = 0, i = 0;
+
+  if (!PyArg_ParseTuple(args, "OO|O", &obj, &pyproducts, &pyqualitynames)) {
+    return NULL;
+  }
+  if (!PyArea_Check(obj)) {
+    raiseException_returnNULL(PyExc_AttributeError, "argument should be an area");
+  }
+  if (!PySequence_Check(pyproducts) || (nproducts = PySequence_Size(pyproducts)) <= 0) {
+    raiseException_returnNULL(PyExc_AttributeError, "products should be a non-empty list of (product, prodpar[, selection_method])");
+  }
+  products = RAVE_MALLOC(sizeof(CompositeProduct_t) * nproducts);
+  if (products == NULL) {
+    raiseException_returnNULL(PyExc_MemoryError, "Failed to allocate memory for products");
+  }
+  for (i = 0; i < nproducts; i++) {
+    PyObject* item = PySequence_GetItem(pyproducts, i);
+    int ptype = 0, method = (int)Composite_getSelectionMethod(self->composite);
+    double prodpar = 0.0;
+    if (item == NULL || !PyTuple_Check(item) || !PyArg_ParseTuple(item, "id|i", &ptype, &prodpar, &method)) {
+      Py_XDECREF(item);
+      PyErr_Clear();
+      raiseException_gotoTag(done, PyExc_AttributeError, "products should be a list of (product, prodpar[, selection_method])");
     }
-    for (i = 0; i < nnames; i++) {
-      PyObject* pystr = PyList_GetItem(pyqualitynames, i);
-      char* dupstr = NULL;
-      if (pystr == NULL || !PyString_Check(pystr)) {
-        raiseException_gotoTag(done, PyExc_AttributeError, "second argument should be a list of quality (how/task) names (strings)");
-      }
-      dupstr = RAVE_STRDUP(PyString_AsString(pystr));
-      if (dupstr != NULL) {
-        if (!RaveList_add(qualitynames, dupstr)) {
-          raiseException_gotoTag(done, PyExc_MemoryError, "Could not allocate memory");
-          RAVE_FREE(dupstr);
-        }
-      } else {
-        raiseException_gotoTag(done, PyExc_MemoryError, "Could not allocate memory");
-      }
-      dupstr = NULL; // We have handed it over to the rave list.
+    Py_DECREF(item);
+    products[i].ptype = (Rave_ProductType)ptype;
+    products[i].height = Composite_getHeight(self->composite);
+    products[i].elangle = Composite_getElevationAngle(self->composite);
+    if (ptype == Rave_ProductType_PPI) {
+      products[i].elangle = prodpar;
+    } else {
+      products[i].height = prodpar;
     }
+    products[i].method = (CompositeSelectionMethod_t)method;
+  }
+  if (!_pycomposite_createQualityNames(pyqualitynames, &qualitynames)) {
+    goto done;
   }
 
-  result = Composite_generate(self->composite, ((PyArea*)obj)->area, qualitynames);
+  composite = RAVE_OBJECT_COPY(self->composite);
+  area = RAVE_OBJECT_COPY(((PyArea*)obj)->area);
+  Py_BEGIN_ALLOW_THREADS
+  result = Composite_generateProducts(composite, area, qualitynames, products, (int)nproducts);
+  Py_END_ALLOW_THREADS
   if (result == NULL) {
-    raiseException_gotoTag(done, PyExc_AttributeError, "failed to generate composite");
+    raiseException_gotoTag(done, PyExc_AttributeError, "failed to generate products");
   }
 
-  pyresult = (PyObject*)PyCartesian_New(result);
+  pyresult = PyList_New(0);
+  for (i = 0; pyresult != NULL && i < RaveObjectList_size(result); i++) {
+    Cartesian_t* cartesian = (Cartesian_t*)RaveObjectList_get(result, i);
+    PyObject* pycartesian = (PyObject*)PyCartesian_New(cartesian);
+    RAVE_OBJECT_RELEASE(cartesian);
+    if (pycartesian == NULL || PyList_Append(pyresult, pycartesian) < 0) {
+      Py_XDECREF(pycartesian);
+      Py_DECREF(pyresult);
+      pyresult = NULL;
+      break;
+    }
+    Py_DECREF(pycartesian);
+  }
+done:
+  RAVE_FREE(products);
+  RAVE_OBJECT_RELEASE(composite);
+  RAVE_OBJECT_RELEASE(area);
+  RAVE_OBJECT_RELEASE(result);
+  RaveList_freeAndDestroy(&qualitynames);
+  return pyresult;
+}
+
+/**
+ * Generates a stack of cappi or pcappi products at several heights
+ * @param[in] self - self
+ * @param[in] args - the area, the product type, a list of heights and optionally the quality flags
+ * @return a cartesian volume on success otherwise NULL
+ */
+static PyObject* _pycomposite_generateCappiVolume(PyComposite* self, PyObject* args)
+{
+  PyObject* obj = NULL;
+  PyObject* pyheights = NULL;
+  PyObject* pyqualitynames = NULL;
+  PyObject* pyresult = NULL;
+  RaveList_t* qualitynames = NULL;
+  CartesianVolume_t* result = NULL;
+  Composite_t* composite = NULL;
+  Area_t* area = NULL;
+  double* heights = NULL;
+  int ptype = 0;
+  Py_ssize_t nheights = 0, i = 0;
+
+  if (!PyArg_ParseTuple(args, "OiO|O", &obj, &ptype, &pyheights, &pyqualitynames)) {
+    return NULL;
+  }
+  if (!PyArea_Check(obj)) {
+    raiseException_returnNULL(PyExc_AttributeError, "argument should be an area");
+  }
+  if (!PySequence_Check(pyheights) || (nheights = PySequence_Size(pyheights)) <= 0) {
+    raiseException_returnNULL(PyExc_AttributeError, "heights should be a non-empty list of heights");
+  }
+  heights = RAVE_MALLOC(sizeof(double) * nheights);
+  if (heights == NULL) {
+    raiseException_returnNULL(PyExc_MemoryError, "Failed to allocate memory for heights");
+  }
+  for (i = 0; i < nheights; i++) {
+    PyObject* item = PySequence_GetItem(pyheights, i);
+    heights[i] = (item != NULL) ? PyFloat_AsDouble(item) : -1.0;
+    Py_XDECREF(item);
+    if (PyErr_Occurred()) {
+      PyErr_Clear();
+      raiseException_gotoTag(done, PyExc_AttributeError, "heights should be a list of heights");
+    }
+  }
+  if (!_pycomposite_createQualityNames(pyqualitynames, &qualitynames)) {
+    goto done;
+  }
+
+  composite = RAVE_OBJECT_COPY(self->composite);
+  area = RAVE_OBJECT_COPY(((PyArea*)obj)->area);
+  Py_BEGIN_ALLOW_THREADS
+  result = Composite_generateCappiVolume(composite, area, qualitynames, (Rave_ProductType)ptype, heights, (int)nheights);
+  Py_END_ALLOW_THREADS
+  if (result == NULL) {
+    raiseException_gotoTag(done, PyExc_AttributeError, "failed to generate cappi volume");
+  }
+  pyresult = (PyObject*)PyCartesianVolume_New(result);
+
 done:
+  RAVE_FREE(heights);
+  RAVE_OBJECT_RELEASE(composite);
+  RAVE_OBJECT_RELEASE(area);
   RAVE_OBJECT_RELEASE(result);
   RaveList_freeAndDestroy(&qualitynames);
   return pyresult;
 }
 
+/**
+ * Generates the composite over several areas
+ * @param[in] self - self
+ * @param[in] args - a list of areas, optionally the quality flags and the number of threads
+ * @return a list of cartesian products on success otherwise NULL
+ */
+static PyObject* _pycomposite_generateMany(PyComposite* self, PyObject* args)
+{
+  PyObject* pyareas = NULL;
+  PyObject* pyqualitynames = NULL;
+  PyObject* pyresult = NULL;
+  RaveList_t* qualitynames = NULL;
+  RaveObjectList_t* areas = NULL;
+  RaveObjectList_t* result = NULL;
+  Composite_t* composite = NULL;
+  Py_ssize_t nareas = 0, i = 0;
+  int nthreads = 1;
+
+  if (!PyArg_ParseTuple(args, "O|Oi", &pyareas, &pyqualitynames, &nthreads)) {
+    return NULL;
+  }
+  if (!PySequence_Check(pyareas) || (nareas = PySequence_Size(pyareas)) <= 0) {
+    raiseException_returnNULL(PyExc_AttributeError, "areas should be a non-empty list of areas");
+  }
+  areas = RAVE_OBJECT_NEW(&RaveObjectList_TYPE);
+  if (areas == NULL) {
+    raiseException_returnNULL(PyExc_MemoryError, "Failed to allocate memory for areas");
+  }
+  for (i = 0; i < nareas; i++) {
+    PyObject* item = PySequence_GetItem(pyareas, i);
+    if (item == NULL || !PyArea_Check(item)) {
+      Py_XDECREF(item);
+      raiseException_gotoTag(done, PyExc_AttributeError, "areas should be a non-empty list of areas");
+    }
+    if (!RaveObjectList_add(areas, (RaveCoreObject*)((PyArea*)item)->area)) {
+      Py_DECREF(item);
+      raiseException_gotoTag(done, PyExc_MemoryError, "Failed to add area to list");
+    }
+    Py_DECREF(item);
+  }
+  if (!_pycomposite_createQualityNames(pyqualitynames, &qualitynames)) {
+    goto done;
+  }
+
+  composite = RAVE_OBJECT_COPY(self->composite);
+  Py_BEGIN_ALLOW_THREADS
+  result = Composite_generateMany(composite, areas, qualitynames, nthreads);
+  Py_END_ALLOW_THREADS
+  if (result == NULL) {
+    raiseException_gotoTag(done, PyExc_AttributeError, "failed to generate composites");
+  }
+
+  pyresult = PyList_New(0);
+  for (i = 0; pyresult != NULL && i < RaveObjectList_size(result); i++) {
+    Cartesian_t* cartesian = (Cartesian_t*)RaveObjectList_get(result, i);
+    PyObject* pycartesian = (PyObject*)PyCartesian_New(cartesian);
+    RAVE_OBJECT_RELEASE(cartesian);
+    if (pycartesian == NULL || PyList_Append(pyresult, pycartesian) < 0) {
+      Py_XDECREF(pycartesian);
+      Py_DECREF(pyresult);
+      pyresult = NULL;
+      break;
+    }
+    Py_DECREF(pycartesian);
+  }
+done:
+  RAVE_OBJECT_RELEASE(composite);
+  RAVE_OBJECT_RELEASE(areas);
+  RAVE_OBJECT_RELEASE(result);
+  RaveList_freeAndDestroy(&qualitynames);
+  return pyresult;
+}
+
+/**
+ * Generates the composite in blocks of rows and writes them to a file
+ * @param[in] self - self
+ * @param[in] args - the area, the quality flags, the filename and optionally rows per block and compression level
+ * @return None on success otherwise NULL
+ */
+static PyObject* _pycomposite_generateToFile(PyComposite* self, PyObject* args)
+{
+  PyObject* obj = NULL;
+  PyObject* pyqualitynames = NULL;
+  PyObject* pyresult = NULL;
+  RaveList_t* qualitynames = NULL;
+  Composite_t* composite = NULL;
+  Area_t* area = NULL;
+  CartesianStreamWriter_t* writer = NULL;
+  char* filename = NULL;
+  long blockrows = 256;
+  int level = 6;
+  int result = 0;
+
+  if (!PyArg_ParseTuple(args, "OOs|li", &obj, &pyqualitynames, &filename, &blockrows, &level)) {
+    return NULL;
+  }
+  if (!PyArea_Check(obj)) {
+    raiseException_returnNULL(PyExc_AttributeError, "argument should be an area");
+  }
+  if (!_pycomposite_createQualityNames(pyqualitynames, &qualitynames)) {
+    return NULL;
+  }
+
+  writer = RAVE_OBJECT_NEW(&CartesianStreamWriter_TYPE);
+  if (writer == NULL) {
+    raiseException_gotoTag(done, PyExc_MemoryError, "Could not create writer");
+  }
+  if (!CartesianStreamWriter_setCompressionLevel(writer, level)) {
+    raiseException_gotoTag(done, PyExc_ValueError, "compression level must be between 0 - 9");
+  }
+
+  composite = RAVE_OBJECT_COPY(self->composite);
+  area = RAVE_OBJECT_COPY(((PyArea*)obj)->area);
+  Py_BEGIN_ALLOW_THREADS
+  result = CartesianStreamWriter_open(writer, filename, area) &&
+           Composite_generateBlocks(composite, area, qualitynames, blockrows, CartesianStreamWriter_blockWriter, writer);
+  result = CartesianStreamWriter_close(writer) && result;
+  Py_END_ALLOW_THREADS
+  if (!result) {
+    raiseException_gotoTag(done, PyExc_IOError, "failed to generate composite to file");
+  }
+
+  Py_INCREF(Py_None);
+  pyresult = Py_None;
+done:
+  RAVE_OBJECT_RELEASE(writer);
+  RAVE_OBJECT_RELEASE(composite);
+  RAVE_OBJECT_RELEASE(area);
+  RaveList_freeAndDestroy(&qualitynames);
+  return pyresult;
+}
+
 /**
  * All methods a cartesian product can have
  */
@@ -386,6 +694,9 @@ static struct PyMethodDef _pycomposite_methods[] =
   {"date", NULL, METH_VARARGS},
   {"time", NULL, METH_VARARGS},
   {"quality_indicator_field_name", NULL, METH_VARARGS},
+  {"lazy_quality", NULL, METH_VARARGS},
+  {"etop_threshold", NULL, METH_VARARGS},
+  {"nthreads", NULL, METH_VARARGS},
   {"addParameter", (PyCFunction)_pycomposite_addParameter, 1,
     "addParameter(quantity, gain, offset, minvalue)\n\n" // "sddd", &
     "Adds one parameter (quantity) that should be processed in the run.\n\n"
@@ -434,6 +745,54 @@ static struct PyMethodDef _pycomposite_methods[] =
     "Example:\n"
     " result = generator.generate(myarea, [\"se.smhi.composite.distance.radar\",\"pl.imgw.radvolqc.spike\"])"
   },
+  {"generateProducts", (PyCFunction) _pycomposite_generateProducts, 1,
+    "generateProducts(area,products[,qualityfields]) -> list of CartesianCore\n\n"
+    "Generates several products over the same area in one pass. The position of each pixel in each radar is\n"
+    "calculated once and shared by all products. All settings except product, height, elangle and selection_method\n"
+    "are shared by the products. The settings of the generator itself are not modified.\n\n"
+    "area          - The AreaCore defining the area to be generated.\n"
+    "products      - A list of tuples (product, prodpar[, selection_method]). prodpar is the elevation angle in radians for\n"
+    "                PPI and the height in meters for the other product types. selection_method defaults to the generators.\n"
+    "qualityfields - See generate.\n"
+    "Example:\n"
+    " pcappi500, pcappi1000, maxp = generator.generateProducts(myarea, [(_rave.Rave_ProductType_PCAPPI, 500.0),\n"
+    "                                                                   (_rave.Rave_ProductType_PCAPPI, 1000.0),\n"
+    "                                                                   (_rave.Rave_ProductType_MAX, 0.0)])"
+  },
+  {"generateCappiVolume", (PyCFunction) _pycomposite_generateCappiVolume, 1,
+    "generateCappiVolume(area,product,heights[,qualityfields]) -> CartesianVolumeCore\n\n"
+    "Generates a stack of CAPPI or PCAPPI products in one pass as with generateProducts and returns them as a cartesian\n"
+    "volume with one image per height. zstart is the first height and zscale the distance between the first two heights.\n\n"
+    "area          - The AreaCore defining the area to be generated.\n"
+    "product       - _rave.Rave_ProductType_CAPPI or _rave.Rave_ProductType_PCAPPI\n"
+    "heights       - A list of heights in meters in ascending order.\n"
+    "qualityfields - See generate.\n"
+    "Example:\n"
+    " cvol = generator.generateCappiVolume(myarea, _rave.Rave_ProductType_PCAPPI, [500.0, 1000.0, 1500.0])"
+  },
+  {"generateMany", (PyCFunction) _pycomposite_generateMany, 1,
+    "generateMany(areas[,qualityfields[,nthreads]]) -> list of CartesianCore\n\n"
+    "Generates the composite over several areas from the same radar objects. The objects are prepared once and\n"
+    "shared read-only while the areas are generated concurrently. The result is the same as calling generate once\n"
+    "per area.\n\n"
+    "areas         - A list of AreaCore.\n"
+    "qualityfields - See generate.\n"
+    "nthreads      - Maximum number of threads to use, default 1.\n"
+    "Example:\n"
+    " national, regional = generator.generateMany([area1, area2], [\"se.smhi.composite.distance.radar\"], 2)"
+  },
+  {"generateToFile", (PyCFunction) _pycomposite_generateToFile, 1,
+    "generateToFile(area,qualityfields,filename[,blockrows[,compression_level]])\n\n"
+    "Generates the same composite as generate but writes it as ODIM H5 to filename block by block while it is being generated.\n"
+    "Only one block of rows is kept in memory at any time which makes it possible to generate very large composites.\n\n"
+    "area              - The AreaCore defining the area to be generated.\n"
+    "qualityfields     - A list of how/task values, see generate. Can be None.\n"
+    "filename          - The file to write.\n"
+    "blockrows         - Number of rows in each block, default 256. Datasets are chunked by this number of rows.\n"
+    "compression_level - zlib compression level 0 - 9, default 6.\n"
+    "Example:\n"
+    " generator.generateToFile(myarea, [\"se.smhi.composite.distance.radar\"], \"/tmp/comp.h5\", 512)"
+  },
   {NULL, NULL } /* sentinel */
 };
 
@@ -484,6 +843,12 @@ static PyObject* _pycomposite_getattro(PyComposite* self, PyObject* name)
     } else {
       Py_RETURN_NONE;
     }
+  } else if (PY_COMPARE_STRING_WITH_ATTRO_NAME("lazy_quality", name) == 0) {
+    return PyBool_FromLong(Composite_getLazyQuality(self->composite));
+  } else if (PY_COMPARE_STRING_WITH_ATTRO_NAME("etop_threshold", name) == 0) {
+    return PyFloat_FromDouble(Composite_getEchoTopThreshold(self->composite));
+  } else if (PY_COMPARE_STRING_WITH_ATTRO_NAME("nthreads", name) == 0) {
+    return PyInt_FromLong(Composite_getNumberOfThreads(self->composite));
   }
   return PyObject_GenericGetAttr((PyObject*)self, name);
 }
@@ -571,6 +936,26 @@ static int _pycomposite_setattro(PyComposite* self, PyObject* name, PyObject* va
     } else {
       raiseException_gotoTag(done, PyExc_ValueError, "quality_indicator_field_name must be a string");
     }
+  } else if (PY_COMPARE_STRING_WITH_ATTRO_NAME("lazy_quality", name) == 0) {
+    if (PyBool_Check(val) || PyInt_Check(val)) {
+      Composite_setLazyQuality(self->composite, PyObject_IsTrue(val));
+    } else {
+      raiseException_gotoTag(done, PyExc_TypeError, "lazy_quality must be a boolean");
+    }
+  } else if (PY_COMPARE_STRING_WITH_ATTRO_NAME("etop_threshold", name) == 0) {
+    if (PyFloat_Check(val)) {
+      Composite_setEchoTopThreshold(self->composite, PyFloat_AsDouble(val));
+    } else if (PyLong_Check(val)) {
+      Composite_setEchoTopThreshold(self->composite, PyLong_AsDouble(val));
+    } else if (PyInt_Check(val)) {
+      Composite_setEchoTopThreshold(self->composite, (double)PyInt_AsLong(val));
+    } else {
+      raiseException_gotoTag(done, PyExc_TypeError, "etop_threshold must be a float or decimal value")
+    }
+  } else if (PY_COMPARE_STRING_WITH_ATTRO_NAME("nthreads", name) == 0) {
+    if (!PyInt_Check(val) || !Composite_setNumberOfThreads(self->composite, (int)PyInt_AsLong(val))) {
+      raiseException_gotoTag(done, PyExc_ValueError, "nthreads must be an integer >= 1");
+    }
   } else if (PY_COMPARE_STRING_WITH_ATTRO_NAME("algorithm", name) == 0) {
     if (val == Py_None) {
       Composite_setAlgorithm(self->composite, NULL);
@@ -604,6 +989,11 @@ PyDoc_STRVAR(_pycomposite_type_doc,
     "                                PPI requires elevation angle\n"
     "                                CAPPI, PCAPPI and PMAX requires height above sea level\n"
     "                                PMAX also requires range in meters\n"
+    "                                ETOP and VIL are generated from polar volumes with exactly one reflectivity parameter. The result is\n"
+    "                                stored as HGHT (km) for ETOP and VIL (kg/m2) for VIL with the gain and offset of the parameter.\n"
+    "                                Where radars overlap the highest value is used. Quality flags are not generated for these products.\n"
+    " etop_threshold               - The reflectivity threshold in dBZ used when generating ETOP. Default 20.0.\n"
+    " nthreads                     - The number of threads that share the rows when generating ETOP and VIL. Default is 1.\n"
     " selection_method             - The selection method to use when there are more than one radar covering same point. I.e. if for example taking distance to radar or height above sea level. Currently the following methods are available\n"
     "       _pycomposite.SelectionMethod_NEAREST - Value from the nearest radar is selected.\n"
     "       _pycomposite.SelectionMethod_HEIGHT  - Value from radar which scan is closest to the sea level at current point.\n"
@@ -627,6 +1017,9 @@ PyDoc_STRVAR(_pycomposite_type_doc,
     " time                         - The nominal time as a string in format HHmmss\n"
     " quality_indicator_field_name - If this field name is set, then the composite will be generated by first using the quality indicator field for determining\n"
     "                                radar usage. If the field name is None, then the selection method will be used instead.\n"
+    " lazy_quality                 - If True, only the winning radar and bin is kept for each pixel when generating and the quality\n"
+    "                                fields are derived from that when they are first accessed. Only applies to nearest interpolation\n"
+    "                                and to the quality flags not filled by the algorithm.\n"
     "\n"
     "Usage:\n"
     " import _pycomposite\n"
@@ -761,6 +1154,7 @@ MOD_INIT(_pycomposite)
   import_pypolarvolume();
   import_pypolarscan();
   import_pycartesian();
+  import_pycartesianvolume();
   import_pyarea();
   import_array(); /*To make sure I get access to Numeric*/
   import_compositealgorithm();
@@ -115,9 +115,17 @@ static PyObject* _dealias_func(PyObject* self, PyObject* args)
   }
 
   if (PyPolarVolume_Check(object)) {
-    ret = dealias_pvol_by_quantity(volume->pvol, (const char*)parameter, emax);
+    PolarVolume_t* pvol = RAVE_OBJECT_COPY(volume->pvol);
+    Py_BEGIN_ALLOW_THREADS
+    ret = dealias_pvol_by_quantity(pvol, (const char*)parameter, emax);
+    Py_END_ALLOW_THREADS
+    RAVE_OBJECT_RELEASE(pvol);
   } else {
-    ret = dealias_scan_by_quantity(scan->scan, (const char*)parameter, emax);
+    PolarScan_t* pscan = RAVE_OBJECT_COPY(scan->scan);
+    Py_BEGIN_ALLOW_THREADS
+    ret = dealias_scan_by_quantity(pscan, (const char*)parameter, emax);
+    Py_END_ALLOW_THREADS
+    RAVE_OBJECT_RELEASE(pscan);
   }
 
   if (ret) {
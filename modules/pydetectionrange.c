@@ -158,6 +158,8 @@ static PyObject* _pydetectionrange_top(PyDetectionRange* self, PyObject* args)
   PyObject* result = NULL;
   PyPolarVolume* volume = NULL;
   PolarScan_t* scan = NULL;
+  DetectionRange_t* dr = NULL;
+  PolarVolume_t* pvol = NULL;
   double scale = 0.0, threshold = 0.0;
   char* paramname = "DBZH";
   if (!PyArg_ParseTuple(args, "Odd|s", &object, &scale, &threshold, &paramname)) {
@@ -169,7 +171,13 @@ static PyObject* _pydetectionrange_top(PyDetectionRange* self, PyObject* args)
     raiseException_returnNULL(PyExc_AttributeError, "Top requires volume");
   }
 
-  scan = DetectionRange_top(self->dr, volume->pvol, scale, threshold, paramname);
+  dr = RAVE_OBJECT_COPY(self->dr);
+  pvol = RAVE_OBJECT_COPY(volume->pvol);
+  Py_BEGIN_ALLOW_THREADS
+  scan = DetectionRange_top(dr, pvol, scale, threshold, paramname);
+  Py_END_ALLOW_THREADS
+  RAVE_OBJECT_RELEASE(dr);
+  RAVE_OBJECT_RELEASE(pvol);
   if (scan == NULL) {
     raiseException_returnNULL(PyExc_Exception, "Failed to create top");
   }
@@ -190,6 +198,8 @@ static PyObject* _pydetectionrange_filter(PyDetectionRange* self, PyObject* args
   PyObject* object = NULL;
   PyPolarScan* pyscan = NULL;
   PolarScan_t* filteredscan = NULL;
+  DetectionRange_t* dr = NULL;
+  PolarScan_t* scan = NULL;
   PyObject* result = NULL;
 
   if (!PyArg_ParseTuple(args, "O", &object)) {
@@ -200,7 +210,13 @@ static PyObject* _pydetectionrange_filter(PyDetectionRange* self, PyObject* args
   } else {
     raiseException_returnNULL(PyExc_AttributeError, "filter requires scan");
   }
-  filteredscan = DetectionRange_filter(self->dr, pyscan->scan);
+  dr = RAVE_OBJECT_COPY(self->dr);
+  scan = RAVE_OBJECT_COPY(pyscan->scan);
+  Py_BEGIN_ALLOW_THREADS
+  filteredscan = DetectionRange_filter(dr, scan);
+  Py_END_ALLOW_THREADS
+  RAVE_OBJECT_RELEASE(dr);
+  RAVE_OBJECT_RELEASE(scan);
   if (filteredscan == NULL) {
     raiseException_returnNULL(PyExc_Exception, "Failed to filter scan");
   }
@@ -220,6 +236,8 @@ static PyObject* _pydetectionrange_analyze(PyDetectionRange* self, PyObject* arg
   PyObject* object = NULL;
   PyPolarScan* pyscan = NULL;
   RaveField_t* analyzedfield = NULL;
+  DetectionRange_t* dr = NULL;
+  PolarScan_t* scan = NULL;
   PyObject* result = NULL;
   int avgsector = 0;
   double sortage = 0.0L;
@@ -233,7 +251,13 @@ static PyObject* _pydetectionrange_analyze(PyDetectionRange* self, PyObject* arg
   } else {
     raiseException_returnNULL(PyExc_AttributeError, "filter requires scan");
   }
-  analyzedfield = DetectionRange_analyze(self->dr, pyscan->scan, avgsector, sortage, samplepoint);
+  dr = RAVE_OBJECT_COPY(self->dr);
+  scan = RAVE_OBJECT_COPY(pyscan->scan);
+  Py_BEGIN_ALLOW_THREADS
+  analyzedfield = DetectionRange_analyze(dr, scan, avgsector, sortage, samplepoint);
+  Py_END_ALLOW_THREADS
+  RAVE_OBJECT_RELEASE(dr);
+  RAVE_OBJECT_RELEASE(scan);
   if (analyzedfield == NULL) {
     raiseException_returnNULL(PyExc_Exception, "Failed to analyze field");
   }
@@ -153,6 +153,9 @@ static PyObject* _pygra_apply(PyGra* self, PyObject* args)
   PyObject* pyfield = NULL;
   PyObject* pyparameter = NULL;
   CartesianParam_t* graparam = NULL;
+  RaveGra_t* gra = NULL;
+  RaveField_t* field = NULL;
+  CartesianParam_t* parameter = NULL;
   PyObject* result = NULL;
 
   if (!PyArg_ParseTuple(args, "OO", &pyfield, &pyparameter)) {
@@ -163,7 +166,15 @@ static PyObject* _pygra_apply(PyGra* self, PyObject* args)
     raiseException_returnNULL(PyExc_AttributeError, "Must provide apply with <rave field with distance>, <cartesian parameter with data>");
   }
 
-  graparam = RaveGra_apply(self->gra, ((PyRaveField*)pyfield)->field, ((PyCartesianParam*)pyparameter)->param);
+  gra = RAVE_OBJECT_COPY(self->gra);
+  field = RAVE_OBJECT_COPY(((PyRaveField*)pyfield)->field);
+  parameter = RAVE_OBJECT_COPY(((PyCartesianParam*)pyparameter)->param);
+  Py_BEGIN_ALLOW_THREADS
+  graparam = RaveGra_apply(gra, field, parameter);
+  Py_END_ALLOW_THREADS
+  RAVE_OBJECT_RELEASE(gra);
+  RAVE_OBJECT_RELEASE(field);
+  RAVE_OBJECT_RELEASE(parameter);
 
   if (graparam != NULL) {
     result = (PyObject*)PyCartesianParam_New(graparam);
@@ -187,6 +198,7 @@ static struct PyMethodDef _pygra_methods[] =
   {"lowerThreshold", NULL, METH_VARARGS},
   {"zrA", NULL, METH_VARARGS},
   {"zrb", NULL, METH_VARARGS},
+  {"nthreads", NULL, METH_VARARGS},
   {"apply", (PyCFunction) _pygra_apply, 1,
     "apply(distanceField, cartesian_parameter) -> cartesian parameter\n\n"
     "Applies the coefficients on the parameter field. The distance field dimensions must match the parameter dimensions.\n"
@@ -219,6 +231,8 @@ static PyObject* _pygra_getattro(PyGra* self, PyObject* name)
     return PyFloat_FromDouble(RaveGra_getZRA(self->gra));
   } else if (PY_COMPARE_STRING_WITH_ATTRO_NAME("zrb", name) == 0) {
     return PyFloat_FromDouble(RaveGra_getZRB(self->gra));
+  } else if (PY_COMPARE_STRING_WITH_ATTRO_NAME("nthreads", name) == 0) {
+    return PyInt_FromLong(RaveGra_getNumberOfThreads(self->gra));
   }
   return PyObject_GenericGetAttr((PyObject*)self, name);
 }
@@ -302,6 +316,10 @@ static int _pygra_setattro(PyGra* self, PyObject* name, PyObject* val)
     } else {
       raiseException_gotoTag(done, PyExc_TypeError, "zrb must be a number");
     }
+  } else if (PY_COMPARE_STRING_WITH_ATTRO_NAME("nthreads", name) == 0) {
+    if (!PyInt_Check(val) || !RaveGra_setNumberOfThreads(self->gra, (int)PyInt_AsLong(val))) {
+      raiseException_gotoTag(done, PyExc_ValueError, "nthreads must be an integer >= 1");
+    }
   } else {
     raiseException_gotoTag(done, PyExc_AttributeError, "Unknown attribute");
   }
@@ -339,7 +357,8 @@ PyDoc_STRVAR(_pygra_module_doc,
     " upperThreshold - The upper threshold in 10ths of dBR. Default is 2.0 (20 dBR)\n"
     " lowerThreshold - The lower threshold in 10ths of dBR. Default is -0.25 (-2.5 dBR)\n"
     " zrA            - ZR A coefficient.\n"
-    " zrB            - ZR B coefficient when converting from reflectivity to MM/H\n\n"
+    " zrB            - ZR B coefficient when converting from reflectivity to MM/H\n"
+    " nthreads       - Number of threads used when applying the coefficients. Default is 1.\n\n"
   "Usage:\n"
   " import _gra\n"
   " gra = _gra.new()\n"
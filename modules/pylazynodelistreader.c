@@ -337,8 +337,10 @@ static PyObject* _pylazynodelistreader_exists(PyLazyNodeListReader* self, PyObje
 static struct PyMethodDef _pylazynodelistreader_methods[] =
 {
     {"preload", (PyCFunction) _pylazynodelistreader_preload, 1,
-        "preload()\n\n"
-        "Preloads all datasets immediately. This is useful if a lot of different datasets should be loaded and read.\n"},
+        "preload([quantities])\n\n"
+        "Preloads all datasets immediately. This is useful if a lot of different datasets should be loaded and read.\n"
+        "quantities - optional comma-separated list of quantities and quality field how/tasks. If given, only the parameters\n"
+        "             with a matching quantity and the quality fields with a matching how/task are loaded.\n"},
   {"getDataset", (PyCFunction) _pylazynodelistreader_getDataset, 1,
       "getRaveData2D(nodename) -> rave data 2d field\n\n"
       "Returns the dataset associated with the nodename\n"},
@@ -30,6 +30,7 @@ along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
 #include "pypolarscan.h"
 #include "pyravefield.h"
 #include "odc_hac.h"
+#include "odc_hac_store.h"
 
 /**
  * Debug this module
@@ -148,6 +149,341 @@ static PyObject* _zdiff_func(PyObject* self, PyObject* args)
   Py_RETURN_NONE;
 }
 
+/*@{ HAC store */
+/**
+ * The python wrapper for the HAC store
+ */
+typedef struct {
+  PyObject_HEAD /*Always has to be on top*/
+  HacStore_t* store; /**< the native object */
+} PyHacStore;
+
+static PyTypeObject PyHacStore_Type;
+
+/**
+ * Deallocates the store. Modified accumulators are written by the native destructor.
+ * @param[in] obj the object to deallocate.
+ */
+static void _pyhacstore_dealloc(PyHacStore* obj)
+{
+  if (obj == NULL) {
+    return;
+  }
+  PYRAVE_DEBUG_OBJECT_DESTROYED;
+  RAVE_OBJECT_UNBIND(obj->store, obj);
+  RAVE_OBJECT_RELEASE(obj->store);
+  PyObject_Del(obj);
+}
+
+/**
+ * Creates a new HAC store
+ * @param[in] self - this instance.
+ * @param[in] args - optional flush interval in seconds
+ * @return the store on success otherwise NULL
+ */
+static PyObject* _pyhacstore_new(PyObject* self, PyObject* args)
+{
+  PyHacStore* result = NULL;
+  int interval = 300;
+
+  if (!PyArg_ParseTuple(args, "|i", &interval)) {
+    return NULL;
+  }
+  result = PyObject_NEW(PyHacStore, &PyHacStore_Type);
+  if (result == NULL) {
+    return NULL;
+  }
+  result->store = RAVE_OBJECT_NEW(&HacStore_TYPE);
+  if (result->store == NULL) {
+    PyObject_Del(result);
+    raiseException_returnNULL(PyExc_MemoryError, "Failed to create HAC store");
+  }
+  PYRAVE_DEBUG_OBJECT_CREATED;
+  RAVE_OBJECT_BIND(result->store, result);
+  HacStore_setFlushInterval(result->store, interval);
+  return (PyObject*)result;
+}
+
+/**
+ * Increments the accumulator for the file with the hits in the scan
+ * @param[in] self - self
+ * @param[in] args - filename, scan, quantity
+ * @return True on success, False if scan did not contain the quantity or had another geometry
+ */
+static PyObject* _pyhacstore_increment(PyHacStore* self, PyObject* args)
+{
+  PyObject* scanobj = NULL;
+  char* filename = NULL;
+  char* quant = NULL;
+  HacStore_t* store = NULL;
+  PolarScan_t* scan = NULL;
+  int result = 0;
+
+  if (!PyArg_ParseTuple(args, "sOs", &filename, &scanobj, &quant)) {
+    return NULL;
+  }
+  if (!PyPolarScan_Check(scanobj)) {
+    raiseException_returnNULL(PyExc_AttributeError, "HAC incrementor requires scan as input");
+  }
+  store = RAVE_OBJECT_COPY(self->store);
+  scan = RAVE_OBJECT_COPY(((PyPolarScan*)scanobj)->scan);
+  Py_BEGIN_ALLOW_THREADS
+  result = HacStore_increment(store, filename, scan, quant);
+  Py_END_ALLOW_THREADS
+  RAVE_OBJECT_RELEASE(store);
+  RAVE_OBJECT_RELEASE(scan);
+  return PyBool_FromLong(result);
+}
+
+/**
+ * Increments the accumulator for the file with hits extracted from a scan
+ * @param[in] self - self
+ * @param[in] args - filename, field with the hits
+ * @return True on success, False if the hits had another geometry
+ */
+static PyObject* _pyhacstore_incrementHits(PyHacStore* self, PyObject* args)
+{
+  PyObject* fieldobj = NULL;
+  char* filename = NULL;
+  HacStore_t* store = NULL;
+  RaveField_t* hits = NULL;
+  int result = 0;
+
+  if (!PyArg_ParseTuple(args, "sO", &filename, &fieldobj)) {
+    return NULL;
+  }
+  if (!PyRaveField_Check(fieldobj)) {
+    raiseException_returnNULL(PyExc_AttributeError, "HAC incrementor requires field with hits as input");
+  }
+  store = RAVE_OBJECT_COPY(self->store);
+  hits = RAVE_OBJECT_COPY(((PyRaveField*)fieldobj)->field);
+  Py_BEGIN_ALLOW_THREADS
+  result = HacStore_incrementHits(store, filename, hits);
+  Py_END_ALLOW_THREADS
+  RAVE_OBJECT_RELEASE(store);
+  RAVE_OBJECT_RELEASE(hits);
+  return PyBool_FromLong(result);
+}
+
+/**
+ * Returns information about a climatology
+ * @param[in] self - self
+ * @param[in] args - filename
+ * @return a tuple (count, nrays, nbins) or None if there is no such climatology
+ */
+static PyObject* _pyhacstore_climatology(PyHacStore* self, PyObject* args)
+{
+  char* filename = NULL;
+  HacStore_t* store = NULL;
+  long count = 0, nrays = 0, nbins = 0;
+  int result = 0;
+
+  if (!PyArg_ParseTuple(args, "s", &filename)) {
+    return NULL;
+  }
+  store = RAVE_OBJECT_COPY(self->store);
+  Py_BEGIN_ALLOW_THREADS
+  result = HacStore_getClimatology(store, filename, &count, &nrays, &nbins);
+  Py_END_ALLOW_THREADS
+  RAVE_OBJECT_RELEASE(store);
+  if (!result) {
+    Py_RETURN_NONE;
+  }
+  return Py_BuildValue("(lll)", count, nrays, nbins);
+}
+
+/**
+ * Filters the scan with the climatology in the file
+ * @param[in] self - self
+ * @param[in] args - filename, scan, quantity
+ * @return True on success otherwise False
+ */
+static PyObject* _pyhacstore_filter(PyHacStore* self, PyObject* args)
+{
+  PyObject* scanobj = NULL;
+  char* filename = NULL;
+  char* quant = NULL;
+  HacStore_t* store = NULL;
+  PolarScan_t* scan = NULL;
+  int result = 0;
+
+  if (!PyArg_ParseTuple(args, "sOs", &filename, &scanobj, &quant)) {
+    return NULL;
+  }
+  if (!PyPolarScan_Check(scanobj)) {
+    raiseException_returnNULL(PyExc_AttributeError, "HAC filter requires scan as input");
+  }
+  store = RAVE_OBJECT_COPY(self->store);
+  scan = RAVE_OBJECT_COPY(((PyPolarScan*)scanobj)->scan);
+  Py_BEGIN_ALLOW_THREADS
+  result = HacStore_filter(store, filename, scan, quant);
+  Py_END_ALLOW_THREADS
+  RAVE_OBJECT_RELEASE(store);
+  RAVE_OBJECT_RELEASE(scan);
+  return PyBool_FromLong(result);
+}
+
+/**
+ * Writes all modified accumulators
+ * @param[in] self - self
+ * @param[in] args - N/A
+ * @return None on success otherwise an IOError is raised
+ */
+static PyObject* _pyhacstore_flush(PyHacStore* self, PyObject* args)
+{
+  HacStore_t* store = NULL;
+  int result = 0;
+
+  if (!PyArg_ParseTuple(args, "")) {
+    return NULL;
+  }
+  store = RAVE_OBJECT_COPY(self->store);
+  Py_BEGIN_ALLOW_THREADS
+  result = HacStore_flush(store);
+  Py_END_ALLOW_THREADS
+  RAVE_OBJECT_RELEASE(store);
+  if (!result) {
+    raiseException_returnNULL(PyExc_IOError, "Failed to write HAC files");
+  }
+  Py_RETURN_NONE;
+}
+
+/**
+ * All methods a HAC store can have
+ */
+static struct PyMethodDef _pyhacstore_methods[] =
+{
+  {"flush_interval", NULL, METH_VARARGS},
+  {"accumulators", NULL, METH_VARARGS},
+  {"climatologies", NULL, METH_VARARGS},
+  {"increment", (PyCFunction)_pyhacstore_increment, 1,
+    "increment(filename, scan, quant) -> boolean\n\n"
+    "Increments the accumulator kept in memory for filename with the hits in the scan. The file is only\n"
+    "read the first time and is written when flush_interval seconds have passed since it was last written.\n\n"
+    "filename - the HAC file\n"
+    "scan     - a polar scan\n"
+    "quant    - parameter in scan that should be processed"
+  },
+  {"incrementHits", (PyCFunction)_pyhacstore_incrementHits, 1,
+    "incrementHits(filename, hits) -> boolean\n\n"
+    "Same as increment but with hits that already have been extracted from a scan, e.g. by another process.\n"
+    "Each non-zero bin in hits is one hit and the accumulation count is incremented by one.\n\n"
+    "filename - the HAC file\n"
+    "hits     - a rave field with nrays rows and nbins columns"
+  },
+  {"climatology", (PyCFunction)_pyhacstore_climatology, 1,
+    "climatology(filename) -> (count, nrays, nbins) or None\n\n"
+    "Returns information about the climatology in filename. The file is read once and cached.\n\n"
+    "filename - the HAC file"
+  },
+  {"filter", (PyCFunction)_pyhacstore_filter, 1,
+    "filter(filename, scan, quant) -> boolean\n\n"
+    "Performs HAC filtering using the cached climatology in filename. The scan must have a quality\n"
+    "field with how/task eu.opera.odc.hac and the threshold in how/task_args.\n\n"
+    "filename - the HAC file\n"
+    "scan     - a polar scan\n"
+    "quant    - parameter in scan that should be processed"
+  },
+  {"flush", (PyCFunction)_pyhacstore_flush, 1,
+    "flush()\n\n"
+    "Writes all modified accumulators to their files."
+  },
+  {NULL, NULL} /* sentinel */
+};
+
+/**
+ * Returns the specified attribute in the HAC store
+ */
+static PyObject* _pyhacstore_getattro(PyHacStore* self, PyObject* name)
+{
+  if (PY_COMPARE_STRING_WITH_ATTRO_NAME("flush_interval", name) == 0) {
+    return PyInt_FromLong(HacStore_getFlushInterval(self->store));
+  } else if (PY_COMPARE_STRING_WITH_ATTRO_NAME("accumulators", name) == 0) {
+    return PyInt_FromLong(HacStore_getNumberOfAccumulators(self->store));
+  } else if (PY_COMPARE_STRING_WITH_ATTRO_NAME("climatologies", name) == 0) {
+    return PyInt_FromLong(HacStore_getNumberOfClimatologies(self->store));
+  }
+  return PyObject_GenericGetAttr((PyObject*)self, name);
+}
+
+/**
+ * Sets the specified attribute in the HAC store
+ */
+static int _pyhacstore_setattro(PyHacStore* self, PyObject* name, PyObject* val)
+{
+  int result = -1;
+  if (name == NULL) {
+    goto done;
+  }
+  if (PY_COMPARE_STRING_WITH_ATTRO_NAME("flush_interval", name) == 0) {
+    if (PyInt_Check(val)) {
+      HacStore_setFlushInterval(self->store, (int)PyInt_AsLong(val));
+    } else {
+      raiseException_gotoTag(done, PyExc_TypeError, "flush_interval must be an integer");
+    }
+  } else {
+    raiseException_gotoTag(done, PyExc_AttributeError, PY_RAVE_ATTRO_NAME_TO_STRING(name));
+  }
+  result = 0;
+done:
+  return result;
+}
+
+PyDoc_STRVAR(_pyhacstore_type_doc,
+    "Keeps HAC accumulators in memory and writes them to their files at an interval instead of for each scan.\n"
+    "Climatologies used for filtering are read once and cached. Modified accumulators are written when flush()\n"
+    "is called and when the store is destroyed.\n\n"
+    " flush_interval - seconds between writes of a modified accumulator, 0 writes after each increment\n"
+    " accumulators   - number of accumulators kept in memory (read only)\n"
+    " climatologies  - number of cached climatologies (read only)\n"
+    );
+
+static PyTypeObject PyHacStore_Type =
+{
+  PyVarObject_HEAD_INIT(NULL, 0) /*ob_size*/
+  "HacStoreCore", /*tp_name*/
+  sizeof(PyHacStore), /*tp_size*/
+  0, /*tp_itemsize*/
+  /* methods */
+  (destructor)_pyhacstore_dealloc, /*tp_dealloc*/
+  0, /*tp_print*/
+  (getattrfunc)0,               /*tp_getattr*/
+  (setattrfunc)0,               /*tp_setattr*/
+  0,                            /*tp_compare*/
+  0,                            /*tp_repr*/
+  0,                            /*tp_as_number */
+  0,
+  0,                            /*tp_as_mapping */
+  0,                            /*tp_hash*/
+  (ternaryfunc)0,               /*tp_call*/
+  (reprfunc)0,                  /*tp_str*/
+  (getattrofunc)_pyhacstore_getattro, /*tp_getattro*/
+  (setattrofunc)_pyhacstore_setattro, /*tp_setattro*/
+  0,                            /*tp_as_buffer*/
+  Py_TPFLAGS_DEFAULT, /*tp_flags*/
+  _pyhacstore_type_doc,         /*tp_doc*/
+  (traverseproc)0,              /*tp_traverse*/
+  (inquiry)0,                   /*tp_clear*/
+  0,                            /*tp_richcompare*/
+  0,                            /*tp_weaklistoffset*/
+  0,                            /*tp_iter*/
+  0,                            /*tp_iternext*/
+  _pyhacstore_methods,          /*tp_methods*/
+  0,                            /*tp_members*/
+  0,                            /*tp_getset*/
+  0,                            /*tp_base*/
+  0,                            /*tp_dict*/
+  0,                            /*tp_descr_get*/
+  0,                            /*tp_descr_set*/
+  0,                            /*tp_dictoffset*/
+  0,                            /*tp_init*/
+  0,                            /*tp_alloc*/
+  0,                            /*tp_new*/
+  0,                            /*tp_free*/
+  0,                            /*tp_is_gc*/
+};
+/*@} End of HAC store */
+
 static struct PyMethodDef _hac_functions[] =
 {
   { "hacFilter", (PyCFunction) _hacFilter_func, METH_VARARGS,
@@ -170,6 +506,11 @@ static struct PyMethodDef _hac_functions[] =
     "scanobj - a polar scan\n"
     "thresh  - threshold. If difference between DBZH and TH is greater than thresh, then value is truncated to threshold."
   },
+  { "store", (PyCFunction) _pyhacstore_new, METH_VARARGS,
+    "store([flush_interval]) -> HacStoreCore\n\n"
+    "Creates a store that keeps HAC accumulators in memory between scans.\n\n"
+    "flush_interval - seconds between writes of a modified accumulator (default 300)"
+  },
   { NULL, NULL }
 };
 
@@ -188,6 +529,10 @@ MOD_INIT(_odc_hac)
   PyObject* module = NULL;
   PyObject* dictionary = NULL;
 
+  MOD_INIT_SETUP_TYPE(PyHacStore_Type, &PyType_Type);
+
+  MOD_INIT_VERIFY_TYPE_READY(&PyHacStore_Type);
+
   MOD_INIT_DEF(module, "_odc_hac", _hac_module_doc, _hac_functions);
   if (module == NULL) {
     return MOD_INIT_ERROR;
@@ -219,12 +219,12 @@ static PyObject* _pypolarscanparam_getData(PyPolarScanParam* self, PyObject* arg
   PyObject* result = NULL;
   npy_intp dims[2] = {0,0};
   int arrtype = 0;
-  void* data = NULL;
+  const void* data = NULL;
 
   nbins = PolarScanParam_getNbins(self->scanparam);
   nrays = PolarScanParam_getNrays(self->scanparam);
   type = PolarScanParam_getDataType(self->scanparam);
-  data = PolarScanParam_getData(self->scanparam);
+  data = PolarScanParam_getReadOnlyData(self->scanparam);
 
   dims[0] = (npy_intp)nrays;
   dims[1] = (npy_intp)nbins;
@@ -244,7 +244,7 @@ static PyObject* _pypolarscanparam_getData(PyPolarScanParam* self, PyObject* arg
   }
   if (result != NULL) {
     int nbytes = nbins*nrays*((PyArrayObject*)result)->descr->elsize;
-    memcpy(((PyArrayObject*)result)->data, PolarScanParam_getData(self->scanparam), nbytes);
+    memcpy(((PyArrayObject*)result)->data, data, nbytes);
   }
 
   return result;
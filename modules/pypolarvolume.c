@@ -59,6 +59,440 @@ PYRAVE_DEBUG_MODULE("_polarvolume");
  */
 static PyObject *ErrorObject;
 
+/// --------------------------------------------------------------------
+/// Polar Cube
+/// --------------------------------------------------------------------
+/*@{ Polar Cube */
+static PyTypeObject PyPolarCube_Type;
+
+/**
+ * Creates a python polar cube from a native cube.
+ * @param[in] p - the native cube
+ * @returns the python cube
+ */
+static PyPolarCube* PyPolarCube_New(PolarCube_t* p)
+{
+  PyPolarCube* result = NULL;
+
+  result = RAVE_OBJECT_GETBINDING(p);
+  if (result != NULL) {
+    Py_INCREF(result);
+    return result;
+  }
+  result = PyObject_NEW(PyPolarCube, &PyPolarCube_Type);
+  if (result == NULL) {
+    raiseException_returnNULL(PyExc_MemoryError, "Failed to allocate memory for PyPolarCube.");
+  }
+  PYRAVE_DEBUG_OBJECT_CREATED;
+  result->cube = RAVE_OBJECT_COPY(p);
+  RAVE_OBJECT_BIND(result->cube, result);
+  return result;
+}
+
+/**
+ * Deallocates the cube
+ * @param[in] obj the object to deallocate.
+ */
+static void _pypolarcube_dealloc(PyPolarCube* obj)
+{
+  if (obj == NULL) {
+    return;
+  }
+  PYRAVE_DEBUG_OBJECT_DESTROYED;
+  RAVE_OBJECT_UNBIND(obj->cube, obj);
+  RAVE_OBJECT_RELEASE(obj->cube);
+  PyObject_Del(obj);
+}
+
+/**
+ * Creates a numpy array with a copy of the values.
+ * @param[in] nd - number of dimensions
+ * @param[in] dims - the dimensions
+ * @param[in] type - the numpy type
+ * @param[in] data - the data to copy
+ * @param[in] itemsize - the size of each item
+ * @return the array or NULL on failure
+ */
+static PyObject* PyPolarCubeInternal_newArray(int nd, npy_intp* dims, int type, const void* data, size_t itemsize)
+{
+  PyObject* result = PyArray_SimpleNew(nd, dims, type);
+  size_t n = itemsize;
+  int i = 0;
+  if (result == NULL) {
+    return NULL;
+  }
+  for (i = 0; i < nd; i++) {
+    n *= (size_t)dims[i];
+  }
+  if (n > 0) {
+    memcpy(PyArray_DATA((PyArrayObject*)result), data, n);
+  }
+  return result;
+}
+
+/**
+ * Converts a kernel result into a numpy array and releases the field.
+ * @param[in] field - the field (will be released)
+ * @return the array or NULL on failure
+ */
+static PyObject* PyPolarCubeInternal_fieldToArray(RaveData2D_t* field)
+{
+  PyObject* result = NULL;
+  npy_intp dims[2] = {0, 0};
+  if (field == NULL) {
+    raiseException_returnNULL(PyExc_RuntimeError, "Failed to run kernel on cube");
+  }
+  dims[0] = (npy_intp)RaveData2D_getYsize(field);
+  dims[1] = (npy_intp)RaveData2D_getXsize(field);
+  result = PyPolarCubeInternal_newArray(2, dims, PyArray_DOUBLE, RaveData2D_getReadOnlyData(field), sizeof(double));
+  RAVE_OBJECT_RELEASE(field);
+  return result;
+}
+
+/**
+ * Returns the values as a numpy array
+ * @param[in] self - self
+ * @param[in] args - N/A
+ * @return the values
+ */
+static PyObject* _pypolarcube_getValues(PyPolarCube* self, PyObject* args)
+{
+  npy_intp dims[3] = {0, 0, 0};
+  if (!PyArg_ParseTuple(args, "")) {
+    return NULL;
+  }
+  dims[0] = PolarCube_getNumberOfElevations(self->cube);
+  dims[1] = PolarCube_getNrays(self->cube);
+  dims[2] = PolarCube_getNbins(self->cube);
+  return PyPolarCubeInternal_newArray(3, dims, PyArray_DOUBLE, PolarCube_getValues(self->cube), sizeof(double));
+}
+
+/**
+ * Returns the value types as a numpy array
+ * @param[in] self - self
+ * @param[in] args - N/A
+ * @return the types
+ */
+static PyObject* _pypolarcube_getTypes(PyPolarCube* self, PyObject* args)
+{
+  npy_intp dims[3] = {0, 0, 0};
+  if (!PyArg_ParseTuple(args, "")) {
+    return NULL;
+  }
+  dims[0] = PolarCube_getNumberOfElevations(self->cube);
+  dims[1] = PolarCube_getNrays(self->cube);
+  dims[2] = PolarCube_getNbins(self->cube);
+  return PyPolarCubeInternal_newArray(3, dims, PyArray_UBYTE, PolarCube_getTypes(self->cube), sizeof(unsigned char));
+}
+
+/**
+ * Returns the heights or ranges as a numpy array
+ * @param[in] self - self
+ * @param[in] heights - 1 for heights, 0 for ranges
+ * @return the array
+ */
+static PyObject* PyPolarCubeInternal_getGeometry(PyPolarCube* self, int heights)
+{
+  npy_intp dims[2] = {0, 0};
+  double* data = NULL;
+  dims[0] = PolarCube_getNumberOfElevations(self->cube);
+  dims[1] = PolarCube_getNbins(self->cube);
+  if (dims[0] > 0) {
+    data = heights ? PolarCube_getHeights(self->cube, 0) : PolarCube_getRanges(self->cube, 0);
+  }
+  return PyPolarCubeInternal_newArray(2, dims, PyArray_DOUBLE, data, sizeof(double));
+}
+
+/**
+ * Returns the heights as a numpy array
+ * @param[in] self - self
+ * @param[in] args - N/A
+ * @return the heights
+ */
+static PyObject* _pypolarcube_getHeights(PyPolarCube* self, PyObject* args)
+{
+  if (!PyArg_ParseTuple(args, "")) {
+    return NULL;
+  }
+  return PyPolarCubeInternal_getGeometry(self, 1);
+}
+
+/**
+ * Returns the ranges as a numpy array
+ * @param[in] self - self
+ * @param[in] args - N/A
+ * @return the ranges
+ */
+static PyObject* _pypolarcube_getRanges(PyPolarCube* self, PyObject* args)
+{
+  if (!PyArg_ParseTuple(args, "")) {
+    return NULL;
+  }
+  return PyPolarCubeInternal_getGeometry(self, 0);
+}
+
+/**
+ * Returns the value at the specified position
+ * @param[in] self - self
+ * @param[in] args - (ei, ri, bi)
+ * @return a tuple (type, value)
+ */
+static PyObject* _pypolarcube_getValue(PyPolarCube* self, PyObject* args)
+{
+  long ei = 0, ri = 0, bi = 0;
+  double v = 0.0;
+  RaveValueType type = RaveValueType_UNDEFINED;
+  if (!PyArg_ParseTuple(args, "lll", &ei, &ri, &bi)) {
+    return NULL;
+  }
+  type = PolarCube_getValue(self->cube, ei, ri, bi, &v);
+  return Py_BuildValue("(id)", type, v);
+}
+
+/**
+ * Vertical max
+ * @param[in] self - self
+ * @param[in] args - nodata and undetect
+ * @return the result as a numpy array
+ */
+static PyObject* _pypolarcube_max(PyPolarCube* self, PyObject* args)
+{
+  double nodata = 0.0, undetect = 0.0;
+  RaveData2D_t* field = NULL;
+  if (!PyArg_ParseTuple(args, "dd", &nodata, &undetect)) {
+    return NULL;
+  }
+  Py_BEGIN_ALLOW_THREADS
+  field = PolarCube_max(self->cube, nodata, undetect);
+  Py_END_ALLOW_THREADS
+  return PyPolarCubeInternal_fieldToArray(field);
+}
+
+/**
+ * Echo top
+ * @param[in] self - self
+ * @param[in] args - threshold, nodata and undetect
+ * @return the result as a numpy array
+ */
+static PyObject* _pypolarcube_echoTop(PyPolarCube* self, PyObject* args)
+{
+  double threshold = 0.0, nodata = 0.0, undetect = 0.0;
+  RaveData2D_t* field = NULL;
+  if (!PyArg_ParseTuple(args, "ddd", &threshold, &nodata, &undetect)) {
+    return NULL;
+  }
+  Py_BEGIN_ALLOW_THREADS
+  field = PolarCube_echoTop(self->cube, threshold, nodata, undetect);
+  Py_END_ALLOW_THREADS
+  return PyPolarCubeInternal_fieldToArray(field);
+}
+
+/**
+ * Vertically integrated liquid
+ * @param[in] self - self
+ * @param[in] args - nodata and undetect
+ * @return the result as a numpy array
+ */
+static PyObject* _pypolarcube_vil(PyPolarCube* self, PyObject* args)
+{
+  double nodata = 0.0, undetect = 0.0;
+  RaveData2D_t* field = NULL;
+  if (!PyArg_ParseTuple(args, "dd", &nodata, &undetect)) {
+    return NULL;
+  }
+  Py_BEGIN_ALLOW_THREADS
+  field = PolarCube_vil(self->cube, nodata, undetect);
+  Py_END_ALLOW_THREADS
+  return PyPolarCubeInternal_fieldToArray(field);
+}
+
+/**
+ * Lowest valid value
+ * @param[in] self - self
+ * @param[in] args - nodata and undetect
+ * @return a tuple (values, heights) of numpy arrays
+ */
+static PyObject* _pypolarcube_lowest(PyPolarCube* self, PyObject* args)
+{
+  double nodata = 0.0, undetect = 0.0;
+  RaveData2D_t *field = NULL, *heights = NULL;
+  PyObject *pyvalues = NULL, *pyheights = NULL, *result = NULL;
+  if (!PyArg_ParseTuple(args, "dd", &nodata, &undetect)) {
+    return NULL;
+  }
+  Py_BEGIN_ALLOW_THREADS
+  field = PolarCube_lowest(self->cube, nodata, undetect, &heights);
+  Py_END_ALLOW_THREADS
+  if (field == NULL) {
+    RAVE_OBJECT_RELEASE(heights);
+  }
+  pyvalues = PyPolarCubeInternal_fieldToArray(field);
+  if (pyvalues != NULL) {
+    pyheights = PyPolarCubeInternal_fieldToArray(heights);
+    if (pyheights != NULL) {
+      result = Py_BuildValue("(OO)", pyvalues, pyheights);
+    }
+  }
+  Py_XDECREF(pyvalues);
+  Py_XDECREF(pyheights);
+  return result;
+}
+
+/**
+ * All methods a polar cube can have
+ */
+static struct PyMethodDef _pypolarcube_methods[] =
+{
+  {"quantity", NULL, METH_VARARGS},
+  {"nelevations", NULL, METH_VARARGS},
+  {"nrays", NULL, METH_VARARGS},
+  {"nbins", NULL, METH_VARARGS},
+  {"dscale", NULL, METH_VARARGS},
+  {"elangles", NULL, METH_VARARGS},
+  {"getValues", (PyCFunction) _pypolarcube_getValues, 1,
+    "getValues() -> numpy array\n\n"
+    "Returns a copy of the decoded values as a float64 array with shape (nelevations, nrays, nbins)."
+  },
+  {"getTypes", (PyCFunction) _pypolarcube_getTypes, 1,
+    "getTypes() -> numpy array\n\n"
+    "Returns a copy of the value types (_rave.RaveValueType_DATA, _NODATA or _UNDETECT) as an uint8 array with shape (nelevations, nrays, nbins)."
+  },
+  {"getHeights", (PyCFunction) _pypolarcube_getHeights, 1,
+    "getHeights() -> numpy array\n\n"
+    "Returns the height above sea level in meters of every bin as a float64 array with shape (nelevations, nbins)."
+  },
+  {"getRanges", (PyCFunction) _pypolarcube_getRanges, 1,
+    "getRanges() -> numpy array\n\n"
+    "Returns the slant range in meters of every bin as a float64 array with shape (nelevations, nbins)."
+  },
+  {"getValue", (PyCFunction) _pypolarcube_getValue, 1,
+    "getValue(ei, ri, bi) -> (type, value)\n\n"
+    "Returns the value type and decoded value at the specified elevation, ray and bin index."
+  },
+  {"max", (PyCFunction) _pypolarcube_max, 1,
+    "max(nodata, undetect) -> numpy array\n\n"
+    "Returns the maximum value in each column as a float64 array with shape (nrays, nbins). Columns with only undetect get undetect and columns without\n"
+    "data or undetect get nodata."
+  },
+  {"echoTop", (PyCFunction) _pypolarcube_echoTop, 1,
+    "echoTop(threshold, nodata, undetect) -> numpy array\n\n"
+    "Returns the height above sea level of the highest bin in each column with a value >= threshold as a float64 array with shape (nrays, nbins).\n"
+    "Columns that never reach the threshold get undetect if they have any data or undetect, otherwise nodata."
+  },
+  {"vil", (PyCFunction) _pypolarcube_vil, 1,
+    "vil(nodata, undetect) -> numpy array\n\n"
+    "Returns the vertically integrated liquid water content in kg/m2 for each column as a float64 array with shape (nrays, nbins).\n"
+    "The cube must contain reflectivity in dBZ."
+  },
+  {"lowest", (PyCFunction) _pypolarcube_lowest, 1,
+    "lowest(nodata, undetect) -> (values, heights)\n\n"
+    "Returns the value from the lowest elevation that is not nodata in each column and the height above sea level of that bin\n"
+    "as two float64 arrays with shape (nrays, nbins)."
+  },
+  {NULL, NULL } /* sentinel */
+};
+
+/**
+ * Returns the specified attribute in the cube
+ */
+static PyObject* _pypolarcube_getattro(PyPolarCube* self, PyObject* name)
+{
+  if (PY_COMPARE_STRING_WITH_ATTRO_NAME("quantity", name) == 0) {
+    if (PolarCube_getQuantity(self->cube) != NULL) {
+      return PyString_FromString(PolarCube_getQuantity(self->cube));
+    }
+    Py_RETURN_NONE;
+  } else if (PY_COMPARE_STRING_WITH_ATTRO_NAME("nelevations", name) == 0) {
+    return PyInt_FromLong(PolarCube_getNumberOfElevations(self->cube));
+  } else if (PY_COMPARE_STRING_WITH_ATTRO_NAME("nrays", name) == 0) {
+    return PyInt_FromLong(PolarCube_getNrays(self->cube));
+  } else if (PY_COMPARE_STRING_WITH_ATTRO_NAME("nbins", name) == 0) {
+    return PyInt_FromLong(PolarCube_getNbins(self->cube));
+  } else if (PY_COMPARE_STRING_WITH_ATTRO_NAME("dscale", name) == 0) {
+    return PyFloat_FromDouble(PolarCube_getDscale(self->cube));
+  } else if (PY_COMPARE_STRING_WITH_ATTRO_NAME("elangles", name) == 0) {
+    long n = PolarCube_getNumberOfElevations(self->cube), i = 0;
+    PyObject* result = PyTuple_New(n);
+    if (result == NULL) {
+      return NULL;
+    }
+    for (i = 0; i < n; i++) {
+      PyTuple_SetItem(result, i, PyFloat_FromDouble(PolarCube_getElangle(self->cube, i)));
+    }
+    return result;
+  }
+  return PyObject_GenericGetAttr((PyObject*)self, name);
+}
+
+/**
+ * The cube is read only
+ */
+static int _pypolarcube_setattro(PyPolarCube* self, PyObject* name, PyObject* val)
+{
+  if (name != NULL) {
+    PyErr_SetString(PyExc_AttributeError, PY_RAVE_ATTRO_NAME_TO_STRING(name));
+  }
+  return -1;
+}
+
+PyDoc_STRVAR(_pypolarcube_type_doc,
+    "The decoded values of one quantity in a polar volume as a contiguous elevation x ray x bin cube. All scans are resampled onto\n"
+    "the same rays and onto bins at the same surface distance so that (ray, bin) is the same vertical column in every elevation.\n"
+    "The elevations are in ascending order. Created with PolarVolumeCore.getCube.\n\n"
+    " quantity    - the quantity (read only)\n"
+    " nelevations - number of elevations (read only)\n"
+    " nrays       - number of rays (read only)\n"
+    " nbins       - number of bins (read only)\n"
+    " dscale      - surface distance between two bins in meters, bin b is centered at (b + 0.5) * dscale (read only)\n"
+    " elangles    - tuple with the elevation angles in radians (read only)\n"
+    );
+
+static PyTypeObject PyPolarCube_Type =
+{
+  PyVarObject_HEAD_INIT(NULL, 0) /*ob_size*/
+  "PolarCubeCore", /*tp_name*/
+  sizeof(PyPolarCube), /*tp_size*/
+  0, /*tp_itemsize*/
+  /* methods */
+  (destructor)_pypolarcube_dealloc, /*tp_dealloc*/
+  0, /*tp_print*/
+  (getattrfunc)0,               /*tp_getattr*/
+  (setattrfunc)0,               /*tp_setattr*/
+  0,                            /*tp_compare*/
+  0,                            /*tp_repr*/
+  0,                            /*tp_as_number */
+  0,
+  0,                            /*tp_as_mapping */
+  0,                            /*tp_hash*/
+  (ternaryfunc)0,               /*tp_call*/
+  (reprfunc)0,                  /*tp_str*/
+  (getattrofunc)_pypolarcube_getattro, /*tp_getattro*/
+  (setattrofunc)_pypolarcube_setattro, /*tp_setattro*/
+  0,                            /*tp_as_buffer*/
+  Py_TPFLAGS_DEFAULT, /*tp_flags*/
+  _pypolarcube_type_doc, /*tp_doc*/
+  (traverseproc)0,              /*tp_traverse*/
+  (inquiry)0,                   /*tp_clear*/
+  0,                            /*tp_richcompare*/
+  0,                            /*tp_weaklistoffset*/
+  0,                            /*tp_iter*/
+  0,                            /*tp_iternext*/
+  _pypolarcube_methods,         /*tp_methods*/
+  0,                            /*tp_members*/
+  0,                            /*tp_getset*/
+  0,                            /*tp_base*/
+  0,                            /*tp_dict*/
+  0,                            /*tp_descr_get*/
+  0,                            /*tp_descr_set*/
+  0,                            /*tp_dictoffset*/
+  0,                            /*tp_init*/
+  0,                            /*tp_alloc*/
+  0,                            /*tp_new*/
+  0,                            /*tp_free*/
+  0,                            /*tp_is_gc*/
+};
+/*@} End of Polar Cube */
+
 /// --------------------------------------------------------------------
 /// Polar Volumes
 /// --------------------------------------------------------------------
@@ -429,6 +863,95 @@ static PyObject* _pypolarvolume_getNearestConvertedParameterValue(PyPolarVolume*
   return Py_BuildValue("(id)", vtype, v);
 }
 
+/**
+ * Gets the nearest converted parameter values and quality values for a number of lon/lat positions.
+ * @param[in] self - the polar volume
+ * @param[in] args - quantity, longitudes, latitudes (in radians), the height, insidee and optionally the quality field name
+ * @return a tuple (values, types, qualities) of numpy arrays
+ */
+static PyObject* _pypolarvolume_getNearestValuesAtLonLats(PyPolarVolume* self, PyObject* args)
+{
+  PyObject *pylon = NULL, *pylat = NULL;
+  PyArrayObject *lonarr = NULL, *latarr = NULL;
+  PyObject *values = NULL, *types = NULL, *qualities = NULL, *result = NULL;
+  RaveValueType* vtypes = NULL;
+  char* quantity = NULL;
+  char* qualityname = NULL;
+  double height = 0.0;
+  int insidee = 0;
+  npy_intp dims[1] = {0};
+  npy_intp i = 0;
+  int ok = 0;
+
+  if (!PyArg_ParseTuple(args, "sOOdi|z", &quantity, &pylon, &pylat, &height, &insidee, &qualityname)) {
+    return NULL;
+  }
+  lonarr = (PyArrayObject*)PyArray_ContiguousFromObject(pylon, PyArray_DOUBLE, 1, 1);
+  latarr = (PyArrayObject*)PyArray_ContiguousFromObject(pylat, PyArray_DOUBLE, 1, 1);
+  if (lonarr == NULL || latarr == NULL) {
+    raiseException_gotoTag(done, PyExc_TypeError, "longitudes and latitudes must be 1-dimensional sequences of numbers");
+  }
+  if (PyArray_DIM(lonarr, 0) != PyArray_DIM(latarr, 0)) {
+    raiseException_gotoTag(done, PyExc_ValueError, "longitudes and latitudes must have the same length");
+  }
+  dims[0] = PyArray_DIM(lonarr, 0);
+  values = PyArray_SimpleNew(1, dims, PyArray_DOUBLE);
+  types = PyArray_SimpleNew(1, dims, PyArray_INT);
+  qualities = PyArray_SimpleNew(1, dims, PyArray_DOUBLE);
+  vtypes = RAVE_MALLOC(sizeof(RaveValueType) * (dims[0] > 0 ? dims[0] : 1));
+  if (values == NULL || types == NULL || qualities == NULL || vtypes == NULL) {
+    raiseException_gotoTag(done, PyExc_MemoryError, "Failed to allocate memory for result");
+  }
+
+  Py_BEGIN_ALLOW_THREADS
+  ok = PolarVolume_getNearestValuesAtLonLats(self->pvol, quantity, (long)dims[0], (double*)PyArray_DATA(lonarr), (double*)PyArray_DATA(latarr),
+                                             height, insidee, (double*)PyArray_DATA((PyArrayObject*)values), vtypes, qualityname,
+                                             (double*)PyArray_DATA((PyArrayObject*)qualities));
+  Py_END_ALLOW_THREADS
+  if (!ok) {
+    raiseException_gotoTag(done, PyExc_MemoryError, "Failed to get values");
+  }
+  for (i = 0; i < dims[0]; i++) {
+    *((int*) PyArray_GETPTR1((PyArrayObject*)types, i)) = (int)vtypes[i];
+  }
+  result = Py_BuildValue("(OOO)", values, types, qualities);
+done:
+  Py_XDECREF(lonarr);
+  Py_XDECREF(latarr);
+  Py_XDECREF(values);
+  Py_XDECREF(types);
+  Py_XDECREF(qualities);
+  RAVE_FREE(vtypes);
+  return result;
+}
+
+/**
+ * Creates a cube with the values of a quantity.
+ * @param[in] self - the polar volume
+ * @param[in] args - quantity and optionally nrays and nbins
+ * @return the cube
+ */
+static PyObject* _pypolarvolume_getCube(PyPolarVolume* self, PyObject* args)
+{
+  char* quantity = NULL;
+  long nrays = 0, nbins = 0;
+  PolarCube_t* cube = NULL;
+  PyObject* result = NULL;
+
+  if (!PyArg_ParseTuple(args, "s|ll", &quantity, &nrays, &nbins)) {
+    return NULL;
+  }
+  Py_BEGIN_ALLOW_THREADS
+  cube = PolarVolume_getCube(self->pvol, quantity, nrays, nbins);
+  Py_END_ALLOW_THREADS
+  if (cube == NULL) {
+    raiseException_returnNULL(PyExc_ValueError, "Failed to create cube, does the quantity exist?");
+  }
+  result = (PyObject*)PyPolarCube_New(cube);
+  RAVE_OBJECT_RELEASE(cube);
+  return result;
+}
+
 /**
  * Gets the vertical max value for the specified lon/lat coordinate.
  * @param[in] self - the polar volume
@@ -849,6 +1372,26 @@ static struct PyMethodDef _pypolarvolume_methods[] =
     "height   - height above sea level\n"
     "inside   - if elevation must be within min-max elevation or not"
   },
+  {"getNearestValuesAtLonLats", (PyCFunction) _pypolarvolume_getNearestValuesAtLonLats, 1,
+    "getNearestValuesAtLonLats(quantity, lons, lats, height, insidee[, qualityfield]) -> (values, types, qualities)\n\n"
+    "Gets the nearest converted values (offset+v*gain) for a number of lon/lat positions at the same height as numpy arrays.\n"
+    "Same as calling getNearestConvertedParameterValue for each position but the parameter and quality lookups are only done once per scan.\n\n"
+    "quantity     - the parameter of interest\n"
+    "lons         - sequence of longitudes in radians\n"
+    "lats         - sequence of latitudes in radians\n"
+    "height       - height above sea level\n"
+    "insidee      - if elevation must be within min-max elevation or not\n"
+    "qualityfield - how/task of the quality field. If not given or not found, all qualities are NaN.\n"
+    "Returns a tuple with the values (float64), value types (int32) and quality values (float64, NaN when missing)."
+  },
+  {"getCube", (PyCFunction)_pypolarvolume_getCube, 1,
+    "getCube(quantity[, nrays, nbins]) -> polar cube\n\n"
+    "Resamples all scans that have the quantity onto a contiguous elevation x ray x bin cube with decoded values, see PolarCubeCore.\n"
+    "Ray i is at azimuth i*360/nrays and the bins are at the same surface distance in all elevations. Nearest neighbour is used.\n\n"
+    "quantity - the parameter of interest\n"
+    "nrays    - number of rays in the cube. Default (0) is the largest number of rays in the scans\n"
+    "nbins    - number of bins in the cube. Default (0) is the largest number of bins in the scans"
+  },
   {"getConvertedVerticalMaxValue", (PyCFunction)_pypolarvolume_getConvertedVerticalMaxValue, 1,
     "getConvertedVerticalMaxValue(quantity, (lon,lat)) -> (type,value)\n\n"
     "Gets the vertical converted maximum value (offset+v*gain) at the specified lon/lat for the specified quantity.\n\n"
@@ -1178,8 +1721,10 @@ MOD_INIT(_polarvolume)
   PyObject *c_api_object = NULL;
 
   MOD_INIT_SETUP_TYPE(PyPolarVolume_Type, &PyType_Type);
+  MOD_INIT_SETUP_TYPE(PyPolarCube_Type, &PyType_Type);
 
   MOD_INIT_VERIFY_TYPE_READY(&PyPolarVolume_Type);
+  MOD_INIT_VERIFY_TYPE_READY(&PyPolarCube_Type);
   MOD_INIT_DEF(module, "_polarvolume", _pypolarvolume_type_doc, functions);
   if (module == NULL) {
     return MOD_INIT_ERROR;
@@ -34,6 +34,14 @@ typedef struct {
    PolarVolume_t* pvol;  /**< the polar volume */
 } PyPolarVolume;
 
+/**
+ * A cube with the values of one quantity in a polar volume
+ */
+typedef struct {
+   PyObject_HEAD /*Always have to be on top*/
+   PolarCube_t* cube;  /**< the cube */
+} PyPolarCube;
+
 #define PyPolarVolume_Type_NUM 0                              /**< index of type */
 
 #define PyPolarVolume_GetNative_NUM 1                         /**< index of GetNative*/
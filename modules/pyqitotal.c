@@ -152,6 +152,7 @@ static PyObject* _pyqitotal_operator_func(PyQITotal* self, PyObject* args, RaveF
   RaveField_t* result = NULL;
   Py_ssize_t n = 0, i = 0;
   RaveObjectList_t* fields = NULL;
+  RaveQITotal_t* qitotal = NULL;
 
   if (!PyArg_ParseTuple(args, "O", &pyfields)) {
     return NULL;
@@ -177,7 +178,11 @@ static PyObject* _pyqitotal_operator_func(PyQITotal* self, PyObject* args, RaveF
     Py_XDECREF(v);
   }
 
-  result = opfunc(self->qitotal, fields);
+  qitotal = RAVE_OBJECT_COPY(self->qitotal);
+  Py_BEGIN_ALLOW_THREADS
+  result = opfunc(qitotal, fields);
+  Py_END_ALLOW_THREADS
+  RAVE_OBJECT_RELEASE(qitotal);
   if (!result) {
     raiseException_gotoTag(done, PyExc_AttributeError, "Failed to generate qi total");
   }
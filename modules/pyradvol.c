@@ -199,9 +199,17 @@ static PyObject* _radvolatt_func(PyObject* self, PyObject* args) {
   mapParams(params, &rpars);
 
   if (PyPolarVolume_Check(object)) {
-    ret = RadvolAtt_attCorrection_pvol(pyvolume->pvol, &rpars, NULL);
+    PolarVolume_t* pvol = RAVE_OBJECT_COPY(pyvolume->pvol);
+    Py_BEGIN_ALLOW_THREADS
+    ret = RadvolAtt_attCorrection_pvol(pvol, &rpars, NULL);
+    Py_END_ALLOW_THREADS
+    RAVE_OBJECT_RELEASE(pvol);
   } else {
-    ret = RadvolAtt_attCorrection_scan(pyscan->scan, &rpars, NULL);
+    PolarScan_t* scan = RAVE_OBJECT_COPY(pyscan->scan);
+    Py_BEGIN_ALLOW_THREADS
+    ret = RadvolAtt_attCorrection_scan(scan, &rpars, NULL);
+    Py_END_ALLOW_THREADS
+    RAVE_OBJECT_RELEASE(scan);
   }
 
   if (ret) {
@@ -241,9 +249,17 @@ static PyObject* _radvolbroad_func(PyObject* self, PyObject* args) {
   mapParams(params, &rpars);
 
   if (PyPolarVolume_Check(object)) {
-    ret = RadvolBroad_broadAssessment_pvol(pyvolume->pvol, &rpars, NULL);
+    PolarVolume_t* pvol = RAVE_OBJECT_COPY(pyvolume->pvol);
+    Py_BEGIN_ALLOW_THREADS
+    ret = RadvolBroad_broadAssessment_pvol(pvol, &rpars, NULL);
+    Py_END_ALLOW_THREADS
+    RAVE_OBJECT_RELEASE(pvol);
   } else {
-    ret = RadvolBroad_broadAssessment_scan(pyscan->scan, &rpars, NULL);
+    PolarScan_t* scan = RAVE_OBJECT_COPY(pyscan->scan);
+    Py_BEGIN_ALLOW_THREADS
+    ret = RadvolBroad_broadAssessment_scan(scan, &rpars, NULL);
+    Py_END_ALLOW_THREADS
+    RAVE_OBJECT_RELEASE(scan);
   }
 
   if (ret) {
@@ -282,9 +298,17 @@ static PyObject* _radvolnmet_func(PyObject* self, PyObject* args) {
   mapParams(params, &rpars);
 
   if (PyPolarVolume_Check(object)) {
-    ret = RadvolNmet_nmetRemoval_pvol(pyvolume->pvol, &rpars, NULL);
+    PolarVolume_t* pvol = RAVE_OBJECT_COPY(pyvolume->pvol);
+    Py_BEGIN_ALLOW_THREADS
+    ret = RadvolNmet_nmetRemoval_pvol(pvol, &rpars, NULL);
+    Py_END_ALLOW_THREADS
+    RAVE_OBJECT_RELEASE(pvol);
   } else {
-    ret = RadvolNmet_nmetRemoval_scan(pyscan->scan, &rpars, NULL);
+    PolarScan_t* scan = RAVE_OBJECT_COPY(pyscan->scan);
+    Py_BEGIN_ALLOW_THREADS
+    ret = RadvolNmet_nmetRemoval_scan(scan, &rpars, NULL);
+    Py_END_ALLOW_THREADS
+    RAVE_OBJECT_RELEASE(scan);
   }
 
   if (ret) {
@@ -323,9 +347,17 @@ static PyObject* _radvolspeck_func(PyObject* self, PyObject* args) {
   mapParams(params, &rpars);
 
   if (PyPolarVolume_Check(object)) {
-    ret = RadvolSpeck_speckRemoval_pvol(pyvolume->pvol, &rpars, NULL);
+    PolarVolume_t* pvol = RAVE_OBJECT_COPY(pyvolume->pvol);
+    Py_BEGIN_ALLOW_THREADS
+    ret = RadvolSpeck_speckRemoval_pvol(pvol, &rpars, NULL);
+    Py_END_ALLOW_THREADS
+    RAVE_OBJECT_RELEASE(pvol);
   } else {
-    ret = RadvolSpeck_speckRemoval_scan(pyscan->scan, &rpars, NULL);
+    PolarScan_t* scan = RAVE_OBJECT_COPY(pyscan->scan);
+    Py_BEGIN_ALLOW_THREADS
+    ret = RadvolSpeck_speckRemoval_scan(scan, &rpars, NULL);
+    Py_END_ALLOW_THREADS
+    RAVE_OBJECT_RELEASE(scan);
   }
 
   if (ret) {
@@ -365,9 +397,17 @@ static PyObject* _radvolspike_func(PyObject* self, PyObject* args) {
   mapParams(params, &rpars);
 
   if (PyPolarVolume_Check(object)) {
-    ret = RadvolSpike_spikeRemoval_pvol(pyvolume->pvol, &rpars, NULL);
+    PolarVolume_t* pvol = RAVE_OBJECT_COPY(pyvolume->pvol);
+    Py_BEGIN_ALLOW_THREADS
+    ret = RadvolSpike_spikeRemoval_pvol(pvol, &rpars, NULL);
+    Py_END_ALLOW_THREADS
+    RAVE_OBJECT_RELEASE(pvol);
   } else {
-    ret = RadvolSpike_spikeRemoval_scan(pyscan->scan, &rpars, NULL);
+    PolarScan_t* scan = RAVE_OBJECT_COPY(pyscan->scan);
+    Py_BEGIN_ALLOW_THREADS
+    ret = RadvolSpike_spikeRemoval_scan(scan, &rpars, NULL);
+    Py_END_ALLOW_THREADS
+    RAVE_OBJECT_RELEASE(scan);
   }
 
   if (ret) {
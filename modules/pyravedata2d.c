@@ -153,6 +153,40 @@ static PyObject* _pyravedata2d_new(PyObject* self, PyObject* args)
   return (PyObject*)result;
 }
 
+/**
+ * Returns the number of bytes that have been allocated for data arrays
+ * @param[in] self this instance.
+ * @param[in] args - not used
+ * @return the number of bytes
+ */
+static PyObject* _pyravedata2d_materializedBytes(PyObject* self, PyObject* args)
+{
+  return PyLong_FromLong(RaveData2D_getMaterializedBytes());
+}
+
+/**
+ * Returns the number of bytes that clones have shared instead of copying
+ * @param[in] self this instance.
+ * @param[in] args - not used
+ * @return the number of bytes
+ */
+static PyObject* _pyravedata2d_sharedBytes(PyObject* self, PyObject* args)
+{
+  return PyLong_FromLong(RaveData2D_getSharedBytes());
+}
+
+/**
+ * Resets the byte counters
+ * @param[in] self this instance.
+ * @param[in] args - not used
+ * @return None
+ */
+static PyObject* _pyravedata2d_resetStatistics(PyObject* self, PyObject* args)
+{
+  RaveData2D_resetStatistics();
+  Py_RETURN_NONE;
+}
+
 /**
  * Sets the data
  * @param[in] self this instance.
@@ -206,12 +240,12 @@ static PyObject* _pyravedata2d_getData(PyRaveData2D* self, PyObject* args)
   PyObject* result = NULL;
   npy_intp dims[2] = {0,0};
   int arrtype = 0;
-  void* data = NULL;
+  const void* data = NULL;
 
   xsize = RaveData2D_getXsize(self->field);
   ysize = RaveData2D_getYsize(self->field);
   type = RaveData2D_getType(self->field);
-  data = RaveData2D_getData(self->field);
+  data = RaveData2D_getReadOnlyData(self->field);
 
   dims[1] = (npy_intp)xsize;
   dims[0] = (npy_intp)ysize;
@@ -230,7 +264,7 @@ static PyObject* _pyravedata2d_getData(PyRaveData2D* self, PyObject* args)
   }
   if (result != NULL) {
     int nbytes = xsize*ysize*PyArray_ITEMSIZE(result);
-    memcpy(((PyArrayObject*)result)->data, (unsigned char*)RaveData2D_getData(self->field), nbytes);
+    memcpy(((PyArrayObject*)result)->data, data, nbytes);
   }
   return result;
 }
@@ -524,6 +558,44 @@ done:
   return result;
 }
 
+static PyObject* _pyravedata2d_boxmean(PyRaveData2D* self, PyObject* args)
+{
+  PyObject* result = NULL;
+  RaveData2D_t* field = NULL;
+  long nx = 0, ny = 0;
+  if (!PyArg_ParseTuple(args, "ll", &nx, &ny)) {
+    return NULL;
+  }
+
+  field = RaveData2D_boxmean(self->field, nx, ny);
+  if (field == NULL) {
+    raiseException_gotoTag(done, PyExc_RuntimeError, "Failed to generate boxmean field");
+  }
+  result = (PyObject*)PyRaveData2D_New(field);
+done:
+  RAVE_OBJECT_RELEASE(field);
+  return result;
+}
+
+static PyObject* _pyravedata2d_boxstd(PyRaveData2D* self, PyObject* args)
+{
+  PyObject* result = NULL;
+  RaveData2D_t* field = NULL;
+  long nx = 0, ny = 0;
+  if (!PyArg_ParseTuple(args, "ll", &nx, &ny)) {
+    return NULL;
+  }
+
+  field = RaveData2D_boxstd(self->field, nx, ny);
+  if (field == NULL) {
+    raiseException_gotoTag(done, PyExc_RuntimeError, "Failed to generate boxstd field");
+  }
+  result = (PyObject*)PyRaveData2D_New(field);
+done:
+  RAVE_OBJECT_RELEASE(field);
+  return result;
+}
+
 static PyObject* _pyravedata2d_hist(PyRaveData2D* self, PyObject* args)
 {
   long* hist = NULL;
@@ -578,6 +650,7 @@ static struct PyMethodDef _pyravedata2d_methods[] =
   {"datatype", NULL, METH_VARARGS},
   {"nodata", NULL, METH_VARARGS},
   {"useNodata", NULL, METH_VARARGS},
+  {"shared", NULL, METH_VARARGS},
   {"setData", (PyCFunction) _pyravedata2d_setData, 1,
     "setData(numpyarray)\n\n"
     "Initializes the data with the numpy array\n\n"
@@ -668,6 +741,20 @@ static struct PyMethodDef _pyravedata2d_methods[] =
     "nx  - number of pixels in x-dim\n"
     "ny  - number of pixels in y-dim"
   },
+  {"boxmean", (PyCFunction) _pyravedata2d_boxmean, 1,
+    "boxmean(nx,ny) -> rave data 2d\n\n"
+    "Computes the mean in the box x +/- nx, y +/- ny around every pixel. The box is clipped at the borders and if useNodata is set, nodata values are excluded.\n"
+    "Pixels without any values in the box gets nodata. The cost does not depend on the box size.\n\n"
+    "nx  - number of pixels on each side in x-dim\n"
+    "ny  - number of pixels on each side in y-dim"
+  },
+  {"boxstd", (PyCFunction) _pyravedata2d_boxstd, 1,
+    "boxstd(nx,ny) -> rave data 2d\n\n"
+    "Computes the (population) standard deviation in the box x +/- nx, y +/- ny around every pixel. The box is clipped at the borders and if useNodata is set, nodata values are excluded.\n"
+    "Pixels without any values in the box gets nodata. The cost does not depend on the box size.\n\n"
+    "nx  - number of pixels on each side in x-dim\n"
+    "ny  - number of pixels on each side in y-dim"
+  },
   {"hist", (PyCFunction) _pyravedata2d_hist, 1,
     "hist(nbins) -> list of counts\n\n"
     "Creates a histogram of field with bins number of bins. The histogram will be determined as\n"
@@ -719,6 +806,8 @@ static PyObject* _pyravedata2d_getattro(PyRaveData2D* self, PyObject* name)
     return PyFloat_FromDouble(RaveData2D_getNodata(self->field));
   } else if (PY_COMPARE_ATTRO_NAME_WITH_STRING(name, "useNodata") == 0) {
     return PyBool_FromLong(RaveData2D_usingNodata(self->field));
+  } else if (PY_COMPARE_ATTRO_NAME_WITH_STRING(name, "shared") == 0) {
+    return PyBool_FromLong(RaveData2D_isShared(self->field));
   }
 
   return PyObject_GenericGetAttr((PyObject*)self, name);
@@ -836,6 +925,19 @@ static PyMethodDef functions[] = {
     "a = _ravedata2d.new()\n"
     "a.setData(numpyarray)"
   },
+  {"materializedBytes", (PyCFunction)_pyravedata2d_materializedBytes, 1,
+    "materializedBytes() -> long\n\n"
+    "Returns the number of bytes that have been allocated for data arrays, either when data has been created or\n"
+    "when a data array shared by clones has been copied before being modified."
+  },
+  {"sharedBytes", (PyCFunction)_pyravedata2d_sharedBytes, 1,
+    "sharedBytes() -> long\n\n"
+    "Returns the number of bytes that clones have shared instead of copying."
+  },
+  {"resetStatistics", (PyCFunction)_pyravedata2d_resetStatistics, 1,
+    "resetStatistics()\n\n"
+    "Resets the materialized and shared byte counters."
+  },
   {NULL,NULL} /*Sentinel*/
 };
 
@@ -195,12 +195,12 @@ static PyObject* _pyravefield_getData(PyRaveField* self, PyObject* args)
   PyObject* result = NULL;
   npy_intp dims[2] = {0,0};
   int arrtype = 0;
-  void* data = NULL;
+  const void* data = NULL;
 
   xsize = RaveField_getXsize(self->field);
   ysize = RaveField_getYsize(self->field);
   type = RaveField_getDataType(self->field);
-  data = RaveField_getData(self->field);
+  data = RaveField_getReadOnlyData(self->field);
 
   dims[1] = (npy_intp)xsize;
   dims[0] = (npy_intp)ysize;
@@ -219,7 +219,7 @@ static PyObject* _pyravefield_getData(PyRaveField* self, PyObject* args)
   }
   if (result != NULL) {
     int nbytes = xsize*ysize*PyArray_ITEMSIZE(result);
-    memcpy(((PyArrayObject*)result)->data, (unsigned char*)RaveField_getData(self->field), nbytes);
+    memcpy(((PyArrayObject*)result)->data, data, nbytes);
   }
   return result;
 }
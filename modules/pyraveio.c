@@ -31,6 +31,10 @@ along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
 #define PYRAVEIO_MODULE   /**< include correct part of pyraveio.h */
 #include "pyraveio.h"
 
+#ifdef RAVE_BUFR_SUPPORTED
+#include "rave_bufr_io.h"
+#endif
+
 #include "pycartesian.h"
 #include "pypolarvolume.h"
 #include "pypolarscan.h"
@@ -135,7 +139,9 @@ PyRaveIO_Open(const char* filename, int lazyLoading, const char* preloadQuantiti
     raiseException_returnNULL(PyExc_ValueError, "providing a filename that is NULL");
   }
 
+  Py_BEGIN_ALLOW_THREADS
   raveio = RaveIO_open(filename, lazyLoading, preloadQuantities);
+  Py_END_ALLOW_THREADS
   if (raveio == NULL) {
     raiseException_gotoTag(done, PyExc_IOError, "Failed to open file");
   }
@@ -194,6 +200,39 @@ static PyObject* _pyraveio_open(PyObject* self, PyObject* args)
   return (PyObject*)result;
 }
 
+/**
+ * Opens the content of a file that is supported by raveio from a memory buffer
+ * @param[in] self this instance.
+ * @param[in] args arguments for creation (the file content as bytes)
+ * @return the object on success, otherwise NULL
+ */
+static PyObject* _pyraveio_openFromMemory(PyObject* self, PyObject* args)
+{
+  PyRaveIO* result = NULL;
+  RaveIO_t* raveio = NULL;
+  Py_buffer content;
+  int lazyLoading = 0;
+  char* preloadQuantities = NULL;
+
+  if (!PyArg_ParseTuple(args, "s*|iz", &content, &lazyLoading, &preloadQuantities)) {
+    return NULL;
+  }
+
+  Py_BEGIN_ALLOW_THREADS
+  raveio = RaveIO_openFromMemory(content.buf, (size_t)content.len, lazyLoading, preloadQuantities);
+  Py_END_ALLOW_THREADS
+  PyBuffer_Release(&content);
+
+  if (raveio == NULL) {
+    raiseException_gotoTag(done, PyExc_IOError, "Failed to open file from memory");
+  }
+  result = PyRaveIO_New(raveio);
+
+done:
+  RAVE_OBJECT_RELEASE(raveio);
+  return (PyObject*)result;
+}
+
 /**
  * Returns if the raveio supports the requested file format.
  * @param[in] self - self
@@ -212,6 +251,49 @@ static PyObject* _pyraveio_supports(PyObject* self, PyObject* args)
   return PyBool_FromLong(RaveIO_supports(format));
 }
 
+/**
+ * Configures worker processes used when reading BUFR files.
+ * @param[in] self - N/A
+ * @param[in] args - the worker program (or None) and the max number of concurrent workers
+ * @return Py_None on success, otherwise NULL
+ */
+static PyObject* _pyraveio_setBufrWorkers(PyObject* self, PyObject* args)
+{
+  char* program = NULL;
+  int maxworkers = 0;
+  if (!PyArg_ParseTuple(args, "zi", &program, &maxworkers)) {
+    return NULL;
+  }
+#ifdef RAVE_BUFR_SUPPORTED
+  if (!RaveBufrIO_setWorkers(program, maxworkers)) {
+    raiseException_returnNULL(PyExc_MemoryError, "Failed to set BUFR workers");
+  }
+#else
+  if (program != NULL && maxworkers > 0) {
+    raiseException_returnNULL(PyExc_NotImplementedError, "Not built with BUFR support");
+  }
+#endif
+  Py_RETURN_NONE;
+}
+
+/**
+ * Returns the max number of concurrent BUFR worker processes.
+ * @param[in] self - N/A
+ * @param[in] args - N/A
+ * @return the number of workers, 0 if not used
+ */
+static PyObject* _pyraveio_getBufrWorkers(PyObject* self, PyObject* args)
+{
+  if (!PyArg_ParseTuple(args, "")) {
+    return NULL;
+  }
+#ifdef RAVE_BUFR_SUPPORTED
+  return PyInt_FromLong(RaveBufrIO_getMaxWorkers());
+#else
+  return PyInt_FromLong(0);
+#endif
+}
+
 /**
  * Closes the currently open nodelist.
  * @param[in] self - this instance
@@ -234,11 +316,19 @@ static PyObject* _pyraveio_load(PyRaveIO* self, PyObject* args)
 {
   int lazyLoading = 0;
   char* preloadQuantities = NULL;
+  RaveIO_t* raveio = NULL;
+  int result = 0;
   if (!PyArg_ParseTuple(args, "|iz", &lazyLoading, &preloadQuantities)) {
     return NULL;
   }
 
-  if (!RaveIO_load(self->raveio, lazyLoading, preloadQuantities)) {
+  raveio = RAVE_OBJECT_COPY(self->raveio);
+  Py_BEGIN_ALLOW_THREADS
+  result = RaveIO_load(raveio, lazyLoading, preloadQuantities);
+  Py_END_ALLOW_THREADS
+  RAVE_OBJECT_RELEASE(raveio);
+
+  if (!result) {
     raiseException_returnNULL(PyExc_IOError, "Failed to load file");
   }
   Py_RETURN_NONE;
@@ -253,17 +343,57 @@ static PyObject* _pyraveio_load(PyRaveIO* self, PyObject* args)
 static PyObject* _pyraveio_save(PyRaveIO* self, PyObject* args)
 {
   char* filename = NULL;
+  RaveIO_t* raveio = NULL;
+  int result = 0;
   if (!PyArg_ParseTuple(args, "|s", &filename)) {
     return NULL;
   }
 
-  if (!RaveIO_save(self->raveio, filename)) {
+  raveio = RAVE_OBJECT_COPY(self->raveio);
+  Py_BEGIN_ALLOW_THREADS
+  result = RaveIO_save(raveio, filename);
+  Py_END_ALLOW_THREADS
+  RAVE_OBJECT_RELEASE(raveio);
+
+  if (!result) {
     raiseException_returnNULL(PyExc_IOError, "Failed to save file");
   }
 
   Py_RETURN_NONE;
 }
 
+/**
+ * Saves the object into a memory buffer.
+ * @param[in] self - this instance
+ * @param[in] args - N/A
+ * @returns the file content as bytes on success, otherwise NULL
+ */
+static PyObject* _pyraveio_saveToMemory(PyRaveIO* self, PyObject* args)
+{
+  RaveIO_t* raveio = NULL;
+  PyObject* pyresult = NULL;
+  void* buffer = NULL;
+  size_t size = 0;
+  int result = 0;
+
+  if (!PyArg_ParseTuple(args, "")) {
+    return NULL;
+  }
+
+  raveio = RAVE_OBJECT_COPY(self->raveio);
+  Py_BEGIN_ALLOW_THREADS
+  result = RaveIO_saveToMemory(raveio, &buffer, &size);
+  Py_END_ALLOW_THREADS
+  RAVE_OBJECT_RELEASE(raveio);
+
+  if (!result) {
+    raiseException_returnNULL(PyExc_IOError, "Failed to save file to memory");
+  }
+  pyresult = PyBytes_FromStringAndSize((const char*)buffer, (Py_ssize_t)size);
+  RAVE_FREE(buffer);
+  return pyresult;
+}
+
 /**
  * All methods a RaveIO can have
  */
@@ -292,6 +422,8 @@ static struct PyMethodDef _pyraveio_methods[] =
   {"save", (PyCFunction) _pyraveio_save, 1,   "save([filename)]\n\n"
                                               "Saves the current object (with current settings).\n\n"
                                               "filename - is optional. If not specified, the objects filename is used\n"},
+  {"saveToMemory", (PyCFunction) _pyraveio_saveToMemory, 1, "saveToMemory() -> bytes\n\n"
+                                              "Saves the current object (with current settings) and returns the file content instead of writing a file.\n"},
   {NULL, NULL } /* sentinel */
 };
 
@@ -628,7 +760,14 @@ static PyMethodDef functions[] = {
       "Opens a file that is supported by raveio and loads the structure.\n\n"
       "filename - a filename pointing to a file supported by raveio.\n"
       "lazy_loading - a boolean if file should be lazy loaded or not. If True, then only meta data is read.\n"
-      "preload_quantities - a comma-separated list of quantities for which data should be loaded immediately. E.g. \"DBZH,TH\".\n\n"},
+      "preload_quantities - a comma-separated list of quantities and quality field how/tasks for which data should be loaded immediately. E.g. \"DBZH,TH\" or \"ACRR,se.smhi.composite.distance.radar\".\n\n"},
+  {"openFromMemory", (PyCFunction)_pyraveio_openFromMemory, 1,
+      "openFromMemory(content[,lazy_loading[,preload_quantities]]) -> a RaveIOCore instance with a loaded object.\n\n"
+      "Opens the content of a file that is supported by raveio, e.g. a file fetched from a database or received over\n"
+      "the network, without writing it to the file system. The filename of the returned instance is None.\n\n"
+      "content - the file content as bytes.\n"
+      "lazy_loading - a boolean if file should be lazy loaded or not. If True, then only meta data is read.\n"
+      "preload_quantities - a comma-separated list of quantities and quality field how/tasks for which data should be loaded immediately. E.g. \"DBZH,TH\" or \"ACRR,se.smhi.composite.distance.radar\".\n\n"},
   {"supports", (PyCFunction)_pyraveio_supports, 1,
       "supports(format) -> True or False depending if format supported or not\n\n"
       "Returns if the raveio supports the requested file format.\n\n"
@@ -636,6 +775,14 @@ static PyMethodDef functions[] = {
       "  raveio.RaveIO_ODIM_FileFormat_HDF5\n"
       " _raveio.RaveIO_ODIM_FileFormat_BUFR - if built with support\n"
       " _raveio.RaveIO_FileFormat_CF        - if built with support and currently only supports writing"},
+  {"setBufrWorkers", (PyCFunction)_pyraveio_setBufrWorkers, 1,
+      "setBufrWorkers(program, maxworkers)\n\n"
+      "Lets open/load decode BUFR files in separate worker processes so that several files can be decoded at the same time.\n"
+      "The BUFR library only allows one file to be decoded at a time within a process.\n\n"
+      "program    - the worker program, e.g. <prefix>/bin/rave_bufr2odim. None disables the workers.\n"
+      "maxworkers - max number of concurrently running workers. <= 0 disables the workers."},
+  {"getBufrWorkers", (PyCFunction)_pyraveio_getBufrWorkers, 1,
+      "getBufrWorkers() -> the max number of concurrently running BUFR worker processes, 0 if not used\n\n"},
   {NULL,NULL} /*Sentinel*/
 };
 /**
@@ -0,0 +1,197 @@
+/* --------------------------------------------------------------------
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of RAVE.
+
+RAVE is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RAVE is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+/**
+ * Python API to the toolbox timers and counters
+ * @file
+ * @date 2026-10-17
+ */
+#include "pyravecompat.h"
+#include "rave.h"
+#include "rave_debug.h"
+#include "pyrave_debug.h"
+#include "rave_stats.h"
+
+/**
+ * Debug this module
+ */
+PYRAVE_DEBUG_MODULE("_ravestats");
+
+/**
+ * Sets a Python exception and return NULL
+ */
+#define raiseException_returnNULL(type, msg) \
+{PyErr_SetString(type, msg); return NULL;}
+
+/**
+ * Error object for reporting errors to the Python interpreter
+ */
+static PyObject *ErrorObject;
+
+/**
+ * Returns if the statistics are compiled in
+ * @param[in] self - self
+ * @param[in] args - N/A
+ * @returns True or False
+ */
+static PyObject* _ravestats_isEnabled(PyObject* self, PyObject* args)
+{
+  if (!PyArg_ParseTuple(args, "")) {
+    return NULL;
+  }
+  return PyBool_FromLong(RaveStats_isEnabled());
+}
+
+/**
+ * Returns the timers
+ * @param[in] self - self
+ * @param[in] args - N/A
+ * @returns a dictionary with timer name and a tuple (seconds, calls)
+ */
+static PyObject* _ravestats_timers(PyObject* self, PyObject* args)
+{
+  RaveStats_t stats;
+  PyObject* result = NULL;
+  int i = 0;
+
+  if (!PyArg_ParseTuple(args, "")) {
+    return NULL;
+  }
+  RaveStats_get(&stats);
+
+  result = PyDict_New();
+  if (result == NULL) {
+    return NULL;
+  }
+  for (i = 0; i < RaveStats_Timer_NTIMERS; i++) {
+    PyObject* item = Py_BuildValue("(dl)", stats.seconds[i], stats.calls[i]);
+    if (item == NULL || PyDict_SetItemString(result, RaveStats_getTimerName((RaveStats_Timer)i), item) != 0) {
+      Py_XDECREF(item);
+      Py_DECREF(result);
+      raiseException_returnNULL(PyExc_MemoryError, "Failed to create timer dictionary");
+    }
+    Py_DECREF(item);
+  }
+  return result;
+}
+
+/**
+ * Returns the counters
+ * @param[in] self - self
+ * @param[in] args - N/A
+ * @returns a dictionary with counter name and value
+ */
+static PyObject* _ravestats_counters(PyObject* self, PyObject* args)
+{
+  RaveStats_t stats;
+  PyObject* result = NULL;
+  int i = 0;
+
+  if (!PyArg_ParseTuple(args, "")) {
+    return NULL;
+  }
+  RaveStats_get(&stats);
+
+  result = PyDict_New();
+  if (result == NULL) {
+    return NULL;
+  }
+  for (i = 0; i < RaveStats_Counter_NCOUNTERS; i++) {
+    PyObject* item = PyLong_FromLong(stats.counters[i]);
+    if (item == NULL || PyDict_SetItemString(result, RaveStats_getCounterName((RaveStats_Counter)i), item) != 0) {
+      Py_XDECREF(item);
+      Py_DECREF(result);
+      raiseException_returnNULL(PyExc_MemoryError, "Failed to create counter dictionary");
+    }
+    Py_DECREF(item);
+  }
+  return result;
+}
+
+/**
+ * Resets all timers and counters
+ * @param[in] self - self
+ * @param[in] args - N/A
+ * @returns None
+ */
+static PyObject* _ravestats_reset(PyObject* self, PyObject* args)
+{
+  if (!PyArg_ParseTuple(args, "")) {
+    return NULL;
+  }
+  RaveStats_reset();
+  Py_RETURN_NONE;
+}
+
+/*@{ Module setup */
+static struct PyMethodDef _ravestats_functions[] =
+{
+  {"isEnabled", (PyCFunction) _ravestats_isEnabled, METH_VARARGS,
+    "isEnabled() -> boolean\n\n"
+    "Returns if the timers and counters have been compiled in (configure --enable-stats). If not, all values are always 0."
+  },
+  {"timers", (PyCFunction) _ravestats_timers, METH_VARARGS,
+    "timers() -> dictionary\n\n"
+    "Returns the timers summed over all threads as a dictionary with the timer name, e.g. 'composite.projection', as key and a tuple (seconds, calls) as value."
+  },
+  {"counters", (PyCFunction) _ravestats_counters, METH_VARARGS,
+    "counters() -> dictionary\n\n"
+    "Returns the counters summed over all threads as a dictionary with the counter name, e.g. 'composite.pixels', as key."
+  },
+  {"reset", (PyCFunction) _ravestats_reset, METH_VARARGS,
+    "reset()\n\n"
+    "Resets all timers and counters."
+  },
+  { NULL, NULL }
+};
+
+/*@{ Documentation about the module */
+PyDoc_STRVAR(_ravestats_module_doc,
+  "Timers and counters for the hot paths in the toolbox, e.g. how long compositing spends in projection, value\n"
+  "selection and quality filling or the time spent in I/O and the quality controls.\n"
+  "The values are only collected if rave has been configured with --enable-stats.\n"
+  "Usage:\n"
+  " import _ravestats\n"
+  " _ravestats.reset()\n"
+  " ... generate a composite ...\n"
+  " print(_ravestats.timers()['composite.projection'])\n"
+);
+/*@} End of Documentation about the module */
+
+/**
+ * Initialize the _ravestats module
+ */
+MOD_INIT(_ravestats)
+{
+  PyObject* module = NULL;
+  PyObject* dictionary = NULL;
+  MOD_INIT_DEF(module, "_ravestats", _ravestats_module_doc, _ravestats_functions);
+  if (module == NULL) {
+    return MOD_INIT_ERROR;
+  }
+
+  dictionary = PyModule_GetDict(module);
+  ErrorObject = PyErr_NewException("_ravestats.error", NULL, NULL);
+  if (ErrorObject == NULL || PyDict_SetItemString(dictionary, "error", ErrorObject) != 0) {
+    Py_FatalError("Can't define _ravestats.error");
+    return MOD_INIT_ERROR;
+  }
+  PYRAVE_DEBUG_INITIALIZE;
+  return MOD_INIT_SUCCESS(module);
+}
+/*@} End of Module setup */
@@ -62,6 +62,327 @@ PYRAVE_DEBUG_MODULE("_transform");
  */
 static PyObject *ErrorObject;
 
+/*@{ Transform operator */
+static PyTypeObject PyTransformOperator_Type;
+
+/**
+ * Checks if the object is a python transform operator
+ */
+#define PyTransformOperator_Check(op) (Py_TYPE(op) == &PyTransformOperator_Type)
+
+/**
+ * Creates a python transform operator from a native operator.
+ * @param[in] p - the native operator
+ * @returns the python operator
+ */
+static PyTransformOperator* PyTransformOperator_New(TransformOperator_t* p)
+{
+  PyTransformOperator* result = NULL;
+
+  result = RAVE_OBJECT_GETBINDING(p);
+  if (result != NULL) {
+    Py_INCREF(result);
+    return result;
+  }
+  result = PyObject_NEW(PyTransformOperator, &PyTransformOperator_Type);
+  if (result == NULL) {
+    raiseException_returnNULL(PyExc_MemoryError, "Failed to allocate memory for PyTransformOperator.");
+  }
+  PYRAVE_DEBUG_OBJECT_CREATED;
+  result->op = RAVE_OBJECT_COPY(p);
+  RAVE_OBJECT_BIND(result->op, result);
+  return result;
+}
+
+/**
+ * Deallocates the operator
+ * @param[in] obj the object to deallocate.
+ */
+static void _pytransformoperator_dealloc(PyTransformOperator* obj)
+{
+  if (obj == NULL) {
+    return;
+  }
+  PYRAVE_DEBUG_OBJECT_DESTROYED;
+  RAVE_OBJECT_UNBIND(obj->op, obj);
+  RAVE_OBJECT_RELEASE(obj->op);
+  PyObject_Del(obj);
+}
+
+/**
+ * Loads an operator that has been saved
+ * @param[in] self - this instance.
+ * @param[in] args - the filename
+ * @return the operator on success otherwise NULL
+ */
+static PyObject* _pytransformoperator_load(PyObject* self, PyObject* args)
+{
+  char* filename = NULL;
+  TransformOperator_t* op = NULL;
+  PyObject* result = NULL;
+
+  if (!PyArg_ParseTuple(args, "s", &filename)) {
+    return NULL;
+  }
+  Py_BEGIN_ALLOW_THREADS
+  op = TransformOperator_load(filename);
+  Py_END_ALLOW_THREADS
+  if (op == NULL) {
+    raiseException_returnNULL(PyExc_IOError, "Failed to load transform operator");
+  }
+  result = (PyObject*)PyTransformOperator_New(op);
+  RAVE_OBJECT_RELEASE(op);
+  return result;
+}
+
+/**
+ * Applies the operator to a scan or volume
+ * @param[in] self - self
+ * @param[in] args - scan or volume, cartesian
+ * @return None on success otherwise NULL
+ */
+static PyObject* _pytransformoperator_apply(PyTransformOperator* self, PyObject* args)
+{
+  PyObject* pyobj = NULL;
+  PyObject* pycartesian = NULL;
+  TransformOperator_t* op = NULL;
+  RaveCoreObject* source = NULL;
+  Cartesian_t* target = NULL;
+  int isscan = 0;
+  int result = 0;
+
+  if (!PyArg_ParseTuple(args, "OO", &pyobj, &pycartesian)) {
+    return NULL;
+  }
+  if (PyPolarScan_Check(pyobj)) {
+    source = (RaveCoreObject*)RAVE_OBJECT_COPY(((PyPolarScan*)pyobj)->scan);
+    isscan = 1;
+  } else if (PyPolarVolume_Check(pyobj)) {
+    source = (RaveCoreObject*)RAVE_OBJECT_COPY(((PyPolarVolume*)pyobj)->pvol);
+  } else {
+    raiseException_returnNULL(PyExc_TypeError, "First argument should be a polar scan or polar volume");
+  }
+  if (!PyCartesian_Check(pycartesian)) {
+    RAVE_OBJECT_RELEASE(source);
+    raiseException_returnNULL(PyExc_TypeError, "Second argument should be a cartesian product");
+  }
+
+  op = RAVE_OBJECT_COPY(self->op);
+  target = RAVE_OBJECT_COPY(((PyCartesian*)pycartesian)->cartesian);
+  Py_BEGIN_ALLOW_THREADS
+  if (isscan) {
+    result = TransformOperator_applyScan(op, (PolarScan_t*)source, target);
+  } else {
+    result = TransformOperator_applyVolume(op, (PolarVolume_t*)source, target);
+  }
+  Py_END_ALLOW_THREADS
+  RAVE_OBJECT_RELEASE(op);
+  RAVE_OBJECT_RELEASE(source);
+  RAVE_OBJECT_RELEASE(target);
+
+  if (!result) {
+    raiseException_returnNULL(PyExc_IOError, "Failed to apply transform operator");
+  }
+  Py_RETURN_NONE;
+}
+
+/**
+ * Saves the operator
+ * @param[in] self - self
+ * @param[in] args - the filename
+ * @return None on success otherwise NULL
+ */
+static PyObject* _pytransformoperator_save(PyTransformOperator* self, PyObject* args)
+{
+  char* filename = NULL;
+  TransformOperator_t* op = NULL;
+  int result = 0;
+
+  if (!PyArg_ParseTuple(args, "s", &filename)) {
+    return NULL;
+  }
+  op = RAVE_OBJECT_COPY(self->op);
+  Py_BEGIN_ALLOW_THREADS
+  result = TransformOperator_save(op, filename);
+  Py_END_ALLOW_THREADS
+  RAVE_OBJECT_RELEASE(op);
+  if (!result) {
+    raiseException_returnNULL(PyExc_IOError, "Failed to save transform operator");
+  }
+  Py_RETURN_NONE;
+}
+
+/**
+ * Returns if the operator has been compiled for the setup
+ * @param[in] self - self
+ * @param[in] args - area, radardef, method, product, value
+ * @return True or False
+ */
+static PyObject* _pytransformoperator_isCompiledFor(PyTransformOperator* self, PyObject* args)
+{
+  PyObject* pyarea = NULL;
+  PyObject* pydef = NULL;
+  int method = 0, product = 0;
+  double value = 0.0;
+
+  if (!PyArg_ParseTuple(args, "OOiid", &pyarea, &pydef, &method, &product, &value)) {
+    return NULL;
+  }
+  if (!PyArea_Check(pyarea) || !PyRadarDefinition_Check(pydef)) {
+    raiseException_returnNULL(PyExc_TypeError, "isCompiledFor requires area and radar definition");
+  }
+  return PyBool_FromLong(TransformOperator_isCompiledFor(self->op, ((PyArea*)pyarea)->area,
+    ((PyRadarDefinition*)pydef)->def, (RaveTransformationMethod)method, (Rave_ProductType)product, value));
+}
+
+/**
+ * All methods a transform operator can have
+ */
+static struct PyMethodDef _pytransformoperator_methods[] =
+{
+  {"xsize", NULL, METH_VARARGS},
+  {"ysize", NULL, METH_VARARGS},
+  {"method", NULL, METH_VARARGS},
+  {"product", NULL, METH_VARARGS},
+  {"value", NULL, METH_VARARGS},
+  {"radius", NULL, METH_VARARGS},
+  {"entries", NULL, METH_VARARGS},
+  {"nthreads", NULL, METH_VARARGS},
+  {"apply", (PyCFunction)_pytransformoperator_apply, 1,
+    "apply(object, cartesian)\n\n"
+    "Applies the operator to the default parameter of a polar scan or polar volume and writes the result to\n"
+    "the default parameter of the cartesian product. The geometry must match the radar definition the\n"
+    "operator was compiled with.\n\n"
+    "object    - a polar scan or polar volume\n"
+    "cartesian - the cartesian product with the size of the area"
+  },
+  {"save", (PyCFunction)_pytransformoperator_save, 1,
+    "save(filename)\n\n"
+    "Saves the operator in a native binary format that can be loaded with _transform.loadOperator.\n\n"
+    "filename - the file"
+  },
+  {"isCompiledFor", (PyCFunction)_pytransformoperator_isCompiledFor, 1,
+    "isCompiledFor(area, radardef, method, product, value) -> boolean\n\n"
+    "Returns if the operator has been compiled for the area, radar definition, method, product and value."
+  },
+  {NULL, NULL} /* sentinel */
+};
+
+/**
+ * Returns the specified attribute in the operator
+ */
+static PyObject* _pytransformoperator_getattro(PyTransformOperator* self, PyObject* name)
+{
+  if (PY_COMPARE_STRING_WITH_ATTRO_NAME("xsize", name) == 0) {
+    return PyInt_FromLong(TransformOperator_getXSize(self->op));
+  } else if (PY_COMPARE_STRING_WITH_ATTRO_NAME("ysize", name) == 0) {
+    return PyInt_FromLong(TransformOperator_getYSize(self->op));
+  } else if (PY_COMPARE_STRING_WITH_ATTRO_NAME("method", name) == 0) {
+    return PyInt_FromLong(TransformOperator_getMethod(self->op));
+  } else if (PY_COMPARE_STRING_WITH_ATTRO_NAME("product", name) == 0) {
+    return PyInt_FromLong(TransformOperator_getProduct(self->op));
+  } else if (PY_COMPARE_STRING_WITH_ATTRO_NAME("value", name) == 0) {
+    return PyFloat_FromDouble(TransformOperator_getValue(self->op));
+  } else if (PY_COMPARE_STRING_WITH_ATTRO_NAME("radius", name) == 0) {
+    return PyFloat_FromDouble(TransformOperator_getRadius(self->op));
+  } else if (PY_COMPARE_STRING_WITH_ATTRO_NAME("rstart", name) == 0) {
+    return PyFloat_FromDouble(TransformOperator_getRstart(self->op));
+  } else if (PY_COMPARE_STRING_WITH_ATTRO_NAME("astart", name) == 0) {
+    if (TransformOperator_hasAstart(self->op)) {
+      return PyFloat_FromDouble(TransformOperator_getAstart(self->op));
+    }
+    Py_RETURN_NONE;
+  } else if (PY_COMPARE_STRING_WITH_ATTRO_NAME("entries", name) == 0) {
+    return PyInt_FromLong(TransformOperator_getNumberOfEntries(self->op));
+  } else if (PY_COMPARE_STRING_WITH_ATTRO_NAME("nthreads", name) == 0) {
+    return PyInt_FromLong(TransformOperator_getNumberOfThreads(self->op));
+  }
+  return PyObject_GenericGetAttr((PyObject*)self, name);
+}
+
+/**
+ * Sets the specified attribute in the operator
+ */
+static int _pytransformoperator_setattro(PyTransformOperator* self, PyObject* name, PyObject* val)
+{
+  int result = -1;
+  if (name == NULL) {
+    goto done;
+  }
+  if (PY_COMPARE_STRING_WITH_ATTRO_NAME("nthreads", name) == 0) {
+    if (!PyInt_Check(val) || !TransformOperator_setNumberOfThreads(self->op, (int)PyInt_AsLong(val))) {
+      raiseException_gotoTag(done, PyExc_ValueError, "nthreads must be an integer >= 1");
+    }
+  } else {
+    raiseException_gotoTag(done, PyExc_AttributeError, PY_RAVE_ATTRO_NAME_TO_STRING(name));
+  }
+  result = 0;
+done:
+  return result;
+}
+
+PyDoc_STRVAR(_pytransformoperator_type_doc,
+    "A transform compiled for an area, radar definition, method and product. The mapping from each cartesian\n"
+    "pixel to the polar bins it is derived from is stored as a sparse matrix so that it can be applied to new\n"
+    "scans and volumes with the same geometry without navigating again. Created with TransformCore.compile\n"
+    "or _transform.loadOperator.\n\n"
+    " xsize, ysize - size of the area (read only)\n"
+    " method       - the transformation method (read only)\n"
+    " product      - _rave.Rave_ProductType_PPI, _CAPPI or _PCAPPI (read only)\n"
+    " value        - the elevation angle in radians or the height in meters (read only)\n"
+    " radius       - the radius of influence used for CRESSMAN, UNIFORM and INVERSE (read only)\n"
+    " rstart       - the range to the start of the first bin in km (read only)\n"
+    " astart       - the azimuth where the first ray starts in radians or None (read only)\n"
+    " entries      - number of weights in the operator (read only)\n"
+    " nthreads     - number of threads used when applying the operator\n"
+    );
+
+static PyTypeObject PyTransformOperator_Type =
+{
+  PyVarObject_HEAD_INIT(NULL, 0) /*ob_size*/
+  "TransformOperatorCore", /*tp_name*/
+  sizeof(PyTransformOperator), /*tp_size*/
+  0, /*tp_itemsize*/
+  /* methods */
+  (destructor)_pytransformoperator_dealloc, /*tp_dealloc*/
+  0, /*tp_print*/
+  (getattrfunc)0,               /*tp_getattr*/
+  (setattrfunc)0,               /*tp_setattr*/
+  0,                            /*tp_compare*/
+  0,                            /*tp_repr*/
+  0,                            /*tp_as_number */
+  0,
+  0,                            /*tp_as_mapping */
+  0,                            /*tp_hash*/
+  (ternaryfunc)0,               /*tp_call*/
+  (reprfunc)0,                  /*tp_str*/
+  (getattrofunc)_pytransformoperator_getattro, /*tp_getattro*/
+  (setattrofunc)_pytransformoperator_setattro, /*tp_setattro*/
+  0,                            /*tp_as_buffer*/
+  Py_TPFLAGS_DEFAULT, /*tp_flags*/
+  _pytransformoperator_type_doc, /*tp_doc*/
+  (traverseproc)0,              /*tp_traverse*/
+  (inquiry)0,                   /*tp_clear*/
+  0,                            /*tp_richcompare*/
+  0,                            /*tp_weaklistoffset*/
+  0,                            /*tp_iter*/
+  0,                            /*tp_iternext*/
+  _pytransformoperator_methods, /*tp_methods*/
+  0,                            /*tp_members*/
+  0,                            /*tp_getset*/
+  0,                            /*tp_base*/
+  0,                            /*tp_dict*/
+  0,                            /*tp_descr_get*/
+  0,                            /*tp_descr_set*/
+  0,                            /*tp_dictoffset*/
+  0,                            /*tp_init*/
+  0,                            /*tp_alloc*/
+  0,                            /*tp_new*/
+  0,                            /*tp_free*/
+  0,                            /*tp_is_gc*/
+};
+/*@} End of Transform operator */
+
 /*@{ Transform */
 /**
  * Returns the native Transform_t instance.
@@ -158,6 +479,10 @@ static PyObject* _pytransform_ppi(PyTransform* self, PyObject* args)
   PyObject* pycartesian = NULL;
   PyPolarScan* scan = NULL;
   PyObject* pyscan = NULL;
+  Transform_t* transform = NULL;
+  PolarScan_t* source = NULL;
+  Cartesian_t* target = NULL;
+  int result = 0;
 
   if(!PyArg_ParseTuple(args, "OO", &pyscan, &pycartesian)) {
     return NULL;
@@ -174,7 +499,17 @@ static PyObject* _pytransform_ppi(PyTransform* self, PyObject* args)
   scan = (PyPolarScan*)pyscan;
   cartesian = (PyCartesian*)pycartesian;
 
-  if (!Transform_ppi(self->transform, scan->scan, cartesian->cartesian)) {
+  transform = RAVE_OBJECT_COPY(self->transform);
+  source = RAVE_OBJECT_COPY(scan->scan);
+  target = RAVE_OBJECT_COPY(cartesian->cartesian);
+  Py_BEGIN_ALLOW_THREADS
+  result = Transform_ppi(transform, source, target);
+  Py_END_ALLOW_THREADS
+  RAVE_OBJECT_RELEASE(transform);
+  RAVE_OBJECT_RELEASE(source);
+  RAVE_OBJECT_RELEASE(target);
+
+  if (!result) {
     raiseException_returnNULL(PyExc_IOError, "Failed to transform volume into a ppi");
   }
 
@@ -194,6 +529,10 @@ static PyObject* _pytransform_cappi(PyTransform* self, PyObject* args)
   PyPolarVolume* pvol = NULL;
   PyObject* pypvol = NULL;
   double height = 0.0L;
+  Transform_t* transform = NULL;
+  PolarVolume_t* source = NULL;
+  Cartesian_t* target = NULL;
+  int result = 0;
 
   if(!PyArg_ParseTuple(args, "OOd", &pypvol, &pycartesian, &height)) {
     return NULL;
@@ -210,7 +549,17 @@ static PyObject* _pytransform_cappi(PyTransform* self, PyObject* args)
   pvol = (PyPolarVolume*)pypvol;
   cartesian = (PyCartesian*)pycartesian;
 
-  if (!Transform_cappi(self->transform, pvol->pvol, cartesian->cartesian, height)) {
+  transform = RAVE_OBJECT_COPY(self->transform);
+  source = RAVE_OBJECT_COPY(pvol->pvol);
+  target = RAVE_OBJECT_COPY(cartesian->cartesian);
+  Py_BEGIN_ALLOW_THREADS
+  result = Transform_cappi(transform, source, target, height);
+  Py_END_ALLOW_THREADS
+  RAVE_OBJECT_RELEASE(transform);
+  RAVE_OBJECT_RELEASE(source);
+  RAVE_OBJECT_RELEASE(target);
+
+  if (!result) {
     raiseException_returnNULL(PyExc_IOError, "Failed to transform volume into a cappi");
   }
 
@@ -230,6 +579,10 @@ static PyObject* _pytransform_pcappi(PyTransform* self, PyObject* args)
   PyPolarVolume* pvol = NULL;
   PyObject* pypvol = NULL;
   double height = 0.0L;
+  Transform_t* transform = NULL;
+  PolarVolume_t* source = NULL;
+  Cartesian_t* target = NULL;
+  int result = 0;
 
   if(!PyArg_ParseTuple(args, "OOd", &pypvol, &pycartesian,&height)) {
     return NULL;
@@ -246,7 +599,17 @@ static PyObject* _pytransform_pcappi(PyTransform* self, PyObject* args)
   pvol = (PyPolarVolume*)pypvol;
   cartesian = (PyCartesian*)pycartesian;
 
-  if (!Transform_pcappi(self->transform, pvol->pvol, cartesian->cartesian, height)) {
+  transform = RAVE_OBJECT_COPY(self->transform);
+  source = RAVE_OBJECT_COPY(pvol->pvol);
+  target = RAVE_OBJECT_COPY(cartesian->cartesian);
+  Py_BEGIN_ALLOW_THREADS
+  result = Transform_pcappi(transform, source, target, height);
+  Py_END_ALLOW_THREADS
+  RAVE_OBJECT_RELEASE(transform);
+  RAVE_OBJECT_RELEASE(source);
+  RAVE_OBJECT_RELEASE(target);
+
+  if (!result) {
     raiseException_returnNULL(PyExc_IOError, "Failed to transform volume into a cappi");
   }
 
@@ -372,6 +735,8 @@ static PyObject* _pytransform_combine_tiles(PyTransform* self, PyObject* args)
   Cartesian_t* result = NULL;
   PyObject* pyresult = NULL;
   RaveObjectList_t* tiles = NULL;
+  Transform_t* transform = NULL;
+  Area_t* area = NULL;
   Py_ssize_t n = 0, i = 0;
 
   if (!PyArg_ParseTuple(args, "OO", &pyarea, &pytiles)) {
@@ -401,18 +766,169 @@ static PyObject* _pytransform_combine_tiles(PyTransform* self, PyObject* args)
     }
     Py_XDECREF(v);
   }
-  result = Transform_combine_tiles(self->transform, ((PyArea*)pyarea)->area, tiles);
+  transform = RAVE_OBJECT_COPY(self->transform);
+  area = RAVE_OBJECT_COPY(((PyArea*)pyarea)->area);
+  Py_BEGIN_ALLOW_THREADS
+  result = Transform_combine_tiles(transform, area, tiles);
+  Py_END_ALLOW_THREADS
   if (result == NULL) {
     raiseException_gotoTag(done, PyExc_AttributeError, "Failed to combine tiles");
   }
   pyresult = (PyObject*)PyCartesian_New(result);
 
 done:
+  RAVE_OBJECT_RELEASE(transform);
+  RAVE_OBJECT_RELEASE(area);
   RAVE_OBJECT_RELEASE(tiles);
   RAVE_OBJECT_RELEASE(result);
   return pyresult;
 }
 
+/**
+ * Compiles a transform operator with the method of this transformer
+ * @param[in] self - self
+ * @param[in] args - area, radardef, product, value and optionally radius, rstart and astart
+ * @return the operator on success otherwise NULL
+ */
+static PyObject* _pytransform_compile(PyTransform* self, PyObject* args)
+{
+  PyObject* pyarea = NULL;
+  PyObject* pydef = NULL;
+  PyObject* pyastart = Py_None;
+  int product = 0, compiled = 0;
+  double value = 0.0, radius = 0.0, rstart = 0.0;
+  RaveTransformationMethod method = NEAREST;
+  Area_t* area = NULL;
+  RadarDefinition_t* def = NULL;
+  TransformOperator_t* op = NULL;
+  PyObject* result = NULL;
+
+  if (!PyArg_ParseTuple(args, "OOid|ddO", &pyarea, &pydef, &product, &value, &radius, &rstart, &pyastart)) {
+    return NULL;
+  }
+  if (!PyArea_Check(pyarea)) {
+    raiseException_returnNULL(PyExc_TypeError, "First argument should be an area");
+  }
+  if (!PyRadarDefinition_Check(pydef)) {
+    raiseException_returnNULL(PyExc_TypeError, "Second argument should be a radar definition");
+  }
+  if (pyastart != Py_None && !PyFloat_Check(pyastart) && !PyLong_Check(pyastart) && !PyInt_Check(pyastart)) {
+    raiseException_returnNULL(PyExc_TypeError, "astart should be a number or None");
+  }
+  op = RAVE_OBJECT_NEW(&TransformOperator_TYPE);
+  if (op == NULL) {
+    raiseException_returnNULL(PyExc_MemoryError, "Failed to create transform operator");
+  }
+  TransformOperator_setRstart(op, rstart);
+  if (pyastart != Py_None) {
+    TransformOperator_setAstart(op, PyFloat_AsDouble(pyastart));
+  }
+  method = Transform_getMethod(self->transform);
+  area = RAVE_OBJECT_COPY(((PyArea*)pyarea)->area);
+  def = RAVE_OBJECT_COPY(((PyRadarDefinition*)pydef)->def);
+  Py_BEGIN_ALLOW_THREADS
+  compiled = TransformOperator_compile(op, area, def, method, (Rave_ProductType)product, value, radius);
+  Py_END_ALLOW_THREADS
+  if (!compiled) {
+    raiseException_gotoTag(done, PyExc_ValueError, "Failed to compile transform operator");
+  }
+  result = (PyObject*)PyTransformOperator_New(op);
+done:
+  RAVE_OBJECT_RELEASE(area);
+  RAVE_OBJECT_RELEASE(def);
+  RAVE_OBJECT_RELEASE(op);
+  return result;
+}
+
+/**
+ * Creates a max, echo top or vil from a polar volume
+ * @param[in] self the transformer
+ * @param[in] args (polarvolume, cartesian) and the threshold in dBZ for the echo top
+ * @param[in] product Rave_ProductType_MAX, Rave_ProductType_ETOP or Rave_ProductType_VIL
+ * @return Py_None on success, otherwise NULL
+ */
+static PyObject* _pytransform_vertical(PyTransform* self, PyObject* args, Rave_ProductType product)
+{
+  PyObject* pycartesian = NULL;
+  PyObject* pypvol = NULL;
+  double threshold = 0.0L;
+  Transform_t* transform = NULL;
+  PolarVolume_t* source = NULL;
+  Cartesian_t* target = NULL;
+  int result = 0;
+
+  if (product == Rave_ProductType_ETOP) {
+    if(!PyArg_ParseTuple(args, "OOd", &pypvol, &pycartesian, &threshold)) {
+      return NULL;
+    }
+  } else if(!PyArg_ParseTuple(args, "OO", &pypvol, &pycartesian)) {
+    return NULL;
+  }
+
+  if (!PyPolarVolume_Check(pypvol)) {
+    raiseException_returnNULL(PyExc_TypeError, "First argument should be a polar volume")
+  }
+
+  if (!PyCartesian_Check(pycartesian)) {
+    raiseException_returnNULL(PyExc_TypeError, "Second argument should be a cartesian product");
+  }
+
+  transform = RAVE_OBJECT_COPY(self->transform);
+  source = RAVE_OBJECT_COPY(((PyPolarVolume*)pypvol)->pvol);
+  target = RAVE_OBJECT_COPY(((PyCartesian*)pycartesian)->cartesian);
+  Py_BEGIN_ALLOW_THREADS
+  if (product == Rave_ProductType_ETOP) {
+    result = Transform_etop(transform, source, target, threshold);
+  } else if (product == Rave_ProductType_VIL) {
+    result = Transform_vil(transform, source, target);
+  } else {
+    result = Transform_max(transform, source, target);
+  }
+  Py_END_ALLOW_THREADS
+  RAVE_OBJECT_RELEASE(transform);
+  RAVE_OBJECT_RELEASE(source);
+  RAVE_OBJECT_RELEASE(target);
+
+  if (!result) {
+    raiseException_returnNULL(PyExc_IOError, "Failed to transform volume");
+  }
+
+  Py_RETURN_NONE;
+}
+
+/**
+ * Creates a vertical max from a polar volume
+ * @param[in] self the transformer
+ * @param[in] args (polarvolume, cartesian)
+ * @return Py_None on success, otherwise NULL
+ */
+static PyObject* _pytransform_max(PyTransform* self, PyObject* args)
+{
+  return _pytransform_vertical(self, args, Rave_ProductType_MAX);
+}
+
+/**
+ * Creates an echo top from a polar volume
+ * @param[in] self the transformer
+ * @param[in] args (polarvolume, cartesian, threshold in dBZ)
+ * @return Py_None on success, otherwise NULL
+ */
+static PyObject* _pytransform_etop(PyTransform* self, PyObject* args)
+{
+  return _pytransform_vertical(self, args, Rave_ProductType_ETOP);
+}
+
+/**
+ * Creates the vertically integrated liquid water from a polar volume
+ * @param[in] self the transformer
+ * @param[in] args (polarvolume, cartesian)
+ * @return Py_None on success, otherwise NULL
+ */
+static PyObject* _pytransform_vil(PyTransform* self, PyObject* args)
+{
+  return _pytransform_vertical(self, args, Rave_ProductType_VIL);
+}
+
 /**
  * All methods a transformator can have
  */
@@ -431,6 +947,21 @@ static struct PyMethodDef _pytransform_methods[] =
     "pcappi(scan, cartesian, height)\n\n"
     "DEPRECATED. Use _composite instead.\n"
   },
+  {"max", (PyCFunction) _pytransform_max, 1,
+    "max(pvol, cartesian)\n\n"
+    "Fills the default parameter of the cartesian product with the vertical maximum of the default parameter of the volume.\n"
+    "The value is stored with the gain and offset of the cartesian product.\n"
+  },
+  {"etop", (PyCFunction) _pytransform_etop, 1,
+    "etop(pvol, cartesian, threshold)\n\n"
+    "Fills the default parameter of the cartesian product with the echo top, the height in km above sea level of the\n"
+    "highest bin where the default parameter of the volume is >= threshold (dBZ).\n"
+  },
+  {"vil", (PyCFunction) _pytransform_vil, 1,
+    "vil(pvol, cartesian)\n\n"
+    "Fills the default parameter of the cartesian product with the vertically integrated liquid water in kg/m2.\n"
+    "The default parameter of the volume must be reflectivity in dBZ.\n"
+  },
   {"ctoscan", (PyCFunction) _pytransform_ctoscan, 1,
     "ctoscan(cartesian, radardef, elangle, quantity) -> scan\n\n"
     "Creates a scan from a cartesian parameter with specified quantity. Uses radardef to get correct radar information and the elevation angle should be in radians\n"
@@ -461,6 +992,19 @@ static struct PyMethodDef _pytransform_methods[] =
     "area - the area that should be created\n"
     "tiles - a list of cartesian objects that will be used to build the resulting cartesian object"
   },
+  {"compile", (PyCFunction) _pytransform_compile, 1,
+    "compile(area, radardef, product, value[, radius[, rstart[, astart]]]) -> transform operator\n\n"
+    "Compiles the transformation with the method of this transformer into an operator that can be applied to\n"
+    "any scan or volume with the geometry of radardef. Supported methods are NEAREST, BILINEAR, CRESSMAN,\n"
+    "UNIFORM and INVERSE.\n\n"
+    "area     - the area\n"
+    "radardef - the radar definition with location, elevation angles, nrays, nbins and scale\n"
+    "product  - _rave.Rave_ProductType_PPI, _rave.Rave_ProductType_CAPPI or _rave.Rave_ProductType_PCAPPI\n"
+    "value    - the elevation angle in radians (PPI) or the height in meters (CAPPI, PCAPPI)\n"
+    "radius   - radius of influence in meters for CRESSMAN, UNIFORM and INVERSE. Default is the largest area scale\n"
+    "rstart   - range to the start of the first bin in km, as the rstart of the scans. Default is 0\n"
+    "astart   - azimuth in radians where the first ray starts, as how/astart of the scans. Default is None (not used)"
+  },
   {NULL, NULL } /* sentinel */
 };
 
@@ -567,6 +1111,10 @@ static PyMethodDef functions[] = {
     "new() -> new instance of the TransformCore object\n\n"
     "Creates a new instance of the TransformCore object"
   },
+  {"loadOperator", (PyCFunction)_pytransformoperator_load, 1,
+    "loadOperator(filename) -> transform operator\n\n"
+    "Loads a transform operator that has been saved with save(filename)."
+  },
   {NULL,NULL} /*Sentinel*/
 };
 
@@ -578,7 +1126,10 @@ MOD_INIT(_transform)
 
   MOD_INIT_SETUP_TYPE(PyTransform_Type, &PyType_Type);
 
+  MOD_INIT_SETUP_TYPE(PyTransformOperator_Type, &PyType_Type);
+
   MOD_INIT_VERIFY_TYPE_READY(&PyTransform_Type);
+  MOD_INIT_VERIFY_TYPE_READY(&PyTransformOperator_Type);
 
   MOD_INIT_DEF(module, "_transform", _transform_type_doc, functions);
   if (module == NULL) {
@@ -34,6 +34,14 @@ typedef struct {
   Transform_t* transform;  /**< the c-api transformator */
 } PyTransform;
 
+/**
+ * A compiled transform operator
+ */
+typedef struct {
+  PyObject_HEAD /*Always has to be on top*/
+  TransformOperator_t* op;  /**< the c-api operator */
+} PyTransformOperator;
+
 #define PyTransform_Type_NUM 0                     /**< index for Type */
 
 #define PyTransform_GetNative_NUM 1                /**< index for GetNative fp */
@@ -80,4 +80,33 @@ class MeanTest(unittest.TestCase):
     for y in range(5):
       for x in range(5):
         self.assertAlmostEqual(expectedarr[y][x], actualarr[y][x], 2)
-    
\ No newline at end of file
+
+  def test_average_same_as_getMean(self):
+    param = _cartesianparam.new()
+    param.nodata = 255.0
+    param.undetect = 0.0
+    param.quantity="DBZH"
+
+    data = numpy.zeros((9,11), numpy.float64)
+    for y in range(9):
+      for x in range(11):
+        data[y][x] = float((x*7 + y*13) % 40 + 1)
+    data[0][0] = param.nodata
+    data[2][5] = param.nodata
+    data[4][4] = param.undetect
+    data[6][9] = param.undetect
+    data[8][10] = param.nodata
+    param.setData(data)
+
+    src = _cartesian.new()
+    src.addParameter(param)
+
+    for N in [1, 2, 5, 6, 30]:
+      actualarr = _mean.average(src, N).getParameter("DBZH").getData()
+      for y in range(9):
+        for x in range(11):
+          (t, v) = src.getMean((x,y), N)
+          if numpy.isnan(v):
+            self.assertTrue(numpy.isnan(actualarr[y][x]))
+          else:
+            self.assertAlmostEqual(v, actualarr[y][x], 6)
@@ -504,6 +504,59 @@ class PyCartesianTest(unittest.TestCase):
     result = obj.getConvertedQualityValueAtLonLat(deg2rad((12.8544, 56.3675)), "se.task.2")
     self.assertAlmostEqual(3.0 * 199.0, result, 4)
 
+  def test_getConvertedValuesAtLonLats(self):
+    obj = _cartesian.new()
+    obj.projection = _rave.projection("gnom","gnom","+proj=gnom +R=6371000.0 +lat_0=56.3675 +lon_0=12.8544")
+    obj.xscale = 100.0
+    obj.yscale = 100.0
+
+    xy = obj.projection.fwd(deg2rad((12.8544, 56.3675)))
+    obj.areaextent = (xy[0] - 4*100.0, xy[1] - 5*100.0, xy[0] + 6*100.0, xy[1] + 5*100.0)
+    param = _cartesianparam.new()
+    param.quantity = "DBZH"
+    param.nodata = 255.0
+    param.undetect = 0.0
+    param.gain = 2.0
+    param.offset = 1.0
+    a = numpy.reshape(numpy.arange(99).astype(numpy.float64), (11,9))
+    param.setData(a)
+
+    field = _ravefield.new()
+    field.addAttribute("how/task", "se.task.1")
+    field.addAttribute("what/offset", 10.0)
+    field.addAttribute("what/gain", 2.0)
+    field.setData(a)
+    param.addQualityField(field)
+    obj.addParameter(param)
+    obj.defaultParameter = "DBZH"
+
+    lonlats = [(12.8544, 56.3675), (12.8560, 56.3690), (12.8500, 56.3650), (20.0, 50.0)]
+    lons = numpy.array([deg2rad(x)[0] for x in lonlats])
+    lats = numpy.array([deg2rad(x)[1] for x in lonlats])
+    values, types, qualities = obj.getConvertedValuesAtLonLats(lons, lats, "se.task.1")
+    self.assertEqual(4, len(values))
+    for i, ll in enumerate(lonlats):
+      expected = obj.getConvertedValueAtLonLat(deg2rad(ll))
+      self.assertEqual(expected[0], types[i])
+      self.assertAlmostEqual(expected[1], values[i], 4)
+      expectedq = obj.getConvertedQualityValueAtLonLat(deg2rad(ll), "se.task.1")
+      if expectedq is None:
+        self.assertTrue(math.isnan(qualities[i]))
+      else:
+        self.assertAlmostEqual(expectedq, qualities[i], 4)
+    self.assertEqual(_rave.RaveValueType_NODATA, types[3])
+
+    values, types, qualities = obj.getConvertedValuesAtLonLats(list(lons), list(lats))
+    self.assertTrue(numpy.all(numpy.isnan(qualities)))
+
+  def test_getConvertedValuesAtLonLats_mismatch(self):
+    obj = _cartesian.new()
+    try:
+      obj.getConvertedValuesAtLonLats([0.1, 0.2], [0.1])
+      self.fail("Expected ValueError")
+    except ValueError:
+      pass
+
   def test_getMean(self):
     obj = _cartesian.new()
     
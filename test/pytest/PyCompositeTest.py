@@ -24,6 +24,7 @@ Tests the composite module.
 @date 2010-01-29
 '''
 import unittest
+import os
 import _pycomposite
 import _rave
 import _area
@@ -144,11 +145,15 @@ class PyCompositeTest(unittest.TestCase):
   
   DUMMY_DATA_FIXTURES = ["fixtures/sehem_qcvol_pn129_20180129T100000Z_0x73fc7b_dummydata.h5"]
   
+  TEMPORARY_FILE="composite_stream_test.h5"
+
   def setUp(self):
-    pass
+    if os.path.isfile(self.TEMPORARY_FILE):
+      os.unlink(self.TEMPORARY_FILE)
 
   def tearDown(self):
-    pass
+    if os.path.isfile(self.TEMPORARY_FILE):
+      os.unlink(self.TEMPORARY_FILE)
 
   def test_new(self):
     obj = _pycomposite.new()
@@ -180,6 +185,14 @@ class PyCompositeTest(unittest.TestCase):
     self.assertEqual("se.some.field", obj.quality_indicator_field_name)
     obj.quality_indicator_field_name = None
     self.assertEqual(None, obj.quality_indicator_field_name)
+
+  def test_lazy_quality(self):
+    obj = _pycomposite.new()
+    self.assertEqual(False, obj.lazy_quality)
+    obj.lazy_quality = True
+    self.assertEqual(True, obj.lazy_quality)
+    obj.lazy_quality = False
+    self.assertEqual(False, obj.lazy_quality)
   
   def test_elangle(self):
     obj = _pycomposite.new()
@@ -891,6 +904,41 @@ class PyCompositeTest(unittest.TestCase):
     ios.filename = "swecomposite_with_index.h5"
     ios.save()
   
+  def test_generateToFile(self):
+    generator = _pycomposite.new()
+
+    a = _area.new()
+    a.id = "nrd2km"
+    a.xsize = 848
+    a.ysize = 1104
+    a.xscale = 2000.0
+    a.yscale = 2000.0
+    a.extent = (-738816.513333,-3995515.596160,955183.48666699999,-1787515.59616)
+    a.projection = _projection.new("x", "y", "+proj=stere +ellps=bessel +lat_0=90 +lon_0=14 +lat_ts=60 +datum=WGS84")
+
+    for fname in self.SWEDISH_VOLUMES:
+      generator.add(_raveio.open(fname).object)
+
+    generator.addParameter("DBZH", 1.0, 0.0, -30.0)
+    generator.product = _rave.Rave_ProductType_PCAPPI
+    generator.height = 1000.0
+    generator.time = "120000"
+    generator.date = "20090501"
+
+    expected = generator.generate(a, ["se.smhi.composite.distance.radar"])
+    generator.generateToFile(a, ["se.smhi.composite.distance.radar"], self.TEMPORARY_FILE, 100)
+
+    result = _raveio.open(self.TEMPORARY_FILE).object
+    self.assertEqual(848, result.xsize)
+    self.assertEqual(1104, result.ysize)
+    self.assertAlmostEqual(expected.areaextent[1], result.areaextent[1], 2)
+    self.assertAlmostEqual(expected.areaextent[3], result.areaextent[3], 2)
+    self.assertEqual("nrd2km", result.source)
+    self.assertTrue(numpy.array_equal(expected.getParameter("DBZH").getData(), result.getParameter("DBZH").getData()))
+    ef = expected.getParameter("DBZH").getQualityFieldByHowTask("se.smhi.composite.distance.radar")
+    rf = result.getParameter("DBZH").getQualityFieldByHowTask("se.smhi.composite.distance.radar")
+    self.assertTrue(numpy.array_equal(ef.getData(), rf.getData()))
+
   def test_nearest_with_reversed_radarindex(self):
     generator = _pycomposite.new()
       
@@ -1101,6 +1149,279 @@ class PyCompositeTest(unittest.TestCase):
     generator.algorithm = _poocompositealgorithm.new()
     result = generator.generate(a, ["se.smhi.detector.poo", "qf"])
   
+  def create_vertical_area(self):
+    a = _area.new()
+    a.id = "test10km"
+    a.xsize = 23
+    a.ysize = 19
+    a.xscale = 10000.0
+    a.yscale = 10000.0
+    a.extent = (1229430.993379, 8300379.564361, 1459430.993379, 8490379.564361)
+    a.projection = _projection.new("x", "y", "+proj=merc +lat_ts=0 +lon_0=0 +k=1.0 +R=6378137.0 +nadgrids=@null +no_defs")
+    return a
+
+  def create_vertical_volume(self, lon, src):
+    v = _polarvolume.new()
+    v.longitude = lon
+    v.latitude = 60.0*math.pi/180.0
+    v.height = 0.0
+    v.source = src
+    v.addScan(self.create_simple_scan((4,4), "DBZH", 30, {}, 0.5 * math.pi / 180.0, lon, 60.0*math.pi/180.0, 0.0, src))
+    v.addScan(self.create_simple_scan((4,4), "DBZH", 25, {}, 10.0 * math.pi / 180.0, lon, 60.0*math.pi/180.0, 0.0, src))
+    return v
+
+  def create_vertical_generator(self, product):
+    generator = _pycomposite.new()
+    generator.add(self.create_vertical_volume(12.0*math.pi/180.0, "NOD:se1"))
+    generator.add(self.create_vertical_volume(12.1*math.pi/180.0, "NOD:sek"))
+    generator.product = product
+    generator.time = "120000"
+    generator.date = "20090501"
+    return generator
+
+  def test_etop(self):
+    generator = self.create_vertical_generator(_rave.Rave_ProductType_ETOP)
+    generator.addParameter("DBZH", 0.01, 0.0, 0.0)
+    generator.etop_threshold = 20.0
+    self.assertAlmostEqual(20.0, generator.etop_threshold, 4)
+    result = generator.generate(self.create_vertical_area(), [])
+
+    self.assertEqual(_rave.Rave_ProductType_ETOP, result.product)
+    self.assertAlmostEqual(20.0, result.getAttribute("what/prodpar"), 4)
+    self.assertEqual(None, result.getParameter("DBZH"))
+    param = result.getParameter("HGHT")
+    # Close to the radars the echo top is the upper elevation, about 5 km * tan(10) above the radar
+    t, v = param.getConvertedValue(10, 9)
+    self.assertEqual(_rave.RaveValueType_DATA, t)
+    self.assertTrue(v > 0.5 and v < 1.5)
+    # Outside the radars
+    self.assertEqual(_rave.RaveValueType_NODATA, param.getConvertedValue(0, 0)[0])
+
+    generator.etop_threshold = 40.0
+    result = generator.generate(self.create_vertical_area(), [])
+    self.assertEqual(_rave.RaveValueType_UNDETECT, result.getParameter("HGHT").getConvertedValue(10, 9)[0])
+
+  def test_vil(self):
+    generator = self.create_vertical_generator(_rave.Rave_ProductType_VIL)
+    generator.addParameter("DBZH", 0.1, 0.0, 0.0)
+    result = generator.generate(self.create_vertical_area(), [])
+
+    self.assertEqual(_rave.Rave_ProductType_VIL, result.product)
+    t, v = result.getParameter("VIL").getConvertedValue(10, 9)
+    self.assertEqual(_rave.RaveValueType_DATA, t)
+    self.assertTrue(v > 0.0)
+    self.assertEqual(_rave.RaveValueType_NODATA, result.getParameter("VIL").getConvertedValue(0, 0)[0])
+
+  def test_vertical_is_same_for_threads(self):
+    generator = self.create_vertical_generator(_rave.Rave_ProductType_ETOP)
+    generator.addParameter("DBZH", 0.01, 0.0, 0.0)
+    self.assertEqual(1, generator.nthreads)
+    r1 = generator.generate(self.create_vertical_area(), [])
+    generator.nthreads = 4
+    self.assertEqual(4, generator.nthreads)
+    r2 = generator.generate(self.create_vertical_area(), [])
+    self.assertTrue(numpy.array_equal(r1.getParameter("HGHT").getData(), r2.getParameter("HGHT").getData()))
+    try:
+      generator.nthreads = 0
+      self.fail("Expected ValueError")
+    except ValueError:
+      pass
+
+  def test_vertical_requires_one_parameter(self):
+    generator = self.create_vertical_generator(_rave.Rave_ProductType_VIL)
+    generator.addParameter("DBZH", 0.1, 0.0, 0.0)
+    generator.addParameter("TH", 0.1, 0.0, 0.0)
+    try:
+      generator.generate(self.create_vertical_area(), [])
+      self.fail("Expected Exception")
+    except Exception:
+      pass
+
+  def test_nearest_poo_quality_row(self):
+    a = _area.new()
+    a.id = "test10km"
+    a.xsize = 23
+    a.ysize = 19
+    a.xscale = 10000.0
+    a.yscale = 10000.0
+    a.extent = (1229430.993379, 8300379.564361, 1459430.993379, 8490379.564361)
+    a.projection = _projection.new("x", "y", "+proj=merc +lat_ts=0 +lon_0=0 +k=1.0 +R=6378137.0 +nadgrids=@null +no_defs")
+
+    s1 = self.create_simple_scan((4,4), "DBZH", 5, {"se.smhi.detector.poo": 0.4}, 0.1 * math.pi / 180.0, 12.0*math.pi/180.0, 60.0*math.pi/180.0, 0.0, "NOD:se1")
+    s2 = self.create_simple_scan((4,4), "DBZH", 10, {}, 0.2 * math.pi / 180.0, 12.0*math.pi/180.0, 60.0*math.pi/180.0, 0.0, "NOD:se1")
+    v1 = _polarvolume.new()
+    v1.longitude = 12.0*math.pi/180.0
+    v1.latitude = 60.0*math.pi/180.0
+    v1.height = 0.0
+    v1.source = "NOD:se1"
+    v1.addScan(s1)
+    v1.addScan(s2)
+
+    generator = _pycomposite.new()
+    generator.add(v1)
+    generator.addParameter("DBZH", 1.0, 0.0, -30.0)
+    generator.product = _rave.Rave_ProductType_PCAPPI
+    generator.height = 1000.0
+    generator.range = 0.0
+    generator.time = "120000"
+    generator.date = "20090501"
+    generator.algorithm = _poocompositealgorithm.new()
+    result = generator.generate(a, ["se.smhi.detector.poo"])
+
+    param = result.getParameter("DBZH")
+    field = param.getQualityFieldByHowTask("se.smhi.detector.poo")
+    gain = field.getAttribute("what/gain")
+    ndata = 0
+    for y in range(a.ysize):
+      for x in range(a.xsize):
+        t, v = param.getValue((x, y))
+        if t == _rave.RaveValueType_DATA or t == _rave.RaveValueType_UNDETECT:
+          ndata = ndata + 1
+          self.assertAlmostEqual(0.4, field.getValue(x, y)[1] * gain, 1)
+        else:
+          self.assertAlmostEqual(0.0, field.getValue(x, y)[1], 4)
+    self.assertTrue(ndata > 0)
+
+  def create_products_generator(self):
+    s1 = self.create_simple_scan((4,4), "DBZH", 5, {"qf":0.6}, 0.1 * math.pi / 180.0, 12.0*math.pi/180.0, 60.0*math.pi/180.0, 0.0, "NOD:se1")
+    s2 = self.create_simple_scan((4,4), "DBZH", 10, {"qf":0.5}, 0.5 * math.pi / 180.0, 12.0*math.pi/180.0, 60.0*math.pi/180.0, 0.0, "NOD:se1")
+    v1 = _polarvolume.new()
+    v1.longitude = 12.0*math.pi/180.0
+    v1.latitude = 60.0*math.pi/180.0
+    v1.height = 0.0
+    v1.source = "NOD:se1"
+    v1.addScan(s1)
+    v1.addScan(s2)
+
+    s3 = self.create_simple_scan((4,4), "DBZH", 20, {"qf":0.4}, 0.1 * math.pi / 180.0, 12.3*math.pi/180.0, 60.0*math.pi/180.0, 0.0, "NOD:sek")
+    generator = _pycomposite.new()
+    generator.add(v1)
+    generator.add(s3)
+    generator.addParameter("DBZH", 1.0, 0.0, -30.0)
+    generator.time = "120000"
+    generator.date = "20090501"
+    return generator
+
+  def test_generateProducts(self):
+    a = _area.new()
+    a.id = "test10km"
+    a.xsize = 23
+    a.ysize = 19
+    a.xscale = 10000.0
+    a.yscale = 10000.0
+    a.extent = (1229430.993379, 8300379.564361, 1459430.993379, 8490379.564361)
+    a.projection = _projection.new("x", "y", "+proj=merc +lat_ts=0 +lon_0=0 +k=1.0 +R=6378137.0 +nadgrids=@null +no_defs")
+    definitions = [(_rave.Rave_ProductType_PCAPPI, 500.0),
+                   (_rave.Rave_ProductType_PCAPPI, 500.0, _pycomposite.SelectionMethod_HEIGHT),
+                   (_rave.Rave_ProductType_PCAPPI, 1000.0, _pycomposite.SelectionMethod_HEIGHT),
+                   (_rave.Rave_ProductType_PPI, 0.5 * math.pi / 180.0),
+                   (_rave.Rave_ProductType_MAX, 0.0)]
+
+    generator = self.create_products_generator()
+    height, elangle, method = generator.height, generator.elangle, generator.selection_method
+    results = generator.generateProducts(a, definitions, ["se.smhi.composite.distance.radar", "qf"])
+    self.assertEqual(len(definitions), len(results))
+    # The settings of the generator are not touched
+    self.assertEqual(_rave.Rave_ProductType_PCAPPI, generator.product)
+    self.assertAlmostEqual(height, generator.height, 4)
+    self.assertAlmostEqual(elangle, generator.elangle, 4)
+    self.assertEqual(method, generator.selection_method)
+
+    for d, result in zip(definitions, results):
+      expected_generator = self.create_products_generator()
+      expected_generator.product = d[0]
+      if d[0] == _rave.Rave_ProductType_PPI:
+        expected_generator.elangle = d[1]
+      else:
+        expected_generator.height = d[1]
+      if len(d) > 2:
+        expected_generator.selection_method = d[2]
+      expected = expected_generator.generate(a, ["se.smhi.composite.distance.radar", "qf"])
+      self.assertEqual(expected.product, result.product)
+      self.assertTrue(numpy.array_equal(expected.getParameter("DBZH").getData(), result.getParameter("DBZH").getData()))
+      for how_task in ["se.smhi.composite.distance.radar", "qf"]:
+        self.assertTrue(numpy.array_equal(expected.getParameter("DBZH").getQualityFieldByHowTask(how_task).getData(),
+                                          result.getParameter("DBZH").getQualityFieldByHowTask(how_task).getData()))
+
+  def test_generateProducts_bad_definition(self):
+    a = _area.new()
+    generator = self.create_products_generator()
+    try:
+      generator.generateProducts(a, [(_rave.Rave_ProductType_PCAPPI,)])
+      self.fail("Expected AttributeError")
+    except AttributeError:
+      pass
+
+  def test_generateCappiVolume(self):
+    a = _area.new()
+    a.id = "test10km"
+    a.xsize = 23
+    a.ysize = 19
+    a.xscale = 10000.0
+    a.yscale = 10000.0
+    a.extent = (1229430.993379, 8300379.564361, 1459430.993379, 8490379.564361)
+    a.projection = _projection.new("x", "y", "+proj=merc +lat_ts=0 +lon_0=0 +k=1.0 +R=6378137.0 +nadgrids=@null +no_defs")
+    heights = [500.0, 1000.0, 1500.0]
+
+    generator = self.create_products_generator()
+    result = generator.generateCappiVolume(a, _rave.Rave_ProductType_PCAPPI, heights)
+    self.assertEqual(_rave.Rave_ObjectType_CVOL, result.objectType)
+    self.assertEqual(len(heights), result.getNumberOfImages())
+    self.assertAlmostEqual(500.0, result.zstart, 4)
+    self.assertAlmostEqual(500.0, result.zscale, 4)
+    self.assertEqual("20090501", result.date)
+    self.assertEqual("120000", result.time)
+
+    for i, h in enumerate(heights):
+      expected_generator = self.create_products_generator()
+      expected_generator.product = _rave.Rave_ProductType_PCAPPI
+      expected_generator.height = h
+      expected = expected_generator.generate(a)
+      self.assertTrue(numpy.array_equal(expected.getParameter("DBZH").getData(), result.getImage(i).getParameter("DBZH").getData()))
+
+  def test_generateCappiVolume_bad_product(self):
+    a = _area.new()
+    generator = self.create_products_generator()
+    try:
+      generator.generateCappiVolume(a, _rave.Rave_ProductType_PPI, [500.0, 1000.0])
+      self.fail("Expected AttributeError")
+    except AttributeError:
+      pass
+
+  def test_generateMany(self):
+    areas = []
+    for i, scale in enumerate([10000.0, 5000.0, 20000.0]):
+      a = _area.new()
+      a.id = "test%d"%i
+      a.xsize = int(230000.0 / scale)
+      a.ysize = int(190000.0 / scale)
+      a.xscale = scale
+      a.yscale = scale
+      a.extent = (1229430.993379, 8300379.564361, 1229430.993379 + a.xsize * scale, 8300379.564361 + a.ysize * scale)
+      a.projection = _projection.new("x", "y", "+proj=merc +lat_ts=0 +lon_0=0 +k=1.0 +R=6378137.0 +nadgrids=@null +no_defs")
+      areas.append(a)
+
+    generator = self.create_products_generator()
+    results = generator.generateMany(areas, ["se.smhi.composite.distance.radar", "qf"], 3)
+    self.assertEqual(len(areas), len(results))
+
+    for a, result in zip(areas, results):
+      expected = self.create_products_generator().generate(a, ["se.smhi.composite.distance.radar", "qf"])
+      self.assertEqual(a.xsize, result.xsize)
+      self.assertEqual(a.ysize, result.ysize)
+      self.assertTrue(numpy.array_equal(expected.getParameter("DBZH").getData(), result.getParameter("DBZH").getData()))
+      for how_task in ["se.smhi.composite.distance.radar", "qf"]:
+        self.assertTrue(numpy.array_equal(expected.getParameter("DBZH").getQualityFieldByHowTask(how_task).getData(),
+                                          result.getParameter("DBZH").getQualityFieldByHowTask(how_task).getData()))
+
+  def test_generateMany_bad_areas(self):
+    generator = self.create_products_generator()
+    try:
+      generator.generateMany([_area.new(), "nisse"])
+      self.fail("Expected AttributeError")
+    except AttributeError:
+      pass
+
   def test_nearest_max_polgmaps(self):
     a = _area.new()
     a.id = "polgmaps_2000"
@@ -1624,6 +1945,73 @@ class PyCompositeTest(unittest.TestCase):
     ios.filename = "swecomposite_pvols_qfields.h5"
     ios.save()
  
+  def create_lazy_quality_generator(self, objects):
+    generator = _pycomposite.new()
+    for o in objects:
+      generator.add(o)
+    generator.addParameter("DBZH", 1.0, 0.0, -30.0)
+    generator.product = _rave.Rave_ProductType_PPI
+    generator.elangle = 0.0
+    generator.time = "120000"
+    generator.date = "20090501"
+    return generator
+
+  def create_nrd2km_area(self):
+    a = _area.new()
+    a.id = "nrd2km"
+    a.xsize = 848
+    a.ysize = 1104
+    a.xscale = 2000.0
+    a.yscale = 2000.0
+    a.extent = (-738816.513333,-3995515.596160,955183.48666699999,-1787515.59616)
+    a.projection = _projection.new("x", "y", "+proj=stere +ellps=bessel +lat_0=90 +lon_0=14 +lat_ts=60 +datum=WGS84")
+    return a
+
+  def assert_same_quality_fields(self, expected, result, flags):
+    self.assertTrue(numpy.array_equal(expected.getParameter("DBZH").getData(), result.getParameter("DBZH").getData()))
+    for flag in flags:
+      ef = expected.getParameter("DBZH").getQualityFieldByHowTask(flag)
+      rf = result.getParameter("DBZH").getQualityFieldByHowTask(flag)
+      self.assertEqual(ef.getAttribute("what/gain"), rf.getAttribute("what/gain"))
+      self.assertEqual(ef.xsize, rf.xsize)
+      self.assertTrue(numpy.array_equal(ef.getData(), rf.getData()), flag)
+
+  def test_quality_fields_for_pvols_lazy_quality(self):
+    a = self.create_nrd2km_area()
+    generator = self.create_lazy_quality_generator([_raveio.open(fname).object for fname in self.QC_VOLUMES_2016])
+    # The same quality flags as a normal product from these volumes
+    flags = ["fi.fmi.ropo.detector.classification", "se.smhi.detector.poo", "se.smhi.detector.beamblockage",
+             "se.smhi.composite.distance.radar", "se.smhi.composite.height.radar", "se.smhi.composite.index.radar"]
+    expected = generator.generate(a, flags)
+    generator.lazy_quality = True
+    result = generator.generate(a, flags)
+
+    self.assert_same_quality_fields(expected, result, flags)
+    self.assertEqual(expected.getParameter("DBZH").getQualityFieldByHowTask("se.smhi.composite.index.radar").getAttribute("how/task_args"),
+                     result.getParameter("DBZH").getQualityFieldByHowTask("se.smhi.composite.index.radar").getAttribute("how/task_args"))
+
+  def test_quality_fields_for_pvols_lazy_quality_inputs_changed(self):
+    a = self.create_nrd2km_area()
+    volumes = [_raveio.open(fname).object for fname in self.QC_VOLUMES_2016]
+    generator = self.create_lazy_quality_generator(volumes)
+    flags = ["fi.fmi.ropo.detector.classification", "se.smhi.detector.beamblockage", "se.smhi.composite.distance.radar"]
+    expected = generator.generate(a, flags)
+    generator.lazy_quality = True
+    result = generator.generate(a, flags)
+
+    # Changing the inputs after the generation must not affect the fields that have not been derived yet
+    for vol in volumes:
+      for i in range(vol.getNumberOfScans()):
+        scan = vol.getScan(i)
+        fields = [scan.getQualityField(j) for j in range(scan.getNumberOfQualityFields())]
+        param = scan.getParameter("DBZH")
+        if param is not None:
+          fields += [param.getQualityField(j) for j in range(param.getNumberOfQualityFields())]
+        for f in fields:
+          f.setData(numpy.zeros((f.ysize, f.xsize), f.getData().dtype))
+
+    self.assert_same_quality_fields(expected, result, flags)
+
   def test_cappi_for_unsorted_volume(self):
     generator = _pycomposite.new()
     a = _area.new()
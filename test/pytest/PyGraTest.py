@@ -43,7 +43,7 @@ class PyGraTest(unittest.TestCase):
     self.assertNotEqual(-1, str(type(obj)).find("GraCore"))
 
   def test_attribute_visibility(self):
-    attrs = ['A', 'B', 'C', 'upperThreshold', 'lowerThreshold', 'zrA', 'zrb']
+    attrs = ['A', 'B', 'C', 'upperThreshold', 'lowerThreshold', 'zrA', 'zrb', 'nthreads']
     gra = _gra.new()
     alist = dir(gra)
     for a in attrs:
@@ -104,7 +104,19 @@ class PyGraTest(unittest.TestCase):
     self.assertAlmostEqual(10.0, gra.zrb, 4)
     gra.zrb = 11.1
     self.assertAlmostEqual(11.1, gra.zrb, 4)
-     
+
+  def test_nthreads(self):
+    gra = _gra.new()
+    self.assertEqual(1, gra.nthreads)
+    gra.nthreads = 3
+    self.assertEqual(3, gra.nthreads)
+    try:
+      gra.nthreads = 0
+      self.fail("Expected ValueError")
+    except ValueError:
+      pass
+    self.assertEqual(3, gra.nthreads)
+
   def test_apply(self):
     distance = _ravefield.new()
     distance.setData(numpy.zeros((2,2), numpy.float64))
@@ -195,3 +207,40 @@ class PyGraTest(unittest.TestCase):
     result = gra.apply(distance, param)
      
     self.assertAlmostEqual(79.23, result.getValue((0,0))[1], 2)
+
+  def test_apply_distance_types_and_threads(self):
+    rawdist = numpy.fromfunction(lambda y, x: (x + 2*y) % 200, (40, 50)).astype(numpy.uint8)
+    data = numpy.fromfunction(lambda y, x: (3*x + y) % 250, (40, 50)).astype(numpy.uint8)
+    data[0,0:5] = 255
+    data[1,0:5] = 0
+
+    def create_distance(dtype):
+      distance = _ravefield.new()
+      distance.setData(rawdist.astype(dtype))
+      distance.addAttribute("what/gain", 1000.0)
+      distance.addAttribute("what/offset", 0.0)
+      return distance
+
+    param = _cartesianparam.new()
+    param.setData(data)
+    param.quantity = "DBZH"
+    param.gain = 0.4
+    param.offset = -30.0
+    param.nodata = 255.0
+    param.undetect = 0.0
+
+    gra = _gra.new()
+    gra.A = 0.323868
+    gra.B = -0.001078
+    gra.C = 0.000018
+
+    gra.nthreads = 1
+    expected = gra.apply(create_distance(numpy.float64), param).getData()
+    for nthreads in [1, 4]:
+      for dtype in [numpy.uint8, numpy.uint16, numpy.float32]:
+        gra.nthreads = nthreads
+        result = gra.apply(create_distance(dtype), param).getData()
+        self.assertTrue(numpy.array_equal(expected, result))
+
+    self.assertTrue(numpy.array_equal(data[0:2,0:5], expected[0:2,0:5]))
+    self.assertFalse(numpy.array_equal(data, expected))
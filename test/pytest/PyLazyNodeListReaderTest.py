@@ -27,6 +27,12 @@ Tests the PyLazyNodeListIO module.
 import unittest
 import os
 import _lazynodelistreader
+import _raveio
+import _rave
+import _cartesian
+import _cartesianparam
+import _projection
+import _ravefield
 import string
 import numpy
 import math
@@ -110,3 +116,62 @@ class PyLazyNodeListReaderTest(unittest.TestCase):
     self.assertFalse(obj.isLoaded("/dataset1/data1/data"))
     self.assertTrue(obj.isLoaded("/dataset1/data2/data"))
 
+  def test_preload_cartesian_quality_by_howtask(self):
+    self.create_cartesian_with_quality().save(self.TEMPORARY_FILE)
+
+    obj = _lazynodelistreader.read(self.TEMPORARY_FILE)
+    obj.preload("DBZH,se.smhi.composite.distance.radar")
+    self.assertTrue(obj.isLoaded("/dataset1/data1/data"))
+    self.assertTrue(obj.isLoaded("/dataset1/data1/quality1/data"))
+    self.assertFalse(obj.isLoaded("/dataset1/data1/quality2/data"))
+    self.assertFalse(obj.isLoaded("/dataset1/data2/data"))
+    self.assertFalse(obj.isLoaded("/dataset1/data2/quality1/data"))
+    self.assertTrue(obj.isLoaded("/dataset1/quality1/data"))
+    self.assertFalse(obj.isLoaded("/dataset1/quality2/data"))
+
+  def test_preload_cartesian_quality_all(self):
+    self.create_cartesian_with_quality().save(self.TEMPORARY_FILE)
+
+    obj = _lazynodelistreader.read(self.TEMPORARY_FILE)
+    obj.preload()
+    self.assertTrue(obj.isLoaded("/dataset1/data1/quality2/data"))
+    self.assertTrue(obj.isLoaded("/dataset1/data2/data"))
+    self.assertTrue(obj.isLoaded("/dataset1/quality2/data"))
+
+  def create_quality_field(self, task, value):
+    field = _ravefield.new()
+    field.addAttribute("how/task", task)
+    field.setData(numpy.zeros((10,10), numpy.uint8) + value)
+    return field
+
+  def create_cartesian_with_quality(self):
+    image = _cartesian.new()
+    image.time = "100000"
+    image.date = "20100101"
+    image.objectType = _rave.Rave_ObjectType_IMAGE
+    image.source = "PLC:123"
+    image.xscale = 2000.0
+    image.yscale = 2000.0
+    image.areaextent = (-10000.0, -10000.0, 10000.0, 10000.0)
+    image.projection = _projection.new("x","y","+proj=gnom +R=6371000.0 +lat_0=56.3675 +lon_0=12.8544 +datum=WGS84 +nadgrids=@null")
+    image.product = _rave.Rave_ProductType_COMP
+
+    for quantity in ["DBZH", "TH"]:
+      param = _cartesianparam.new()
+      param.quantity = quantity
+      param.gain = 1.0
+      param.offset = 0.0
+      param.nodata = 255.0
+      param.undetect = 0.0
+      param.setData(numpy.zeros((10,10), numpy.uint8))
+      param.addQualityField(self.create_quality_field("se.smhi.composite.distance.radar", 1))
+      param.addQualityField(self.create_quality_field("se.smhi.composite.height.radar", 2))
+      image.addParameter(param)
+
+    image.addQualityField(self.create_quality_field("se.smhi.composite.distance.radar", 3))
+    image.addQualityField(self.create_quality_field("pl.imgw.quality.qi_total", 4))
+
+    rio = _raveio.new()
+    rio.object = image
+    return rio
+
@@ -26,6 +26,7 @@ Tests the polarscanparam module.
 import unittest
 import os
 import _polarscanparam
+import _ravedata2d
 import _rave
 import _ravefield
 import string
@@ -568,7 +569,37 @@ class PyPolarScanParamTest(unittest.TestCase):
     self.assertEqual(obj.offset, c.offset)
     self.assertEqual(obj.nodata, c.nodata)
     self.assertAlmostEqual(123.0, c.getAttribute("how/nisse"), 4)
-    
+
+  def test_clone_copy_on_write(self):
+    obj = _polarscanparam.new()
+    a = numpy.reshape(numpy.arange(30).astype(numpy.uint8), (5,6))
+    obj.setData(a)
+
+    _ravedata2d.resetStatistics()
+    c = obj.clone()
+    self.assertEqual(0, _ravedata2d.materializedBytes())
+    self.assertEqual(30, _ravedata2d.sharedBytes())
+    self.assertTrue(obj.getData2D().shared)
+
+    # Reading does not copy the data
+    self.assertTrue(numpy.array_equal(a, c.getData()))
+    self.assertEqual(0, _ravedata2d.materializedBytes())
+
+    # Writing to the clone copies it
+    c.setValue((1,2), 99.0)
+    self.assertEqual(30, _ravedata2d.materializedBytes())
+    self.assertEqual(99.0, c.getValue(1,2)[1])
+    self.assertEqual(13.0, obj.getValue(1,2)[1])
+    self.assertTrue(numpy.array_equal(a, obj.getData()))
+
+    # The original is no longer shared with the clone
+    d = obj.getData2D()
+    d = None
+    obj.setValue((0,0), 7.0)
+    self.assertEqual(30, _ravedata2d.materializedBytes())
+    self.assertEqual(7.0, obj.getValue(0,0)[1])
+    self.assertEqual(0.0, c.getValue(0,0)[1])
+
 if __name__ == "__main__":
   #import sys;sys.argv = ['', 'Test.testName']
   unittest.main()
\ No newline at end of file
@@ -28,6 +28,7 @@ import os
 import _polarvolume
 import _polarscan
 import _polarscanparam
+import _ravefield
 import _rave
 import _polarnav
 import string
@@ -546,6 +547,51 @@ class PyPolarVolumeTest(unittest.TestCase):
     self.assertEqual(_rave.RaveValueType_NODATA, t)
 
 
+  def test_getNearestValuesAtLonLats(self):
+    obj = _polarvolume.new()
+    obj.longitude = 12.0 * math.pi/180.0
+    obj.latitude = 60.0 * math.pi/180.0
+    obj.height = 0.0
+    for i, elangle in enumerate([0.1, 1.0]):
+      scan = _polarscan.new()
+      scan.elangle = elangle * math.pi / 180.0
+      scan.rstart = 0.0
+      scan.rscale = 5000.0
+      param = _polarscanparam.new()
+      param.nodata = 10.0
+      param.undetect = 11.0
+      param.quantity = "DBZH"
+      param.offset = 1.0 + 2*i
+      param.gain = 2.0 + 2*i
+      data = numpy.ones((100, 120), numpy.uint8) + i
+      param.setData(data)
+      qfield = _ravefield.new()
+      qfield.addAttribute("how/task", "se.task.1")
+      qfield.addAttribute("what/gain", 0.5)
+      qfield.setData(numpy.ones((100, 120), numpy.uint8) * (10 + i))
+      param.addQualityField(qfield)
+      scan.addParameter(param)
+      obj.addScan(scan)
+
+    lonlats = [(12.0, 60.45), (12.0, 62.0), (12.5, 60.2)]
+    lons = numpy.array([x[0]*math.pi/180.0 for x in lonlats])
+    lats = numpy.array([x[1]*math.pi/180.0 for x in lonlats])
+    for insidee in [0, 1]:
+      values, types, qualities = obj.getNearestValuesAtLonLats("DBZH", lons, lats, 1000.0, insidee, "se.task.1")
+      for i, ll in enumerate(lonlats):
+        t, v = obj.getNearestConvertedParameterValue("DBZH", (ll[0]*math.pi/180.0, ll[1]*math.pi/180.0), 1000.0, insidee)
+        self.assertEqual(t, types[i])
+        self.assertAlmostEqual(v, values[i], 4)
+        if t == _rave.RaveValueType_DATA:
+          self.assertTrue(qualities[i] in [5.0, 5.5])
+        else:
+          self.assertTrue(math.isnan(qualities[i]))
+
+    values, types, qualities = obj.getNearestValuesAtLonLats("DBZH", lons, lats, 1000.0, 0)
+    self.assertTrue(numpy.all(numpy.isnan(qualities)))
+    values, types, qualities = obj.getNearestValuesAtLonLats("TH", lons, lats, 1000.0, 0)
+    self.assertTrue(numpy.all(types == _rave.RaveValueType_UNDEFINED))
+
   def test_paramname(self):
     obj = _polarvolume.new()
     self.assertEqual("DBZH", obj.paramname)
@@ -765,6 +811,136 @@ class PyPolarVolumeTest(unittest.TestCase):
     self.assertEqual(stype, type)
     self.assertAlmostEqual(svalue, value, 4)
 
+  def create_cube_scan(self, elangle, data):
+    scan = _polarscan.new()
+    scan.longitude = 12.0 * math.pi / 180.0
+    scan.latitude = 60.0 * math.pi / 180.0
+    scan.height = 0.0
+    scan.rscale = 1000.0
+    scan.elangle = elangle * math.pi / 180.0
+    param = _polarscanparam.new()
+    param.quantity = "DBZH"
+    param.gain = 0.5
+    param.offset = -32.0
+    param.nodata = 255.0
+    param.undetect = 0.0
+    param.setData(data)
+    scan.addParameter(param)
+    return scan
+
+  def create_cube_volume(self):
+    d1 = numpy.zeros((4, 10), numpy.uint8)
+    d1[:,:] = 100   # 18 dBZ
+    d1[3,:] = 255
+    d2 = numpy.zeros((4, 10), numpy.uint8)
+    d2[:,:] = 120   # 28 dBZ
+    d2[0,:] = 0
+    d2[3,:] = 255
+    obj = _polarvolume.new()
+    obj.longitude = 12.0 * math.pi / 180.0
+    obj.latitude = 60.0 * math.pi / 180.0
+    obj.height = 0.0
+    obj.addScan(self.create_cube_scan(1.0, d2))
+    obj.addScan(self.create_cube_scan(0.5, d1))
+    return obj
+
+  def test_getCube(self):
+    cube = self.create_cube_volume().getCube("DBZH")
+    self.assertEqual("DBZH", cube.quantity)
+    self.assertEqual(2, cube.nelevations)
+    self.assertEqual(4, cube.nrays)
+    self.assertEqual(10, cube.nbins)
+    self.assertAlmostEqual(0.5 * math.pi / 180.0, cube.elangles[0], 6)
+    self.assertAlmostEqual(1.0 * math.pi / 180.0, cube.elangles[1], 6)
+
+    values = cube.getValues()
+    types = cube.getTypes()
+    self.assertEqual((2, 4, 10), values.shape)
+    self.assertEqual((2, 4, 10), types.shape)
+    self.assertEqual((2, 10), cube.getHeights().shape)
+    self.assertEqual((2, 10), cube.getRanges().shape)
+
+    self.assertEqual((_rave.RaveValueType_DATA, 18.0), cube.getValue(0, 0, 5))
+    self.assertEqual((_rave.RaveValueType_UNDETECT, 0.0), cube.getValue(1, 0, 5))
+    self.assertEqual((_rave.RaveValueType_DATA, 28.0), cube.getValue(1, 1, 9))
+    self.assertEqual(_rave.RaveValueType_NODATA, cube.getValue(0, 3, 0)[0])
+    self.assertEqual(_rave.RaveValueType_UNDEFINED, cube.getValue(2, 0, 0)[0])
+
+    heights = cube.getHeights()
+    for b in range(10):
+      self.assertTrue(heights[1][b] > heights[0][b])
+
+  def test_getCube_nrays_nbins(self):
+    cube = self.create_cube_volume().getCube("DBZH", 8, 20)
+    self.assertEqual(8, cube.nrays)
+    self.assertEqual(20, cube.nbins)
+    self.assertEqual((2, 8, 20), cube.getValues().shape)
+
+  def test_getCube_noSuchQuantity(self):
+    try:
+      self.create_cube_volume().getCube("TH")
+      self.fail("Expected ValueError")
+    except ValueError:
+      pass
+
+  def test_cube_max(self):
+    cube = self.create_cube_volume().getCube("DBZH")
+    result = cube.max(-1.0, -2.0)
+    self.assertEqual((4, 10), result.shape)
+    for b in range(10):
+      self.assertAlmostEqual(18.0, result[0][b], 4)
+      self.assertAlmostEqual(28.0, result[1][b], 4)
+      self.assertAlmostEqual(28.0, result[2][b], 4)
+      self.assertAlmostEqual(-1.0, result[3][b], 4)
+
+  def test_cube_echoTop(self):
+    cube = self.create_cube_volume().getCube("DBZH")
+    heights = cube.getHeights()
+    result = cube.echoTop(20.0, -1.0, -2.0)
+    for b in range(10):
+      self.assertAlmostEqual(-2.0, result[0][b], 4)
+      self.assertAlmostEqual(heights[1][b], result[1][b], 4)
+      self.assertAlmostEqual(-1.0, result[3][b], 4)
+
+    result = cube.echoTop(10.0, -1.0, -2.0)
+    for b in range(10):
+      self.assertAlmostEqual(heights[0][b], result[0][b], 4)
+
+  def test_cube_vil(self):
+    cube = self.create_cube_volume().getCube("DBZH")
+    heights = cube.getHeights()
+    result = cube.vil(-1.0, -2.0)
+    z18 = math.pow(10.0, 1.8)
+    z28 = math.pow(10.0, 2.8)
+    for b in range(10):
+      dh = heights[1][b] - heights[0][b]
+      self.assertAlmostEqual(3.44e-6 * math.pow(z18 / 2.0, 4.0/7.0) * dh, result[0][b], 6)
+      self.assertAlmostEqual(3.44e-6 * math.pow((z18 + z28) / 2.0, 4.0/7.0) * dh, result[1][b], 6)
+      self.assertAlmostEqual(-1.0, result[3][b], 4)
+
+  def test_cube_vil_caps_hail(self):
+    volume = self.create_cube_volume()
+    for i in range(volume.getNumberOfScans()):
+      if abs(volume.getScan(i).elangle - 0.5 * math.pi / 180.0) < 1e-6:
+        volume.getScan(i).getParameter("DBZH").setValue((0, 1), 240) # 88 dBZ
+    cube = volume.getCube("DBZH")
+    heights = cube.getHeights()
+    result = cube.vil(-1.0, -2.0)
+    z28 = math.pow(10.0, 2.8)
+    z56 = math.pow(10.0, 5.6)
+    dh = heights[1][0] - heights[0][0]
+    self.assertAlmostEqual(3.44e-6 * math.pow((z56 + z28) / 2.0, 4.0/7.0) * dh, result[1][0], 6)
+
+  def test_cube_lowest(self):
+    cube = self.create_cube_volume().getCube("DBZH")
+    heights = cube.getHeights()
+    values, hresult = cube.lowest(-1.0, -2.0)
+    for b in range(10):
+      self.assertAlmostEqual(18.0, values[0][b], 4)
+      self.assertAlmostEqual(heights[0][b], hresult[0][b], 4)
+      self.assertAlmostEqual(-1.0, values[3][b], 4)
+      self.assertAlmostEqual(-1.0, hresult[3][b], 4)
+
   def test_getDistanceField(self):
     polnav = _polarnav.new()
     polnav.lat0 = 60.0 * math.pi / 180.0
@@ -5,6 +5,7 @@ Created on Jul 5, 2010
 '''
 import unittest
 import _ravedata2d
+import _rave
 import string
 import numpy
 
@@ -267,6 +268,23 @@ class PyRaveRaveData2DTest(unittest.TestCase):
     obj.circshiftData(-1,0)
     self.assertTrue((numpy.array([[1,2,3,0],[5,6,7,4],[9,10,11,8],[13,14,15,12]],numpy.uint8)==obj.getData()).all())
 
+  def test_circshiftData_xy_types(self):
+    data = numpy.arange(35).reshape(5,7)
+    for t in [numpy.uint8, numpy.int16, numpy.int32, numpy.int64, numpy.float32, numpy.float64]:
+      for (x,y) in [(2,3), (-3,1), (7,-11), (15,4), (0,-2)]:
+        obj = _ravedata2d.new()
+        obj.setData(data.astype(t))
+        obj.circshiftData(x,y)
+        self.assertTrue((numpy.roll(numpy.roll(data, y, axis=0), x, axis=1).astype(t) == obj.getData()).all())
+
+  def test_circshift_keeps_original(self):
+    data = numpy.arange(12).reshape(3,4).astype(numpy.int16)
+    obj = _ravedata2d.new()
+    obj.setData(data)
+    result = obj.circshift(1, 2)
+    self.assertTrue((numpy.roll(numpy.roll(data, 2, axis=0), 1, axis=1) == result.getData()).all())
+    self.assertTrue((data == obj.getData()).all())
+
   def test_add_number(self):
     obj = _ravedata2d.new()
     obj.setData(numpy.array([[1.0, 2.0, 3.0, 4.0],
@@ -763,6 +781,81 @@ class PyRaveRaveData2DTest(unittest.TestCase):
     result = obj.movingstd(1,1)
     #print(str(result.getData()))
     
+  def test_movingstd_large_window(self):
+    data = numpy.array([
+      [-7,-5,-3,-2,  4],
+      [-2,-1, 0, 1, 11],
+      [ 2, 3, 3, 4, -1],
+      [ 5, 5, 6, 7,  2]], numpy.float64)
+    obj = _ravedata2d.new(data)
+    obj.nodata = -999;
+    obj.useNodata = True
+    result = obj.movingstd(4, 2).getData()
+
+    # Window wraps around the borders and covers more than the field
+    for y in range(4):
+      for x in range(5):
+        s = 0.0
+        for j in range(-2, 3):
+          for i in range(-4, 5):
+            s = s + (data[(y+j)%4][(x+i)%5] - data[y][x])**2
+        self.assertAlmostEqual(numpy.sqrt(s) / (9*5-1), result[y][x], 6)
+
+  def test_boxmean(self):
+    data = numpy.array([
+      [-999, -5, -3, -2],
+      [-2,   -1,  0,  1],
+      [ 2, -999,  3,  4],
+      [ 5,    5,  6,  7]], numpy.float64)
+    obj = _ravedata2d.new(data)
+    obj.nodata = -999;
+    obj.useNodata = True
+    result = obj.boxmean(1, 2)
+    self.assertEqual(_rave.RaveDataType_DOUBLE, result.datatype)
+    self.assertTrue(result.useNodata)
+    self.assertAlmostEqual(-999.0, result.nodata)
+
+    for y in range(4):
+      for x in range(4):
+        box = data[max(0,y-2):y+3, max(0,x-1):x+2]
+        self.assertAlmostEqual(numpy.mean(box[box != -999]), result.getData()[y][x], 6)
+
+  def test_boxmean_all_nodata(self):
+    obj = _ravedata2d.new(numpy.array([
+      [-999, -999, 1],
+      [-999, -999, 2]], numpy.float64))
+    obj.nodata = -999;
+    obj.useNodata = True
+    result = obj.boxmean(0, 0).getData()
+    self.assertTrue((numpy.array([[-999,-999,1],[-999,-999,2]], numpy.float64) == result).all())
+
+  def test_boxstd(self):
+    data = numpy.array([
+      [-999, -5, -3, -2, 10],
+      [-2,   -1,  0,  1, 12],
+      [ 2, -999,  3,  4, 17],
+      [ 5,    5,  6,  7, 1]], numpy.float64)
+    obj = _ravedata2d.new(data)
+    obj.nodata = -999;
+    obj.useNodata = True
+    result = obj.boxstd(2, 1).getData()
+
+    for y in range(4):
+      for x in range(5):
+        box = data[max(0,y-1):y+2, max(0,x-2):x+3]
+        self.assertAlmostEqual(numpy.std(box[box != -999]), result[y][x], 6)
+
+  def test_boxstd_noNodata(self):
+    data = numpy.array([
+      [-999, -5, -3],
+      [-2,   -1,  0]], numpy.float64)
+    obj = _ravedata2d.new(data)
+    obj.useNodata = False
+    result = obj.boxstd(1, 1).getData()
+    for y in range(2):
+      for x in range(3):
+        self.assertAlmostEqual(numpy.std(data[max(0,y-1):y+2, max(0,x-1):x+2]), result[y][x], 6)
+
   def test_hist(self):
     obj = _ravedata2d.new(numpy.array([
       [-7,-5,-3,-2],
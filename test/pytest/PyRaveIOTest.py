@@ -2466,6 +2466,29 @@ class PyRaveIOTest(unittest.TestCase):
     self.assertAlmostEqual(1.0, ddata[1], 2)
     self.assertAlmostEqual(5.0, ddata[5], 2)
 
+  def test_write_scan_datasets_as_written(self):
+    scan = _raveio.open(self.FIXTURE_VOLUME).object.getScan(0)
+    dbzh = scan.getParameter("DBZH").getData()
+
+    p1 = scan.getParameter("DBZH")
+    qfield = _ravefield.new()
+    qfield.addAttribute("how/task", "se.test.quality")
+    qfield.setData(numpy.arange(scan.nrays*scan.nbins).reshape((scan.nrays, scan.nbins)).astype(numpy.float64))
+    p1.addQualityField(qfield)
+
+    for level in [0, 6]:
+      obj = _raveio.new()
+      obj.object = scan
+      obj.compression_level = level
+      obj.save(self.TEMPORARY_FILE)
+
+      nodelist = _pyhl.read_nodelist(self.TEMPORARY_FILE)
+      nodelist.selectAll()
+      nodelist.fetch()
+      self.assertEqual("IMAGE", nodelist.getNode("/dataset1/data1/data/CLASS").data())
+      self.assertTrue(numpy.array_equal(dbzh, nodelist.getNode("/dataset1/data1/data").data()))
+      self.assertTrue(numpy.array_equal(qfield.getData(), nodelist.getNode("/dataset1/data1/quality1/data").data()))
+
   def test_write_scanparam_with_array(self):
     obj = _raveio.open(self.FIXTURE_VOLUME)
     vol = obj.object
@@ -5872,6 +5895,32 @@ class PyRaveIOTest(unittest.TestCase):
     self.assertEqual(_rave.RaveDataType_DOUBLE, param.datatype)
 
 
+  def testReadBufr_inWorkers(self):
+    if not _raveio.supports(_raveio.RaveIO_ODIM_FileFormat_BUFR):
+      return
+    program = os.environ.get("RAVE_BUFR2ODIM_BIN", os.path.join(os.path.dirname(os.path.abspath(__file__)), "../../librave/toolbox/rave_bufr2odim"))
+    if not os.path.isfile(program):
+      self.skipTest("%s has not been built"%program)
+    import threading
+    _raveio.setBufrWorkers(program, 2)
+    try:
+      self.assertEqual(2, _raveio.getBufrWorkers())
+      results = [None]*4
+      def opener(idx):
+        rio = _raveio.open(self.FIXTURE_BUFR_PVOL)
+        results[idx] = (rio.file_format, rio.object.getNumberOfScans(), rio.object.getScan(0).nrays)
+
+      threads = [threading.Thread(target=opener, args=(i,)) for i in range(len(results))]
+      for t in threads:
+        t.start()
+      for t in threads:
+        t.join()
+    finally:
+      _raveio.setBufrWorkers(None, 0)
+
+    self.assertEqual(0, _raveio.getBufrWorkers())
+    self.assertEqual([(_raveio.RaveIO_ODIM_FileFormat_BUFR, 3, 720)]*len(results), results)
+
   def testReadBufrOdim22(self):
     import _rave
     if not _raveio.supports(_raveio.RaveIO_ODIM_FileFormat_BUFR):
@@ -5927,6 +5976,57 @@ class PyRaveIOTest(unittest.TestCase):
     self.assertTrue(data is not None)
     self.assertEqual(58, data[0][2])
 
+  def test_open_from_several_threads(self):
+    import threading
+    results = [None]*8
+    def opener(idx):
+      vol = _raveio.open(self.FIXTURE_VOLUME, (idx%2)==0).object
+      results[idx] = vol.getScan(0).getParameter("DBZH").getData()[0][2]
+
+    threads = [threading.Thread(target=opener, args=(i,)) for i in range(len(results))]
+    for t in threads:
+      t.start()
+    for t in threads:
+      t.join()
+
+    self.assertEqual([58]*len(results), results)
+
+  def test_openFromMemory(self):
+    with open(self.FIXTURE_VOLUME, "rb") as fp:
+      content = fp.read()
+    obj = _raveio.openFromMemory(content)
+    self.assertEqual(None, obj.filename)
+    self.assertEqual(_rave.Rave_ObjectType_PVOL, obj.objectType)
+    self.assertEqual(10, obj.object.getNumberOfScans())
+    self.assertEqual(58, obj.object.getScan(0).getParameter("DBZH").getData()[0][2])
+
+  def test_openFromMemory_lazy(self):
+    with open(self.FIXTURE_VOLUME, "rb") as fp:
+      content = fp.read()
+    vol = _raveio.openFromMemory(content, True, "VRADH").object
+    content = None
+    data = vol.getScan(0).getParameter("DBZH").getData()
+    self.assertTrue(data is not None)
+    self.assertEqual(58, data[0][2])
+
+  def test_openFromMemory_bad_content(self):
+    try:
+      _raveio.openFromMemory(b"this is not a hdf5 file")
+      self.fail("Expected IOError")
+    except IOError:
+      pass
+
+  def test_saveToMemory(self):
+    obj = _raveio.open(self.FIXTURE_CARTESIAN_IMAGE)
+    obj.object.getParameter("DBZH").setValue((1,1),10)
+    obj.filename = self.TEMPORARY_FILE
+    content = obj.saveToMemory()
+    self.assertEqual(self.TEMPORARY_FILE, obj.filename)
+    self.assertFalse(os.path.exists(self.TEMPORARY_FILE))
+
+    result = _raveio.openFromMemory(content, True)
+    self.assertAlmostEqual(10.0, result.object.getParameter("DBZH").getValue((1,1))[1], 4)
+
   def test_read_scan_with_lazyio_shift(self):
     scan = _raveio.open(self.FIXTURE_SEHEM_SCAN_0_5, True).object
     scan.shiftData(-1)
@@ -5965,6 +6065,25 @@ class PyRaveIOTest(unittest.TestCase):
     obj = _raveio.open(self.TEMPORARY_FILE, True)
     self.assertAlmostEqual(10.0, obj.object.getParameter("DBZH").getValue((1,1))[1], 4)
 
+  def test_read_cartesian_with_lazyio_quality_fields(self):
+    obj = _raveio.open(self.FIXTURE_CARTESIAN_IMAGE)
+    qfield = _ravefield.new()
+    qfield.addAttribute("how/task", "se.smhi.composite.distance.radar")
+    qfield.setData(numpy.zeros((obj.object.ysize, obj.object.xsize), numpy.uint8) + 7)
+    obj.object.getParameter("DBZH").addQualityField(qfield)
+    obj.object.addQualityField(qfield.clone())
+    obj.save(self.TEMPORARY_FILE)
+
+    obj = _raveio.open(self.TEMPORARY_FILE, True, "DBZH,se.smhi.composite.distance.radar")
+    field = obj.object.getParameter("DBZH").getQualityFieldByHowTask("se.smhi.composite.distance.radar")
+    self.assertEqual(7, field.getValue(1,1)[1])
+    field = obj.object.getQualityFieldByHowTask("se.smhi.composite.distance.radar")
+    self.assertEqual(7, field.getValue(1,1)[1])
+
+    obj = _raveio.open(self.TEMPORARY_FILE, True, "DBZH")
+    field = obj.object.getParameter("DBZH").getQualityFieldByHowTask("se.smhi.composite.distance.radar")
+    self.assertEqual(7, field.getData()[1][1])
+
   def test_read_cartesian_volume_with_lazyio(self):
     obj = _raveio.open(self.FIXTURE_CARTESIAN_VOLUME, False)
     obj.object.getImage(0).getParameter("DBZH").setValue((1,1),10)
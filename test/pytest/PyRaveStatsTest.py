@@ -0,0 +1,71 @@
+'''
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of RAVE.
+
+RAVE is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RAVE is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+
+Tests the _ravestats module.
+
+@file
+@date 2026-10-17
+'''
+import unittest
+import _ravestats
+import _raveio
+
+class PyRaveStatsTest(unittest.TestCase):
+  FIXTURE_VOLUME="fixture_ODIM_H5_pvol_ang_20090501T1200Z.h5"
+
+  def setUp(self):
+    _ravestats.reset()
+
+  def tearDown(self):
+    _ravestats.reset()
+
+  def test_names(self):
+    timers = _ravestats.timers()
+    for name in ["composite.generate", "composite.projection", "composite.select", "composite.quality",
+                 "transform", "io.read", "io.write", "polar_odim_io.read", "polar_odim_io.write",
+                 "qc.hac", "qc.detection_range", "qc.dealias", "qc.ctfilter", "qc.qitotal"]:
+      self.assertTrue(name in timers)
+    counters = _ravestats.counters()
+    for name in ["composite.pixels", "composite.lookups", "composite.projections", "transform.pixels", "io.files_read", "io.files_written"]:
+      self.assertTrue(name in counters)
+
+  def test_reset(self):
+    _raveio.open(self.FIXTURE_VOLUME)
+    _ravestats.reset()
+    for seconds, calls in _ravestats.timers().values():
+      self.assertEqual(0.0, seconds)
+      self.assertEqual(0, calls)
+    for value in _ravestats.counters().values():
+      self.assertEqual(0, value)
+
+  def test_load(self):
+    _raveio.open(self.FIXTURE_VOLUME)
+    timers = _ravestats.timers()
+    counters = _ravestats.counters()
+    if _ravestats.isEnabled():
+      self.assertEqual(1, timers["io.read"][1])
+      self.assertTrue(timers["io.read"][0] > 0.0)
+      self.assertEqual(1, timers["polar_odim_io.read"][1])
+      self.assertEqual(1, counters["io.files_read"])
+    else:
+      self.assertEqual((0.0, 0), timers["io.read"])
+      self.assertEqual(0, counters["io.files_read"])
+
+if __name__ == "__main__":
+  unittest.main()
@@ -35,20 +35,27 @@ import _cartesianparam
 import _ravefield
 import string
 import numpy
+import math
+import glob
 
 class PyTransformTest(unittest.TestCase):
   FIXTURE_CARTESIAN_PCAPPI = "fixture_cartesian_pcappi.h5"
   FIXTURE_CARTESIAN_PPI = "fixture_cartesian_ppi.h5"
   FIXTURE_VOLUME = "fixture_ODIM_H5_pvol_ang_20090501T1200Z.h5"
   TRANSFORM_FILLGAP_FILENAME = "transform_filledGap.h5"
+  TRANSFORM_OPERATOR_FILENAME = "transform_operator.top"
   
   def setUp(self):
     if os.path.isfile(self.TRANSFORM_FILLGAP_FILENAME):
       os.unlink(self.TRANSFORM_FILLGAP_FILENAME)
+    if os.path.isfile(self.TRANSFORM_OPERATOR_FILENAME):
+      os.unlink(self.TRANSFORM_OPERATOR_FILENAME)
 
   def tearDown(self):
     if os.path.isfile(self.TRANSFORM_FILLGAP_FILENAME):
       os.unlink(self.TRANSFORM_FILLGAP_FILENAME)
+    if os.path.isfile(self.TRANSFORM_OPERATOR_FILENAME):
+      os.unlink(self.TRANSFORM_OPERATOR_FILENAME)
 
   def test_new(self):
     obj = _transform.new()
@@ -209,6 +216,234 @@ class PyTransformTest(unittest.TestCase):
     data = result.getParameter("TH").getData() 
     self.assertEqual(2, data[2][2])
   
+  def test_compile_ppi(self):
+    obj = _transform.new()
+    volume = _raveio.open(self.FIXTURE_VOLUME).object
+    radardef = self.create_radardef(volume)
+    area = self.create_area_around(volume)
+    scan = volume.getScan(0)
+
+    op = obj.compile(area, radardef, _rave.Rave_ProductType_PPI, scan.elangle)
+    self.assertNotEqual(-1, str(type(op)).find("TransformOperatorCore"))
+    self.assertEqual(area.xsize, op.xsize)
+    self.assertEqual(area.ysize, op.ysize)
+    self.assertEqual(_rave.NEAREST, op.method)
+    self.assertEqual(_rave.Rave_ProductType_PPI, op.product)
+    self.assertAlmostEqual(scan.elangle, op.value, 4)
+    self.assertTrue(op.entries > 0)
+    self.assertTrue(op.isCompiledFor(area, radardef, _rave.NEAREST, _rave.Rave_ProductType_PPI, scan.elangle))
+    self.assertFalse(op.isCompiledFor(area, radardef, _rave.BILINEAR, _rave.Rave_ProductType_PPI, scan.elangle))
+
+    cartesian = self.create_empty_cartesian(area)
+    op.apply(scan, cartesian)
+    data = cartesian.getParameter("DBZH").getData()
+    self.assertTrue(numpy.any(data != 255))
+
+  def test_compile_ppi_is_same_as_transform(self):
+    obj = _transform.new()
+    volume = _raveio.open(self.FIXTURE_VOLUME).object
+    area = self.create_area_around(volume)
+    scan = volume.getScan(0)
+
+    op = obj.compile(area, self.create_radardef(volume), _rave.Rave_ProductType_PPI, scan.elangle)
+    c1 = self.create_empty_cartesian(area)
+    op.apply(scan, c1)
+    c2 = self.create_empty_cartesian(area)
+    obj.ppi(scan, c2)
+    self.assertTrue(numpy.array_equal(c1.getParameter("DBZH").getData(), c2.getParameter("DBZH").getData()))
+
+  def test_compile_cappi_is_same_as_transform(self):
+    obj = _transform.new()
+    volume = _raveio.open(self.FIXTURE_VOLUME).object
+    area = self.create_area_around(volume)
+
+    op = obj.compile(area, self.create_radardef(volume), _rave.Rave_ProductType_CAPPI, 1000.0)
+    c1 = self.create_empty_cartesian(area)
+    op.apply(volume, c1)
+    c2 = self.create_empty_cartesian(area)
+    obj.cappi(volume, c2, 1000.0)
+    self.assertTrue(numpy.array_equal(c1.getParameter("DBZH").getData(), c2.getParameter("DBZH").getData()))
+
+  def test_compile_ppi_with_rstart_and_astart(self):
+    obj = _transform.new()
+    volume = _raveio.open(self.FIXTURE_VOLUME).object
+    area = self.create_area_around(volume)
+    scan = volume.getScan(0)
+    scan.rstart = 2.0
+    scan.addAttribute("how/astart", 0.5)
+
+    op = obj.compile(area, self.create_radardef(volume), _rave.Rave_ProductType_PPI, scan.elangle, 0.0, 2.0, 0.5 * math.pi / 180.0)
+    self.assertAlmostEqual(2.0, op.rstart, 4)
+    self.assertAlmostEqual(0.5 * math.pi / 180.0, op.astart, 6)
+    c1 = self.create_empty_cartesian(area)
+    op.apply(scan, c1)
+    c2 = self.create_empty_cartesian(area)
+    obj.ppi(scan, c2)
+    self.assertTrue(numpy.array_equal(c1.getParameter("DBZH").getData(), c2.getParameter("DBZH").getData()))
+
+    # An operator compiled without rstart and astart can not be used for the scan
+    op = obj.compile(area, self.create_radardef(volume), _rave.Rave_ProductType_PPI, scan.elangle)
+    self.assertEqual(None, op.astart)
+    try:
+      op.apply(scan, self.create_empty_cartesian(area))
+      self.fail("Expected IOError")
+    except IOError:
+      pass
+
+  def test_compile_apply_is_same_for_threads(self):
+    obj = _transform.new()
+    obj.method = _rave.BILINEAR
+    volume = _raveio.open(self.FIXTURE_VOLUME).object
+    radardef = self.create_radardef(volume)
+    area = self.create_area_around(volume)
+
+    op = obj.compile(area, radardef, _rave.Rave_ProductType_CAPPI, 1000.0)
+    self.assertEqual(1, op.nthreads)
+    c1 = self.create_empty_cartesian(area)
+    op.apply(volume, c1)
+    op.nthreads = 4
+    self.assertEqual(4, op.nthreads)
+    c2 = self.create_empty_cartesian(area)
+    op.apply(volume, c2)
+    self.assertTrue(numpy.array_equal(c1.getParameter("DBZH").getData(), c2.getParameter("DBZH").getData()))
+
+    try:
+      op.nthreads = 0
+      self.fail("Expected ValueError")
+    except ValueError:
+      pass
+
+  def test_compile_with_unsorted_elangles(self):
+    obj = _transform.new()
+    obj.method = _rave.BILINEAR
+    volume = _raveio.open(self.FIXTURE_VOLUME).object
+    area = self.create_area_around(volume)
+    radardef = self.create_radardef(volume)
+    reverseddef = self.create_radardef(volume)
+    reverseddef.elangles = list(reversed(radardef.elangles))
+
+    op = obj.compile(area, radardef, _rave.Rave_ProductType_CAPPI, 1000.0)
+    reversedop = obj.compile(area, reverseddef, _rave.Rave_ProductType_CAPPI, 1000.0)
+    self.assertEqual(op.entries, reversedop.entries)
+    self.assertTrue(reversedop.isCompiledFor(area, radardef, _rave.BILINEAR, _rave.Rave_ProductType_CAPPI, 1000.0))
+
+    c1 = self.create_empty_cartesian(area)
+    op.apply(volume, c1)
+    c2 = self.create_empty_cartesian(area)
+    reversedop.apply(volume, c2)
+    self.assertTrue(numpy.array_equal(c1.getParameter("DBZH").getData(), c2.getParameter("DBZH").getData()))
+
+  def test_compile_save_and_load(self):
+    obj = _transform.new()
+    obj.method = _rave.CRESSMAN
+    volume = _raveio.open(self.FIXTURE_VOLUME).object
+    radardef = self.create_radardef(volume)
+    area = self.create_area_around(volume)
+
+    op = obj.compile(area, radardef, _rave.Rave_ProductType_PCAPPI, 2000.0, 4000.0)
+    self.assertAlmostEqual(4000.0, op.radius, 4)
+    op.save(self.TRANSFORM_OPERATOR_FILENAME)
+    # The operator is written to a temporary file that is renamed
+    self.assertEqual([], glob.glob(self.TRANSFORM_OPERATOR_FILENAME + ".*"))
+
+    loaded = _transform.loadOperator(self.TRANSFORM_OPERATOR_FILENAME)
+    self.assertEqual(op.entries, loaded.entries)
+    self.assertEqual(_rave.CRESSMAN, loaded.method)
+    self.assertEqual(_rave.Rave_ProductType_PCAPPI, loaded.product)
+    self.assertTrue(loaded.isCompiledFor(area, radardef, _rave.CRESSMAN, _rave.Rave_ProductType_PCAPPI, 2000.0))
+
+    c1 = self.create_empty_cartesian(area)
+    op.apply(volume, c1)
+    c2 = self.create_empty_cartesian(area)
+    loaded.apply(volume, c2)
+    self.assertTrue(numpy.array_equal(c1.getParameter("DBZH").getData(), c2.getParameter("DBZH").getData()))
+
+  def test_loadOperator_bad_file(self):
+    fp = open(self.TRANSFORM_OPERATOR_FILENAME, "w")
+    fp.write("not an operator")
+    fp.close()
+    try:
+      _transform.loadOperator(self.TRANSFORM_OPERATOR_FILENAME)
+      self.fail("Expected IOError")
+    except IOError:
+      pass
+
+  def create_radardef(self, volume):
+    radardef = _radardef.new()
+    radardef.id = volume.source
+    radardef.longitude = volume.longitude
+    radardef.latitude = volume.latitude
+    radardef.height = volume.height
+    elangles = []
+    for i in range(volume.getNumberOfScans()):
+      elangles.append(volume.getScan(i).elangle)
+    radardef.elangles = elangles
+    scan = volume.getScan(0)
+    radardef.nrays = scan.nrays
+    radardef.nbins = scan.nbins
+    radardef.scale = scan.rscale
+    radardef.beamwidth = scan.beamwidth
+    return radardef
+
+  def test_max(self):
+    obj = _transform.new()
+    volume = _raveio.open(self.FIXTURE_VOLUME).object
+    cartesian = self.create_empty_cartesian(self.create_area_around(volume))
+    obj.max(volume, cartesian)
+    data = cartesian.getParameter("DBZH").getData()
+    self.assertTrue(numpy.any(data != 255))
+    # The corners are outside the range of the radar
+    self.assertEqual(255, data[0][0])
+
+  def test_etop(self):
+    obj = _transform.new()
+    volume = _raveio.open(self.FIXTURE_VOLUME).object
+    area = self.create_area_around(volume)
+    low = self.create_empty_cartesian(area)
+    obj.etop(volume, low, 0.0)
+    high = self.create_empty_cartesian(area)
+    obj.etop(volume, high, 100.0)
+    ldata = low.getParameter("DBZH").getData()
+    hdata = high.getParameter("DBZH").getData()
+    self.assertTrue(numpy.any((ldata != 255) & (ldata != 0)))
+    # Nothing reaches 100 dBZ so everything within range is undetect
+    self.assertTrue(numpy.all((hdata == 255) | (hdata == 0)))
+    self.assertTrue(numpy.array_equal(ldata == 255, hdata == 255))
+
+  def test_vil(self):
+    obj = _transform.new()
+    volume = _raveio.open(self.FIXTURE_VOLUME).object
+    cartesian = self.create_empty_cartesian(self.create_area_around(volume))
+    cartesian.getParameter("DBZH").gain = 0.01
+    obj.vil(volume, cartesian)
+    data = cartesian.getParameter("DBZH").getData()
+    self.assertTrue(numpy.any((data != 255) & (data != 0)))
+
+  def create_area_around(self, volume):
+    import math
+    area = _area.new()
+    lon = volume.longitude * 180.0 / math.pi
+    lat = volume.latitude * 180.0 / math.pi
+    area.projection = _projection.new("x", "y", "+proj=aeqd +lon_0=%f +lat_0=%f +R=6371000 +no_defs"%(lon, lat))
+    area.xsize = 100
+    area.ysize = 100
+    area.xscale = 2000.0
+    area.yscale = 2000.0
+    area.extent = (-100000.0, -100000.0, 100000.0, 100000.0)
+    return area
+
+  def create_empty_cartesian(self, area):
+    obj = _cartesian.new()
+    obj.init(area)
+    param = _cartesianparam.new()
+    param.setData(numpy.zeros((area.ysize, area.xsize), numpy.uint8))
+    param.nodata = 255.0
+    param.undetect = 0.0
+    param.quantity = "DBZH"
+    obj.addParameter(param)
+    obj.defaultParameter = "DBZH"
+    return obj
+
   def create_cartesian_with_parameter(self, xsize, ysize, xscale, yscale, extent, projstr, dtype, value, quantity):
     obj = _cartesian.new()
     a = _area.new()
@@ -317,6 +552,35 @@ class PyTransformTest(unittest.TestCase):
     self.assertEqual([[23,23,25,25],[23,23,25,25],[27,27,29,29],[27,27,29,29]], pqf1.getData().tolist())
     self.assertEqual([[24,24,26,26],[24,24,26,26],[28,28,30,30],[28,28,30,30]], pqf2.getData().tolist())
     
+  def test_combine_tiles_merges_radar_index(self):
+    pyarea = _area.new()
+    pyarea.extent = (971337.728807, 7196461.17902, 3015337.72881, 11028461.179)
+    pyarea.xscale = 511000.0
+    pyarea.yscale = 958000.0
+    pyarea.xsize = 4
+    pyarea.ysize = 4
+    pyarea.projection = _projection.new("x", "y", "+proj=merc +lat_ts=0 +lon_0=0 +k=1.0 +R=6378137.0 +nadgrids=@null +no_defs")
+
+    extents = [(971337.728807,9112461.1790100001,1993337.7288084999,11028461.179),
+               (1993337.7288084999,9112461.1790100001,3015337.72881,11028461.179),
+               (971337.728807,7196461.17902,1993337.7288084999,9112461.1790100001),
+               (1993337.7288084999,7196461.17902,3015337.72881,9112461.1790100001)]
+    taskargs = ["sekkr:1,sevar:2", "sevar:2, seang:3", "sekkr:1", "seang:3,sekaa:4"]
+    tiles = []
+    for i in range(4):
+      tile = self.create_cartesian_with_parameter(2, 2, pyarea.xscale, pyarea.yscale, extents[i], pyarea.projection.definition, numpy.uint8, [i], ["DBZH"])
+      field = self.create_quality_field(2,2,numpy.uint8, i+1, "se.smhi.composite.index.radar")
+      field.addAttribute("how/task_args", taskargs[i])
+      tile.getParameter("DBZH").addQualityField(field)
+      tiles.append(tile)
+
+    t = _transform.new()
+    result = t.combine_tiles(pyarea, tiles)
+    field = result.getParameter("DBZH").getQualityFieldByHowTask("se.smhi.composite.index.radar")
+    self.assertEqual([[1,1,2,2],[1,1,2,2],[3,3,4,4],[3,3,4,4]], field.getData().tolist())
+    self.assertEqual("sekkr:1,sevar:2,seang:3,sekaa:4", field.getAttribute("how/task_args"))
+    self.assertTrue("how/task_args" in field.getAttributeNames())
+
   def test_combine_tiles_with_two_parameters(self):
     pyarea = _area.new()
     pyarea.extent = (971337.728807, 7196461.17902, 3015337.72881, 11028461.179)
@@ -44,6 +44,7 @@ from PyCartesianVolumeTest import *
 from PyVerticalProfileTest import *
 from PyRaveFieldTest import *
 from PyRaveData2DTest import *
+from PyRaveStatsTest import *
 from PyAttributeTableTest import *
 from PyTransformTest import *
 
@@ -79,6 +80,7 @@ from qitotal_options_test import *
 from rave_qitotal_quality_plugin_test import *
 from rave_pgf_quality_registry_mgr_test import *
 from rave_quality_chain_registry_test import *
+from rave_qc_executor_test import *
 from odc_hac_test import *
 from rave_hexquant_test import *
 from polar_merger_test import *
@@ -119,6 +121,7 @@ if os.environ.get("RAVE_TESTDB_URI", "") != "":
   from rave_dom_db_test import *
 
 from rave_wmo_flatfile_test import *
+from rave_dom_index_test import *
 
 from rave_fm12_test import *
 
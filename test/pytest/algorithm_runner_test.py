@@ -28,6 +28,7 @@ import unittest
 import string
 import math
 import os
+import mock
 import algorithm_runner
 
 class AlgorithmRunnerTest(unittest.TestCase):
@@ -112,6 +113,49 @@ class AlgorithmRunnerTest(unittest.TestCase):
     job = algorithm_runner.algorithm_job(os.path, "123-432", "an.algorithm",["a.h5","b.h5"], ["--date=20150101","--time=101112","--algorithm_id=123"])
     job.jobdone() # No exception should be called
 
+  def create_runner(self, nrprocesses):
+    with mock.patch("algorithm_runner.RavePool"):
+      return algorithm_runner.algorithm_runner(nrprocesses)
+
+  def test_status_empty(self):
+    runner = self.create_runner(2)
+    try:
+      status = runner.status()
+      self.assertEqual(0, status["queued"])
+      self.assertEqual(0, status["running"])
+      self.assertEqual(2, status["processes"])
+      self.assertEqual(0, status["finished"])
+      self.assertAlmostEqual(0.0, status["estimated_latency"], 4)
+    finally:
+      runner.terminate()
+
+  def test_status_estimated_latency(self):
+    runner = self.create_runner(2)
+    try:
+      runner._record_job_time(4.0)
+      runner.running_jobs = 2
+      for i in range(3):
+        runner.queue.put(algorithm_runner.algorithm_job(os.path, "1-%d"%i, "an.algorithm", ["a.h5"], []))
+      status = runner.status()
+      self.assertEqual(3, status["queued"])
+      self.assertEqual(2, status["running"])
+      self.assertEqual(1, status["finished"])
+      self.assertAlmostEqual(4.0, status["mean_job_time"], 4)
+      self.assertAlmostEqual(8.0, status["estimated_latency"], 4)
+    finally:
+      runner.terminate()
+
+  def test_record_job_time(self):
+    runner = self.create_runner(1)
+    try:
+      runner._record_job_time(2.0)
+      self.assertAlmostEqual(2.0, runner.mean_job_time, 4)
+      runner._record_job_time(12.0)
+      self.assertAlmostEqual(2.0 + runner.JOB_TIME_WEIGHT * 10.0, runner.mean_job_time, 4)
+      self.assertEqual(2, runner.finished_jobs)
+    finally:
+      runner.terminate()
+
 if __name__ == "__main__":
     unittest.main()
 
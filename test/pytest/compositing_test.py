@@ -30,6 +30,7 @@ import _pycomposite
 import rave_quality_plugin, rave_pgf_quality_registry
 import mock
 import math
+import rave_defines
 
 class scan_mock(mock.MagicMock):
 
@@ -510,6 +511,16 @@ class compositing_test(unittest.TestCase):
       self.classUnderTest.set_product_from_string(p[0])
       self.assertEqual(p[1], self.classUnderTest.product)
 
+  def test_product_gain_offset(self):
+    self.classUnderTest.gain = 0.5
+    self.classUnderTest.offset = -32.0
+    self.classUnderTest.set_product_from_string("pcappi")
+    self.assertEqual((0.5, -32.0), self.classUnderTest._product_gain_offset())
+    self.classUnderTest.set_product_from_string("etop")
+    self.assertEqual((rave_defines.ETOP_GAIN, rave_defines.ETOP_OFFSET), self.classUnderTest._product_gain_offset())
+    self.classUnderTest.set_product_from_string("vil")
+    self.assertEqual((rave_defines.VIL_GAIN, rave_defines.VIL_OFFSET), self.classUnderTest._product_gain_offset())
+
   def test_set_product_from_string_invalid(self):
     try:
       self.classUnderTest.set_product_from_string("nisse")
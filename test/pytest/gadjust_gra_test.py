@@ -174,3 +174,36 @@ class gadjust_gra_test(unittest.TestCase):
     self.assertAlmostEqual(0.4714, result[1], 4)
     
     
+
+  def create_points_with_outliers(self):
+    points = []
+    for i in range(50):
+      d = 4.0 * i
+      gr = 0.5 + 0.01*d + (0.05 if i % 2 else -0.05)
+      if i in [5, 7]:
+        gr = gr + (20.0 if i == 5 else 3.0)
+      points.append(grapoint(_rave.RaveValueType_DATA, 1.0, d, 10.0, 20.0, "20131010", "101500", 10**(gr/10.0), 12))
+    return points
+
+  def test_get_2nd_order_adjustment_iterative(self):
+    single = gra.gra(self.create_points_with_outliers(), 1)
+    single_result = single.get_2nd_order_adjustment()
+    self.assertEqual(1, single_result[5])
+
+    self.classUnderTest = gra.gra(self.create_points_with_outliers(), 5)
+    result = self.classUnderTest.get_2nd_order_adjustment()
+    self.assertTrue(result[5] >= 2)
+    self.assertEqual(50 - result[5], len(self.classUnderTest.points))
+    self.assertTrue(abs(result[0] - 0.5) < abs(single_result[0] - 0.5))
+    self.assertAlmostEqual(0.5, result[0], 1)
+    self.assertAlmostEqual(0.01, result[1], 3)
+    for p in self.classUnderTest.points:
+      self.assertTrue(0.0 <= p.quality_ok <= 1.0)
+
+  def test_quality_control_2nd_order_keeps_minimum(self):
+    points = [grapoint(_rave.RaveValueType_DATA, 1.0, 0.0, 10.0, 20.0, "20131010", "101500", 10**0.1, 12),
+              grapoint(_rave.RaveValueType_DATA, 1.0, 1.0, 10.0, 20.0, "20131010", "101500", 1.0, 12),
+              grapoint(_rave.RaveValueType_DATA, 1.0, 2.0, 10.0, 20.0, "20131010", "101500", 10**0.1, 12)]
+    self.classUnderTest = gra.gra(points, 5)
+    self.classUnderTest.quality_control_2nd_order(0.0, 0.0, 0.0)
+    self.assertEqual(3, len(self.classUnderTest.points))
@@ -22,6 +22,7 @@ import rave_dom_db
 from rave_dom import observation
 from gadjust import obsmatcher
 import mock
+import numpy
 import _raveio, _rave
 
 ##
@@ -37,6 +38,15 @@ class gadjust_obsmatcher_test(unittest.TestCase):
     self.db = None
     self.classUnderTest = None
   
+  def assert_sampled(self, acrrmock, lonlats):
+    self.assertEqual(2, len(acrrmock.mock_calls))
+    self.assertEqual(mock.call.getExtremeLonLatBoundaries(), acrrmock.mock_calls[0])
+    name, args, kwargs = acrrmock.mock_calls[1]
+    self.assertEqual("getConvertedValuesAtLonLats", name)
+    self.assertTrue(numpy.allclose([x[0]*math.pi/180.0 for x in lonlats], args[0]))
+    self.assertTrue(numpy.allclose([x[1]*math.pi/180.0 for x in lonlats], args[1]))
+    self.assertEqual("se.smhi.composite.distance.radar", args[2])
+
   def test_match_1(self):
     acrrmock = mock.Mock(date="20101010",time="121500")
     acrrmock.getExtremeLonLatBoundaries.return_value = ((0.1,0.2),(0.3,0.4))
@@ -44,42 +54,27 @@ class gadjust_obsmatcher_test(unittest.TestCase):
     self.dbmock.get_observations_in_bbox.return_value = [observation("01234","S",observation.SYNOP, "20101010", "001500", 13.0, 60.0, liquid_precipitation=1.0, accumulation_period=12),
                                                          observation("01235","S",observation.SYNOP, "20101010", "001500", 13.5, 60.0, liquid_precipitation=1.0, accumulation_period=12),
                                                          observation("01236","S",observation.SYNOP, "20101010", "001500", 13.5, 60.5, liquid_precipitation=1.0, accumulation_period=12)]
-    acrrmock.getConvertedValueAtLonLat.return_value = (2,48.0)
-    acrrmock.getConvertedQualityValueAtLonLat.return_value = 200.0
-    acrrmock.getConvertedValueAtLonLat.return_value = (2,49.0)
-    acrrmock.getConvertedQualityValueAtLonLat.return_value = 25.5
-    acrrmock.getConvertedValueAtLonLat.return_value = (2,30.0)
-    acrrmock.getConvertedQualityValueAtLonLat.return_value = 123456.0
+    acrrmock.getConvertedValuesAtLonLats.return_value = (numpy.array([48.0, 49.0, 30.0]), numpy.array([2, 2, 2]), numpy.array([200.0, 25.5, 123456.0]))
     
     result = self.classUnderTest.match(acrrmock, 12)
     
     # Expects
-    expected_acrrmock_calls=[mock.call.getExtremeLonLatBoundaries(), 
-                             mock.call.getConvertedValueAtLonLat((13.0*math.pi/180.0, 60.0*math.pi/180.0)),
-                             mock.call.getConvertedQualityValueAtLonLat((13.0*math.pi/180.0, 60.0*math.pi/180.0), 'se.smhi.composite.distance.radar'),
-                             mock.call.getConvertedValueAtLonLat((13.5*math.pi/180.0, 60.0*math.pi/180.0)),
-                             mock.call.getConvertedQualityValueAtLonLat((13.5*math.pi/180.0, 60.0*math.pi/180.0), 'se.smhi.composite.distance.radar'),
-                             mock.call.getConvertedValueAtLonLat((13.5*math.pi/180.0, 60.5*math.pi/180.0)),
-                             mock.call.getConvertedQualityValueAtLonLat((13.5*math.pi/180.0, 60.5*math.pi/180.0), 'se.smhi.composite.distance.radar')]
-
-    self.assertTrue(expected_acrrmock_calls == acrrmock.mock_calls)
+    self.assert_sampled(acrrmock, [(13.0, 60.0), (13.5, 60.0), (13.5, 60.5)])
     self.assertEqual(3, len(result))
+    self.assertAlmostEqual(49.0, result[1].radarvalue, 4)
+    self.assertAlmostEqual(0.0255, result[1].radardistance, 4)
 
   def test_match_2(self):
     acrrmock = mock.Mock(date="20101010",time="121500")
     acrrmock.getExtremeLonLatBoundaries.return_value = ((0.1,0.2),(0.3,0.4))
     
     self.dbmock.get_observations_in_bbox.return_value = [observation("01234","S",observation.SYNOP, "20101010", "001500", 13.0, 60.0, liquid_precipitation=1.0, accumulation_period=12)]
-    acrrmock.getConvertedValueAtLonLat.return_value = (2,48.0)
-    acrrmock.getConvertedQualityValueAtLonLat.return_value = 200.0
+    acrrmock.getConvertedValuesAtLonLats.return_value = (numpy.array([48.0]), numpy.array([2]), numpy.array([200.0]))
     
     result = self.classUnderTest.match(acrrmock, 12)
     
     # Expects
-    expected_acrrmock_calls=[mock.call.getExtremeLonLatBoundaries(), 
-                             mock.call.getConvertedValueAtLonLat((13.0*math.pi/180.0, 60.0*math.pi/180.0)),
-                             mock.call.getConvertedQualityValueAtLonLat((13.0*math.pi/180.0, 60.0*math.pi/180.0), 'se.smhi.composite.distance.radar')]
-    self.assertTrue(expected_acrrmock_calls == acrrmock.mock_calls)
+    self.assert_sampled(acrrmock, [(13.0, 60.0)])
     self.assertEqual(1, len(result))
     self.assertEqual(result[0].radarvaluetype, _rave.RaveValueType_DATA)
     self.assertAlmostEqual(result[0].radarvalue, 48.0, 4)
@@ -94,17 +89,26 @@ class gadjust_obsmatcher_test(unittest.TestCase):
     acrrmock.getExtremeLonLatBoundaries.return_value = ((0.1,0.2),(0.3,0.4))
     
     self.dbmock.get_observations_in_bbox.return_value = [observation("01234","S",observation.SYNOP, "20101010", "001500", 13.0, 60.0, accumulation_period=12)]
-    acrrmock.getConvertedValueAtLonLat.return_value = (1,48.0)
-    acrrmock.getQualityValueAtLonLat.return_value = 200.0
+    acrrmock.getConvertedValuesAtLonLats.return_value = (numpy.array([48.0]), numpy.array([1]), numpy.array([200.0]))
     
     result = self.classUnderTest.match(acrrmock, 12)
     
     # Expects
-    expected_acrrmock_calls=[mock.call.getExtremeLonLatBoundaries(), 
-                             mock.call.getConvertedValueAtLonLat((13.0*math.pi/180.0, 60.0*math.pi/180.0))]
-    self.assertTrue(expected_acrrmock_calls == acrrmock.mock_calls)
+    self.assert_sampled(acrrmock, [(13.0, 60.0)])
     self.assertEqual(0, len(result))
+
+  def test_match_missing_quality(self):
+    acrrmock = mock.Mock(date="20101010",time="121500")
+    acrrmock.getExtremeLonLatBoundaries.return_value = ((0.1,0.2),(0.3,0.4))
     
+    self.dbmock.get_observations_in_bbox.return_value = [observation("01234","S",observation.SYNOP, "20101010", "001500", 13.0, 60.0, liquid_precipitation=1.0, accumulation_period=12),
+                                                         observation("01235","S",observation.SYNOP, "20101010", "001500", 13.5, 60.0, liquid_precipitation=1.0, accumulation_period=6)]
+    acrrmock.getConvertedValuesAtLonLats.return_value = (numpy.array([48.0]), numpy.array([2]), numpy.array([float("nan")]))
+    
+    result = self.classUnderTest.match(acrrmock, 12)
+    
+    self.assert_sampled(acrrmock, [(13.0, 60.0)])
+    self.assertEqual(0, len(result))
 
   def Xtest_match_2(self):
     acrrmock = mock.Mock(date="20101010",time="121500")
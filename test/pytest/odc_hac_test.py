@@ -29,19 +29,23 @@ import math
 import string
 import _odc_hac, odc_hac, rave_zdiff_quality_plugin
 import _raveio, _ravefield
-import _polarscanparam,_polarvolume
+import _polarscanparam,_polarvolume,_polarscan
+import _pyhl
 import numpy
 
 class odc_hac_test(unittest.TestCase):
   VOLUME_FIXTURE = "fixtures/pvol_seang_20090501T120000Z.h5"
   SCAN_FIXTURE = "fixtures/scan_sehuv_0.5_20110126T184500Z.h5"
+  HAC_FILE = "odc_hac_test_hit-accum.hdf"
   classUnderTest = None
     
   def setUp(self):
-    pass 
+    if os.path.isfile(self.HAC_FILE):
+      os.unlink(self.HAC_FILE)
 
   def tearDown(self):
-    pass
+    if os.path.isfile(self.HAC_FILE):
+      os.unlink(self.HAC_FILE)
   
   def test_py_odc_hac_zdiffScan(self):
     scan = self.create_scan()
@@ -164,6 +168,102 @@ class odc_hac_test(unittest.TestCase):
     self.assertEqual(1, len(fields))
     self.assertEqual("eu.opera.odc.zdiff", fields[0])
     
+  def test_hac_store_increment(self):
+    scan = _raveio.open(self.SCAN_FIXTURE).object
+    hac = _ravefield.new()
+    hac.addAttribute("how/count", 0)
+    hac.setData(numpy.zeros((scan.nrays, scan.nbins), numpy.uint32))
+    _odc_hac.hacIncrement(scan, hac, "DBZH")
+    _odc_hac.hacIncrement(scan, hac, "DBZH")
+
+    store = _odc_hac.store(3600)
+    self.assertEqual(3600, store.flush_interval)
+    self.assertTrue(store.increment(self.HAC_FILE, scan, "DBZH"))
+    self.assertTrue(store.increment(self.HAC_FILE, scan, "DBZH"))
+    self.assertEqual(1, store.accumulators)
+    self.assertFalse(os.path.isfile(self.HAC_FILE))
+
+    store.flush()
+    nodelist = _pyhl.read_nodelist(self.HAC_FILE)
+    nodelist.selectNode("/accumulation_count")
+    nodelist.selectNode("/hit_accum")
+    nodelist.fetch()
+    self.assertEqual(2, nodelist.getNode("/accumulation_count").data())
+    self.assertTrue(numpy.array_equal(hac.getData(), nodelist.getNode("/hit_accum").data()))
+
+    # The file is read by a new store and incremented further
+    store = _odc_hac.store(0)
+    self.assertEqual((2, scan.nrays, scan.nbins), store.climatology(self.HAC_FILE))
+    self.assertTrue(store.increment(self.HAC_FILE, scan, "DBZH"))
+    self.assertEqual((3, scan.nrays, scan.nbins), store.climatology(self.HAC_FILE))
+
+  def test_hac_store_geometry_mismatch(self):
+    scan = _raveio.open(self.SCAN_FIXTURE).object
+    store = _odc_hac.store(0)
+    self.assertTrue(store.increment(self.HAC_FILE, scan, "DBZH"))
+    other = _polarscan.new()
+    param = _polarscanparam.new()
+    param.quantity = "DBZH"
+    param.setData(numpy.zeros((10, 10), numpy.uint8))
+    other.addParameter(param)
+    self.assertFalse(store.increment(self.HAC_FILE, other, "DBZH"))
+
+  def test_hac_store_filter(self):
+    scan = _raveio.open(self.SCAN_FIXTURE).object
+    store = _odc_hac.store(0)
+    self.assertEqual(None, store.climatology(self.HAC_FILE))
+    self.assertTrue(store.increment(self.HAC_FILE, scan, "DBZH"))
+
+    hac = _ravefield.new()
+    hac.addAttribute("how/count", 0)
+    hac.setData(numpy.zeros((scan.nrays, scan.nbins), numpy.uint32))
+    _odc_hac.hacIncrement(scan, hac, "DBZH")
+
+    expected = _raveio.open(self.SCAN_FIXTURE).object
+    scan = _raveio.open(self.SCAN_FIXTURE).object
+    for s in [expected, scan]:
+      qind = _ravefield.new()
+      qind.setData(numpy.zeros((s.nrays, s.nbins), numpy.uint8))
+      qind.addAttribute("how/task", "eu.opera.odc.hac")
+      qind.addAttribute("how/task_args", 60.0)
+      s.addQualityField(qind)
+    _odc_hac.hacFilter(expected, hac, "DBZH")
+
+    store = _odc_hac.store(0)
+    self.assertTrue(store.filter(self.HAC_FILE, scan, "DBZH"))
+    self.assertEqual(1, store.climatologies)
+    self.assertTrue(numpy.array_equal(expected.getParameter("DBZH").getData(), scan.getParameter("DBZH").getData()))
+    self.assertTrue(numpy.array_equal(expected.getQualityFieldByHowTask("eu.opera.odc.hac").getData(),
+                                      scan.getQualityFieldByHowTask("eu.opera.odc.hac").getData()))
+
+  def test_hac_store_increment_packed_hits(self):
+    scan = _raveio.open(self.SCAN_FIXTURE).object
+    hac = _ravefield.new()
+    hac.addAttribute("how/count", 0)
+    hac.setData(numpy.zeros((scan.nrays, scan.nbins), numpy.uint32))
+    _odc_hac.hacIncrement(scan, hac, "DBZH")
+
+    hits = odc_hac.packHits(scan, "DBZH")
+    self.assertEqual(1, len(hits))
+    fstr, nrays, nbins, packed = hits[0]
+    self.assertEqual(odc_hac.hacFile(scan), fstr)
+    self.assertEqual((scan.nrays, scan.nbins), (nrays, nbins))
+    self.assertEqual([], odc_hac.packHits(scan, "TH"))
+
+    field = _ravefield.new()
+    field.setData(numpy.unpackbits(numpy.frombuffer(packed, numpy.uint8))[:nrays*nbins].reshape((nrays, nbins)))
+    store = _odc_hac.store(0)
+    self.assertTrue(store.incrementHits(self.HAC_FILE, field))
+    self.assertEqual((1, scan.nrays, scan.nbins), store.climatology(self.HAC_FILE))
+
+    nodelist = _pyhl.read_nodelist(self.HAC_FILE)
+    nodelist.selectNode("/hit_accum")
+    nodelist.fetch()
+    self.assertTrue(numpy.array_equal(hac.getData(), nodelist.getNode("/hit_accum").data()))
+
+    field.setData(numpy.zeros((10, 10), numpy.uint8))
+    self.assertFalse(store.incrementHits(self.HAC_FILE, field))
+
   def create_scan(self, dbzh0_0=3.0, dbzh0_1=4.0, th0_0=53.0, th0_1=40.0):
     scan = _raveio.open(self.SCAN_FIXTURE).object
     param_dbzh = scan.getParameter("DBZH")
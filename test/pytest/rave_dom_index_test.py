@@ -0,0 +1,159 @@
+'''
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of RAVE.
+
+RAVE is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RAVE is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+
+Tests the in-process index over the DOM observations and stations
+
+@file
+@date 2026-10-17
+'''
+import unittest
+import datetime
+import sqlite3
+import rave_dom_index
+from rave_dom import wmo_station, observation
+
+##
+# Stand-in for rave_dom_db.rave_db that keeps the observations and stations in an in-memory
+# SQLite database and records the queries that are made.
+class sqlite_dom_db(object):
+  def __init__(self):
+    self.conn = sqlite3.connect(":memory:", check_same_thread=False)
+    self.conn.execute("CREATE TABLE obs (station TEXT, dt TEXT, longitude REAL, latitude REAL, liquid_precipitation REAL, accumulation_period INTEGER, PRIMARY KEY (station, dt, accumulation_period))")
+    self.conn.execute("CREATE TABLE station (stationnumber TEXT, stationsubnumber TEXT, longitude REAL, latitude REAL, PRIMARY KEY(stationnumber, stationsubnumber))")
+    self.queries = []
+
+  def add_observation(self, station, dt, lon, lat, precip=1.0, period=12):
+    self.conn.execute("INSERT OR REPLACE INTO obs VALUES (?,?,?,?,?,?)", (station, dt.strftime("%Y%m%d%H%M%S"), lon, lat, precip, period))
+
+  def add_station(self, number, lon, lat):
+    self.conn.execute("INSERT INTO station VALUES (?,?,?,?)", (number, "0", lon, lat))
+
+  def get_observations_in_bbox(self, ullon, ullat, lrlon, lrlat, startdt=None, enddt=None):
+    self.queries.append(("obs", startdt, enddt))
+    sql = "SELECT station, dt, longitude, latitude, liquid_precipitation, accumulation_period FROM obs WHERE longitude >= ? AND longitude <= ? AND latitude <= ? AND latitude >= ?"
+    args = [ullon, lrlon, ullat, lrlat]
+    if startdt is not None:
+      sql += " AND dt >= ?"
+      args.append(startdt.strftime("%Y%m%d%H%M%S"))
+    if enddt is not None:
+      sql += " AND dt <= ?"
+      args.append(enddt.strftime("%Y%m%d%H%M%S"))
+    sql += " ORDER BY station ASC, dt DESC"
+    result = []
+    for station, dt, lon, lat, precip, period in self.conn.execute(sql, args):
+      d = datetime.datetime.strptime(dt, "%Y%m%d%H%M%S")
+      result.append(observation(station, "SWEDEN", observation.SYNOP, d.date(), d.time(), lon, lat, precip, period))
+    return result
+
+  def get_stations_in_bbox(self, ullon, ullat, lrlon, lrlat):
+    self.queries.append(("station",))
+    result = []
+    for number, sub, lon, lat in self.conn.execute("SELECT * FROM station WHERE longitude >= ? AND longitude <= ? AND latitude <= ? AND latitude >= ?", (ullon, lrlon, ullat, lrlat)):
+      result.append(wmo_station("SWEDEN", "0", number, sub, number, lon, lat))
+    return result
+
+def keys(observations):
+  return [(o.station, rave_dom_index.observation_datetime(o)) for o in observations]
+
+class rave_dom_index_test(unittest.TestCase):
+  BBOX = (10.0, 65.0, 20.0, 55.0)
+
+  def setUp(self):
+    self.db = sqlite_dom_db()
+    self.t0 = datetime.datetime(2026, 10, 17, 0, 0, 0)
+    for h in range(12):
+      for i, (lon, lat) in enumerate([(12.0, 58.0), (15.5, 60.25), (19.9, 55.1), (25.0, 60.0), (14.0, 70.0)]):
+        self.db.add_observation("0%d"%i, self.t0 + datetime.timedelta(hours=h), lon, lat)
+    self.classUnderTest = rave_dom_index.dom_index(self.db, cellsize=1.0, overlap=datetime.timedelta(hours=1))
+
+  def tearDown(self):
+    self.db = None
+    self.classUnderTest = None
+
+  def test_get_observations_in_bbox(self):
+    sdt = self.t0 + datetime.timedelta(hours=2)
+    edt = self.t0 + datetime.timedelta(hours=5)
+    expected = self.db.get_observations_in_bbox(*(self.BBOX + (sdt, edt)))
+    result = self.classUnderTest.get_observations_in_bbox(*(self.BBOX + (sdt, edt)))
+    self.assertEqual(12, len(result))
+    self.assertEqual(keys(expected), keys(result))
+
+  def test_get_observations_in_bbox_sub_window_from_memory(self):
+    self.classUnderTest.get_observations_in_bbox(*(self.BBOX + (self.t0, self.t0 + datetime.timedelta(hours=8))))
+    self.db.queries = []
+    sdt = self.t0 + datetime.timedelta(hours=1)
+    edt = self.t0 + datetime.timedelta(hours=3)
+    result = self.classUnderTest.get_observations_in_bbox(*(self.BBOX + (sdt, edt)))
+    self.assertEqual([], self.db.queries)
+    self.assertEqual(keys(self.db.get_observations_in_bbox(*(self.BBOX + (sdt, edt)))), keys(result))
+
+  def test_get_observations_in_bbox_incremental(self):
+    sdt = self.t0
+    edt = self.t0 + datetime.timedelta(hours=4)
+    self.classUnderTest.get_observations_in_bbox(*(self.BBOX + (sdt, edt)))
+
+    # A delayed report inside the overlap and a new report
+    self.db.add_observation("09", self.t0 + datetime.timedelta(hours=4), 13.0, 59.0)
+    self.db.add_observation("09", self.t0 + datetime.timedelta(hours=6), 13.0, 59.0)
+    self.db.queries = []
+
+    sdt = self.t0 + datetime.timedelta(hours=2)
+    edt = self.t0 + datetime.timedelta(hours=7)
+    result = self.classUnderTest.get_observations_in_bbox(*(self.BBOX + (sdt, edt)))
+    self.assertEqual([("obs", self.t0 + datetime.timedelta(hours=3), edt)], self.db.queries)
+    self.assertEqual(keys(self.db.get_observations_in_bbox(*(self.BBOX + (sdt, edt)))), keys(result))
+
+    # Evicted observations are not kept in memory
+    for k in self.classUnderTest._get_extent_index(*self.BBOX).observations.items.keys():
+      self.assertTrue(k[1] >= sdt)
+
+  def test_get_observations_in_bbox_earlier_window(self):
+    self.classUnderTest.get_observations_in_bbox(*(self.BBOX + (self.t0 + datetime.timedelta(hours=5), self.t0 + datetime.timedelta(hours=8))))
+    sdt = self.t0
+    edt = self.t0 + datetime.timedelta(hours=2)
+    result = self.classUnderTest.get_observations_in_bbox(*(self.BBOX + (sdt, edt)))
+    self.assertEqual(keys(self.db.get_observations_in_bbox(*(self.BBOX + (sdt, edt)))), keys(result))
+
+  def test_get_observations_in_bbox_unbounded(self):
+    self.classUnderTest.get_observations_in_bbox(*self.BBOX)
+    self.classUnderTest.get_observations_in_bbox(*self.BBOX)
+    self.assertEqual(2, len(self.db.queries))
+
+  def test_get_stations_in_bbox(self):
+    self.db.add_station("02000", 12.0, 58.0)
+    self.db.add_station("02001", 16.0, 61.0)
+    self.db.add_station("02002", 30.0, 61.0)
+    result = self.classUnderTest.get_stations_in_bbox(*self.BBOX)
+    result = self.classUnderTest.get_stations_in_bbox(*self.BBOX)
+    self.assertEqual(["02000", "02001"], sorted([s.stationnumber for s in result]))
+    self.assertEqual(1, len(self.db.queries))
+
+  def test_lonlat_grid(self):
+    grid = rave_dom_index.lonlat_grid(2.0)
+    grid.add("a", wmo_station("S", "0", "a", "0", "a", 1.0, 1.0))
+    grid.add("b", wmo_station("S", "0", "b", "0", "b", -3.0, 5.0))
+    grid.add("a", wmo_station("S", "0", "a", "0", "a", 7.0, 7.0))
+    self.assertEqual(2, len(grid))
+    self.assertEqual(["b"], [s.stationnumber for s in grid.query(-4.0, 6.0, 2.0, 0.0)])
+    self.assertEqual(["a"], [s.stationnumber for s in grid.query(6.0, 8.0, 8.0, 6.0)])
+    grid.remove("a")
+    self.assertEqual([], grid.query(6.0, 8.0, 8.0, 6.0))
+
+  def test_get_index(self):
+    self.assertTrue(rave_dom_index.get_index(self.db) is rave_dom_index.get_index(self.db))
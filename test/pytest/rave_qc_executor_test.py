@@ -0,0 +1,150 @@
+'''
+Copyright (C) 2026 Swedish Meteorological and Hydrological Institute, SMHI,
+
+This file is part of RAVE.
+
+RAVE is free software: you can redistribute it and/or modify
+it under the terms of the GNU Lesser General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+RAVE is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU Lesser General Public License for more details.
+
+You should have received a copy of the GNU Lesser General Public License
+along with RAVE.  If not, see <http://www.gnu.org/licenses/>.
+------------------------------------------------------------------------*/
+
+Tests the quality control executor
+
+@file
+@date 2026-10-17
+'''
+import unittest
+import threading
+import time
+import rave_qc_executor
+import rave_pgf_quality_registry
+from rave_quality_plugin import rave_quality_plugin
+
+class recording_plugin(rave_quality_plugin):
+  def __init__(self, name, log, threadsafe=True, algorithm=None, delay=0.0):
+    super(recording_plugin, self).__init__()
+    self.name = name
+    self.log = log
+    self.threadsafe = threadsafe
+    self.algo = algorithm
+    self.delay = delay
+    self.active = 0
+    self.maxactive = 0
+    self.lock = threading.Lock()
+
+  def getQualityFields(self):
+    return [self.name]
+
+  def process(self, obj, reprocess_quality_flag=True, quality_control_mode="analyze_and_apply", arguments=None):
+    with self.lock:
+      self.active += 1
+      self.maxactive = max(self.maxactive, self.active)
+    time.sleep(self.delay)
+    with self.lock:
+      self.active -= 1
+      self.log.append((obj.name, self.name))
+    obj.tasks.append(self.name)
+    return obj, self.getQualityFields()
+
+  def algorithm(self):
+    return self.algo
+
+  def isThreadSafe(self):
+    return self.threadsafe
+
+class qc_object(object):
+  def __init__(self, name):
+    self.name = name
+    self.tasks = []
+
+class failing_plugin(rave_quality_plugin):
+  def process(self, obj, reprocess_quality_flag=True, quality_control_mode="analyze_and_apply", arguments=None):
+    raise ValueError("failed")
+
+class rave_qc_executor_test(unittest.TestCase):
+  def setUp(self):
+    self.log = []
+    self.p1 = recording_plugin("qc.exec.1", self.log, delay=0.01)
+    self.p2 = recording_plugin("qc.exec.2", self.log, threadsafe=False, algorithm="algo", delay=0.01)
+    self.p3 = recording_plugin("qc.exec.3", self.log, delay=0.01)
+    rave_pgf_quality_registry.add_plugin("qc.exec.1", self.p1)
+    rave_pgf_quality_registry.add_plugin("qc.exec.2", self.p2)
+    rave_pgf_quality_registry.add_plugin("qc.exec.3", self.p3)
+    rave_pgf_quality_registry.add_plugin("qc.exec.fail", failing_plugin())
+
+  def tearDown(self):
+    for n in ["qc.exec.1", "qc.exec.2", "qc.exec.3", "qc.exec.fail"]:
+      rave_pgf_quality_registry.remove_plugin(n)
+
+  def create_objects(self, n):
+    result = {}
+    for i in range(n):
+      result["s%d.h5"%i] = qc_object("s%d"%i)
+    return result
+
+  def test_create_stages(self):
+    classUnderTest = rave_qc_executor.qc_executor(["qc.exec.1", "qc.exec.3", "qc.exec.2", "qc.exec.1", "qc.exec.nonexisting"])
+    stages = classUnderTest.create_stages()
+    self.assertEqual(3, len(stages))
+    self.assertEqual(["qc.exec.1", "qc.exec.3"], [x[1] for x in stages[0].plugins])
+    self.assertTrue(stages[0].threadsafe)
+    self.assertEqual(["qc.exec.2"], [x[1] for x in stages[1].plugins])
+    self.assertFalse(stages[1].threadsafe)
+    self.assertEqual(["qc.exec.1"], [x[1] for x in stages[2].plugins])
+
+  def test_is_thread_safe(self):
+    self.assertTrue(rave_qc_executor.is_thread_safe(self.p1))
+    self.assertFalse(rave_qc_executor.is_thread_safe(self.p2))
+    self.assertFalse(rave_qc_executor.is_thread_safe(failing_plugin()))
+    self.assertFalse(rave_qc_executor.is_thread_safe(qc_object("s0")))
+
+  def test_create_stages_serial(self):
+    classUnderTest = rave_qc_executor.qc_executor(["qc.exec.1", "qc.exec.2", "qc.exec.3"])
+    stages = classUnderTest.create_stages(False)
+    self.assertEqual(1, len(stages))
+
+  def test_process_serial(self):
+    classUnderTest = rave_qc_executor.qc_executor(["qc.exec.1", "qc.exec.2", "qc.exec.3"], nthreads=1)
+    result, algorithm, qfields = classUnderTest.process(self.create_objects(2))
+    self.assertEqual([("s0","qc.exec.1"),("s0","qc.exec.2"),("s0","qc.exec.3"),("s1","qc.exec.1"),("s1","qc.exec.2"),("s1","qc.exec.3")], self.log)
+    self.assertEqual("algo", algorithm)
+    self.assertEqual(["qc.exec.1", "qc.exec.2", "qc.exec.3"], qfields)
+    self.assertEqual(["qc.exec.1", "qc.exec.2", "qc.exec.3"], result["s1.h5"].tasks)
+
+  def test_process_parallel(self):
+    classUnderTest = rave_qc_executor.qc_executor(["qc.exec.1", "qc.exec.2", "qc.exec.3"], nthreads=4)
+    result, algorithm, qfields = classUnderTest.process(self.create_objects(8))
+    self.assertEqual(8, len(result))
+    for i in range(8):
+      self.assertEqual(["qc.exec.1", "qc.exec.2", "qc.exec.3"], result["s%d.h5"%i].tasks)
+      entries = [x[1] for x in self.log if x[0] == "s%d"%i]
+      self.assertEqual(["qc.exec.1", "qc.exec.2", "qc.exec.3"], entries)
+    self.assertEqual("algo", algorithm)
+    self.assertEqual(["qc.exec.1", "qc.exec.2", "qc.exec.3"], qfields)
+    self.assertTrue(self.p1.maxactive > 1)
+    self.assertEqual(1, self.p2.maxactive)
+
+  def test_process_timings(self):
+    classUnderTest = rave_qc_executor.qc_executor(["qc.exec.1", "qc.exec.3"], nthreads=2)
+    classUnderTest.process(self.create_objects(3))
+    self.assertEqual(3, classUnderTest.timings["qc.exec.1"][0])
+    self.assertEqual(3, classUnderTest.timings["qc.exec.3"][0])
+    self.assertTrue(classUnderTest.timings["qc.exec.1"][1] > 0.0)
+    self.assertTrue(classUnderTest.timings_str().startswith("qc.exec.1: 3 objects, "))
+
+  def test_process_failure(self):
+    classUnderTest = rave_qc_executor.qc_executor(["qc.exec.1", "qc.exec.fail"], nthreads=2)
+    try:
+      classUnderTest.process(self.create_objects(3))
+      self.fail("Expected ValueError")
+    except ValueError:
+      pass
@@ -44,6 +44,9 @@ RBPATH="${SCRIPTPATH}/../Lib:${SCRIPTPATH}/../modules"
 RAVE_LDPATH="${SCRIPTPATH}/../librave/tnc:${SCRIPTPATH}/../librave/toolbox:${SCRIPTPATH}/../librave/pyapi:${SCRIPTPATH}/../librave/scansun:${SCRIPTPATH}/../librave/radvol/lib"
 XRUNNERPATH="${SCRIPTPATH}/../test/lib"
 
+# The BUFR worker binary as built in this tree
+export RAVE_BUFR2ODIM_BIN="${SCRIPTPATH}/../librave/toolbox/rave_bufr2odim"
+
 # Special hack for mac osx.
 ISMACOS=no
 case `uname -s` in